@@ -42,9 +42,14 @@
 #include <hydra/reconstruction/projective_integrator.h>
 #include <hydra/utils/timing_utilities.h>
 
+#include <cstring>
 #include <filesystem>
+#include <list>
+#include <type_traits>
 
 #include "hydra_ros/utils/bag_reader.h"
+#include "hydra_ros/utils/block_store.h"
+#include "hydra_ros/utils/mesh_stitching.h"
 
 DEFINE_string(config, "", "config contents (in YAML)");
 DEFINE_string(output_path, "", "output directory");
@@ -52,33 +57,268 @@ DEFINE_bool(show_timers, false, "print timers during reconstruction");
 
 namespace hydra {
 
+namespace {
+
+using StoreIndex = ChunkedBlockStore::BlockIndex;
+
+inline StoreIndex toStoreIndex(const BlockIndex& index) {
+  return {index.x(), index.y(), index.z()};
+}
+
+template <typename T>
+void appendArray(std::vector<uint8_t>& buffer, const std::vector<T>& values) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  const uint64_t size = values.size();
+  const auto size_ptr = reinterpret_cast<const uint8_t*>(&size);
+  buffer.insert(buffer.end(), size_ptr, size_ptr + sizeof(size));
+  const auto data_ptr = reinterpret_cast<const uint8_t*>(values.data());
+  buffer.insert(buffer.end(), data_ptr, data_ptr + values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readArray(const std::vector<uint8_t>& buffer,
+               size_t& offset,
+               std::vector<T>& values) {
+  uint64_t size;
+  if (offset + sizeof(size) > buffer.size()) {
+    return false;
+  }
+
+  std::memcpy(&size, buffer.data() + offset, sizeof(size));
+  offset += sizeof(size);
+  if (offset + size * sizeof(T) > buffer.size()) {
+    return false;
+  }
+
+  values.resize(size);
+  std::memcpy(values.data(), buffer.data() + offset, size * sizeof(T));
+  offset += size * sizeof(T);
+  return true;
+}
+
+// eigen types are not trivially copyable, so positions are stored as raw floats
+void appendPoints(std::vector<uint8_t>& buffer,
+                  const std::vector<Eigen::Vector3f>& points) {
+  std::vector<float> values(3 * points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    std::memcpy(values.data() + 3 * i, points[i].data(), 3 * sizeof(float));
+  }
+
+  appendArray(buffer, values);
+}
+
+bool readPoints(const std::vector<uint8_t>& buffer,
+                size_t& offset,
+                std::vector<Eigen::Vector3f>& points) {
+  std::vector<float> values;
+  if (!readArray(buffer, offset, values) || values.size() % 3 != 0) {
+    return false;
+  }
+
+  points.resize(values.size() / 3);
+  for (size_t i = 0; i < points.size(); ++i) {
+    points[i] = Eigen::Vector3f(values[3 * i], values[3 * i + 1], values[3 * i + 2]);
+  }
+
+  return true;
+}
+
+std::vector<uint8_t> serializeMesh(const Mesh& mesh) {
+  std::vector<uint8_t> buffer;
+  appendPoints(buffer, mesh.points);
+  appendArray(buffer, mesh.colors);
+  appendArray(buffer, mesh.stamps);
+  appendArray(buffer, mesh.first_seen_stamps);
+  appendArray(buffer, mesh.labels);
+  appendArray(buffer, mesh.faces);
+  return buffer;
+}
+
+bool deserializeMesh(const std::vector<uint8_t>& buffer, Mesh& mesh) {
+  size_t offset = 0;
+  return readPoints(buffer, offset, mesh.points) &&
+         readArray(buffer, offset, mesh.colors) &&
+         readArray(buffer, offset, mesh.stamps) &&
+         readArray(buffer, offset, mesh.first_seen_stamps) &&
+         readArray(buffer, offset, mesh.labels) &&
+         readArray(buffer, offset, mesh.faces);
+}
+
+}  // namespace
+
 struct Reconstructor {
+  struct OutOfCoreConfig {
+    //! Flush blocks far from the sensor to disk (all are reloaded to save the map)
+    bool enable = false;
+    //! Blocks with centers further than this from the sensor are flushed
+    double active_radius_m = 30.0;
+    //! Number of integrated frames between flushes
+    size_t flush_period = 20;
+    //! Directory for flushed blocks (defaults to the output directory)
+    std::string storage_path = "";
+    //! Number of blocks per chunk file side
+    int blocks_per_chunk = 8;
+  };
+
   struct Config {
     VolumetricMap::Config map;
     ProjectiveIntegratorConfig integrator;
+    //! Vertices of neighboring mesh blocks closer than this are merged
+    double vertex_merge_tolerance = 1.0e-4;
+    size_t num_mesh_threads = 4;
+    OutOfCoreConfig out_of_core;
   } const config;
 
-  explicit Reconstructor(const Config& config)
+  Reconstructor(const Config& config, const std::string& output_dir)
       : config(config::checkValid(config)),
         map(config.map),
-        integrator(std::make_unique<ProjectiveIntegrator>(config.integrator)) {}
+        integrator(std::make_unique<ProjectiveIntegrator>(config.integrator)),
+        mesh_integrator(MeshIntegratorConfig()) {
+    if (!config.out_of_core.enable) {
+      return;
+    }
+
+    const std::filesystem::path storage_path = config.out_of_core.storage_path.empty()
+                                                   ? output_dir
+                                                   : config.out_of_core.storage_path;
+    const auto blocks_per_chunk = config.out_of_core.blocks_per_chunk;
+    tsdf_store.reset(new ChunkedBlockStore(storage_path / "tsdf", blocks_per_chunk));
+    mesh_store.reset(new ChunkedBlockStore(storage_path / "mesh", blocks_per_chunk));
+  }
 
   void update(const InputData& data) const {
     VLOG(5) << "processing data @ " << data.timestamp_ns;
-    timing::ScopedTimer timer("update_tsdf", data.timestamp_ns, true, 1, false);
-    integrator->updateMap(data, map);
+    if (tsdf_store) {
+      reloadBlocks(data.world_t_body);
+    }
+
+    {
+      timing::ScopedTimer timer("update_tsdf", data.timestamp_ns, true, 1, false);
+      integrator->updateMap(data, map);
+    }
+
+    if (tsdf_store && ++num_updates % config.out_of_core.flush_period == 0) {
+      flushBlocks(data.world_t_body);
+    }
+  }
+
+  //! Bring back flushed blocks that are inside the active region again
+  void reloadBlocks(const Eigen::Vector3d& position) const {
+    timing::ScopedTimer timer("reload_blocks", 0, true, 1, false);
+    auto& tsdf = map.getTsdfLayer();
+    const double radius = config.out_of_core.active_radius_m;
+    std::vector<uint8_t> buffer;
+    for (const auto& store_index : tsdf_store->blocks()) {
+      const BlockIndex index(store_index[0], store_index[1], store_index[2]);
+      const Eigen::Vector3d center =
+          ((index.cast<double>() + Eigen::Vector3d::Constant(0.5)) * tsdf.blockSize());
+      if ((center - position).norm() > radius) {
+        continue;
+      }
+
+      if (!loadTsdfBlock(store_index, buffer)) {
+        continue;
+      }
+
+      tsdf.getBlock(index).updated = true;
+      tsdf_store->erase(store_index);
+      // the block will be meshed again along with its neighbors
+      mesh_store->erase(store_index);
+    }
+  }
+
+  //! Copy a flushed TSDF block back into the map
+  bool loadTsdfBlock(const StoreIndex& store_index,
+                     std::vector<uint8_t>& buffer) const {
+    const BlockIndex index(store_index[0], store_index[1], store_index[2]);
+    if (!tsdf_store->read(store_index, buffer)) {
+      LOG(ERROR) << "Unable to reload block " << index.transpose();
+      return false;
+    }
+
+    auto& tsdf = map.getTsdfLayer();
+    auto& block = tsdf.allocateBlock(index);
+    if (buffer.size() != block.voxels.size() * sizeof(TsdfVoxel)) {
+      LOG(ERROR) << "Stored block " << index.transpose() << " has invalid size";
+      tsdf.removeBlock(index);
+      return false;
+    }
+
+    std::memcpy(block.voxels.data(), buffer.data(), buffer.size());
+    return true;
+  }
+
+  //! Move every flushed block back into the map so that the saved map is complete
+  bool restoreFlushedBlocks() const {
+    timing::ScopedTimer timer("restore_blocks", 0, true, 1, false);
+    bool success = true;
+    std::vector<uint8_t> buffer;
+    for (const auto& store_index : tsdf_store->blocks()) {
+      success &= loadTsdfBlock(store_index, buffer);
+    }
+
+    // the blocks were meshed before they were flushed
+    auto& mesh_layer = map.getMeshLayer();
+    for (const auto& store_index : mesh_store->blocks()) {
+      const BlockIndex index(store_index[0], store_index[1], store_index[2]);
+      auto& mesh_block = mesh_layer.allocateBlock(index);
+      if (!mesh_store->read(store_index, buffer) ||
+          !deserializeMesh(buffer, mesh_block)) {
+        LOG(ERROR) << "Unable to reload mesh block " << index.transpose();
+        mesh_layer.removeBlock(index);
+        success = false;
+      }
+    }
+
+    tsdf_store->clear();
+    mesh_store->clear();
+    return success;
+  }
+
+  //! Mesh everything that changed and move blocks outside the active region to disk
+  void flushBlocks(const Eigen::Vector3d& position) const {
+    static_assert(std::is_trivially_copyable_v<TsdfVoxel>);
+    timing::ScopedTimer timer("flush_blocks", 0, true, 1, false);
+    // meshing happens before anything is removed so flushed blocks see all neighbors
+    mesh_integrator.generateMesh(map, true, true);
+
+    auto& tsdf = map.getTsdfLayer();
+    auto& mesh_layer = map.getMeshLayer();
+    const double radius = config.out_of_core.active_radius_m;
+    std::vector<BlockIndex> to_flush;
+    for (const auto& block : tsdf) {
+      if ((block.position().cast<double>() - position).norm() > radius) {
+        to_flush.push_back(block.index);
+      }
+    }
+
+    std::vector<uint8_t> buffer;
+    for (const auto& index : to_flush) {
+      const auto& block = tsdf.getBlock(index);
+      const auto data = reinterpret_cast<const uint8_t*>(block.voxels.data());
+      buffer.assign(data, data + block.voxels.size() * sizeof(TsdfVoxel));
+      tsdf_store->write(toStoreIndex(index), buffer);
+      tsdf.removeBlock(index);
+
+      const auto mesh_block = mesh_layer.getBlockPtr(index);
+      if (mesh_block) {
+        mesh_store->write(toStoreIndex(index), serializeMesh(*mesh_block));
+        mesh_layer.removeBlock(index);
+      }
+    }
+
+    VLOG(1) << "Flushed " << to_flush.size() << " blocks (" << tsdf_store->size()
+            << " on disk, " << tsdf.numBlocks() << " in memory)";
   }
 
   void reconstruct(const std::string& output_dir) {
-    if (!map.getTsdfLayer().numBlocks()) {
+    if (!map.getTsdfLayer().numBlocks() && !(tsdf_store && tsdf_store->size())) {
       LOG(ERROR) << "TSDF is empty! Not saving output";
       return;
     }
 
     {
       timing::ScopedTimer timer("reconstruct_mesh", 0, true, 1);
-      MeshIntegratorConfig mesh_config;
-      MeshIntegrator mesh_integrator(mesh_config);
       mesh_integrator.generateMesh(map, false, false);
     }
 
@@ -87,31 +327,75 @@ struct Reconstructor {
       std::filesystem::create_directories(output_path);
     }
 
-    Mesh full_mesh;
+    Mesh::Ptr full_mesh;
     {
       timing::ScopedTimer timer("connect_mesh", 0, true, 1);
-      // TODO(lschmid): BROKEN fix the mesh connecting. Can be implemented by adapting
-      // this
-      // https://github.mit.edu/SPARK/Hydra/blob/66b701702adb51a4c076ba0e26baf59462863d5a/eval/tools/compress_graph.cpp#L201-L217
-      // to 'full_mesh = connectMesh(map.getMeshLayer());'
-      LOG(ERROR) << "Mesh blocks  are currently not being connected!";
+      std::vector<const Mesh*> blocks;
+      for (const auto& block : map.getMeshLayer()) {
+        blocks.push_back(&block);
+      }
+
+      // flushed blocks are only read back at the very end
+      std::list<Mesh> stored_meshes;
+      std::vector<uint8_t> buffer;
+      const auto stored = mesh_store ? mesh_store->blocks() : std::vector<StoreIndex>();
+      for (const auto& index : stored) {
+        auto& mesh = stored_meshes.emplace_back();
+        if (mesh_store->read(index, buffer) && deserializeMesh(buffer, mesh)) {
+          blocks.push_back(&mesh);
+        }
+      }
+
+      full_mesh = connectMeshes(
+          blocks, config.vertex_merge_tolerance, config.num_mesh_threads);
     }
 
     LOG(INFO) << "Saving mesh and tsdf to " << output_path;
     timing::ScopedTimer io_timer("save_files", 0, true, 1);
-    full_mesh.save(output_path / "mesh");
+    full_mesh->save(output_path / "mesh");
+    full_mesh.reset();
+
+    // the saved map has to contain every block, so this needs the full map in memory
+    if (tsdf_store && !restoreFlushedBlocks()) {
+      LOG(ERROR) << "Unable to restore flushed blocks! Not saving partial map";
+      return;
+    }
+
     map.save(output_path / "map");
   }
 
   mutable VolumetricMap map;
   std::unique_ptr<ProjectiveIntegrator> integrator;
+  mutable MeshIntegrator mesh_integrator;
+  mutable size_t num_updates = 0;
+  std::unique_ptr<ChunkedBlockStore> tsdf_store;
+  std::unique_ptr<ChunkedBlockStore> mesh_store;
 };
 
+void declare_config(Reconstructor::OutOfCoreConfig& config) {
+  using namespace config;
+  name("Reconstructor::OutOfCoreConfig");
+  field(config.enable, "enable");
+  field(config.active_radius_m, "active_radius_m", "m");
+  field(config.flush_period, "flush_period");
+  field(config.storage_path, "storage_path");
+  field(config.blocks_per_chunk, "blocks_per_chunk");
+
+  check(config.active_radius_m, GT, 0.0, "active_radius_m");
+  check(config.flush_period, GT, 0u, "flush_period");
+  check(config.blocks_per_chunk, GT, 0, "blocks_per_chunk");
+}
+
 void declare_config(Reconstructor::Config& config) {
   using namespace config;
   name("Reconstructor::Config");
   field(config.map, "map");
   field(config.integrator, "integrator");
+  field(config.vertex_merge_tolerance, "vertex_merge_tolerance", "m");
+  field(config.num_mesh_threads, "num_mesh_threads");
+  field(config.out_of_core, "out_of_core");
+
+  check(config.vertex_merge_tolerance, GT, 0.0, "vertex_merge_tolerance");
 }
 
 }  // namespace hydra
@@ -151,7 +435,8 @@ int main(int argc, char* argv[]) {
   VLOG(1) << std::endl << config::toString(config);
 
   hydra::BagReader reader(config.reader);
-  auto reconstructor = std::make_shared<hydra::Reconstructor>(config.reconstructor);
+  auto reconstructor =
+      std::make_shared<hydra::Reconstructor>(config.reconstructor, FLAGS_output_path);
   auto sink = hydra::BagReader::Sink::fromMethod(&hydra::Reconstructor::update,
                                                  reconstructor.get());
   reader.addSink(sink);
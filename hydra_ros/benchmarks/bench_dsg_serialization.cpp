@@ -0,0 +1,154 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <benchmark/benchmark.h>
+#include <hydra_ros/utils/dsg_compression.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+
+#include "allocation_counter.h"
+#include "scene_graph_generator.h"
+
+namespace hydra::bench {
+
+// serialization on the sender side (DsgSender::sendGraph)
+void BM_WriteGraph(benchmark::State& state) {
+  const auto graph = makeSceneGraph(state.range(0));
+  std::vector<uint8_t> buffer;
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    buffer.clear();
+    spark_dsg::io::binary::writeGraph(*graph, buffer, false);
+    benchmark::DoNotOptimize(buffer.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * graph->numNodes());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+// parsing a full update (DsgReceiver::handleUpdate without a previous graph)
+void BM_ReadGraph(benchmark::State& state) {
+  const auto graph = makeSceneGraph(state.range(0));
+  std::vector<uint8_t> buffer;
+  spark_dsg::io::binary::writeGraph(*graph, buffer, false);
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    auto result = spark_dsg::io::binary::readGraph(buffer);
+    benchmark::DoNotOptimize(result);
+  }
+
+  state.SetItemsProcessed(state.iterations() * graph->numNodes());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+// applying a full update to an existing graph (DsgReceiver::handleUpdate)
+void BM_UpdateGraph(benchmark::State& state) {
+  const auto graph = makeSceneGraph(state.range(0));
+  std::vector<uint8_t> buffer;
+  spark_dsg::io::binary::writeGraph(*graph, buffer, false);
+  auto received = spark_dsg::io::binary::readGraph(buffer);
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    spark_dsg::io::binary::updateGraph(*received, buffer, false);
+  }
+
+  state.SetItemsProcessed(state.iterations() * graph->numNodes());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+void BM_CompressGraph(benchmark::State& state) {
+  const auto codec = static_cast<DsgCodec>(state.range(0));
+  const auto graph = makeSceneGraph(state.range(1));
+  std::vector<uint8_t> buffer;
+  spark_dsg::io::binary::writeGraph(*graph, buffer, false);
+
+  std::vector<uint8_t> compressed;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    compressPayload(codec, 1, buffer, compressed);
+    benchmark::DoNotOptimize(compressed.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+  state.counters["ratio"] = static_cast<double>(buffer.size()) / compressed.size();
+}
+
+void BM_DecompressGraph(benchmark::State& state) {
+  const auto codec = static_cast<DsgCodec>(state.range(0));
+  const auto graph = makeSceneGraph(state.range(1));
+  std::vector<uint8_t> buffer;
+  spark_dsg::io::binary::writeGraph(*graph, buffer, false);
+  std::vector<uint8_t> compressed;
+  compressPayload(codec, 1, buffer, compressed);
+
+  std::vector<uint8_t> result;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    decompressPayload(codec, buffer.size(), compressed, result);
+    benchmark::DoNotOptimize(result.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+BENCHMARK(BM_WriteGraph)
+    ->ArgName("places")
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReadGraph)
+    ->ArgName("places")
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UpdateGraph)
+    ->ArgName("places")
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+constexpr int64_t kZstd = static_cast<int64_t>(DsgCodec::ZSTD);
+constexpr int64_t kLz4 = static_cast<int64_t>(DsgCodec::LZ4);
+BENCHMARK(BM_CompressGraph)
+    ->ArgNames({"codec", "places"})
+    ->ArgsProduct({{kZstd, kLz4}, {1000, 100000}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecompressGraph)
+    ->ArgNames({"codec", "places"})
+    ->ArgsProduct({{kZstd, kLz4}, {1000, 100000}})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace hydra::bench
@@ -0,0 +1,126 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <benchmark/benchmark.h>
+#include <hydra_ros/reconstruction/reconstruction_visualizer.h>
+#include <hydra_ros/utils/occupancy_publisher.h>
+
+#include <random>
+
+#include "allocation_counter.h"
+
+namespace hydra::bench {
+
+namespace {
+
+//! Square TSDF layer num_blocks x num_blocks wide and two blocks tall
+TsdfLayer::Ptr makeTsdfLayer(int num_blocks, float voxel_size = 0.1f) {
+  auto layer = std::make_shared<TsdfLayer>(voxel_size, 16);
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(-0.5f, 2.0f);
+  for (int x = 0; x < num_blocks; ++x) {
+    for (int y = 0; y < num_blocks; ++y) {
+      for (int z = 0; z < 2; ++z) {
+        auto block = layer->allocateBlockPtr(BlockIndex(x, y, z));
+        block->updated = true;
+        for (size_t i = 0; i < block->numVoxels(); ++i) {
+          auto& voxel = block->getVoxel(i);
+          voxel.distance = dist(gen);
+          voxel.weight = voxel.distance > 1.8f ? 0.0f : 1.0f;
+        }
+      }
+    }
+  }
+
+  return layer;
+}
+
+Eigen::Isometry3d makePose(int num_blocks, float block_size) {
+  Eigen::Isometry3d world_T_sensor = Eigen::Isometry3d::Identity();
+  const double center = 0.5 * num_blocks * block_size;
+  world_T_sensor.translation() = Eigen::Vector3d(center, center, 0.5);
+  return world_T_sensor;
+}
+
+}  // namespace
+
+void BM_FillOccupancyGrid(benchmark::State& state) {
+  const int num_blocks = state.range(0);
+  const auto layer = makeTsdfLayer(num_blocks);
+  const auto world_T_sensor = makePose(num_blocks, layer->blockSize());
+  OccupancyPublisher::Config config;
+  config.num_slices = 2;
+  config.num_threads = state.range(1);
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    nav_msgs::OccupancyGrid msg;
+    fillOccupancyGrid(config, *layer, world_T_sensor, msg);
+    benchmark::DoNotOptimize(msg.data.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * layer->numBlocks());
+}
+
+void BM_MakeTsdfMarker(benchmark::State& state) {
+  const int num_blocks = state.range(0);
+  const auto layer = makeTsdfLayer(num_blocks);
+  const auto world_T_sensor = makePose(num_blocks, layer->blockSize());
+  ReconstructionVisualizer::Config config;
+  config.colors = ColormapConfig::__getDefault__();
+  std_msgs::Header header;
+  header.frame_id = "world";
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const auto msg = makeTsdfMarker(
+        config, header, *layer, world_T_sensor, colorVoxelByDist, "tsdf");
+    benchmark::DoNotOptimize(msg.points.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * layer->numBlocks());
+}
+
+BENCHMARK(BM_FillOccupancyGrid)
+    ->ArgNames({"blocks_per_side", "threads"})
+    ->ArgsProduct({{8, 32, 128}, {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MakeTsdfMarker)
+    ->ArgName("blocks_per_side")
+    ->Arg(8)
+    ->Arg(32)
+    ->Arg(128)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace hydra::bench
@@ -0,0 +1,158 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <benchmark/benchmark.h>
+#include <hydra_ros/input/pointcloud_adaptor.h>
+
+#include <cstring>
+
+#include "allocation_counter.h"
+
+namespace hydra::bench {
+
+namespace {
+
+using sensor_msgs::PointField;
+
+enum class Layout : int {
+  //! x, y, z as consecutive float32 followed by rgb and label
+  PACKED = 0,
+  //! ouster-style padding and extra fields between coordinates and color
+  PADDED = 1,
+  //! float64 coordinates (generic parsing path)
+  DOUBLE = 2,
+};
+
+void addField(sensor_msgs::PointCloud2& cloud,
+              const std::string& name,
+              uint32_t offset,
+              uint8_t datatype) {
+  PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = 1;
+  cloud.fields.push_back(field);
+}
+
+sensor_msgs::PointCloud2 makeCloud(Layout layout, size_t num_points, bool organized) {
+  sensor_msgs::PointCloud2 cloud;
+  const bool is_double = layout == Layout::DOUBLE;
+  const auto coord_type = is_double ? PointField::FLOAT64 : PointField::FLOAT32;
+  const uint32_t coord_size = is_double ? 8 : 4;
+  const uint32_t coord_stride = layout == Layout::PADDED ? 2 * coord_size : coord_size;
+  addField(cloud, "x", 0, coord_type);
+  addField(cloud, "y", coord_stride, coord_type);
+  addField(cloud, "z", 2 * coord_stride, coord_type);
+  const uint32_t rgb_offset = 3 * coord_stride + (layout == Layout::PADDED ? 8 : 0);
+  addField(cloud, "rgb", rgb_offset, PointField::UINT32);
+  addField(cloud, "label", rgb_offset + 4, PointField::UINT32);
+
+  cloud.point_step = rgb_offset + 8;
+  cloud.height = organized ? 64 : 1;
+  cloud.width = num_points / cloud.height;
+  cloud.row_step = cloud.width * cloud.point_step;
+  cloud.is_dense = true;
+  cloud.data.resize(cloud.row_step * cloud.height);
+
+  for (size_t i = 0; i < cloud.width * cloud.height; ++i) {
+    uint8_t* point = cloud.data.data() + i * cloud.point_step;
+    for (size_t d = 0; d < 3; ++d) {
+      const double value = 0.01 * i + d;
+      if (is_double) {
+        std::memcpy(point + d * coord_stride, &value, sizeof(double));
+      } else {
+        const float value_f = value;
+        std::memcpy(point + d * coord_stride, &value_f, sizeof(float));
+      }
+    }
+
+    const uint8_t bgra[4] = {static_cast<uint8_t>(i), 10, 20, 255};
+    std::memcpy(point + rgb_offset, bgra, 4);
+    const uint32_t label = i % 20;
+    std::memcpy(point + rgb_offset + 4, &label, sizeof(uint32_t));
+  }
+
+  return cloud;
+}
+
+}  // namespace
+
+void BM_FillPointcloudPacket(benchmark::State& state) {
+  const auto layout = static_cast<Layout>(state.range(0));
+  const size_t num_points = state.range(1);
+  const auto cloud = makeCloud(layout, num_points, state.range(2));
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    CloudInputPacket packet(0, 0);
+    benchmark::DoNotOptimize(fillPointcloudPacket(cloud, packet, true));
+    benchmark::DoNotOptimize(packet.points.data);
+  }
+
+  state.SetItemsProcessed(state.iterations() * cloud.width * cloud.height);
+  state.SetBytesProcessed(state.iterations() * cloud.data.size());
+}
+
+BENCHMARK(BM_FillPointcloudPacket)
+    ->ArgNames({"layout", "points", "organized"})
+    ->ArgsProduct({{0, 1, 2}, {1 << 14, 1 << 17, 1 << 20}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_FillTransformedPointcloudPacket(benchmark::State& state) {
+  const auto layout = static_cast<Layout>(state.range(0));
+  const auto cloud = makeCloud(layout, state.range(1), true);
+  Eigen::Isometry3f sensor_T_cloud = Eigen::Isometry3f::Identity();
+  sensor_T_cloud.linear() =
+      Eigen::AngleAxisf(0.3, Eigen::Vector3f::UnitZ()).toRotationMatrix();
+  sensor_T_cloud.translation() << 0.1f, -0.2f, 0.5f;
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    CloudInputPacket packet(0, 0);
+    const auto& T = sensor_T_cloud;
+    benchmark::DoNotOptimize(fillPointcloudPacket(cloud, packet, true, &T));
+    benchmark::DoNotOptimize(packet.points.data);
+  }
+
+  state.SetItemsProcessed(state.iterations() * cloud.width * cloud.height);
+  state.SetBytesProcessed(state.iterations() * cloud.data.size());
+}
+
+BENCHMARK(BM_FillTransformedPointcloudPacket)
+    ->ArgNames({"layout", "points"})
+    ->ArgsProduct({{0, 1, 2}, {1 << 14, 1 << 17, 1 << 20}})
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace hydra::bench
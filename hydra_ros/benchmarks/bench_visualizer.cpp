@@ -0,0 +1,130 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <benchmark/benchmark.h>
+#include <hydra_ros/visualizer/visualizer_utilities.h>
+
+#include "allocation_counter.h"
+#include "scene_graph_generator.h"
+
+namespace hydra::bench {
+
+namespace {
+
+LayerConfig makeLayerConfig() {
+  auto config = LayerConfig::__getDefault__();
+  config.visualize = true;
+  return config;
+}
+
+}  // namespace
+
+void BM_MakeGraphEdgeMarkers(benchmark::State& state) {
+  const auto graph = makeSceneGraph(state.range(0));
+  const std::map<LayerId, LayerConfig> configs{
+      {DsgLayers::OBJECTS, makeLayerConfig()}, {DsgLayers::PLACES, makeLayerConfig()}};
+  const auto visualizer_config = VisualizerConfig::__getDefault__();
+  std_msgs::Header header;
+  header.frame_id = "world";
+
+  size_t num_points = 0;
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const auto msg =
+        makeGraphEdgeMarkers(header, *graph, configs, visualizer_config, "edges");
+    num_points = 0;
+    for (const auto& marker : msg.markers) {
+      num_points += marker.points.size();
+    }
+    benchmark::DoNotOptimize(num_points);
+  }
+
+  state.SetItemsProcessed(state.iterations() * graph->numEdges());
+  state.counters["points"] = num_points;
+}
+
+void BM_MakeLayerEdgeMarkers(benchmark::State& state) {
+  const auto graph = makeSceneGraph(state.range(0));
+  const auto config = makeLayerConfig();
+  const auto visualizer_config = VisualizerConfig::__getDefault__();
+  const auto& layer = graph->getLayer(DsgLayers::PLACES);
+  std_msgs::Header header;
+  header.frame_id = "world";
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const auto msg = makeLayerEdgeMarkers(
+        header, config, layer, visualizer_config, Color(), "place_edges");
+    benchmark::DoNotOptimize(msg.points.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * layer.numEdges());
+}
+
+void BM_MakeCentroidMarkers(benchmark::State& state) {
+  const auto graph = makeSceneGraph(state.range(0));
+  const auto config = makeLayerConfig();
+  const auto visualizer_config = VisualizerConfig::__getDefault__();
+  const auto& layer = graph->getLayer(DsgLayers::PLACES);
+  const ColorFunction color_func = [](const SceneGraphNode&) { return Color(); };
+  std_msgs::Header header;
+  header.frame_id = "world";
+
+  AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const auto msg = makeCentroidMarkers(
+        header, config, layer, visualizer_config, "places", color_func);
+    benchmark::DoNotOptimize(msg.points.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * layer.numNodes());
+}
+
+BENCHMARK(BM_MakeGraphEdgeMarkers)
+    ->ArgName("places")
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MakeLayerEdgeMarkers)
+    ->ArgName("places")
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MakeCentroidMarkers)
+    ->ArgName("places")
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace hydra::bench
@@ -0,0 +1,71 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+
+#include <random>
+
+namespace hydra::bench {
+
+/**
+ * @brief Synthetic scene graph with a connected places layer and one object per ten
+ * places, each attached to a place
+ */
+inline DynamicSceneGraph::Ptr makeSceneGraph(size_t num_places) {
+  auto graph = std::make_shared<DynamicSceneGraph>();
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> dist(0.0, 100.0);
+  for (size_t i = 0; i < num_places; ++i) {
+    auto attrs = std::make_unique<PlaceNodeAttributes>(1.0, 3);
+    attrs->position = Eigen::Vector3d(dist(gen), dist(gen), 0.1 * dist(gen));
+    graph->emplaceNode(DsgLayers::PLACES, NodeSymbol('p', i), std::move(attrs));
+    if (i > 0) {
+      graph->insertEdge(NodeSymbol('p', i - 1), NodeSymbol('p', i));
+    }
+
+    if (i % 10 == 0) {
+      auto object_attrs = std::make_unique<ObjectNodeAttributes>();
+      object_attrs->position = graph->getNode(NodeSymbol('p', i)).attributes().position;
+      object_attrs->semantic_label = i % 20;
+      const NodeSymbol object_id('O', i / 10);
+      graph->emplaceNode(DsgLayers::OBJECTS, object_id, std::move(object_attrs));
+      graph->insertEdge(object_id, NodeSymbol('p', i));
+    }
+  }
+
+  return graph;
+}
+
+}  // namespace hydra::bench
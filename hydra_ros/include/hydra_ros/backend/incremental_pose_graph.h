@@ -0,0 +1,93 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#pragma once
+#include <pose_graph_tools_msgs/PoseGraph.h>
+#include <spark_dsg/dynamic_scene_graph.h>
+
+#include <atomic>
+#include <optional>
+
+namespace hydra {
+
+/**
+ * @brief Builds pose graph messages that only contain the agent poses (and the
+ * odometry edges between them) added since the last message.
+ *
+ * Poses are read from the agent layer of the scene graph, so a delta never touches
+ * the deformation graph. Any change to a pose that was already sent (i.e., after an
+ * optimization) requires the full pose graph instead.
+ */
+class IncrementalPoseGraph {
+ public:
+  enum class Update {
+    //! Nothing was added since the last update
+    NONE,
+    //! The message contains the added poses and odometry edges
+    DELTA,
+    //! The full pose graph has to be sent
+    FULL,
+  };
+
+  //! @param refresh_period_s Maximum time between full pose graphs (ignored if <= 0)
+  explicit IncrementalPoseGraph(double refresh_period_s = 10.0);
+
+  //! Force the next update to request the full pose graph (safe from any thread)
+  void requestRefresh();
+
+  /**
+   * @brief Fill a message with the poses added since the last update
+   * @param timestamp_ns Current time
+   * @param agents Agent layer of the robot whose pose graph is published
+   * @param robot_id Pose graph robot id of the agent
+   * @param msg Message to fill (only touched for deltas)
+   * @returns Whether a delta, the full graph or nothing should be sent
+   */
+  Update update(uint64_t timestamp_ns,
+                const DynamicSceneGraphLayer& agents,
+                int robot_id,
+                pose_graph_tools_msgs::PoseGraph& msg);
+
+ private:
+  bool needsRefresh(uint64_t timestamp_ns, const DynamicSceneGraphLayer& agents);
+
+  const double refresh_period_s_;
+  std::atomic<bool> refresh_requested_;
+  std::optional<uint64_t> last_refresh_ns_;
+  //! Positions of every pose that was sent, used to detect moved poses
+  std::vector<Eigen::Vector3d> sent_positions_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,70 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <pose_graph_tools/pose_graph.h>
+#include <pose_graph_tools_msgs/PoseGraph.h>
+
+#include <map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Merges incremental pose graph messages into one contiguous graph per robot.
+ *
+ * Nodes and edges are converted directly into the pending graph of their robot in
+ * arrival order. Storage for each pending graph is reserved from the size of the
+ * previous merged graph of the same robot.
+ */
+class PoseGraphCoalescer {
+ public:
+  //! Append the nodes and edges of a message to the pending graph of its robot
+  void add(const pose_graph_tools_msgs::PoseGraph& msg);
+
+  //! Move the merged graph of every robot (in robot id order) into graphs
+  void flush(std::vector<pose_graph_tools::PoseGraph::ConstPtr>& graphs);
+
+  //! Number of robots with a pending graph
+  size_t numPending() const { return pending_.size(); }
+
+ private:
+  pose_graph_tools::PoseGraph& getPendingGraph(int robot_id);
+
+  std::map<int, std::shared_ptr<pose_graph_tools::PoseGraph>> pending_;
+  //! Sizes of the last merged graph per robot, used to preallocate the next one
+  std::map<int, std::pair<size_t, size_t>> capacity_;
+};
+
+}  // namespace hydra
@@ -40,6 +40,8 @@
 #include <message_filters/synchronizer.h>
 #include <pose_graph_tools_msgs/PoseGraph.h>
 
+#include "hydra_ros/backend/pose_graph_coalescer.h"
+
 namespace hydra {
 
 class RosBackend : public BackendModule {
@@ -77,7 +79,8 @@ class RosBackend : public BackendModule {
 
  protected:
   ros::NodeHandle nh_;
-  std::list<pose_graph_tools::PoseGraph::ConstPtr> pose_graph_queue_;
+  //! Incremental pose graphs received since the last input, merged per robot
+  PoseGraphCoalescer pose_graphs_;
   kimera_pgmo_msgs::KimeraPgmoMesh::ConstPtr latest_mesh_msg_;
 
   ros::Subscriber pose_graph_sub_;
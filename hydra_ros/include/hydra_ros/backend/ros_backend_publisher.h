@@ -34,34 +34,87 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <hydra/backend/backend_module.h>
+#include <pose_graph_tools_msgs/PoseGraph.h>
+#include <visualization_msgs/Marker.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "hydra_ros/backend/incremental_pose_graph.h"
 #include "hydra_ros/utils/dsg_streaming_interface.h"
 
 namespace hydra {
 
 class RosBackendPublisher : public BackendModule::Sink {
  public:
+  //! Tracks what was published for a marker that only gets new points appended
+  struct IncrementalMarker {
+    size_t num_points = 0;
+    uint64_t hash = 0;
+    int32_t next_id = 0;
+
+    //! Force the next update to send the full marker (ids already sent get cleared)
+    void invalidate() {
+      num_points = 0;
+      hash = 0;
+    }
+  };
+
   explicit RosBackendPublisher(const ros::NodeHandle& nh);
 
-  virtual ~RosBackendPublisher() = default;
+  virtual ~RosBackendPublisher();
 
   void call(uint64_t timestamp_ns,
             const DynamicSceneGraph& graph,
             const kimera_pgmo::DeformationGraph& dgraph) const override;
 
+  //! Markers to publish so that a subscriber sees the full marker (only new points
+  //! are sent if the previously published points did not change)
+  static std::vector<visualization_msgs::Marker> updateIncrementalMarker(
+      IncrementalMarker& state, visualization_msgs::Marker& marker);
+
  protected:
-  virtual void publishPoseGraph(const DynamicSceneGraph& graph,
+  virtual void publishPoseGraph(uint64_t timestamp_ns,
+                                const DynamicSceneGraph& graph,
                                 const kimera_pgmo::DeformationGraph& dgraph) const;
 
   virtual void publishDeformationGraphViz(const kimera_pgmo::DeformationGraph& dgraph,
                                           size_t timestamp_ns) const;
 
+  //! Publishes deformation graph markers handed off by the backend thread
+  void vizLoop();
+
  protected:
   ros::NodeHandle nh_;
   ros::Publisher mesh_mesh_edges_pub_;
   ros::Publisher pose_mesh_edges_pub_;
   ros::Publisher pose_graph_pub_;
+  //! New poses only, relative to the last full graph on pose_graph_pub_
+  ros::Publisher pose_graph_delta_pub_;
   std::unique_ptr<DsgSender> dsg_sender_;
+  //! Tracks sent poses when publishing incremental pose graphs (null otherwise)
+  std::unique_ptr<IncrementalPoseGraph> pose_graph_deltas_;
+  //! Minimum time between deformation graph visualizations
+  double deformation_graph_viz_period_s_;
+
+ private:
+  using MarkerPair = std::pair<visualization_msgs::Marker, visualization_msgs::Marker>;
+
+  mutable std::optional<uint64_t> last_viz_ns_;
+  mutable std::mutex viz_mutex_;
+  mutable std::condition_variable viz_cv_;
+  //! latest (mesh-mesh, pose-mesh) markers waiting to be published
+  mutable std::optional<MarkerPair> pending_viz_;
+  bool should_shutdown_ = false;
+  IncrementalMarker mesh_mesh_state_;
+  IncrementalMarker pose_mesh_state_;
+  //! Set from the connect callback when a marker topic gains a subscriber
+  std::atomic<bool> mesh_mesh_connected_;
+  std::atomic<bool> pose_mesh_connected_;
+  std::thread viz_thread_;
 };
 
 }  // namespace hydra
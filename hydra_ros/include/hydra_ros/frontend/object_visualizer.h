@@ -36,8 +36,12 @@
 #include <hydra/frontend/mesh_segmenter.h>
 #include <kimera_pgmo/mesh_delta.h>
 #include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
 #include <visualization_msgs/Marker.h>
 
+#include <map>
+#include <optional>
+
 #include "hydra_ros/utils/semantic_ros_publishers.h"
 
 namespace hydra {
@@ -45,6 +49,7 @@ namespace hydra {
 class ObjectVisualizer : public MeshSegmenter::Sink {
  public:
   using ObjectCloudPub = SemanticRosPublishers<uint32_t, visualization_msgs::Marker>;
+  using ObjectPointsPub = SemanticRosPublishers<uint32_t, sensor_msgs::PointCloud2>;
 
   struct Config {
     std::string module_ns = "~objects";
@@ -53,6 +58,8 @@ class ObjectVisualizer : public MeshSegmenter::Sink {
     double point_scale = 0.1;
     double point_alpha = 0.7;
     bool use_spheres = false;
+    //! Publish vertices as point clouds (on active_points and object_points)
+    bool use_pointcloud = false;
   } const config;
 
   explicit ObjectVisualizer(const Config& config);
@@ -79,10 +86,18 @@ class ObjectVisualizer : public MeshSegmenter::Sink {
                            const std::vector<size_t>& indices,
                            visualization_msgs::Marker& marker) const;
 
+  void fillPointCloud(const kimera_pgmo::MeshDelta& delta,
+                      const std::vector<size_t>& indices,
+                      sensor_msgs::PointCloud2& cloud) const;
+
  protected:
   ros::NodeHandle nh_;
   ros::Publisher active_vertices_pub_;
   std::unique_ptr<ObjectCloudPub> segmented_vertices_pub_;
+  std::unique_ptr<ObjectPointsPub> segmented_points_pub_;
+  //! Signatures of the last published vertices (topics are latched)
+  mutable std::optional<uint64_t> active_signature_;
+  mutable std::map<uint32_t, uint64_t> object_signatures_;
 
  private:
   inline static const auto registration_ =
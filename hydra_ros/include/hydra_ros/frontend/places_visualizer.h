@@ -38,6 +38,9 @@
 #include <hydra/places/gvd_voxel.h>
 #include <hydra_ros/GvdVisualizerConfig.h>
 
+#include <optional>
+
+#include "hydra_ros/visualizer/chunked_marker_cache.h"
 #include "hydra_ros/visualizer/visualizer_types.h"
 
 namespace hydra {
@@ -58,10 +61,13 @@ class PlacesVisualizer : public GvdPlaceExtractor::Sink {
     bool show_block_outlines = false;
     bool use_gvd_block_outlines = false;
     double outline_scale = 0.01;
+    //! Publish voxel slices as point clouds (on <topic>_cloud) instead of cube lists
+    bool use_pointcloud = false;
     ColormapConfig colormap;
     GvdVisualizerConfig gvd;
     VisualizerConfig graph;
     LayerConfig graph_layer;
+    ChunkedMarkerCache::Config chunks;
   };
 
   explicit PlacesVisualizer(const Config& config);
@@ -87,6 +93,13 @@ class PlacesVisualizer : public GvdPlaceExtractor::Sink {
   void visualizeGvd(const std_msgs::Header& header,
                     const places::GvdLayer& gvd) const;
 
+  void visualizeGvdClouds(const std_msgs::Header& header,
+                          const places::GvdLayer& gvd) const;
+
+  void visualizeGvdChunks(const std_msgs::Header& header,
+                          const Eigen::Vector3d& sensor_pos,
+                          const places::GvdLayer& gvd) const;
+
   void visualizeGvdGraph(const std_msgs::Header& header,
                          const places::GvdGraph& gvd_graph) const;
 
@@ -125,6 +138,14 @@ class PlacesVisualizer : public GvdPlaceExtractor::Sink {
   mutable size_t previous_spheres_;
   mutable bool published_gvd_graph_;
   mutable bool published_gvd_clusters_;
+  //! Set when the GVD or colormap config changes so that every chunk is redrawn
+  mutable bool gvd_config_changed_;
+  //! Incremented with every GVD or colormap config change
+  size_t gvd_config_version_;
+  //! Signatures of the last published GVD graph and clusters (including the config)
+  mutable std::optional<uint64_t> gvd_graph_signature_;
+  mutable std::optional<uint64_t> gvd_cluster_signature_;
+  std::map<std::string, std::unique_ptr<ChunkedMarkerCache>> chunks_;
 
   std::unique_ptr<dynamic_reconfigure::Server<GvdVisualizerConfig>> gvd_config_server_;
   std::unique_ptr<dynamic_reconfigure::Server<LayerConfig>> graph_config_server_;
@@ -36,15 +36,47 @@
 #include <hydra/common/hydra_pipeline.h>
 #include <ros/ros.h>
 
+#include <functional>
+
+#include "hydra_ros/input/bag_input_module.h"
 #include "hydra_ros/input/ros_input_module.h"
+#include "hydra_ros/input/sensor_prefetcher.h"
+#include "hydra_ros/utils/latency_tracer.h"
+#include "hydra_ros/utils/memory_monitor.h"
+#include "hydra_ros/utils/pipeline_checkpointer.h"
 
 namespace hydra {
 
 class BowSubscriber;
+class LoopClosureModule;
+
+//! Saved state to resume mapping from (as used by dsg_optimizer_node)
+struct WarmStartConfig {
+  std::string dsg_filepath = "";
+  std::string frontend_filepath = "";
+  std::string dgrf_filepath = "";
+
+  bool enabled() const { return !dsg_filepath.empty(); }
+};
+
+void declare_config(WarmStartConfig& conf);
 
 struct HydraRosConfig {
   bool enable_frontend_output = true;
   RosInputModule::Config input;
+  //! read inputs straight from a bag instead of ROS (replaces input if bag_path is set)
+  BagInputModule::Config bag_input;
+  //! resolve sensor intrinsics and extrinsics concurrently before creating the input
+  SensorPrefetcher::Config sensor_prefetch;
+  //! build loop closure detection and resolve sensors while the other modules load
+  bool parallel_init = false;
+  WarmStartConfig warm_start;
+  //! periodically save the pipeline state (disabled unless a directory is set)
+  PipelineCheckpointer::Config checkpoint;
+  //! trace inputs from their sensor stamp to the scene graph being published
+  LatencyTracer::Config tracing;
+  //! report memory used by the scene graphs and volumetric layers
+  MemoryMonitor::Config memory;
 };
 
 void declare_config(HydraRosConfig& conf);
@@ -57,16 +89,38 @@ class HydraRosPipeline : public HydraPipeline {
 
   void init() override;
 
+  bool hasBagInput() const { return bag_input_ != nullptr; }
+
+  //! Whether the bag input has been read and every queue of the pipeline is empty
+  bool inputFinished() const;
+
  protected:
   virtual void initFrontend();
   virtual void initBackend();
   virtual void initReconstruction();
   virtual void initLCD();
 
+  //! Load everything loop closure detection needs (does not touch modules_)
+  virtual std::shared_ptr<LoopClosureModule> createLCD() const;
+
+  //! Restore saved state (restored static nodes get ids the frontend never allocates)
+  virtual void warmStart(const WarmStartConfig& config);
+
+  //! Warm start config for the latest checkpoint (if resuming is enabled)
+  WarmStartConfig getResumeConfig() const;
+
+  template <typename Queue>
+  void addQueueGauge(const std::string& name, const std::shared_ptr<Queue>& queue);
+
  protected:
   const HydraRosConfig config_;
   ros::NodeHandle nh_;
   std::unique_ptr<BowSubscriber> bow_sub_;
+  PipelineCheckpointer::Ptr checkpointer_;
+  std::unique_ptr<MemoryMonitor> memory_monitor_;
+  std::vector<std::string> queue_gauges_;
+  std::vector<std::function<size_t()>> queue_sizes_;
+  BagInputModule* bag_input_ = nullptr;
 };
 
 }  // namespace hydra
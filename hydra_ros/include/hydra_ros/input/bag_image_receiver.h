@@ -0,0 +1,117 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#pragma once
+#include <config_utilities/factory.h>
+#include <hydra/input/data_receiver.h>
+
+#include <atomic>
+#include <filesystem>
+#include <limits>
+#include <thread>
+
+#include "hydra_ros/utils/backpressure.h"
+#include "hydra_ros/utils/bag_reader.h"
+
+namespace hydra {
+
+/**
+ * @brief Reads color and depth straight from a bag instead of subscribing to topics
+ *
+ * Frames are read on a separate thread that waits whenever the receiver queue is
+ * full, so the bag is read as fast as the pipeline consumes it. Once the bag is read,
+ * a packet stamped kEndOfBag is queued so the input module can tell when every frame
+ * before it has been handed on.
+ */
+class BagImageReceiver : public DataReceiver {
+ public:
+  //! Stamp of the packet that follows the last frame of the bag
+  inline static constexpr uint64_t kEndOfBag = std::numeric_limits<uint64_t>::max();
+
+  struct Config : DataReceiver::Config {
+    //! Bag to read, which also needs to be set for the bag input module
+    std::filesystem::path bag_path;
+    std::string color_topic;
+    std::string depth_topic;
+    //! Offset from the start of the bag to the first frame (disabled if negative)
+    double start = -1.0;
+    //! Amount of the bag to read (disabled if negative)
+    double duration = -1.0;
+    bool color_compressed = false;
+    //! Match color and depth by stamp (exact first) instead of approximate time
+    bool use_stamp_sync = false;
+    //! Largest stamp difference between color and depth that the stamp sync accepts
+    double sync_tolerance_s = 0.01;
+    //! Packets waiting for the input module before reading pauses
+    size_t max_queue_size = 2;
+  };
+
+  BagImageReceiver(const Config& config, size_t sensor_id);
+
+  virtual ~BagImageReceiver();
+
+  //! Whether every frame of the bag has been read
+  bool finished() const { return finished_; }
+
+  //! Called by the input module after taking a packet from the queue
+  void notifyConsumed() { backpressure_.notify(); }
+
+ public:
+  const Config config;
+
+ protected:
+  bool initImpl() override;
+
+ private:
+  void read();
+
+  void callback(const sensor_msgs::Image::ConstPtr& color,
+                const sensor_msgs::Image::ConstPtr& depth);
+
+  std::atomic<bool> should_stop_;
+  std::atomic<bool> finished_;
+  Backpressure backpressure_;
+  std::thread read_thread_;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<DataReceiver,
+                                     BagImageReceiver,
+                                     BagImageReceiver::Config,
+                                     size_t>("BagImageReceiver");
+};
+
+void declare_config(BagImageReceiver::Config& config);
+
+}  // namespace hydra
@@ -0,0 +1,105 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#pragma once
+#include <hydra/input/input_module.h>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "hydra_ros/utils/backpressure.h"
+
+namespace hydra {
+
+class BagImageReceiver;
+class PoseCache;
+
+/**
+ * @brief Input module that reads body poses from the tf messages of a bag
+ *
+ * Intended for BagImageReceiver inputs: no poses are read from ROS, and packets are
+ * only handed to reconstruction once there is room in its queue, so a bag is
+ * processed as fast as the pipeline allows. Reconstruction reports its progress
+ * through notifyProgress() to wake the input thread. The node still reads its
+ * parameters from the ROS parameter server, so a roscore has to be running.
+ */
+class BagInputModule : public InputModule {
+ public:
+  using OutputQueue = InputQueue<InputPacket::Ptr>;
+  struct Config : InputModule::Config {
+    //! Bag to read body poses from
+    std::filesystem::path bag_path;
+    //! Directory to cache extracted bag metadata in (no disk cache if empty)
+    std::filesystem::path metadata_cache_dir;
+    //! Packets waiting for reconstruction before the input module waits
+    size_t max_output_queue_size = 2;
+  } const config;
+
+  BagInputModule(const Config& config, const OutputQueue::Ptr& output_queue);
+
+  virtual ~BagInputModule();
+
+  void stop() override;
+
+  std::string printInfo() const override;
+
+  //! Whether every receiver read its bag and all packets reached reconstruction
+  bool finished() const;
+
+  //! Called by reconstruction after taking packets from its queue
+  void notifyProgress();
+
+ protected:
+  PoseStatus getBodyPose(uint64_t timestamp_ns) override;
+
+ protected:
+  OutputQueue::Ptr output_queue_;
+  std::unique_ptr<PoseCache> pose_cache_;
+  Backpressure backpressure_;
+  std::vector<BagImageReceiver*> bag_receivers_;
+  //! End of bag packets that reached the input thread; every packet of a receiver
+  //! was handed on once its end of bag packet arrives
+  std::atomic<size_t> num_finished_receivers_;
+
+  inline static const auto registration_ = config::
+      RegistrationWithConfig<InputModule, BagInputModule, Config, OutputQueue::Ptr>(
+          "BagInput");
+};
+
+void declare_config(BagInputModule::Config& config);
+
+}  // namespace hydra
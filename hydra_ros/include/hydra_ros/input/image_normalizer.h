@@ -0,0 +1,86 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Single-pass normalization of incoming depth and label images
+ *
+ * Reads directly from a view of the message pixels and writes the packet buffers:
+ * depth is converted to float meters with out-of-range values set to zero, and labels
+ * are remapped through a lookup table into 32-bit integers. The inner loops are kept
+ * branch-free so that they vectorize.
+ */
+class ImageNormalizer {
+ public:
+  struct Config {
+    //! Convert depth to CV_32FC1 meters (instead of copying the source encoding)
+    bool normalize_depth = false;
+    //! Scale applied to integer depth (e.g., 16UC1 millimeters)
+    float integer_depth_scale = 1.0e-3f;
+    //! Depth below this is marked invalid
+    float min_depth_m = 0.0f;
+    //! Depth above this is marked invalid (disabled if non-positive)
+    float max_depth_m = -1.0f;
+    //! Label remapping <input, output>; labels not in the map are kept as is
+    std::map<int32_t, int32_t> label_remapping;
+  } const config;
+
+  explicit ImageNormalizer(const Config& config);
+
+  bool remapsLabels() const { return !lut_.empty(); }
+
+  //! Convert CV_16UC1 or CV_32FC1 depth; returns false for other encodings
+  bool normalizeDepth(const cv::Mat& raw, cv::Mat& depth) const;
+
+  //! Remap CV_8UC1, CV_16UC1 or CV_32SC1 labels; returns false for other encodings
+  bool remapLabels(const cv::Mat& raw, cv::Mat& labels) const;
+
+ private:
+  template <typename T>
+  void remapRows(const cv::Mat& raw, cv::Mat& labels) const;
+
+  std::vector<int32_t> lut_;
+};
+
+void declare_config(ImageNormalizer::Config& config);
+
+}  // namespace hydra
@@ -42,6 +42,12 @@
 #include <ros/ros.h>
 #include <sensor_msgs/Image.h>
 
+#include "hydra_ros/input/image_normalizer.h"
+#include "hydra_ros/utils/mat_pool.h"
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/ordered_worker_pool.h"
+#include "hydra_ros/utils/stamp_synchronizer.h"
+
 namespace hydra {
 
 struct ImageSubscriber {
@@ -61,10 +67,27 @@ class ImageReceiver : public DataReceiver {
   using SyncPolicy = message_filters::sync_policies::
       ApproximateTime<sensor_msgs::Image, sensor_msgs::Image, sensor_msgs::Image>;
   using Synchronizer = message_filters::Synchronizer<SyncPolicy>;
+  using StampSync = StampSynchronizer<sensor_msgs::Image::ConstPtr, 3>;
 
   struct Config : DataReceiver::Config {
     std::string ns = "~";
+    //! Image topics relative to ns (one receiver per camera of a multi-camera rig)
+    std::string color_topic = "rgb/image_raw";
+    std::string depth_topic = "depth_registered/image_rect";
+    std::string label_topic = "semantic/image_raw";
     size_t queue_size = 10;
+    //! Match images by stamp (exact first) instead of the approximate time policy
+    bool use_stamp_sync = false;
+    //! Largest stamp difference to the color image that the stamp sync accepts
+    double sync_tolerance_s = 0.01;
+    //! Idle image buffers kept for reuse by later packets (0 allocates every packet)
+    size_t buffer_pool_size = 0;
+    //! Threads serving a callback queue for this receiver (0 uses the global queue)
+    size_t num_callback_threads = 0;
+    //! Threads converting synced images (0 converts in the subscriber callback)
+    size_t num_conversion_threads = 0;
+    //! Depth conversion / range masking and label remapping done on receipt
+    ImageNormalizer::Config normalization;
   };
 
   ImageReceiver(const Config& config, size_t sensor_id);
@@ -78,15 +101,36 @@ class ImageReceiver : public DataReceiver {
   bool initImpl() override;
 
  private:
+  struct SyncedImages {
+    sensor_msgs::Image::ConstPtr color;
+    sensor_msgs::Image::ConstPtr depth;
+    sensor_msgs::Image::ConstPtr labels;
+  };
+
+  using ConversionPool = OrderedWorkerPool<SyncedImages, InputPacket::Ptr>;
+
   void callback(const sensor_msgs::Image::ConstPtr& color,
                 const sensor_msgs::Image::ConstPtr& depth,
                 const sensor_msgs::Image::ConstPtr& labels);
 
+  InputPacket::Ptr convert(const SyncedImages& images) const;
+
+  cv::Mat getImage(const sensor_msgs::Image::ConstPtr& msg) const;
+
+  cv::Mat getDepth(const sensor_msgs::Image::ConstPtr& msg) const;
+
+  cv::Mat getLabels(const sensor_msgs::Image::ConstPtr& msg) const;
+
   ros::NodeHandle nh_;
+  const ImageNormalizer normalizer_;
+  std::unique_ptr<CallbackThreads> callback_threads_;
   ImageSubscriber color_sub_;
   ImageSubscriber depth_sub_;
   ImageSubscriber label_sub_;
   std::unique_ptr<Synchronizer> synchronizer_;
+  std::unique_ptr<StampSync> stamp_sync_;
+  MatPool::Ptr pool_;
+  std::unique_ptr<ConversionPool> conversion_pool_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DataReceiver,
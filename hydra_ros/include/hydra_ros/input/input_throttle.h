@@ -0,0 +1,101 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Geometry>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace hydra {
+
+/**
+ * @brief Load-dependent frame skipping for the input module
+ *
+ * The system is overloaded when the end-to-end latency of incoming frames exceeds the
+ * target or the output queue is backed up. While overloaded, frames with little
+ * motion relative to the last kept frame are skipped first; frames with enough new
+ * motion are only skipped when the latency is twice the target. A bounded number of
+ * consecutive skips keeps the map from starving.
+ */
+class InputThrottle {
+ public:
+  struct Config {
+    bool enable = false;
+    //! End-to-end latency (now - frame stamp) to hold
+    double target_latency_s = 0.5;
+    //! Output queue depth at which frames start being skipped (0 disables)
+    size_t max_queue_size = 5;
+    //! Translation since the last kept frame that counts as significant motion
+    double min_translation_m = 0.1;
+    //! Rotation since the last kept frame that counts as significant motion
+    double min_rotation_rad = 0.1;
+    //! Always keep a frame after this many consecutive skips
+    size_t max_consecutive_skips = 5;
+  } const config;
+
+  enum class Decision {
+    KEEP,
+    SKIP_LATENCY,
+    SKIP_QUEUE,
+  };
+
+  explicit InputThrottle(const Config& config);
+
+  Decision update(double latency_s,
+                  size_t queue_size,
+                  const Eigen::Vector3d& position,
+                  const Eigen::Quaterniond& rotation);
+
+  size_t numKept() const { return num_kept_; }
+
+  size_t numSkippedLatency() const { return num_skipped_latency_; }
+
+  size_t numSkippedQueue() const { return num_skipped_queue_; }
+
+ private:
+  bool hasMoved(const Eigen::Vector3d& position,
+                const Eigen::Quaterniond& rotation) const;
+
+  std::optional<Eigen::Vector3d> last_position_;
+  Eigen::Quaterniond last_rotation_;
+  size_t consecutive_skips_ = 0;
+  size_t num_kept_ = 0;
+  size_t num_skipped_latency_ = 0;
+  size_t num_skipped_queue_ = 0;
+};
+
+void declare_config(InputThrottle::Config& config);
+
+}  // namespace hydra
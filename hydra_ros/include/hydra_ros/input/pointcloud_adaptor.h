@@ -36,7 +36,10 @@
 #include <hydra/input/sensor_input_packet.h>
 #include <sensor_msgs/PointCloud2.h>
 
+#include <Eigen/Geometry>
 #include <functional>
+#include <optional>
+#include <vector>
 
 namespace hydra {
 
@@ -62,8 +65,76 @@ class PointcloudAdaptor {
   std::function<cv::Vec3b(const uint8_t*)> color_parser_;
 };
 
+/**
+ * @brief Common field layouts that can be converted without per-field dispatch
+ *
+ * A layout is only "packed" if x, y and z are consecutive little-endian float32 fields.
+ * Color and label fields are optional and may be located anywhere in the point.
+ */
+struct PointcloudLayout {
+  bool packed_xyz = false;
+  uint32_t xyz_offset = 0;
+  std::optional<uint32_t> color_offset;
+  std::optional<uint32_t> label_offset;
+  uint8_t label_datatype = 0;
+
+  static PointcloudLayout fromCloud(const sensor_msgs::PointCloud2& cloud);
+
+  /**
+   * @brief Layout of a cloud, only recomputed when its fields change
+   *
+   * Streams keep the same fields for every message, so the last layout computed on
+   * the calling thread is reused if the field names, offsets, types and counts and
+   * the byte order all match.
+   */
+  static PointcloudLayout cached(const sensor_msgs::PointCloud2& cloud);
+};
+
+/**
+ * @brief Parse a cloud into an organized packet with the same dimensions
+ *
+ * If target_T_cloud is provided, points are transformed while parsing: each row is
+ * transformed in fixed-size batches right after it is copied (while it is still in
+ * cache), so the cloud is only traversed once. Invalid points are kept to preserve the
+ * organization (see PointcloudFilter::compact for packets of only valid points).
+ */
 bool fillPointcloudPacket(const sensor_msgs::PointCloud2& msg,
                           CloudInputPacket& packet,
-                          bool labels_required);
+                          bool labels_required,
+                          const Eigen::Isometry3f* target_T_cloud = nullptr);
+
+//! Point rejection and downsampling applied while parsing a cloud
+struct PointcloudFilter {
+  //! Points closer than this to the cloud origin are dropped
+  double min_range = 0.0;
+  //! Points further than this from the cloud origin are dropped (disabled if <= 0)
+  double max_range = -1.0;
+  //! Keep only the first point that falls in each voxel (disabled if <= 0)
+  double voxel_size = -1.0;
+  //! Only keep valid returns (finite and not at the cloud origin), even if unfiltered
+  bool compact = false;
+
+  bool enabled() const {
+    return compact || min_range > 0.0 || max_range > 0.0 || voxel_size > 0.0;
+  }
+};
+
+void declare_config(PointcloudFilter& config);
+
+/**
+ * @brief Parse the points that pass the filter into an unorganized (1 x N) packet
+ *
+ * Non-finite points are always dropped. Range checks and voxel hashing happen per
+ * point as the fields are parsed, so rejected points are never copied. Filtering uses
+ * the original coordinates and only the kept points are transformed by target_T_cloud
+ * (if provided). If source_indices is provided, it is filled with the index (i.e.,
+ * row * width + col) of each kept point in the original cloud.
+ */
+bool fillFilteredPointcloudPacket(const sensor_msgs::PointCloud2& msg,
+                                  CloudInputPacket& packet,
+                                  const PointcloudFilter& filter,
+                                  bool labels_required,
+                                  const Eigen::Isometry3f* target_T_cloud = nullptr,
+                                  std::vector<uint32_t>* source_indices = nullptr);
 
 }  // namespace hydra
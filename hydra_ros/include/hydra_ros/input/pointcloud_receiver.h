@@ -37,6 +37,14 @@
 #include <hydra/input/data_receiver.h>
 #include <ros/ros.h>
 #include <sensor_msgs/PointCloud2.h>
+#include <tf2_ros/transform_listener.h>
+
+#include <map>
+#include <mutex>
+
+#include "hydra_ros/input/pointcloud_adaptor.h"
+#include "hydra_ros/utils/mat_pool.h"
+#include "hydra_ros/utils/node_utilities.h"
 
 namespace hydra {
 
@@ -45,6 +53,15 @@ class PointcloudReceiver : public DataReceiver {
   struct Config : DataReceiver::Config {
     std::string ns = "~";
     size_t queue_size = 10;
+    //! Threads serving a callback queue for this receiver (0 uses the global queue)
+    size_t num_callback_threads = 0;
+    //! Idle packet buffers kept for reuse by later packets (0 allocates every packet)
+    size_t buffer_pool_size = 0;
+    //! Range cropping and voxel downsampling applied while parsing clouds
+    PointcloudFilter filter;
+    //! Frame of the sensor extrinsics: clouds in other frames are transformed into it
+    //! while parsing (disabled if empty)
+    std::string sensor_frame = "";
   };
 
   PointcloudReceiver(const Config& config, size_t sensor_id);
@@ -60,8 +77,17 @@ class PointcloudReceiver : public DataReceiver {
  private:
   void callback(const sensor_msgs::PointCloud2& cloud);
 
+  //! Cached sensor_T_cloud for the frame (or nullptr if no transform is needed)
+  const Eigen::Isometry3f* getExtrinsics(const std::string& frame_id, bool& valid);
+
   ros::NodeHandle nh_;
+  std::unique_ptr<CallbackThreads> callback_threads_;
   ros::Subscriber cloud_sub_;
+  MatPool::Ptr pool_;
+  std::unique_ptr<tf2_ros::Buffer> tf_buffer_;
+  std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
+  std::mutex extrinsics_mutex_;
+  std::map<std::string, Eigen::Isometry3f> extrinsics_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DataReceiver,
@@ -70,4 +96,6 @@ class PointcloudReceiver : public DataReceiver {
                                      size_t>("PointcloudReceiver");
 };
 
+void declare_config(PointcloudReceiver::Config& config);
+
 }  // namespace hydra
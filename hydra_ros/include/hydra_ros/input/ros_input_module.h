@@ -34,9 +34,14 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <hydra/input/input_module.h>
+#include <nav_msgs/Odometry.h>
 #include <ros/ros.h>
 #include <tf2_ros/transform_listener.h>
 
+#include "hydra_ros/input/input_throttle.h"
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/odometry_pose_buffer.h"
+
 namespace hydra {
 
 class RosInputModule : public InputModule {
@@ -55,6 +60,17 @@ class RosInputModule : public InputModule {
     int tf_max_tries = 5;
     //! Logging verbosity of tf lookup process
     int tf_verbosity = 3;
+    //! Wait on tf2 callbacks (deadline of tf_max_tries * tf_wait_duration_s)
+    bool tf_use_callbacks = false;
+    //! Maximum age in seconds of a stamp relative to the latest transform before the
+    //! callback lookup gives up early (only bounded by tf_buffer_size_s if <= 0)
+    double tf_max_age_s = 0.0;
+    //! Odometry topic to read body poses from instead of tf (unused if empty)
+    std::string odometry_topic = "";
+    //! Number of odometry samples to keep for interpolation
+    size_t odometry_buffer_size = 2000;
+    //! Skip frames when reconstruction cannot keep up
+    InputThrottle::Config throttle;
   } const config;
 
   RosInputModule(const Config& config, const OutputQueue::Ptr& output_queue);
@@ -66,12 +82,32 @@ class RosInputModule : public InputModule {
  protected:
   PoseStatus getBodyPose(uint64_t timestamp_ns) override;
 
+  PoseStatus lookupBodyPose(uint64_t timestamp_ns);
+
+  bool shouldSkip(uint64_t timestamp_ns, const PoseStatus& pose);
+
+  //! Drop the packet for a stamp whose pose was found but that the throttle rejected
+  PoseStatus skipInput(uint64_t timestamp_ns);
+
+  PoseStatus getOdometryPose(uint64_t timestamp_ns,
+                             const std::optional<size_t>& max_tries);
+
+  void handleOdometry(const nav_msgs::Odometry& msg);
+
  protected:
   ros::NodeHandle nh_;
+  OutputQueue::Ptr output_queue_;
+  InputThrottle throttle_;
   bool have_first_pose_;
   std::unique_ptr<tf2_ros::Buffer> buffer_;
   std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
 
+  bool checked_odometry_frames_;
+  std::unique_ptr<OdometryPoseBuffer> odometry_buffer_;
+  ros::NodeHandle odometry_nh_;
+  std::unique_ptr<CallbackThreads> odometry_threads_;
+  ros::Subscriber odometry_sub_;
+
   inline static const auto registration_ = config::
       RegistrationWithConfig<InputModule, RosInputModule, Config, OutputQueue::Ptr>(
           "RosInput");
@@ -57,6 +57,8 @@ struct RosbagExtrinsics : public SensorExtrinsics {
   struct Config {
     std::string sensor_frame = "";
     std::filesystem::path bag_path;
+    //! directory to cache extracted bag metadata in (no disk cache if empty)
+    std::filesystem::path metadata_cache_dir;
   };
 
   explicit RosbagExtrinsics(const Config& config);
@@ -85,6 +87,8 @@ struct RosbagCameraIntrinsics {
   struct Config : Sensor::Config {
     std::string topic = "";
     std::filesystem::path bag_path;
+    //! directory to cache extracted bag metadata in (no disk cache if empty)
+    std::filesystem::path metadata_cache_dir;
   };
 
   static Camera::Config makeCameraConfig(const YAML::Node& data, const Config& config);
@@ -0,0 +1,111 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/input/input_module.h>
+#include <ros/ros.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <tf2_ros/transform_listener.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "hydra_ros/utils/node_utilities.h"
+
+namespace hydra {
+
+/**
+ * @brief Resolves camera info and extrinsics for every configured sensor at once
+ *
+ * Sensors are constructed one after another and each used to wait for its own camera
+ * info and transform. The prefetcher issues all of these requests before the sensors
+ * are constructed so that the individual waits overlap and share one overall deadline.
+ * Sensors that were not prefetched (or not resolved by the deadline) fall back to
+ * resolving their information directly.
+ */
+class SensorPrefetcher {
+ public:
+  struct Config {
+    bool enable = true;
+    //! time budget for resolving every sensor before falling back to blocking waits
+    double timeout_s = 10.0;
+  };
+
+  static SensorPrefetcher& instance();
+
+  /**
+   * @brief Issue requests for the sensors of the input receivers
+   *
+   * Looks for camera_info intrinsics and ros extrinsics in the sensor of every entry
+   * of `receivers` below the namespace.
+   */
+  void start(const Config& config, const ros::NodeHandle& nh);
+
+  //! Drop all subscriptions and cached results
+  void stop();
+
+  //! Camera info for a resolved topic (std::nullopt if not prefetched or timed out)
+  std::optional<sensor_msgs::CameraInfo::ConstPtr> getCameraInfo(
+      const std::string& resolved_topic);
+
+  //! Robot to sensor transform (std::nullopt if not prefetched or timed out)
+  std::optional<PoseStatus> getExtrinsics(const std::string& sensor_frame);
+
+ private:
+  SensorPrefetcher() = default;
+
+  void handleCameraInfo(const std::string& topic,
+                        const sensor_msgs::CameraInfo::ConstPtr& msg);
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::chrono::steady_clock::time_point deadline_;
+
+  ros::NodeHandle nh_;
+  std::unique_ptr<CallbackThreads> threads_;
+  std::map<std::string, ros::Subscriber> info_subs_;
+  std::map<std::string, sensor_msgs::CameraInfo::ConstPtr> infos_;
+
+  std::unique_ptr<tf2_ros::Buffer> buffer_;
+  std::unique_ptr<tf2_ros::TransformListener> listener_;
+  std::map<std::string, std::shared_future<PoseStatus>> extrinsics_;
+};
+
+void declare_config(SensorPrefetcher::Config& config);
+
+}  // namespace hydra
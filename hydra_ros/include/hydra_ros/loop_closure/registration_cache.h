@@ -0,0 +1,109 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <tuple>
+
+namespace hydra::lcd {
+
+/**
+ * @brief LRU cache of visual registration outcomes between two frames
+ *
+ * Both successful transforms and failures are cached so that repeated candidates
+ * can be resolved without another registration request. Entries expire after a
+ * configurable time-to-live (separately for successes and failures).
+ */
+class RegistrationCache {
+ public:
+  struct Config {
+    //! Maximum number of cached frame pairs (0 disables the cache)
+    size_t max_size = 1000;
+    //! Lifetime of successful registrations (negative never expires)
+    double success_ttl_s = -1.0;
+    //! Lifetime of failed registrations (negative never expires)
+    double failure_ttl_s = 30.0;
+  } const config;
+
+  struct Key {
+    size_t query_robot;
+    size_t query;
+    size_t match_robot;
+    size_t match;
+
+    bool operator<(const Key& other) const {
+      return std::tie(query_robot, query, match_robot, match) <
+             std::tie(other.query_robot, other.query, other.match_robot, other.match);
+    }
+  };
+
+  struct Entry {
+    bool valid = false;
+    Eigen::Vector3d match_t_query = Eigen::Vector3d::Zero();
+    Eigen::Quaterniond match_q_query = Eigen::Quaterniond::Identity();
+  };
+
+  explicit RegistrationCache(const Config& config);
+
+  //! Get a non-expired entry for the pair (and mark it as recently used)
+  std::optional<Entry> get(const Key& key, double now_s);
+
+  void put(const Key& key, const Entry& entry, double now_s);
+
+  size_t size() const;
+
+  void clear();
+
+ private:
+  struct Item {
+    Key key;
+    Entry entry;
+    double stamp_s;
+  };
+
+  bool expired(const Item& item, double now_s) const;
+
+  mutable std::mutex mutex_;
+  std::list<Item> items_;
+  std::map<Key, std::list<Item>::iterator> lookup_;
+};
+
+void declare_config(RegistrationCache::Config& config);
+
+}  // namespace hydra::lcd
@@ -34,17 +34,130 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <hydra/loop_closure/registration.h>
+#include <pose_graph_tools_msgs/LcdFrameRegistration.h>
+#include <ros/ros.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "hydra_ros/loop_closure/registration_cache.h"
 
 namespace hydra::lcd {
 
+/**
+ * @brief Limits how often a missing service is looked up
+ *
+ * The delay between lookups starts at the initial backoff and doubles after every
+ * failure up to the maximum. All methods are thread-safe.
+ */
+class ServiceBackoff {
+ public:
+  ServiceBackoff(double initial_s, double max_s);
+
+  //! Whether the service should be looked up at the given time
+  bool shouldCheck(double now_s) const;
+
+  void succeeded();
+
+  void failed(double now_s);
+
+ private:
+  const double initial_s_;
+  const double max_s_;
+  mutable std::mutex mutex_;
+  double delay_s_ = 0.0;
+  double next_check_s_ = 0.0;
+};
+
+/**
+ * @brief Agent-level registration via the external frame_registration service
+ *
+ * Requests go through persistent service clients and the service is only looked up
+ * (with a backoff) when a client has to be created. In async mode, requests are
+ * handled by a pool of workers so that several query/match pairs are in flight at
+ * once: solve() waits (up to async_timeout_s) only for its own candidate while
+ * requests submitted through solveAsync() keep running on the other workers. The
+ * LCD module only consumes solutions returned from solve() and never installs the
+ * result callback, so a candidate whose request outlives the timeout is reported as
+ * failed (its result is still returned if the same pair is asked for again).
+ */
 struct DsgAgentSolver : DsgRegistrationSolver {
-  DsgAgentSolver() = default;
+  using ResultCallback = std::function<void(const RegistrationSolution&)>;
+
+  struct Config {
+    std::string service_name = "frame_registration";
+    //! Pipeline requests through worker threads instead of calling the service in
+    //! solve()
+    bool async = false;
+    //! Number of concurrent requests in async mode
+    size_t num_workers = 2;
+    //! Longest time solve() waits for its own request in async mode
+    double async_timeout_s = 5.0;
+    //! Maximum number of requests waiting for a worker (oldest dropped first)
+    size_t max_pending = 20;
+    //! Delay before looking up a missing service again (doubles on every failure)
+    double service_backoff_s = 1.0;
+    //! Upper bound on the lookup delay
+    double max_service_backoff_s = 30.0;
+    //! Outcomes of previous requests for repeated frame pairs
+    RegistrationCache::Config cache;
+  } const config;
 
-  virtual ~DsgAgentSolver() = default;
+  DsgAgentSolver();
+
+  explicit DsgAgentSolver(const Config& config);
+
+  virtual ~DsgAgentSolver();
 
   RegistrationSolution solve(const DynamicSceneGraph& dsg,
                              const DsgRegistrationInput& match,
                              NodeId query_agent_id) const override;
+
+  //! Submit a registration request without waiting for the result
+  std::future<RegistrationSolution> solveAsync(const DynamicSceneGraph& dsg,
+                                               const DsgRegistrationInput& match) const;
+
+  //! Called from a worker thread once an async request finishes
+  void setResultCallback(const ResultCallback& callback);
+
+ private:
+  struct Request {
+    NodeId query_id;
+    NodeId match_id;
+    uint64_t timestamp_ns;
+    pose_graph_tools_msgs::LcdFrameRegistration srv;
+    std::promise<RegistrationSolution> promise;
+  };
+
+  std::optional<Request> makeRequest(const DynamicSceneGraph& dsg,
+                                     const DsgRegistrationInput& match) const;
+
+  RegistrationSolution call(ros::ServiceClient& client, Request& request) const;
+
+  void spinWorker();
+
+  mutable ros::ServiceClient client_;
+  mutable ServiceBackoff backoff_;
+  mutable RegistrationCache cache_;
+  ResultCallback callback_;
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cv_;
+  bool should_shutdown_ = false;
+  mutable std::deque<Request> pending_;
+  //! async results by (query, match) so that solve() only returns its own candidate
+  mutable std::map<std::pair<NodeId, NodeId>, std::future<RegistrationSolution>>
+      in_flight_;
+  std::vector<std::thread> workers_;
 };
 
+void declare_config(DsgAgentSolver::Config& config);
+
 }  // namespace hydra::lcd
@@ -53,7 +53,7 @@
 #include <ros/node_handle.h>
 #include <ros/subscriber.h>
 
-#include <mutex>
+#include "hydra_ros/utils/spsc_ring_buffer.h"
 
 namespace hydra {
 
@@ -68,10 +68,15 @@ class RosPoseGraphTracker : public PoseGraphTracker {
     std::string ns = "~";
     //! Size of the odometry subscriber queue.
     size_t queue_size = 1000;
+    //! Pose graphs that can be pending before the callback blocks (or drops)
+    size_t max_pending = 1000;
+    //! What to do when full: "block", "drop_oldest" or "drop_newest". Incremental
+    //! pose graphs cannot be recovered once dropped, so only "block" is lossless
+    std::string drop_policy = "block";
   } const config;
 
   explicit RosPoseGraphTracker(const Config& config);
-  virtual ~RosPoseGraphTracker() = default;
+  virtual ~RosPoseGraphTracker();
 
   PoseGraphPacket update(uint64_t timestamp,
                          const Eigen::Isometry3d& world_T_body) override;
@@ -84,9 +89,9 @@ class RosPoseGraphTracker : public PoseGraphTracker {
   ros::Subscriber odom_sub_;
   ros::Subscriber prior_sub_;
 
-  std::mutex mutex_;
-  std::vector<pose_graph_tools::PoseGraph::ConstPtr> pose_graphs_;
-  pose_graph_tools::PoseGraph::ConstPtr external_priors_;
+  // callbacks for each subscriber are serialized, so each buffer has one producer
+  SpscRingBuffer<pose_graph_tools::PoseGraph::ConstPtr> pose_graphs_;
+  SpscRingBuffer<pose_graph_tools::PoseGraph::ConstPtr> external_priors_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<PoseGraphTracker,
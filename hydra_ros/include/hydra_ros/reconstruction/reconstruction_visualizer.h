@@ -35,13 +35,23 @@
 #pragma once
 #include <hydra/reconstruction/reconstruction_module.h>
 #include <ros/ros.h>
+#include <visualization_msgs/Marker.h>
 
+#include <optional>
+
+#include "hydra_ros/visualizer/chunked_marker_cache.h"
 #include "hydra_ros/visualizer/visualizer_types.h"
 
 namespace hydra {
 
 class MarkerGroupPub;
 
+//! Block and voxel z-index of the TSDF slice
+struct TsdfSlice {
+  int block_z;
+  int voxel_z;
+};
+
 class ReconstructionVisualizer : public ReconstructionModule::Sink {
  public:
   struct Config {
@@ -54,9 +64,15 @@ class ReconstructionVisualizer : public ReconstructionModule::Sink {
     bool use_relative_height = true;
     double slice_height = 0.0;
     double min_observation_weight = 1.0e-5;
+    //! Publish slices as point clouds (on <topic>_cloud) instead of cube lists
+    bool use_pointcloud = false;
     ColormapConfig colors;
+    ChunkedMarkerCache::Config chunks;
   };
 
+  using ColorFunction =
+      std::function<std_msgs::ColorRGBA(const Config&, const TsdfVoxel&)>;
+
   explicit ReconstructionVisualizer(const Config& config);
 
   virtual ~ReconstructionVisualizer();
@@ -69,9 +85,22 @@ class ReconstructionVisualizer : public ReconstructionModule::Sink {
             const ReconstructionOutput& msg) const override;
 
  protected:
+  void publishChunks(const std::string& topic,
+                     const std_msgs::Header& header,
+                     const TsdfLayer& tsdf,
+                     const Eigen::Isometry3d& world_T_sensor,
+                     const TsdfSlice& slice,
+                     const ColorFunction& color_func,
+                     const std::string& ns,
+                     ChunkedMarkerCache& chunks,
+                     bool force) const;
+
   Config config_;
   ros::NodeHandle nh_;
   std::unique_ptr<MarkerGroupPub> pubs_;
+  std::unique_ptr<ChunkedMarkerCache> distance_chunks_;
+  std::unique_ptr<ChunkedMarkerCache> weight_chunks_;
+  mutable std::optional<TsdfSlice> last_slice_;
 
  private:
   inline static const auto registration_ =
@@ -82,4 +111,33 @@ class ReconstructionVisualizer : public ReconstructionModule::Sink {
 
 void declare_config(ReconstructionVisualizer::Config& config);
 
+using TsdfColorFunction = ReconstructionVisualizer::ColorFunction;
+
+std_msgs::ColorRGBA colorVoxelByDist(const ReconstructionVisualizer::Config& config,
+                                     const TsdfVoxel& voxel);
+
+std_msgs::ColorRGBA colorVoxelByWeight(const ReconstructionVisualizer::Config& config,
+                                       const TsdfVoxel& voxel);
+
+//! Slice at the configured height (optionally relative to the sensor)
+TsdfSlice getTsdfSlice(const ReconstructionVisualizer::Config& config,
+                       const TsdfLayer& layer,
+                       const Eigen::Isometry3d& world_T_sensor);
+
+//! Add the observed voxels of a block that lie in the slice to a cube list
+void addTsdfSliceVoxels(const ReconstructionVisualizer::Config& config,
+                        const TsdfSlice& slice,
+                        const TsdfBlock& block,
+                        const TsdfColorFunction& color_func,
+                        visualization_msgs::Marker& msg);
+
+//! Cube list of the observed voxels in the TSDF slice at the configured height
+visualization_msgs::Marker makeTsdfMarker(
+    const ReconstructionVisualizer::Config& config,
+    const std_msgs::Header& header,
+    const TsdfLayer& layer,
+    const Eigen::Isometry3d& world_T_sensor,
+    const TsdfColorFunction& color_func,
+    const std::string& ns);
+
 }  // namespace hydra
@@ -0,0 +1,98 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+namespace hydra {
+
+/**
+ * @brief Blocks a producer until the queue it feeds has room
+ *
+ * The consumer calls notify() after taking something from the queue, which wakes the
+ * producer right away. Consumers that cannot report every item are still picked up
+ * after `recheck_period`.
+ */
+class Backpressure {
+ public:
+  using SizeFunction = std::function<size_t()>;
+
+  Backpressure(const SizeFunction& size,
+               size_t max_size,
+               std::chrono::milliseconds recheck_period = std::chrono::milliseconds(10))
+      : size_(size), max_size_(max_size), recheck_period_(recheck_period) {}
+
+  //! Wait until the queue has room; returns false if stopped while waiting
+  bool wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopped_ && size_() >= max_size_) {
+      cv_.wait_for(lock, recheck_period_);
+    }
+
+    return !stopped_;
+  }
+
+  //! Wake the producer to check the queue again
+  void notify() {
+    {  // the lock keeps a waiting producer from missing the notification
+      std::lock_guard<std::mutex> lock(mutex_);
+    }
+
+    cv_.notify_all();
+  }
+
+  //! Release the producer for good
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+
+    cv_.notify_all();
+  }
+
+ private:
+  const SizeFunction size_;
+  const size_t max_size_;
+  const std::chrono::milliseconds recheck_period_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+};
+
+}  // namespace hydra
@@ -0,0 +1,103 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <geometry_msgs/TransformStamped.h>
+#include <ros/time.h>
+#include <sensor_msgs/CameraInfo.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace rosbag {
+class Bag;
+}
+
+namespace hydra {
+
+/**
+ * @brief TF and camera info extracted from a bag in a single pass.
+ *
+ * Metadata is kept for every bag the process has loaded and shared between all of its
+ * consumers. It can also be written to a cache directory, so that later runs do not
+ * need to scan the bag at all.
+ */
+class BagMetadata {
+ public:
+  using Ptr = std::shared_ptr<const BagMetadata>;
+  using Transforms = std::vector<geometry_msgs::TransformStamped>;
+
+  //! Extract metadata directly from an open bag (no caching)
+  explicit BagMetadata(const rosbag::Bag& bag);
+
+  /**
+   * @brief Get the metadata for a bag
+   *
+   * Returns the metadata already loaded by this process if possible, then tries the
+   * on-disk cache in cache_dir (if not empty) and finally scans the bag.
+   */
+  static Ptr get(const std::filesystem::path& bag_path,
+                 const std::filesystem::path& cache_dir = {});
+
+  //! Drop the metadata kept for every bag loaded by this process
+  static void clearLoaded();
+
+  //! Path to the on-disk cache for a bag inside cache_dir
+  static std::filesystem::path cachePath(const std::filesystem::path& bag_path,
+                                         const std::filesystem::path& cache_dir);
+
+  bool save(const std::filesystem::path& filepath) const;
+
+  static std::unique_ptr<BagMetadata> load(const std::filesystem::path& filepath);
+
+  //! First camera info on the topic (nullptr if the topic does not exist)
+  const sensor_msgs::CameraInfo* cameraInfo(const std::string& topic) const;
+
+  //! Transforms from /tf, in bag order
+  Transforms transforms;
+  //! Transforms from /tf_static, in bag order
+  Transforms static_transforms;
+  //! First camera info on every CameraInfo topic
+  std::map<std::string, sensor_msgs::CameraInfo> camera_infos;
+  //! Time range spanned by the tf messages
+  ros::Time tf_begin;
+  ros::Time tf_end;
+
+ private:
+  BagMetadata() = default;
+};
+
+}  // namespace hydra
@@ -32,11 +32,16 @@
  * Government is authorized to reproduce and distribute reprints for Government
  * purposes notwithstanding any copyright notation herein.
  * -------------------------------------------------------------------------- */
+#pragma once
 #include <hydra/common/output_sink.h>
 #include <sensor_msgs/Image.h>
 #include <hydra/input/input_data.h>
 
+#include <atomic>
 #include <filesystem>
+#include <functional>
+
+#include "hydra_ros/utils/keyframe_selector.h"
 
 namespace hydra {
 
@@ -50,6 +55,12 @@ struct BagConfig {
   config::VirtualConfig<Sensor> sensor;
   std::string sensor_frame;
   std::string world_frame;
+  //! interpolate poses from a precomputed trajectory cached next to the bag
+  bool index_trajectory = false;
+  //! directory to cache extracted bag metadata in (no disk cache if empty)
+  std::filesystem::path metadata_cache_dir;
+  //! sinks that only receive frames from this bag
+  std::vector<OutputSink<const InputData&>::Factory> sinks;
 };
 
 void declare_config(BagConfig& config);
@@ -59,9 +70,28 @@ class PoseCache;
 class BagReader {
  public:
   using Sink = OutputSink<const InputData&>;
+  using ImageCallback = std::function<void(const sensor_msgs::Image::ConstPtr&,
+                                           const sensor_msgs::Image::ConstPtr&)>;
   struct Config {
     std::vector<BagConfig> bags;
     std::vector<Sink::Factory> sinks;
+    //! number of decode and processing workers (0 reads everything on one thread)
+    size_t num_workers = 0;
+    //! maximum number of images read from the bag that have not reached the sync
+    size_t prefetch_queue_size = 20;
+    //! maximum number of synced frames that have not reached the sinks
+    size_t output_queue_size = 10;
+    //! number of bags read at the same time
+    size_t num_parallel_bags = 1;
+    //! how frames from bags read in parallel reach the sinks: "ordered" interleaves
+    //! frames by timestamp and "per_bag" forwards each bag's frames as they arrive
+    std::string merge_policy = "ordered";
+    //! Match color and depth by stamp (exact first) instead of approximate time
+    bool use_stamp_sync = false;
+    //! Largest stamp difference between color and depth that the stamp sync accepts
+    double sync_tolerance_s = 0.01;
+    //! Drop synced frames that barely moved from the last keyframe before conversion
+    KeyframeSelector::Config keyframes;
   } const config;
 
   explicit BagReader(const Config& config);
@@ -72,18 +102,42 @@ class BagReader {
 
   void addSink(const Sink::Ptr& sink);
 
-  void handleImages(const BagConfig& bag_config,
-                    const Sensor::ConstPtr& sensor,
-                    const PoseCache& cache,
-                    const sensor_msgs::Image::ConstPtr& color_msg,
-                    const sensor_msgs::Image::ConstPtr& depth_msg);
+  //! Decode and sync color and depth from a bag without looking up poses
+  static void readImages(const Config& config,
+                         const BagConfig& bag_config,
+                         const ImageCallback& callback,
+                         const std::atomic<bool>* stop = nullptr);
+
+  std::unique_ptr<InputData> processImages(
+      const BagConfig& bag_config,
+      const Sensor::ConstPtr& sensor,
+      const PoseCache& cache,
+      const sensor_msgs::Image::ConstPtr& color_msg,
+      const sensor_msgs::Image::ConstPtr& depth_msg) const;
 
  protected:
-  void readBag(const BagConfig& config);
+  using FrameCallback = std::function<void(std::unique_ptr<InputData>&&)>;
+
+  void readBags();
+
+  void readBagsPerBag();
+
+  void readBagsOrdered();
+
+  void readBag(const BagConfig& config, const FrameCallback& callback);
+
+  void readBagSerial(const BagConfig& config, const FrameCallback& callback);
+
+  void readBagPipelined(const BagConfig& config, const FrameCallback& callback);
+
+  void emit(const Sink::List& bag_sinks, const InputData& data);
 
   Sink::List sinks_;
 };
 
 void declare_config(BagReader::Config& config);
 
+//! Convert a color image to RGB, referencing the message if it already is RGB
+cv::Mat toRgbImage(const sensor_msgs::Image::ConstPtr& msg);
+
 }  // namespace hydra
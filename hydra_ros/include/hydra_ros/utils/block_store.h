@@ -0,0 +1,100 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Append-only on-disk store of per-block blobs grouped into chunk files
+ *
+ * Blocks are grouped into cubic chunks of blocks_per_chunk blocks per side and each
+ * chunk is one file that new versions of blocks are appended to. An in-memory index
+ * keeps the location of the latest version of every block, so reading a block is a
+ * single seek and read. Files are removed when the store is destroyed.
+ */
+class ChunkedBlockStore {
+ public:
+  using BlockIndex = std::array<int32_t, 3>;
+
+  ChunkedBlockStore(const std::filesystem::path& directory, int blocks_per_chunk = 8);
+
+  ~ChunkedBlockStore();
+
+  ChunkedBlockStore(const ChunkedBlockStore&) = delete;
+  ChunkedBlockStore& operator=(const ChunkedBlockStore&) = delete;
+
+  bool write(const BlockIndex& index, const std::vector<uint8_t>& data);
+
+  bool read(const BlockIndex& index, std::vector<uint8_t>& data) const;
+
+  bool contains(const BlockIndex& index) const;
+
+  //! Forget a block (the data stays in its chunk file until the store is cleared)
+  void erase(const BlockIndex& index);
+
+  std::vector<BlockIndex> blocks() const;
+
+  size_t size() const { return entries_.size(); }
+
+  //! Total number of bytes written to disk
+  size_t bytesWritten() const { return bytes_written_; }
+
+  void clear();
+
+ private:
+  struct Entry {
+    BlockIndex chunk;
+    long offset;
+    size_t size;
+  };
+
+  BlockIndex chunkIndex(const BlockIndex& index) const;
+
+  std::FILE* getChunkFile(const BlockIndex& chunk);
+
+  const std::filesystem::path directory_;
+  const int blocks_per_chunk_;
+  std::map<BlockIndex, Entry> entries_;
+  std::map<BlockIndex, std::FILE*> files_;
+  size_t bytes_written_ = 0;
+};
+
+}  // namespace hydra
@@ -37,19 +37,58 @@
 #include <pose_graph_tools_msgs/BowQueries.h>
 #include <ros/ros.h>
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace hydra {
 
+/**
+ * @brief Forwards BoW queries from ROS to the loop closure module
+ *
+ * Each BowQueries message is converted into a single batch (one allocation shared by
+ * all queries in the message) and handed to a worker under one lock, so the ROS
+ * callback stays short under bursts of queries from multiple robots. The worker
+ * pushes everything it collected to the loop closure queue under a single lock.
+ */
 class BowSubscriber {
  public:
+  struct Config {
+    //! ROS subscriber queue size
+    size_t queue_size = 100;
+    //! Maximum number of batches waiting to be forwarded (oldest dropped first)
+    size_t max_backlog = 100;
+  } const config;
+
+  using Batch = std::shared_ptr<std::vector<pose_graph_tools::BowQuery>>;
+
   BowSubscriber(const ros::NodeHandle& nh, const SharedModuleState::Ptr& state);
 
+  BowSubscriber(const Config& config,
+                const ros::NodeHandle& nh,
+                const SharedModuleState::Ptr& state);
+
+  ~BowSubscriber();
+
  protected:
   void callback(const pose_graph_tools_msgs::BowQueries& msg);
 
+  void spin();
+
  protected:
   ros::NodeHandle nh_;
   ros::Subscriber sub_;
   SharedModuleState::Ptr state_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool should_shutdown_ = false;
+  std::deque<Batch> batches_;
+  std::thread worker_;
 };
 
+void declare_config(BowSubscriber::Config& config);
+
 }  // namespace hydra
@@ -0,0 +1,75 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/Image.h>
+
+#include <mutex>
+
+namespace hydra {
+
+/**
+ * @brief Size and type of the last image decoded from a stream.
+ *
+ * Frames from the same topic almost always share a size, so knowing the previous
+ * shape lets the decoder write straight into the output message instead of decoding
+ * into a temporary image first. Safe to share between decode threads.
+ */
+class DecodeShapeHint {
+ public:
+  bool get(int& rows, int& cols, int& type) const;
+
+  void set(int rows, int cols, int type);
+
+ private:
+  mutable std::mutex mutex_;
+  bool valid_ = false;
+  int rows_ = 0;
+  int cols_ = 0;
+  int type_ = 0;
+};
+
+/**
+ * @brief Decode a compressed image (including compressedDepth) into a raw image.
+ *
+ * Color images are decoded as is (i.e., bgr8 for jpeg, bgr16 for 16-bit png) and
+ * compressedDepth images are restored to their original 16UC1 or 32FC1 encoding. Other
+ * pixel types use the generic encodings (e.g., 32FC1) and half floats are widened to
+ * 32-bit floats. Returns nullptr if the image cannot be decoded.
+ */
+sensor_msgs::Image::Ptr decodeCompressedImage(const sensor_msgs::CompressedImage& msg,
+                                              DecodeShapeHint* hint = nullptr);
+
+}  // namespace hydra
@@ -0,0 +1,98 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+#include <hydra_msgs/DsgUpdate.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hydra {
+
+enum class DsgCodec : uint8_t {
+  NONE = hydra_msgs::DsgUpdate::CODEC_NONE,
+  ZSTD = hydra_msgs::DsgUpdate::CODEC_ZSTD,
+  LZ4 = hydra_msgs::DsgUpdate::CODEC_LZ4,
+};
+
+std::optional<DsgCodec> codecFromString(const std::string& name);
+
+std::string codecToString(DsgCodec codec);
+
+enum class DsgProfile : uint8_t {
+  FULL = hydra_msgs::DsgUpdate::PROFILE_FULL,
+  REDUCED = hydra_msgs::DsgUpdate::PROFILE_REDUCED,
+};
+
+std::optional<DsgProfile> profileFromString(const std::string& name);
+
+std::string profileToString(DsgProfile profile);
+
+/**
+ * @brief Strip a graph down to what remote consumers need (reduced profile)
+ *
+ * Rounds node positions to the closest multiple of position_resolution (which makes
+ * the serialized graph compress better) and drops the mesh connections of places,
+ * which are only needed to draw basis points next to the full mesh.
+ */
+void reduceGraph(DynamicSceneGraph& graph, double position_resolution);
+
+/**
+ * @brief Compress a serialized graph
+ *
+ * Throws std::runtime_error if the codec fails. `level` is the zstd compression
+ * level or the lz4 acceleration factor.
+ */
+void compressPayload(DsgCodec codec,
+                     int level,
+                     const std::vector<uint8_t>& input,
+                     std::vector<uint8_t>& output);
+
+//! Inverse of compressPayload; throws std::runtime_error on invalid input
+void decompressPayload(DsgCodec codec,
+                       size_t uncompressed_size,
+                       const std::vector<uint8_t>& input,
+                       std::vector<uint8_t>& output);
+
+//! Decompress from a raw buffer (e.g., a memory-mapped file) without copying it first
+void decompressPayload(DsgCodec codec,
+                       size_t uncompressed_size,
+                       const uint8_t* input,
+                       size_t input_size,
+                       std::vector<uint8_t>& output);
+
+}  // namespace hydra
@@ -0,0 +1,185 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+#include <hydra_msgs/DsgUpdate.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "hydra_ros/utils/dsg_compression.h"
+
+namespace hydra {
+
+class MappedFile;
+
+//! Metadata for a single entry in a binary scene graph log
+struct DsgLogRecord {
+  enum class Type : uint8_t {
+    //! full graph written by the logger itself
+    SNAPSHOT = 0,
+    //! full update received from a DsgSender
+    FULL_UPDATE = 1,
+    //! delta update received from a DsgSender
+    DELTA_UPDATE = 2,
+  };
+
+  Type type = Type::SNAPSHOT;
+  uint64_t timestamp_ns = 0;
+  //! sender sequence number (for snapshots, that of the last update applied)
+  int64_t sequence_number = 0;
+  DsgCodec codec = DsgCodec::NONE;
+  uint64_t uncompressed_size = 0;
+  //! location of the payload in the log file
+  uint64_t offset = 0;
+  uint64_t size = 0;
+
+  //! whether the graph can be reconstructed from this record alone
+  inline bool isKeyframe() const { return type != Type::DELTA_UPDATE; }
+};
+
+/**
+ * @brief Appends scene graph updates to a single binary log file
+ *
+ * Each record is a fixed-size header followed by its payload and is flushed as soon as
+ * it is written, so a log from a process that did not shut down cleanly can still be
+ * read back up to the last complete record. Closing the writer appends an index of all
+ * records so readers do not have to scan the file.
+ */
+class DsgLogWriter {
+ public:
+  DsgLogWriter(const std::string& filepath,
+               DsgCodec snapshot_codec = DsgCodec::NONE,
+               int compression_level = 0);
+
+  ~DsgLogWriter();
+
+  DsgLogWriter(const DsgLogWriter&) = delete;
+  DsgLogWriter& operator=(const DsgLogWriter&) = delete;
+
+  //! Append an update as received by a DsgReceiver (payload is left as is)
+  bool writeUpdate(const hydra_msgs::DsgUpdate& msg);
+
+  //! Append a full serialization of the graph
+  bool writeSnapshot(const DynamicSceneGraph& graph,
+                     uint64_t timestamp_ns,
+                     int64_t sequence_number);
+
+  //! Append a record with an already-encoded payload (offset and size are filled in)
+  bool append(DsgLogRecord record, const std::vector<uint8_t>& payload);
+
+  //! Write the index and close the file
+  void close();
+
+  inline bool valid() const { return file_ != nullptr; }
+
+  inline const std::vector<DsgLogRecord>& records() const { return records_; }
+
+ private:
+  std::FILE* file_;
+  uint64_t offset_;
+  DsgCodec snapshot_codec_;
+  int compression_level_;
+  std::vector<DsgLogRecord> records_;
+  std::vector<uint8_t> buffer_;
+};
+
+/**
+ * @brief Memory-maps a binary scene graph log for random access
+ *
+ * Uses the index written by DsgLogWriter::close if present and otherwise recovers the
+ * records by scanning the file, discarding a trailing partial record.
+ */
+class DsgLogReader {
+ public:
+  //! Graph reconstructed by replaying records
+  struct State {
+    DynamicSceneGraph::Ptr graph;
+    std::optional<int64_t> sequence_number;
+    uint64_t timestamp_ns = 0;
+  };
+
+  explicit DsgLogReader(const std::string& filepath);
+
+  ~DsgLogReader();
+
+  DsgLogReader(const DsgLogReader&) = delete;
+  DsgLogReader& operator=(const DsgLogReader&) = delete;
+
+  inline bool valid() const { return data_ != nullptr; }
+
+  inline const std::vector<DsgLogRecord>& records() const { return records_; }
+
+  //! Pointer to the payload of a record inside the mapped file
+  const uint8_t* payload(size_t index) const;
+
+  //! Latest keyframe at or before the timestamp (the first keyframe if there is none)
+  std::optional<size_t> findKeyframe(uint64_t timestamp_ns) const;
+
+  /**
+   * @brief Apply a record to the state
+   *
+   * Deltas that do not follow the last applied sequence number are skipped until the
+   * next keyframe. Returns false if the record was skipped or invalid.
+   */
+  bool apply(size_t index, State& state) const;
+
+  /**
+   * @brief Reconstruct the graph as of a timestamp
+   *
+   * Starts from the nearest keyframe and applies the deltas after it. If provided,
+   * `next_index` is set to the first record that was not applied.
+   */
+  State seek(uint64_t timestamp_ns, size_t* next_index = nullptr) const;
+
+ private:
+  bool readIndex();
+
+  void scanRecords();
+
+  std::unique_ptr<MappedFile> file_;
+  //! mapped contents (null if the file is not a valid log)
+  size_t size_;
+  const uint8_t* data_;
+  std::vector<DsgLogRecord> records_;
+  //! indices of keyframe records in file order
+  std::vector<size_t> keyframes_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,109 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#pragma once
+#include <hydra/common/dsg_types.h>
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Incrementally maintained lookups over the nodes of a scene graph
+ *
+ * Nodes are bucketed per layer by semantic label and by voxel cell, and children
+ * are tracked per parent, so queries never need to scan or copy the graph.
+ */
+class DsgQueryIndex {
+ public:
+  struct Entry {
+    LayerId layer;
+    Eigen::Vector3d position;
+    std::optional<uint32_t> label;
+    std::optional<NodeId> parent;
+  };
+
+  explicit DsgQueryIndex(double resolution = 1.0);
+
+  void clear();
+
+  //! Add or change a node; nodes that did not change are not reinserted
+  void updateNode(NodeId node, const Entry& entry);
+
+  void removeNode(NodeId node);
+
+  //! Synchronize the index with all static layers of the graph
+  void update(const DynamicSceneGraph& graph);
+
+  //! Closest node in the layer with the semantic label (if any)
+  std::optional<NodeId> nearestWithLabel(LayerId layer,
+                                         uint32_t label,
+                                         const Eigen::Vector3d& point) const;
+
+  //! All nodes in the layer within radius of the point
+  std::vector<NodeId> withinRadius(LayerId layer,
+                                   const Eigen::Vector3d& point,
+                                   double radius) const;
+
+  //! All indexed nodes whose parent is the node
+  std::vector<NodeId> children(NodeId node) const;
+
+  size_t numNodes() const { return entries_.size(); }
+
+  double resolution() const { return resolution_; }
+
+ private:
+  using CellKey = uint64_t;
+  using Buckets = std::unordered_map<uint64_t, std::vector<NodeId>>;
+
+  CellKey toKey(const Eigen::Vector3i& index) const;
+
+  Eigen::Vector3i toIndex(const Eigen::Vector3d& point) const;
+
+  void insert(NodeId node, const Entry& entry);
+
+  void erase(NodeId node, const Entry& entry);
+
+  double resolution_;
+  std::unordered_map<NodeId, Entry> entries_;
+  std::map<LayerId, Buckets> cells_;
+  std::map<LayerId, Buckets> labels_;
+  Buckets children_;
+};
+
+}  // namespace hydra
@@ -35,10 +35,25 @@
 #pragma once
 #include <hydra/common/dsg_types.h>
 #include <hydra_msgs/DsgUpdate.h>
+#include <hydra_msgs/GetDsg.h>
+#include <hydra_msgs/MeshDelta.h>
 #include <kimera_pgmo_msgs/KimeraPgmoMesh.h>
 #include <ros/ros.h>
+#include <std_msgs/Empty.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <set>
+#include <thread>
+
+#include "hydra_ros/utils/dsg_compression.h"
+#include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/shared_memory_dsg.h"
+#include "hydra_ros/utils/stream_scheduler.h"
+#include "hydra_ros/utils/update_sequence.h"
 
 namespace hydra {
 
@@ -51,25 +66,130 @@ class DsgSender {
                      double min_mesh_separation_s = 0.0,
                      bool serialize_dsg_mesh_ = true);
 
+  ~DsgSender();
+
+  /**
+   * @brief Publish the graph (or hand a copy of it to the publisher thread if async)
+   *
+   * In async mode the caller still pays for one graph clone (plus a mesh copy when
+   * the mesh is published or serialized) per call. The copy is skipped when no
+   * output (subscriber, shared memory or get_dsg request) would consume it.
+   */
   void sendGraph(const DynamicSceneGraph& graph, const ros::Time& stamp) const;
 
  private:
+  using EdgeSet = std::set<std::pair<NodeId, NodeId>>;
+
+  void publishGraph(const DynamicSceneGraph& graph, const ros::Time& stamp) const;
+
+  void publishLoop() const;
+
+  bool shouldSendFullUpdate() const;
+
+  //! Fill a full update, moving out of serialized if it already holds the encoding
+  void fillFullUpdate(const DynamicSceneGraph& graph,
+                      hydra_msgs::DsgUpdate& msg,
+                      std::vector<uint8_t>& serialized) const;
+
+  //! Serialize the graph with the configured profile (reducing the graph in place)
+  void writeContents(DynamicSceneGraph& graph, hydra_msgs::DsgUpdate& msg) const;
+
+  void resetDeltaState(const DynamicSceneGraph& graph) const;
+
+  void compressUpdate(hydra_msgs::DsgUpdate& msg) const;
+
+  void cacheFullUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg) const;
+
+  bool handleGetDsg(hydra_msgs::GetDsg::Request& req,
+                    hydra_msgs::GetDsg::Response& res);
+
+  void fillDeltaUpdate(const DynamicSceneGraph& graph,
+                       hydra_msgs::DsgUpdate& msg) const;
+
+  //! Drop nodes of layers that are over budget or rate limited from the delta
+  void scheduleDelta(const DynamicSceneGraph& graph,
+                     std::set<NodeId>& to_send,
+                     EdgeSet& curr_edges) const;
+
+  void handleResync(const std_msgs::Empty::ConstPtr& msg);
+
+  void handleMeshResync(const std_msgs::Empty::ConstPtr& msg);
+
+  void publishMeshDelta(const Mesh& mesh, uint64_t timestamp_ns) const;
+
   ros::NodeHandle nh_;
   std::string frame_id_;
 
   ros::Publisher pub_;
   ros::Publisher mesh_pub_;
+  ros::Publisher mesh_delta_pub_;
+  ros::Subscriber resync_sub_;
+  ros::Subscriber mesh_resync_sub_;
+  //! get_dsg waits for the next publish, so it is served from its own thread
+  ros::NodeHandle service_nh_;
+  std::unique_ptr<CallbackThreads> service_threads_;
+  ros::ServiceServer get_dsg_service_;
   mutable std::optional<uint64_t> last_mesh_time_ns_;
 
   std::string timer_name_;
   bool publish_mesh_;
   double min_mesh_separation_s_;
   bool serialize_dsg_mesh_;
+  //! number of delta updates between full updates (0 disables delta updates)
+  int full_update_period_;
+  DsgCodec codec_;
+  int compression_level_;
+  //! reduced profiles round positions and drop attributes only needed locally
+  DsgProfile profile_;
+  double position_resolution_;
+  //! quantize and pack mesh deltas (compressed with codec_) to save bandwidth
+  bool compact_mesh_delta_;
+  double mesh_position_resolution_;
+
+  mutable int64_t sequence_number_;
+  mutable int updates_since_full_;
+  mutable size_t num_delta_nodes_;
+  //! defers layers of delta updates to stay within the budget of the dsg topic
+  std::unique_ptr<StreamScheduler> scheduler_;
+  //! defers mesh updates to stay within the budget of the mesh topics
+  std::unique_ptr<StreamScheduler> mesh_scheduler_;
+  mutable std::atomic<bool> resync_requested_;
+  //! static node attributes and edges as of the last published message
+  mutable std::map<NodeId, NodeAttributes::Ptr> sent_nodes_;
+  mutable EdgeSet sent_edges_;
+  //! copy of the last mesh sent on the mesh delta topic
+  mutable Mesh::Ptr sent_mesh_;
+  mutable int64_t mesh_sequence_number_;
+  mutable int mesh_updates_since_full_;
+  mutable std::atomic<bool> mesh_resync_requested_;
+
+  //! how long GetDsg waits for a serialization of the latest graph
+  double get_dsg_timeout_s_;
+  mutable std::mutex cache_mutex_;
+  mutable std::condition_variable cache_cv_;
+  mutable std::atomic<bool> cache_requested_;
+  mutable uint64_t graph_revision_;
+  mutable uint64_t cache_revision_;
+  mutable hydra_msgs::DsgUpdate::ConstPtr cached_update_;
+
+  //! publish from a dedicated thread, dropping all but the latest graph
+  bool async_publish_;
+  mutable std::mutex pending_mutex_;
+  mutable std::condition_variable pending_cv_;
+  mutable bool should_shutdown_;
+  mutable DynamicSceneGraph::Ptr pending_graph_;
+  mutable ros::Time pending_stamp_;
+  mutable size_t num_dropped_;
+  std::unique_ptr<std::thread> publish_thread_;
+
+  //! optional shared-memory segment for co-located readers
+  std::unique_ptr<SharedDsgWriter> shm_writer_;
 };
 
 class DsgReceiver {
  public:
   using LogCallback = std::function<void(const ros::Time&, size_t)>;
+  using UpdateCallback = std::function<void(const DynamicSceneGraph&)>;
 
   explicit DsgReceiver(const ros::NodeHandle& nh, bool subscribe_to_mesh = false);
 
@@ -81,20 +201,70 @@ class DsgReceiver {
 
   inline void clearUpdated() { has_update_ = false; }
 
+  //! sequence number of the last update applied to the graph (if any)
+  inline std::optional<int64_t> sequenceNumber() const { return sequence_.last(); }
+
+  //! Profile of the last update (reduced graphs have no place mesh connections)
+  inline DsgProfile profile() const { return profile_; }
+
+  //! Called from the receiving thread after every update that was applied to the graph
+  void setUpdateCallback(const UpdateCallback& callback);
+
+  /**
+   * @brief Copy of the graph if it changed since the last call (null otherwise)
+   *
+   * Safe to call from a thread other than the receiving one: updates only mark the
+   * graph dirty and the copy is made here under the graph lock. The mesh of the copy
+   * is only copied when it changed and is never modified by the receiver afterwards.
+   * Must not be called from the update callback.
+   */
+  DynamicSceneGraph::Ptr takeSnapshot();
+
  private:
+  void notifyUpdate(bool mesh_changed = false);
+
   void handleUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg);
 
   void handleMesh(const kimera_pgmo_msgs::KimeraPgmoMesh::ConstPtr& msg);
 
+  void handleMeshDelta(const hydra_msgs::MeshDelta::ConstPtr& msg);
+
+  void applyDelta(const hydra_msgs::DsgUpdate& msg,
+                  const std::vector<uint8_t>& contents);
+
+  void requestResync();
+
+  void requestMeshResync();
+
+  void pollSharedMemory(const ros::WallTimerEvent&);
+
+  void handleSharedGraph(const uint8_t* data, size_t size, uint64_t timestamp_ns);
+
   ros::NodeHandle nh_;
   ros::Subscriber sub_;
   ros::Subscriber mesh_sub_;
+  ros::Subscriber mesh_delta_sub_;
+  ros::Publisher resync_pub_;
+  ros::Publisher mesh_resync_pub_;
 
   bool has_update_;
+  DsgProfile profile_;
+  UpdateSequence sequence_;
+  UpdateSequence mesh_sequence_;
   DynamicSceneGraph::Ptr graph_;
   Mesh::Ptr mesh_;
 
+  //! Guards graph_ and mesh_ against takeSnapshot
+  std::mutex graph_mutex_;
+  std::atomic<bool> snapshot_dirty_;
+  bool mesh_dirty_;
+  Mesh::Ptr snapshot_mesh_;
+
   std::unique_ptr<LogCallback> log_callback_;
+  std::unique_ptr<UpdateCallback> update_callback_;
+
+  std::unique_ptr<SharedDsgReader> shm_reader_;
+  ros::WallTimer shm_timer_;
 };
 
 }  // namespace hydra
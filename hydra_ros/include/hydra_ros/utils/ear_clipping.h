@@ -35,6 +35,10 @@
 #pragma once
 #include <hydra/common/dsg_types.h>
 
+#include <array>
+#include <list>
+#include <vector>
+
 namespace hydra {
 
 struct Vertex {
@@ -135,4 +139,23 @@ class Polygon {
   std::vector<Vertex> vertices_;
 };
 
+/**
+ * @brief Ear clipping over index arrays
+ *
+ * Produces the same faces as Polygon::triangulate. Active vertices are a ring of
+ * prev/next indices, ear tests only visit reflex vertices and candidate ears are kept
+ * in an ordered set that is updated for the two neighbors of each clipped ear.
+ */
+std::vector<std::array<size_t, 3>> triangulatePolygon(
+    const std::vector<Vertex>& vertices,
+    bool is_ccw = true,
+    bool use_first_ear = false);
+
+//! Triangulate the xy-projection of a polygon with one point per column
+std::vector<std::array<size_t, 3>> triangulatePoints(const Eigen::MatrixXd& points);
+
+//! Triangulate polygons (one point per column) using up to num_threads threads
+std::vector<std::vector<std::array<size_t, 3>>> triangulatePolygons(
+    const std::vector<const Eigen::MatrixXd*>& polygons, size_t num_threads = 1);
+
 }  // namespace hydra
@@ -0,0 +1,91 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Voxel hash over the free-space spheres of place nodes
+ *
+ * Each place is inserted into every cell overlapped by the bounding box of its
+ * sphere, so a query only needs to check the places in a single cell.
+ */
+class FreespaceIndex {
+ public:
+  struct Sphere {
+    Eigen::Vector3d center;
+    double radius;
+  };
+
+  explicit FreespaceIndex(double resolution = 0.5);
+
+  void clear();
+
+  //! Add or move a sphere; unchanged spheres are not reinserted
+  void updateSphere(NodeId node, const Eigen::Vector3d& center, double radius);
+
+  void removeSphere(NodeId node);
+
+  //! Synchronize the index with all real places in the layer
+  void update(const SceneGraphLayer& places);
+
+  //! Check whether a point has at least `clearance` distance to the nearest obstacle
+  bool inFreespace(const Eigen::Vector3d& point, double clearance = 0.0) const;
+
+  size_t numSpheres() const { return spheres_.size(); }
+
+  double resolution() const { return resolution_; }
+
+ private:
+  using CellKey = uint64_t;
+
+  CellKey toKey(const Eigen::Vector3i& index) const;
+
+  Eigen::Vector3i toIndex(const Eigen::Vector3d& point) const;
+
+  void insertCells(NodeId node, const Sphere& sphere);
+
+  void eraseCells(NodeId node, const Sphere& sphere);
+
+  double resolution_;
+  std::unordered_map<NodeId, Sphere> spheres_;
+  std::unordered_map<CellKey, std::vector<NodeId>> cells_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,82 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Geometry>
+#include <cstdint>
+#include <optional>
+
+namespace hydra {
+
+/**
+ * @brief Decides whether a frame moved far enough from the last keyframe to be kept
+ *
+ * A frame becomes a keyframe if at least min_separation_s has passed since the last
+ * keyframe and the sensor either translated by min_translation or rotated by
+ * min_rotation since then. The first frame is always a keyframe.
+ */
+class KeyframeSelector {
+ public:
+  struct Config {
+    //! Only forward keyframes (every frame is forwarded if disabled)
+    bool enable = false;
+    //! Translation since the last keyframe that triggers a new keyframe
+    double min_translation = 0.05;
+    //! Rotation since the last keyframe that triggers a new keyframe
+    double min_rotation = 0.1;
+    //! Minimum time between keyframes
+    double min_separation_s = 0.0;
+  } const config;
+
+  explicit KeyframeSelector(const Config& config);
+
+  //! Check whether the frame is a keyframe and make it the reference frame if it is
+  bool accept(uint64_t timestamp_ns, const Eigen::Isometry3d& world_T_sensor);
+
+  size_t numAccepted() const { return num_accepted_; }
+
+  size_t numRejected() const { return num_rejected_; }
+
+  void reset();
+
+ private:
+  std::optional<uint64_t> last_timestamp_ns_;
+  Eigen::Isometry3d last_world_T_sensor_;
+  size_t num_accepted_ = 0;
+  size_t num_rejected_ = 0;
+};
+
+void declare_config(KeyframeSelector::Config& config);
+
+}  // namespace hydra
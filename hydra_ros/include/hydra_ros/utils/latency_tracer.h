@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Records when each input (identified by its sensor stamp) reaches a stage
+ *
+ * Every mark records the time since the sensor stamp as the "trace/<stage>" latency
+ * and the trace of each frame (i.e., the time spent between consecutive stages) can
+ * be exported in the Chrome trace event format for Perfetto or chrome://tracing.
+ * Latencies are only meaningful if the sensor stamps come from the system clock.
+ * Marks are dropped while the tracer is disabled, which is the default.
+ */
+class LatencyTracer {
+ public:
+  struct Config {
+    //! Record marks for every input
+    bool enable = false;
+    //! Chrome trace file written when the tracer is stopped (unused if empty)
+    std::string output_path = "";
+    //! Number of most recent frames to keep in the trace
+    size_t max_frames = 10000;
+  };
+
+  struct Mark {
+    std::string stage;
+    uint64_t wall_ns;
+  };
+
+  static LatencyTracer& instance();
+
+  void start(const Config& config);
+
+  //! Disable the tracer and write the trace if configured
+  void stop();
+
+  bool enabled() const { return enabled_; }
+
+  //! Record that the input with the provided stamp reached a stage
+  void mark(uint64_t timestamp_ns, const std::string& stage);
+
+  void mark(uint64_t timestamp_ns, const std::string& stage, uint64_t wall_ns);
+
+  std::map<uint64_t, std::vector<Mark>> frames() const;
+
+  //! Trace as a Chrome trace event JSON object (one async track per frame)
+  std::string toChromeTrace() const;
+
+  void clear();
+
+ private:
+  LatencyTracer() = default;
+
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  Config config_;
+  std::map<uint64_t, std::vector<Mark>> frames_;
+};
+
+void declare_config(LatencyTracer::Config& config);
+
+}  // namespace hydra
@@ -56,4 +56,22 @@ PoseStatus lookupTransform(const tf2_ros::Buffer& buffer,
                            double wait_duration_s = 0.1,
                            int verbosity = 10);
 
+/**
+ * @brief Wait for a transform to become available via tf2 transformable callbacks
+ *
+ * Blocks on a condition variable instead of polling the buffer. Requires the buffer
+ * to be filled from another thread (e.g., a TransformListener with a spin thread).
+ * A timeout of std::nullopt waits until the transform arrives or ROS shuts down.
+ * Stamps that are more than max_age_s seconds older than the latest transform between
+ * the frames fail immediately instead of waiting for the timeout. Without a maximum
+ * age, only stamps that predate the buffer cache fail early.
+ */
+PoseStatus waitForTransform(tf2_ros::Buffer& buffer,
+                            const ros::Time& stamp,
+                            const std::string& target,
+                            const std::string& source,
+                            std::optional<double> timeout_s = std::nullopt,
+                            int verbosity = 10,
+                            std::optional<double> max_age_s = std::nullopt);
+
 }  // namespace hydra
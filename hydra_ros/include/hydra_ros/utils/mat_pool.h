@@ -0,0 +1,86 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <opencv2/core.hpp>
+
+#include <memory>
+
+namespace hydra {
+
+/**
+ * @brief Recycles the buffers of matrices allocated for input packets
+ *
+ * Matrices attached to the pool allocate through it, and their buffer goes back to
+ * the pool (instead of the heap) once the last reference to the matrix is released,
+ * i.e., once reconstruction is done with the packet. Later allocations reuse an idle
+ * buffer that is large enough (but not more than twice the requested size), so
+ * receivers with fixed-size inputs stop allocating pixel or point storage after the
+ * first few messages. The pool stays alive until every matrix it allocated is gone.
+ */
+class MatPool {
+ public:
+  using Ptr = std::shared_ptr<MatPool>;
+
+  //! Create a pool that keeps up to max_idle_buffers unused buffers around
+  static Ptr create(size_t max_idle_buffers);
+
+  ~MatPool();
+
+  MatPool(const MatPool&) = delete;
+
+  MatPool& operator=(const MatPool&) = delete;
+
+  //! Make create() on the (empty) matrix draw from the pool
+  void attach(cv::Mat& mat) const;
+
+  //! Number of buffers handed out by the pool that came from the heap
+  size_t numAllocated() const;
+
+  //! Number of buffers handed out by the pool that were recycled
+  size_t numReused() const;
+
+  //! Number of buffers currently idle in the pool
+  size_t numIdle() const;
+
+ private:
+  class Allocator;
+
+  explicit MatPool(size_t max_idle_buffers);
+
+  //! deletes itself once the pool and every matrix from it are gone
+  Allocator* allocator_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,161 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <config_utilities/factory.h>
+#include <hydra/common/dsg_types.h>
+#include <hydra/frontend/gvd_place_extractor.h>
+#include <hydra/places/gvd_voxel.h>
+#include <hydra/reconstruction/reconstruction_module.h>
+#include <ros/ros.h>
+
+#include <map>
+#include <string>
+
+#include "hydra_ros/utils/metrics.h"
+
+namespace hydra {
+
+struct MemoryUsage {
+  size_t count = 0;
+  size_t bytes = 0;
+};
+
+//! Estimated footprint of the nodes and edges of a layer (not counting containers)
+MemoryUsage estimateLayerMemory(const SceneGraphLayer& layer);
+
+//! Estimated footprint of the mesh buffers (count is the number of vertices)
+MemoryUsage estimateMeshMemory(const Mesh& mesh);
+
+//! Resident set size of the process (0 if unavailable)
+size_t readResidentBytes();
+
+//! Number of allocated blocks and bytes used by their voxels
+template <typename LayerT>
+MemoryUsage estimateVoxelLayerMemory(const LayerT& layer) {
+  MemoryUsage usage;
+  for (const auto& block : layer) {
+    using VoxelT = typename std::decay_t<decltype(block.voxels)>::value_type;
+    ++usage.count;
+    usage.bytes += sizeof(block) + block.voxels.size() * sizeof(VoxelT);
+  }
+
+  return usage;
+}
+
+/**
+ * @brief Periodically reports how much memory the scene graphs use
+ *
+ * Each period sets gauges in the metrics registry (published with the timing
+ * metrics) for the node and edge counts and estimated bytes of every layer, the total
+ * edge count, the mesh vertex and face counts and bytes and the resident set size of
+ * the process. The volumetric layers are reported by TsdfMemorySink and
+ * GvdMemorySink.
+ */
+class MemoryMonitor {
+ public:
+  struct Config {
+    //! Reporting period (disabled if not positive)
+    double period_s = 0.0;
+  } const config;
+
+  MemoryMonitor(const Config& config, const ros::NodeHandle& nh);
+
+  ~MemoryMonitor();
+
+  //! Report a scene graph under memory/<name>/...
+  void addGraph(const std::string& name, const SharedDsgInfo::Ptr& dsg);
+
+  void update();
+
+ private:
+  void updateGraph(const std::string& name, SharedDsgInfo& dsg) const;
+
+  ros::NodeHandle nh_;
+  ros::WallTimer timer_;
+  std::map<std::string, SharedDsgInfo::Ptr> graphs_;
+};
+
+class TsdfMemorySink : public ReconstructionModule::Sink {
+ public:
+  struct Config {
+    //! Minimum time between reports
+    double period_s = 1.0;
+  } const config;
+
+  explicit TsdfMemorySink(const Config& config);
+
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3d& world_T_sensor,
+            const TsdfLayer& tsdf,
+            const ReconstructionOutput& msg) const override;
+
+ private:
+  mutable uint64_t last_ns_ = 0;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<ReconstructionModule::Sink,
+                                     TsdfMemorySink,
+                                     Config>("TsdfMemorySink");
+};
+
+class GvdMemorySink : public GvdPlaceExtractor::Sink {
+ public:
+  struct Config {
+    //! Minimum time between reports
+    double period_s = 1.0;
+  } const config;
+
+  explicit GvdMemorySink(const Config& config);
+
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3f& world_T_sensor,
+            const places::GvdLayer& gvd,
+            const places::GraphExtractorInterface* extractor) const override;
+
+ private:
+  mutable uint64_t last_ns_ = 0;
+
+  inline static const auto registration_ =
+      config::RegistrationWithConfig<GvdPlaceExtractor::Sink, GvdMemorySink, Config>(
+          "GvdMemorySink");
+};
+
+void declare_config(MemoryMonitor::Config& config);
+
+void declare_config(TsdfMemorySink::Config& config);
+
+void declare_config(GvdMemorySink::Config& config);
+
+}  // namespace hydra
@@ -0,0 +1,78 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+#include <hydra_msgs/MeshDelta.h>
+
+#include "hydra_ros/utils/dsg_compression.h"
+
+namespace hydra {
+
+/**
+ * @brief Fill a message with the vertices and faces of `curr` that differ from `prev`
+ *
+ * Passing a null `prev` (or a mesh with different attributes) produces a full update.
+ */
+void fillMeshDelta(const Mesh* prev, const Mesh& curr, hydra_msgs::MeshDelta& msg);
+
+/**
+ * @brief Patch a mesh in place with a delta (or reset it for full updates)
+ *
+ * Throws std::runtime_error if the delta is inconsistent or does not match the
+ * attributes of the mesh.
+ */
+void applyMeshDelta(const hydra_msgs::MeshDelta& msg, Mesh::Ptr& mesh);
+
+/**
+ * @brief Pack the changed vertices and faces of a raw delta into compact_data
+ *
+ * Positions are quantized to `position_resolution` and stored relative to the
+ * previous changed vertex, colors use a palette when there are few distinct colors,
+ * and indices, stamps, labels and faces are delta and varint coded. The packed bytes
+ * are optionally compressed with `codec`.
+ */
+void encodeMeshDelta(hydra_msgs::MeshDelta& msg,
+                     double position_resolution,
+                     DsgCodec codec = DsgCodec::NONE,
+                     int compression_level = 1);
+
+/**
+ * @brief Restore the raw fields of a compact delta (raw deltas are left untouched)
+ *
+ * Throws std::runtime_error if the packed data is truncated or inconsistent.
+ */
+void decodeMeshDelta(hydra_msgs::MeshDelta& msg);
+
+}  // namespace hydra
@@ -0,0 +1,177 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/utils/timing_utilities.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Fixed-size latency histogram with logarithmic buckets
+ *
+ * Buckets grow by a factor of 2^(1/4) starting at 1 microsecond, which bounds the
+ * relative error of any quantile to about 19% while covering almost 4 minutes.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t kNumBuckets = 112;
+
+  void record(double seconds);
+
+  //! Upper bound of the bucket containing the q-th quantile (0 if empty)
+  double quantile(double q) const;
+
+  size_t count() const { return count_; }
+
+  double mean() const { return count_ ? total_s_ / count_ : 0.0; }
+
+  double max() const { return max_s_; }
+
+  void clear();
+
+  static double bucketUpperBound(size_t bucket);
+
+ private:
+  std::array<uint64_t, kNumBuckets> buckets_{};
+  size_t count_ = 0;
+  double total_s_ = 0.0;
+  double max_s_ = 0.0;
+};
+
+/**
+ * @brief Process-wide registry of latencies, counters and gauges
+ *
+ * Latencies are aggregated per reporting window (see takeLatencies), counters are
+ * monotonic totals and gauges are sampled from callbacks when reported. All methods
+ * are thread-safe.
+ */
+class MetricsRegistry {
+ public:
+  using GaugeCallback = std::function<double()>;
+
+  struct LatencySummary {
+    size_t count = 0;
+    double mean_s = 0.0;
+    double p50_s = 0.0;
+    double p95_s = 0.0;
+    double p99_s = 0.0;
+    double max_s = 0.0;
+  };
+
+  static MetricsRegistry& instance();
+
+  void recordLatency(const std::string& name, double seconds);
+
+  void addCount(const std::string& name, uint64_t count = 1);
+
+  void setGauge(const std::string& name, double value);
+
+  //! Register a gauge that is evaluated every time gauges are read
+  void registerGauge(const std::string& name, const GaugeCallback& callback);
+
+  void removeGauge(const std::string& name);
+
+  //! Summarize the latencies recorded since the last call and start a new window
+  std::map<std::string, LatencySummary> takeLatencies();
+
+  std::map<std::string, uint64_t> counters() const;
+
+  std::map<std::string, double> gauges() const;
+
+  void clear();
+
+ private:
+  MetricsRegistry() = default;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, LatencyHistogram> latencies_;
+  std::map<std::string, uint64_t> counters_;
+  std::map<std::string, double> gauges_;
+  std::map<std::string, GaugeCallback> gauge_callbacks_;
+};
+
+/**
+ * @brief Format metrics in the Prometheus text exposition format
+ *
+ * Latency quantiles of the last window are exported as gauges (e.g.,
+ * hydra_latency_seconds{node="...",timer="...",quantile="0.99"}) so that the output
+ * can be scraped via the node exporter textfile collector.
+ */
+std::string formatPrometheus(
+    const std::string& node_name,
+    const std::map<std::string, MetricsRegistry::LatencySummary>& latencies,
+    const std::map<std::string, uint64_t>& counters,
+    const std::map<std::string, double>& gauges);
+
+//! Records the lifetime of the object as a latency sample
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(const std::string& name);
+
+  ~ScopedLatency();
+
+ private:
+  const std::string name_;
+  const std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief timing::ScopedTimer that also records its lifetime as a latency sample
+ *
+ * Use instead of pairing a ScopedTimer and a ScopedLatency with the same name.
+ * Arguments after the timestamp are forwarded to the ScopedTimer.
+ */
+class LatencyTimer {
+ public:
+  template <typename... Args>
+  LatencyTimer(const std::string& name, uint64_t timestamp_ns, Args&&... args)
+      : latency_(name), timer_(name, timestamp_ns, std::forward<Args>(args)...) {}
+
+ private:
+  // declared first so that the latency includes stopping the timer
+  ScopedLatency latency_;
+  timing::ScopedTimer timer_;
+};
+
+}  // namespace hydra
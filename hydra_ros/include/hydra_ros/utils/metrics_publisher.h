@@ -0,0 +1,86 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <ros/ros.h>
+
+#include <map>
+#include <string>
+
+#include "hydra_ros/utils/metrics.h"
+
+namespace hydra {
+
+/**
+ * @brief Periodically publishes the metrics registry
+ *
+ * Each period produces a diagnostic_msgs/DiagnosticArray on /diagnostics with one
+ * status for latencies (p50/p95/p99/max per timer), one for counters (totals and
+ * rates) and one for gauges. Optionally also writes the same metrics to a file in the
+ * Prometheus text format.
+ */
+class MetricsPublisher {
+ public:
+  struct Config {
+    bool enable = true;
+    //! Reporting (and latency window) period
+    double period_s = 1.0;
+    //! Report WARN if any timer has a p99 above this (disabled if non-positive)
+    double warn_p99_s = -1.0;
+    //! Prometheus textfile to write each period (disabled if empty)
+    std::string prometheus_path = "";
+  } const config;
+
+  MetricsPublisher(const Config& config,
+                   const ros::NodeHandle& nh,
+                   const std::string& node_name);
+
+  ~MetricsPublisher();
+
+ private:
+  void publish(const ros::WallTimerEvent&);
+
+  void writePrometheus(const std::string& contents) const;
+
+  ros::NodeHandle nh_;
+  const std::string node_name_;
+  ros::Publisher pub_;
+  ros::WallTimer timer_;
+  ros::WallTime last_time_;
+  std::map<std::string, uint64_t> last_counters_;
+};
+
+void declare_config(MetricsPublisher::Config& config);
+
+}  // namespace hydra
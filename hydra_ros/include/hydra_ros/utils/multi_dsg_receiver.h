@@ -0,0 +1,135 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+#include <ros/ros.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "hydra_ros/utils/dsg_streaming_interface.h"
+#include "hydra_ros/utils/node_utilities.h"
+
+namespace hydra {
+
+/**
+ * @brief Receives scene graphs from several robots and merges them into one graph
+ *
+ * Every robot gets its own DsgReceiver on <robot_ns>/dsg with a dedicated callback
+ * queue and thread, so the robot streams are decompressed and deserialized
+ * concurrently. Each receiving thread diffs its robot graph against the previous
+ * update and queues the changed, removed and new nodes and edges under a per-robot
+ * lock. Only these changes are applied to the merged graph when it is requested.
+ * Robots are expected to use disjoint node ids (i.e., distinct node symbol prefixes
+ * per robot). Nodes of dynamic layers are merged when they first appear.
+ */
+class MultiDsgReceiver {
+ public:
+  using EdgeKey = std::pair<NodeId, NodeId>;
+
+  //! Changes of a robot graph that were not merged yet
+  struct Changes {
+    struct Node {
+      LayerId layer;
+      //! only set for nodes of dynamic layers
+      std::optional<std::chrono::nanoseconds> timestamp;
+      NodeAttributes::Ptr attributes;
+    };
+
+    std::map<NodeId, Node> nodes;
+    std::set<NodeId> removed_nodes;
+    std::map<EdgeKey, EdgeAttributes::Ptr> edges;
+    std::set<EdgeKey> removed_edges;
+
+    bool empty() const;
+    //! Add newer changes on top of these (later changes win)
+    void update(Changes&& other);
+  };
+
+  //! Nodes and edges of a robot graph when it was last diffed
+  struct GraphState {
+    std::map<NodeId, NodeAttributes::Ptr> nodes;
+    std::set<EdgeKey> edges;
+  };
+
+  MultiDsgReceiver(const ros::NodeHandle& nh,
+                   const std::vector<std::string>& robot_namespaces);
+
+  ~MultiDsgReceiver();
+
+  /**
+   * @brief Merged graph if anything changed since the last call (null otherwise)
+   *
+   * The graph is updated in place by the next call, so it should only be used from
+   * the thread that calls this.
+   */
+  DynamicSceneGraph::Ptr getUpdatedGraph();
+
+  inline size_t numRobots() const { return robots_.size(); }
+
+  //! Changes of a graph since `state` and update `state` to the graph
+  static Changes diffGraph(const DynamicSceneGraph& graph, GraphState& state);
+
+ private:
+  struct Robot {
+    size_t index;
+    std::string ns;
+    ros::NodeHandle nh;
+    std::unique_ptr<CallbackThreads> threads;
+    std::unique_ptr<DsgReceiver> receiver;
+    //! only used by the receiving thread
+    GraphState state;
+    //! guards pending
+    std::mutex mutex;
+    Changes pending;
+  };
+
+  void handleUpdate(Robot& robot, const DynamicSceneGraph& graph);
+
+  void applyChanges(const Robot& robot, Changes& changes);
+
+  DynamicSceneGraph::Ptr merged_;
+  //! robot that last contributed each node of the merged graph
+  std::map<NodeId, size_t> owners_;
+  std::vector<std::unique_ptr<Robot>> robots_;
+};
+
+}  // namespace hydra
@@ -35,6 +35,7 @@
 #pragma once
 #include <hydra/common/dsg_types.h>
 #include <hydra/utils/log_utilities.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 #include <std_srvs/Empty.h>
 
@@ -51,6 +52,23 @@ struct ServiceFunctor {
   bool should_exit;
 };
 
+/**
+ * @brief Dedicated callback queue and spinner threads for a nodehandle
+ *
+ * Must be constructed before the nodehandle is used to subscribe. Call stop() before
+ * shutting down any subscribers that use the queue.
+ */
+struct CallbackThreads {
+  CallbackThreads(ros::NodeHandle& nh, size_t num_threads);
+
+  ~CallbackThreads();
+
+  void stop();
+
+  std::unique_ptr<ros::CallbackQueue> queue;
+  std::unique_ptr<ros::AsyncSpinner> spinner;
+};
+
 bool haveClock();
 
 void spinWhileClockPresent();
@@ -59,4 +77,7 @@ void spinUntilExitRequested();
 
 void spinAndWait(const ros::NodeHandle& nh);
 
+//! All parameters below the nodehandle namespace as a string (empty if none are set)
+std::string getParamSignature(const ros::NodeHandle& nh);
+
 }  // namespace hydra
@@ -37,10 +37,15 @@
 #include <hydra/frontend/gvd_place_extractor.h>
 #include <hydra/places/gvd_voxel.h>
 #include <hydra/reconstruction/reconstruction_module.h>
+#include <nav_msgs/OccupancyGrid.h>
 #include <ros/ros.h>
 
+#include <atomic>
+
 namespace hydra {
 
+struct IncrementalGrid;
+
 class OccupancyPublisher {
  public:
   struct Config {
@@ -52,6 +57,29 @@ class OccupancyPublisher {
     bool add_robot_footprint = false;
     Eigen::Vector3f footprint_min;
     Eigen::Vector3f footprint_max;
+    //! Keep a persistent grid and publish patches for updated blocks
+    bool incremental = false;
+    //! Number of blocks per side to grow the persistent grid by
+    size_t grid_chunk_blocks = 8;
+    //! Period to republish the full persistent grid (only on resize and new
+    //! subscribers if <= 0)
+    double full_update_period_s = 10.0;
+    //! Number of threads to split block processing over
+    size_t num_threads = 1;
+    //! Side length of a grid around the sensor on occupancy_local (off if <= 0)
+    double local_window_size = 0.0;
+    //! Cell size of a max-pooled global grid on occupancy_coarse (off if <= 0)
+    double coarse_resolution = 0.0;
+    //! Minimum time between coarse grid updates
+    double coarse_period_s = 1.0;
+    //! Publish inflated costs derived from voxel distances instead of free/occupied
+    bool costmap = false;
+    //! Distance below which cells get the inscribed cost (99)
+    double inscribed_radius = 0.3;
+    //! Distance beyond which cells are free (bounded by the layer truncation distance)
+    double inflation_radius = 1.0;
+    //! Exponential decay rate of costs between the two radii
+    double cost_scaling_factor = 10.0;
   } const config;
 
   OccupancyPublisher(const Config& config, const ros::NodeHandle& nh);
@@ -67,8 +95,26 @@ class OccupancyPublisher {
                   const places::GvdLayer& gvd) const;
 
  private:
+  template <typename BlockT>
+  void publishLayer(uint64_t timestamp_ns,
+                    const Eigen::Isometry3d& world_T_sensor,
+                    const spatial_hash::VoxelLayer<BlockT>& layer) const;
+
+  void publishIncremental(uint64_t timestamp_ns) const;
+
+  void onSubscriberConnect(const ros::SingleSubscriberPublisher& pub);
+
   ros::NodeHandle nh_;
+  //! set when a subscriber connects to a latched grid that only changes with patches
+  //! or periodically, so that the next update sends the current grid right away
+  mutable std::atomic<bool> need_full_grid_;
+  mutable std::atomic<bool> need_coarse_grid_;
   ros::Publisher pub_;
+  ros::Publisher update_pub_;
+  ros::Publisher local_pub_;
+  ros::Publisher coarse_pub_;
+  mutable uint64_t last_coarse_ns_ = 0;
+  mutable std::unique_ptr<IncrementalGrid> grid_;
 };
 
 class TsdfOccupancyPublisher : public ReconstructionModule::Sink {
@@ -129,4 +175,18 @@ void declare_config(OccupancyPublisher::Config& config);
 void declare_config(GvdOccupancyPublisher::Config& config);
 void declare_config(TsdfOccupancyPublisher::Config& config);
 
+//! Fill a grid covering the full layer extent (as published by OccupancyPublisher)
+void fillOccupancyGrid(const OccupancyPublisher::Config& config,
+                       const TsdfLayer& tsdf,
+                       const Eigen::Isometry3d& world_T_sensor,
+                       nav_msgs::OccupancyGrid& msg);
+
+void fillOccupancyGrid(const OccupancyPublisher::Config& config,
+                       const places::GvdLayer& gvd,
+                       const Eigen::Isometry3d& world_T_sensor,
+                       nav_msgs::OccupancyGrid& msg);
+
+//! Map a voxel distance to a grid cost in [0, 100] (100 for occupied)
+int8_t getInflatedCost(const OccupancyPublisher::Config& config, float distance);
+
 }  // namespace hydra
@@ -0,0 +1,89 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Geometry>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Fixed-size history of timestamped body poses with interpolation
+ *
+ * Filled from an odometry callback and queried by the input thread. Samples must
+ * arrive in increasing stamp order; out-of-order samples are dropped.
+ */
+class OdometryPoseBuffer {
+ public:
+  struct Pose {
+    uint64_t stamp_ns;
+    Eigen::Vector3d position;
+    Eigen::Quaterniond rotation;
+  };
+
+  explicit OdometryPoseBuffer(size_t capacity);
+
+  //! Add a new sample; returns false if the sample is not newer than the last one
+  bool add(uint64_t stamp_ns,
+           const Eigen::Vector3d& position,
+           const Eigen::Quaterniond& rotation);
+
+  //! Get the interpolated pose at the stamp if it lies within the buffer
+  std::optional<Pose> getPose(uint64_t stamp_ns) const;
+
+  //! Block until the stamp is covered by the buffer or the timeout expires
+  std::optional<Pose> waitForPose(uint64_t stamp_ns, double timeout_s) const;
+
+  //! Whether the stamp predates the oldest sample (and can never be resolved)
+  bool isTooOld(uint64_t stamp_ns) const;
+
+  size_t size() const;
+
+ private:
+  const Pose& at(size_t index) const;
+
+  std::optional<Pose> interpolate(uint64_t stamp_ns) const;
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cv_;
+  std::vector<Pose> poses_;
+  size_t start_;
+  size_t size_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,175 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Process inputs on a pool of worker threads and hand results to a consumer in
+ * the order that the inputs were pushed.
+ *
+ * The consumer is always called from a single thread. push() blocks while max_pending
+ * inputs are either waiting, being processed or waiting to be consumed.
+ */
+template <typename Input, typename Output>
+class OrderedWorkerPool {
+ public:
+  using Processor = std::function<Output(Input&)>;
+  using Consumer = std::function<void(Output&)>;
+
+  OrderedWorkerPool(size_t num_workers,
+                    size_t max_pending,
+                    const Processor& processor,
+                    const Consumer& consumer)
+      : max_pending_(std::max<size_t>(max_pending, 1)),
+        processor_(processor),
+        consumer_(consumer) {
+    for (size_t i = 0; i < std::max<size_t>(num_workers, 1); ++i) {
+      workers_.emplace_back(&OrderedWorkerPool::work, this);
+    }
+
+    consumer_thread_ = std::thread(&OrderedWorkerPool::consume, this);
+  }
+
+  ~OrderedWorkerPool() { finish(); }
+
+  void push(Input&& input) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    slot_available_.wait(lock, [this] { return num_pending_ < max_pending_; });
+    inputs_.emplace_back(next_input_, std::move(input));
+    ++next_input_;
+    ++num_pending_;
+    input_available_.notify_one();
+  }
+
+  //! Wait for all pushed inputs to be consumed and stop all threads
+  void finish() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (finished_) {
+        return;
+      }
+
+      finished_ = true;
+    }
+
+    input_available_.notify_all();
+    output_available_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+
+    consumer_thread_.join();
+  }
+
+ private:
+  void work() {
+    while (true) {
+      std::pair<size_t, Input> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        input_available_.wait(lock, [this] { return finished_ || !inputs_.empty(); });
+        if (inputs_.empty()) {
+          return;
+        }
+
+        job = std::move(inputs_.front());
+        inputs_.pop_front();
+      }
+
+      auto output = processor_(job.second);
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      outputs_.emplace(job.first, std::move(output));
+      output_available_.notify_one();
+    }
+  }
+
+  void consume() {
+    while (true) {
+      Output output;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        output_available_.wait(lock, [this] {
+          return outputs_.count(next_output_) ||
+                 (finished_ && next_output_ == next_input_);
+        });
+
+        auto iter = outputs_.find(next_output_);
+        if (iter == outputs_.end()) {
+          return;
+        }
+
+        output = std::move(iter->second);
+        outputs_.erase(iter);
+        ++next_output_;
+      }
+
+      consumer_(output);
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      --num_pending_;
+      slot_available_.notify_one();
+    }
+  }
+
+  const size_t max_pending_;
+  const Processor processor_;
+  const Consumer consumer_;
+
+  std::mutex mutex_;
+  std::condition_variable input_available_;
+  std::condition_variable output_available_;
+  std::condition_variable slot_available_;
+  bool finished_ = false;
+  size_t num_pending_ = 0;
+  size_t next_input_ = 0;
+  size_t next_output_ = 0;
+  std::deque<std::pair<size_t, Input>> inputs_;
+  std::map<size_t, Output> outputs_;
+
+  std::vector<std::thread> workers_;
+  std::thread consumer_thread_;
+};
+
+}  // namespace hydra
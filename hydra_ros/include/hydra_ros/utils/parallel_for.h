@@ -0,0 +1,78 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Call func(i) for every i in [0, num_items) using up to num_threads threads
+ *
+ * Items are split into one contiguous range per thread and the calling thread handles
+ * the first range. Runs inline when num_threads <= 1.
+ */
+template <typename Func>
+void parallelFor(size_t num_items, size_t num_threads, const Func& func) {
+  const size_t threads = std::min(num_threads, num_items);
+  if (threads <= 1) {
+    for (size_t i = 0; i < num_items; ++i) {
+      func(i);
+    }
+
+    return;
+  }
+
+  const size_t chunk_size = (num_items + threads - 1) / threads;
+  const auto run_range = [&func](size_t start, size_t end) {
+    for (size_t i = start; i < end; ++i) {
+      func(i);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t start = chunk_size; start < num_items; start += chunk_size) {
+    workers.emplace_back(run_range, start, std::min(start + chunk_size, num_items));
+  }
+
+  run_range(0, chunk_size);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace hydra
@@ -0,0 +1,122 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#pragma once
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief End-to-end timing report for a pipeline run that can be compared to a baseline
+ *
+ * Collects the statistics of the configured ElapsedTimeRecorder timers once the run is
+ * over, writes them as CSV (which is also the baseline format) and JSON, and flags
+ * stages whose mean latency grew or whose throughput dropped by more than the
+ * tolerance relative to the baseline.
+ */
+class PipelineBenchmark {
+ public:
+  struct Config {
+    //! Directory to write benchmark.csv and benchmark.json to (disabled if empty)
+    std::string output_path = "";
+    //! Results of a previous run (as written to benchmark.csv) to compare against
+    std::string baseline_path = "";
+    //! Timer names of the stages to report
+    std::vector<std::string> stages{"reconstruction/spin",
+                                    "frontend/spin",
+                                    "backend/spin",
+                                    "lcd/spin",
+                                    "frontend",
+                                    "backend"};
+    //! Relative change of a stage that counts as a regression
+    double tolerance = 0.1;
+    //! Latency changes below this are never regressions (avoids noise on fast stages)
+    double min_delta_s = 1.0e-3;
+  } const config;
+
+  struct Stage {
+    std::string name;
+    size_t count = 0;
+    double mean_s = 0.0;
+    double min_s = 0.0;
+    double max_s = 0.0;
+    double total_s = 0.0;
+    double throughput_hz = 0.0;
+  };
+
+  struct Regression {
+    std::string stage;
+    std::string metric;
+    double baseline = 0.0;
+    double current = 0.0;
+  };
+
+  using Report = std::vector<Stage>;
+
+  explicit PipelineBenchmark(const Config& config);
+
+  bool enabled() const;
+
+  //! Mark the start of the run (throughput is measured from here)
+  void start();
+
+  //! Collect, write and compare results; returns the regressions against the baseline
+  std::vector<Regression> finish() const;
+
+  //! Statistics of the given timers over a run of duration_s
+  static Report collect(const std::vector<std::string>& stages, double duration_s);
+
+  static std::string toCsv(const Report& report);
+
+  static std::string toJson(const Report& report, double duration_s);
+
+  //! Parse a report written by toCsv (nullopt if malformed)
+  static std::optional<Report> fromCsv(const std::string& contents);
+
+  static std::vector<Regression> compare(const Report& baseline,
+                                         const Report& current,
+                                         double tolerance,
+                                         double min_delta_s);
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+void declare_config(PipelineBenchmark::Config& config);
+
+}  // namespace hydra
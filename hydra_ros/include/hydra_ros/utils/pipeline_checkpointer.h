@@ -0,0 +1,138 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/backend/backend_module.h>
+#include <hydra/frontend/frontend_module.h>
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+//! Files that make up a checkpoint (inside a checkpoint directory)
+struct CheckpointFiles {
+  inline static const std::string frontend_dsg = "frontend_dsg.sparkdsg";
+  inline static const std::string backend_dsg = "backend_dsg.sparkdsg";
+  inline static const std::string deformation_graph = "deformation_graph.dgrf";
+};
+
+//! Most recent complete checkpoint under a directory (if any)
+std::optional<std::filesystem::path> findLatestCheckpoint(
+    const std::filesystem::path& directory);
+
+/**
+ * @brief Periodically saves the frontend and backend state for crash recovery
+ *
+ * The frontend and backend sinks serialize their graph into a single buffer at most
+ * once per period and a background thread turns the buffers into files, so the
+ * modules only pay for the serialization. The deformation graph can neither be copied
+ * nor serialized into memory, so the backend sink saves it into a staging directory
+ * (in memory by default) and the background thread moves it into the checkpoint.
+ * Checkpoints are written to a temporary directory that is renamed once complete, so
+ * a crash never leaves a partial checkpoint behind. Must be constructed as a shared
+ * pointer (the sinks keep the checkpointer alive).
+ */
+class PipelineCheckpointer : public std::enable_shared_from_this<PipelineCheckpointer> {
+ public:
+  using Ptr = std::shared_ptr<PipelineCheckpointer>;
+
+  struct Config {
+    //! Directory to keep checkpoints in (disabled if empty)
+    std::string directory = "";
+    //! Minimum time between checkpoints
+    double period_s = 60.0;
+    //! Number of most recent checkpoints to keep
+    size_t num_checkpoints = 2;
+    //! Resume from the latest checkpoint in the directory on startup
+    bool resume = false;
+    //! Where the backend saves the deformation graph (checkpoint directory if empty)
+    std::string staging_directory = "/dev/shm";
+  } const config;
+
+  explicit PipelineCheckpointer(const Config& config);
+
+  ~PipelineCheckpointer();
+
+  FrontendModule::Sink::Ptr frontendSink();
+
+  BackendModule::Sink::Ptr backendSink();
+
+  //! Serialize the frontend graph if a checkpoint is due
+  void saveFrontend(uint64_t timestamp_ns, const DynamicSceneGraph& graph);
+
+  //! Serialize the backend graph and stage the deformation graph if a checkpoint is due
+  void saveBackend(uint64_t timestamp_ns,
+                   const DynamicSceneGraph& graph,
+                   const kimera_pgmo::DeformationGraph& dgraph);
+
+ private:
+  struct Snapshot {
+    uint64_t timestamp_ns = 0;
+    std::shared_ptr<const std::vector<uint8_t>> serialized;
+  };
+
+  static Snapshot makeSnapshot(uint64_t timestamp_ns, const DynamicSceneGraph& graph);
+
+  bool due(uint64_t timestamp_ns, std::optional<uint64_t>& last_ns) const;
+
+  void writeLoop();
+
+  void writeCheckpoint(const Snapshot& frontend,
+                       const Snapshot& backend,
+                       const std::filesystem::path& dgrf_path) const;
+
+  void pruneCheckpoints() const;
+
+  std::filesystem::path staging_directory_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool should_shutdown_;
+  std::optional<uint64_t> last_frontend_ns_;
+  std::optional<uint64_t> last_backend_ns_;
+  Snapshot frontend_;
+  Snapshot backend_;
+  //! deformation graph staged by the backend sink for the pending checkpoint
+  std::filesystem::path pending_dgrf_;
+  std::unique_ptr<std::thread> thread_;
+};
+
+void declare_config(PipelineCheckpointer::Config& config);
+
+}  // namespace hydra
@@ -37,6 +37,7 @@
 
 #include <Eigen/Geometry>
 #include <filesystem>
+#include <map>
 
 namespace rosbag {
 class Bag;
@@ -44,11 +45,15 @@ class Bag;
 
 namespace hydra {
 
+class BagMetadata;
+
 class PoseCache {
  public:
   struct Config {
     std::filesystem::path bag_path;
     bool static_only = false;
+    //! directory to cache extracted bag metadata in (no disk cache if empty)
+    std::filesystem::path metadata_cache_dir;
   };
 
   struct PoseResult {
@@ -63,16 +68,47 @@ class PoseCache {
     }
   };
 
+  struct PoseSample {
+    uint64_t timestamp_ns;
+    Eigen::Vector3d to_p_from;
+    Eigen::Quaterniond to_R_from;
+  };
+
+  using Trajectory = std::vector<PoseSample>;
+
+  //! Construct an empty cache that only answers lookups from loaded trajectories
+  PoseCache();
+
   explicit PoseCache(const Config& config);
 
   explicit PoseCache(const rosbag::Bag& bag, bool static_only = false);
 
+  explicit PoseCache(const BagMetadata& metadata, bool static_only = false);
+
   PoseResult lookupPose(uint64_t timestamp_ns,
                         const std::string& to_frame,
                         const std::string& from_frame) const;
 
+  /**
+   * @brief Resolve the pose between two frames at every tf timestamp in the bag
+   *
+   * Subsequent lookups for the frame pair use a binary search and interpolation over
+   * the extracted trajectory instead of querying tf.
+   */
+  bool indexTrajectory(const std::string& to_frame, const std::string& from_frame);
+
+  bool saveTrajectory(const std::filesystem::path& filepath,
+                      const std::string& to_frame,
+                      const std::string& from_frame) const;
+
+  bool loadTrajectory(const std::filesystem::path& filepath,
+                      const std::string& to_frame,
+                      const std::string& from_frame);
+
  private:
   std::shared_ptr<tf2::BufferCore> buffer_;
+  std::vector<uint64_t> tf_stamps_;
+  std::map<std::pair<std::string, std::string>, Trajectory> trajectories_;
 };
 
 void declare_config(PoseCache::Config& config);
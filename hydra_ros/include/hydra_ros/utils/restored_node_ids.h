@@ -0,0 +1,64 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+
+namespace hydra {
+
+/**
+ * @brief Moves the static nodes of a graph restored by a warm start out of the way
+ *
+ * The frontend numbers new places, objects, etc. from zero for every prefix and those
+ * counters are not part of any saved state, so a resumed node would hand out ids that
+ * the restored graph already uses. Restored static nodes are therefore moved into a
+ * block of indices that no earlier run used (one block per restart). Nodes in dynamic
+ * layers keep their ids, as new agent nodes are numbered after the restored ones.
+ */
+struct RestoredNodeIds {
+  //! Number of indices per block (block 0 is what the frontend allocates from)
+  inline static constexpr size_t kBlockSize = size_t(1) << 40;
+
+  //! First block that no static node of the graph uses
+  static size_t findFreeBlock(const DynamicSceneGraph& graph);
+
+  //! Id of a restored node in the block (nodes outside block 0 are unchanged)
+  static NodeId shift(NodeId node_id, size_t block);
+
+  //! Copy of the graph with every static node in block 0 moved to the block
+  static DynamicSceneGraph::Ptr shiftGraph(const DynamicSceneGraph& graph,
+                                           size_t block);
+};
+
+}  // namespace hydra
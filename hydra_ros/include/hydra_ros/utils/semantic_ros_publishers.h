@@ -38,14 +38,15 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace hydra {
 
 template <class LabelType, class MsgType>
 class SemanticRosPublishers {
-  typedef std::unordered_map<LabelType, ros::Publisher> SemanticRosPubs;
-
  public:
+  using Indices = std::vector<size_t>;
+
   /**
    * @brief SemanticRosPublishers Publishes a msg in a different ROS topic
    * defined by the semantic label. This is a convenience class
@@ -55,7 +56,7 @@ class SemanticRosPublishers {
    */
   SemanticRosPublishers(const std::string& topic_name,
                         const ros::NodeHandle& nh_private)
-      : topic_name_(topic_name), nh_private_(nh_private), pubs_() {}
+      : topic_name_(topic_name), nh_private_(nh_private), entries_() {}
 
   virtual ~SemanticRosPublishers() = default;
 
@@ -65,36 +66,133 @@ class SemanticRosPublishers {
    * is advertised with the name given by topic_name_.
    */
   void publish(const LabelType& semantic_label, const MsgType& msg) {
-    // Publish centroids for each semantic label
-    const auto& pub_it = pubs_.find(semantic_label);
-    if (pub_it == pubs_.end()) {
-      pubs_[semantic_label] = nh_private_.advertise<MsgType>(
-          topic_name_ + "_semantic_label_" + std::to_string(semantic_label), 1, true);
+    getEntry(semantic_label).pub.publish(msg);
+  }
+
+  /**
+   * @brief Fill and publish the message for a label if anything subscribes to it
+   *
+   * The topic is advertised on first use so that subscribers can connect. The
+   * message passed to fill is reused between calls for the same label, and fill
+   * returns false to skip publishing.
+   * @returns whether a message was published
+   */
+  template <typename FillFunc>
+  bool publish(const LabelType& semantic_label, const FillFunc& fill) {
+    auto& entry = getEntry(semantic_label);
+    if (entry.pub.getNumSubscribers() < 1) {
+      return false;
+    }
+
+    if (!fill(semantic_label, entry.msg)) {
+      return false;
+    }
+
+    entry.pub.publish(entry.msg);
+    return true;
+  }
+
+  /**
+   * @brief Group items by label in a single pass
+   *
+   * Items with labels that nobody subscribes to are skipped (their topics still get
+   * advertised). The index buffers are reused between calls.
+   * @param num_items Number of items to partition
+   * @param label_of Function returning the label of the i-th item
+   * @returns labels that have subscribers and at least one item
+   */
+  template <typename LabelFunc>
+  const std::vector<LabelType>& partition(size_t num_items, const LabelFunc& label_of) {
+    for (auto& [label, entry] : entries_) {
+      entry.indices.clear();
+      entry.checked = false;
+    }
+
+    partition_labels_.clear();
+    Entry* entry = nullptr;
+    for (size_t i = 0; i < num_items; ++i) {
+      const LabelType label = label_of(i);
+      // consecutive items usually share a label
+      if (!entry || entry->label != label) {
+        entry = &getEntry(label);
+      }
+
+      if (!entry->checked) {
+        entry->checked = true;
+        entry->subscribed = entry->pub.getNumSubscribers() > 0;
+        if (entry->subscribed) {
+          partition_labels_.push_back(label);
+        }
+      }
+
+      if (entry->subscribed) {
+        entry->indices.push_back(i);
+      }
     }
-    // Publish semantic pointcloud
-    pubs_.at(semantic_label).publish(msg);
+
+    return partition_labels_;
+  }
+
+  //! Indices of the items with the label from the last partition
+  const Indices& indices(const LabelType& semantic_label) const {
+    return entries_.at(semantic_label).indices;
   }
 
   /**
-   * Derive the topic name from the label.
+   * @brief Fill and publish a message for every label of the last partition
+   * @param fill Called with the label, its item indices and the reused message
    */
-  std::string getTopic(const LabelType& semantic_label) {
-    const auto& pub_it = pubs_.find(semantic_label);
-    if (pub_it == pubs_.end()) {
-      pubs_[semantic_label] = nh_private_.advertise<MsgType>(
-          topic_name_ + "_semantic_label_" + std::to_string(semantic_label), 1, true);
+  template <typename FillFunc>
+  void publishPartition(const FillFunc& fill) {
+    for (const auto& label : partition_labels_) {
+      auto& entry = entries_.at(label);
+      if (fill(label, entry.indices, entry.msg)) {
+        entry.pub.publish(entry.msg);
+      }
     }
-    return pubs_.at(semantic_label).getTopic();
+  }
+
+  /**
+   * Derive the topic name from the label (without advertising it).
+   */
+  std::string getTopic(const LabelType& semantic_label) const {
+    return nh_private_.resolveName(getTopicName(semantic_label));
   }
 
   std::string get_prefix() { return topic_name_; }
 
  private:
+  struct Entry {
+    LabelType label;
+    ros::Publisher pub;
+    Indices indices;
+    MsgType msg;
+    bool checked = false;
+    bool subscribed = false;
+  };
+
+  std::string getTopicName(const LabelType& semantic_label) const {
+    return topic_name_ + "_semantic_label_" + std::to_string(semantic_label);
+  }
+
+  Entry& getEntry(const LabelType& semantic_label) {
+    auto iter = entries_.find(semantic_label);
+    if (iter != entries_.end()) {
+      return iter->second;
+    }
+
+    auto& entry = entries_[semantic_label];
+    entry.label = semantic_label;
+    entry.pub = nh_private_.advertise<MsgType>(getTopicName(semantic_label), 1, true);
+    return entry;
+  }
+
   /// Prepended string to the ROS topic that is to be advertised.
   std::string topic_name_;
 
   ros::NodeHandle nh_private_;
-  SemanticRosPubs pubs_;
+  std::unordered_map<LabelType, Entry> entries_;
+  std::vector<LabelType> partition_labels_;
 };
 
 }  // namespace hydra
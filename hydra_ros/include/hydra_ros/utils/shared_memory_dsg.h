@@ -0,0 +1,130 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace hydra {
+
+struct SharedDsgLayout;
+
+/**
+ * @brief Publishes serialized scene graphs into a double-buffered shared-memory segment
+ *
+ * Each write goes into the slot that readers are not currently using, and a global
+ * sequence counter is bumped once the slot is complete. Readers parse directly from
+ * the mapped slot. If both slots are in use, the write is dropped.
+ */
+class SharedDsgWriter {
+ public:
+  /**
+   * @brief Create (or replace) the segment
+   *
+   * Readers need read and write access to the segment, so the default permissions
+   * (0600) only allow readers running as the same user.
+   */
+  SharedDsgWriter(const std::string& name,
+                  size_t capacity_bytes,
+                  int permissions = 0600);
+
+  ~SharedDsgWriter();
+
+  SharedDsgWriter(const SharedDsgWriter&) = delete;
+  SharedDsgWriter& operator=(const SharedDsgWriter&) = delete;
+
+  //! Copy a serialized graph into a free slot; returns false if it was dropped
+  bool write(const uint8_t* data, size_t size, uint64_t stamp_ns);
+
+  inline bool valid() const { return layout_ != nullptr; }
+
+  inline size_t numDropped() const { return num_dropped_; }
+
+ private:
+  bool tryWrite(uint32_t index, const uint8_t* data, size_t size, uint64_t stamp_ns);
+
+  const std::string name_;
+  size_t capacity_;
+  size_t mapped_size_;
+  SharedDsgLayout* layout_;
+  uint8_t* buffers_;
+  uint64_t sequence_;
+  size_t num_dropped_;
+};
+
+class SharedDsgReader {
+ public:
+  using Callback = std::function<void(const uint8_t*, size_t, uint64_t)>;
+
+  explicit SharedDsgReader(const std::string& name);
+
+  ~SharedDsgReader();
+
+  SharedDsgReader(const SharedDsgReader&) = delete;
+  SharedDsgReader& operator=(const SharedDsgReader&) = delete;
+
+  /**
+   * @brief Call func(data, size, stamp_ns) on the latest graph if it is new
+   *
+   * The data pointer is only valid during the callback. Returns false if there is no
+   * writer, nothing new has been written, or the latest slot is being overwritten.
+   * While there is nothing new, the reader checks whether the segment was replaced
+   * (e.g., by a writer that restarted after crashing) and remaps it if so.
+   */
+  bool readLatest(const Callback& func);
+
+  inline bool connected() const { return layout_ != nullptr; }
+
+ private:
+  bool connect();
+
+  void disconnect();
+
+  //! Whether the name now refers to a different segment than the mapped one
+  bool segmentReplaced() const;
+
+  const std::string name_;
+  dev_t device_;
+  ino_t inode_;
+  size_t mapped_size_;
+  SharedDsgLayout* layout_;
+  const uint8_t* buffers_;
+  uint64_t last_sequence_;
+};
+
+}  // namespace hydra
@@ -0,0 +1,195 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <thread>
+
+namespace hydra {
+
+enum class DropPolicy {
+  //! discard the oldest queued item to make room for a new one
+  DROP_OLDEST,
+  //! discard the new item when the queue is full
+  DROP_NEWEST,
+  //! wait for the consumer to make room (items are only dropped after close())
+  BLOCK,
+};
+
+/**
+ * @brief Bounded lock-free queue for handing data from a ROS callback to a worker
+ *
+ * Intended for one producer and one consumer. Slots carry sequence numbers (as in
+ * Vyukov's bounded queue) so that the producer can safely discard the oldest item
+ * under DROP_OLDEST while the consumer is reading another slot.
+ */
+template <typename T>
+class SpscRingBuffer {
+ public:
+  SpscRingBuffer(size_t capacity, DropPolicy policy = DropPolicy::DROP_OLDEST)
+      : policy_(policy), mask_(roundCapacity(capacity) - 1) {
+    slots_.reset(new Slot[mask_ + 1]);
+    for (size_t i = 0; i <= mask_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  //! Add an item; returns false if the item (or an older one) was dropped
+  bool push(T value) {
+    bool dropped = false;
+    while (!tryPush(value)) {
+      if (policy_ == DropPolicy::BLOCK) {
+        if (closed_.load(std::memory_order_acquire)) {
+          num_dropped_.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        continue;
+      }
+
+      if (policy_ == DropPolicy::DROP_NEWEST) {
+        num_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      if (tryPop()) {
+        dropped = true;
+        num_dropped_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        // the consumer is still reading the slot we need
+        std::this_thread::yield();
+      }
+    }
+
+    num_pushed_.fetch_add(1, std::memory_order_relaxed);
+    return !dropped;
+  }
+
+  std::optional<T> pop() { return tryPop(); }
+
+  //! Stop blocking producers (e.g., on shutdown when nothing consumes anymore)
+  void close() { closed_.store(true, std::memory_order_release); }
+
+  //! Number of items currently queued (approximate while other threads are active)
+  size_t size() const {
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    const size_t head = head_.load(std::memory_order_acquire);
+    return tail >= head ? tail - head : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  size_t numPushed() const { return num_pushed_.load(std::memory_order_relaxed); }
+
+  size_t numDropped() const { return num_dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    std::optional<T> value;
+  };
+
+  static size_t roundCapacity(size_t capacity) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  bool tryPush(T& value) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      const size_t seq = slot.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff < 0) {
+        return false;
+      }
+
+      if (diff == 0 &&
+          tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        slot.value = std::move(value);
+        slot.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+
+      if (diff > 0) {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::optional<T> tryPop() {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      const size_t seq = slot.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+      if (diff < 0) {
+        return std::nullopt;
+      }
+
+      if (diff == 0 &&
+          head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        std::optional<T> value = std::move(slot.value);
+        slot.value.reset();
+        slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return value;
+      }
+
+      if (diff > 0) {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  const DropPolicy policy_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  std::atomic<size_t> num_pushed_{0};
+  std::atomic<size_t> num_dropped_{0};
+  std::atomic<bool> closed_{false};
+};
+
+}  // namespace hydra
@@ -0,0 +1,217 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Matches messages from N streams by stamp, preferring identical stamps
+ *
+ * Every stream keeps its pending messages in a fixed-size ring allocated up front, so
+ * adding a message never allocates. Stream 0 is the reference: a reference message is
+ * matched as soon as every other stream has a message with the identical stamp.
+ * Otherwise, each other stream contributes its closest message once it has seen a
+ * message at or after the reference stamp (so no closer message can still arrive),
+ * and the match is rejected if any stamp differs by more than the tolerance. Streams
+ * are expected to deliver messages in stamp order; older messages are dropped.
+ */
+template <typename T, size_t N>
+class StampSynchronizer {
+ public:
+  using Items = std::array<T, N>;
+  using Callback = std::function<void(const Items&)>;
+
+  StampSynchronizer(size_t capacity, uint64_t tolerance_ns, const Callback& callback)
+      : tolerance_ns_(tolerance_ns), callback_(callback) {
+    for (auto& ring : rings_) {
+      ring.slots.resize(std::max<size_t>(capacity, 1));
+    }
+  }
+
+  //! Add a message to a stream; invokes the callback (outside the lock) per match
+  void add(size_t stream, uint64_t stamp_ns, const T& item) {
+    {  // start critical section
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& ring = rings_.at(stream);
+      if (ring.latest && stamp_ns <= *ring.latest) {
+        ++num_dropped_;
+        return;
+      }
+
+      if (ring.size == ring.slots.size()) {
+        ring.pop();
+        ++num_dropped_;
+      }
+
+      ring.push(stamp_ns, item);
+    }  // end critical section
+
+    Items matched;
+    while (match(matched)) {
+      callback_(matched);
+    }
+  }
+
+  size_t numMatched() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_matched_;
+  }
+
+  //! Messages discarded without being matched (ring overflow, order or tolerance)
+  size_t numDropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_dropped_;
+  }
+
+ private:
+  struct Slot {
+    uint64_t stamp_ns = 0;
+    T item;
+  };
+
+  struct Ring {
+    std::vector<Slot> slots;
+    size_t head = 0;
+    size_t size = 0;
+    std::optional<uint64_t> latest;
+
+    Slot& at(size_t i) { return slots[(head + i) % slots.size()]; }
+
+    void push(uint64_t stamp_ns, const T& item) {
+      auto& slot = at(size);
+      slot.stamp_ns = stamp_ns;
+      slot.item = item;
+      ++size;
+      latest = stamp_ns;
+    }
+
+    void pop() {
+      at(0).item = T();
+      head = (head + 1) % slots.size();
+      --size;
+    }
+  };
+
+  static uint64_t absDiff(uint64_t lhs, uint64_t rhs) {
+    return lhs > rhs ? lhs - rhs : rhs - lhs;
+  }
+
+  //! Index of the exact or closest message in the ring (nullopt: wait for more)
+  std::optional<size_t> findPartner(Ring& ring, uint64_t stamp_ns) const {
+    std::optional<size_t> closest;
+    for (size_t i = 0; i < ring.size; ++i) {
+      const auto stamp = ring.at(i).stamp_ns;
+      if (stamp == stamp_ns) {
+        return i;
+      }
+
+      if (!closest || absDiff(stamp, stamp_ns) < absDiff(ring.at(*closest).stamp_ns,
+                                                         stamp_ns)) {
+        closest = i;
+      }
+    }
+
+    if (!ring.latest || *ring.latest < stamp_ns) {
+      return std::nullopt;
+    }
+
+    return closest;
+  }
+
+  bool match(Items& matched) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& reference = rings_[0];
+    while (reference.size > 0) {
+      const auto stamp_ns = reference.at(0).stamp_ns;
+      std::array<size_t, N> partners;
+      bool complete = true;
+      bool rejected = false;
+      for (size_t s = 1; s < N; ++s) {
+        const auto partner = findPartner(rings_[s], stamp_ns);
+        if (!partner) {
+          complete = false;
+          break;
+        }
+
+        partners[s] = *partner;
+        rejected |= absDiff(rings_[s].at(*partner).stamp_ns, stamp_ns) > tolerance_ns_;
+      }
+
+      if (!complete) {
+        return false;
+      }
+
+      if (rejected) {
+        // every other stream is past this stamp, so it can never be matched
+        reference.pop();
+        ++num_dropped_;
+        continue;
+      }
+
+      matched[0] = std::move(reference.at(0).item);
+      reference.pop();
+      for (size_t s = 1; s < N; ++s) {
+        auto& ring = rings_[s];
+        matched[s] = std::move(ring.at(partners[s]).item);
+        // older messages could only match older reference messages, which are gone
+        num_dropped_ += partners[s];
+        for (size_t i = 0; i <= partners[s]; ++i) {
+          ring.pop();
+        }
+      }
+
+      ++num_matched_;
+      return true;
+    }
+
+    return false;
+  }
+
+  const uint64_t tolerance_ns_;
+  const Callback callback_;
+  mutable std::mutex mutex_;
+  std::array<Ring, N> rings_;
+  size_t num_matched_ = 0;
+  size_t num_dropped_ = 0;
+};
+
+}  // namespace hydra
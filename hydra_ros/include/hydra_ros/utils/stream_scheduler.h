@@ -0,0 +1,115 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#pragma once
+#include <spark_dsg/scene_graph_types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+
+namespace hydra {
+
+/**
+ * @brief Decides which layers of a scene graph update fit in the bandwidth of a topic
+ *
+ * Bytes are budgeted with a token bucket that refills at bytes_per_second and holds up
+ * to burst_s worth of bytes. Layers with pending changes are considered in order of
+ * decreasing priority and are deferred if they were sent less than min_period_s ago
+ * or if their estimated size does not fit in the remaining budget. The size of a layer
+ * is estimated from the average number of bytes per node sent so far. A layer is
+ * always sent when the bucket is full so that layers larger than the burst still make
+ * progress.
+ */
+class StreamScheduler {
+ public:
+  using LayerId = spark_dsg::LayerId;
+
+  struct LayerConfig {
+    //! Layers with higher priority get the budget first
+    int priority = 0;
+    //! Minimum time between updates of the layer (0 sends every update)
+    double min_period_s = 0.0;
+  };
+
+  struct Config {
+    //! Sustained rate of the topic (0 disables the budget)
+    double bytes_per_second = 0.0;
+    //! Size of the budget in seconds worth of bytes
+    double burst_s = 1.0;
+    //! Initial guess of the serialized size of a node
+    double initial_bytes_per_node = 256.0;
+    //! Used for every layer without an entry in layers
+    LayerConfig default_layer;
+    //! Per-layer settings by layer name (e.g., "rooms" or "places")
+    std::map<std::string, LayerConfig> layers;
+  } const config;
+
+  explicit StreamScheduler(const Config& config);
+
+  //! Pick the layers to send given the number of changed nodes in each layer
+  std::set<LayerId> schedule(uint64_t timestamp_ns,
+                             const std::map<LayerId, size_t>& pending_nodes);
+
+  //! Charge bytes that were sent (num_nodes > 0 also updates the size estimate)
+  void consume(uint64_t timestamp_ns, size_t bytes, size_t num_nodes = 0);
+
+  //! Bytes that can currently be sent without exceeding the budget (may be negative)
+  double available(uint64_t timestamp_ns);
+
+  double bytesPerNode() const { return bytes_per_node_; }
+
+  const LayerConfig& layerConfig(LayerId layer) const;
+
+ private:
+  void refill(uint64_t timestamp_ns);
+
+  double capacity() const;
+
+  std::map<LayerId, LayerConfig> layer_configs_;
+  std::map<LayerId, uint64_t> last_sent_ns_;
+  std::optional<uint64_t> last_refill_ns_;
+  double tokens_;
+  double bytes_per_node_;
+};
+
+void declare_config(StreamScheduler::LayerConfig& config);
+
+void declare_config(StreamScheduler::Config& config);
+
+}  // namespace hydra
@@ -0,0 +1,123 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Merge items from several producers into a single stream ordered by timestamp
+ *
+ * Every producer pushes items in nondecreasing timestamp order into its own bounded
+ * queue. pop() only returns an item once every producer that has not finished has an
+ * item queued, which makes the output globally ordered. push() blocks while the
+ * producer's queue is full.
+ */
+template <typename T>
+class TimestampMerger {
+ public:
+  TimestampMerger(size_t num_sources, size_t capacity)
+      : capacity_(std::max<size_t>(capacity, 1)), sources_(num_sources) {}
+
+  void push(size_t source, uint64_t timestamp_ns, T&& item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto& queue = sources_.at(source);
+    cv_.wait(lock, [&] { return queue.items.size() < capacity_; });
+    queue.items.emplace_back(timestamp_ns, std::move(item));
+    cv_.notify_all();
+  }
+
+  //! Mark a producer as done; its remaining items are still returned
+  void finish(size_t source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sources_.at(source).finished = true;
+    cv_.notify_all();
+  }
+
+  //! Block until the next item is available (nullopt once all producers finished)
+  std::optional<T> pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::optional<size_t> next;
+    cv_.wait(lock, [&] {
+      next.reset();
+      for (size_t i = 0; i < sources_.size(); ++i) {
+        const auto& queue = sources_[i];
+        if (queue.items.empty()) {
+          if (!queue.finished) {
+            return false;  // this producer could still emit an earlier item
+          }
+
+          continue;
+        }
+
+        if (!next || queue.items.front().first < sources_[*next].items.front().first) {
+          next = i;
+        }
+      }
+
+      return true;
+    });
+
+    if (!next) {
+      return std::nullopt;
+    }
+
+    auto& items = sources_[*next].items;
+    std::optional<T> result(std::move(items.front().second));
+    items.pop_front();
+    cv_.notify_all();
+    return result;
+  }
+
+ private:
+  struct Source {
+    bool finished = false;
+    std::deque<std::pair<uint64_t, T>> items;
+  };
+
+  const size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Source> sources_;
+};
+
+}  // namespace hydra
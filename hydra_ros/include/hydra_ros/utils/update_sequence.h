@@ -0,0 +1,82 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace hydra {
+
+/**
+ * @brief Tracks which full and delta updates a receiver can apply
+ *
+ * Deltas only apply on top of the previous message. After a gap every delta is
+ * rejected until the next full update arrives. A resync is requested for the first
+ * rejected update and again every `resync_retry` rejections in case the request (or
+ * the full update answering it) was lost.
+ */
+class UpdateSequence {
+ public:
+  explicit UpdateSequence(size_t resync_retry = 10)
+      : resync_retry_(std::max<size_t>(resync_retry, 1)) {}
+
+  //! Whether an update can be applied on top of the last applied one
+  bool canApply(int64_t sequence_number, bool full_update) const {
+    return full_update || (last_ && sequence_number == *last_ + 1);
+  }
+
+  //! Record an update that was applied
+  void applied(int64_t sequence_number) {
+    last_ = sequence_number;
+    num_rejected_ = 0;
+  }
+
+  //! Record an update that could not be applied; returns whether to request a resync
+  bool rejected() {
+    last_.reset();
+    return num_rejected_++ % resync_retry_ == 0;
+  }
+
+  //! Sequence number of the last applied update (if any)
+  std::optional<int64_t> last() const { return last_; }
+
+ private:
+  const size_t resync_retry_;
+  std::optional<int64_t> last_;
+  size_t num_rejected_ = 0;
+};
+
+}  // namespace hydra
@@ -36,6 +36,8 @@
 #include <config_utilities/factory.h>
 #include <visualization_msgs/MarkerArray.h>
 
+#include <unordered_map>
+
 #include "hydra_ros/visualizer/dsg_visualizer_plugin.h"
 
 namespace hydra {
@@ -70,23 +72,44 @@ class BasisPointPlugin : public DsgVisualizerPlugin {
 
   void reset(const std_msgs::Header& header, const DynamicSceneGraph& graph) override;
 
+  bool usesConfigs() const override { return false; }
+
  protected:
+  //! Basis points of a place as of the attributes they were computed from
+  struct CacheEntry {
+    NodeAttributes::Ptr attrs;
+    std::vector<geometry_msgs::Point> points;
+    std::vector<std_msgs::ColorRGBA> colors;
+    uint64_t generation = 0;
+  };
+
+  //! Recompute basis points for places whose attributes changed since the last draw
+  void updateCache(const DynamicSceneGraph& graph);
+
   void drawNodes(const std_msgs::Header& header,
                  const DynamicSceneGraph& graph,
                  visualization_msgs::MarkerArray& msg) const;
 
   void drawEdges(const std_msgs::Header& header,
                  const DynamicSceneGraph& graph,
-                 visualization_msgs::MarkerArray& msg) const;
+                 visualization_msgs::MarkerArray& msg);
 
   void drawBasisPoints(const std_msgs::Header& header,
                        const DynamicSceneGraph& graph,
-                       visualization_msgs::MarkerArray& msg) const;
+                       visualization_msgs::MarkerArray& msg);
 
   ros::Publisher pub_;
   mutable std::set<std::string> published_;
   std::unique_ptr<SemanticColorMap> colormap_;
 
+  std::unordered_map<NodeId, CacheEntry> cache_;
+  uint64_t generation_ = 0;
+  const spark_dsg::Mesh* cached_mesh_ = nullptr;
+  size_t cached_mesh_size_ = 0;
+  //! marker buffers are reused between draws to avoid reallocating the point lists
+  visualization_msgs::Marker edge_marker_;
+  visualization_msgs::Marker basis_marker_;
+
   inline static const auto registration_ =
       config::RegistrationWithConfig<DsgVisualizerPlugin,
                                      BasisPointPlugin,
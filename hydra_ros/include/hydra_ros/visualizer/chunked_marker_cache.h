@@ -0,0 +1,213 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spatial_hash/block_layer.h>
+#include <std_msgs/Header.h>
+#include <visualization_msgs/MarkerArray.h>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Splits a block layer marker into one marker per spatial chunk
+ *
+ * Blocks are grouped into cubic chunks of blocks_per_chunk blocks. A chunk's marker is
+ * only regenerated when one of its blocks has the updated flag set or the blocks
+ * assigned to the chunk change (e.g., from allocation, removal or cropping). Chunks
+ * that disappear are sent as deletions.
+ */
+class ChunkedMarkerCache {
+ public:
+  struct Config {
+    //! Generate one marker per chunk instead of a single marker for the layer
+    bool enable = true;
+    //! Number of blocks along each side of a chunk
+    int blocks_per_chunk = 4;
+    //! Only draw blocks within this distance of the sensor (disabled if non-positive)
+    double crop_radius = -1.0;
+  } const config;
+
+  template <typename BlockT>
+  using FillFunc = std::function<void(const BlockT&, visualization_msgs::Marker&)>;
+
+  explicit ChunkedMarkerCache(const Config& config);
+
+  /**
+   * @brief Compute the markers for every chunk that changed since the last update
+   * @param header Header to use for the markers
+   * @param layer Layer to draw
+   * @param sensor_pos Center of the crop radius
+   * @param prototype Marker (namespace, type, scale, etc.) that chunks are copied from
+   * @param fill Adds the points and colors of a single block to a marker
+   * @param force Regenerate every chunk (e.g., after a config change)
+   */
+  template <typename BlockT>
+  visualization_msgs::MarkerArray update(const std_msgs::Header& header,
+                                         const spatial_hash::BlockLayer<BlockT>& layer,
+                                         const Eigen::Vector3d& sensor_pos,
+                                         const visualization_msgs::Marker& prototype,
+                                         const FillFunc<BlockT>& fill,
+                                         bool force = false);
+
+  //! Regenerate every chunk on the next update if the subscriber count grows
+  void setNumSubscribers(size_t num_subscribers);
+
+  //! Forget all published chunks so that the next update regenerates everything
+  void clear();
+
+  size_t numChunks() const { return published_.size(); }
+
+  //! Number of chunks regenerated by the last update
+  size_t numUpdated() const { return num_updated_; }
+
+ private:
+  struct IndexHash {
+    size_t operator()(const spatial_hash::BlockIndex& index) const;
+  };
+
+  struct ChunkInfo {
+    int id = 0;
+    uint64_t signature = 0;
+  };
+
+  spatial_hash::BlockIndex getChunkIndex(const spatial_hash::BlockIndex& index) const;
+
+  int getChunkId(const spatial_hash::BlockIndex& chunk);
+
+  static uint64_t hashIndex(const spatial_hash::BlockIndex& index);
+
+  size_t num_updated_ = 0;
+  size_t num_subscribers_ = 0;
+  bool refresh_ = false;
+  int next_id_ = 0;
+  std::unordered_map<spatial_hash::BlockIndex, ChunkInfo, IndexHash> published_;
+  std::unordered_map<spatial_hash::BlockIndex, int, IndexHash> chunk_ids_;
+};
+
+void declare_config(ChunkedMarkerCache::Config& config);
+
+template <typename BlockT>
+visualization_msgs::MarkerArray ChunkedMarkerCache::update(
+    const std_msgs::Header& header,
+    const spatial_hash::BlockLayer<BlockT>& layer,
+    const Eigen::Vector3d& sensor_pos,
+    const visualization_msgs::Marker& prototype,
+    const FillFunc<BlockT>& fill,
+    bool force) {
+  struct Chunk {
+    std::vector<const BlockT*> blocks;
+    uint64_t signature = 0;
+    bool updated = false;
+  };
+
+  std::unordered_map<spatial_hash::BlockIndex, Chunk, IndexHash> chunks;
+  for (const auto& block : layer) {
+    if (config.crop_radius > 0.0) {
+      const Eigen::Vector3d center =
+          block.origin().template cast<double>() +
+          Eigen::Vector3d::Constant(block.block_size / 2.0);
+      if ((center - sensor_pos).norm() > config.crop_radius) {
+        continue;
+      }
+    }
+
+    auto& chunk = chunks[getChunkIndex(block.index)];
+    chunk.blocks.push_back(&block);
+    // order-independent so that the signature only depends on the set of blocks
+    chunk.signature += hashIndex(block.index);
+    chunk.updated |= block.updated;
+  }
+
+  visualization_msgs::MarkerArray msg;
+  auto iter = published_.begin();
+  while (iter != published_.end()) {
+    if (chunks.count(iter->first)) {
+      ++iter;
+      continue;
+    }
+
+    auto& marker = msg.markers.emplace_back();
+    marker.header = header;
+    marker.action = visualization_msgs::Marker::DELETE;
+    marker.ns = prototype.ns;
+    marker.id = iter->second.id;
+    iter = published_.erase(iter);
+  }
+
+  force |= refresh_;
+  refresh_ = false;
+  num_updated_ = 0;
+  for (const auto& [index, chunk] : chunks) {
+    auto prev = published_.find(index);
+    const bool unchanged = prev != published_.end() &&
+                           prev->second.signature == chunk.signature && !chunk.updated;
+    if (unchanged && !force) {
+      continue;
+    }
+
+    ++num_updated_;
+    const auto id = getChunkId(index);
+    auto& marker = msg.markers.emplace_back(prototype);
+    marker.header = header;
+    marker.id = id;
+    for (const auto block : chunk.blocks) {
+      fill(*block, marker);
+    }
+
+    if (!marker.points.empty()) {
+      published_[index] = {id, chunk.signature};
+      continue;
+    }
+
+    // nothing to draw: make sure nothing is left over from a previous update
+    marker = visualization_msgs::Marker();
+    marker.header = header;
+    marker.action = visualization_msgs::Marker::DELETE;
+    marker.ns = prototype.ns;
+    marker.id = id;
+    if (prev == published_.end()) {
+      msg.markers.pop_back();
+    } else {
+      published_.erase(prev);
+    }
+  }
+
+  return msg;
+}
+
+}  // namespace hydra
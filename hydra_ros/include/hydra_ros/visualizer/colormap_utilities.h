@@ -35,6 +35,8 @@
 #pragma once
 #include <std_msgs/ColorRGBA.h>
 
+#include <vector>
+
 #include "hydra_ros/visualizer/visualizer_types.h"
 
 namespace hydra::dsg_utils {
@@ -51,6 +53,35 @@ inline double computeRatio(double min, double max, double value) {
 
 std_msgs::ColorRGBA makeColorMsg(const Color& color, double alpha = -1.0);
 
+/**
+ * @brief Colormap sampled at evenly spaced ratios
+ *
+ * Looking up a color replaces the HLS conversion per voxel or node with an index
+ * into the table.
+ */
+class ColormapLut {
+ public:
+  static constexpr size_t kNumEntries = 1024;
+
+  explicit ColormapLut(const ColormapConfig& config);
+
+  //! Exact color at the ratio without going through the table
+  static Color compute(const ColormapConfig& config, double ratio);
+
+  //! Whether the table was built from a config with the same colormap parameters
+  bool matches(const ColormapConfig& config) const;
+
+  //! Color of the entry nearest to the (clamped) ratio
+  const Color& lookup(double ratio) const;
+
+ private:
+  ColormapConfig config_;
+  std::vector<Color> colors_;
+};
+
+//! Table for the config, rebuilt only when the colormap parameters change
+const ColormapLut& getColormapLut(const ColormapConfig& config);
+
 Color interpolateColorMap(const ColormapConfig& config, double ratio);
 
 }  // namespace hydra::dsg_utils
@@ -36,6 +36,8 @@
 #include <dynamic_reconfigure/server.h>
 #include <ros/ros.h>
 
+#include <mutex>
+
 #include "hydra_ros/visualizer/visualizer_types.h"
 
 namespace hydra {
@@ -95,6 +97,15 @@ class ConfigManager {
 
   virtual bool hasChange() const;
 
+  //! Whether the global visualizer config changed (which affects every layer)
+  bool visualizerConfigChanged() const;
+
+  bool layerConfigChanged(LayerId layer) const;
+
+  bool dynamicLayerConfigChanged(LayerId layer) const;
+
+  bool colormapChanged(const std::string& name) const;
+
   virtual void clearChangeFlags();
 
   const VisualizerConfig& getVisualizerConfig() const;
@@ -113,6 +124,8 @@ class ConfigManager {
   mutable std::map<LayerId, ConfigWrapper<DynamicLayerConfig>::Ptr>
       dynamic_layer_configs_;
   mutable std::map<std::string, ConfigWrapper<ColormapConfig>::Ptr> colormaps_;
+  //! configs are created lazily, possibly while markers are drawn in parallel
+  mutable std::mutex mutex_;
 };
 
 }  // namespace hydra
@@ -61,8 +61,16 @@ class DsgVisualizerPlugin {
 
   virtual void clearChangeFlag() {}
 
+  //! Whether draw reads the configs, i.e., the plugin has to redraw on config changes
+  virtual bool usesConfigs() const { return true; }
+
+  //! Called by the visualizer before drawing with the revision of the graph to draw
+  void setGraphRevision(uint64_t revision) { graph_revision_ = revision; }
+
  protected:
   ros::NodeHandle nh_;
+  //! changes every time the graph or its mesh is updated
+  uint64_t graph_revision_ = 0;
 };
 
 }  // namespace hydra
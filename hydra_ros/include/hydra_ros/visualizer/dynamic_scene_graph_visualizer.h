@@ -34,14 +34,25 @@
  * -------------------------------------------------------------------------- */
 #pragma once
 #include <ros/ros.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
 #include <visualization_msgs/MarkerArray.h>
 
+#include <atomic>
 #include <functional>
+#include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "hydra_ros/visualizer/config_manager.h"
 #include "hydra_ros/visualizer/dsg_visualizer_plugin.h"
+#include "hydra_ros/visualizer/edge_marker_builder.h"
+#include "hydra_ros/visualizer/label_lod.h"
+#include "hydra_ros/visualizer/mesh_edge_cache.h"
+#include "hydra_ros/visualizer/view_frustum.h"
 #include "hydra_ros/visualizer/visualizer_types.h"
 #include "hydra_ros/visualizer/visualizer_utilities.h"
 
@@ -56,6 +67,14 @@ void clearPrevMarkers(const std_msgs::Header& header,
                       std::set<NodeId>& prev_nodes,
                       MarkerArray& msg);
 
+//! Structure of a layer at the last redraw, used to detect changes between redraws
+struct LayerSnapshot {
+  //! graph revision the layer was last checked at
+  uint64_t revision = 0;
+  std::set<NodeId> nodes;
+  std::map<std::pair<NodeId, NodeId>, double> edges;
+};
+
 class DynamicSceneGraphVisualizer {
  public:
   explicit DynamicSceneGraphVisualizer(const ros::NodeHandle& nh);
@@ -72,7 +91,15 @@ class DynamicSceneGraphVisualizer {
 
   bool redraw();
 
-  void setGraphUpdated() { need_redraw_ = true; }
+  //! Mark the graph as updated without knowing which nodes changed
+  void setGraphUpdated() {
+    need_redraw_ = true;
+    graph_updated_ = true;
+    unknown_change_revision_ = ++graph_revision_;
+  }
+
+  //! Mark the graph as updated where only the given nodes changed
+  void setNodesUpdated(const std::vector<NodeId>& nodes);
 
   void setGraph(const DynamicSceneGraph::Ptr& scene_graph, bool need_reset = true);
 
@@ -80,12 +107,23 @@ class DynamicSceneGraphVisualizer {
 
   bool graphIsSet() const { return scene_graph_.operator bool(); }
 
-  void setNeedRedraw() { need_redraw_ = true; }
+  void setNeedRedraw() {
+    need_redraw_ = true;
+    graph_updated_ = true;
+    unknown_change_revision_ = ++graph_revision_;
+  }
+
+  uint64_t graphRevision() const { return graph_revision_; }
 
   DynamicSceneGraph::Ptr getGraph() const { return scene_graph_; }
 
   void setLayerColorFunction(LayerId layer, const ColorFunction& func);
 
+  void setNeedFullRedraw() {
+    need_redraw_ = true;
+    need_full_redraw_ = true;
+  }
+
   void addUpdateCallback(
       const std::function<void(const DynamicSceneGraph::Ptr&)>& func) {
     callbacks_.push_back(func);
@@ -101,6 +139,19 @@ class DynamicSceneGraphVisualizer {
                          const LayerConfig& config,
                          MarkerArray& msg);
 
+  //! Draw everything for a layer except labels (safe to call for layers in parallel)
+  virtual void drawLayerMarkers(const std_msgs::Header& header,
+                                const SceneGraphLayer& layer,
+                                const LayerConfig& config,
+                                const FilterFunction& filter,
+                                MarkerArray& msg);
+
+  //! Draw layers (and optionally the mesh edges) using num_redraw_threads_ threads
+  void drawLayersParallel(const std_msgs::Header& header,
+                          const std::vector<LayerId>& layer_ids,
+                          bool draw_mesh_edges,
+                          MarkerArray& msg);
+
   virtual void drawLayerMeshEdges(const std_msgs::Header& header,
                                   LayerId layer_id,
                                   const std::string& ns,
@@ -157,6 +208,10 @@ class DynamicSceneGraphVisualizer {
     return boundary_ellipse_ns_prefix_ + std::to_string(layer);
   }
 
+  inline std::string getLayerFrontierNamespace(LayerId layer) const {
+    return frontier_ns_prefix_ + std::to_string(layer);
+  }
+
   inline std::string getLayerBoundaryEdgeNamespace(LayerId layer) const {
     return boundary_ns_prefix_ + "edges_" + std::to_string(layer);
   }
@@ -171,21 +226,97 @@ class DynamicSceneGraphVisualizer {
 
   void deleteLabel(const std_msgs::Header& header, char prefix, MarkerArray& msg);
 
+  void drawLayerLabels(const std_msgs::Header& header,
+                       const SceneGraphLayer& layer,
+                       const LayerConfig& config,
+                       const VisualizerConfig& viz_config,
+                       MarkerArray& msg);
+
+  std::optional<Eigen::Vector3d> getViewerPosition() const;
+
+  std::optional<Eigen::Isometry3d> lookupViewPose(const std::string& frame) const;
+
+  //! Index the layer against the view volume and get a filter for visible nodes
+  FilterFunction getFrustumFilter(const SceneGraphLayer& layer,
+                                  const LayerConfig& config,
+                                  const VisualizerConfig& viz_config);
+
+  bool isVisible(const SceneGraphNode& node) const;
+
   void deleteDynamicLayer(const std_msgs::Header& header,
                           char prefix,
                           MarkerArray& msg);
 
   void drawDynamicLayers(const std_msgs::Header& header, MarkerArray& msg);
 
+  void drawInterlayerEdges(const std_msgs::Header& header,
+                           const std::map<LayerId, LayerConfig>& all_configs,
+                           MarkerArray& msg);
+
+  void drawDynamicInterlayerEdges(const std_msgs::Header& header,
+                                  const std::map<LayerId, LayerConfig>& all_configs,
+                                  MarkerArray& msg);
+
   Color getParentColor(const SceneGraphNode& node) const;
 
+  bool layerChanged(const SceneGraphLayer& layer);
+
+  //! Update the snapshot of a layer and check if the layer changed since it was taken
+  template <typename Nodes, typename Edges>
+  bool snapshotChanged(const Nodes& nodes,
+                       const Edges& edges,
+                       LayerSnapshot& snapshot) const;
+
+  //! Check if the config of the layer or a colormap that the layer uses changed
+  bool layerConfigChanged(LayerId layer_id, const LayerConfig& config) const;
+
+  bool dynamicLayerChanged(LayerId layer_id, const DynamicSceneGraphLayer& layer);
+
+  void onSubscriberConnect(const ros::SingleSubscriberPublisher&);
+
+  //! Publish markers on the main topic or split them between the per-layer topics
+  void publishMarkers(const MarkerArray& msg);
+
+  //! Topic (relative to dsg_markers) for a marker namespace or empty for dsg_markers
+  std::string getMarkerTopic(const std::string& ns) const;
+
+  const ros::Publisher& getTopicPublisher(const std::string& topic);
+
+  //! Whether markers for the topic need to be generated
+  bool hasSubscribers(const std::string& topic);
+
  protected:
   ros::NodeHandle nh_;
   ros::WallTimer visualizer_loop_timer_;
   ConfigManager::Ptr config_manager_;
-
-  bool need_redraw_;
+  std::unique_ptr<EdgeMarkerBuilder> edge_builder_;
+  std::unique_ptr<LabelLod> label_lod_;
+  std::unique_ptr<tf2_ros::Buffer> tf_buffer_;
+  std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
+  std::optional<Eigen::Vector3d> viewer_position_;
+  bool viewer_moved_;
+  std::unique_ptr<ViewFrustum> frustum_;
+  bool frustum_moved_;
+  std::map<LayerId, std::unordered_set<NodeId>> visible_nodes_;
+
+  //! requests are written from the subscriber connect callbacks
+  std::atomic<bool> need_redraw_;
+  std::atomic<bool> need_full_redraw_;
+  //! whether the redraw in progress redraws everything (taken from need_full_redraw_)
+  bool full_redraw_;
+  //! whether the graph changed since the last redraw (instead of only configs)
+  bool graph_updated_;
+  //! incremented whenever the graph is set or updated
+  uint64_t graph_revision_;
+  //! last revision where any node may have changed (updates without node ids)
+  uint64_t unknown_change_revision_;
+  //! last revision each node was marked as changed at
+  std::unordered_map<NodeId, uint64_t> node_revisions_;
   bool periodic_redraw_;
+  bool incremental_redraw_;
+  //! threads used to draw layers and plugins (sequential redraw if 1)
+  size_t num_redraw_threads_;
+  bool per_layer_topics_;
   std::string visualizer_frame_;
   DynamicSceneGraph::Ptr scene_graph_;
   std::map<LayerId, ColorFunction> layer_colors_;
@@ -197,19 +328,30 @@ class DynamicSceneGraphVisualizer {
   const std::string bbox_ns_prefix_ = "layer_bounding_boxes_";
   const std::string boundary_ns_prefix_ = "layer_polygon_boundaries_";
   const std::string boundary_ellipse_ns_prefix_ = "layer_ellipsoid_boundaries_";
+  const std::string frontier_ns_prefix_ = "layer_frontier_ellipsoids_";
   const std::string mesh_edge_ns_ = "mesh_object_connections";
   const std::string interlayer_edge_ns_prefix_ = "interlayer_edges_";
+  const std::string dynamic_interlayer_edge_ns_prefix_ = "dynamic_interlayer_edges_";
   const LayerId mesh_edge_source_layer_ = DsgLayers::MESH_PLACES;
   const std::string dynamic_node_ns_prefix_ = "dynamic_nodes_";
   const std::string dynamic_edge_ns_prefix_ = "dynamic_edges_";
   const std::string dynamic_label_ns_prefix_ = "dynamic_label_";
 
   std::set<std::string> published_multimarkers_;
+  std::mutex multimarker_mutex_;
   std::map<LayerId, std::set<NodeId>> prev_labels_;
   std::map<LayerId, std::set<NodeId>> curr_labels_;
   std::set<std::string> published_dynamic_labels_;
 
+  std::map<LayerId, LayerSnapshot> layer_snapshots_;
+  std::map<std::pair<LayerId, char>, LayerSnapshot> dynamic_snapshots_;
+  std::map<std::pair<NodeId, NodeId>, double> interlayer_snapshot_;
+  std::map<std::pair<NodeId, NodeId>, double> dynamic_interlayer_snapshot_;
+  //! mesh edge segments of the mesh edge source layer (rebuilt per changed node)
+  MeshEdgeCache mesh_edge_cache_;
+
   ros::Publisher dsg_pub_;
+  std::map<std::string, ros::Publisher> topic_pubs_;
   ros::Publisher dynamic_layers_viz_pub_;
   std::list<std::shared_ptr<DsgVisualizerPlugin>> plugins_;
 };
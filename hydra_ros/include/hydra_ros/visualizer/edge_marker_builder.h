@@ -0,0 +1,98 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <visualization_msgs/MarkerArray.h>
+
+#include <map>
+#include <vector>
+
+#include "hydra_ros/visualizer/visualizer_types.h"
+#include "hydra_ros/visualizer/visualizer_utilities.h"
+
+namespace hydra {
+
+/**
+ * @brief Builds interlayer edge markers with one line list per source layer
+ *
+ * Edges are first sorted into per source layer buckets (applying filters and insertion
+ * skips), after which every marker is sized once and filled in parallel. Buckets are
+ * kept between calls so that redraws reuse their allocations. Markers are named after
+ * the source layer and the target layer of the first edge in the bucket.
+ */
+class EdgeMarkerBuilder {
+ public:
+  explicit EdgeMarkerBuilder(size_t num_threads = 1);
+
+  visualization_msgs::MarkerArray makeGraphEdgeMarkers(
+      const std_msgs::Header& header,
+      const DynamicSceneGraph& graph,
+      const std::map<LayerId, LayerConfig>& configs,
+      const VisualizerConfig& visualizer_config,
+      const std::string& ns_prefix,
+      const FilterFunction& filter = {});
+
+  visualization_msgs::MarkerArray makeDynamicGraphEdgeMarkers(
+      const std_msgs::Header& header,
+      const DynamicSceneGraph& graph,
+      const std::map<LayerId, LayerConfig>& configs,
+      const std::map<LayerId, DynamicLayerConfig>& dynamic_configs,
+      const VisualizerConfig& visualizer_config,
+      const std::string& ns_prefix);
+
+ private:
+  using NodePair = std::pair<const SceneGraphNode*, const SceneGraphNode*>;
+
+  struct Bucket {
+    LayerId source;
+    LayerId target;
+    size_t num_since_last_insertion = 0;
+    std::vector<NodePair> edges;
+  };
+
+  Bucket& getBucket(LayerId source, LayerId target, size_t skip);
+
+  void addEdge(const SceneGraphNode& source, const SceneGraphNode& target, size_t skip);
+
+  visualization_msgs::MarkerArray makeMarkers(
+      const std_msgs::Header& header,
+      const std::map<LayerId, LayerConfig>& configs,
+      const std::string& ns_prefix);
+
+  const size_t num_threads_;
+  size_t num_buckets_ = 0;
+  std::vector<Bucket> buckets_;
+};
+
+}  // namespace hydra
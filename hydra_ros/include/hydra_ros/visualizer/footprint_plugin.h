@@ -37,6 +37,7 @@
 #include <std_srvs/SetBool.h>
 
 #include "hydra_ros/visualizer/dsg_visualizer_plugin.h"
+#include "hydra_ros/visualizer/polygon_cache.h"
 
 namespace hydra {
 
@@ -68,9 +69,16 @@ class FootprintPlugin : public DsgVisualizerPlugin {
 
   void reset(const std_msgs::Header& header, const DynamicSceneGraph& graph) override;
 
+  bool usesConfigs() const override { return false; }
+
  protected:
   ros::Publisher pub_;
   std::set<std::string> namespaces_;
+  //! Footprint polygons, rebuilt when the position or radius of a node changes
+  PolygonCache polygon_cache_;
+  //! Neighborhood heights, recomputed whenever any node or edge in the layer changes
+  uint64_t layer_signature_ = 0;
+  std::map<NodeId, double> mean_heights_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DsgVisualizerPlugin,
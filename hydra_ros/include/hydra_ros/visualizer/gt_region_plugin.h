@@ -48,6 +48,8 @@ struct Region {
   Eigen::Vector3d centroid;
   std::string name;
   std_msgs::ColorRGBA color;
+  //! Triangulation of the boundary (computed once on load)
+  std::vector<std::array<size_t, 3>> faces;
 };
 
 class GtRegionPlugin : public DsgVisualizerPlugin {
@@ -66,6 +68,7 @@ class GtRegionPlugin : public DsgVisualizerPlugin {
     double label_offset = 0.0;
     double z_offset = 0.1;
     bool use_boundary_color = true;
+    size_t num_triangulation_threads = 1;
   } const config;
 
   GtRegionPlugin(const Config& config,
@@ -80,6 +83,8 @@ class GtRegionPlugin : public DsgVisualizerPlugin {
 
   void reset(const std_msgs::Header& header, const DynamicSceneGraph& graph) override;
 
+  bool usesConfigs() const override { return false; }
+
  protected:
   std::optional<size_t> getFillMarker(const std_msgs::Header& header,
                                       visualization_msgs::MarkerArray& msg);
@@ -37,6 +37,7 @@
 #include <hydra/places/gvd_graph.h>
 #include <hydra/places/gvd_voxel.h>
 #include <hydra_ros/GvdVisualizerConfig.h>
+#include <sensor_msgs/PointCloud2.h>
 #include <visualization_msgs/Marker.h>
 #include <visualization_msgs/MarkerArray.h>
 
@@ -51,6 +52,7 @@ class MarkerGroupPub {
  public:
   using MarkerCallback = std::function<bool(visualization_msgs::Marker& marker)>;
   using ArrayCallback = std::function<bool(visualization_msgs::MarkerArray& marker)>;
+  using CloudCallback = std::function<bool(sensor_msgs::PointCloud2& cloud)>;
 
   explicit MarkerGroupPub(const ros::NodeHandle& nh);
 
@@ -58,9 +60,16 @@ class MarkerGroupPub {
 
   void publish(const std::string& name, const ArrayCallback& marker) const;
 
+  void publish(const std::string& name, const CloudCallback& cloud) const;
+
+  size_t numSubscribers(const std::string& name) const;
+
  private:
+  const ros::Publisher& getPublisher(const std::string& name) const;
+
   mutable ros::NodeHandle nh_;
   mutable std::map<std::string, ros::Publisher> pubs_;
+  mutable std::map<std::string, ros::Publisher> cloud_pubs_;
 };
 
 enum class GvdVisualizationMode : int {
@@ -75,6 +84,25 @@ visualization_msgs::Marker makeGvdMarker(const GvdVisualizerConfig& config,
                                          const ColormapConfig& colors,
                                          const places::GvdLayer& layer);
 
+//! Empty cube list with the voxel size and identity pose of the layer
+visualization_msgs::Marker makeVoxelMarker(double voxel_size, const std::string& ns);
+
+//! Per-block versions of the GVD markers (for chunked marker generation)
+void addGvdVoxels(const GvdVisualizerConfig& config,
+                  const ColormapConfig& colors,
+                  const places::GvdBlock& block,
+                  visualization_msgs::Marker& marker);
+
+void addSurfaceVoxels(const GvdVisualizerConfig& config,
+                      const ColormapConfig& colors,
+                      const places::GvdBlock& block,
+                      visualization_msgs::Marker& marker);
+
+void addEsdfVoxels(const GvdVisualizerConfig& config,
+                   const ColormapConfig& colors,
+                   const places::GvdBlock& block,
+                   visualization_msgs::Marker& marker);
+
 visualization_msgs::Marker makeSurfaceVoxelMarker(
     const GvdVisualizerConfig& config,
     const ColormapConfig& colors,
@@ -100,6 +128,13 @@ visualization_msgs::Marker makeBlocksMarker(
 visualization_msgs::Marker makeMeshBlocksMarker(const MeshLayer& layer,
                                                 double scale);
 
+//! Hash of the GVD graph contents (used to skip republishing an unchanged graph)
+uint64_t computeGvdGraphSignature(const places::GvdGraph& graph);
+
+uint64_t computeGvdClusterSignature(
+    const CompressedNodeMap& clusters,
+    const std::unordered_map<uint64_t, uint64_t>& remapping);
+
 visualization_msgs::MarkerArray makeGvdGraphMarkers(const places::GvdGraph& graph,
                                                     const GvdVisualizerConfig& config,
                                                     const ColormapConfig& colors,
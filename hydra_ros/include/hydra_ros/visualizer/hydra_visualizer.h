@@ -35,13 +35,20 @@
 #pragma once
 
 #include <config_utilities/virtual_config.h>
+#include <hydra_msgs/QueryDsg.h>
+#include <hydra_msgs/QueryFreespace.h>
 #include <ros/ros.h>
 #include <spark_dsg/zmq_interface.h>
 #include <std_srvs/Empty.h>
 
 #include <fstream>
+#include <future>
 
+#include "hydra_ros/utils/dsg_query_index.h"
 #include "hydra_ros/utils/dsg_streaming_interface.h"
+#include "hydra_ros/utils/freespace_index.h"
+#include "hydra_ros/utils/metrics_publisher.h"
+#include "hydra_ros/utils/multi_dsg_receiver.h"
 #include "hydra_ros/visualizer/dynamic_scene_graph_visualizer.h"
 #include "hydra_ros/visualizer/mesh_plugin.h"
 
@@ -53,12 +60,27 @@ using spark_dsg::getDefaultLayerIds;
 struct HydraVisualizerConfig {
   bool load_graph = false;
   bool use_zmq = false;
+  //! JSON or binary scene graph, or the latest state of a scene graph log (.log)
   std::string scene_graph_filepath = "";
+  //! Optional mesh attached to the loaded graph once it is read in the background
+  std::string mesh_filepath = "";
   std::string visualizer_ns = "/hydra_dsg_visualizer";
   std::string output_path = "";
   std::string zmq_url = "tcp://127.0.0.1:8001";
   size_t zmq_num_threads = 2;
   size_t zmq_poll_time_ms = 10;
+  //! Receive and deserialize graphs on a separate thread and only render the latest
+  bool pipelined = false;
+  //! Rate at which received graphs are swapped in and redrawn
+  double render_rate_hz = 10.0;
+  //! Merge the graphs published on <ns>/dsg for each namespace (one thread each)
+  std::vector<std::string> robot_namespaces;
+  //! Cell size of the spatial index used to answer freespace queries
+  double freespace_index_resolution = 0.5;
+  //! Cell size of the spatial index used to answer radius queries
+  double query_index_resolution = 1.0;
+  //! Diagnostics / Prometheus reporting of receive and redraw latencies
+  MetricsPublisher::Config metrics;
 
   // Specify additional plugins that should be loaded <name, config>
   std::map<std::string, config::VirtualConfig<DsgVisualizerPlugin>> plugins;
@@ -70,16 +92,33 @@ struct HydraVisualizer {
   HydraVisualizer(const ros::NodeHandle& nh);
   ~HydraVisualizer();
 
+  //! Start loading the graph (and mesh) file in the background, abandoning old loads
   void loadGraph();
 
+  //! Draw the file graph once it is loaded (returns true if it was set)
+  bool checkPendingGraph();
+
+  //! Attach the mesh to the file graph once both are loaded (returns true if attached)
+  bool checkPendingMesh();
+
   bool handleReload(std_srvs::Empty::Request&, std_srvs::Empty::Response&);
   bool handleRedraw(std_srvs::Empty::Request&, std_srvs::Empty::Response&);
+  bool handleFreespaceQuery(hydra_msgs::QueryFreespace::Request& req,
+                            hydra_msgs::QueryFreespace::Response& res);
+  bool handleDsgQuery(hydra_msgs::QueryDsg::Request& req,
+                      hydra_msgs::QueryDsg::Response& res);
+
+  void updateFreespaceIndex(const DynamicSceneGraph& graph);
+
+  void updateQueryIndex(const DynamicSceneGraph& graph);
 
   void addPlugin(DsgVisualizerPlugin::Ptr plugin);
   void clearPlugins();
   inline DynamicSceneGraphVisualizer& getVisualizer() { return *visualizer_; }
 
   void spinRos();
+  void spinRosPipelined();
+  void spinRosMultiRobot();
   void spinFile();
   void spinZmq();
   void spin();
@@ -92,6 +131,14 @@ struct HydraVisualizer {
   std::unique_ptr<std::ofstream> size_log_file_;
   ros::ServiceServer reload_service_;
   ros::ServiceServer redraw_service_;
+  ros::ServiceServer freespace_service_;
+  ros::ServiceServer query_service_;
+  FreespaceIndex freespace_index_;
+  DsgQueryIndex query_index_;
+  std::unique_ptr<MetricsPublisher> metrics_;
+  DynamicSceneGraph::Ptr file_graph_;
+  std::future<DynamicSceneGraph::Ptr> pending_graph_;
+  std::future<Mesh::Ptr> pending_mesh_;
 };
 
 }  // namespace hydra
@@ -0,0 +1,101 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <Eigen/Core>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Decides which node labels of a layer get drawn and republished
+ *
+ * Labels outside of a radius around the viewer are hidden, dense labels are thinned
+ * to at most one per grid cell and (optionally) only labels whose text or position
+ * changed since they were last published are returned for publishing.
+ */
+class LabelLod {
+ public:
+  struct Config {
+    bool enable = false;
+    //! frame that the view radius is centered on (empty centers on the origin)
+    std::string view_frame = "";
+    //! labels further than this from the view frame are hidden (<= 0 disables)
+    double view_radius = -1.0;
+    //! at most one label is drawn per cubic cell of this size (<= 0 disables)
+    double min_spacing = 0.0;
+    //! only republish labels whose text or position changed
+    bool only_changed = true;
+    //! movement of the view frame that triggers updating labels of unchanged layers
+    double view_update_distance = 1.0;
+  } const config;
+
+  struct Label {
+    uint64_t id;
+    std::string text;
+    Eigen::Vector3d position;
+  };
+
+  struct Result {
+    //! indices of the input labels that need to be (re)published
+    std::vector<size_t> to_publish;
+    //! ids of every label that should currently be shown
+    std::set<uint64_t> visible;
+  };
+
+  explicit LabelLod(const Config& config);
+
+  Result update(int64_t layer,
+                const std::vector<Label>& labels,
+                const std::optional<Eigen::Vector3d>& viewer);
+
+  //! Check whether the viewer moved far enough to warrant updating every layer
+  bool viewerMoved(const std::optional<Eigen::Vector3d>& viewer);
+
+  //! Forget published labels (e.g., after the markers were cleared)
+  void reset();
+
+ private:
+  std::map<int64_t, std::map<uint64_t, Label>> published_;
+  std::optional<Eigen::Vector3d> last_viewer_;
+};
+
+void declare_config(LabelLod::Config& config);
+
+}  // namespace hydra
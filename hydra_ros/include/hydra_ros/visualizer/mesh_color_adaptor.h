@@ -37,6 +37,9 @@
 #include <kimera_pgmo/mesh_traits.h>
 #include <spark_dsg/mesh.h>
 
+#include <optional>
+#include <vector>
+
 namespace hydra {
 
 class SemanticColorMap;
@@ -56,6 +59,14 @@ struct MeshColoring {
    */
   virtual spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh,
                                           size_t i) const = 0;
+
+  /**
+   * @brief Value of the vertex attributes that determine its color (if known). Used by
+   * MeshColorCache to skip vertices whose color cannot have changed.
+   */
+  virtual std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh&, size_t) const {
+    return std::nullopt;
+  }
 };
 
 /**
@@ -69,6 +80,10 @@ struct UniformMeshColoring : public MeshColoring {
     return color_;
   }
 
+  std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh&, size_t) const override {
+    return 0;
+  }
+
  private:
   const spark_dsg::Color color_;
 };
@@ -82,6 +97,9 @@ struct SemanticMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh& mesh,
+                                       size_t i) const override;
+
  private:
   const SemanticColorMap& colormap_;
 };
@@ -99,6 +117,9 @@ struct FirstSeenMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh& mesh,
+                                       size_t i) const override;
+
  private:
   spark_dsg::Mesh::Timestamp min_;
   spark_dsg::Mesh::Timestamp max_;
@@ -116,6 +137,9 @@ struct LastSeenMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh& mesh,
+                                       size_t i) const override;
+
  private:
   spark_dsg::Mesh::Timestamp min_;
   spark_dsg::Mesh::Timestamp max_;
@@ -133,10 +157,40 @@ struct SeenDurationMeshColoring : public MeshColoring {
 
   spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh, size_t i) const override;
 
+  std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh& mesh,
+                                       size_t i) const override;
+
  private:
   spark_dsg::Mesh::Timestamp max_;
 };
 
+/**
+ * @brief Per-vertex colors of a mesh that are only recomputed when their inputs change
+ *
+ * All colors are recomputed when the coloring changes. Otherwise only vertices that
+ * were added or whose key (see MeshColoring::getVertexKey) changed are recomputed.
+ */
+class MeshColorCache {
+ public:
+  explicit MeshColorCache(size_t num_threads = 1);
+
+  //! Bring the colors up to date with the mesh (coloring must not be null)
+  const std::vector<spark_dsg::Color>& update(const spark_dsg::Mesh& mesh,
+                                              const MeshColoring::ConstPtr& coloring);
+
+  void clear();
+
+  //! Number of vertices recomputed during the last update
+  inline size_t numUpdated() const { return num_updated_; }
+
+ private:
+  size_t num_threads_;
+  MeshColoring::ConstPtr coloring_;
+  std::vector<spark_dsg::Color> colors_;
+  std::vector<uint64_t> keys_;
+  size_t num_updated_;
+};
+
 /**
  * @brief Utility class to color a mesh based on a mesh coloring for visualization.
  */
@@ -147,6 +201,10 @@ struct MeshColorAdaptor {
    */
   explicit MeshColorAdaptor(const spark_dsg::Mesh& mesh,
                             MeshColoring::ConstPtr coloring = nullptr);
+
+  //! Use precomputed colors (e.g. from a MeshColorCache) with one entry per vertex
+  MeshColorAdaptor(const spark_dsg::Mesh& mesh,
+                   const std::vector<spark_dsg::Color>& colors);
   virtual ~MeshColorAdaptor() = default;
 
   std::function<spark_dsg::Color(size_t)> getVertexColor;
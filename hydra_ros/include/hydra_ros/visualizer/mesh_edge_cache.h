@@ -0,0 +1,94 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#pragma once
+#include <geometry_msgs/Point.h>
+#include <std_msgs/ColorRGBA.h>
+#include <visualization_msgs/Marker.h>
+
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "hydra_ros/visualizer/visualizer_types.h"
+
+namespace hydra {
+
+//! Line segments (and per-point colors) from a node to its mesh vertices
+struct MeshEdgeSegments {
+  bool built = false;
+  uint64_t signature = 0;
+  //! last draw that included the node
+  uint64_t generation = 0;
+  std::vector<geometry_msgs::Point> points;
+  std::vector<std_msgs::ColorRGBA> colors;
+};
+
+/**
+ * @brief Mesh edge segments per node that persist across redraws
+ *
+ * Segments are only rebuilt for nodes whose position, color or mesh connections
+ * changed. Everything is rebuilt when the mesh revision or the drawing settings change.
+ * The mesh revision combines the mesh instance, its size and a strided sample of
+ * vertex positions, so mesh deformations invalidate the cache as well.
+ */
+class MeshEdgeCache {
+ public:
+  visualization_msgs::Marker draw(const std_msgs::Header& header,
+                                  const LayerConfig& config,
+                                  const VisualizerConfig& visualizer_config,
+                                  const DynamicSceneGraph& graph,
+                                  const SceneGraphLayer& layer,
+                                  const std::string& ns);
+
+  size_t size() const { return cache_.size(); }
+
+  //! Number of nodes rebuilt by the last draw
+  size_t numRebuilt() const { return num_rebuilt_; }
+
+  void clear();
+
+ private:
+  std::optional<uint64_t> mesh_revision_;
+  std::optional<uint64_t> settings_;
+  size_t num_rebuilt_ = 0;
+  uint64_t generation_ = 0;
+  std::map<NodeId, MeshEdgeSegments> cache_;
+};
+
+//! Hash of the mesh instance, vertex count and up to num_samples vertex positions
+uint64_t hashMeshRevision(const spark_dsg::Mesh* mesh, size_t num_samples = 256);
+
+}  // namespace hydra
@@ -0,0 +1,126 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <spark_dsg/mesh.h>
+
+#include <Eigen/Core>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief Level-of-detail representation of a mesh split into cubic chunks
+ *
+ * Faces are assigned to chunks by their first vertex. Each chunk caches decimated
+ * copies of its faces (vertex clustering with a cell size that doubles per level),
+ * which are only rebuilt when the faces or vertices of the chunk change.
+ */
+class MeshLod {
+ public:
+  //! Decides whether a chunk (given by its lower and upper corner) gets drawn
+  using ChunkFilter =
+      std::function<bool(const Eigen::Vector3f& lower, const Eigen::Vector3f& upper)>;
+
+  struct Config {
+    //! Side length of a chunk in meters
+    double chunk_size = 8.0;
+    //! Clustering cell size of the first decimated level in meters
+    double voxel_size = 0.1;
+    //! Chunks further than level_distances[i] from the focus use level i + 1
+    std::vector<double> level_distances{10.0, 25.0, 50.0};
+  } const config;
+
+  explicit MeshLod(const Config& config);
+
+  /**
+   * @brief Re-assign faces to chunks and drop the cached levels of changed chunks
+   *
+   * Every face is visited, so callers should only call this when the mesh changed
+   * (e.g., when the graph revision changed) and not for every draw.
+   */
+  void update(const spark_dsg::Mesh& mesh);
+
+  /**
+   * @brief Assemble a mesh with per-chunk detail based on distance to the focus point
+   *
+   * Vertex colors are taken from a representative vertex of each cluster, either from
+   * the per-vertex colors (if provided) or from the mesh. The mesh must be the one last
+   * passed to update(). Chunks rejected by the filter (if provided) are skipped.
+   */
+  spark_dsg::Mesh::Ptr extract(const spark_dsg::Mesh& mesh,
+                               const Eigen::Vector3f& focus,
+                               const std::vector<spark_dsg::Color>* colors = nullptr,
+                               const ChunkFilter& filter = {});
+
+  //! Detail level used for a chunk at the given distance from the focus point
+  size_t getLevel(double distance) const;
+
+  inline size_t numChunks() const { return chunks_.size(); }
+
+  //! Number of chunks whose contents changed during the last update
+  inline size_t numChanged() const { return num_changed_; }
+
+ private:
+  struct ChunkIndexHash {
+    size_t operator()(const Eigen::Vector3i& index) const;
+  };
+
+  struct Level {
+    bool valid = false;
+    //! original vertex that provides the color of each output vertex
+    std::vector<size_t> sources;
+    std::vector<spark_dsg::Mesh::Pos> points;
+    std::vector<spark_dsg::Mesh::Face> faces;
+  };
+
+  struct Chunk {
+    std::vector<size_t> faces;
+    uint64_t signature = 0;
+    std::vector<Level> levels;
+  };
+
+  Eigen::Vector3i getChunkIndex(const spark_dsg::Mesh::Pos& pos) const;
+
+  void buildLevel(const spark_dsg::Mesh& mesh, Chunk& chunk, size_t level) const;
+
+  std::unordered_map<Eigen::Vector3i, Chunk, ChunkIndexHash> chunks_;
+  size_t num_changed_;
+};
+
+void declare_config(MeshLod::Config& config);
+
+}  // namespace hydra
@@ -35,12 +35,19 @@
 #pragma once
 #include <config_utilities/factory.h>
 #include <std_srvs/SetBool.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
+
+#include <optional>
 
 #include "hydra_ros/visualizer/dsg_visualizer_plugin.h"
+#include "hydra_ros/visualizer/mesh_lod.h"
+#include "hydra_ros/visualizer/view_frustum.h"
 
 namespace hydra {
 
 class SemanticColorMap;
+class MeshColorCache;
 struct MeshColoring;
 
 class MeshPlugin : public DsgVisualizerPlugin {
@@ -51,6 +58,16 @@ class MeshPlugin : public DsgVisualizerPlugin {
   struct Config {
     std::string label_colormap = "";
     bool color_by_label = false;
+    //! Publish decimated chunks away from the focus point instead of the full mesh
+    bool use_lod = false;
+    //! Frame whose origin is the focus point (uses lod_focus_point if empty)
+    std::string lod_focus_frame = "";
+    std::vector<double> lod_focus_point{0.0, 0.0, 0.0};
+    MeshLod::Config lod;
+    //! Only publish LOD chunks inside the view volume of this frame
+    ViewFrustum::Config view_frustum;
+    //! Number of threads used to recompute cached vertex colors
+    size_t num_coloring_threads = 1;
   } const config;
 
   MeshPlugin(const Config& config, const ros::NodeHandle& nh, const std::string& name);
@@ -67,17 +84,33 @@ class MeshPlugin : public DsgVisualizerPlugin {
 
   void clearChangeFlag() override;
 
+  bool usesConfigs() const override { return false; }
+
  protected:
   bool handleService(std_srvs::SetBool::Request& req, std_srvs::SetBool::Response& res);
 
   std::string getMsgNamespace() const;
 
+  Eigen::Vector3f getFocusPoint(const std_msgs::Header& header) const;
+
+  std::optional<Eigen::Isometry3d> getViewPose(const std::string& frame_id) const;
+
   bool color_by_label_ = false;
   bool need_redraw_ = true;
+  //! graph revision and mesh of the last published mesh (skips republishing)
+  std::optional<uint64_t> drawn_revision_;
+  const spark_dsg::Mesh* drawn_mesh_ = nullptr;
   ros::Publisher mesh_pub_;
   ros::ServiceServer toggle_service_;
   std::unique_ptr<SemanticColorMap> colormap_;
   std::shared_ptr<const MeshColoring> mesh_coloring_;
+  std::unique_ptr<MeshColorCache> color_cache_;
+  std::unique_ptr<MeshLod> lod_;
+  std::unique_ptr<ViewFrustum> frustum_;
+  //! frame of the last drawn mesh, used to check for view changes between draws
+  std::string frame_id_;
+  std::unique_ptr<tf2_ros::Buffer> tf_buffer_;
+  std::unique_ptr<tf2_ros::TransformListener> tf_listener_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DsgVisualizerPlugin,
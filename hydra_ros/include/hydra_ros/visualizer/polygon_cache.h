@@ -0,0 +1,96 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+
+#include <Eigen/Dense>
+#include <array>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace hydra {
+
+//! Polygon boundary, triangulation and drawing height for a single node
+struct PolygonGeometry {
+  uint64_t signature = 0;
+  Eigen::MatrixXd points;
+  std::vector<std::array<size_t, 3>> faces;
+  double height = 0.0;
+};
+
+/**
+ * @brief Per-node polygon geometry that persists across redraws
+ *
+ * Each update provides a signature for every node that should be drawn. Geometry is
+ * only rebuilt (and re-triangulated) for nodes whose signature changed, and nodes
+ * that are no longer present are dropped.
+ */
+class PolygonCache {
+ public:
+  using Signatures = std::vector<std::pair<NodeId, uint64_t>>;
+  //! Fills in the points and height of the geometry for a node
+  using BuildFunc = std::function<void(NodeId, PolygonGeometry&)>;
+
+  explicit PolygonCache(size_t num_threads = 1);
+
+  void update(const Signatures& signatures, const BuildFunc& build);
+
+  const PolygonGeometry& at(NodeId node) const;
+
+  size_t size() const { return cache_.size(); }
+
+  //! Number of nodes rebuilt by the last update
+  size_t numRebuilt() const { return num_rebuilt_; }
+
+  void clear();
+
+ private:
+  size_t num_threads_;
+  size_t num_rebuilt_ = 0;
+  std::map<NodeId, PolygonGeometry> cache_;
+};
+
+//! Combine a value into a hash (FNV-1a over the bytes of the value)
+uint64_t hashCombine(uint64_t hash, const void* data, size_t size);
+
+//! Hash of the position of a node and the ids and positions of its children
+uint64_t hashChildGeometry(const DynamicSceneGraph& graph,
+                           const SceneGraphNode& parent);
+
+//! Hash of the ids, positions and siblings of every node in the layer
+uint64_t hashLayerGeometry(const SceneGraphLayer& layer);
+
+}  // namespace hydra
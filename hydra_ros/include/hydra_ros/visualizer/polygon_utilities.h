@@ -39,7 +39,9 @@
 #include <visualization_msgs/Marker.h>
 
 #include <Eigen/Dense>
+#include <array>
 #include <optional>
+#include <vector>
 
 namespace hydra {
 
@@ -62,6 +64,13 @@ void makeFilledPolygon(const Eigen::MatrixXd& points,
                        visualization_msgs::Marker& marker,
                        std::optional<double> height = std::nullopt);
 
+//! Fill a polygon using faces precomputed from the points (e.g., by triangulatePoints)
+void makeFilledPolygon(const Eigen::MatrixXd& points,
+                       const std::vector<std::array<size_t, 3>>& faces,
+                       const std_msgs::ColorRGBA& color,
+                       visualization_msgs::Marker& marker,
+                       std::optional<double> height = std::nullopt);
+
 void makePolygonBoundary(const Eigen::MatrixXd& points,
                          const std_msgs::ColorRGBA& color,
                          visualization_msgs::Marker& edges,
@@ -37,6 +37,7 @@
 #include <std_srvs/SetBool.h>
 
 #include "hydra_ros/visualizer/dsg_visualizer_plugin.h"
+#include "hydra_ros/visualizer/polygon_cache.h"
 
 namespace hydra {
 
@@ -52,6 +53,8 @@ class RegionPlugin : public DsgVisualizerPlugin {
     double mesh_alpha = 0.6;
     double label_scale = 0.7;
     std::string region_colormap = "";
+    //! Number of threads used to triangulate changed regions
+    size_t num_triangulation_threads = 1;
   } const config;
 
   RegionPlugin(const Config& config,
@@ -66,10 +69,14 @@ class RegionPlugin : public DsgVisualizerPlugin {
 
   void reset(const std_msgs::Header& header, const DynamicSceneGraph& graph) override;
 
+  bool usesConfigs() const override { return false; }
+
  protected:
   ros::Publisher pub_;
   std::unique_ptr<SemanticColorMap> colormap_;
   std::set<int> published_labels_;
+  //! Hull, triangulation and mean child height of every drawn region
+  PolygonCache polygon_cache_;
 
   inline static const auto registration_ =
       config::RegistrationWithConfig<DsgVisualizerPlugin,
@@ -0,0 +1,129 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#pragma once
+#include <hydra/common/dsg_types.h>
+
+#include <Eigen/Geometry>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace hydra {
+
+/**
+ * @brief View volume of the viewer (e.g., the rviz camera) used to cull markers
+ *
+ * The volume is a truncated pyramid in the view frame, padded by a margin so that
+ * geometry close to the edge of the screen does not pop in and out. Node positions are
+ * kept in a voxel hash per layer so that whole cells outside of the view can be
+ * skipped when collecting the visible nodes.
+ */
+class ViewFrustum {
+ public:
+  struct Config {
+    bool enable = false;
+    //! frame of the viewer (e.g., the output of rotate_tf_node or a rviz view frame)
+    std::string view_frame = "";
+    //! view frame looks along +z (camera optical convention) instead of +x
+    bool optical_frame = false;
+    double horizontal_fov = 90.0;
+    double vertical_fov = 60.0;
+    double min_range = 0.0;
+    double max_range = 50.0;
+    //! distance outside of the view volume that is still drawn
+    double margin = 1.0;
+    //! side length of the cells of the node index
+    double index_resolution = 2.0;
+    //! viewer translation that triggers redrawing with the new view volume
+    double update_distance = 0.5;
+    //! viewer rotation that triggers redrawing with the new view volume
+    double update_angle = 5.0;
+  } const config;
+
+  explicit ViewFrustum(const Config& config);
+
+  //! Set the pose of the view frame; returns true if it moved enough to redraw
+  bool setViewPose(const Eigen::Isometry3d& world_T_view);
+
+  //! Check whether the view frame moved enough from the current pose to redraw
+  bool moved(const Eigen::Isometry3d& world_T_view) const;
+
+  bool hasViewPose() const { return has_pose_; }
+
+  //! Check if a sphere intersects the padded view volume (always true without a pose)
+  bool contains(const Eigen::Vector3d& point, double radius = 0.0) const;
+
+  //! Synchronize the index with the nodes of a layer, shifting positions by z_offset
+  void update(LayerId layer_id, const SceneGraphLayer& layer, double z_offset = 0.0);
+
+  void updateNode(LayerId layer_id, NodeId node, const Eigen::Vector3d& position);
+
+  void removeNode(LayerId layer_id, NodeId node);
+
+  //! Indexed nodes of a layer that are inside the view volume
+  std::unordered_set<NodeId> getVisible(LayerId layer_id) const;
+
+  void clear();
+
+ private:
+  struct CellHash {
+    size_t operator()(const Eigen::Vector3i& index) const;
+  };
+
+  using Cells = std::unordered_map<Eigen::Vector3i, std::vector<NodeId>, CellHash>;
+
+  struct LayerIndex {
+    std::unordered_map<NodeId, Eigen::Vector3d> positions;
+    Cells cells;
+  };
+
+  Eigen::Vector3i toIndex(const Eigen::Vector3d& position) const;
+
+  void eraseFromCell(LayerIndex& index, NodeId node, const Eigen::Vector3d& position);
+
+  bool has_pose_;
+  Eigen::Isometry3d world_T_view_;
+  Eigen::Isometry3d view_T_world_;
+  double cos_half_h_;
+  double sin_half_h_;
+  double cos_half_v_;
+  double sin_half_v_;
+  std::unordered_map<LayerId, LayerIndex> layers_;
+};
+
+void declare_config(ViewFrustum::Config& config);
+
+}  // namespace hydra
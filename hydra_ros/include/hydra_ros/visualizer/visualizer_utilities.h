@@ -124,14 +124,26 @@ visualization_msgs::Marker makeTextMarkerNoHeight(
     const VisualizerConfig& visualizer_config,
     const std::string& ns);
 
+//! One marker per frontier (frontiers rejected by the filter get a delete marker)
 std::vector<visualization_msgs::Marker> makeEllipsoidMarkers(
     const std_msgs::Header& header,
     const LayerConfig& config,
     const SceneGraphLayer& layer,
     const VisualizerConfig& visualizer_config,
     const std::string& ns,
-    const ColorFunction& color_func);
+    const ColorFunction& color_func,
+    const FilterFunction& filter = {});
 
+//! Draw every frontier as a single SPHERE_LIST (if all frontiers are the same sphere)
+//! or a single TRIANGLE_LIST of ellipsoids
+visualization_msgs::Marker makeEllipsoidListMarker(
+    const std_msgs::Header& header,
+    const LayerConfig& config,
+    const SceneGraphLayer& layer,
+    const VisualizerConfig& visualizer_config,
+    const std::string& ns,
+    const ColorFunction& color_func,
+    const FilterFunction& filter = {});
 
 visualization_msgs::Marker makeCentroidMarkers(
     const std_msgs::Header& header,
@@ -148,7 +160,8 @@ visualization_msgs::Marker makePlaceCentroidMarkers(
     const SceneGraphLayer& layer,
     const VisualizerConfig& visualizer_config,
     const std::string& ns,
-    const ColorFunction& color_func);
+    const ColorFunction& color_func,
+    const FilterFunction& filter = {});
 
 visualization_msgs::MarkerArray makeGraphEdgeMarkers(
     const std_msgs::Header& header,
@@ -158,6 +171,14 @@ visualization_msgs::MarkerArray makeGraphEdgeMarkers(
     const std::string& ns,
     const FilterFunction& filter = {});
 
+//! Append the edges from a mesh place to its (sub-sampled) mesh vertices
+void appendMeshEdges(const Place2dNodeAttributes& attrs,
+                     const spark_dsg::Mesh& mesh,
+                     const LayerConfig& config,
+                     const VisualizerConfig& visualizer_config,
+                     std::vector<geometry_msgs::Point>& points,
+                     std::vector<std_msgs::ColorRGBA>& colors);
+
 visualization_msgs::Marker makeMeshEdgesMarker(
     const std_msgs::Header& header,
     const LayerConfig& config,
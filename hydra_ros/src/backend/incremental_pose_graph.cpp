@@ -0,0 +1,143 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/backend/incremental_pose_graph.h"
+
+#include <tf2_eigen/tf2_eigen.h>
+
+namespace hydra {
+
+using pose_graph_tools_msgs::PoseGraph;
+using pose_graph_tools_msgs::PoseGraphEdge;
+using pose_graph_tools_msgs::PoseGraphNode;
+
+namespace {
+
+inline Eigen::Isometry3d getPose(const SceneGraphNode& node) {
+  const auto& attrs = node.attributes<AgentNodeAttributes>();
+  Eigen::Isometry3d world_T_body = Eigen::Isometry3d::Identity();
+  world_T_body.linear() = attrs.world_R_body.toRotationMatrix();
+  world_T_body.translation() = attrs.position;
+  return world_T_body;
+}
+
+inline size_t getKey(const SceneGraphNode& node) {
+  return NodeSymbol(node.attributes<AgentNodeAttributes>().external_key).categoryId();
+}
+
+}  // namespace
+
+IncrementalPoseGraph::IncrementalPoseGraph(double refresh_period_s)
+    : refresh_period_s_(refresh_period_s), refresh_requested_(true) {}
+
+void IncrementalPoseGraph::requestRefresh() { refresh_requested_ = true; }
+
+bool IncrementalPoseGraph::needsRefresh(uint64_t timestamp_ns,
+                                        const DynamicSceneGraphLayer& agents) {
+  const auto& nodes = agents.nodes();
+  if (refresh_requested_.exchange(false) || !last_refresh_ns_ ||
+      nodes.size() < sent_positions_.size()) {
+    return true;
+  }
+
+  if (refresh_period_s_ > 0.0 && timestamp_ns > *last_refresh_ns_ &&
+      (timestamp_ns - *last_refresh_ns_) * 1.0e-9 >= refresh_period_s_) {
+    return true;
+  }
+
+  // optimization moves previously sent poses
+  for (size_t i = 0; i < sent_positions_.size(); ++i) {
+    if (nodes[i]->attributes().position != sent_positions_[i]) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+IncrementalPoseGraph::Update IncrementalPoseGraph::update(
+    uint64_t timestamp_ns,
+    const DynamicSceneGraphLayer& agents,
+    int robot_id,
+    PoseGraph& msg) {
+  const auto& nodes = agents.nodes();
+  if (needsRefresh(timestamp_ns, agents)) {
+    // the full graph covers every pose currently in the layer
+    sent_positions_.clear();
+    for (const auto& node : nodes) {
+      sent_positions_.push_back(node->attributes().position);
+    }
+
+    last_refresh_ns_ = timestamp_ns;
+    return Update::FULL;
+  }
+
+  const size_t num_sent = sent_positions_.size();
+  if (nodes.size() == num_sent) {
+    return Update::NONE;
+  }
+
+  msg.header.stamp.fromNSec(timestamp_ns);
+  msg.nodes.clear();
+  msg.edges.clear();
+  for (size_t i = num_sent; i < nodes.size(); ++i) {
+    const auto& node = *nodes[i];
+    const auto world_T_body = getPose(node);
+    auto& node_msg = msg.nodes.emplace_back();
+    node_msg.header.stamp.fromNSec(node.timestamp.value().count());
+    node_msg.robot_id = robot_id;
+    node_msg.key = getKey(node);
+    node_msg.pose = tf2::toMsg(world_T_body);
+    sent_positions_.push_back(node.attributes().position);
+    if (i == 0) {
+      continue;
+    }
+
+    // odometry edge from the previous pose, which may have been sent before
+    const auto& prev = *nodes[i - 1];
+    auto& edge = msg.edges.emplace_back();
+    edge.header.stamp = node_msg.header.stamp;
+    edge.robot_from = robot_id;
+    edge.robot_to = robot_id;
+    edge.key_from = getKey(prev);
+    edge.key_to = node_msg.key;
+    edge.type = PoseGraphEdge::ODOM;
+    edge.pose = tf2::toMsg(getPose(prev).inverse() * world_T_body);
+  }
+
+  return Update::DELTA;
+}
+
+}  // namespace hydra
@@ -0,0 +1,92 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/backend/pose_graph_coalescer.h"
+
+#include <pose_graph_tools_ros/conversions.h>
+
+#include <algorithm>
+
+namespace hydra {
+
+void PoseGraphCoalescer::add(const pose_graph_tools_msgs::PoseGraph& msg) {
+  if (msg.nodes.empty() && msg.edges.empty()) {
+    return;
+  }
+
+  // incremental graphs are appended in arrival order so that the backend sees one
+  // contiguous graph per robot instead of one graph per message
+  const int robot_id =
+      msg.nodes.empty() ? msg.edges.front().robot_from : msg.nodes.front().robot_id;
+  auto& graph = getPendingGraph(robot_id);
+  graph.stamp_ns = std::max<uint64_t>(graph.stamp_ns, msg.header.stamp.toNSec());
+  for (const auto& node : msg.nodes) {
+    graph.nodes.push_back(pose_graph_tools::fromMsg(node));
+  }
+
+  for (const auto& edge : msg.edges) {
+    graph.edges.push_back(pose_graph_tools::fromMsg(edge));
+  }
+}
+
+void PoseGraphCoalescer::flush(
+    std::vector<pose_graph_tools::PoseGraph::ConstPtr>& graphs) {
+  for (auto&& [robot_id, graph] : pending_) {
+    capacity_[robot_id] = {graph->nodes.size(), graph->edges.size()};
+    graphs.push_back(std::move(graph));
+  }
+
+  pending_.clear();
+}
+
+pose_graph_tools::PoseGraph& PoseGraphCoalescer::getPendingGraph(int robot_id) {
+  auto iter = pending_.find(robot_id);
+  if (iter != pending_.end()) {
+    return *iter->second;
+  }
+
+  auto graph = std::make_shared<pose_graph_tools::PoseGraph>();
+  // the previous merged graph is a good estimate of how many poses arrive per input
+  const auto capacity = capacity_.find(robot_id);
+  if (capacity != capacity_.end()) {
+    graph->nodes.reserve(capacity->second.first);
+    graph->edges.reserve(capacity->second.second);
+  }
+
+  iter = pending_.emplace(robot_id, graph).first;
+  return *iter->second;
+}
+
+}  // namespace hydra
@@ -76,17 +76,15 @@ void RosBackend::inputCallback(const KimeraPgmoMesh::ConstPtr& mesh,
   input->deformation_graph = std::make_shared<pose_graph_tools::PoseGraph>(
       pose_graph_tools::fromMsg(*deformation_graph));
   input->timestamp_ns = mesh->header.stamp.toNSec();
-  for (const auto& graph : pose_graph_queue_) {
-    input->agent_updates.pose_graphs.push_back(graph);
-  }
-  pose_graph_queue_.clear();
+  pose_graphs_.flush(input->agent_updates.pose_graphs);
 
   state_->backend_queue.push(input);
 }
 
 void RosBackend::poseGraphCallback(const PoseGraph::ConstPtr& msg) {
-  pose_graph_queue_.push_back(
-      std::make_shared<pose_graph_tools::PoseGraph>(pose_graph_tools::fromMsg(*msg)));
+  if (msg) {
+    pose_graphs_.add(*msg);
+  }
 }
 
 }  // namespace hydra
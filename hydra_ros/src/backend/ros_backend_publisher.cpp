@@ -40,6 +40,9 @@
 #include <pose_graph_tools_ros/conversions.h>
 #include <visualization_msgs/Marker.h>
 
+#include "hydra_ros/utils/metrics.h"
+#include "hydra_ros/visualizer/polygon_cache.h"
+
 namespace hydra {
 
 using kimera_pgmo::DeformationGraph;
@@ -48,17 +51,92 @@ using kimera_pgmo_msgs::KimeraPgmoMesh;
 using pose_graph_tools_msgs::PoseGraph;
 using visualization_msgs::Marker;
 
-RosBackendPublisher::RosBackendPublisher(const ros::NodeHandle& nh) : nh_(nh) {
-  mesh_mesh_edges_pub_ =
-      nh_.advertise<Marker>("deformation_graph_mesh_mesh", 10, false);
-  pose_mesh_edges_pub_ =
-      nh_.advertise<Marker>("deformation_graph_pose_mesh", 10, false);
-  pose_graph_pub_ = nh_.advertise<PoseGraph>("pose_graph", 10, false);
+namespace {
+
+inline constexpr uint64_t kHashSeed = 0xcbf29ce484222325;
+
+uint64_t hashPoints(uint64_t hash,
+                    const std::vector<geometry_msgs::Point>& points,
+                    size_t start,
+                    size_t end) {
+  for (size_t i = start; i < end; ++i) {
+    const double pos[3] = {points[i].x, points[i].y, points[i].z};
+    hash = hashCombine(hash, pos, sizeof(pos));
+  }
+
+  return hash;
+}
+
+}  // namespace
+
+RosBackendPublisher::RosBackendPublisher(const ros::NodeHandle& nh)
+    : nh_(nh),
+      deformation_graph_viz_period_s_(1.0),
+      mesh_mesh_connected_(false),
+      pose_mesh_connected_(false) {
+  // markers are sent incrementally, so a new subscriber needs everything resent
+  mesh_mesh_edges_pub_ = nh_.advertise<Marker>(
+      "deformation_graph_mesh_mesh",
+      10,
+      [this](const ros::SingleSubscriberPublisher&) { mesh_mesh_connected_ = true; },
+      ros::SubscriberStatusCallback(),
+      ros::VoidConstPtr(),
+      false);
+  pose_mesh_edges_pub_ = nh_.advertise<Marker>(
+      "deformation_graph_pose_mesh",
+      10,
+      [this](const ros::SingleSubscriberPublisher&) { pose_mesh_connected_ = true; },
+      ros::SubscriberStatusCallback(),
+      ros::VoidConstPtr(),
+      false);
+
+  // deltas go on a separate topic so pose_graph always carries full graphs
+  bool incremental_pose_graph = false;
+  nh_.getParam("incremental_pose_graph", incremental_pose_graph);
+  if (!incremental_pose_graph) {
+    pose_graph_pub_ = nh_.advertise<PoseGraph>("pose_graph", 10, false);
+  } else {
+    double refresh_period_s = 10.0;
+    nh_.getParam("pose_graph_refresh_period_s", refresh_period_s);
+    pose_graph_deltas_ = std::make_unique<IncrementalPoseGraph>(refresh_period_s);
+    // subscribers need a full graph to apply the deltas to
+    const ros::SubscriberStatusCallback connect_cb =
+        [this](const ros::SingleSubscriberPublisher&) {
+          pose_graph_deltas_->requestRefresh();
+        };
+    pose_graph_pub_ = nh_.advertise<PoseGraph>("pose_graph",
+                                               10,
+                                               connect_cb,
+                                               ros::SubscriberStatusCallback(),
+                                               ros::VoidConstPtr(),
+                                               false);
+    pose_graph_delta_pub_ =
+        nh_.advertise<PoseGraph>("pose_graph_incremental",
+                                 10,
+                                 connect_cb,
+                                 ros::SubscriberStatusCallback(),
+                                 ros::VoidConstPtr(),
+                                 false);
+  }
 
   double separation = 0.0;
   nh_.getParam("min_mesh_separation_s", separation);
+  nh_.getParam("deformation_graph_viz_period_s", deformation_graph_viz_period_s_);
   const auto map_frame = GlobalInfo::instance().getFrames().map;
   dsg_sender_.reset(new hydra::DsgSender(nh_, map_frame, "backend", false, separation));
+  viz_thread_ = std::thread(&RosBackendPublisher::vizLoop, this);
+}
+
+RosBackendPublisher::~RosBackendPublisher() {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(viz_mutex_);
+    should_shutdown_ = true;
+  }  // end critical section
+
+  viz_cv_.notify_all();
+  if (viz_thread_.joinable()) {
+    viz_thread_.join();
+  }
 }
 
 void RosBackendPublisher::call(uint64_t timestamp_ns,
@@ -68,8 +146,9 @@ void RosBackendPublisher::call(uint64_t timestamp_ns,
   stamp.fromNSec(timestamp_ns);
   dsg_sender_->sendGraph(graph, stamp);
 
-  if (pose_graph_pub_.getNumSubscribers() > 0) {
-    publishPoseGraph(graph, dgraph);
+  if (pose_graph_pub_.getNumSubscribers() > 0 ||
+      pose_graph_delta_pub_.getNumSubscribers() > 0) {
+    publishPoseGraph(timestamp_ns, graph, dgraph);
   }
 
   if (mesh_mesh_edges_pub_.getNumSubscribers() > 0 ||
@@ -78,11 +157,27 @@ void RosBackendPublisher::call(uint64_t timestamp_ns,
   }
 }
 
-void RosBackendPublisher::publishPoseGraph(const DynamicSceneGraph& graph,
+void RosBackendPublisher::publishPoseGraph(uint64_t timestamp_ns,
+                                           const DynamicSceneGraph& graph,
                                            const DeformationGraph& dgraph) const {
   const auto& prefix = GlobalInfo::instance().getRobotPrefix();
   const auto& agent = graph.getLayer(DsgLayers::AGENTS, prefix.key);
 
+  if (pose_graph_deltas_) {
+    // deltas are built from the agent layer without touching the deformation graph
+    PoseGraph msg;
+    const auto update = pose_graph_deltas_->update(timestamp_ns, agent, prefix.id, msg);
+    if (update == IncrementalPoseGraph::Update::NONE) {
+      return;
+    }
+
+    if (update == IncrementalPoseGraph::Update::DELTA) {
+      MetricsRegistry::instance().addCount("backend/incremental_pose_graphs");
+      pose_graph_delta_pub_.publish(msg);
+      return;
+    }
+  }
+
   std::map<size_t, std::vector<size_t>> id_timestamps;
   id_timestamps[prefix.id] = std::vector<size_t>();
   auto& times = id_timestamps[prefix.id];
@@ -96,23 +191,125 @@ void RosBackendPublisher::publishPoseGraph(const DynamicSceneGraph& graph,
 
 void RosBackendPublisher::publishDeformationGraphViz(const DeformationGraph& dgraph,
                                                      size_t timestamp_ns) const {
+  if (last_viz_ns_ && timestamp_ns > *last_viz_ns_ &&
+      (timestamp_ns - *last_viz_ns_) * 1.0e-9 < deformation_graph_viz_period_s_) {
+    return;
+  }
+
+  last_viz_ns_ = timestamp_ns;
   ros::Time stamp;
   stamp.fromNSec(timestamp_ns);
 
-  Marker mm_edges_msg;
-  Marker pm_edges_msg;
+  // the deformation graph has no copy, so only filling the markers happens here
+  MarkerPair markers;
   kimera_pgmo::fillDeformationGraphMarkers(dgraph,
                                            stamp,
-                                           mm_edges_msg,
-                                           pm_edges_msg,
+                                           markers.first,
+                                           markers.second,
                                            GlobalInfo::instance().getFrames().map);
 
-  if (!mm_edges_msg.points.empty()) {
-    mesh_mesh_edges_pub_.publish(mm_edges_msg);
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(viz_mutex_);
+    if (pending_viz_) {
+      MetricsRegistry::instance().addCount("backend/dropped_deformation_viz");
+    }
+
+    pending_viz_ = std::move(markers);
+  }  // end critical section
+
+  viz_cv_.notify_one();
+}
+
+void RosBackendPublisher::vizLoop() {
+  const auto publish = [](const ros::Publisher& pub,
+                          std::atomic<bool>& connected,
+                          IncrementalMarker& state,
+                          Marker& marker) {
+    // keeps the next id so that markers sent before the connection get cleared
+    if (connected.exchange(false)) {
+      state.invalidate();
+    }
+
+    if (!pub.getNumSubscribers() || marker.points.empty()) {
+      return;
+    }
+
+    for (const auto& msg : updateIncrementalMarker(state, marker)) {
+      pub.publish(msg);
+    }
+  };
+
+  while (true) {
+    MarkerPair markers;
+    {  // start critical section
+      std::unique_lock<std::mutex> lock(viz_mutex_);
+      viz_cv_.wait(lock, [this] { return should_shutdown_ || pending_viz_; });
+      if (should_shutdown_) {
+        return;
+      }
+
+      markers = std::move(*pending_viz_);
+      pending_viz_.reset();
+    }  // end critical section
+
+    publish(
+        mesh_mesh_edges_pub_, mesh_mesh_connected_, mesh_mesh_state_, markers.first);
+    publish(
+        pose_mesh_edges_pub_, pose_mesh_connected_, pose_mesh_state_, markers.second);
+  }
+}
+
+std::vector<Marker> RosBackendPublisher::updateIncrementalMarker(
+    IncrementalMarker& state, Marker& marker) {
+  const auto& points = marker.points;
+  const size_t num_points = points.size();
+  const bool has_colors = marker.colors.size() == num_points;
+  if (state.num_points && num_points >= state.num_points) {
+    const auto prefix_hash = hashPoints(kHashSeed, points, 0, state.num_points);
+    if (prefix_hash == state.hash) {
+      if (num_points == state.num_points) {
+        return {};
+      }
+
+      // only the appended edges go out, as a new marker next to the previous ones
+      Marker added;
+      added.header = marker.header;
+      added.ns = marker.ns;
+      added.id = state.next_id++;
+      added.type = marker.type;
+      added.action = marker.action;
+      added.pose = marker.pose;
+      added.scale = marker.scale;
+      added.color = marker.color;
+      added.points.assign(points.begin() + state.num_points, points.end());
+      if (has_colors) {
+        added.colors.assign(marker.colors.begin() + state.num_points,
+                            marker.colors.end());
+      }
+
+      state.hash = hashPoints(prefix_hash, points, state.num_points, num_points);
+      state.num_points = num_points;
+      return {added};
+    }
   }
-  if (!pm_edges_msg.points.empty()) {
-    pose_mesh_edges_pub_.publish(pm_edges_msg);
+
+  // previously published edges moved (i.e., after an optimization), so the full
+  // marker replaces everything that was sent before
+  std::vector<Marker> to_publish;
+  if (state.next_id > 1) {
+    Marker clear;
+    clear.header = marker.header;
+    clear.ns = marker.ns;
+    clear.action = Marker::DELETEALL;
+    to_publish.push_back(clear);
   }
+
+  marker.id = 0;
+  state.next_id = 1;
+  state.num_points = num_points;
+  state.hash = hashPoints(kHashSeed, points, 0, num_points);
+  to_publish.push_back(marker);
+  return to_publish;
 }
 
 }  // namespace hydra
@@ -39,10 +39,31 @@
 #include <config_utilities/validation.h>
 #include <hydra/common/global_info.h>
 
+#include "hydra_ros/visualizer/polygon_cache.h"
+#include "hydra_ros/visualizer/voxel_cloud.h"
+
 namespace hydra {
 
 using visualization_msgs::Marker;
 
+namespace {
+
+uint64_t hashVertices(const kimera_pgmo::MeshDelta& delta,
+                      const std::vector<size_t>& indices) {
+  uint64_t hash = 0;
+  for (const auto idx : indices) {
+    const auto& p = delta.vertex_updates->at(idx);
+    const float pos[3] = {p.x, p.y, p.z};
+    const uint8_t color[3] = {p.r, p.g, p.b};
+    hash = hashCombine(hash, pos, sizeof(pos));
+    hash = hashCombine(hash, color, sizeof(color));
+  }
+
+  return hash;
+}
+
+}  // namespace
+
 void declare_config(ObjectVisualizer::Config& config) {
   using namespace config;
   name("ObjectVisualizerConfig");
@@ -52,20 +73,31 @@ void declare_config(ObjectVisualizer::Config& config) {
   field(config.point_scale, "point_scale");
   field(config.point_alpha, "point_alpha");
   field(config.use_spheres, "use_spheres");
+  field(config.use_pointcloud, "use_pointcloud");
 }
 
 ObjectVisualizer::ObjectVisualizer(const Config& config)
     : config(config::checkValid(config)), nh_(config.module_ns) {
   if (config.enable_active_mesh_pub) {
-    active_vertices_pub_ = nh_.advertise<Marker>("active_vertices", 1, true);
+    active_vertices_pub_ =
+        config.use_pointcloud
+            ? nh_.advertise<sensor_msgs::PointCloud2>("active_points", 1, true)
+            : nh_.advertise<Marker>("active_vertices", 1, true);
   }
 
   if (config.enable_segmented_mesh_pub) {
-    segmented_vertices_pub_.reset(new ObjectCloudPub("object_vertices", nh_));
+    if (config.use_pointcloud) {
+      segmented_points_pub_.reset(new ObjectPointsPub("object_points", nh_));
+    } else {
+      segmented_vertices_pub_.reset(new ObjectCloudPub("object_vertices", nh_));
+    }
   }
 }
 
-ObjectVisualizer::~ObjectVisualizer() { segmented_vertices_pub_.reset(); }
+ObjectVisualizer::~ObjectVisualizer() {
+  segmented_vertices_pub_.reset();
+  segmented_points_pub_.reset();
+}
 
 std::string ObjectVisualizer::printInfo() const {
   std::stringstream ss;
@@ -88,9 +120,25 @@ void ObjectVisualizer::publishActiveVertices(uint64_t timestamp_ns,
     return;
   }
 
+  const auto signature = hashVertices(delta, active);
+  if (active_signature_ && *active_signature_ == signature) {
+    return;
+  }
+
+  active_signature_ = signature;
+  std_msgs::Header header;
+  header.stamp.fromNSec(timestamp_ns);
+  header.frame_id = GlobalInfo::instance().getFrames().odom;
+  if (config.use_pointcloud) {
+    sensor_msgs::PointCloud2 msg;
+    msg.header = header;
+    fillPointCloud(delta, active, msg);
+    active_vertices_pub_.publish(msg);
+    return;
+  }
+
   visualization_msgs::Marker msg;
-  msg.header.stamp.fromNSec(timestamp_ns);
-  msg.header.frame_id = GlobalInfo::instance().getFrames().odom;
+  msg.header = header;
   msg.ns = "active_vertices";
   msg.id = 0;
   fillMarkerFromCloud(delta, active, msg);
@@ -100,18 +148,54 @@ void ObjectVisualizer::publishActiveVertices(uint64_t timestamp_ns,
 void ObjectVisualizer::publishObjectClouds(uint64_t timestamp_ns,
                                            const kimera_pgmo::MeshDelta& delta,
                                            const LabelIndices& label_indices) const {
-  if (!segmented_vertices_pub_) {
+  if (!segmented_vertices_pub_ && !segmented_points_pub_) {
     return;
   }
 
-  for (auto&& [label, indices] : label_indices) {
-    visualization_msgs::Marker msg;
-    msg.header.stamp.fromNSec(timestamp_ns);
-    msg.header.frame_id = GlobalInfo::instance().getFrames().odom;
-    msg.ns = "label_vertices_" + std::to_string(label);
-    msg.id = 0;
-    fillMarkerFromCloud(delta, indices, msg);
-    segmented_vertices_pub_->publish(label, msg);
+  std_msgs::Header header;
+  header.stamp.fromNSec(timestamp_ns);
+  header.frame_id = GlobalInfo::instance().getFrames().odom;
+  for (const auto& label_indices_pair : label_indices) {
+    const auto label = label_indices_pair.first;
+    const auto& indices = label_indices_pair.second;
+    // only objects whose vertices changed need a new message
+    const auto changed = [&]() {
+      const auto signature = hashVertices(delta, indices);
+      auto iter = object_signatures_.find(label);
+      if (iter != object_signatures_.end() && iter->second == signature) {
+        return false;
+      }
+
+      object_signatures_[label] = signature;
+      return true;
+    };
+
+    // messages are only built for labels with subscribers and reuse their buffers
+    if (segmented_points_pub_) {
+      segmented_points_pub_->publish(
+          label, [&](uint32_t, sensor_msgs::PointCloud2& msg) {
+            if (!changed()) {
+              return false;
+            }
+
+            msg.header = header;
+            fillPointCloud(delta, indices, msg);
+            return true;
+          });
+      continue;
+    }
+
+    segmented_vertices_pub_->publish(label, [&](uint32_t, Marker& msg) {
+      if (!changed()) {
+        return false;
+      }
+
+      msg.header = header;
+      msg.ns = "label_vertices_" + std::to_string(label);
+      msg.id = 0;
+      fillMarkerFromCloud(delta, indices, msg);
+      return true;
+    });
   }
 }
 
@@ -126,6 +210,8 @@ void ObjectVisualizer::fillMarkerFromCloud(const kimera_pgmo::MeshDelta& delta,
   msg.scale.z = config.point_scale;
   msg.pose.orientation.w = 1.0;
 
+  msg.points.clear();
+  msg.colors.clear();
   msg.points.reserve(indices.size());
   msg.colors.reserve(indices.size());
   for (const auto idx : indices) {
@@ -142,4 +228,14 @@ void ObjectVisualizer::fillMarkerFromCloud(const kimera_pgmo::MeshDelta& delta,
   }
 }
 
+void ObjectVisualizer::fillPointCloud(const kimera_pgmo::MeshDelta& delta,
+                                      const std::vector<size_t>& indices,
+                                      sensor_msgs::PointCloud2& cloud) const {
+  initColoredCloud(indices.size(), cloud);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const auto& p = delta.vertex_updates->at(indices[i]);
+    setColoredPoint(cloud, i, p.x, p.y, p.z, p.r, p.g, p.b);
+  }
+}
+
 }  // namespace hydra
@@ -42,8 +42,10 @@
 #include <hydra/places/compression_graph_extractor.h>
 #include <hydra/utils/timing_utilities.h>
 
+#include "hydra_ros/utils/metrics.h"
 #include "hydra_ros/visualizer/gvd_visualization_utilities.h"
 #include "hydra_ros/visualizer/visualizer_utilities.h"
+#include "hydra_ros/visualizer/voxel_cloud.h"
 
 namespace hydra {
 
@@ -52,7 +54,6 @@ using places::GraphExtractorInterface;
 using places::GvdGraph;
 using places::GvdLayer;
 using places::GvdVoxel;
-using timing::ScopedTimer;
 using visualization_msgs::Marker;
 using visualization_msgs::MarkerArray;
 
@@ -64,14 +65,23 @@ void declare_config(PlacesVisualizer::Config& config) {
   field(config.show_block_outlines, "show_block_outlines");
   field(config.use_gvd_block_outlines, "use_gvd_block_outlines");
   field(config.outline_scale, "outline_scale");
+  field(config.use_pointcloud, "use_pointcloud");
+  field(config.chunks, "chunks");
 }
 
 PlacesVisualizer::PlacesVisualizer(const Config& config)
     : config_(config),
       nh_(config.ns),
       previous_spheres_(0),
-      published_gvd_graph_(false) {
+      published_gvd_graph_(false),
+      published_gvd_clusters_(false),
+      gvd_config_changed_(false),
+      gvd_config_version_(0) {
   pubs_.reset(new MarkerGroupPub(nh_));
+  for (const auto& topic : {"esdf_viz", "gvd_viz", "surface_viz"}) {
+    chunks_.emplace(topic, std::make_unique<ChunkedMarkerCache>(config_.chunks));
+  }
+
   config_.graph.layer_z_step = 0;
 
   setupConfigServers();
@@ -86,16 +96,22 @@ std::string PlacesVisualizer::printInfo() const {
 }
 
 void PlacesVisualizer::call(uint64_t timestamp_ns,
-                            const Eigen::Isometry3f&,
+                            const Eigen::Isometry3f& world_T_body,
                             const GvdLayer& gvd,
                             const GraphExtractorInterface* extractor) const {
-  ScopedTimer timer("topology/topology_visualizer", timestamp_ns);
+  LatencyTimer timer("topology/topology_visualizer", timestamp_ns);
 
   std_msgs::Header header;
   header.frame_id = GlobalInfo::instance().getFrames().map;
   header.stamp.fromNSec(timestamp_ns);
 
-  visualizeGvd(header, gvd);
+  if (config_.use_pointcloud) {
+    visualizeGvdClouds(header, gvd);
+  } else if (config_.chunks.enable) {
+    visualizeGvdChunks(header, world_T_body.translation().cast<double>(), gvd);
+  } else {
+    visualizeGvd(header, gvd);
+  }
 
   if (extractor) {
     visualizeGraph(header, extractor->getGraph());
@@ -115,12 +131,22 @@ void PlacesVisualizer::call(uint64_t timestamp_ns,
   pubs_->publish("gvd_cluster_viz", [&](MarkerArray& markers) {
     const std::string ns = "gvd_cluster_graph";
     if (compression->getGvdGraph().empty() && published_gvd_clusters_) {
-      published_gvd_graph_ = false;
+      published_gvd_clusters_ = false;
+      gvd_cluster_signature_.reset();
       markers.markers.push_back(makeDeleteMarker(header, 0, ns + "_nodes"));
       markers.markers.push_back(makeDeleteMarker(header, 0, ns + "_edges"));
       return true;
     }
 
+    // markers are latched, so there is no need to republish an unchanged graph
+    uint64_t signature = computeGvdGraphSignature(compression->getGvdGraph());
+    signature += computeGvdClusterSignature(compression->getCompressedNodeInfo(),
+                                            compression->getCompressedRemapping());
+    signature += gvd_config_version_;
+    if (gvd_cluster_signature_ && *gvd_cluster_signature_ == signature) {
+      return false;
+    }
+
     markers = showGvdClusters(compression->getGvdGraph(),
                               compression->getCompressedNodeInfo(),
                               compression->getCompressedRemapping(),
@@ -135,6 +161,7 @@ void PlacesVisualizer::call(uint64_t timestamp_ns,
     markers.markers.at(0).header = header;
     markers.markers.at(1).header = header;
     published_gvd_clusters_ = true;
+    gvd_cluster_signature_ = signature;
     return true;
   });
 }
@@ -202,11 +229,18 @@ void PlacesVisualizer::visualizeGvdGraph(const std_msgs::Header& header,
     const std::string ns = config_.place_marker_ns + "_gvd_graph";
     if (graph.empty() && published_gvd_graph_) {
       published_gvd_graph_ = false;
+      gvd_graph_signature_.reset();
       markers.markers.push_back(makeDeleteMarker(header, 0, ns + "_nodes"));
       markers.markers.push_back(makeDeleteMarker(header, 0, ns + "_edges"));
       return true;
     }
 
+    // markers are latched, so there is no need to republish an unchanged graph
+    const auto signature = computeGvdGraphSignature(graph) + gvd_config_version_;
+    if (gvd_graph_signature_ && *gvd_graph_signature_ == signature) {
+      return false;
+    }
+
     markers = makeGvdGraphMarkers(graph, config_.gvd, config_.colormap, ns);
     if (markers.markers.empty()) {
       return false;
@@ -215,6 +249,7 @@ void PlacesVisualizer::visualizeGvdGraph(const std_msgs::Header& header,
     markers.markers.at(0).header = header;
     markers.markers.at(1).header = header;
     published_gvd_graph_ = true;
+    gvd_graph_signature_ = signature;
     return true;
   });
 }
@@ -261,6 +296,58 @@ void PlacesVisualizer::visualizeGvd(const std_msgs::Header& header,
   });
 }
 
+void PlacesVisualizer::visualizeGvdClouds(const std_msgs::Header& header,
+                                          const GvdLayer& gvd) const {
+  pubs_->publish("esdf_viz_cloud", [&](sensor_msgs::PointCloud2& msg) {
+    auto marker = makeEsdfMarker(config_.gvd, config_.colormap, gvd);
+    marker.header = header;
+    msg = makeVoxelCloud(marker);
+    return msg.width > 0;
+  });
+
+  pubs_->publish("gvd_viz_cloud", [&](sensor_msgs::PointCloud2& msg) {
+    auto marker = makeGvdMarker(config_.gvd, config_.colormap, gvd);
+    marker.header = header;
+    msg = makeVoxelCloud(marker);
+    return msg.width > 0;
+  });
+
+  pubs_->publish("surface_viz_cloud", [&](sensor_msgs::PointCloud2& msg) {
+    auto marker = makeSurfaceVoxelMarker(config_.gvd, config_.colormap, gvd);
+    marker.header = header;
+    msg = makeVoxelCloud(marker);
+    return msg.width > 0;
+  });
+}
+
+void PlacesVisualizer::visualizeGvdChunks(const std_msgs::Header& header,
+                                          const Eigen::Vector3d& sensor_pos,
+                                          const GvdLayer& gvd) const {
+  using places::GvdBlock;
+  using FillFunc = ChunkedMarkerCache::FillFunc<GvdBlock>;
+  const auto publish_chunks = [&](const std::string& topic, const FillFunc& fill) {
+    auto& chunks = *chunks_.at(topic);
+    chunks.setNumSubscribers(pubs_->numSubscribers(topic));
+    pubs_->publish(topic, [&](MarkerArray& msg) {
+      const auto prototype = makeVoxelMarker(gvd.voxel_size, "gvd_visualizer");
+      msg = chunks.update<GvdBlock>(
+          header, gvd, sensor_pos, prototype, fill, gvd_config_changed_);
+      return !msg.markers.empty();
+    });
+  };
+
+  publish_chunks("esdf_viz", [&](const GvdBlock& block, Marker& marker) {
+    addEsdfVoxels(config_.gvd, config_.colormap, block, marker);
+  });
+  publish_chunks("gvd_viz", [&](const GvdBlock& block, Marker& marker) {
+    addGvdVoxels(config_.gvd, config_.colormap, block, marker);
+  });
+  publish_chunks("surface_viz", [&](const GvdBlock& block, Marker& marker) {
+    addSurfaceVoxels(config_.gvd, config_.colormap, block, marker);
+  });
+  gvd_config_changed_ = false;
+}
+
 void PlacesVisualizer::visualizeBlocks(const std_msgs::Header& header,
                                        const GvdLayer& gvd) const {
   pubs_->publish("voxel_block_viz", [&](Marker& msg) {
@@ -381,10 +468,14 @@ void PlacesVisualizer::graphConfigCb(LayerConfig& config, uint32_t) {
 
 void PlacesVisualizer::colormapCb(ColormapConfig& config, uint32_t) {
   config_.colormap = config;
+  gvd_config_changed_ = true;
+  ++gvd_config_version_;
 }
 
 void PlacesVisualizer::gvdConfigCb(GvdVisualizerConfig& config, uint32_t) {
   config_.gvd = config;
+  gvd_config_changed_ = true;
+  ++gvd_config_version_;
   config_.graph.places_colormap_min_distance = config.gvd_min_distance;
   config_.graph.places_colormap_max_distance = config.gvd_max_distance;
 }
@@ -47,21 +47,90 @@
 #include <hydra/loop_closure/loop_closure_module.h>
 #include <hydra/reconstruction/reconstruction_module.h>
 #include <pose_graph_tools_ros/conversions.h>
+#include <unistd.h>
 
+#include <filesystem>
+#include <future>
 #include <memory>
 
 #include "hydra_ros/backend/ros_backend_publisher.h"
 #include "hydra_ros/frontend/ros_frontend_publisher.h"
 #include "hydra_ros/loop_closure/ros_lcd_registration.h"
 #include "hydra_ros/utils/bow_subscriber.h"
+#include "hydra_ros/utils/latency_tracer.h"
+#include "hydra_ros/utils/metrics.h"
+#include "hydra_ros/utils/restored_node_ids.h"
 
 namespace hydra {
 
+namespace {
+
+// marks when the outputs for an input are available (before any other sink runs)
+struct ReconstructionTraceSink : public ReconstructionModule::Sink {
+  void call(uint64_t timestamp_ns,
+            const Eigen::Isometry3d&,
+            const TsdfLayer&,
+            const ReconstructionOutput&) const override {
+    LatencyTracer::instance().mark(timestamp_ns, "reconstruction");
+  }
+};
+
+// wakes the bag input when reconstruction took packets from its queue
+struct BagProgressSink : public ReconstructionModule::Sink {
+  explicit BagProgressSink(BagInputModule& input) : input(input) {}
+
+  void call(uint64_t,
+            const Eigen::Isometry3d&,
+            const TsdfLayer&,
+            const ReconstructionOutput&) const override {
+    input.notifyProgress();
+  }
+
+  BagInputModule& input;
+};
+
+struct FrontendTraceSink : public FrontendModule::Sink {
+  void call(uint64_t timestamp_ns,
+            const DynamicSceneGraph&,
+            const BackendInput&) const override {
+    LatencyTracer::instance().mark(timestamp_ns, "frontend");
+  }
+};
+
+struct BackendTraceSink : public BackendModule::Sink {
+  void call(uint64_t timestamp_ns,
+            const DynamicSceneGraph&,
+            const kimera_pgmo::DeformationGraph&) const override {
+    LatencyTracer::instance().mark(timestamp_ns, "backend");
+  }
+};
+
+}  // namespace
+
+void declare_config(WarmStartConfig& conf) {
+  using namespace config;
+  name("WarmStartConfig");
+  field(conf.dsg_filepath, "dsg_filepath");
+  field(conf.frontend_filepath, "frontend_filepath");
+  field(conf.dgrf_filepath, "dgrf_filepath");
+  if (conf.enabled()) {
+    check(conf.frontend_filepath, NE, "", "frontend_filepath");
+    check(conf.dgrf_filepath, NE, "", "dgrf_filepath");
+  }
+}
+
 void declare_config(HydraRosConfig& conf) {
   using namespace config;
   name("HydraRosConfig");
   field(conf.enable_frontend_output, "enable_frontend_output");
   field(conf.input, "input");
+  field(conf.bag_input, "bag_input");
+  field(conf.sensor_prefetch, "sensor_prefetch");
+  field(conf.parallel_init, "parallel_init");
+  field(conf.warm_start, "warm_start");
+  field(conf.checkpoint, "checkpoint");
+  field(conf.tracing, "tracing");
+  field(conf.memory, "memory");
 }
 
 HydraRosPipeline::HydraRosPipeline(const ros::NodeHandle& nh, int robot_id)
@@ -69,21 +138,121 @@ HydraRosPipeline::HydraRosPipeline(const ros::NodeHandle& nh, int robot_id)
       config_(config::checkValid(config::fromRos<HydraRosConfig>(nh))),
       nh_(nh) {}
 
-HydraRosPipeline::~HydraRosPipeline() {}
+HydraRosPipeline::~HydraRosPipeline() {
+  LatencyTracer::instance().stop();
+  for (const auto& name : queue_gauges_) {
+    MetricsRegistry::instance().removeGauge(name);
+  }
+}
+
+template <typename Queue>
+void HydraRosPipeline::addQueueGauge(const std::string& name,
+                                     const std::shared_ptr<Queue>& queue) {
+  if (!queue) {
+    return;
+  }
+
+  // the gauge holds onto the queue so it stays valid until the gauge is removed
+  const auto gauge_name = "queue/" + name;
+  MetricsRegistry::instance().registerGauge(
+      gauge_name, [queue]() { return static_cast<double>(queue->size()); });
+  queue_gauges_.push_back(gauge_name);
+  queue_sizes_.push_back([queue]() { return static_cast<size_t>(queue->size()); });
+}
+
+bool HydraRosPipeline::inputFinished() const {
+  if (!bag_input_ || !bag_input_->finished()) {
+    return false;
+  }
+
+  for (const auto& queue_size : queue_sizes_) {
+    if (queue_size() > 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
 
 void HydraRosPipeline::init() {
   const auto& pipeline_config = GlobalInfo::instance().getConfig();
+  LatencyTracer::instance().start(config_.tracing);
+  auto& prefetcher = SensorPrefetcher::instance();
+  std::future<std::shared_ptr<LoopClosureModule>> lcd;
+  if (config_.parallel_init) {
+    // neither depends on the other modules, so both can overlap with their setup
+    prefetcher.start(config_.sensor_prefetch, ros::NodeHandle(nh_, "input"));
+    if (pipeline_config.enable_lcd) {
+      shared_state_->lcd_queue.reset(new InputQueue<LcdInput::Ptr>());
+      lcd = std::async(std::launch::async, [this]() { return createLCD(); });
+    }
+  }
+
   initFrontend();
   initBackend();
   initReconstruction();
   if (pipeline_config.enable_lcd) {
-    initLCD();
-    bow_sub_.reset(new BowSubscriber(nh_, shared_state_));
+    if (lcd.valid()) {
+      modules_["lcd"] = lcd.get();
+    } else {
+      initLCD();
+    }
+
+    const auto bow_config =
+        config::fromRos<BowSubscriber::Config>(ros::NodeHandle(nh_, "bow"));
+    bow_sub_.reset(new BowSubscriber(bow_config, nh_, shared_state_));
+  }
+
+  if (!config_.checkpoint.directory.empty()) {
+    checkpointer_ = std::make_shared<PipelineCheckpointer>(config_.checkpoint);
+    const auto frontend = getModule<FrontendModule>("frontend");
+    if (frontend) {
+      frontend->addSink(checkpointer_->frontendSink());
+    }
+
+    getModule<BackendModule>("backend")->addSink(checkpointer_->backendSink());
+  }
+
+  // explicitly requested state takes precedence over checkpoints
+  const auto warm_start =
+      config_.warm_start.enabled() ? config_.warm_start : getResumeConfig();
+  if (warm_start.enabled()) {
+    warmStart(warm_start);
   }
 
   const auto reconstruction = getModule<ReconstructionModule>("reconstruction");
   CHECK(reconstruction);
-  input_module_.reset(new RosInputModule(config_.input, reconstruction->queue()));
+  // sensors are created with the input module and resolve their info from the prefetch
+  if (!config_.parallel_init) {
+    prefetcher.start(config_.sensor_prefetch, ros::NodeHandle(nh_, "input"));
+  }
+
+  if (config_.bag_input.bag_path.empty()) {
+    input_module_.reset(new RosInputModule(config_.input, reconstruction->queue()));
+  } else {
+    auto bag_input = new BagInputModule(config_.bag_input, reconstruction->queue());
+    input_module_.reset(bag_input);
+    bag_input_ = bag_input;
+    reconstruction->addSink(std::make_shared<BagProgressSink>(*bag_input));
+  }
+  prefetcher.stop();
+
+  addQueueGauge("reconstruction", reconstruction->queue());
+  const auto frontend = getModule<FrontendModule>("frontend");
+  if (frontend) {
+    addQueueGauge("frontend", frontend->getQueue());
+  }
+
+  addQueueGauge("backend", shared_state_->backend_queue);
+  addQueueGauge("lcd", shared_state_->lcd_queue);
+
+  if (config_.memory.period_s > 0.0) {
+    memory_monitor_.reset(new MemoryMonitor(config_.memory, nh_));
+    memory_monitor_->addGraph("frontend", frontend_dsg_);
+    memory_monitor_->addGraph("backend", backend_dsg_);
+    const TsdfMemorySink::Config tsdf_config{config_.memory.period_s};
+    reconstruction->addSink(std::make_shared<TsdfMemorySink>(tsdf_config));
+  }
 }
 
 void HydraRosPipeline::initFrontend() {
@@ -91,6 +260,10 @@ void HydraRosPipeline::initFrontend() {
   const auto logs = GlobalInfo::instance().getLogs();
   FrontendModule::Ptr frontend =
       config::createFromROS<FrontendModule>(fnh, frontend_dsg_, shared_state_, logs);
+  if (frontend && config_.tracing.enable) {
+    frontend->addSink(std::make_shared<FrontendTraceSink>());
+  }
+
   if (config_.enable_frontend_output) {
     CHECK(frontend) << "Frontend module required!";
     frontend->addSink(std::make_shared<RosFrontendPublisher>(fnh));
@@ -105,6 +278,10 @@ void HydraRosPipeline::initBackend() {
   BackendModule::Ptr backend = config::createFromROS<BackendModule>(
       bnh, backend_dsg_, shared_state_, GlobalInfo::instance().getLogs());
   CHECK(backend) << "Failed to construct backend!";
+  if (config_.tracing.enable) {
+    backend->addSink(std::make_shared<BackendTraceSink>());
+  }
+
   backend->addSink(std::make_shared<RosBackendPublisher>(bnh));
   modules_["backend"] = backend;
 
@@ -135,24 +312,98 @@ void HydraRosPipeline::initReconstruction() {
   }
 
   ros::NodeHandle rnh(nh_, "reconstruction");
-  modules_["reconstruction"] =
+  auto reconstruction =
       config::createFromROS<ReconstructionModule>(rnh, frontend->getQueue());
+  if (reconstruction && config_.tracing.enable) {
+    reconstruction->addSink(std::make_shared<ReconstructionTraceSink>());
+  }
+
+  modules_["reconstruction"] = reconstruction;
 }
 
 void HydraRosPipeline::initLCD() {
+  shared_state_->lcd_queue.reset(new InputQueue<LcdInput::Ptr>());
+  modules_["lcd"] = createLCD();
+}
+
+std::shared_ptr<LoopClosureModule> HydraRosPipeline::createLCD() const {
   auto lcd_config = config::fromRos<LoopClosureConfig>(nh_);
   lcd_config.detector.num_semantic_classes = GlobalInfo::instance().getTotalLabels();
   VLOG(1) << "Number of classes for LCD: " << lcd_config.detector.num_semantic_classes;
   config::checkValid(lcd_config);
 
-  shared_state_->lcd_queue.reset(new InputQueue<LcdInput::Ptr>());
   auto lcd = std::make_shared<LoopClosureModule>(lcd_config, shared_state_);
-  modules_["lcd"] = lcd;
-
   if (lcd_config.detector.enable_agent_registration) {
-    lcd->getDetector().setRegistrationSolver(0,
-                                             std::make_unique<lcd::DsgAgentSolver>());
+    const auto solver_config = config::fromRos<lcd::DsgAgentSolver::Config>(
+        ros::NodeHandle(nh_, "agent_registration"));
+    lcd->getDetector().setRegistrationSolver(
+        0, std::make_unique<lcd::DsgAgentSolver>(solver_config));
+  }
+
+  return lcd;
+}
+
+WarmStartConfig HydraRosPipeline::getResumeConfig() const {
+  WarmStartConfig resume;
+  if (config_.checkpoint.directory.empty() || !config_.checkpoint.resume) {
+    return resume;
+  }
+
+  const auto latest = findLatestCheckpoint(config_.checkpoint.directory);
+  if (!latest) {
+    LOG(WARNING) << "No checkpoint found in '" << config_.checkpoint.directory
+                 << "': starting fresh";
+    return resume;
+  }
+
+  // the frontend graph holds everything the backend needs to rebuild its state
+  resume.dsg_filepath = (*latest / CheckpointFiles::frontend_dsg).string();
+  resume.frontend_filepath = resume.dsg_filepath;
+  resume.dgrf_filepath = (*latest / CheckpointFiles::deformation_graph).string();
+  return resume;
+}
+
+void HydraRosPipeline::warmStart(const WarmStartConfig& config) {
+  const auto backend = getModule<BackendModule>("backend");
+  CHECK(backend);
+
+  LOG(INFO) << "Resuming from scene graph '" << config.dsg_filepath << "'";
+  const auto graph = DynamicSceneGraph::load(config.dsg_filepath);
+  if (!graph) {
+    LOG(ERROR) << "Failed to load '" << config.dsg_filepath << "': starting fresh";
+    return;
   }
+
+  // the frontend numbers new nodes from zero, so restored nodes move out of its way
+  const auto block = RestoredNodeIds::findFreeBlock(*graph);
+  const auto restored = RestoredNodeIds::shiftGraph(*graph, block);
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(frontend_dsg_->mutex);
+    // merge instead of replacing the graph so pointers held by modules stay valid
+    frontend_dsg_->graph->mergeGraph(*restored);
+    frontend_dsg_->updated = true;
+  }  // end critical section
+
+  // the backend state has to use the same ids as the frontend graph
+  DynamicSceneGraph::Ptr state = restored;
+  if (config.frontend_filepath != config.dsg_filepath) {
+    const auto frontend_graph = DynamicSceneGraph::load(config.frontend_filepath);
+    if (!frontend_graph) {
+      LOG(ERROR) << "Failed to load '" << config.frontend_filepath
+                 << "': not restoring backend";
+      return;
+    }
+
+    state = RestoredNodeIds::shiftGraph(*frontend_graph, block);
+  }
+
+  auto state_path = std::filesystem::temp_directory_path() /
+                    ("hydra_warm_start_" + std::to_string(getpid()));
+  state_path += std::filesystem::path(config.frontend_filepath).extension();
+  state->save(state_path.string());
+  backend->loadState(state_path.string(), config.dgrf_filepath);
+  std::filesystem::remove(state_path);
+  LOG(INFO) << "Loaded backend state (restored nodes moved to block " << block << ")";
 }
 
 }  // namespace hydra
@@ -0,0 +1,144 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/input/bag_image_receiver.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/types/path.h>
+#include <config_utilities/validation.h>
+#include <cv_bridge/cv_bridge.h>
+#include <glog/logging.h>
+#include <hydra/input/input_packet.h>
+
+#include "hydra_ros/utils/latency_tracer.h"
+#include "hydra_ros/utils/owned_image.h"
+
+namespace hydra {
+
+void declare_config(BagImageReceiver::Config& config) {
+  using namespace config;
+  name("BagImageReceiver::Config");
+  base<DataReceiver::Config>(config);
+  field<Path>(config.bag_path, "bag_path");
+  field(config.color_topic, "color_topic");
+  field(config.depth_topic, "depth_topic");
+  field(config.start, "start", "s");
+  field(config.duration, "duration", "s");
+  field(config.color_compressed, "color_compressed");
+  field(config.use_stamp_sync, "use_stamp_sync");
+  field(config.sync_tolerance_s, "sync_tolerance_s", "s");
+  field(config.max_queue_size, "max_queue_size");
+  check(config.color_topic, NE, "", "color_topic");
+  check(config.depth_topic, NE, "", "depth_topic");
+  check(config.max_queue_size, GT, 0u, "max_queue_size");
+  check<Path::Exists>(config.bag_path, "bag_path");
+}
+
+BagImageReceiver::BagImageReceiver(const Config& config, size_t sensor_id)
+    : DataReceiver(config, sensor_id),
+      config(config),
+      should_stop_(false),
+      finished_(false),
+      backpressure_([this]() { return queue.size(); }, config.max_queue_size) {}
+
+BagImageReceiver::~BagImageReceiver() {
+  should_stop_ = true;
+  backpressure_.stop();
+  if (read_thread_.joinable()) {
+    read_thread_.join();
+  }
+}
+
+bool BagImageReceiver::initImpl() {
+  read_thread_ = std::thread(&BagImageReceiver::read, this);
+  return true;
+}
+
+void BagImageReceiver::read() {
+  BagConfig bag_config;
+  bag_config.bag_path = config.bag_path;
+  bag_config.color_topic = config.color_topic;
+  bag_config.depth_topic = config.depth_topic;
+  bag_config.start = config.start;
+  bag_config.duration = config.duration;
+  bag_config.color_compressed = config.color_compressed;
+
+  BagReader::Config reader_config;
+  reader_config.use_stamp_sync = config.use_stamp_sync;
+  reader_config.sync_tolerance_s = config.sync_tolerance_s;
+
+  try {
+    BagReader::readImages(
+        reader_config,
+        bag_config,
+        [this](const auto& color, const auto& depth) { callback(color, depth); },
+        &should_stop_);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to read bag " << config.bag_path << ": " << e.what();
+  }
+
+  LOG(INFO) << "Finished reading " << config.bag_path;
+  if (!should_stop_) {
+    queue.push(std::make_shared<ImageInputPacket>(kEndOfBag, sensor_id_));
+  }
+
+  finished_ = true;
+}
+
+void BagImageReceiver::callback(const sensor_msgs::Image::ConstPtr& color,
+                                const sensor_msgs::Image::ConstPtr& depth) {
+  // wait for the input module instead of dropping frames like a live sensor
+  backpressure_.wait();
+
+  const auto timestamp_ns = color->header.stamp.toNSec();
+  if (should_stop_ || !checkInputTimestamp(timestamp_ns)) {
+    return;
+  }
+
+  LatencyTracer::instance().mark(timestamp_ns, "receive");
+  auto packet = std::make_shared<ImageInputPacket>(timestamp_ns, sensor_id_);
+  try {
+    packet->color = toRgbImage(color);
+    packet->depth = toOwnedImage(cv_bridge::toCvShare(depth));
+  } catch (const cv_bridge::Exception& e) {
+    LOG(ERROR) << "Unable to convert images @ " << timestamp_ns
+               << " [ns]: " << e.what();
+    return;
+  }
+
+  queue.push(packet);
+}
+
+}  // namespace hydra
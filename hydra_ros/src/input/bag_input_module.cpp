@@ -0,0 +1,151 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/input/bag_input_module.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/printing.h>
+#include <config_utilities/types/path.h>
+#include <config_utilities/validation.h>
+#include <hydra/common/global_info.h>
+#include <hydra/utils/timing_utilities.h>
+
+#include <sstream>
+
+#include "hydra_ros/input/bag_image_receiver.h"
+#include "hydra_ros/utils/bag_metadata.h"
+#include "hydra_ros/utils/latency_tracer.h"
+#include "hydra_ros/utils/metrics.h"
+#include "hydra_ros/utils/pose_cache.h"
+
+namespace hydra {
+
+void declare_config(BagInputModule::Config& config) {
+  using namespace config;
+  name("BagInputModule::Config");
+  base<InputModule::Config>(config);
+  field<Path>(config.bag_path, "bag_path");
+  field<Path>(config.metadata_cache_dir, "metadata_cache_dir");
+  field(config.max_output_queue_size, "max_output_queue_size");
+  if (!config.bag_path.empty()) {
+    check<Path::Exists>(config.bag_path, "bag_path");
+  }
+
+  check(config.max_output_queue_size, GT, 0u, "max_output_queue_size");
+}
+
+BagInputModule::BagInputModule(const Config& config, const OutputQueue::Ptr& queue)
+    : InputModule(config, queue),
+      config(config::checkValid(config)),
+      output_queue_(queue),
+      pose_cache_(std::make_unique<PoseCache>(
+          *BagMetadata::get(config.bag_path, config.metadata_cache_dir))),
+      backpressure_([this]() { return output_queue_ ? output_queue_->size() : 0; },
+                    config.max_output_queue_size),
+      num_finished_receivers_(0) {
+  for (const auto& receiver : receivers_) {
+    auto bag_receiver = dynamic_cast<BagImageReceiver*>(receiver.get());
+    if (bag_receiver) {
+      bag_receivers_.push_back(bag_receiver);
+    }
+  }
+}
+
+BagInputModule::~BagInputModule() = default;
+
+void BagInputModule::stop() {
+  // release the input thread if it is waiting on a queue that will never drain
+  backpressure_.stop();
+  InputModule::stop();
+}
+
+std::string BagInputModule::printInfo() const {
+  std::stringstream ss;
+  ss << config::toString(config);
+  return ss.str();
+}
+
+bool BagInputModule::finished() const {
+  // empty queues are not enough: the input thread may still be converting a packet
+  if (num_finished_receivers_ < bag_receivers_.size()) {
+    return false;
+  }
+
+  for (const auto& receiver : receivers_) {
+    if (receiver->queue.size() > 0) {
+      return false;
+    }
+  }
+
+  return !output_queue_ || output_queue_->size() == 0;
+}
+
+void BagInputModule::notifyProgress() { backpressure_.notify(); }
+
+PoseStatus BagInputModule::getBodyPose(uint64_t timestamp_ns) {
+  // the packet was just taken from a receiver queue
+  for (auto receiver : bag_receivers_) {
+    receiver->notifyConsumed();
+  }
+
+  if (timestamp_ns == BagImageReceiver::kEndOfBag) {
+    // packets are handed on in order, so everything read before it was pushed
+    ++num_finished_receivers_;
+    return {false, {}, {}};
+  }
+
+  {  // tracks how long each packet waits for reconstruction to catch up
+    LatencyTimer timer("input/backpressure_wait", timestamp_ns);
+    backpressure_.wait();
+  }
+
+  const auto& frames = GlobalInfo::instance().getFrames();
+  const auto pose = pose_cache_->lookupPose(timestamp_ns, frames.odom, frames.robot);
+  if (!pose) {
+    MetricsRegistry::instance().addCount("input/pose_failures");
+    LOG(ERROR) << "Could not find body pose @ " << timestamp_ns << " [ns] in "
+               << config.bag_path;
+    return {false, {}, {}};
+  }
+
+  LatencyTracer::instance().mark(timestamp_ns, "pose");
+  PoseStatus pose_status;
+  pose_status.is_valid = true;
+  pose_status.target_p_source = pose.to_p_from;
+  pose_status.target_R_source = pose.to_R_from;
+  return pose_status;
+}
+
+}  // namespace hydra
@@ -0,0 +1,148 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/image_normalizer.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace hydra {
+
+void declare_config(ImageNormalizer::Config& config) {
+  using namespace config;
+  name("ImageNormalizer::Config");
+  field(config.normalize_depth, "normalize_depth");
+  field(config.integer_depth_scale, "integer_depth_scale");
+  field(config.min_depth_m, "min_depth_m", "m");
+  field(config.max_depth_m, "max_depth_m", "m");
+  field(config.label_remapping, "label_remapping");
+
+  check(config.integer_depth_scale, GT, 0.0f, "integer_depth_scale");
+  check(config.min_depth_m, GE, 0.0f, "min_depth_m");
+}
+
+ImageNormalizer::ImageNormalizer(const Config& config)
+    : config(config::checkValid(config)) {
+  if (config.label_remapping.empty()) {
+    return;
+  }
+
+  // a dense table covers every input label up to the largest remapped one
+  int32_t max_label = 0;
+  for (const auto& [input, output] : config.label_remapping) {
+    max_label = std::max(max_label, input);
+  }
+
+  lut_.resize(static_cast<size_t>(max_label) + 1);
+  for (size_t i = 0; i < lut_.size(); ++i) {
+    lut_[i] = static_cast<int32_t>(i);
+  }
+
+  for (const auto& [input, output] : config.label_remapping) {
+    if (input >= 0) {
+      lut_[input] = output;
+    }
+  }
+}
+
+bool ImageNormalizer::normalizeDepth(const cv::Mat& raw, cv::Mat& depth) const {
+  const int type = raw.type();
+  if (type != CV_16UC1 && type != CV_32FC1) {
+    return false;
+  }
+
+  const float min_depth = config.min_depth_m;
+  const float max_depth = config.max_depth_m > 0.0f
+                              ? config.max_depth_m
+                              : std::numeric_limits<float>::infinity();
+  const float scale = config.integer_depth_scale;
+
+  depth.create(raw.rows, raw.cols, CV_32FC1);
+  for (int r = 0; r < raw.rows; ++r) {
+    float* out = depth.ptr<float>(r);
+    if (type == CV_16UC1) {
+      const uint16_t* in = raw.ptr<uint16_t>(r);
+      for (int c = 0; c < raw.cols; ++c) {
+        const float value = scale * in[c];
+        out[c] = (value >= min_depth && value <= max_depth) ? value : 0.0f;
+      }
+    } else {
+      const float* in = raw.ptr<float>(r);
+      for (int c = 0; c < raw.cols; ++c) {
+        // comparisons with NaN are false, so NaN is also marked invalid
+        const float value = in[c];
+        out[c] = (value >= min_depth && value <= max_depth) ? value : 0.0f;
+      }
+    }
+  }
+
+  return true;
+}
+
+template <typename T>
+void ImageNormalizer::remapRows(const cv::Mat& raw, cv::Mat& labels) const {
+  const int32_t* lut = lut_.data();
+  const int64_t lut_size = static_cast<int64_t>(lut_.size());
+  for (int r = 0; r < raw.rows; ++r) {
+    const T* in = raw.ptr<T>(r);
+    int32_t* out = labels.ptr<int32_t>(r);
+    for (int c = 0; c < raw.cols; ++c) {
+      const int64_t label = in[c];
+      out[c] = (label >= 0 && label < lut_size) ? lut[label] : in[c];
+    }
+  }
+}
+
+bool ImageNormalizer::remapLabels(const cv::Mat& raw, cv::Mat& labels) const {
+  const int type = raw.type();
+  if (type != CV_8UC1 && type != CV_16UC1 && type != CV_32SC1) {
+    return false;
+  }
+
+  labels.create(raw.rows, raw.cols, CV_32SC1);
+  if (type == CV_8UC1) {
+    remapRows<uint8_t>(raw, labels);
+  } else if (type == CV_16UC1) {
+    remapRows<uint16_t>(raw, labels);
+  } else {
+    remapRows<int32_t>(raw, labels);
+  }
+
+  return true;
+}
+
+}  // namespace hydra
@@ -38,11 +38,24 @@
 #include <cv_bridge/cv_bridge.h>
 #include <glog/logging.h>
 
+#include "hydra_ros/utils/latency_tracer.h"
+#include "hydra_ros/utils/owned_image.h"
+
 namespace hydra {
 
 using image_transport::ImageTransport;
 using image_transport::SubscriberFilter;
 
+ImageSubscriber makeSubscriber(const ros::NodeHandle& nh, const std::string& topic) {
+  // the image transport lives in the namespace of the topic
+  const auto pos = topic.find_last_of('/');
+  if (pos == std::string::npos) {
+    return ImageSubscriber(nh, "", topic);
+  }
+
+  return ImageSubscriber(nh, topic.substr(0, pos), topic.substr(pos + 1));
+}
+
 image_transport::TransportHints getHintsWithNamespace(const ros::NodeHandle& nh,
                                                       const std::string& ns) {
   return image_transport::TransportHints(
@@ -54,7 +67,19 @@ void declare_config(ImageReceiver::Config& config) {
   name("ImageReceiver::Config");
   base<DataReceiver::Config>(config);
   field(config.ns, "ns");
+  field(config.color_topic, "color_topic");
+  field(config.depth_topic, "depth_topic");
+  field(config.label_topic, "label_topic");
   field(config.queue_size, "queue_size");
+  field(config.use_stamp_sync, "use_stamp_sync");
+  field(config.sync_tolerance_s, "sync_tolerance_s", "s");
+  field(config.buffer_pool_size, "buffer_pool_size");
+  field(config.num_callback_threads, "num_callback_threads");
+  field(config.num_conversion_threads, "num_conversion_threads");
+  field(config.normalization, "normalization");
+  check(config.color_topic, NE, "", "color_topic");
+  check(config.depth_topic, NE, "", "depth_topic");
+  check(config.label_topic, NE, "", "label_topic");
 }
 
 ImageSubscriber::ImageSubscriber() {}
@@ -69,13 +94,57 @@ ImageSubscriber::ImageSubscriber(const ros::NodeHandle& nh,
 }
 
 ImageReceiver::ImageReceiver(const Config& config, size_t sensor_id)
-    : DataReceiver(config, sensor_id), config(config), nh_(config.ns) {}
+    : DataReceiver(config, sensor_id),
+      config(config),
+      nh_(config.ns),
+      normalizer_(config.normalization) {
+  if (config.buffer_pool_size > 0) {
+    pool_ = MatPool::create(config.buffer_pool_size);
+  }
+}
 
 bool ImageReceiver::initImpl() {
+  if (config.num_callback_threads > 0) {
+    // image transports copy the callback queue of the nodehandle they are given
+    callback_threads_.reset(new CallbackThreads(nh_, config.num_callback_threads));
+  }
+
+  if (config.num_conversion_threads > 0) {
+    // packets reach the queue in the order the images were synced
+    conversion_pool_.reset(new ConversionPool(
+        config.num_conversion_threads,
+        config.queue_size,
+        [this](SyncedImages& images) { return convert(images); },
+        [this](InputPacket::Ptr& packet) {
+          if (packet) {
+            queue.push(packet);
+          }
+        }));
+  }
+
   // TODO(nathan) subscribe to image subsets
-  color_sub_ = ImageSubscriber(nh_, "rgb");
-  depth_sub_ = ImageSubscriber(nh_, "depth_registered", "image_rect");
-  label_sub_ = ImageSubscriber(nh_, "semantic");
+  color_sub_ = makeSubscriber(nh_, config.color_topic);
+  depth_sub_ = makeSubscriber(nh_, config.depth_topic);
+  label_sub_ = makeSubscriber(nh_, config.label_topic);
+  if (config.use_stamp_sync) {
+    stamp_sync_.reset(new StampSync(config.queue_size,
+                                    config.sync_tolerance_s * 1.0e9,
+                                    [this](const StampSync::Items& images) {
+                                      callback(images[0], images[1], images[2]);
+                                    }));
+
+    const std::array<ImageSubscriber*, 3> subs{&color_sub_, &depth_sub_, &label_sub_};
+    for (size_t i = 0; i < subs.size(); ++i) {
+      subs[i]->sub->registerCallback(
+          boost::function<void(const sensor_msgs::Image::ConstPtr&)>(
+              [this, i](const sensor_msgs::Image::ConstPtr& msg) {
+                stamp_sync_->add(i, msg->header.stamp.toNSec(), msg);
+              }));
+    }
+
+    return true;
+  }
+
   synchronizer_.reset(new Synchronizer(SyncPolicy(config.queue_size),
                                        *color_sub_.sub,
                                        *depth_sub_.sub,
@@ -84,7 +153,58 @@ bool ImageReceiver::initImpl() {
   return true;
 }
 
-ImageReceiver::~ImageReceiver() {}
+ImageReceiver::~ImageReceiver() {
+  if (callback_threads_) {
+    callback_threads_->stop();
+  }
+
+  if (conversion_pool_) {
+    conversion_pool_->finish();
+  }
+}
+
+cv::Mat ImageReceiver::getImage(const sensor_msgs::Image::ConstPtr& msg) const {
+  return toOwnedImage(cv_bridge::toCvShare(msg), pool_);
+}
+
+cv::Mat ImageReceiver::getDepth(const sensor_msgs::Image::ConstPtr& msg) const {
+  if (!normalizer_.config.normalize_depth) {
+    return getImage(msg);
+  }
+
+  // the conversion reads the message pixels directly instead of cloning them first
+  cv::Mat depth;
+  if (pool_) {
+    pool_->attach(depth);
+  }
+
+  if (!normalizer_.normalizeDepth(cv_bridge::toCvShare(msg)->image, depth)) {
+    LOG_FIRST_N(WARNING, 1) << "Unable to normalize depth with encoding '"
+                            << msg->encoding << "'";
+    return getImage(msg);
+  }
+
+  return depth;
+}
+
+cv::Mat ImageReceiver::getLabels(const sensor_msgs::Image::ConstPtr& msg) const {
+  if (!normalizer_.remapsLabels()) {
+    return getImage(msg);
+  }
+
+  cv::Mat labels;
+  if (pool_) {
+    pool_->attach(labels);
+  }
+
+  if (!normalizer_.remapLabels(cv_bridge::toCvShare(msg)->image, labels)) {
+    LOG_FIRST_N(WARNING, 1) << "Unable to remap labels with encoding '"
+                            << msg->encoding << "'";
+    return getImage(msg);
+  }
+
+  return labels;
+}
 
 std::string showImageDim(const sensor_msgs::Image::ConstPtr& image) {
   std::stringstream ss;
@@ -111,27 +231,38 @@ void ImageReceiver::callback(const sensor_msgs::Image::ConstPtr& color,
     return;
   }
 
+  LatencyTracer::instance().mark(color->header.stamp.toNSec(), "receive");
+  if (conversion_pool_) {
+    conversion_pool_->push({color, depth, labels});
+    return;
+  }
+
+  const auto packet = convert({color, depth, labels});
+  if (packet) {
+    queue.push(packet);
+  }
+}
+
+InputPacket::Ptr ImageReceiver::convert(const SyncedImages& images) const {
+  const auto& [color, depth, labels] = images;
   auto packet = std::make_shared<ImageInputPacket>(color->header.stamp.toNSec(), sensor_id_);
   try {
-    const auto cv_depth = cv_bridge::toCvShare(depth);
-    packet->depth = cv_depth->image.clone();
+    packet->depth = getDepth(depth);
     if (color && color->encoding == sensor_msgs::image_encodings::RGB8) {
-      auto cv_color = cv_bridge::toCvShare(color);
-      packet->color = cv_color->image.clone();
+      packet->color = getImage(color);
     } else if (color) {
       auto cv_color = cv_bridge::toCvCopy(color, sensor_msgs::image_encodings::RGB8);
       packet->color = cv_color->image;
     }
 
     if (labels) {
-      auto cv_labels = cv_bridge::toCvShare(labels);
-      packet->labels = cv_labels->image.clone();
+      packet->labels = getLabels(labels);
     }
   } catch (const cv_bridge::Exception& e) {
     LOG(ERROR) << "unable to read images from ros: " << e.what();
   }
 
-  queue.push(packet);
+  return packet;
 }
 
 }  // namespace hydra
@@ -0,0 +1,108 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/input_throttle.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+namespace hydra {
+
+void declare_config(InputThrottle::Config& config) {
+  using namespace config;
+  name("InputThrottle::Config");
+  field(config.enable, "enable");
+  field(config.target_latency_s, "target_latency_s", "s");
+  field(config.max_queue_size, "max_queue_size");
+  field(config.min_translation_m, "min_translation_m", "m");
+  field(config.min_rotation_rad, "min_rotation_rad", "rad");
+  field(config.max_consecutive_skips, "max_consecutive_skips");
+
+  check(config.target_latency_s, GT, 0.0, "target_latency_s");
+}
+
+InputThrottle::InputThrottle(const Config& config)
+    : config(config::checkValid(config)) {}
+
+bool InputThrottle::hasMoved(const Eigen::Vector3d& position,
+                             const Eigen::Quaterniond& rotation) const {
+  if (!last_position_) {
+    return true;
+  }
+
+  const double translation = (position - *last_position_).norm();
+  const double angle = last_rotation_.angularDistance(rotation);
+  return translation >= config.min_translation_m || angle >= config.min_rotation_rad;
+}
+
+InputThrottle::Decision InputThrottle::update(double latency_s,
+                                              size_t queue_size,
+                                              const Eigen::Vector3d& position,
+                                              const Eigen::Quaterniond& rotation) {
+  Decision decision = Decision::KEEP;
+  if (config.enable && consecutive_skips_ < config.max_consecutive_skips) {
+    const bool queue_full =
+        config.max_queue_size > 0 && queue_size >= config.max_queue_size;
+    const bool too_slow = latency_s > config.target_latency_s;
+    // frames that add new viewpoints are worth keeping unless we are far behind
+    const bool keep_motion =
+        hasMoved(position, rotation) && latency_s < 2.0 * config.target_latency_s;
+    if (too_slow && !keep_motion) {
+      decision = Decision::SKIP_LATENCY;
+    } else if (queue_full && !keep_motion) {
+      decision = Decision::SKIP_QUEUE;
+    }
+  }
+
+  switch (decision) {
+    case Decision::KEEP:
+      ++num_kept_;
+      consecutive_skips_ = 0;
+      last_position_ = position;
+      last_rotation_ = rotation;
+      break;
+    case Decision::SKIP_LATENCY:
+      ++num_skipped_latency_;
+      ++consecutive_skips_;
+      break;
+    case Decision::SKIP_QUEUE:
+      ++num_skipped_queue_;
+      ++consecutive_skips_;
+      break;
+  }
+
+  return decision;
+}
+
+}  // namespace hydra
@@ -34,8 +34,14 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_ros/input/pointcloud_adaptor.h"
 
+#include <config_utilities/config.h>
 #include <glog/logging.h>
 
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_set>
+
 namespace hydra {
 
 template <typename T>
@@ -237,18 +243,226 @@ uint32_t PointcloudAdaptor::label(const uint8_t* point_ptr) const {
   return label_parser_(point_ptr);
 }
 
+PointcloudLayout PointcloudLayout::fromCloud(const sensor_msgs::PointCloud2& cloud) {
+  PointcloudLayout layout;
+  if (cloud.is_bigendian) {
+    return layout;
+  }
+
+  std::optional<uint32_t> x_offset, y_offset, z_offset;
+  for (const auto& field : cloud.fields) {
+    const bool is_float = field.datatype == PointField::FLOAT32 && field.count <= 1;
+    if (field.name == "x" && is_float) {
+      x_offset = field.offset;
+    } else if (field.name == "y" && is_float) {
+      y_offset = field.offset;
+    } else if (field.name == "z" && is_float) {
+      z_offset = field.offset;
+    } else if (field.name == "rgb" || field.name == "rgba") {
+      if (field.datatype != PointField::FLOAT32 &&
+          field.datatype != PointField::UINT32) {
+        return layout;
+      }
+      layout.color_offset = field.offset;
+    } else if (field.name == "label" || field.name == "ring") {
+      if (field.datatype == PointField::FLOAT32 ||
+          field.datatype == PointField::FLOAT64) {
+        return layout;
+      }
+      layout.label_offset = field.offset;
+      layout.label_datatype = field.datatype;
+    }
+  }
+
+  if (!x_offset || !y_offset || !z_offset) {
+    return layout;
+  }
+
+  layout.xyz_offset = *x_offset;
+  layout.packed_xyz = *y_offset == *x_offset + sizeof(float) &&
+                      *z_offset == *y_offset + sizeof(float);
+  return layout;
+}
+
+namespace {
+
+bool sameFields(const std::vector<PointField>& lhs,
+                const std::vector<PointField>& rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    const auto& a = lhs[i];
+    const auto& b = rhs[i];
+    if (a.offset != b.offset || a.datatype != b.datatype || a.count != b.count ||
+        a.name != b.name) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+PointcloudLayout PointcloudLayout::cached(const sensor_msgs::PointCloud2& cloud) {
+  // one entry per thread, as every receiver parses its own stream on its own thread
+  thread_local std::optional<PointcloudLayout> layout;
+  thread_local bool is_bigendian = false;
+  thread_local std::vector<PointField> fields;
+  if (!layout || cloud.is_bigendian != is_bigendian ||
+      !sameFields(cloud.fields, fields)) {
+    layout = fromCloud(cloud);
+    is_bigendian = cloud.is_bigendian;
+    fields = cloud.fields;
+  }
+
+  return *layout;
+}
+
+namespace {
+
+// fixed-size batches keep the product vectorized without any temporary allocations
+inline constexpr int kTransformBatchSize = 64;
+
+void transformPoints(float* points, size_t num_points, const Eigen::Isometry3f& T) {
+  using Batch = Eigen::Matrix<float, 3, kTransformBatchSize>;
+  const Eigen::Matrix3f R = T.linear();
+  const Eigen::Vector3f t = T.translation();
+  size_t i = 0;
+  for (; i + kTransformBatchSize <= num_points; i += kTransformBatchSize) {
+    Eigen::Map<Batch> batch(points + 3 * i);
+    const Batch transformed = (R * batch).colwise() + t;
+    batch = transformed;
+  }
+
+  Eigen::Map<Eigen::Matrix3Xf> tail(points + 3 * i, 3, num_points - i);
+  for (Eigen::Index col = 0; col < tail.cols(); ++col) {
+    tail.col(col) = R * tail.col(col) + t;
+  }
+}
+
+template <typename LabelT, bool HasColor, bool HasLabel>
+void fillPacketKernel(const sensor_msgs::PointCloud2& msg,
+                      const PointcloudLayout& layout,
+                      CloudInputPacket& packet,
+                      const Eigen::Isometry3f* target_T_cloud) {
+  [[maybe_unused]] const uint32_t color_offset = HasColor ? *layout.color_offset : 0;
+  [[maybe_unused]] const uint32_t label_offset = HasLabel ? *layout.label_offset : 0;
+  for (uint32_t row = 0; row < msg.height; ++row) {
+    const uint8_t* point_ptr = msg.data.data() + row * msg.row_step;
+    auto points = packet.points.ptr<float>(row);
+    [[maybe_unused]] auto colors = packet.colors.ptr<uint8_t>(row);
+    [[maybe_unused]] auto labels = HasLabel ? packet.labels.ptr<int32_t>(row) : nullptr;
+    for (uint32_t col = 0; col < msg.width; ++col, point_ptr += msg.point_step) {
+      std::memcpy(points + 3 * col, point_ptr + layout.xyz_offset, 3 * sizeof(float));
+      if constexpr (HasColor) {
+        // clouds store colors as bgra
+        const uint8_t* bgra = point_ptr + color_offset;
+        colors[3 * col] = bgra[2];
+        colors[3 * col + 1] = bgra[1];
+        colors[3 * col + 2] = bgra[0];
+      }
+
+      if constexpr (HasLabel) {
+        LabelT label;
+        std::memcpy(&label, point_ptr + label_offset, sizeof(LabelT));
+        labels[col] = static_cast<uint32_t>(label);
+      }
+    }
+
+    if (target_T_cloud) {
+      transformPoints(points, msg.width, *target_T_cloud);
+    }
+  }
+}
+
+template <typename LabelT>
+void fillLabeledPacket(const sensor_msgs::PointCloud2& msg,
+                       const PointcloudLayout& layout,
+                       CloudInputPacket& packet,
+                       const Eigen::Isometry3f* T) {
+  if (layout.color_offset) {
+    fillPacketKernel<LabelT, true, true>(msg, layout, packet, T);
+  } else {
+    fillPacketKernel<LabelT, false, true>(msg, layout, packet, T);
+  }
+}
+
+bool fillPacketFromLayout(const sensor_msgs::PointCloud2& msg,
+                          const PointcloudLayout& layout,
+                          CloudInputPacket& packet,
+                          const Eigen::Isometry3f* T) {
+  if (!layout.label_offset) {
+    if (layout.color_offset) {
+      fillPacketKernel<uint8_t, true, false>(msg, layout, packet, T);
+    } else {
+      fillPacketKernel<uint8_t, false, false>(msg, layout, packet, T);
+    }
+    return true;
+  }
+
+  switch (layout.label_datatype) {
+    case PointField::INT8:
+      fillLabeledPacket<int8_t>(msg, layout, packet, T);
+      return true;
+    case PointField::UINT8:
+      fillLabeledPacket<uint8_t>(msg, layout, packet, T);
+      return true;
+    case PointField::INT16:
+      fillLabeledPacket<int16_t>(msg, layout, packet, T);
+      return true;
+    case PointField::UINT16:
+      fillLabeledPacket<uint16_t>(msg, layout, packet, T);
+      return true;
+    case PointField::INT32:
+      fillLabeledPacket<int32_t>(msg, layout, packet, T);
+      return true;
+    case PointField::UINT32:
+      fillLabeledPacket<uint32_t>(msg, layout, packet, T);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
 bool fillPointcloudPacket(const sensor_msgs::PointCloud2& msg,
                           CloudInputPacket& packet,
-                          bool labels_required) {
+                          bool labels_required,
+                          const Eigen::Isometry3f* target_T_cloud) {
+  const auto layout = PointcloudLayout::cached(msg);
+  if (layout.packed_xyz) {
+    if (!layout.label_offset && labels_required) {
+      return false;
+    }
+
+    // create() keeps any allocator the receiver attached to the packet
+    packet.points.create(msg.height, msg.width, CV_32FC3);
+    packet.colors.create(msg.height, msg.width, CV_8UC3);
+    packet.colors.setTo(cv::Scalar::all(0));
+    if (layout.label_offset) {
+      packet.labels.create(msg.height, msg.width, CV_32SC1);
+    }
+
+    if (fillPacketFromLayout(msg, layout, packet, target_T_cloud)) {
+      return true;
+    }
+
+    VLOG(10) << "falling back to generic pointcloud conversion";
+  }
+
   PointcloudAdaptor adaptor(msg);
   if (!adaptor.valid() || (!adaptor.hasLabels() && labels_required)) {
     return false;
   }
 
-  packet.points = cv::Mat(msg.height, msg.width, CV_32FC3);
-  packet.colors = cv::Mat(msg.height, msg.width, CV_8UC3);
+  packet.points.create(msg.height, msg.width, CV_32FC3);
+  packet.colors.create(msg.height, msg.width, CV_8UC3);
   if (adaptor.hasLabels()) {
-    packet.labels = cv::Mat(msg.height, msg.width, CV_32SC1);
+    packet.labels.create(msg.height, msg.width, CV_32SC1);
   }
 
   for (uint32_t row = 0; row < msg.height; ++row) {
@@ -261,8 +475,234 @@ bool fillPointcloudPacket(const sensor_msgs::PointCloud2& msg,
         packet.labels.at<int32_t>(row, col) = adaptor.label(point_ptr);
       }
     }
+
+    if (target_T_cloud) {
+      transformPoints(packet.points.ptr<float>(row), msg.width, *target_T_cloud);
+    }
+  }
+
+  return true;
+}
+
+void declare_config(PointcloudFilter& config) {
+  using namespace config;
+  name("PointcloudFilter");
+  field(config.min_range, "min_range", "m");
+  field(config.max_range, "max_range", "m");
+  field(config.voxel_size, "voxel_size", "m");
+  field(config.compact, "compact");
+}
+
+namespace {
+
+template <typename T>
+uint32_t readLabel(const uint8_t* label_ptr) {
+  T value;
+  std::memcpy(&value, label_ptr, sizeof(T));
+  return static_cast<uint32_t>(value);
+}
+
+using LabelReader = uint32_t (*)(const uint8_t*);
+
+LabelReader getLabelReader(uint8_t datatype) {
+  switch (datatype) {
+    case PointField::INT8:
+      return &readLabel<int8_t>;
+    case PointField::UINT8:
+      return &readLabel<uint8_t>;
+    case PointField::INT16:
+      return &readLabel<int16_t>;
+    case PointField::UINT16:
+      return &readLabel<uint16_t>;
+    case PointField::INT32:
+      return &readLabel<int32_t>;
+    case PointField::UINT32:
+      return &readLabel<uint32_t>;
+    default:
+      return nullptr;
+  }
+}
+
+class PointFilter {
+ public:
+  PointFilter(const PointcloudFilter& filter, size_t num_points)
+      : min_range_sq_(filter.min_range * filter.min_range),
+        max_range_sq_(filter.max_range > 0.0 ? filter.max_range * filter.max_range
+                                             : std::numeric_limits<double>::infinity()),
+        voxel_scale_(filter.voxel_size > 0.0 ? 1.0 / filter.voxel_size : 0.0),
+        drop_zero_(filter.compact) {
+    if (voxel_scale_ > 0.0) {
+      voxels_.reserve(num_points / 4);
+    }
   }
 
+  bool accept(const float* xyz) {
+    if (!std::isfinite(xyz[0]) || !std::isfinite(xyz[1]) || !std::isfinite(xyz[2])) {
+      return false;
+    }
+
+    const double range_sq = static_cast<double>(xyz[0]) * xyz[0] +
+                            static_cast<double>(xyz[1]) * xyz[1] +
+                            static_cast<double>(xyz[2]) * xyz[2];
+    if (range_sq < min_range_sq_ || range_sq > max_range_sq_) {
+      return false;
+    }
+
+    // sensors report missing returns as points at the origin
+    if (drop_zero_ && range_sq == 0.0) {
+      return false;
+    }
+
+    if (voxel_scale_ <= 0.0) {
+      return true;
+    }
+
+    // 21 bits per axis covers +/- 1e6 voxels, which is plenty for a single scan
+    uint64_t key = 0;
+    for (int i = 0; i < 3; ++i) {
+      const auto index = static_cast<int64_t>(std::floor(xyz[i] * voxel_scale_));
+      key |= (static_cast<uint64_t>(index) & 0x1FFFFF) << (21 * i);
+    }
+
+    return voxels_.insert(key).second;
+  }
+
+ private:
+  const double min_range_sq_;
+  const double max_range_sq_;
+  const double voxel_scale_;
+  const bool drop_zero_;
+  std::unordered_set<uint64_t> voxels_;
+};
+
+// Parser fills xyz, rgb and label (if requested) for one point
+template <typename Parser>
+void filterPoints(const sensor_msgs::PointCloud2& msg,
+                  const PointcloudFilter& filter,
+                  bool has_labels,
+                  const Parser& parser,
+                  CloudInputPacket& packet,
+                  const Eigen::Isometry3f* target_T_cloud,
+                  std::vector<uint32_t>* source_indices) {
+  const size_t num_points = msg.width * msg.height;
+  // scratch space keeps its capacity between clouds parsed on the same thread
+  thread_local std::vector<float> points;
+  thread_local std::vector<uint8_t> colors;
+  thread_local std::vector<int32_t> labels;
+  points.clear();
+  colors.clear();
+  labels.clear();
+  points.reserve(3 * num_points);
+  colors.reserve(3 * num_points);
+  if (has_labels) {
+    labels.reserve(num_points);
+  }
+
+  if (source_indices) {
+    source_indices->clear();
+    source_indices->reserve(num_points);
+  }
+
+  PointFilter point_filter(filter, num_points);
+  float xyz[3];
+  uint8_t rgb[3];
+  int32_t label = 0;
+  for (uint32_t row = 0; row < msg.height; ++row) {
+    const uint8_t* point_ptr = msg.data.data() + row * msg.row_step;
+    for (uint32_t col = 0; col < msg.width; ++col, point_ptr += msg.point_step) {
+      parser(point_ptr, xyz, rgb, label);
+      if (!point_filter.accept(xyz)) {
+        continue;
+      }
+
+      points.insert(points.end(), xyz, xyz + 3);
+      colors.insert(colors.end(), rgb, rgb + 3);
+      if (has_labels) {
+        labels.push_back(label);
+      }
+
+      if (source_indices) {
+        source_indices->push_back(row * msg.width + col);
+      }
+    }
+  }
+
+  const int num_kept = points.size() / 3;
+  if (target_T_cloud) {
+    transformPoints(points.data(), num_kept, *target_T_cloud);
+  }
+
+  packet.points.create(1, num_kept, CV_32FC3);
+  packet.colors.create(1, num_kept, CV_8UC3);
+  std::memcpy(
+      packet.points.ptr<float>(0), points.data(), points.size() * sizeof(float));
+  std::memcpy(packet.colors.ptr<uint8_t>(0), colors.data(), colors.size());
+  if (has_labels) {
+    packet.labels.create(1, num_kept, CV_32SC1);
+    std::memcpy(
+        packet.labels.ptr<int32_t>(0), labels.data(), labels.size() * sizeof(int32_t));
+  }
+}
+
+}  // namespace
+
+bool fillFilteredPointcloudPacket(const sensor_msgs::PointCloud2& msg,
+                                  CloudInputPacket& packet,
+                                  const PointcloudFilter& filter,
+                                  bool labels_required,
+                                  const Eigen::Isometry3f* target_T_cloud,
+                                  std::vector<uint32_t>* source_indices) {
+  const auto layout = PointcloudLayout::cached(msg);
+  const LabelReader label_reader =
+      layout.label_offset ? getLabelReader(layout.label_datatype) : nullptr;
+  if (layout.packed_xyz && (label_reader || !layout.label_offset)) {
+    if (!label_reader && labels_required) {
+      return false;
+    }
+
+    const auto parser = [&](const uint8_t* ptr, float* xyz, uint8_t* rgb, int32_t& l) {
+      std::memcpy(xyz, ptr + layout.xyz_offset, 3 * sizeof(float));
+      if (layout.color_offset) {
+        // clouds store colors as bgra
+        const uint8_t* bgra = ptr + *layout.color_offset;
+        rgb[0] = bgra[2];
+        rgb[1] = bgra[1];
+        rgb[2] = bgra[0];
+      } else {
+        rgb[0] = rgb[1] = rgb[2] = 0;
+      }
+
+      if (label_reader) {
+        l = label_reader(ptr + *layout.label_offset);
+      }
+    };
+
+    const bool has_labels = label_reader != nullptr;
+    filterPoints(
+        msg, filter, has_labels, parser, packet, target_T_cloud, source_indices);
+    return true;
+  }
+
+  PointcloudAdaptor adaptor(msg);
+  if (!adaptor.valid() || (!adaptor.hasLabels() && labels_required)) {
+    return false;
+  }
+
+  const bool has_labels = adaptor.hasLabels();
+  const auto parser = [&](const uint8_t* ptr, float* xyz, uint8_t* rgb, int32_t& l) {
+    const auto pos = adaptor.position(ptr);
+    const auto color = adaptor.color(ptr);
+    for (int i = 0; i < 3; ++i) {
+      xyz[i] = pos[i];
+      rgb[i] = color[i];
+    }
+
+    if (has_labels) {
+      l = adaptor.label(ptr);
+    }
+  };
+
+  filterPoints(msg, filter, has_labels, parser, packet, target_T_cloud, source_indices);
   return true;
 }
 
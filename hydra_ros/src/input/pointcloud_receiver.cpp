@@ -1,19 +1,52 @@
 #include "hydra_ros/input/pointcloud_receiver.h"
 
+#include <config_utilities/config.h>
 #include <glog/logging.h>
 #include <hydra/common/common.h>
 #include <hydra/common/global_info.h>
 
 #include "hydra_ros/input/pointcloud_adaptor.h"
+#include "hydra_ros/utils/latency_tracer.h"
+#include "hydra_ros/utils/lookup_tf.h"
+#include "hydra_ros/utils/metrics.h"
 
 namespace hydra {
 
+void declare_config(PointcloudReceiver::Config& config) {
+  using namespace config;
+  name("PointcloudReceiver::Config");
+  base<DataReceiver::Config>(config);
+  field(config.ns, "ns");
+  field(config.queue_size, "queue_size");
+  field(config.num_callback_threads, "num_callback_threads");
+  field(config.buffer_pool_size, "buffer_pool_size");
+  field(config.filter, "filter");
+  field(config.sensor_frame, "sensor_frame");
+}
+
 PointcloudReceiver::PointcloudReceiver(const Config& config, size_t sensor_id)
-    : DataReceiver(config, sensor_id), nh_(config.ns) {}
+    : DataReceiver(config, sensor_id), config(config), nh_(config.ns) {
+  if (config.buffer_pool_size > 0) {
+    pool_ = MatPool::create(config.buffer_pool_size);
+  }
+
+  if (!config.sensor_frame.empty()) {
+    tf_buffer_.reset(new tf2_ros::Buffer());
+    tf_listener_.reset(new tf2_ros::TransformListener(*tf_buffer_));
+  }
+}
 
-PointcloudReceiver::~PointcloudReceiver() {}
+PointcloudReceiver::~PointcloudReceiver() {
+  if (callback_threads_) {
+    callback_threads_->stop();
+  }
+}
 
 bool PointcloudReceiver::initImpl() {
+  if (config.num_callback_threads > 0) {
+    callback_threads_.reset(new CallbackThreads(nh_, config.num_callback_threads));
+  }
+
   cloud_sub_ = nh_.subscribe(
       "pointcloud", config.queue_size, &PointcloudReceiver::callback, this);
   return true;
@@ -28,12 +61,80 @@ void PointcloudReceiver::callback(const sensor_msgs::PointCloud2& msg) {
     return;
   }
 
+  LatencyTracer::instance().mark(timestamp_ns, "receive");
+
   auto packet = std::make_shared<CloudInputPacket>(timestamp_ns, sensor_id_);
-  fillPointcloudPacket(msg, *packet, false);
   // TODO(nathan) this is brittle, but at least handles kitti
   packet->in_world_frame =
       msg.header.frame_id == GlobalInfo::instance().getFrames().odom;
+
+  // world frame clouds are handled by the input module instead
+  bool have_extrinsics = true;
+  const Eigen::Isometry3f* sensor_T_cloud = nullptr;
+  if (!packet->in_world_frame) {
+    sensor_T_cloud = getExtrinsics(msg.header.frame_id, have_extrinsics);
+  }
+
+  if (!have_extrinsics) {
+    LOG_FIRST_N(WARNING, 5) << "Dropping cloud: no transform from '"
+                            << msg.header.frame_id << "' to '" << config.sensor_frame
+                            << "'";
+    MetricsRegistry::instance().addCount("input/dropped_clouds");
+    return;
+  }
+
+  if (pool_) {
+    // the buffers go back to the pool when the packet is dropped after integration
+    pool_->attach(packet->points);
+    pool_->attach(packet->colors);
+    pool_->attach(packet->labels);
+  }
+
+  if (!config.filter.enabled()) {
+    fillPointcloudPacket(msg, *packet, false, sensor_T_cloud);
+  } else {
+    // ranges are relative to the cloud origin, which is not the sensor for world clouds
+    auto filter = config.filter;
+    if (packet->in_world_frame) {
+      filter.min_range = 0.0;
+      filter.max_range = -1.0;
+      filter.compact = false;
+    }
+
+    fillFilteredPointcloudPacket(msg, *packet, filter, false, sensor_T_cloud);
+    VLOG(10) << "[Hydra Reconstruction] Kept " << packet->points.cols << " / "
+             << msg.width * msg.height << " points";
+  }
+
   queue.push(packet);
 }
 
+const Eigen::Isometry3f* PointcloudReceiver::getExtrinsics(const std::string& frame_id,
+                                                           bool& valid) {
+  valid = true;
+  if (!tf_buffer_ || frame_id == config.sensor_frame) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(extrinsics_mutex_);
+  // extrinsics are static, so each frame is only looked up until it is found once
+  auto iter = extrinsics_.find(frame_id);
+  if (iter != extrinsics_.end()) {
+    return &iter->second;
+  }
+
+  const auto pose =
+      lookupTransform(*tf_buffer_, std::nullopt, config.sensor_frame, frame_id, 1);
+  if (!pose) {
+    valid = false;
+    return nullptr;
+  }
+
+  Eigen::Isometry3f sensor_T_cloud = Eigen::Isometry3f::Identity();
+  sensor_T_cloud.linear() = pose.target_R_source.toRotationMatrix().cast<float>();
+  sensor_T_cloud.translation() = pose.target_p_source.cast<float>();
+  iter = extrinsics_.emplace(frame_id, sensor_T_cloud).first;
+  return &iter->second;
+}
+
 }  // namespace hydra
@@ -38,8 +38,12 @@
 #include <config_utilities/printing.h>
 #include <config_utilities/validation.h>
 #include <hydra/common/global_info.h>
+#include <hydra/utils/timing_utilities.h>
+#include <tf2_eigen/tf2_eigen.h>
 
+#include "hydra_ros/utils/latency_tracer.h"
 #include "hydra_ros/utils/lookup_tf.h"
+#include "hydra_ros/utils/metrics.h"
 
 namespace hydra {
 
@@ -53,18 +57,53 @@ void declare_config(RosInputModule::Config& config) {
   field(config.tf_buffer_size_s, "tf_buffer_size_s");
   field(config.tf_max_tries, "tf_max_tries");
   field(config.tf_verbosity, "tf_verbosity");
+  field(config.tf_use_callbacks, "tf_use_callbacks");
+  field(config.tf_max_age_s, "tf_max_age_s", "s");
+  field(config.odometry_topic, "odometry_topic");
+  field(config.odometry_buffer_size, "odometry_buffer_size");
+  field(config.throttle, "throttle");
+  check(config.odometry_buffer_size, GT, 0u, "odometry_buffer_size");
 }
 
 RosInputModule::RosInputModule(const Config& config, const OutputQueue::Ptr& queue)
     : InputModule(config, queue),
       config(config),
       nh_(ros::NodeHandle(config.ns)),
-      have_first_pose_(false) {
-  buffer_.reset(new tf2_ros::Buffer(ros::Duration(config.tf_buffer_size_s)));
-  tf_listener_.reset(new tf2_ros::TransformListener(*buffer_));
+      output_queue_(queue),
+      throttle_(config.throttle),
+      have_first_pose_(false),
+      checked_odometry_frames_(false) {
+  if (config.odometry_topic.empty()) {
+    buffer_.reset(new tf2_ros::Buffer(ros::Duration(config.tf_buffer_size_s)));
+    tf_listener_.reset(new tf2_ros::TransformListener(*buffer_));
+    // every frame keeps up to tf_buffer_size_s worth of transforms
+    MetricsRegistry::instance().registerGauge("memory/tf_frames", [this]() {
+      std::vector<std::string> frames;
+      buffer_->_getFrameStrings(frames);
+      return static_cast<double>(frames.size());
+    });
+    return;
+  }
+
+  // odometry gets its own queue so samples arrive while the input thread waits
+  odometry_buffer_.reset(new OdometryPoseBuffer(config.odometry_buffer_size));
+  odometry_nh_ = ros::NodeHandle(nh_, "");
+  odometry_threads_.reset(new CallbackThreads(odometry_nh_, 1));
+  odometry_sub_ = odometry_nh_.subscribe(
+      config.odometry_topic, 100, &RosInputModule::handleOdometry, this);
+  MetricsRegistry::instance().registerGauge("memory/odometry_poses", [this]() {
+    return static_cast<double>(odometry_buffer_->size());
+  });
 }
 
-RosInputModule::~RosInputModule() = default;
+RosInputModule::~RosInputModule() {
+  auto& metrics = MetricsRegistry::instance();
+  metrics.removeGauge("memory/tf_frames");
+  metrics.removeGauge("memory/odometry_poses");
+  if (odometry_threads_) {
+    odometry_threads_->stop();
+  }
+}
 
 std::string RosInputModule::printInfo() const {
   std::stringstream ss;
@@ -73,33 +112,182 @@ std::string RosInputModule::printInfo() const {
 }
 
 PoseStatus RosInputModule::getBodyPose(uint64_t timestamp_ns) {
+  const auto pose_status = lookupBodyPose(timestamp_ns);
+  if (!pose_status) {
+    return pose_status;
+  }
+
+  if (shouldSkip(timestamp_ns, pose_status)) {
+    return skipInput(timestamp_ns);
+  }
+
+  LatencyTracer::instance().mark(timestamp_ns, "pose");
+  return pose_status;
+}
+
+PoseStatus RosInputModule::skipInput(uint64_t timestamp_ns) {
+  // InputModule only drops packets without a pose, so a skipped packet is handed
+  // back without one. The pose was found, so it does not count as a pose failure
+  // and does not affect have_first_pose_ or clearing the queues
+  LatencyTracer::instance().mark(timestamp_ns, "skipped");
+  PoseStatus skipped;
+  skipped.is_valid = false;
+  return skipped;
+}
+
+bool RosInputModule::shouldSkip(uint64_t timestamp_ns, const PoseStatus& pose) {
+  if (!throttle_.config.enable) {
+    return false;
+  }
+
+  ros::Time stamp;
+  stamp.fromNSec(timestamp_ns);
+  const double latency_s = (ros::Time::now() - stamp).toSec();
+  const size_t queue_size = output_queue_ ? output_queue_->size() : 0;
+  const auto decision = throttle_.update(
+      latency_s, queue_size, pose.target_p_source, pose.target_R_source);
+  switch (decision) {
+    case InputThrottle::Decision::SKIP_LATENCY:
+      MetricsRegistry::instance().addCount("input/skipped_latency");
+      VLOG(2) << "Skipping input @ " << timestamp_ns << " [ns]: latency of "
+              << latency_s << " [s]";
+      return true;
+    case InputThrottle::Decision::SKIP_QUEUE:
+      MetricsRegistry::instance().addCount("input/skipped_queue");
+      VLOG(2) << "Skipping input @ " << timestamp_ns << " [ns]: " << queue_size
+              << " packets queued";
+      return true;
+    case InputThrottle::Decision::KEEP:
+    default:
+      return false;
+  }
+}
+
+PoseStatus RosInputModule::lookupBodyPose(uint64_t timestamp_ns) {
   // negative or 0 for tf_max_tries means we spin forever if the transform isn't present
   const std::optional<size_t> max_tries =
       config.tf_max_tries > 0 ? std::optional<size_t>(config.tf_max_tries)
                               : std::nullopt;
 
+  if (odometry_buffer_) {
+    return getOdometryPose(timestamp_ns, max_tries);
+  }
+
   ros::Time curr_ros_time;
   curr_ros_time.fromNSec(timestamp_ns);
-  const auto pose_status = lookupTransform(*buffer_,
-                                           curr_ros_time,
-                                           GlobalInfo::instance().getFrames().odom,
-                                           GlobalInfo::instance().getFrames().robot,
-                                           max_tries,
-                                           config.tf_wait_duration_s,
-                                           config.tf_verbosity);
+  const auto& frames = GlobalInfo::instance().getFrames();
+
+  PoseStatus pose_status;
+  {  // tracks how long each packet waits for its pose
+    LatencyTimer timer("input/pose_wait", timestamp_ns);
+    if (config.tf_use_callbacks) {
+      const std::optional<double> timeout_s =
+          max_tries ? std::optional<double>(*max_tries * config.tf_wait_duration_s)
+                    : std::nullopt;
+      const std::optional<double> max_age_s =
+          config.tf_max_age_s > 0.0 ? std::optional<double>(config.tf_max_age_s)
+                                    : std::nullopt;
+      pose_status = waitForTransform(*buffer_,
+                                     curr_ros_time,
+                                     frames.odom,
+                                     frames.robot,
+                                     timeout_s,
+                                     config.tf_verbosity,
+                                     max_age_s);
+    } else {
+      pose_status = lookupTransform(*buffer_,
+                                    curr_ros_time,
+                                    frames.odom,
+                                    frames.robot,
+                                    max_tries,
+                                    config.tf_wait_duration_s,
+                                    config.tf_verbosity);
+    }
+  }
 
   if (pose_status && !have_first_pose_) {
     have_first_pose_ = true;
   }
 
+  auto& metrics = MetricsRegistry::instance();
+  if (!pose_status) {
+    metrics.addCount("input/pose_failures");
+  }
+
   if (!pose_status && !have_first_pose_ && config.clear_queue_on_fail) {
     LOG(WARNING) << "Clearing input queues while pose is unavailable";
+    size_t num_dropped = 0;
     for (auto& receiver : receivers_) {
+      num_dropped += receiver->queue.size();
       receiver->queue.clear();
     }
+
+    metrics.addCount("input/dropped_packets", num_dropped);
+  }
+
+  size_t num_queued = 0;
+  for (const auto& receiver : receivers_) {
+    num_queued += receiver->queue.size();
+  }
+
+  metrics.setGauge("input/queued_packets", num_queued);
+
+  return pose_status;
+}
+
+PoseStatus RosInputModule::getOdometryPose(uint64_t timestamp_ns,
+                                           const std::optional<size_t>& max_tries) {
+  LatencyTimer timer("input/pose_wait", timestamp_ns);
+  std::optional<OdometryPoseBuffer::Pose> pose;
+  size_t attempt_number = 0;
+  while (ros::ok() && !pose) {
+    if (max_tries && attempt_number >= *max_tries) {
+      break;
+    }
+
+    if (odometry_buffer_->isTooOld(timestamp_ns)) {
+      break;
+    }
+
+    pose = odometry_buffer_->waitForPose(timestamp_ns, config.tf_wait_duration_s);
+    ++attempt_number;
+  }
+
+  if (!pose) {
+    MetricsRegistry::instance().addCount("input/pose_failures");
+    LOG(ERROR) << "Failed to find odometry pose @ " << timestamp_ns << " [ns] on "
+               << odometry_sub_.getTopic();
+    return {false, {}, {}};
   }
 
+  PoseStatus pose_status;
+  pose_status.is_valid = true;
+  pose_status.target_p_source = pose->position;
+  pose_status.target_R_source = pose->rotation;
   return pose_status;
 }
 
+void RosInputModule::handleOdometry(const nav_msgs::Odometry& msg) {
+  if (!checked_odometry_frames_) {
+    const auto& frames = GlobalInfo::instance().getFrames();
+    LOG_IF(WARNING, msg.header.frame_id != frames.odom)
+        << "Odometry frame '" << msg.header.frame_id << "' does not match odom frame '"
+        << frames.odom << "'";
+    LOG_IF(WARNING, msg.child_frame_id != frames.robot)
+        << "Odometry child frame '" << msg.child_frame_id
+        << "' does not match robot frame '" << frames.robot << "'";
+    checked_odometry_frames_ = true;
+  }
+
+  Eigen::Vector3d position;
+  Eigen::Quaterniond rotation;
+  tf2::convert(msg.pose.pose.position, position);
+  tf2::convert(msg.pose.pose.orientation, rotation);
+  const auto stamp_ns = msg.header.stamp.toNSec();
+  if (!odometry_buffer_->add(stamp_ns, position, rotation.normalized())) {
+    VLOG(config.tf_verbosity) << "Dropping out-of-order odometry @ " << stamp_ns
+                              << " [ns]";
+  }
+}
+
 }  // namespace hydra
@@ -41,10 +41,10 @@
 #include <config_utilities/validation.h>
 #include <glog/logging.h>
 #include <hydra/common/global_info.h>
-#include <rosbag/bag.h>
-#include <rosbag/view.h>
 #include <sensor_msgs/CameraInfo.h>
 
+#include "hydra_ros/input/sensor_prefetcher.h"
+#include "hydra_ros/utils/bag_metadata.h"
 #include "hydra_ros/utils/lookup_tf.h"
 #include "hydra_ros/utils/pose_cache.h"
 
@@ -73,11 +73,15 @@ void fillConfigFromInfo(const sensor_msgs::CameraInfo& msg,
 RosSensorExtrinsics::RosSensorExtrinsics(const RosSensorExtrinsics::Config& config)
     : SensorExtrinsics() {
   config::checkValid(config);
-  const auto pose_status =
-      lookupTransform(GlobalInfo::instance().getFrames().robot, config.sensor_frame);
-  CHECK(pose_status.is_valid) << "Could not look up extrinsics from ros!";
-  body_R_sensor = pose_status.target_R_source;
-  body_p_sensor = pose_status.target_p_source;
+  auto pose_status = SensorPrefetcher::instance().getExtrinsics(config.sensor_frame);
+  if (!pose_status) {
+    pose_status =
+        lookupTransform(GlobalInfo::instance().getFrames().robot, config.sensor_frame);
+  }
+
+  CHECK(pose_status->is_valid) << "Could not look up extrinsics from ros!";
+  body_R_sensor = pose_status->target_R_source;
+  body_p_sensor = pose_status->target_p_source;
   VLOG(5) << "body_R_sensor: {w: " << body_R_sensor.w() << ", x: " << body_R_sensor.x()
           << ", y: " << body_R_sensor.y() << ", z: " << body_R_sensor.z() << "}";
   VLOG(5) << "body_p_sensor: [" << body_p_sensor.x() << ", " << body_p_sensor.y()
@@ -89,6 +93,7 @@ RosbagExtrinsics::RosbagExtrinsics(const RosbagExtrinsics::Config& config)
   config::checkValid(config);
   PoseCache::Config cache_config;
   cache_config.bag_path = config.bag_path;
+  cache_config.metadata_cache_dir = config.metadata_cache_dir;
   cache_config.static_only = true;
   PoseCache cache(cache_config);
 
@@ -125,34 +130,37 @@ RosIntrinsicsRegistration::RosIntrinsicsRegistration(const std::string& name) {
 
 Camera::Config RosCameraIntrinsics::makeCameraConfig(const YAML::Node& data,
                                                      const Config& config) {
-  sensor_msgs::CameraInfo::ConstPtr msg;
-
   ros::NodeHandle nh("~");
   const auto resolved_topic = nh.resolveName(config.topic);
-  CameraInfoFunctor functor;
-  ros::Subscriber sub =
-      nh.subscribe(config.topic, 1, &CameraInfoFunctor::callback, &functor);
-
-  LOG(INFO) << "Waiting for CameraInfo on " << resolved_topic
-            << " to initialize sensor model";
-  ros::WallRate r(10);
-  while (ros::ok()) {
-    if (functor.msg) {
-      break;
+  auto msg = SensorPrefetcher::instance().getCameraInfo(resolved_topic);
+  if (!msg) {
+    CameraInfoFunctor functor;
+    ros::Subscriber sub =
+        nh.subscribe(config.topic, 1, &CameraInfoFunctor::callback, &functor);
+
+    LOG(INFO) << "Waiting for CameraInfo on " << resolved_topic
+              << " to initialize sensor model";
+    ros::WallRate r(10);
+    while (ros::ok()) {
+      if (functor.msg) {
+        break;
+      }
+
+      ros::spinOnce();
+      r.sleep();
     }
 
-    ros::spinOnce();
-    r.sleep();
+    msg = functor.msg;
   }
 
-  if (!functor.msg) {
+  if (!*msg) {
     LOG(ERROR) << "did not receive message on " << resolved_topic;
     return {};
   }
 
   Camera::Config cam_config;
   config::internal::Visitor::setValues(static_cast<Sensor::Config&>(cam_config), data);
-  fillConfigFromInfo(*functor.msg, cam_config);
+  fillConfigFromInfo(**msg, cam_config);
   LOG(INFO) << "Initialized camera as " << std::endl << config::toString(cam_config);
   return cam_config;
 }
@@ -161,34 +169,18 @@ Camera::Config RosbagCameraIntrinsics::makeCameraConfig(const YAML::Node& data,
                                                         const Config& config) {
   LOG(INFO) << "Loading camera intrinsics from " << config.bag_path;
 
-  rosbag::Bag bag;
-  bag.open(config.bag_path, rosbag::bagmode::Read);
-  rosbag::View view(bag, rosbag::TopicQuery(std::vector<std::string>{config.topic}));
-
   Camera::Config cam_config;
-  for (const auto& m : view) {
-    const auto msg = m.instantiate<sensor_msgs::CameraInfo>();
-    if (!msg) {
-      LOG(ERROR) << "Topic '" << config.topic << "' is invalid!";
-      break;
-    }
-
-    config::internal::Visitor::setValues(static_cast<Sensor::Config&>(cam_config),
-                                         data);
-    cam_config.width = msg->width;
-    cam_config.height = msg->height;
-    cam_config.cx = msg->K[2];
-    cam_config.cy = msg->K[5];
-    cam_config.fx = msg->K[0];
-    cam_config.fy = msg->K[4];
-    LOG(INFO) << "Initialized Camera Info as " << std::endl
-              << config::toString(cam_config);
+  const auto metadata = BagMetadata::get(config.bag_path, config.metadata_cache_dir);
+  const auto msg = metadata->cameraInfo(config.topic);
+  if (!msg) {
+    LOG(ERROR) << "Failed to find topic '" << config.topic << "' in bag!'";
     return cam_config;
   }
 
-  bag.close();
-
-  LOG(ERROR) << "Failed to find topic '" << config.topic << "' in bag!'";
+  config::internal::Visitor::setValues(static_cast<Sensor::Config&>(cam_config), data);
+  fillConfigFromInfo(*msg, cam_config);
+  LOG(INFO) << "Initialized Camera Info as " << std::endl
+            << config::toString(cam_config);
   return cam_config;
 }
 
@@ -204,6 +196,7 @@ void declare_config(RosbagExtrinsics::Config& config) {
   name("RosbagExtrinsics::Config");
   field(config.sensor_frame, "sensor_frame");
   field<Path>(config.bag_path, "bag_path");
+  field<Path>(config.metadata_cache_dir, "metadata_cache_dir");
   checkCondition(!config.sensor_frame.empty(), "sensor frame required");
   check<Path::Exists>(config.bag_path, "bag_path");
 }
@@ -222,6 +215,7 @@ void declare_config(RosbagCameraIntrinsics::Config& config) {
   base<Sensor::Config>(config);
   field(config.topic, "camera_info_topic");
   field<Path>(config.bag_path, "bag_path");
+  field<Path>(config.metadata_cache_dir, "metadata_cache_dir");
   checkCondition(!config.topic.empty(), "camera info topic required");
   check<Path::Exists>(config.bag_path, "bag_path");
 }
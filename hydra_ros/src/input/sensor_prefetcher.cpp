@@ -0,0 +1,271 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/input/sensor_prefetcher.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+#include <hydra/common/global_info.h>
+
+#include <algorithm>
+#include <set>
+
+#include "hydra_ros/utils/lookup_tf.h"
+
+namespace hydra {
+
+namespace {
+
+struct SensorRequests {
+  std::set<std::string> info_topics;
+  std::set<std::string> sensor_frames;
+};
+
+std::string getString(XmlRpc::XmlRpcValue& value, const std::string& key) {
+  if (!value.hasMember(key)) {
+    return "";
+  }
+
+  auto& child = value[key];
+  if (child.getType() != XmlRpc::XmlRpcValue::TypeString) {
+    return "";
+  }
+
+  return static_cast<std::string>(child);
+}
+
+void addSensor(XmlRpc::XmlRpcValue& receiver, SensorRequests& requests) {
+  if (receiver.getType() != XmlRpc::XmlRpcValue::TypeStruct ||
+      !receiver.hasMember("sensor")) {
+    return;
+  }
+
+  auto& sensor = receiver["sensor"];
+  if (sensor.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+    return;
+  }
+
+  if (getString(sensor, "type") == "camera_info") {
+    const auto topic = getString(sensor, "camera_info_topic");
+    if (!topic.empty()) {
+      requests.info_topics.insert(topic);
+    }
+  }
+
+  if (!sensor.hasMember("extrinsics")) {
+    return;
+  }
+
+  auto& extrinsics = sensor["extrinsics"];
+  if (extrinsics.getType() == XmlRpc::XmlRpcValue::TypeStruct &&
+      getString(extrinsics, "type") == "ros") {
+    const auto frame = getString(extrinsics, "sensor_frame");
+    if (!frame.empty()) {
+      requests.sensor_frames.insert(frame);
+    }
+  }
+}
+
+void collectRequests(XmlRpc::XmlRpcValue& receivers, SensorRequests& requests) {
+  if (receivers.getType() == XmlRpc::XmlRpcValue::TypeArray) {
+    for (int i = 0; i < receivers.size(); ++i) {
+      addSensor(receivers[i], requests);
+    }
+  } else if (receivers.getType() == XmlRpc::XmlRpcValue::TypeStruct) {
+    for (auto& [name, receiver] : receivers) {
+      addSensor(receiver, requests);
+    }
+  }
+}
+
+}  // namespace
+
+void declare_config(SensorPrefetcher::Config& config) {
+  using namespace config;
+  name("SensorPrefetcher::Config");
+  field(config.enable, "enable");
+  field(config.timeout_s, "timeout_s", "s");
+  check(config.timeout_s, GT, 0.0, "timeout_s");
+}
+
+SensorPrefetcher& SensorPrefetcher::instance() {
+  static SensorPrefetcher prefetcher;
+  return prefetcher;
+}
+
+void SensorPrefetcher::start(const Config& config, const ros::NodeHandle& nh) {
+  config::checkValid(config);
+  stop();
+  if (!config.enable) {
+    return;
+  }
+
+  // only the receiver sensors are built with the input module
+  XmlRpc::XmlRpcValue receivers;
+  if (!nh.getParam("receivers", receivers)) {
+    return;
+  }
+
+  SensorRequests requests;
+  collectRequests(receivers, requests);
+  if (requests.info_topics.empty() && requests.sensor_frames.empty()) {
+    return;
+  }
+
+  LOG(INFO) << "Prefetching " << requests.info_topics.size() << " camera info topic(s) "
+            << "and " << requests.sensor_frames.size() << " sensor transform(s)";
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  deadline_ = std::chrono::steady_clock::now() +
+              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(config.timeout_s));
+
+  // topics are resolved the same way as the camera_info intrinsics
+  nh_ = ros::NodeHandle("~");
+  threads_.reset(new CallbackThreads(nh_, 1));
+  for (const auto& topic : requests.info_topics) {
+    const auto resolved = nh_.resolveName(topic);
+    const boost::function<void(const sensor_msgs::CameraInfo::ConstPtr&)> callback =
+        [this, resolved](const auto& msg) { handleCameraInfo(resolved, msg); };
+    info_subs_[resolved] = nh_.subscribe<sensor_msgs::CameraInfo>(topic, 1, callback);
+  }
+
+  if (requests.sensor_frames.empty()) {
+    return;
+  }
+
+  buffer_.reset(new tf2_ros::Buffer());
+  listener_.reset(new tf2_ros::TransformListener(*buffer_));
+  const auto robot_frame = GlobalInfo::instance().getFrames().robot;
+  for (const auto& frame : requests.sensor_frames) {
+    extrinsics_[frame] = std::async(std::launch::async,
+                                    [buffer = buffer_.get(),
+                                     robot_frame,
+                                     frame,
+                                     timeout_s = config.timeout_s]() {
+                                      return waitForTransform(*buffer,
+                                                              ros::Time(0),
+                                                              robot_frame,
+                                                              frame,
+                                                              timeout_s);
+                                    })
+                             .share();
+  }
+}
+
+void SensorPrefetcher::stop() {
+  std::map<std::string, std::shared_future<PoseStatus>> extrinsics;
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    extrinsics.swap(extrinsics_);
+  }  // end critical section
+
+  // transform waits reference the buffer and finish by the deadline at the latest
+  for (auto& [frame, result] : extrinsics) {
+    result.wait();
+  }
+
+  if (threads_) {
+    threads_->stop();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  info_subs_.clear();
+  infos_.clear();
+  threads_.reset();
+  listener_.reset();
+  buffer_.reset();
+}
+
+std::optional<sensor_msgs::CameraInfo::ConstPtr> SensorPrefetcher::getCameraInfo(
+    const std::string& resolved_topic) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!info_subs_.count(resolved_topic)) {
+    return std::nullopt;
+  }
+
+  while (!infos_.count(resolved_topic) && ros::ok()) {
+    // wake up periodically to check for shutdown
+    const auto wake_time = std::min(
+        deadline_, std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+    cv_.wait_until(lock, wake_time);
+    if (std::chrono::steady_clock::now() >= deadline_) {
+      break;
+    }
+  }
+
+  const auto iter = infos_.find(resolved_topic);
+  if (iter == infos_.end()) {
+    // the sensor keeps waiting on its own instead of using an empty config
+    LOG(WARNING) << "Did not receive camera info on " << resolved_topic
+                 << " before the prefetch deadline";
+    return std::nullopt;
+  }
+
+  return iter->second;
+}
+
+std::optional<PoseStatus> SensorPrefetcher::getExtrinsics(
+    const std::string& sensor_frame) {
+  std::shared_future<PoseStatus> result;
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto iter = extrinsics_.find(sensor_frame);
+    if (iter == extrinsics_.end()) {
+      return std::nullopt;
+    }
+
+    result = iter->second;
+  }  // end critical section
+
+  const auto& pose_status = result.get();
+  if (!pose_status.is_valid) {
+    // the sensor keeps retrying on its own instead of failing at startup
+    LOG(WARNING) << "Did not receive extrinsics for " << sensor_frame
+                 << " before the prefetch deadline";
+    return std::nullopt;
+  }
+
+  return pose_status;
+}
+
+void SensorPrefetcher::handleCameraInfo(const std::string& topic,
+                                        const sensor_msgs::CameraInfo::ConstPtr& msg) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  infos_.emplace(topic, msg);
+  cv_.notify_all();
+}
+
+}  // namespace hydra
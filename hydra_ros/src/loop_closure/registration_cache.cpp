@@ -0,0 +1,109 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/loop_closure/registration_cache.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+namespace hydra::lcd {
+
+void declare_config(RegistrationCache::Config& config) {
+  using namespace config;
+  name("RegistrationCache::Config");
+  field(config.max_size, "max_size");
+  field(config.success_ttl_s, "success_ttl_s", "s");
+  field(config.failure_ttl_s, "failure_ttl_s", "s");
+}
+
+RegistrationCache::RegistrationCache(const Config& config)
+    : config(config::checkValid(config)) {}
+
+bool RegistrationCache::expired(const Item& item, double now_s) const {
+  const double ttl_s = item.entry.valid ? config.success_ttl_s : config.failure_ttl_s;
+  return ttl_s >= 0.0 && now_s - item.stamp_s > ttl_s;
+}
+
+std::optional<RegistrationCache::Entry> RegistrationCache::get(const Key& key,
+                                                              double now_s) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = lookup_.find(key);
+  if (iter == lookup_.end()) {
+    return std::nullopt;
+  }
+
+  if (expired(*iter->second, now_s)) {
+    items_.erase(iter->second);
+    lookup_.erase(iter);
+    return std::nullopt;
+  }
+
+  items_.splice(items_.begin(), items_, iter->second);
+  return iter->second->entry;
+}
+
+void RegistrationCache::put(const Key& key, const Entry& entry, double now_s) {
+  if (!config.max_size) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = lookup_.find(key);
+  if (iter != lookup_.end()) {
+    iter->second->entry = entry;
+    iter->second->stamp_s = now_s;
+    items_.splice(items_.begin(), items_, iter->second);
+    return;
+  }
+
+  items_.push_front({key, entry, now_s});
+  lookup_[key] = items_.begin();
+  while (items_.size() > config.max_size) {
+    lookup_.erase(items_.back().key);
+    items_.pop_back();
+  }
+}
+
+size_t RegistrationCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return items_.size();
+}
+
+void RegistrationCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  items_.clear();
+  lookup_.clear();
+}
+
+}  // namespace hydra::lcd
@@ -34,17 +34,22 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_ros/loop_closure/ros_lcd_registration.h"
 
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
 #include <hydra/utils/timing_utilities.h>
 #include <kimera_pgmo/utils/common_functions.h>
 #include <pose_graph_tools_msgs/LcdFrameRegistration.h>
 #include <ros/service.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <algorithm>
 #include <iomanip>
 
+#include "hydra_ros/utils/metrics.h"
+
 namespace hydra::lcd {
 
-using hydra::timing::ScopedTimer;
+using pose_graph_tools_msgs::LcdFrameRegistration;
 
 inline size_t getRobotIdFromNode(const DynamicSceneGraph& graph, NodeId node_id) {
   const auto& attrs = graph.getNode(node_id).attributes<AgentNodeAttributes>();
@@ -66,16 +71,84 @@ std::string getPoseRepr(const Eigen::Quaterniond& q, const Eigen::Vector3d& v) {
   return ss.str();
 }
 
-RegistrationSolution DsgAgentSolver::solve(const DynamicSceneGraph& dsg,
-                                           const DsgRegistrationInput& match,
-                                           NodeId) const {
-  if (match.query_nodes.empty() || match.match_nodes.empty()) {
-    return {};
+void declare_config(DsgAgentSolver::Config& config) {
+  using namespace config;
+  name("DsgAgentSolver::Config");
+  field(config.service_name, "service_name");
+  field(config.async, "async");
+  field(config.num_workers, "num_workers");
+  field(config.async_timeout_s, "async_timeout_s", "s");
+  field(config.max_pending, "max_pending");
+  field(config.service_backoff_s, "service_backoff_s", "s");
+  field(config.max_service_backoff_s, "max_service_backoff_s", "s");
+  field(config.cache, "cache");
+
+  check(config.num_workers, GT, 0u, "num_workers");
+  check(config.max_pending, GT, 0u, "max_pending");
+  check(config.async_timeout_s, GE, 0.0, "async_timeout_s");
+  check(config.service_backoff_s, GT, 0.0, "service_backoff_s");
+  check(config.max_service_backoff_s,
+        GE,
+        config.service_backoff_s,
+        "max_service_backoff_s");
+}
+
+ServiceBackoff::ServiceBackoff(double initial_s, double max_s)
+    : initial_s_(initial_s), max_s_(max_s) {}
+
+bool ServiceBackoff::shouldCheck(double now_s) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return now_s >= next_check_s_;
+}
+
+void ServiceBackoff::succeeded() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  delay_s_ = 0.0;
+  next_check_s_ = 0.0;
+}
+
+void ServiceBackoff::failed(double now_s) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  delay_s_ = delay_s_ > 0.0 ? std::min(2.0 * delay_s_, max_s_) : initial_s_;
+  next_check_s_ = now_s + delay_s_;
+}
+
+DsgAgentSolver::DsgAgentSolver() : DsgAgentSolver(Config()) {}
+
+DsgAgentSolver::DsgAgentSolver(const Config& config)
+    : config(config::checkValid(config)),
+      backoff_(config.service_backoff_s, config.max_service_backoff_s),
+      cache_(config.cache) {
+  if (!config.async) {
+    return;
   }
 
-  if (!ros::service::exists("frame_registration", true)) {
-    LOG(ERROR) << "[Hydra LCD] Frame registration service missing!";
-    return {};
+  for (size_t i = 0; i < config.num_workers; ++i) {
+    workers_.emplace_back(&DsgAgentSolver::spinWorker, this);
+  }
+}
+
+DsgAgentSolver::~DsgAgentSolver() {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    should_shutdown_ = true;
+  }  // end critical section
+
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void DsgAgentSolver::setResultCallback(const ResultCallback& callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  callback_ = callback;
+}
+
+std::optional<DsgAgentSolver::Request> DsgAgentSolver::makeRequest(
+    const DynamicSceneGraph& dsg, const DsgRegistrationInput& match) const {
+  if (match.query_nodes.empty() || match.match_nodes.empty()) {
+    return std::nullopt;
   }
 
   // at the agent level, match sets are one node each
@@ -84,20 +157,75 @@ RegistrationSolution DsgAgentSolver::solve(const DynamicSceneGraph& dsg,
 
   if (!dsg.hasNode(query_id) || !dsg.hasNode(match_id)) {
     LOG(ERROR) << "Query or match node does not exist in graph!";
-    return {};
+    return std::nullopt;
   }
 
-  pose_graph_tools_msgs::LcdFrameRegistration msg;
-  msg.request.query_robot = getRobotIdFromNode(dsg, query_id);
-  msg.request.match_robot = getRobotIdFromNode(dsg, match_id);
-  msg.request.query = getFrameIdFromNode(dsg, query_id);
-  msg.request.match = getFrameIdFromNode(dsg, match_id);
-  uint64_t timestamp = dsg.getNode(query_id).timestamp.value().count();
+  // the graph is only read here so that requests can be served without it
+  std::optional<Request> request(std::in_place);
+  request->query_id = query_id;
+  request->match_id = match_id;
+  request->timestamp_ns = dsg.getNode(query_id).timestamp.value().count();
+  auto& srv = request->srv;
+  srv.request.query_robot = getRobotIdFromNode(dsg, query_id);
+  srv.request.match_robot = getRobotIdFromNode(dsg, match_id);
+  srv.request.query = getFrameIdFromNode(dsg, query_id);
+  srv.request.match = getFrameIdFromNode(dsg, match_id);
+  return request;
+}
+
+RegistrationSolution DsgAgentSolver::call(ros::ServiceClient& client,
+                                          Request& request) const {
+  auto& msg = request.srv;
+  RegistrationCache::Key key;
+  key.query_robot = msg.request.query_robot;
+  key.query = msg.request.query;
+  key.match_robot = msg.request.match_robot;
+  key.match = msg.request.match;
+  const auto cached = cache_.get(key, ros::WallTime::now().toSec());
+  if (cached) {
+    MetricsRegistry::instance().addCount("lcd/register_agent_cache_hits");
+    VLOG(3) << "Cached visual registration " << (cached->valid ? "success" : "failure")
+            << ": " << NodeSymbol(request.query_id).getLabel() << " -> "
+            << NodeSymbol(request.match_id).getLabel();
+    if (!cached->valid) {
+      return {};
+    }
+
+    return {true,
+            request.query_id,
+            request.match_id,
+            cached->match_t_query,
+            cached->match_q_query,
+            -1};
+  }
+
+  if (!client || !client.isValid()) {
+    // persistent clients avoid a service lookup and connection per request, so the
+    // master is only queried when the connection has to be (re-)established
+    const double now_s = ros::WallTime::now().toSec();
+    if (!backoff_.shouldCheck(now_s)) {
+      MetricsRegistry::instance().addCount("lcd/register_agent_unavailable");
+      return {};
+    }
 
-  ScopedTimer timer("lcd/register_agent", timestamp, true, 2, false);
+    if (!ros::service::exists(config.service_name, false)) {
+      LOG(ERROR) << "[Hydra LCD] Frame registration service missing!";
+      backoff_.failed(now_s);
+      MetricsRegistry::instance().addCount("lcd/register_agent_unavailable");
+      return {};
+    }
 
-  if (!ros::service::call("frame_registration", msg)) {
+    backoff_.succeeded();
+    client = ros::NodeHandle().serviceClient<LcdFrameRegistration>(config.service_name,
+                                                                   true);
+  }
+
+  LatencyTimer timer("lcd/register_agent", request.timestamp_ns, true, 2, false);
+
+  if (!client.call(msg)) {
     LOG(ERROR) << "Frame registration service failed!";
+    client.shutdown();
+    backoff_.failed(ros::WallTime::now().toSec());
     return {};
   }
 
@@ -106,9 +234,12 @@ RegistrationSolution DsgAgentSolver::solve(const DynamicSceneGraph& dsg,
           << "}, match={robot: " << msg.request.match_robot
           << ", frame: " << msg.request.match;
 
+  RegistrationCache::Entry entry;
+  entry.valid = msg.response.valid;
   if (!msg.response.valid) {
-    VLOG(1) << "Visual registration failed: " << NodeSymbol(query_id).getLabel()
-            << " -> " << NodeSymbol(match_id).getLabel();
+    cache_.put(key, entry, ros::WallTime::now().toSec());
+    VLOG(1) << "Visual registration failed: " << NodeSymbol(request.query_id).getLabel()
+            << " -> " << NodeSymbol(request.match_id).getLabel();
     return {};
   }
 
@@ -116,10 +247,130 @@ RegistrationSolution DsgAgentSolver::solve(const DynamicSceneGraph& dsg,
   Eigen::Vector3d match_t_query;
   tf2::convert(msg.response.match_T_query.orientation, match_q_query);
   tf2::convert(msg.response.match_T_query.position, match_t_query);
-  const Eigen::IOFormat format(3, Eigen::DontAlignCols, ", ", ", ", "", "", "[", "]");
+  entry.match_t_query = match_t_query;
+  entry.match_q_query = match_q_query;
+  cache_.put(key, entry, ros::WallTime::now().toSec());
   VLOG(3) << "Visual registration succeded: "
           << getPoseRepr(match_q_query, match_t_query);
-  return {true, query_id, match_id, match_t_query, match_q_query, -1};
+  return {
+      true, request.query_id, request.match_id, match_t_query, match_q_query, -1};
+}
+
+RegistrationSolution DsgAgentSolver::solve(const DynamicSceneGraph& dsg,
+                                           const DsgRegistrationInput& match,
+                                           NodeId) const {
+  if (!config.async) {
+    auto request = makeRequest(dsg, match);
+    return request ? call(client_, *request) : RegistrationSolution();
+  }
+
+  if (match.query_nodes.empty() || match.match_nodes.empty()) {
+    return {};
+  }
+
+  // drop finished results nobody asked for again (the callback already saw them)
+  const size_t max_in_flight = config.max_pending + config.num_workers;
+  for (auto curr = in_flight_.begin();
+       curr != in_flight_.end() && in_flight_.size() > max_in_flight;) {
+    if (curr->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      curr = in_flight_.erase(curr);
+    } else {
+      ++curr;
+    }
+  }
+
+  const std::pair<NodeId, NodeId> key{*match.query_nodes.begin(),
+                                      *match.match_nodes.begin()};
+  auto iter = in_flight_.find(key);
+  if (iter == in_flight_.end()) {
+    auto future = solveAsync(dsg, match);
+    if (!future.valid()) {
+      return {};
+    }
+
+    iter = in_flight_.emplace(key, std::move(future)).first;
+  }
+
+  // only wait for this candidate: other submitted requests keep running on the
+  // workers, and a late result stays in flight in case the pair is asked for again
+  const std::chrono::duration<double> timeout(config.async_timeout_s);
+  if (iter->second.wait_for(timeout) != std::future_status::ready) {
+    LOG(WARNING) << "[Hydra LCD] Timed out waiting for registration of "
+                 << NodeSymbol(key.first).getLabel() << " -> "
+                 << NodeSymbol(key.second).getLabel();
+    MetricsRegistry::instance().addCount("lcd/register_agent_timeouts");
+    return {};
+  }
+
+  auto solution = iter->second.get();
+  in_flight_.erase(iter);
+  return solution;
+}
+
+std::future<RegistrationSolution> DsgAgentSolver::solveAsync(
+    const DynamicSceneGraph& dsg, const DsgRegistrationInput& match) const {
+  auto request = makeRequest(dsg, match);
+  if (!request) {
+    return {};
+  }
+
+  auto future = request->promise.get_future();
+  if (!config.async) {
+    request->promise.set_value(call(client_, *request));
+    return future;
+  }
+
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.size() >= config.max_pending) {
+      LOG(WARNING) << "[Hydra LCD] Dropping registration request for "
+                   << NodeSymbol(pending_.front().query_id).getLabel();
+      MetricsRegistry::instance().addCount("lcd/dropped_registrations");
+      pending_.front().promise.set_value({});
+      pending_.pop_front();
+    }
+
+    pending_.push_back(std::move(*request));
+  }  // end critical section
+
+  cv_.notify_one();
+  return future;
+}
+
+void DsgAgentSolver::spinWorker() {
+  ros::ServiceClient client;
+  while (true) {
+    std::optional<Request> request;
+    {  // start critical section
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return should_shutdown_ || !pending_.empty(); });
+      if (should_shutdown_) {
+        break;
+      }
+
+      request.emplace(std::move(pending_.front()));
+      pending_.pop_front();
+    }  // end critical section
+
+    const auto solution = call(client, *request);
+    ResultCallback callback;
+    {  // start critical section
+      std::lock_guard<std::mutex> lock(mutex_);
+      callback = callback_;
+    }  // end critical section
+
+    if (callback) {
+      callback(solution);
+    }
+
+    request->promise.set_value(solution);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& request : pending_) {
+    request.promise.set_value({});
+  }
+  pending_.clear();
 }
 
 }  // namespace hydra::lcd
@@ -38,35 +38,51 @@
 #include <kimera_pgmo/deformation_graph.h>
 #include <std_srvs/Empty.h>
 
+#include <filesystem>
+#include <mutex>
+
 #include "hydra_ros/backend/ros_backend.h"
+#include "hydra_ros/utils/node_utilities.h"
 #include "hydra_ros/visualizer/dynamic_scene_graph_visualizer.h"
 
 namespace hydra {
 
+struct OptimizerRun {
+  std::string name;
+  SharedDsgInfo::Ptr frontend_dsg;
+  SharedDsgInfo::Ptr backend_dsg;
+  BackendModule::Ptr backend;
+  //! Whether the backend holds the frontend and deformation graph state
+  bool state_loaded = false;
+};
+
 struct DsgOptimizer {
   DsgOptimizer(const ros::NodeHandle& node_handle)
-      : nh(node_handle), reset_backend(false), dsg_output_path("") {
+      : nh(node_handle),
+        reset_backend(false),
+        run_sweep(false),
+        dsg_output_path("") {
     CHECK(nh.getParam("dsg_filepath", dsg_filepath)) << "missing dsg_filepath!";
     CHECK(nh.getParam("dgrf_filepath", dgrf_filepath)) << "missing dgrf_filepath!";
     CHECK(nh.getParam("frontend_filepath", frontend_filepath))
         << "missing frontend_state_filepath";
     nh.getParam("log_path", dsg_output_path);
+    // each namespace holds a full backend config to optimize with during a sweep
+    nh.getParam("sweep_namespaces", sweep_namespaces);
 
-    const std::map<LayerId, char>& layer_id_map{{DsgLayers::OBJECTS, 'o'},
-                                                {DsgLayers::PLACES, 'p'},
-                                                {DsgLayers::ROOMS, 'r'},
-                                                {DsgLayers::BUILDINGS, 'b'}};
-
-    frontend_dsg = std::make_shared<SharedDsgInfo>(layer_id_map);
-    backend_dsg = std::make_shared<SharedDsgInfo>(layer_id_map);
+    // TODO(nathan) maybe pull robot id from somewhere
+    GlobalInfo::init(PipelineConfig{}, 0);
 
-    frontend_dsg->graph = frontend_dsg->graph->load(dsg_filepath);
-    frontend_dsg->updated = true;
+    // parsed once and copied for every run so that runs never see each other
+    loaded_graph = DynamicSceneGraph::load(dsg_filepath);
+    CHECK(loaded_graph) << "failed to load " << dsg_filepath;
 
     do_optimize();
+    run_sweep = !sweep_namespaces.empty();
 
     optimize_service =
         nh.advertiseService("optimize", &DsgOptimizer::handle_service, this);
+    sweep_service = nh.advertiseService("sweep", &DsgOptimizer::handle_sweep, this);
   }
 
   bool handle_service(std_srvs::Empty::Request&, std_srvs::Empty::Response&) {
@@ -74,27 +90,94 @@ struct DsgOptimizer {
     return true;
   }
 
-  void do_optimize() {
-    // TODO(nathan) maybe pull robot id from somewhere
-    GlobalInfo::init(PipelineConfig{}, 0);
+  bool handle_sweep(std_srvs::Empty::Request&, std_srvs::Empty::Response&) {
+    run_sweep = true;
+    return true;
+  }
+
+  OptimizerRun make_run(const std::string& name, const ros::NodeHandle& run_nh) const {
+    const std::map<LayerId, char>& layer_id_map{{DsgLayers::OBJECTS, 'o'},
+                                                {DsgLayers::PLACES, 'p'},
+                                                {DsgLayers::ROOMS, 'r'},
+                                                {DsgLayers::BUILDINGS, 'b'}};
+
+    OptimizerRun run;
+    run.name = name;
+    run.frontend_dsg = std::make_shared<SharedDsgInfo>(layer_id_map);
+    run.frontend_dsg->graph = loaded_graph->clone();
+    run.frontend_dsg->updated = true;
+    run.backend_dsg = std::make_shared<SharedDsgInfo>(layer_id_map);
+
     SharedModuleState::Ptr state(new SharedModuleState());
-    backend =
-        config::createFromROS<BackendModule>(nh, frontend_dsg, backend_dsg, state);
-    LOG(ERROR) << "Loading backend state!";
-    backend->loadState(frontend_filepath, dgrf_filepath);
-    LOG(ERROR) << "Loaded backend state!";
+    run.backend = config::createFromROS<BackendModule>(
+        run_nh, run.frontend_dsg, run.backend_dsg, state);
+    return run;
+  }
+
+  void optimize(OptimizerRun& run) const {
+    // the state only has to be read from disk once per backend
+    if (!run.state_loaded) {
+      LOG(ERROR) << "[" << run.name << "] Loading backend state!";
+      run.backend->loadState(frontend_filepath, dgrf_filepath);
+      LOG(ERROR) << "[" << run.name << "] Loaded backend state!";
+      run.state_loaded = true;
+    }
 
     BackendInput input;
     input.deformation_graph = std::make_shared<pose_graph_tools::PoseGraph>();
-    backend->spinOnce(input, true);
+    run.backend->spinOnce(input, true);
+  }
+
+  void reset(OptimizerRun& run) const {
+    // the backend keeps the shared graphs, so only their contents are replaced
+    std::scoped_lock lock(run.frontend_dsg->mutex, run.backend_dsg->mutex);
+    run.frontend_dsg->graph = loaded_graph->clone();
+    run.frontend_dsg->updated = true;
+    run.backend_dsg->graph->clear();
+  }
+
+  void do_optimize() {
+    // a backend's config is fixed, so only new parameters require a new backend
+    const auto params = getParamSignature(nh);
+    if (!current.backend || params != current_params) {
+      current = make_run("optimize", nh);
+      current_params = params;
+    } else {
+      LOG(INFO) << "Parameters unchanged: re-running with the existing backend";
+      reset(current);
+    }
+
+    // an existing backend keeps its deformation graph and only re-optimizes
+    optimize(current);
 
-    visualizer->setGraph(backend_dsg->graph);
+    visualizer->setGraph(current.backend_dsg->graph);
     visualizer->redraw();
 
     // backend->visualizePoseGraph();
     // backend->visualizeDeformationGraphEdges();
   }
 
+  void do_sweep() {
+    if (dsg_output_path.empty()) {
+      LOG(WARNING) << "No log_path set: sweep results are not saved";
+    }
+
+    // backends share the GlobalInfo singleton, so sweep points run one at a time
+    for (const auto& ns : sweep_namespaces) {
+      auto run = make_run(ns, ros::NodeHandle(nh, ns));
+      optimize(run);
+      if (dsg_output_path.empty()) {
+        continue;
+      }
+
+      const auto output = std::filesystem::path(dsg_output_path) / "sweep" / run.name;
+      std::filesystem::create_directories(output);
+      LOG(INFO) << "[" << run.name << "] Saving scene graph to " << output;
+      run.backend_dsg->graph->save((output / "dsg.json").string(), false);
+      run.backend_dsg->graph->save((output / "dsg_with_mesh.json").string());
+    }
+  }
+
   void run() {
     ros::WallRate r(10);
     while (ros::ok()) {
@@ -103,6 +186,11 @@ struct DsgOptimizer {
         do_optimize();
       }
 
+      if (run_sweep) {
+        run_sweep = false;
+        do_sweep();
+      }
+
       r.sleep();
       ros::spinOnce();
     }
@@ -110,26 +198,30 @@ struct DsgOptimizer {
     if (!dsg_output_path.empty()) {
       LOG(INFO) << "[DSG Node] Saving scene graph and other stats and logs to "
                 << dsg_output_path;
-      backend_dsg->graph->save(dsg_output_path + "/backend/dsg.json", false);
-      backend_dsg->graph->save(dsg_output_path + "/backend/dsg_with_mesh.json");
+      const auto& graph = current.backend_dsg->graph;
+      graph->save(dsg_output_path + "/backend/dsg.json", false);
+      graph->save(dsg_output_path + "/backend/dsg_with_mesh.json");
     }
   }
 
   ros::NodeHandle nh;
   bool reset_backend;
+  bool run_sweep;
 
   std::string dsg_filepath;
   std::string frontend_filepath;
   std::string dgrf_filepath;
   std::string dsg_output_path;
+  std::vector<std::string> sweep_namespaces;
 
-  SharedDsgInfo::Ptr frontend_dsg;
-  SharedDsgInfo::Ptr backend_dsg;
+  DynamicSceneGraph::Ptr loaded_graph;
+  OptimizerRun current;
+  std::string current_params;
 
-  BackendModule::Ptr backend;
   std::unique_ptr<DynamicSceneGraphVisualizer> visualizer;
 
   ros::ServiceServer optimize_service;
+  ros::ServiceServer sweep_service;
 };
 
 }  // namespace hydra
@@ -39,9 +39,13 @@
 #include <hydra/common/global_info.h>
 
 #include "hydra_ros/hydra_ros_pipeline.h"
+#include "hydra_ros/utils/metrics_publisher.h"
 #include "hydra_ros/utils/node_utilities.h"
+#include "hydra_ros/utils/pipeline_benchmark.h"
 
 int main(int argc, char* argv[]) {
+  // bag input still reads its configuration from the parameter server, so it needs
+  // a roscore like every other mode
   ros::init(argc, argv, "hydra_node");
 
   FLAGS_minloglevel = 3;
@@ -60,11 +64,33 @@ int main(int argc, char* argv[]) {
   hydra::HydraRosPipeline hydra(nh, robot_id);
   hydra.init();
 
+  const ros::NodeHandle metrics_nh(nh, "metrics");
+  hydra::MetricsPublisher metrics(
+      config::fromRos<hydra::MetricsPublisher::Config>(metrics_nh),
+      metrics_nh,
+      ros::this_node::getName());
+
+  hydra::PipelineBenchmark benchmark(config::fromRos<hydra::PipelineBenchmark::Config>(
+      ros::NodeHandle(nh, "benchmark")));
+
   hydra.start();
-  hydra::spinAndWait(nh);
+  benchmark.start();
+  if (hydra.hasBagInput()) {
+    // bags are processed as fast as possible and the node exits once they are done
+    ros::WallRate r(10);
+    while (ros::ok() && !hydra.inputFinished()) {
+      ros::spinOnce();
+      r.sleep();
+    }
+  } else {
+    hydra::spinAndWait(nh);
+  }
+
   hydra.stop();
+  // only counts the processing time and not saving the outputs
+  const auto regressions = benchmark.finish();
   hydra.save();
   hydra::GlobalInfo::exit();
 
-  return 0;
+  return regressions.empty() ? 0 : 1;
 }
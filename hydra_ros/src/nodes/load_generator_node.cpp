@@ -0,0 +1,439 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <config_utilities/config.h>
+#include <config_utilities/parsing/ros.h>
+#include <config_utilities/printing.h>
+#include <config_utilities/validation.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <glog/logging.h>
+#include <ros/ros.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <tf2_ros/static_transform_broadcaster.h>
+#include <tf2_ros/transform_broadcaster.h>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <optional>
+
+namespace hydra {
+
+using diagnostic_msgs::DiagnosticArray;
+using sensor_msgs::PointField;
+
+struct LoadGeneratorConfig {
+  //! namespaces of the simulated sensors (one receiver per namespace)
+  std::vector<std::string> sensors{"camera"};
+  //! publish point clouds instead of rgb, depth and label images
+  bool use_pointcloud = false;
+  //! initial rate that every sensor publishes at
+  double rate_hz = 10.0;
+  //! rate increase per ramp step (constant rate if not positive)
+  double ramp_step_hz = 0.0;
+  //! duration of each ramp step (and of each report for constant rates)
+  double ramp_period_s = 10.0;
+  //! maximum rate to ramp up to
+  double max_rate_hz = 100.0;
+  //! stop once hydra_node drops inputs instead of continuing the ramp
+  bool stop_on_drop = true;
+  int width = 640;
+  int height = 480;
+  size_t num_labels = 20;
+  //! simulated forward speed of the robot (moves along a circle)
+  double speed_mps = 0.5;
+  double path_radius_m = 5.0;
+  std::string odom_frame = "odom";
+  std::string robot_frame = "base_link";
+  //! node name reported in /diagnostics to monitor (any node if empty)
+  std::string target_node = "";
+  //! queue length (in packets) past which hydra_node is considered behind
+  double max_queue_size = 10.0;
+};
+
+void declare_config(LoadGeneratorConfig& config) {
+  using namespace config;
+  name("LoadGeneratorConfig");
+  field(config.sensors, "sensors");
+  field(config.use_pointcloud, "use_pointcloud");
+  field(config.rate_hz, "rate_hz", "Hz");
+  field(config.ramp_step_hz, "ramp_step_hz", "Hz");
+  field(config.ramp_period_s, "ramp_period_s", "s");
+  field(config.max_rate_hz, "max_rate_hz", "Hz");
+  field(config.stop_on_drop, "stop_on_drop");
+  field(config.width, "width");
+  field(config.height, "height");
+  field(config.num_labels, "num_labels");
+  field(config.speed_mps, "speed_mps", "m/s");
+  field(config.path_radius_m, "path_radius_m", "m");
+  field(config.odom_frame, "odom_frame");
+  field(config.robot_frame, "robot_frame");
+  field(config.target_node, "target_node");
+  field(config.max_queue_size, "max_queue_size");
+  check(config.rate_hz, GT, 0.0, "rate_hz");
+  check(config.ramp_period_s, GT, 0.0, "ramp_period_s");
+  check(config.width, GT, 0, "width");
+  check(config.height, GT, 0, "height");
+  check(config.num_labels, GT, 0, "num_labels");
+  check(config.path_radius_m, GT, 0.0, "path_radius_m");
+  checkCondition(!config.sensors.empty(), "sensors must not be empty");
+}
+
+// totals reported by hydra_node that indicate it could not keep up
+struct HydraLoad {
+  double num_dropped = 0.0;
+  double queue_size = 0.0;
+};
+
+struct LoadGeneratorNode {
+  struct SensorPubs {
+    std::string frame;
+    ros::Publisher color;
+    ros::Publisher depth;
+    ros::Publisher labels;
+    ros::Publisher cloud;
+  };
+
+  explicit LoadGeneratorNode(const ros::NodeHandle& nh)
+      : config(config::checkValid(config::fromRos<LoadGeneratorConfig>(nh))),
+        nh_(nh),
+        rate_hz_(config.rate_hz),
+        num_published_(0) {
+    LOG(INFO) << "Load generator:" << std::endl << config::toString(config);
+    makeTemplates();
+
+    for (const auto& sensor : config.sensors) {
+      ros::NodeHandle sensor_nh(sensor);
+      SensorPubs pubs;
+      pubs.frame = sensor + "_link";
+      if (config.use_pointcloud) {
+        pubs.cloud = sensor_nh.advertise<sensor_msgs::PointCloud2>("pointcloud", 10);
+      } else {
+        // matches the topics that ImageReceiver subscribes to
+        pubs.color = sensor_nh.advertise<sensor_msgs::Image>("rgb/image_raw", 10);
+        pubs.depth =
+            sensor_nh.advertise<sensor_msgs::Image>("depth_registered/image_rect", 10);
+        pubs.labels = sensor_nh.advertise<sensor_msgs::Image>("semantic/image_raw", 10);
+      }
+
+      sensors_.push_back(pubs);
+    }
+
+    publishSensorFrames();
+    diagnostics_sub_ =
+        nh_.subscribe("/diagnostics", 10, &LoadGeneratorNode::handleDiagnostics, this);
+  }
+
+  void makeTemplates() {
+    const uint32_t width = config.width;
+    const uint32_t height = config.height;
+
+    color_.width = width;
+    color_.height = height;
+    color_.encoding = "rgb8";
+    color_.step = 3 * width;
+    color_.data.resize(color_.step * height);
+
+    depth_.width = width;
+    depth_.height = height;
+    depth_.encoding = "32FC1";
+    depth_.step = sizeof(float) * width;
+    depth_.data.resize(depth_.step * height);
+
+    labels_.width = width;
+    labels_.height = height;
+    labels_.encoding = "16UC1";
+    labels_.step = sizeof(uint16_t) * width;
+    labels_.data.resize(labels_.step * height);
+
+    cloud_.width = width;
+    cloud_.height = height;
+    cloud_.is_dense = true;
+    cloud_.fields.resize(5);
+    const std::array<std::string, 5> names{"x", "y", "z", "rgb", "label"};
+    for (size_t i = 0; i < names.size(); ++i) {
+      auto& field = cloud_.fields[i];
+      field.name = names[i];
+      field.offset = i * 4;
+      field.datatype = i < 3 ? PointField::FLOAT32 : PointField::UINT32;
+      field.count = 1;
+    }
+
+    cloud_.point_step = 4 * names.size();
+    cloud_.row_step = cloud_.point_step * width;
+    cloud_.data.resize(cloud_.row_step * height);
+
+    // a rippled wall in front of the sensor with banded labels and a color gradient
+    const float fx = width / 2.0f;
+    const float fy = fx;
+    for (uint32_t r = 0; r < height; ++r) {
+      for (uint32_t c = 0; c < width; ++c) {
+        const size_t idx = r * width + c;
+        const float depth = 3.0f + 0.5f * std::sin(0.05f * c) * std::cos(0.05f * r);
+        const uint16_t label = (c * config.num_labels) / width;
+        const std::array<uint8_t, 3> rgb{static_cast<uint8_t>((255 * c) / width),
+                                         static_cast<uint8_t>((255 * r) / height),
+                                         static_cast<uint8_t>(40 * label)};
+
+        std::memcpy(&color_.data[3 * idx], rgb.data(), 3);
+        std::memcpy(&depth_.data[sizeof(float) * idx], &depth, sizeof(float));
+        std::memcpy(&labels_.data[sizeof(uint16_t) * idx], &label, sizeof(uint16_t));
+
+        const std::array<float, 3> point{(c - width / 2.0f) * depth / fx,
+                                         (r - height / 2.0f) * depth / fy,
+                                         depth};
+        const uint32_t packed_rgb = (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
+        const uint32_t packed_label = label;
+        uint8_t* point_ptr = &cloud_.data[idx * cloud_.point_step];
+        std::memcpy(point_ptr, point.data(), 3 * sizeof(float));
+        std::memcpy(point_ptr + 12, &packed_rgb, sizeof(uint32_t));
+        std::memcpy(point_ptr + 16, &packed_label, sizeof(uint32_t));
+      }
+    }
+  }
+
+  void publishSensorFrames() {
+    std::vector<geometry_msgs::TransformStamped> transforms;
+    for (const auto& sensor : sensors_) {
+      auto& transform = transforms.emplace_back();
+      transform.header.stamp = ros::Time::now();
+      transform.header.frame_id = config.robot_frame;
+      transform.child_frame_id = sensor.frame;
+      transform.transform.rotation.w = 1.0;
+    }
+
+    static_broadcaster_.sendTransform(transforms);
+  }
+
+  void publishPose(const ros::Time& stamp) {
+    const double distance_m = config.speed_mps * (stamp - start_).toSec();
+    const double angle = distance_m / config.path_radius_m;
+    geometry_msgs::TransformStamped transform;
+    transform.header.stamp = stamp;
+    transform.header.frame_id = config.odom_frame;
+    transform.child_frame_id = config.robot_frame;
+    transform.transform.translation.x = config.path_radius_m * std::cos(angle);
+    transform.transform.translation.y = config.path_radius_m * std::sin(angle);
+    // yaw tangent to the circle
+    const double yaw = angle + M_PI / 2.0;
+    transform.transform.rotation.z = std::sin(yaw / 2.0);
+    transform.transform.rotation.w = std::cos(yaw / 2.0);
+    broadcaster_.sendTransform(transform);
+  }
+
+  template <typename Msg>
+  void publishCopy(const ros::Publisher& pub,
+                   const Msg& msg_template,
+                   const std::string& frame,
+                   const ros::Time& stamp) {
+    if (!pub.getNumSubscribers()) {
+      return;
+    }
+
+    // published messages are shared with subscribers, so each one is a fresh copy
+    auto msg = boost::make_shared<Msg>(msg_template);
+    msg->header.stamp = stamp;
+    msg->header.frame_id = frame;
+    pub.publish(msg);
+  }
+
+  void publishFrame(const ros::Time& stamp) {
+    publishPose(stamp);
+    for (const auto& sensor : sensors_) {
+      if (config.use_pointcloud) {
+        publishCopy(sensor.cloud, cloud_, sensor.frame, stamp);
+      } else {
+        publishCopy(sensor.color, color_, sensor.frame, stamp);
+        publishCopy(sensor.depth, depth_, sensor.frame, stamp);
+        publishCopy(sensor.labels, labels_, sensor.frame, stamp);
+      }
+    }
+
+    ++num_published_;
+  }
+
+  void handleDiagnostics(const DiagnosticArray::ConstPtr& msg) {
+    for (const auto& status : msg->status) {
+      if (!config.target_node.empty() && status.hardware_id != config.target_node) {
+        continue;
+      }
+
+      for (const auto& kv : status.values) {
+        // the input module skips or clears packets once it falls behind
+        if (kv.key == "input/skipped_queue" || kv.key == "input/skipped_latency" ||
+            kv.key == "input/dropped_packets") {
+          drop_totals_[status.hardware_id + kv.key] = std::stod(kv.value);
+        } else if (kv.key == "queue/reconstruction") {
+          queue_sizes_[status.hardware_id] = std::stod(kv.value);
+        }
+      }
+    }
+  }
+
+  HydraLoad currentLoad() const {
+    HydraLoad load;
+    for (const auto& [name, total] : drop_totals_) {
+      load.num_dropped += total;
+    }
+
+    for (const auto& [name, size] : queue_sizes_) {
+      load.queue_size = std::max(load.queue_size, size);
+    }
+
+    return load;
+  }
+
+  // returns false once the load test is finished
+  bool endStep(const ros::WallTime& now) {
+    const auto load = currentLoad();
+    const double elapsed_s = (now - step_start_).toSec();
+    const double achieved_hz = (num_published_ - step_start_published_) / elapsed_s;
+    const double num_dropped = load.num_dropped - step_start_load_.num_dropped;
+    const bool kept_up = num_dropped == 0.0 && load.queue_size <= config.max_queue_size;
+
+    LOG(INFO) << "[Load Generator] " << rate_hz_ << " Hz x " << sensors_.size()
+              << " sensors: published " << achieved_hz << " Hz, hydra dropped "
+              << num_dropped << " inputs, reconstruction queue at "
+              << load.queue_size << (kept_up ? " (kept up)" : " (behind)");
+    if (achieved_hz < 0.9 * rate_hz_) {
+      LOG(WARNING) << "[Load Generator] unable to publish at " << rate_hz_
+                   << " Hz: results are limited by the generator";
+    }
+
+    if (kept_up) {
+      sustained_hz_ = achieved_hz;
+    } else if (!first_drop_hz_) {
+      first_drop_hz_ = achieved_hz;
+    }
+
+    step_start_ = now;
+    step_start_published_ = num_published_;
+    step_start_load_ = load;
+    if (!kept_up && config.stop_on_drop) {
+      return false;
+    }
+
+    if (config.ramp_step_hz <= 0.0) {
+      return true;
+    }
+
+    if (rate_hz_ + config.ramp_step_hz > config.max_rate_hz) {
+      return false;
+    }
+
+    rate_hz_ += config.ramp_step_hz;
+    return true;
+  }
+
+  void report() const {
+    LOG(INFO) << "[Load Generator] sustained rate: "
+              << (sustained_hz_ ? std::to_string(*sustained_hz_) + " Hz" : "none");
+    LOG(INFO) << "[Load Generator] first dropped inputs at: "
+              << (first_drop_hz_ ? std::to_string(*first_drop_hz_) + " Hz" : "never");
+  }
+
+  void spin() {
+    start_ = ros::Time::now();
+    step_start_ = ros::WallTime::now();
+    step_start_published_ = 0;
+    step_start_load_ = currentLoad();
+
+    auto next_frame = ros::WallTime::now();
+    while (ros::ok()) {
+      auto now = ros::WallTime::now();
+      if (now >= next_frame) {
+        publishFrame(ros::Time::now());
+        next_frame += ros::WallDuration(1.0 / rate_hz_);
+        if (next_frame < now) {
+          // fell behind: keep the rate instead of bursting to catch up
+          next_frame = now;
+        }
+      }
+
+      if ((now - step_start_).toSec() >= config.ramp_period_s && !endStep(now)) {
+        break;
+      }
+
+      ros::spinOnce();
+      (next_frame - ros::WallTime::now()).sleep();
+    }
+
+    report();
+  }
+
+  const LoadGeneratorConfig config;
+  ros::NodeHandle nh_;
+  double rate_hz_;
+  size_t num_published_;
+
+  sensor_msgs::Image color_;
+  sensor_msgs::Image depth_;
+  sensor_msgs::Image labels_;
+  sensor_msgs::PointCloud2 cloud_;
+  std::vector<SensorPubs> sensors_;
+
+  tf2_ros::TransformBroadcaster broadcaster_;
+  tf2_ros::StaticTransformBroadcaster static_broadcaster_;
+  ros::Subscriber diagnostics_sub_;
+  std::map<std::string, double> drop_totals_;
+  std::map<std::string, double> queue_sizes_;
+
+  ros::Time start_;
+  ros::WallTime step_start_;
+  size_t step_start_published_;
+  HydraLoad step_start_load_;
+  std::optional<double> sustained_hz_;
+  std::optional<double> first_drop_hz_;
+};
+
+}  // namespace hydra
+
+int main(int argc, char* argv[]) {
+  ros::init(argc, argv, "load_generator_node");
+
+  FLAGS_minloglevel = 0;
+  FLAGS_logtostderr = 1;
+  FLAGS_colorlogtostderr = 1;
+
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+
+  ros::NodeHandle nh("~");
+  hydra::LoadGeneratorNode node(nh);
+  node.spin();
+
+  return 0;
+}
@@ -35,14 +35,23 @@
 #include <ros/ros.h>
 
 #include <iomanip>
+#include <optional>
 
+#include "hydra_ros/utils/dsg_log.h"
 #include "hydra_ros/utils/dsg_streaming_interface.h"
 
 namespace hydra {
 
 struct SceneGraphLoggerNode {
   SceneGraphLoggerNode(const ros::NodeHandle& nh)
-      : nh_(nh), curr_count_(0), curr_output_count_(0), output_every_num_(1) {
+      : nh_(nh),
+        curr_count_(0),
+        curr_output_count_(0),
+        output_every_num_(1),
+        binary_log_(false),
+        snapshot_period_s_(30.0),
+        last_sequence_number_(0),
+        last_stamp_ns_(0) {
     receiver_.reset(new DsgReceiver(nh_));
     if (!nh_.getParam("output_path", output_path_)) {
       ROS_FATAL("Failed to get output path parameter");
@@ -50,6 +59,66 @@ struct SceneGraphLoggerNode {
     }
 
     nh_.getParam("output_every_num", output_every_num_);
+    nh_.getParam("binary_log", binary_log_);
+    if (binary_log_) {
+      setupBinaryLog();
+    }
+  }
+
+  void setupBinaryLog() {
+    nh_.getParam("snapshot_period_s", snapshot_period_s_);
+
+    std::string codec_name = "none";
+    nh_.getParam("snapshot_codec", codec_name);
+    auto codec = codecFromString(codec_name);
+    if (!codec) {
+      ROS_ERROR_STREAM("Unknown snapshot codec '" << codec_name
+                                                  << "'. Writing uncompressed");
+      codec = DsgCodec::NONE;
+    }
+
+    int compression_level = 0;
+    nh_.getParam("snapshot_compression_level", compression_level);
+
+    const auto log_path = output_path_ + "/dsg.log";
+    log_.reset(new DsgLogWriter(log_path, *codec, compression_level));
+    if (!log_->valid()) {
+      ROS_FATAL_STREAM("Failed to open scene graph log at " << log_path);
+      throw std::runtime_error("failed to open scene graph log");
+    }
+
+    // updates are logged as received; the receiver graph is only used for snapshots
+    sub_ = nh_.subscribe("dsg", 100, &SceneGraphLoggerNode::handleUpdate, this);
+  }
+
+  void handleUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg) {
+    if (!log_->writeUpdate(*msg)) {
+      return;
+    }
+
+    last_sequence_number_ = msg->sequence_number;
+    last_stamp_ns_ = msg->header.stamp.toNSec();
+    if (msg->full_update) {
+      last_keyframe_ns_ = last_stamp_ns_;
+    }
+  }
+
+  void writeSnapshot() {
+    // the receiver may have dropped the latest update if it fell behind
+    if (receiver_->sequenceNumber() != last_sequence_number_) {
+      return;
+    }
+
+    const double elapsed_s =
+        last_keyframe_ns_ ? (last_stamp_ns_ - *last_keyframe_ns_) * 1.0e-9 : 0.0;
+    if (last_keyframe_ns_ && elapsed_s < snapshot_period_s_) {
+      return;
+    }
+
+    const auto graph = receiver_->graph();
+    if (log_->writeSnapshot(*graph, last_stamp_ns_, last_sequence_number_)) {
+      last_keyframe_ns_ = last_stamp_ns_;
+    }
   }
 
   void spin() {
@@ -63,8 +132,13 @@ struct SceneGraphLoggerNode {
       }
 
       receiver_->clearUpdated();
+      if (binary_log_) {
+        writeSnapshot();
+        continue;
+      }
+
       ++curr_count_;
-      if (output_every_num_ == 1 || curr_count_ % output_every_num_ != 1) {
+      if (output_every_num_ > 1 && curr_count_ % output_every_num_ != 1) {
         continue;
       }
 
@@ -83,6 +157,14 @@ struct SceneGraphLoggerNode {
   int output_every_num_;
   std::string output_path_;
   std::unique_ptr<DsgReceiver> receiver_;
+
+  bool binary_log_;
+  double snapshot_period_s_;
+  ros::Subscriber sub_;
+  std::unique_ptr<DsgLogWriter> log_;
+  int64_t last_sequence_number_;
+  uint64_t last_stamp_ns_;
+  std::optional<uint64_t> last_keyframe_ns_;
 };
 
 }  // namespace hydra
@@ -0,0 +1,195 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "hydra_ros/utils/dsg_log.h"
+#include "hydra_ros/utils/dsg_streaming_interface.h"
+
+namespace hydra {
+
+using Clock = std::chrono::steady_clock;
+
+struct ReplayStats {
+  size_t num_records = 0;
+  size_t num_skipped = 0;
+  size_t num_bytes = 0;
+  double decode_s = 0.0;
+  double publish_s = 0.0;
+
+  void report(double elapsed_s) const {
+    const size_t num_published = num_records - num_skipped;
+    const double mb = num_bytes / (1024.0 * 1024.0);
+    const double decode_rate = decode_s > 0.0 ? num_records / decode_s : 0.0;
+    const double decode_mb_rate = decode_s > 0.0 ? mb / decode_s : 0.0;
+    const double publish_rate = publish_s > 0.0 ? num_published / publish_s : 0.0;
+    ROS_INFO_STREAM("Replayed " << num_records << " records (" << num_skipped
+                                << " skipped) in " << elapsed_s
+                                << " s. Decode: " << decode_rate << " records/s, "
+                                << decode_mb_rate << " MB/s. Publish: " << publish_rate
+                                << " graphs/s");
+  }
+};
+
+struct SceneGraphReplayNode {
+  SceneGraphReplayNode(const ros::NodeHandle& nh)
+      : nh_(nh),
+        rate_(1.0),
+        start_time_s_(0.0),
+        report_period_s_(5.0),
+        loop_(false) {
+    if (!nh_.getParam("log_path", log_path_)) {
+      ROS_FATAL("Failed to get log path parameter");
+      throw std::runtime_error("failed to get log path");
+    }
+
+    std::string frame_id = "world";
+    nh_.getParam("frame_id", frame_id);
+    nh_.getParam("rate", rate_);
+    nh_.getParam("start_time_s", start_time_s_);
+    nh_.getParam("report_period_s", report_period_s_);
+    nh_.getParam("loop", loop_);
+
+    reader_.reset(new DsgLogReader(log_path_));
+    if (!reader_->valid() || reader_->records().empty()) {
+      ROS_FATAL_STREAM("Failed to read scene graph log at " << log_path_);
+      throw std::runtime_error("failed to read scene graph log");
+    }
+
+    sender_.reset(new DsgSender(nh_, frame_id, "replay"));
+  }
+
+  //! Replay the log once; returns false if interrupted
+  bool replay() {
+    const auto& records = reader_->records();
+    const uint64_t start_ns =
+        records.front().timestamp_ns + static_cast<uint64_t>(start_time_s_ * 1.0e9);
+
+    ReplayStats stats;
+    size_t index = 0;
+    auto decode_start = Clock::now();
+    auto state = reader_->seek(start_ns, &index);
+    stats.decode_s += elapsedSeconds(decode_start);
+    if (state.graph) {
+      publish(state, stats);
+    }
+
+    const auto wall_start = Clock::now();
+    auto last_report = wall_start;
+    const uint64_t log_start_ns = std::max(start_ns, state.timestamp_ns);
+    for (; index < records.size(); ++index) {
+      if (!ros::ok()) {
+        return false;
+      }
+
+      const auto& record = records[index];
+      if (rate_ > 0.0 && record.timestamp_ns > log_start_ns) {
+        const double offset_s = (record.timestamp_ns - log_start_ns) * 1.0e-9 / rate_;
+        std::this_thread::sleep_until(
+            wall_start + std::chrono::duration_cast<Clock::duration>(
+                             std::chrono::duration<double>(offset_s)));
+      }
+
+      ++stats.num_records;
+      stats.num_bytes += record.size;
+      decode_start = Clock::now();
+      const bool applied = reader_->apply(index, state);
+      stats.decode_s += elapsedSeconds(decode_start);
+      if (!applied) {
+        ++stats.num_skipped;
+        continue;
+      }
+
+      publish(state, stats);
+      if (report_period_s_ > 0.0 && elapsedSeconds(last_report) >= report_period_s_) {
+        stats.report(elapsedSeconds(wall_start));
+        last_report = Clock::now();
+      }
+    }
+
+    stats.report(elapsedSeconds(wall_start));
+    return true;
+  }
+
+  void publish(const DsgLogReader::State& state, ReplayStats& stats) const {
+    ros::Time stamp;
+    stamp.fromNSec(state.timestamp_ns);
+    const auto publish_start = Clock::now();
+    sender_->sendGraph(*state.graph, stamp);
+    stats.publish_s += elapsedSeconds(publish_start);
+  }
+
+  void spin() {
+    // the sender services resync requests and GetDsg calls in the background
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+
+    ROS_INFO_STREAM("Replaying " << reader_->records().size() << " records from "
+                                 << log_path_ << " at "
+                                 << (rate_ > 0.0 ? std::to_string(rate_) + "x"
+                                                 : std::string("max rate")));
+    while (replay() && loop_) {
+    }
+  }
+
+  static double elapsedSeconds(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  ros::NodeHandle nh_;
+  std::string log_path_;
+  //! playback speed relative to the recording (values <= 0 replay as fast as possible)
+  double rate_;
+  double start_time_s_;
+  double report_period_s_;
+  bool loop_;
+  std::unique_ptr<DsgLogReader> reader_;
+  std::unique_ptr<DsgSender> sender_;
+};
+
+}  // namespace hydra
+
+int main(int argc, char** argv) {
+  ros::init(argc, argv, "scene_graph_replay_node");
+
+  ros::NodeHandle nh("~");
+  hydra::SceneGraphReplayNode node(nh);
+  node.spin();
+
+  return 0;
+}
@@ -52,19 +52,43 @@
 #include <glog/logging.h>
 #include <pose_graph_tools_ros/conversions.h>
 
+#include "hydra_ros/utils/metrics.h"
+
 namespace hydra {
 
 using PoseGraphMsg = pose_graph_tools_msgs::PoseGraph;
 
+namespace {
+
+DropPolicy getDropPolicy(const std::string& policy) {
+  if (policy == "drop_oldest") {
+    return DropPolicy::DROP_OLDEST;
+  }
+
+  return policy == "drop_newest" ? DropPolicy::DROP_NEWEST : DropPolicy::BLOCK;
+}
+
+}  // namespace
+
 void declare_config(RosPoseGraphTracker::Config& config) {
   using namespace config;
   name("RosPoseGraphTracker");
   field(config.ns, "ns");
   field(config.queue_size, "queue_size");
+  field(config.max_pending, "max_pending");
+  field(config.drop_policy, "drop_policy");
+
+  checkCondition(config.max_pending > 0, "max_pending must be positive");
+  checkCondition(config.drop_policy == "block" || config.drop_policy == "drop_oldest" ||
+                     config.drop_policy == "drop_newest",
+                 "drop_policy must be 'block', 'drop_oldest' or 'drop_newest'");
 }
 
 RosPoseGraphTracker::RosPoseGraphTracker(const Config& config)
-    : config(config::checkValid(config)), nh_(config.ns) {
+    : config(config::checkValid(config)),
+      nh_(config.ns),
+      pose_graphs_(config.max_pending, getDropPolicy(config.drop_policy)),
+      external_priors_(1, DropPolicy::DROP_OLDEST) {
   odom_sub_ = nh_.subscribe(
       "pose_graph", config.queue_size, &RosPoseGraphTracker::odomCallback, this);
   prior_sub_ = nh_.subscribe("agent_node_measurements",
@@ -73,17 +97,26 @@ RosPoseGraphTracker::RosPoseGraphTracker(const Config& config)
                              this);
 }
 
+RosPoseGraphTracker::~RosPoseGraphTracker() {
+  // nothing consumes pose graphs anymore, so a blocked callback has to give up
+  pose_graphs_.close();
+  odom_sub_.shutdown();
+  prior_sub_.shutdown();
+}
+
 // Return pose graphs and priors received from Kimera since the last call
 PoseGraphPacket RosPoseGraphTracker::update(uint64_t, const Eigen::Isometry3d&) {
-  std::unique_lock<std::mutex> lock(mutex_);
-
   PoseGraphPacket packet;
-  packet.pose_graphs = std::move(pose_graphs_);
-  // NOTE(lschmid): Move assignments should leave vectors empty but could be
-  // implementation dependent so we play it safe.
-  pose_graphs_.clear();
-  packet.external_priors = external_priors_;
-  external_priors_.reset();
+  packet.pose_graphs.reserve(pose_graphs_.size());
+  while (auto pose_graph = pose_graphs_.pop()) {
+    packet.pose_graphs.push_back(std::move(*pose_graph));
+  }
+
+  auto priors = external_priors_.pop();
+  if (priors) {
+    packet.external_priors = std::move(*priors);
+  }
+
   return packet;
 }
 
@@ -93,15 +126,20 @@ void RosPoseGraphTracker::odomCallback(const PoseGraphMsg& msg) {
     return;
   }
 
-  std::unique_lock<std::mutex> lock(mutex_);
-  pose_graphs_.push_back(
+  const auto pushed = pose_graphs_.push(
       std::make_shared<pose_graph_tools::PoseGraph>(pose_graph_tools::fromMsg(msg)));
+  if (!pushed) {
+    // drop_oldest drops a queued graph, the other policies drop this one
+    MetricsRegistry::instance().addCount("pose_graph_tracker/dropped");
+    LOG(WARNING) << "[RosPoseGraphTracker] Dropped pose graph ("
+                 << pose_graphs_.numDropped() << " total) with policy '"
+                 << config.drop_policy << "'";
+  }
 }
 
 void RosPoseGraphTracker::priorCallback(const PoseGraphMsg& msg) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  external_priors_ =
-      std::make_shared<pose_graph_tools::PoseGraph>(pose_graph_tools::fromMsg(msg));
+  external_priors_.push(
+      std::make_shared<pose_graph_tools::PoseGraph>(pose_graph_tools::fromMsg(msg)));
 }
 
 }  // namespace hydra
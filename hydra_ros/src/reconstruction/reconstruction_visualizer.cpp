@@ -40,8 +40,10 @@
 #include <hydra/common/global_info.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include "hydra_ros/visualizer/chunked_marker_cache.h"
 #include "hydra_ros/visualizer/colormap_utilities.h"
 #include "hydra_ros/visualizer/gvd_visualization_utilities.h"
+#include "hydra_ros/visualizer/voxel_cloud.h"
 
 namespace hydra {
 
@@ -49,9 +51,6 @@ using visualization_msgs::Marker;
 using visualization_msgs::MarkerArray;
 using VizConfig = ReconstructionVisualizer::Config;
 
-using ColorFunction =
-    std::function<std_msgs::ColorRGBA(const VizConfig&, const TsdfVoxel&)>;
-
 std_msgs::ColorRGBA colorVoxelByDist(const VizConfig& config, const TsdfVoxel& voxel) {
   double ratio =
       dsg_utils::computeRatio(config.min_distance, config.max_distance, voxel.distance);
@@ -68,27 +67,9 @@ std_msgs::ColorRGBA colorVoxelByWeight(const VizConfig& config,
   return dsg_utils::makeColorMsg(color, config.marker_alpha);
 }
 
-// adapted from khronos
-Marker makeTsdfMarker(const VizConfig& config,
-                      const std_msgs::Header& header,
-                      const TsdfLayer& layer,
-                      const Eigen::Isometry3d& world_T_sensor,
-                      const ColorFunction& color_func,
-                      const std::string& ns) {
-  Marker msg;
-  msg.header = header;
-  msg.action = visualization_msgs::Marker::ADD;
-  msg.id = 0;
-  msg.ns = ns;
-  msg.type = visualization_msgs::Marker::CUBE_LIST;
-  msg.scale.x = layer.voxel_size;
-  msg.scale.y = layer.voxel_size;
-  msg.scale.z = layer.voxel_size;
-
-  Eigen::Vector3d identity_pos = Eigen::Vector3d::Zero();
-  tf2::convert(identity_pos, msg.pose.position);
-  tf2::convert(Eigen::Quaterniond::Identity(), msg.pose.orientation);
-
+TsdfSlice getTsdfSlice(const VizConfig& config,
+                       const TsdfLayer& layer,
+                       const Eigen::Isometry3d& world_T_sensor) {
   auto height = config.slice_height;
   if (config.use_relative_height) {
     height += world_T_sensor.translation().z();
@@ -100,29 +81,49 @@ Marker makeTsdfMarker(const VizConfig& config,
       spatial_hash::originPointFromIndex(slice_index, layer.blockSize());
   const auto grid_index = spatial_hash::indexFromPoint<VoxelIndex>(
       slice_pos - origin, layer.voxel_size_inv);
+  return {slice_index.z(), grid_index.z()};
+}
 
-  for (const auto& block : layer) {
-    if (block.index.z() != slice_index.z()) {
-      continue;
-    }
+void addTsdfSliceVoxels(const VizConfig& config,
+                        const TsdfSlice& slice,
+                        const TsdfBlock& block,
+                        const TsdfColorFunction& color_func,
+                        Marker& msg) {
+  if (block.index.z() != slice.block_z) {
+    return;
+  }
 
-    for (size_t x = 0; x < block.voxels_per_side; ++x) {
-      for (size_t y = 0; y < block.voxels_per_side; ++y) {
-        const VoxelIndex voxel_index(x, y, grid_index.z());
-        const auto& voxel = block.getVoxel(voxel_index);
-        if (voxel.weight < config.min_observation_weight) {
-          continue;
-        }
-
-        const Eigen::Vector3d pos =
-            block.getVoxelPosition(voxel_index).cast<double>();
-        geometry_msgs::Point marker_pos;
-        tf2::convert(pos, marker_pos);
-        msg.points.push_back(marker_pos);
-        msg.colors.push_back(color_func(config, voxel));
+  for (size_t x = 0; x < block.voxels_per_side; ++x) {
+    for (size_t y = 0; y < block.voxels_per_side; ++y) {
+      const VoxelIndex voxel_index(x, y, slice.voxel_z);
+      const auto& voxel = block.getVoxel(voxel_index);
+      if (voxel.weight < config.min_observation_weight) {
+        continue;
       }
+
+      const Eigen::Vector3d pos = block.getVoxelPosition(voxel_index).cast<double>();
+      geometry_msgs::Point marker_pos;
+      tf2::convert(pos, marker_pos);
+      msg.points.push_back(marker_pos);
+      msg.colors.push_back(color_func(config, voxel));
     }
   }
+}
+
+// adapted from khronos
+Marker makeTsdfMarker(const VizConfig& config,
+                      const std_msgs::Header& header,
+                      const TsdfLayer& layer,
+                      const Eigen::Isometry3d& world_T_sensor,
+                      const TsdfColorFunction& color_func,
+                      const std::string& ns) {
+  Marker msg = makeVoxelMarker(layer.voxel_size, ns);
+  msg.header = header;
+
+  const auto slice = getTsdfSlice(config, layer, world_T_sensor);
+  for (const auto& block : layer) {
+    addTsdfSliceVoxels(config, slice, block, color_func, msg);
+  }
 
   return msg;
 }
@@ -139,6 +140,8 @@ void declare_config(ReconstructionVisualizer::Config& config) {
   field(config.use_relative_height, "use_relative_height");
   field(config.slice_height, "slice_height", "m");
   field(config.min_observation_weight, "min_observation_weight");
+  field(config.use_pointcloud, "use_pointcloud");
+  field(config.chunks, "chunks");
   field(config.colors.min_hue, "min_hue");
   field(config.colors.max_hue, "max_hue");
   field(config.colors.min_luminance, "min_luminance");
@@ -150,6 +153,8 @@ void declare_config(ReconstructionVisualizer::Config& config) {
 ReconstructionVisualizer::ReconstructionVisualizer(const Config& config)
     : config_(config), nh_(config.ns) {
   pubs_.reset(new MarkerGroupPub(nh_));
+  distance_chunks_.reset(new ChunkedMarkerCache(config_.chunks));
+  weight_chunks_.reset(new ChunkedMarkerCache(config_.chunks));
 }
 
 ReconstructionVisualizer::~ReconstructionVisualizer() {}
@@ -168,6 +173,51 @@ void ReconstructionVisualizer::call(uint64_t timestamp_ns,
   header.frame_id = GlobalInfo::instance().getFrames().map;
   header.stamp.fromNSec(timestamp_ns);
 
+  if (config_.use_pointcloud) {
+    const auto publish_cloud = [&](const std::string& topic,
+                                   const TsdfColorFunction& color_func,
+                                   const std::string& ns) {
+      pubs_->publish(topic, [&](sensor_msgs::PointCloud2& msg) {
+        const auto marker =
+            makeTsdfMarker(config_, header, tsdf, world_T_sensor, color_func, ns);
+        msg = makeVoxelCloud(marker);
+        return msg.width > 0;
+      });
+    };
+
+    publish_cloud("tsdf_viz_cloud", colorVoxelByDist, "tsdf_distance_slice");
+    publish_cloud("tsdf_weight_viz_cloud", colorVoxelByWeight, "tsdf_weight_slice");
+    return;
+  }
+
+  if (config_.chunks.enable) {
+    const auto slice = getTsdfSlice(config_, tsdf, world_T_sensor);
+    // the voxels in a chunk change without any block updates if the slice moves
+    const bool slice_changed = !last_slice_ || last_slice_->block_z != slice.block_z ||
+                               last_slice_->voxel_z != slice.voxel_z;
+    last_slice_ = slice;
+
+    publishChunks("tsdf_viz",
+                  header,
+                  tsdf,
+                  world_T_sensor,
+                  slice,
+                  colorVoxelByDist,
+                  "tsdf_distance_slice",
+                  *distance_chunks_,
+                  slice_changed);
+    publishChunks("tsdf_weight_viz",
+                  header,
+                  tsdf,
+                  world_T_sensor,
+                  slice,
+                  colorVoxelByWeight,
+                  "tsdf_weight_slice",
+                  *weight_chunks_,
+                  slice_changed);
+    return;
+  }
+
   pubs_->publish("tsdf_viz", [&](Marker& msg) {
     msg = makeTsdfMarker(
         config_, header, tsdf, world_T_sensor, colorVoxelByDist, "tsdf_distance_slice");
@@ -192,4 +242,28 @@ void ReconstructionVisualizer::call(uint64_t timestamp_ns,
   });
 }
 
+void ReconstructionVisualizer::publishChunks(const std::string& topic,
+                                             const std_msgs::Header& header,
+                                             const TsdfLayer& tsdf,
+                                             const Eigen::Isometry3d& world_T_sensor,
+                                             const TsdfSlice& slice,
+                                             const TsdfColorFunction& color_func,
+                                             const std::string& ns,
+                                             ChunkedMarkerCache& chunks,
+                                             bool force) const {
+  chunks.setNumSubscribers(pubs_->numSubscribers(topic));
+  pubs_->publish(topic, [&](MarkerArray& msg) {
+    msg = chunks.update<TsdfBlock>(
+        header,
+        tsdf,
+        world_T_sensor.translation(),
+        makeVoxelMarker(tsdf.voxel_size, ns),
+        [&](const TsdfBlock& block, Marker& marker) {
+          addTsdfSliceVoxels(config_, slice, block, color_func, marker);
+        },
+        force);
+    return !msg.markers.empty();
+  });
+}
+
 }  // namespace hydra
@@ -0,0 +1,348 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/bag_metadata.h"
+
+#include <glog/logging.h>
+#include <ros/serialization.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <tf2_msgs/TFMessage.h>
+
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace hydra {
+
+namespace {
+
+inline constexpr uint32_t kMetadataVersion = 1;
+
+template <typename T>
+void writeMessage(std::ofstream& out, const T& msg) {
+  const uint32_t size = ros::serialization::serializationLength(msg);
+  std::vector<uint8_t> buffer(size);
+  ros::serialization::OStream stream(buffer.data(), size);
+  ros::serialization::serialize(stream, msg);
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out.write(reinterpret_cast<const char*>(buffer.data()), size);
+}
+
+template <typename T>
+bool readMessage(std::ifstream& in, T& msg) {
+  uint32_t size = 0;
+  in.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (!in) {
+    return false;
+  }
+
+  std::vector<uint8_t> buffer(size);
+  in.read(reinterpret_cast<char*>(buffer.data()), size);
+  if (!in) {
+    return false;
+  }
+
+  try {
+    ros::serialization::IStream stream(buffer.data(), size);
+    ros::serialization::deserialize(stream, msg);
+  } catch (const ros::Exception& e) {
+    LOG(WARNING) << "Invalid message in metadata cache: " << e.what();
+    return false;
+  }
+
+  return true;
+}
+
+std::filesystem::path normalize(const std::filesystem::path& bag_path) {
+  return std::filesystem::absolute(bag_path).lexically_normal();
+}
+
+struct LoadedMetadata {
+  std::mutex mutex;
+  //! Metadata per bag, shared with every caller that asks while the bag is scanned
+  std::map<std::filesystem::path, std::shared_future<BagMetadata::Ptr>> metadata;
+
+  static LoadedMetadata& instance() {
+    static LoadedMetadata loaded;
+    return loaded;
+  }
+};
+
+bool isCurrent(const std::filesystem::path& cache_path,
+               const std::filesystem::path& bag_path) {
+  std::error_code ec;
+  if (!std::filesystem::exists(cache_path, ec)) {
+    return false;
+  }
+
+  return std::filesystem::last_write_time(cache_path, ec) >=
+         std::filesystem::last_write_time(bag_path, ec);
+}
+
+BagMetadata::Ptr extract(const std::filesystem::path& bag_path,
+                         const std::filesystem::path& cache_dir) {
+  const bool use_disk_cache = !cache_dir.empty();
+  const auto cache_path = use_disk_cache ? BagMetadata::cachePath(bag_path, cache_dir)
+                                         : std::filesystem::path();
+  if (use_disk_cache && isCurrent(cache_path, bag_path)) {
+    BagMetadata::Ptr metadata = BagMetadata::load(cache_path);
+    if (metadata) {
+      LOG(INFO) << "Loaded bag metadata from " << cache_path;
+      return metadata;
+    }
+  }
+
+  LOG(INFO) << "Extracting metadata from " << bag_path;
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+  auto metadata = std::make_shared<const BagMetadata>(bag);
+  bag.close();
+
+  if (use_disk_cache) {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir, ec);
+    if (ec || !metadata->save(cache_path)) {
+      LOG(WARNING) << "Unable to save bag metadata to " << cache_path;
+    }
+  }
+
+  return metadata;
+}
+
+}  // namespace
+
+BagMetadata::BagMetadata(const rosbag::Bag& bag) {
+  // only tf and camera info connections are read, so images are skipped entirely
+  rosbag::View view(
+      bag,
+      rosbag::TypeQuery(
+          std::vector<std::string>{"tf2_msgs/TFMessage", "sensor_msgs/CameraInfo"}));
+  bool have_tf = false;
+  for (const auto& m : view) {
+    const auto& topic = m.getTopic();
+    if (m.isType<sensor_msgs::CameraInfo>()) {
+      if (!camera_infos.count(topic)) {
+        const auto msg = m.instantiate<sensor_msgs::CameraInfo>();
+        if (msg) {
+          camera_infos.emplace(topic, *msg);
+        }
+      }
+
+      continue;
+    }
+
+    const bool is_static = topic == "/tf_static";
+    if (!is_static && topic != "/tf") {
+      continue;
+    }
+
+    const auto msg = m.instantiate<tf2_msgs::TFMessage>();
+    if (!msg) {
+      LOG(ERROR) << "Found invalid message on '" << topic << "'";
+      continue;
+    }
+
+    if (!have_tf) {
+      tf_begin = m.getTime();
+      have_tf = true;
+    }
+
+    tf_end = m.getTime();
+    auto& output = is_static ? static_transforms : transforms;
+    output.insert(output.end(), msg->transforms.begin(), msg->transforms.end());
+  }
+
+  VLOG(1) << "Extracted " << transforms.size() << " transforms, "
+          << static_transforms.size() << " static transforms and "
+          << camera_infos.size() << " camera info topics from " << bag.getFileName();
+}
+
+BagMetadata::Ptr BagMetadata::get(const std::filesystem::path& bag_path,
+                                  const std::filesystem::path& cache_dir) {
+  // metadata is kept for the lifetime of the process (or until clearLoaded), so
+  // consumers that run one after the other still only scan the bag once
+  auto& loaded = LoadedMetadata::instance();
+  const auto key = normalize(bag_path);
+  std::promise<Ptr> promise;
+  std::shared_future<Ptr> pending;
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(loaded.mutex);
+    auto iter = loaded.metadata.find(key);
+    if (iter != loaded.metadata.end()) {
+      pending = iter->second;
+    } else {
+      loaded.metadata.emplace(key, promise.get_future().share());
+    }
+  }  // end critical section
+
+  // later callers wait for the first one without blocking requests for other bags
+  if (pending.valid()) {
+    return pending.get();
+  }
+
+  // only the first caller for a bag scans it, without holding the global lock
+  try {
+    auto metadata = extract(bag_path, cache_dir);
+    promise.set_value(metadata);
+    return metadata;
+  } catch (...) {
+    {  // start critical section
+      std::lock_guard<std::mutex> lock(loaded.mutex);
+      loaded.metadata.erase(key);
+    }  // end critical section
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+}
+
+void BagMetadata::clearLoaded() {
+  auto& loaded = LoadedMetadata::instance();
+  std::lock_guard<std::mutex> lock(loaded.mutex);
+  loaded.metadata.clear();
+}
+
+std::filesystem::path BagMetadata::cachePath(const std::filesystem::path& bag_path,
+                                             const std::filesystem::path& cache_dir) {
+  // bags with the same name in different directories get different cache files
+  const auto hash = std::hash<std::string>()(normalize(bag_path).string());
+  std::stringstream ss;
+  ss << bag_path.filename().string() << "." << std::hex << std::setw(16)
+     << std::setfill('0') << hash << ".metadata";
+  return cache_dir / ss.str();
+}
+
+bool BagMetadata::save(const std::filesystem::path& filepath) const {
+  // write to a temporary file so readers never see a partial cache
+  auto tmp_path = filepath;
+  tmp_path += ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out) {
+      return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&kMetadataVersion),
+              sizeof(kMetadataVersion));
+    const uint64_t times[2] = {tf_begin.toNSec(), tf_end.toNSec()};
+    out.write(reinterpret_cast<const char*>(times), sizeof(times));
+
+    tf2_msgs::TFMessage msg;
+    msg.transforms = transforms;
+    writeMessage(out, msg);
+    msg.transforms = static_transforms;
+    writeMessage(out, msg);
+
+    const uint64_t num_infos = camera_infos.size();
+    out.write(reinterpret_cast<const char*>(&num_infos), sizeof(num_infos));
+    for (const auto& [topic, info] : camera_infos) {
+      const uint64_t size = topic.size();
+      out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+      out.write(topic.data(), size);
+      writeMessage(out, info);
+    }
+
+    if (!out) {
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, filepath, ec);
+  return !ec;
+}
+
+std::unique_ptr<BagMetadata> BagMetadata::load(const std::filesystem::path& filepath) {
+  std::ifstream in(filepath, std::ios::binary);
+  if (!in) {
+    return nullptr;
+  }
+
+  uint32_t version = 0;
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  if (!in || version != kMetadataVersion) {
+    LOG(WARNING) << "Ignoring bag metadata " << filepath << " with unknown version";
+    return nullptr;
+  }
+
+  std::unique_ptr<BagMetadata> metadata(new BagMetadata());
+  uint64_t times[2];
+  in.read(reinterpret_cast<char*>(times), sizeof(times));
+  metadata->tf_begin.fromNSec(times[0]);
+  metadata->tf_end.fromNSec(times[1]);
+
+  tf2_msgs::TFMessage msg;
+  if (!readMessage(in, msg)) {
+    return nullptr;
+  }
+
+  metadata->transforms = std::move(msg.transforms);
+  if (!readMessage(in, msg)) {
+    return nullptr;
+  }
+
+  metadata->static_transforms = std::move(msg.transforms);
+
+  uint64_t num_infos = 0;
+  in.read(reinterpret_cast<char*>(&num_infos), sizeof(num_infos));
+  for (uint64_t i = 0; in && i < num_infos; ++i) {
+    uint64_t size = 0;
+    in.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!in || size > 4096) {
+      return nullptr;
+    }
+
+    std::string topic(size, '\0');
+    in.read(topic.data(), size);
+    if (!readMessage(in, metadata->camera_infos[topic])) {
+      return nullptr;
+    }
+  }
+
+  if (!in) {
+    LOG(WARNING) << "Ignoring truncated bag metadata " << filepath;
+    return nullptr;
+  }
+
+  return metadata;
+}
+
+const sensor_msgs::CameraInfo* BagMetadata::cameraInfo(const std::string& topic) const {
+  const auto iter = camera_infos.find(topic);
+  return iter == camera_infos.end() ? nullptr : &iter->second;
+}
+
+}  // namespace hydra
@@ -45,13 +45,27 @@
 #include <hydra/input/camera.h>
 #include <hydra/input/input_packet.h>
 #include <hydra/input/input_conversion.h>
+#include <hydra/utils/timing_utilities.h>
 #include <message_filters/sync_policies/approximate_time.h>
 #include <rosbag/bag.h>
 #include <rosbag/view.h>
 #include <sensor_msgs/CameraInfo.h>
 #include <sensor_msgs/CompressedImage.h>
-
+#include <sensor_msgs/image_encodings.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "hydra_ros/utils/bag_metadata.h"
+#include "hydra_ros/utils/compressed_image.h"
+#include "hydra_ros/utils/ordered_worker_pool.h"
+#include "hydra_ros/utils/owned_image.h"
+#include "hydra_ros/utils/parallel_for.h"
 #include "hydra_ros/utils/pose_cache.h"
+#include "hydra_ros/utils/stamp_synchronizer.h"
+#include "hydra_ros/utils/timestamp_merger.h"
 
 namespace hydra {
 
@@ -67,37 +81,234 @@ void declare_config(BagConfig& config) {
   field(config.depth_topic, "depth_topic");
   field(config.start, "start");
   field(config.duration, "duration");
+  field(config.color_compressed, "color_compressed");
   field(config.sensor, "sensor");
   field(config.sensor_frame, "sensor_frame");
   field(config.world_frame, "world_frame");
+  field(config.index_trajectory, "index_trajectory");
+  field<Path>(config.metadata_cache_dir, "metadata_cache_dir");
+  field(config.sinks, "sinks");
   check(config.color_topic, NE, "", "color_topic");
   check(config.depth_topic, NE, "", "depth_topic");
   check<Path::Exists>(config.bag_path, "bag_path");
 }
 
-sensor_msgs::Image::ConstPtr getImageMessage(const rosbag::MessageInstance& m) {
-  const auto raw = m.instantiate<sensor_msgs::Image>();
-  if (raw) {
-    // no need to do anything special with normal image
-    return raw;
+struct BagImage {
+  bool is_color = false;
+  ros::Time time;
+  sensor_msgs::Image::ConstPtr raw;
+  sensor_msgs::CompressedImage::ConstPtr compressed;
+};
+
+bool readImageMessage(const BagConfig& config,
+                      const rosbag::MessageInstance& m,
+                      BagImage& image) {
+  image.is_color = m.getTopic() == config.color_topic;
+  image.time = m.getTime();
+  // avoid a failed instantiation attempt for topics that are known to be compressed
+  const bool expect_compressed = image.is_color && config.color_compressed;
+  if (!expect_compressed) {
+    image.raw = m.instantiate<sensor_msgs::Image>();
+    if (image.raw) {
+      // no need to do anything special with normal image
+      return true;
+    }
+  }
+
+  image.compressed = m.instantiate<sensor_msgs::CompressedImage>();
+  if (image.compressed) {
+    return true;
   }
 
-  auto msg = m.instantiate<sensor_msgs::CompressedImage>();
-  if (!msg) {
-    LOG(ERROR) << "Unable to parse image from '" << m.getTopic() << "'";
-    return nullptr;
+  if (expect_compressed) {
+    image.raw = m.instantiate<sensor_msgs::Image>();
+  }
+
+  LOG_IF(ERROR, !image.raw) << "Unable to parse image from '" << m.getTopic() << "'";
+  return image.raw != nullptr;
+}
+
+//! Decoder state shared by all frames of a bag
+struct DecodeHints {
+  DecodeShapeHint color;
+  DecodeShapeHint depth;
+};
+
+void decodeImage(BagImage& image, DecodeHints& hints) {
+  if (image.raw || !image.compressed) {
+    return;
   }
 
-  const auto cv_ptr = cv_bridge::toCvCopy(msg);
-  return cv_ptr->toImageMsg();
+  // decode straight into the message handed to the sync to avoid a copy
+  timing::ScopedTimer timer("bag_reader/decode", image.time.toNSec());
+  auto& hint = image.is_color ? hints.color : hints.depth;
+  image.raw = decodeCompressedImage(*image.compressed, &hint);
+  image.compressed.reset();
+}
+
+template <typename Callback>
+void forEachImage(const rosbag::Bag& bag,
+                  const BagConfig& bag_config,
+                  const Callback& callback,
+                  const std::atomic<bool>* stop = nullptr) {
+  const std::vector<std::string> topics{bag_config.color_topic,
+                                        bag_config.depth_topic};
+
+  // the bag index gives the time range without reading any messages
+  const rosbag::View full_view(bag, rosbag::TopicQuery(topics));
+  if (full_view.size() == 0) {
+    LOG(WARNING) << "No messages on '" << bag_config.color_topic << "' or '"
+                 << bag_config.depth_topic << "'";
+    return;
+  }
+
+  ros::Time start = full_view.getBeginTime();
+  if (bag_config.start >= 0.0) {
+    start += ros::Duration(bag_config.start);
+  }
+
+  ros::Time end = ros::TIME_MAX;
+  if (bag_config.duration >= 0.0) {
+    end = start + ros::Duration(bag_config.duration);
+  }
+
+  // only messages within [start, end] are read from the bag
+  rosbag::View view(bag, rosbag::TopicQuery(topics), start, end);
+  VLOG(1) << "Reading " << view.size() << " of " << full_view.size()
+          << " messages from bag";
+  for (const auto& m : view) {
+    if (stop && *stop) {
+      LOG(INFO) << "Stopped reading bag";
+      return;
+    }
+
+    BagImage image;
+    bool valid = false;
+    {  // only time reading and deserializing the message
+      timing::ScopedTimer timer("bag_reader/read", m.getTime().toNSec());
+      valid = readImageMessage(bag_config, m, image);
+    }
+
+    if (!valid) {
+      continue;
+    }
+
+    VLOG(10) << "new " << m.getTopic() << " @ " << m.getTime().toNSec();
+    callback(image);
+  }
+
+  LOG_IF(INFO, bag_config.duration >= 0.0)
+      << "Reached end of duration: " << bag_config.duration << " [s]";
+}
+
+std::string getWorldFrame(const BagConfig& config) {
+  return !config.world_frame.empty() ? config.world_frame
+                                     : GlobalInfo::instance().getFrames().odom;
+}
+
+std::string getSensorFrame(const rosbag::Bag& bag, const BagConfig& config) {
+  if (!config.sensor_frame.empty()) {
+    return config.sensor_frame;
+  }
+
+  const std::vector<std::string> topics{config.color_topic};
+  rosbag::View view(bag, rosbag::TopicQuery(topics));
+  for (const auto& m : view) {
+    BagImage image;
+    if (!readImageMessage(config, m, image)) {
+      continue;
+    }
+
+    return image.raw ? image.raw->header.frame_id : image.compressed->header.frame_id;
+  }
+
+  return "";
+}
+
+std::filesystem::path getTrajectoryPath(const BagConfig& config,
+                                        const std::string& world_frame,
+                                        const std::string& sensor_frame) {
+  auto name = world_frame + "_T_" + sensor_frame;
+  std::replace(name.begin(), name.end(), '/', '_');
+  auto path = config.bag_path;
+  path += "." + name + ".poses";
+  return path;
+}
+
+std::string getSensorFrame(const BagConfig& config, const Image& color_msg) {
+  return !config.sensor_frame.empty() ? config.sensor_frame : color_msg.header.frame_id;
+}
+
+bool isKeyframe(KeyframeSelector& selector,
+                const BagConfig& config,
+                const PoseCache& cache,
+                const Image& color_msg) {
+  if (!selector.config.enable) {
+    return true;
+  }
+
+  // frames without a pose are left for processImages to report
+  const auto timestamp_ns = color_msg.header.stamp.toNSec();
+  const auto pose = cache.lookupPose(
+      timestamp_ns, getWorldFrame(config), getSensorFrame(config, color_msg));
+  if (!pose) {
+    return true;
+  }
+
+  const auto accepted = selector.accept(timestamp_ns, pose.to_T_from());
+  VLOG_IF(10, !accepted) << "skipping non-keyframe @ " << timestamp_ns << " [ns]";
+  return accepted;
+}
+
+void logKeyframes(const KeyframeSelector& selector) {
+  LOG_IF(INFO, selector.config.enable)
+      << "Kept " << selector.numAccepted() << " keyframes and skipped "
+      << selector.numRejected() << " frames";
+}
+
+std::unique_ptr<PoseCache> makePoseCache(const rosbag::Bag& bag,
+                                         const BagConfig& config) {
+  if (!config.index_trajectory) {
+    return std::make_unique<PoseCache>(
+        *BagMetadata::get(config.bag_path, config.metadata_cache_dir));
+  }
+
+  const auto world_frame = getWorldFrame(config);
+  const auto sensor_frame = getSensorFrame(bag, config);
+  const auto trajectory_path = getTrajectoryPath(config, world_frame, sensor_frame);
+
+  std::error_code ec;
+  const bool is_current = std::filesystem::exists(trajectory_path) &&
+                          std::filesystem::last_write_time(trajectory_path, ec) >=
+                              std::filesystem::last_write_time(config.bag_path, ec);
+  if (is_current) {
+    auto cache = std::make_unique<PoseCache>();
+    if (cache->loadTrajectory(trajectory_path, world_frame, sensor_frame)) {
+      LOG(INFO) << "Loaded trajectory from " << trajectory_path;
+      return cache;
+    }
+  }
+
+  auto cache = std::make_unique<PoseCache>(
+      *BagMetadata::get(config.bag_path, config.metadata_cache_dir));
+  if (cache->indexTrajectory(world_frame, sensor_frame) &&
+      !cache->saveTrajectory(trajectory_path, world_frame, sensor_frame)) {
+    LOG(WARNING) << "Unable to save trajectory to " << trajectory_path;
+  }
+
+  return cache;
 }
 
 BagReader::BagReader(const Config& config)
     : config(config::checkValid(config)), sinks_(Sink::instantiate(config.sinks)) {}
 
 void BagReader::read() {
-  for (const auto& bag : config.bags) {
-    readBag(bag);
+  if (config.num_parallel_bags <= 1 || config.bags.size() <= 1) {
+    readBags();
+  } else if (config.merge_policy == "per_bag") {
+    readBagsPerBag();
+  } else {
+    readBagsOrdered();
   }
 }
 
@@ -108,20 +319,138 @@ void BagReader::addSink(const Sink::Ptr& sink) {
 }
 
 struct Trampoline {
-  const BagConfig config;
-  BagReader* reader;
-  const PoseCache* cache;
-  Sensor::ConstPtr sensor;
+  std::function<void(const Image::ConstPtr&, const Image::ConstPtr&)> callback;
 
   void call(const sensor_msgs::Image::ConstPtr& msg1,
             const sensor_msgs::Image::ConstPtr& msg2) {
-    reader->handleImages(config, sensor, *cache, msg1, msg2);
+    callback(msg1, msg2);
+  }
+};
+
+//! Pairs color and depth images with either the approximate time or stamp policy
+class ImageSync {
+ public:
+  using Callback = std::function<void(const Image::ConstPtr&, const Image::ConstPtr&)>;
+  using StampSync = StampSynchronizer<Image::ConstPtr, 2>;
+
+  ImageSync(const BagReader::Config& config, const Callback& callback)
+      : trampoline_{callback} {
+    if (config.use_stamp_sync) {
+      stamp_sync_.reset(new StampSync(
+          10, config.sync_tolerance_s * 1.0e9, [this](const StampSync::Items& images) {
+            trampoline_.call(images[0], images[1]);
+          }));
+    } else {
+      sync_.reset(new TimeSync(Policy(10)));
+      sync_->registerCallback(&Trampoline::call, &trampoline_);
+    }
+  }
+
+  void add(const BagImage& image) {
+    if (!image.raw) {
+      return;
+    }
+
+    if (stamp_sync_) {
+      const auto stamp_ns = image.raw->header.stamp.toNSec();
+      stamp_sync_->add(image.is_color ? 0 : 1, stamp_ns, image.raw);
+    } else if (image.is_color) {
+      sync_->add<0>(ros::MessageEvent<Image>(image.raw, image.time));
+    } else {
+      sync_->add<1>(ros::MessageEvent<Image>(image.raw, image.time));
+    }
   }
+
+ private:
+  Trampoline trampoline_;
+  std::unique_ptr<TimeSync> sync_;
+  std::unique_ptr<StampSync> stamp_sync_;
 };
 
-void BagReader::readBag(const BagConfig& bag_config) {
+void BagReader::readBags() {
+  for (const auto& bag : config.bags) {
+    const auto bag_sinks = Sink::instantiate(bag.sinks);
+    readBag(bag, [&](std::unique_ptr<InputData>&& data) { emit(bag_sinks, *data); });
+  }
+}
+
+void BagReader::readBagsPerBag() {
+  LOG(INFO) << "Reading " << config.bags.size() << " bags with "
+            << config.num_parallel_bags << " readers";
+
+  std::mutex sink_mutex;
+  parallelFor(config.bags.size(), config.num_parallel_bags, [&](size_t i) {
+    const auto& bag = config.bags[i];
+    const auto bag_sinks = Sink::instantiate(bag.sinks);
+    readBag(bag, [&](std::unique_ptr<InputData>&& data) {
+      timing::ScopedTimer timer("bag_reader/sinks", data->timestamp_ns);
+      Sink::callAll(bag_sinks, *data);
+      std::lock_guard<std::mutex> lock(sink_mutex);
+      Sink::callAll(sinks_, *data);
+    });
+  });
+}
+
+void BagReader::readBagsOrdered() {
+  // the merge can only release a frame once every bag has produced its next frame,
+  // so every bag needs its own reader
+  const auto num_bags = config.bags.size();
+  LOG_IF(WARNING, config.num_parallel_bags < num_bags)
+      << "Timestamp ordered merge reads all " << num_bags
+      << " bags at once (num_parallel_bags: " << config.num_parallel_bags << ")";
+
+  std::vector<Sink::List> bag_sinks;
+  for (const auto& bag : config.bags) {
+    bag_sinks.push_back(Sink::instantiate(bag.sinks));
+  }
+
+  TimestampMerger<std::unique_ptr<InputData>> merger(num_bags,
+                                                     config.output_queue_size);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < num_bags; ++i) {
+    readers.emplace_back([this, i, &merger, &bag_sinks]() {
+      try {
+        readBag(config.bags[i], [&](std::unique_ptr<InputData>&& data) {
+          Sink::callAll(bag_sinks[i], *data);
+          const auto timestamp_ns = data->timestamp_ns;
+          merger.push(i, timestamp_ns, std::move(data));
+        });
+      } catch (const std::exception& e) {
+        LOG(ERROR) << "Failed to read bag " << config.bags[i].bag_path << ": "
+                   << e.what();
+      }
+
+      merger.finish(i);
+    });
+  }
+
+  while (auto data = merger.pop()) {
+    timing::ScopedTimer timer("bag_reader/sinks", (*data)->timestamp_ns);
+    Sink::callAll(sinks_, **data);
+  }
+
+  for (auto& reader : readers) {
+    reader.join();
+  }
+}
+
+void BagReader::readBag(const BagConfig& bag_config, const FrameCallback& callback) {
+  if (config.num_workers > 0) {
+    readBagPipelined(bag_config, callback);
+  } else {
+    readBagSerial(bag_config, callback);
+  }
+}
+
+void BagReader::emit(const Sink::List& bag_sinks, const InputData& data) {
+  timing::ScopedTimer timer("bag_reader/sinks", data.timestamp_ns);
+  Sink::callAll(bag_sinks, data);
+  Sink::callAll(sinks_, data);
+}
+
+void BagReader::readBagSerial(const BagConfig& bag_config,
+                              const FrameCallback& callback) {
   LOG(INFO) << "Reading bag from config: " << std::endl << config::toString(bag_config);
-  std::vector<std::string> topics{bag_config.color_topic, bag_config.depth_topic};
 
   rosbag::Bag bag;
   bag.open(bag_config.bag_path, rosbag::bagmode::Read);
@@ -132,99 +461,187 @@ void BagReader::readBag(const BagConfig& bag_config) {
     return;
   }
 
-  PoseCache cache(bag);
-  Trampoline trampoline{bag_config, this, &cache, sensor};
+  const auto cache = makePoseCache(bag, bag_config);
+  KeyframeSelector keyframes(config.keyframes);
+  ImageSync sync(config,
+                 [&](const Image::ConstPtr& color, const Image::ConstPtr& depth) {
+                   if (!isKeyframe(keyframes, bag_config, *cache, *color)) {
+                     return;
+                   }
+
+                   auto data = processImages(bag_config, sensor, *cache, color, depth);
+                   if (data) {
+                     callback(std::move(data));
+                   }
+                 });
+
+  DecodeHints hints;
+  forEachImage(bag, bag_config, [&](BagImage& image) {
+    decodeImage(image, hints);
+    sync.add(image);
+  });
+
+  logKeyframes(keyframes);
+  bag.close();
+}
 
-  TimeSync sync(Policy(10));
-  sync.registerCallback(&Trampoline::call, &trampoline);
+void BagReader::readBagPipelined(const BagConfig& bag_config,
+                                 const FrameCallback& callback) {
+  LOG(INFO) << "Reading bag with " << config.num_workers
+            << " workers from config: " << std::endl
+            << config::toString(bag_config);
 
-  ros::Time start;
-  bool have_start = false;
-  rosbag::View view(bag, rosbag::TopicQuery(topics));
-  for (const auto& m : view) {
-    if (!have_start) {
-      start = m.getTime();
-      if (bag_config.start >= 0.0) {
-        start += ros::Duration(bag_config.start);
-      }
-      have_start = true;
-    }
+  rosbag::Bag bag;
+  bag.open(bag_config.bag_path, rosbag::bagmode::Read);
 
-    const auto diff_s = (m.getTime() - start).toSec();
-    if (diff_s < 0.0) {
-      VLOG(2) << "Skipping message " << std::abs(diff_s) << " [s] before start";
-      continue;
-    }
+  const Sensor::ConstPtr sensor = bag_config.sensor.create();
+  if (!sensor) {
+    LOG(ERROR) << "Could not load sensor for bag " << bag_config.bag_path;
+    return;
+  }
 
-    if (bag_config.duration >= 0.0 && diff_s > bag_config.duration) {
-      LOG(INFO) << "Reached end of duration: " << diff_s << " [s]";
-      return;
-    }
+  const auto cache = makePoseCache(bag, bag_config);
+
+  using ImagePair = std::pair<Image::ConstPtr, Image::ConstPtr>;
+  using DataPtr = std::unique_ptr<InputData>;
+  OrderedWorkerPool<ImagePair, DataPtr> process_pool(
+      config.num_workers,
+      config.output_queue_size,
+      [&](ImagePair& images) {
+        return processImages(bag_config, sensor, *cache, images.first, images.second);
+      },
+      [&callback](DataPtr& data) {
+        if (data) {
+          callback(std::move(data));
+        }
+      });
+
+  // the sync callback runs on the decode pool's consumer thread, so keyframes are
+  // selected in order before any frame reaches the process pool
+  KeyframeSelector keyframes(config.keyframes);
+  ImageSync sync(config,
+                 [&](const Image::ConstPtr& color, const Image::ConstPtr& depth) {
+                   if (isKeyframe(keyframes, bag_config, *cache, *color)) {
+                     process_pool.push({color, depth});
+                   }
+                 });
+
+  DecodeHints hints;
+  OrderedWorkerPool<BagImage, BagImage> decode_pool(
+      config.num_workers,
+      config.prefetch_queue_size,
+      [&hints](BagImage& image) {
+        decodeImage(image, hints);
+        return std::move(image);
+      },
+      [&sync](BagImage& image) { sync.add(image); });
+
+  forEachImage(bag, bag_config, [&](BagImage& image) {
+    decode_pool.push(std::move(image));
+  });
+
+  decode_pool.finish();
+  process_pool.finish();
+  logKeyframes(keyframes);
+  bag.close();
+}
 
-    const auto topic = m.getTopic();
-    auto msg = getImageMessage(m);
-    if (!msg) {
-      continue;
-    }
+void BagReader::readImages(const Config& config,
+                           const BagConfig& bag_config,
+                           const ImageCallback& callback,
+                           const std::atomic<bool>* stop) {
+  rosbag::Bag bag;
+  bag.open(bag_config.bag_path, rosbag::bagmode::Read);
 
-    if (topic == bag_config.color_topic) {
-      VLOG(10) << "new " << bag_config.color_topic << " @ "
-               << msg->header.stamp.toNSec();
-      sync.add<0>(ros::MessageEvent<Image>(msg, m.getTime()));
-    } else {
-      VLOG(10) << "new " << bag_config.depth_topic << " @ "
-               << msg->header.stamp.toNSec();
-      sync.add<1>(ros::MessageEvent<Image>(msg, m.getTime()));
-    }
-  }
+  ImageSync sync(config, callback);
+  DecodeHints hints;
+  forEachImage(
+      bag,
+      bag_config,
+      [&](BagImage& image) {
+        decodeImage(image, hints);
+        sync.add(image);
+      },
+      stop);
 
   bag.close();
 }
 
-void BagReader::handleImages(const BagConfig& bag_config,
-                             const Sensor::ConstPtr& sensor,
-                             const PoseCache& cache,
-                             const sensor_msgs::Image::ConstPtr& color_msg,
-                             const sensor_msgs::Image::ConstPtr& depth_msg) {
+cv::Mat toRgbImage(const Image::ConstPtr& msg) {
+  namespace enc = sensor_msgs::image_encodings;
+  if (msg->encoding == enc::RGB8) {
+    return toOwnedImage(cv_bridge::toCvShare(msg));
+  }
+
+  // common encodings are converted straight into the output image in one pass
+  int code = -1;
+  if (msg->encoding == enc::BGR8) {
+    code = cv::COLOR_BGR2RGB;
+  } else if (msg->encoding == enc::BGRA8) {
+    code = cv::COLOR_BGRA2RGB;
+  } else if (msg->encoding == enc::RGBA8) {
+    code = cv::COLOR_RGBA2RGB;
+  } else if (msg->encoding == enc::MONO8) {
+    code = cv::COLOR_GRAY2RGB;
+  }
+
+  if (code < 0) {
+    return cv_bridge::toCvCopy(msg, enc::RGB8)->image;
+  }
+
+  cv::Mat rgb;
+  cv::cvtColor(cv_bridge::toCvShare(msg)->image, rgb, code);
+  return rgb;
+}
+
+std::unique_ptr<InputData> BagReader::processImages(
+    const BagConfig& bag_config,
+    const Sensor::ConstPtr& sensor,
+    const PoseCache& cache,
+    const sensor_msgs::Image::ConstPtr& color_msg,
+    const sensor_msgs::Image::ConstPtr& depth_msg) const {
   if (!sensor) {
     LOG(ERROR) << "sensor required!";
-    return;
+    return nullptr;
   }
 
   const auto timestamp_ns = color_msg->header.stamp.toNSec();
   VLOG(5) << "processing images @ " << timestamp_ns << " [ns]";
+  timing::ScopedTimer timer("bag_reader/process", timestamp_ns);
 
-  const auto sensor_frame = !bag_config.sensor_frame.empty()
-                                ? bag_config.sensor_frame
-                                : color_msg->header.frame_id;
-  const auto world_frame = !bag_config.world_frame.empty()
-                               ? bag_config.world_frame
-                               : GlobalInfo::instance().getFrames().odom;
+  const auto sensor_frame = getSensorFrame(bag_config, *color_msg);
+  const auto world_frame = getWorldFrame(bag_config);
   const auto pose = cache.lookupPose(timestamp_ns, world_frame, sensor_frame);
   if (!pose) {
     LOG(ERROR) << "Could not find pose for data @ " << timestamp_ns << " [ns]";
-    return;
+    return nullptr;
   }
 
-  InputData data(sensor);
-  data.timestamp_ns = timestamp_ns;
-  data.world_T_body = pose.to_T_from();
-  data.color_image = cv_bridge::toCvCopy(color_msg)->image.clone();
-  cv::cvtColor(data.color_image, data.color_image, cv::COLOR_BGR2RGB);
-  data.depth_image = cv_bridge::toCvCopy(depth_msg)->image.clone();
+  auto data = std::make_unique<InputData>(sensor);
+  data->timestamp_ns = timestamp_ns;
+  data->world_T_body = pose.to_T_from();
+  try {
+    timing::ScopedTimer convert_timer("bag_reader/convert", timestamp_ns);
+    data->color_image = toRgbImage(color_msg);
+    data->depth_image = toOwnedImage(cv_bridge::toCvShare(depth_msg));
+  } catch (const cv_bridge::Exception& e) {
+    LOG(ERROR) << "Unable to convert images @ " << timestamp_ns
+               << " [ns]: " << e.what();
+    return nullptr;
+  }
 
-  const auto valid = conversions::normalizeData(data, false);
+  const auto valid = conversions::normalizeData(*data, false);
   if (!valid) {
-    LOG(ERROR) << "Failed to normalize frame data @ " << data.timestamp_ns << " [ns]";
-    return;
+    LOG(ERROR) << "Failed to normalize frame data @ " << data->timestamp_ns << " [ns]";
+    return nullptr;
   }
 
-  if (!sensor->finalizeRepresentations(data)) {
-    LOG(ERROR) << "Failed to finalized data @ " << data.timestamp_ns << " [ns]";
-    return;
+  if (!sensor->finalizeRepresentations(*data)) {
+    LOG(ERROR) << "Failed to finalized data @ " << data->timestamp_ns << " [ns]";
+    return nullptr;
   }
 
-  Sink::callAll(sinks_, data);
+  return data;
 }
 
 void declare_config(BagReader::Config& config) {
@@ -232,6 +649,19 @@ void declare_config(BagReader::Config& config) {
   name("BagReader::Config");
   field(config.bags, "bags");
   field(config.sinks, "sinks");
+  field(config.num_workers, "num_workers");
+  field(config.prefetch_queue_size, "prefetch_queue_size");
+  field(config.output_queue_size, "output_queue_size");
+  field(config.num_parallel_bags, "num_parallel_bags");
+  field(config.merge_policy, "merge_policy");
+  field(config.use_stamp_sync, "use_stamp_sync");
+  field(config.sync_tolerance_s, "sync_tolerance_s", "s");
+  field(config.keyframes, "keyframes");
+  checkCondition(config.prefetch_queue_size > 0,
+                 "prefetch_queue_size must be positive");
+  checkCondition(config.output_queue_size > 0, "output_queue_size must be positive");
+  checkCondition(config.merge_policy == "ordered" || config.merge_policy == "per_bag",
+                 "merge_policy must be 'ordered' or 'per_bag'");
 }
 
 }  // namespace hydra
@@ -0,0 +1,150 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/block_store.h"
+
+#include <glog/logging.h>
+
+#include <cmath>
+#include <sstream>
+
+namespace hydra {
+
+ChunkedBlockStore::ChunkedBlockStore(const std::filesystem::path& directory,
+                                     int blocks_per_chunk)
+    : directory_(directory), blocks_per_chunk_(blocks_per_chunk) {
+  CHECK_GT(blocks_per_chunk_, 0);
+  std::filesystem::create_directories(directory_);
+}
+
+ChunkedBlockStore::~ChunkedBlockStore() { clear(); }
+
+ChunkedBlockStore::BlockIndex ChunkedBlockStore::chunkIndex(
+    const BlockIndex& index) const {
+  BlockIndex chunk;
+  for (size_t i = 0; i < 3; ++i) {
+    chunk[i] = static_cast<int32_t>(
+        std::floor(static_cast<double>(index[i]) / blocks_per_chunk_));
+  }
+
+  return chunk;
+}
+
+std::FILE* ChunkedBlockStore::getChunkFile(const BlockIndex& chunk) {
+  auto iter = files_.find(chunk);
+  if (iter != files_.end()) {
+    return iter->second;
+  }
+
+  std::stringstream ss;
+  ss << "chunk_" << chunk[0] << "_" << chunk[1] << "_" << chunk[2] << ".bin";
+  const auto filepath = directory_ / ss.str();
+  std::FILE* file = std::fopen(filepath.c_str(), "w+b");
+  if (!file) {
+    LOG(ERROR) << "Unable to open block store chunk " << filepath;
+    return nullptr;
+  }
+
+  files_.emplace(chunk, file);
+  return file;
+}
+
+bool ChunkedBlockStore::write(const BlockIndex& index,
+                              const std::vector<uint8_t>& data) {
+  const auto chunk = chunkIndex(index);
+  std::FILE* file = getChunkFile(chunk);
+  if (!file || std::fseek(file, 0, SEEK_END) != 0) {
+    return false;
+  }
+
+  const long offset = std::ftell(file);
+  if (std::fwrite(data.data(), 1, data.size(), file) != data.size()) {
+    LOG(ERROR) << "Failed to write block to store";
+    return false;
+  }
+
+  entries_[index] = {chunk, offset, data.size()};
+  bytes_written_ += data.size();
+  return true;
+}
+
+bool ChunkedBlockStore::read(const BlockIndex& index,
+                             std::vector<uint8_t>& data) const {
+  const auto iter = entries_.find(index);
+  if (iter == entries_.end()) {
+    return false;
+  }
+
+  const auto& entry = iter->second;
+  std::FILE* file = files_.at(entry.chunk);
+  data.resize(entry.size);
+  if (std::fflush(file) != 0 || std::fseek(file, entry.offset, SEEK_SET) != 0) {
+    return false;
+  }
+
+  return std::fread(data.data(), 1, entry.size, file) == entry.size;
+}
+
+bool ChunkedBlockStore::contains(const BlockIndex& index) const {
+  return entries_.count(index);
+}
+
+void ChunkedBlockStore::erase(const BlockIndex& index) { entries_.erase(index); }
+
+std::vector<ChunkedBlockStore::BlockIndex> ChunkedBlockStore::blocks() const {
+  std::vector<BlockIndex> indices;
+  indices.reserve(entries_.size());
+  for (const auto& [index, entry] : entries_) {
+    indices.push_back(index);
+  }
+
+  return indices;
+}
+
+void ChunkedBlockStore::clear() {
+  for (auto& [chunk, file] : files_) {
+    std::fclose(file);
+  }
+
+  files_.clear();
+  entries_.clear();
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+    if (entry.path().extension() == ".bin") {
+      std::filesystem::remove(entry.path(), ec);
+    }
+  }
+}
+
+}  // namespace hydra
@@ -34,24 +34,129 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_ros/utils/bow_subscriber.h"
 
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
 #include <pose_graph_tools_ros/conversions.h>
 
+#include "hydra_ros/utils/input_queue_batch.h"
+#include "hydra_ros/utils/metrics.h"
+
 namespace hydra {
 
 using pose_graph_tools_msgs::BowQueries;
 
+void declare_config(BowSubscriber::Config& config) {
+  using namespace config;
+  name("BowSubscriber::Config");
+  field(config.queue_size, "queue_size");
+  field(config.max_backlog, "max_backlog");
+
+  check(config.queue_size, GT, 0u, "queue_size");
+  check(config.max_backlog, GT, 0u, "max_backlog");
+}
+
 BowSubscriber::BowSubscriber(const ros::NodeHandle& nh,
                              const SharedModuleState::Ptr& state)
-    : nh_(nh), state_(state) {
-  if (state_->bow_queue) {
-    sub_ = nh_.subscribe("bow_vectors", 100, &BowSubscriber::callback, this);
+    : BowSubscriber(Config(), nh, state) {}
+
+BowSubscriber::BowSubscriber(const Config& config,
+                             const ros::NodeHandle& nh,
+                             const SharedModuleState::Ptr& state)
+    : config(config::checkValid(config)), nh_(nh), state_(state) {
+  if (!state_->bow_queue) {
+    return;
+  }
+
+  MetricsRegistry::instance().registerGauge("bow/backlog", [this]() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<double>(batches_.size());
+  });
+
+  worker_ = std::thread(&BowSubscriber::spin, this);
+  sub_ = nh_.subscribe(
+      "bow_vectors", config.queue_size, &BowSubscriber::callback, this);
+}
+
+BowSubscriber::~BowSubscriber() {
+  if (!worker_.joinable()) {
+    return;
   }
+
+  sub_.shutdown();
+  MetricsRegistry::instance().removeGauge("bow/backlog");
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    should_shutdown_ = true;
+  }  // end critical section
+
+  cv_.notify_all();
+  worker_.join();
 }
 
 void BowSubscriber::callback(const BowQueries& msg) {
+  if (msg.queries.empty()) {
+    return;
+  }
+
+  auto batch = std::make_shared<std::vector<pose_graph_tools::BowQuery>>();
+  batch->reserve(msg.queries.size());
   for (const auto& query : msg.queries) {
-    state_->bow_queue->push(
-        std::make_shared<pose_graph_tools::BowQuery>(pose_graph_tools::fromMsg(query)));
+    batch->push_back(pose_graph_tools::fromMsg(query));
+  }
+
+  auto& metrics = MetricsRegistry::instance();
+  metrics.addCount("bow/queries", batch->size());
+
+  size_t num_dropped = 0;
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (batches_.size() >= config.max_backlog) {
+      num_dropped += batches_.front()->size();
+      batches_.pop_front();
+    }
+
+    batches_.push_back(std::move(batch));
+  }  // end critical section
+
+  cv_.notify_one();
+  if (num_dropped) {
+    metrics.addCount("bow/dropped_queries", num_dropped);
+    LOG_EVERY_N(WARNING, 10) << "BoW backlog full: dropped " << num_dropped
+                             << " queries";
+  }
+}
+
+void BowSubscriber::spin() {
+  std::deque<Batch> to_forward;
+  std::vector<pose_graph_tools::BowQuery::ConstPtr> queries;
+  while (true) {
+    {  // start critical section
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return should_shutdown_ || !batches_.empty(); });
+      if (should_shutdown_) {
+        return;
+      }
+
+      to_forward.swap(batches_);
+    }  // end critical section
+
+    for (const auto& batch : to_forward) {
+      // queries share the batch allocation through aliasing pointers
+      for (const auto& query : *batch) {
+        queries.emplace_back(batch, &query);
+      }
+    }
+
+    const auto num_pushed =
+        pushBatch(*state_->bow_queue, queries.begin(), queries.end());
+    if (num_pushed < queries.size()) {
+      MetricsRegistry::instance().addCount("bow/dropped_queries",
+                                           queries.size() - num_pushed);
+    }
+
+    queries.clear();
+    to_forward.clear();
   }
 }
 
@@ -0,0 +1,224 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/compressed_image.h"
+
+#include <glog/logging.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <boost/make_shared.hpp>
+#include <cstring>
+#include <limits>
+#include <opencv2/imgcodecs.hpp>
+
+namespace hydra {
+
+namespace {
+
+// matches compressed_depth_image_transport::ConfigHeader
+struct DepthHeader {
+  int32_t format;
+  float depth_quant_a;
+  float depth_quant_b;
+};
+
+std::string encodingFromType(int type) {
+  namespace enc = sensor_msgs::image_encodings;
+  switch (type) {
+    case CV_8UC1:
+      return enc::MONO8;
+    case CV_8UC3:
+      return enc::BGR8;
+    case CV_8UC4:
+      return enc::BGRA8;
+    case CV_16UC1:
+      return enc::MONO16;
+    case CV_16UC3:
+      return enc::BGR16;
+    case CV_16UC4:
+      return enc::BGRA16;
+    default:
+      break;
+  }
+
+  // everything else (e.g., 32FC1 from tiff or exr) uses the generic type encodings
+  static const char* depths[] = {"8U", "8S", "16U", "16S", "32S", "32F", "64F"};
+  const auto depth = CV_MAT_DEPTH(type);
+  if (depth > CV_64F) {
+    return "";
+  }
+
+  return std::string(depths[depth]) + "C" + std::to_string(CV_MAT_CN(type));
+}
+
+cv::Mat wrapMessage(sensor_msgs::Image& image, int rows, int cols, int type) {
+  image.height = rows;
+  image.width = cols;
+  image.step = cols * CV_ELEM_SIZE(type);
+  image.data.resize(image.step * rows);
+  return cv::Mat(rows, cols, type, image.data.data(), image.step);
+}
+
+// decode into the message buffer, falling back to a single copy if the shape is not
+// known in advance or changed
+bool decodeInto(const cv::Mat& buffer,
+                sensor_msgs::Image& image,
+                DecodeShapeHint* hint) {
+  int rows, cols, type;
+  cv::Mat decoded;
+  if (hint && hint->get(rows, cols, type)) {
+    decoded = wrapMessage(image, rows, cols, type);
+  }
+
+  uint8_t* const target = decoded.data;
+  cv::imdecode(buffer, cv::IMREAD_UNCHANGED, &decoded);
+  if (decoded.empty()) {
+    return false;
+  }
+
+#ifdef CV_16F
+  if (decoded.depth() == CV_16F) {
+    // half floats have no ROS encoding
+    cv::Mat converted;
+    decoded.convertTo(converted, CV_MAKETYPE(CV_32F, decoded.channels()));
+    decoded = converted;
+  }
+#endif
+
+  if (decoded.data != target) {
+    auto output = wrapMessage(image, decoded.rows, decoded.cols, decoded.type());
+    decoded.copyTo(output);
+    if (hint) {
+      hint->set(decoded.rows, decoded.cols, decoded.type());
+    }
+  }
+
+  image.encoding = encodingFromType(decoded.type());
+  if (image.encoding.empty()) {
+    LOG(ERROR) << "Decoded image has unsupported type " << decoded.type();
+    return false;
+  }
+
+  return true;
+}
+
+bool decodeDepth(const sensor_msgs::CompressedImage& msg,
+                 sensor_msgs::Image& image,
+                 DecodeShapeHint* hint) {
+  namespace enc = sensor_msgs::image_encodings;
+  if (msg.data.size() <= sizeof(DepthHeader)) {
+    LOG(ERROR) << "compressedDepth image is missing header";
+    return false;
+  }
+
+  DepthHeader header;
+  std::memcpy(&header, msg.data.data(), sizeof(DepthHeader));
+  const cv::Mat buffer(1,
+                       msg.data.size() - sizeof(DepthHeader),
+                       CV_8UC1,
+                       const_cast<uint8_t*>(msg.data.data()) + sizeof(DepthHeader));
+
+  const auto encoding = msg.format.substr(0, msg.format.find(';'));
+  if (encoding == enc::TYPE_16UC1) {
+    if (!decodeInto(buffer, image, hint)) {
+      return false;
+    }
+
+    image.encoding = enc::TYPE_16UC1;
+    return true;
+  }
+
+  if (encoding != enc::TYPE_32FC1) {
+    LOG(ERROR) << "Unsupported compressedDepth encoding: '" << encoding << "'";
+    return false;
+  }
+
+  // float depth is stored as quantized inverse depth
+  const auto inv_depth = cv::imdecode(buffer, cv::IMREAD_UNCHANGED);
+  if (inv_depth.empty() || inv_depth.type() != CV_16UC1) {
+    return false;
+  }
+
+  auto depth = wrapMessage(image, inv_depth.rows, inv_depth.cols, CV_32FC1);
+  for (int r = 0; r < inv_depth.rows; ++r) {
+    const auto in_row = inv_depth.ptr<uint16_t>(r);
+    auto out_row = depth.ptr<float>(r);
+    for (int c = 0; c < inv_depth.cols; ++c) {
+      out_row[c] = in_row[c] == 0
+                       ? std::numeric_limits<float>::quiet_NaN()
+                       : header.depth_quant_a / (in_row[c] - header.depth_quant_b);
+    }
+  }
+
+  image.encoding = enc::TYPE_32FC1;
+  return true;
+}
+
+}  // namespace
+
+bool DecodeShapeHint::get(int& rows, int& cols, int& type) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  rows = rows_;
+  cols = cols_;
+  type = type_;
+  return valid_;
+}
+
+void DecodeShapeHint::set(int rows, int cols, int type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  valid_ = true;
+  rows_ = rows;
+  cols_ = cols;
+  type_ = type;
+}
+
+sensor_msgs::Image::Ptr decodeCompressedImage(const sensor_msgs::CompressedImage& msg,
+                                              DecodeShapeHint* hint) {
+  auto image = boost::make_shared<sensor_msgs::Image>();
+  image->header = msg.header;
+  if (msg.format.find("compressedDepth") != std::string::npos) {
+    return decodeDepth(msg, *image, hint) ? image : nullptr;
+  }
+
+  const cv::Mat buffer(
+      1, msg.data.size(), CV_8UC1, const_cast<uint8_t*>(msg.data.data()));
+  if (!decodeInto(buffer, *image, hint)) {
+    LOG(ERROR) << "Unable to decode image with format '" << msg.format << "'";
+    return nullptr;
+  }
+
+  return image;
+}
+
+}  // namespace hydra
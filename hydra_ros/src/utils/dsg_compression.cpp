@@ -0,0 +1,219 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/dsg_compression.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace hydra {
+
+std::optional<DsgCodec> codecFromString(const std::string& name) {
+  if (name == "none") {
+    return DsgCodec::NONE;
+  }
+
+  if (name == "zstd") {
+    return DsgCodec::ZSTD;
+  }
+
+  if (name == "lz4") {
+    return DsgCodec::LZ4;
+  }
+
+  return std::nullopt;
+}
+
+std::string codecToString(DsgCodec codec) {
+  switch (codec) {
+    case DsgCodec::NONE:
+      return "none";
+    case DsgCodec::ZSTD:
+      return "zstd";
+    case DsgCodec::LZ4:
+      return "lz4";
+    default:
+      return "unknown";
+  }
+}
+
+std::optional<DsgProfile> profileFromString(const std::string& name) {
+  if (name == "full") {
+    return DsgProfile::FULL;
+  }
+
+  if (name == "reduced") {
+    return DsgProfile::REDUCED;
+  }
+
+  return std::nullopt;
+}
+
+std::string profileToString(DsgProfile profile) {
+  switch (profile) {
+    case DsgProfile::FULL:
+      return "full";
+    case DsgProfile::REDUCED:
+      return "reduced";
+    default:
+      return "unknown";
+  }
+}
+
+void reduceGraph(DynamicSceneGraph& graph, double position_resolution) {
+  const auto quantize = [position_resolution](double value) {
+    return std::round(value / position_resolution) * position_resolution;
+  };
+
+  for (const auto& id_layer_pair : graph.layers()) {
+    for (const auto& id_node_pair : id_layer_pair.second->nodes()) {
+      auto& attrs = id_node_pair.second->attributes();
+      if (position_resolution > 0.0) {
+        attrs.position = attrs.position.unaryExpr(quantize);
+      }
+
+      auto places_attrs = dynamic_cast<PlaceNodeAttributes*>(&attrs);
+      if (places_attrs) {
+        places_attrs->voxblox_mesh_connections.clear();
+        places_attrs->pcl_mesh_connections.clear();
+        places_attrs->mesh_vertex_labels.clear();
+      }
+    }
+  }
+}
+
+void compressPayload(DsgCodec codec,
+                     int level,
+                     const std::vector<uint8_t>& input,
+                     std::vector<uint8_t>& output) {
+  switch (codec) {
+    case DsgCodec::NONE:
+      output = input;
+      return;
+    case DsgCodec::ZSTD: {
+      output.resize(ZSTD_compressBound(input.size()));
+      const size_t size = ZSTD_compress(
+          output.data(), output.size(), input.data(), input.size(), level);
+      if (ZSTD_isError(size)) {
+        throw std::runtime_error(std::string("zstd compression failed: ") +
+                                 ZSTD_getErrorName(size));
+      }
+
+      output.resize(size);
+      return;
+    }
+    case DsgCodec::LZ4: {
+      if (input.size() > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+        throw std::runtime_error("payload too large for lz4");
+      }
+
+      const int input_size = static_cast<int>(input.size());
+      output.resize(LZ4_compressBound(input_size));
+      const int size =
+          LZ4_compress_fast(reinterpret_cast<const char*>(input.data()),
+                            reinterpret_cast<char*>(output.data()),
+                            input_size,
+                            static_cast<int>(output.size()),
+                            std::max(level, 1));
+      if (size <= 0) {
+        throw std::runtime_error("lz4 compression failed");
+      }
+
+      output.resize(size);
+      return;
+    }
+    default:
+      throw std::runtime_error("unknown codec: " +
+                               std::to_string(static_cast<int>(codec)));
+  }
+}
+
+void decompressPayload(DsgCodec codec,
+                       size_t uncompressed_size,
+                       const std::vector<uint8_t>& input,
+                       std::vector<uint8_t>& output) {
+  decompressPayload(codec, uncompressed_size, input.data(), input.size(), output);
+}
+
+void decompressPayload(DsgCodec codec,
+                       size_t uncompressed_size,
+                       const uint8_t* input,
+                       size_t input_size,
+                       std::vector<uint8_t>& output) {
+  switch (codec) {
+    case DsgCodec::NONE:
+      output.assign(input, input + input_size);
+      return;
+    case DsgCodec::ZSTD: {
+      output.resize(uncompressed_size);
+      const size_t size =
+          ZSTD_decompress(output.data(), output.size(), input, input_size);
+      if (ZSTD_isError(size)) {
+        throw std::runtime_error(std::string("zstd decompression failed: ") +
+                                 ZSTD_getErrorName(size));
+      }
+
+      if (size != uncompressed_size) {
+        throw std::runtime_error("zstd payload size mismatch");
+      }
+      return;
+    }
+    case DsgCodec::LZ4: {
+      constexpr size_t max_size = std::numeric_limits<int>::max();
+      if (uncompressed_size > max_size || input_size > max_size) {
+        throw std::runtime_error("payload too large for lz4");
+      }
+
+      output.resize(uncompressed_size);
+      const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(input),
+                                           reinterpret_cast<char*>(output.data()),
+                                           static_cast<int>(input_size),
+                                           static_cast<int>(output.size()));
+      if (size < 0 || static_cast<size_t>(size) != uncompressed_size) {
+        throw std::runtime_error("lz4 decompression failed");
+      }
+      return;
+    }
+    default:
+      throw std::runtime_error("unknown codec: " +
+                               std::to_string(static_cast<int>(codec)));
+  }
+}
+
+}  // namespace hydra
@@ -0,0 +1,482 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/dsg_log.h"
+
+#include <glog/logging.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "hydra_ros/utils/mapped_file.h"
+
+namespace hydra {
+
+namespace {
+
+// all fields are written in host byte order
+constexpr uint64_t kFileMagic = 0x31676f6c67736468;   // "hdsglog1"
+constexpr uint64_t kIndexMagic = 0x31786469677364;    // "dsgidx1"
+constexpr uint32_t kRecordMagic = 0x63657264;         // "drec"
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct RecordHeader {
+  uint32_t magic;
+  uint8_t type;
+  uint8_t codec;
+  uint16_t reserved;
+  uint64_t timestamp_ns;
+  int64_t sequence_number;
+  uint64_t uncompressed_size;
+  uint64_t size;
+};
+
+struct IndexEntry {
+  uint8_t type;
+  uint8_t codec;
+  uint8_t reserved[6];
+  uint64_t timestamp_ns;
+  int64_t sequence_number;
+  uint64_t uncompressed_size;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct IndexFooter {
+  uint64_t num_records;
+  uint64_t index_offset;
+  uint64_t magic;
+};
+
+template <typename T>
+inline void appendBytes(std::vector<uint8_t>& buffer, const T& value) {
+  const auto ptr = reinterpret_cast<const uint8_t*>(&value);
+  buffer.insert(buffer.end(), ptr, ptr + sizeof(T));
+}
+
+// records are not aligned within the file, so everything is read via memcpy
+template <typename T>
+inline T readBytes(const uint8_t* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+inline bool validType(uint8_t type) {
+  return type <= static_cast<uint8_t>(DsgLogRecord::Type::DELTA_UPDATE);
+}
+
+// update payloads are the deleted nodes and edges followed by the layer contents
+struct UpdateView {
+  std::vector<NodeId> deleted_nodes;
+  std::vector<NodeId> deleted_edges;
+  const uint8_t* contents = nullptr;
+  size_t contents_size = 0;
+};
+
+bool parseIds(const uint8_t*& ptr, const uint8_t* end, std::vector<NodeId>& ids) {
+  if (end - ptr < static_cast<std::ptrdiff_t>(sizeof(uint64_t))) {
+    return false;
+  }
+
+  const auto num_ids = readBytes<uint64_t>(ptr);
+  ptr += sizeof(uint64_t);
+  if (num_ids > static_cast<uint64_t>(end - ptr) / sizeof(uint64_t)) {
+    return false;
+  }
+
+  ids.resize(num_ids);
+  std::memcpy(ids.data(), ptr, num_ids * sizeof(uint64_t));
+  ptr += num_ids * sizeof(uint64_t);
+  return true;
+}
+
+bool parseUpdate(const uint8_t* data, size_t size, UpdateView& view) {
+  const uint8_t* ptr = data;
+  const uint8_t* end = data + size;
+  if (!parseIds(ptr, end, view.deleted_nodes) ||
+      !parseIds(ptr, end, view.deleted_edges)) {
+    return false;
+  }
+
+  view.contents = ptr;
+  view.contents_size = end - ptr;
+  return true;
+}
+
+}  // namespace
+
+DsgLogWriter::DsgLogWriter(const std::string& filepath,
+                           DsgCodec snapshot_codec,
+                           int compression_level)
+    : file_(nullptr),
+      offset_(0),
+      snapshot_codec_(snapshot_codec),
+      compression_level_(compression_level) {
+  file_ = std::fopen(filepath.c_str(), "wb");
+  if (!file_) {
+    LOG(ERROR) << "Failed to open '" << filepath << "': " << std::strerror(errno);
+    return;
+  }
+
+  const FileHeader header{kFileMagic, kVersion, 0};
+  if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+    LOG(ERROR) << "Failed to write header to '" << filepath << "'";
+    std::fclose(file_);
+    file_ = nullptr;
+    return;
+  }
+
+  offset_ = sizeof(header);
+}
+
+DsgLogWriter::~DsgLogWriter() { close(); }
+
+bool DsgLogWriter::writeUpdate(const hydra_msgs::DsgUpdate& msg) {
+  DsgLogRecord record;
+  record.type = msg.full_update ? DsgLogRecord::Type::FULL_UPDATE
+                                : DsgLogRecord::Type::DELTA_UPDATE;
+  record.timestamp_ns = msg.header.stamp.toNSec();
+  record.sequence_number = msg.sequence_number;
+  record.codec = static_cast<DsgCodec>(msg.codec);
+  record.uncompressed_size = msg.uncompressed_size;
+
+  buffer_.clear();
+  const size_t num_ids = msg.deleted_nodes.size() + msg.deleted_edges.size();
+  buffer_.reserve(sizeof(uint64_t) * (num_ids + 2) + msg.layer_contents.size());
+  appendBytes<uint64_t>(buffer_, msg.deleted_nodes.size());
+  for (const auto node_id : msg.deleted_nodes) {
+    appendBytes<uint64_t>(buffer_, node_id);
+  }
+
+  appendBytes<uint64_t>(buffer_, msg.deleted_edges.size());
+  for (const auto node_id : msg.deleted_edges) {
+    appendBytes<uint64_t>(buffer_, node_id);
+  }
+
+  buffer_.insert(buffer_.end(), msg.layer_contents.begin(), msg.layer_contents.end());
+  return append(record, buffer_);
+}
+
+bool DsgLogWriter::writeSnapshot(const DynamicSceneGraph& graph,
+                                 uint64_t timestamp_ns,
+                                 int64_t sequence_number) {
+  DsgLogRecord record;
+  record.type = DsgLogRecord::Type::SNAPSHOT;
+  record.timestamp_ns = timestamp_ns;
+  record.sequence_number = sequence_number;
+  record.codec = snapshot_codec_;
+
+  spark_dsg::io::binary::writeGraph(graph, buffer_, false);
+  record.uncompressed_size = buffer_.size();
+  if (snapshot_codec_ == DsgCodec::NONE) {
+    return append(record, buffer_);
+  }
+
+  std::vector<uint8_t> compressed;
+  try {
+    compressPayload(snapshot_codec_, compression_level_, buffer_, compressed);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to compress snapshot: " << e.what();
+    return false;
+  }
+
+  return append(record, compressed);
+}
+
+bool DsgLogWriter::append(DsgLogRecord record, const std::vector<uint8_t>& payload) {
+  if (!file_) {
+    return false;
+  }
+
+  const RecordHeader header{kRecordMagic,
+                            static_cast<uint8_t>(record.type),
+                            static_cast<uint8_t>(record.codec),
+                            0,
+                            record.timestamp_ns,
+                            record.sequence_number,
+                            record.uncompressed_size,
+                            payload.size()};
+  if (std::fwrite(&header, sizeof(header), 1, file_) != 1 ||
+      std::fwrite(payload.data(), 1, payload.size(), file_) != payload.size()) {
+    LOG(ERROR) << "Failed to append record to scene graph log";
+    return false;
+  }
+
+  std::fflush(file_);
+  record.offset = offset_ + sizeof(header);
+  record.size = payload.size();
+  offset_ = record.offset + record.size;
+  records_.push_back(record);
+  return true;
+}
+
+void DsgLogWriter::close() {
+  if (!file_) {
+    return;
+  }
+
+  for (const auto& record : records_) {
+    IndexEntry entry{};
+    entry.type = static_cast<uint8_t>(record.type);
+    entry.codec = static_cast<uint8_t>(record.codec);
+    entry.timestamp_ns = record.timestamp_ns;
+    entry.sequence_number = record.sequence_number;
+    entry.uncompressed_size = record.uncompressed_size;
+    entry.offset = record.offset;
+    entry.size = record.size;
+    std::fwrite(&entry, sizeof(entry), 1, file_);
+  }
+
+  const IndexFooter footer{records_.size(), offset_, kIndexMagic};
+  std::fwrite(&footer, sizeof(footer), 1, file_);
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+DsgLogReader::DsgLogReader(const std::string& filepath)
+    : file_(new MappedFile(filepath)), size_(0), data_(nullptr) {
+  if (!file_->valid()) {
+    return;
+  }
+
+  if (file_->size() < sizeof(FileHeader)) {
+    LOG(ERROR) << "'" << filepath << "' is not a scene graph log";
+    return;
+  }
+
+  const auto header = readBytes<FileHeader>(file_->data());
+  if (header.magic != kFileMagic || header.version != kVersion) {
+    LOG(ERROR) << "'" << filepath << "' is not a scene graph log";
+    return;
+  }
+
+  size_ = file_->size();
+  data_ = file_->data();
+  if (!readIndex()) {
+    LOG(WARNING) << "'" << filepath << "' has no index (writer did not close cleanly)";
+    scanRecords();
+  }
+
+  for (size_t i = 0; i < records_.size(); ++i) {
+    if (records_[i].isKeyframe()) {
+      keyframes_.push_back(i);
+    }
+  }
+}
+
+DsgLogReader::~DsgLogReader() = default;
+
+bool DsgLogReader::readIndex() {
+  if (size_ < sizeof(FileHeader) + sizeof(IndexFooter)) {
+    return false;
+  }
+
+  const auto footer = readBytes<IndexFooter>(data_ + size_ - sizeof(IndexFooter));
+  if (footer.magic != kIndexMagic || footer.index_offset < sizeof(FileHeader) ||
+      footer.index_offset > size_ - sizeof(IndexFooter)) {
+    return false;
+  }
+
+  const size_t index_size = size_ - sizeof(IndexFooter) - footer.index_offset;
+  if (index_size != footer.num_records * sizeof(IndexEntry)) {
+    return false;
+  }
+
+  records_.resize(footer.num_records);
+  const uint8_t* ptr = data_ + footer.index_offset;
+  for (auto& record : records_) {
+    const auto entry = readBytes<IndexEntry>(ptr);
+    ptr += sizeof(IndexEntry);
+    if (!validType(entry.type) || entry.offset > footer.index_offset ||
+        entry.size > footer.index_offset - entry.offset) {
+      records_.clear();
+      return false;
+    }
+
+    record.type = static_cast<DsgLogRecord::Type>(entry.type);
+    record.codec = static_cast<DsgCodec>(entry.codec);
+    record.timestamp_ns = entry.timestamp_ns;
+    record.sequence_number = entry.sequence_number;
+    record.uncompressed_size = entry.uncompressed_size;
+    record.offset = entry.offset;
+    record.size = entry.size;
+  }
+
+  return true;
+}
+
+void DsgLogReader::scanRecords() {
+  size_t offset = sizeof(FileHeader);
+  while (size_ - offset >= sizeof(RecordHeader)) {
+    const auto header = readBytes<RecordHeader>(data_ + offset);
+    if (header.magic != kRecordMagic || !validType(header.type)) {
+      break;
+    }
+
+    const size_t payload_offset = offset + sizeof(RecordHeader);
+    if (header.size > size_ - payload_offset) {
+      break;  // partially written record
+    }
+
+    DsgLogRecord record;
+    record.type = static_cast<DsgLogRecord::Type>(header.type);
+    record.codec = static_cast<DsgCodec>(header.codec);
+    record.timestamp_ns = header.timestamp_ns;
+    record.sequence_number = header.sequence_number;
+    record.uncompressed_size = header.uncompressed_size;
+    record.offset = payload_offset;
+    record.size = header.size;
+    records_.push_back(record);
+    offset = payload_offset + header.size;
+  }
+}
+
+const uint8_t* DsgLogReader::payload(size_t index) const {
+  return data_ + records_.at(index).offset;
+}
+
+std::optional<size_t> DsgLogReader::findKeyframe(uint64_t timestamp_ns) const {
+  if (keyframes_.empty()) {
+    return std::nullopt;
+  }
+
+  const auto iter = std::upper_bound(keyframes_.begin(),
+                                     keyframes_.end(),
+                                     timestamp_ns,
+                                     [&](uint64_t stamp, size_t i) {
+                                       return stamp < records_[i].timestamp_ns;
+                                     });
+  return iter == keyframes_.begin() ? *iter : *(iter - 1);
+}
+
+bool DsgLogReader::apply(size_t index, State& state) const {
+  const auto& record = records_.at(index);
+  const uint8_t* data = payload(index);
+  size_t size = record.size;
+
+  UpdateView update;
+  if (record.type != DsgLogRecord::Type::SNAPSHOT) {
+    if (!parseUpdate(data, size, update)) {
+      LOG(ERROR) << "Invalid update in scene graph log at record " << index;
+      return false;
+    }
+
+    data = update.contents;
+    size = update.contents_size;
+  }
+
+  if (record.type == DsgLogRecord::Type::DELTA_UPDATE &&
+      (!state.graph || !state.sequence_number ||
+       record.sequence_number != *state.sequence_number + 1)) {
+    VLOG(2) << "Skipping delta " << record.sequence_number << " at record " << index;
+    return false;
+  }
+
+  std::vector<uint8_t> decompressed;
+  if (record.codec != DsgCodec::NONE) {
+    try {
+      // decompress straight out of the mapped file
+      decompressPayload(
+          record.codec, record.uncompressed_size, data, size, decompressed);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Failed to decompress record " << index << ": " << e.what();
+      return false;
+    }
+
+    data = decompressed.data();
+    size = decompressed.size();
+  }
+
+  try {
+    if (record.type == DsgLogRecord::Type::DELTA_UPDATE) {
+      spark_dsg::io::binary::updateGraph(*state.graph, data, size, false);
+    } else if (!state.graph) {
+      state.graph = spark_dsg::io::binary::readGraph(data, size);
+    } else {
+      spark_dsg::io::binary::updateGraph(*state.graph, data, size);
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Invalid graph in scene graph log at record " << index << ": "
+               << e.what();
+    return false;
+  }
+
+  for (const auto node_id : update.deleted_nodes) {
+    state.graph->removeNode(node_id);
+  }
+
+  for (size_t i = 0; i + 1 < update.deleted_edges.size(); i += 2) {
+    state.graph->removeEdge(update.deleted_edges[i], update.deleted_edges[i + 1]);
+  }
+
+  state.sequence_number = record.sequence_number;
+  state.timestamp_ns = record.timestamp_ns;
+  return true;
+}
+
+DsgLogReader::State DsgLogReader::seek(uint64_t timestamp_ns,
+                                       size_t* next_index) const {
+  State state;
+  const auto keyframe = findKeyframe(timestamp_ns);
+  size_t index = keyframe ? *keyframe : records_.size();
+  if (keyframe) {
+    apply(index, state);
+    ++index;
+  }
+
+  for (; index < records_.size(); ++index) {
+    if (records_[index].timestamp_ns > timestamp_ns) {
+      break;
+    }
+
+    apply(index, state);
+  }
+
+  if (next_index) {
+    *next_index = index;
+  }
+
+  return state;
+}
+
+}  // namespace hydra
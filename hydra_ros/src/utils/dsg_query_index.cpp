@@ -0,0 +1,242 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/utils/dsg_query_index.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+namespace hydra {
+
+namespace {
+
+void removeFromBucket(std::unordered_map<uint64_t, std::vector<NodeId>>& buckets,
+                      uint64_t key,
+                      NodeId node) {
+  auto iter = buckets.find(key);
+  if (iter == buckets.end()) {
+    return;
+  }
+
+  auto& nodes = iter->second;
+  nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+  if (nodes.empty()) {
+    buckets.erase(iter);
+  }
+}
+
+}  // namespace
+
+DsgQueryIndex::DsgQueryIndex(double resolution) : resolution_(resolution) {
+  CHECK_GT(resolution_, 0.0) << "invalid query index resolution";
+}
+
+void DsgQueryIndex::clear() {
+  entries_.clear();
+  cells_.clear();
+  labels_.clear();
+  children_.clear();
+}
+
+void DsgQueryIndex::updateNode(NodeId node, const Entry& entry) {
+  auto iter = entries_.find(node);
+  if (iter != entries_.end()) {
+    const auto& prev = iter->second;
+    if (prev.layer == entry.layer && prev.position == entry.position &&
+        prev.label == entry.label && prev.parent == entry.parent) {
+      return;
+    }
+
+    erase(node, prev);
+    entries_.erase(iter);
+  }
+
+  const auto new_iter = entries_.emplace(node, entry).first;
+  insert(node, new_iter->second);
+}
+
+void DsgQueryIndex::removeNode(NodeId node) {
+  auto iter = entries_.find(node);
+  if (iter == entries_.end()) {
+    return;
+  }
+
+  erase(node, iter->second);
+  entries_.erase(iter);
+}
+
+void DsgQueryIndex::update(const DynamicSceneGraph& graph) {
+  std::unordered_set<NodeId> seen;
+  for (const auto& [layer_id, layer] : graph.layers()) {
+    for (const auto& [node_id, node] : layer->nodes()) {
+      const auto& attrs = node->attributes();
+      const auto semantic = dynamic_cast<const SemanticNodeAttributes*>(&attrs);
+
+      Entry entry{layer_id, attrs.position, std::nullopt, node->getParent()};
+      if (semantic) {
+        entry.label = semantic->semantic_label;
+      }
+
+      seen.insert(node_id);
+      updateNode(node_id, entry);
+    }
+  }
+
+  std::vector<NodeId> to_remove;
+  for (const auto& id_entry_pair : entries_) {
+    if (!seen.count(id_entry_pair.first)) {
+      to_remove.push_back(id_entry_pair.first);
+    }
+  }
+
+  for (const auto node : to_remove) {
+    removeNode(node);
+  }
+}
+
+std::optional<NodeId> DsgQueryIndex::nearestWithLabel(
+    LayerId layer, uint32_t label, const Eigen::Vector3d& point) const {
+  const auto layer_iter = labels_.find(layer);
+  if (layer_iter == labels_.end()) {
+    return std::nullopt;
+  }
+
+  const auto iter = layer_iter->second.find(label);
+  if (iter == layer_iter->second.end()) {
+    return std::nullopt;
+  }
+
+  std::optional<NodeId> best;
+  double best_dist = std::numeric_limits<double>::infinity();
+  for (const auto node : iter->second) {
+    const double dist = (entries_.at(node).position - point).squaredNorm();
+    if (dist < best_dist) {
+      best = node;
+      best_dist = dist;
+    }
+  }
+
+  return best;
+}
+
+std::vector<NodeId> DsgQueryIndex::withinRadius(LayerId layer,
+                                                const Eigen::Vector3d& point,
+                                                double radius) const {
+  std::vector<NodeId> result;
+  const auto layer_iter = cells_.find(layer);
+  if (layer_iter == cells_.end() || radius < 0.0) {
+    return result;
+  }
+
+  const auto& cells = layer_iter->second;
+  const double radius_sq = radius * radius;
+  auto add_cell = [&](const std::vector<NodeId>& nodes) {
+    for (const auto node : nodes) {
+      if ((entries_.at(node).position - point).squaredNorm() <= radius_sq) {
+        result.push_back(node);
+      }
+    }
+  };
+
+  const Eigen::Vector3d offset = Eigen::Vector3d::Constant(radius);
+  const auto min_index = toIndex(point - offset);
+  const auto max_index = toIndex(point + offset);
+  const Eigen::Vector3d extent = (max_index - min_index).cast<double>().array() + 1.0;
+  // large radii visit fewer cells by walking the occupied ones instead of the box
+  if (extent.prod() > static_cast<double>(cells.size())) {
+    for (const auto& key_nodes_pair : cells) {
+      add_cell(key_nodes_pair.second);
+    }
+
+    return result;
+  }
+
+  for (int x = min_index.x(); x <= max_index.x(); ++x) {
+    for (int y = min_index.y(); y <= max_index.y(); ++y) {
+      for (int z = min_index.z(); z <= max_index.z(); ++z) {
+        const auto iter = cells.find(toKey(Eigen::Vector3i(x, y, z)));
+        if (iter != cells.end()) {
+          add_cell(iter->second);
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+std::vector<NodeId> DsgQueryIndex::children(NodeId node) const {
+  const auto iter = children_.find(node);
+  return iter == children_.end() ? std::vector<NodeId>() : iter->second;
+}
+
+DsgQueryIndex::CellKey DsgQueryIndex::toKey(const Eigen::Vector3i& index) const {
+  // 21 bits per axis is enough for +/- 1e6 cells
+  constexpr uint64_t mask = (uint64_t{1} << 21) - 1;
+  return (static_cast<uint64_t>(index.x()) & mask) |
+         ((static_cast<uint64_t>(index.y()) & mask) << 21) |
+         ((static_cast<uint64_t>(index.z()) & mask) << 42);
+}
+
+Eigen::Vector3i DsgQueryIndex::toIndex(const Eigen::Vector3d& point) const {
+  return (point / resolution_).array().floor().cast<int>();
+}
+
+void DsgQueryIndex::insert(NodeId node, const Entry& entry) {
+  cells_[entry.layer][toKey(toIndex(entry.position))].push_back(node);
+  if (entry.label) {
+    labels_[entry.layer][*entry.label].push_back(node);
+  }
+
+  if (entry.parent) {
+    children_[*entry.parent].push_back(node);
+  }
+}
+
+void DsgQueryIndex::erase(NodeId node, const Entry& entry) {
+  removeFromBucket(cells_[entry.layer], toKey(toIndex(entry.position)), node);
+  if (entry.label) {
+    removeFromBucket(labels_[entry.layer], *entry.label, node);
+  }
+
+  if (entry.parent) {
+    removeFromBucket(children_, *entry.parent, node);
+  }
+}
+
+}  // namespace hydra
@@ -34,6 +34,7 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_ros/utils/dsg_streaming_interface.h"
 
+#include <config_utilities/parsing/ros.h>
 #include <glog/logging.h>
 #include <hydra/common/dsg_types.h>
 #include <hydra/utils/display_utilities.h>
@@ -43,8 +44,49 @@
 #include <kimera_pgmo_ros/conversion/ros_conversion.h>
 #include <spark_dsg/serialization/graph_binary_serialization.h>
 
+#include <boost/make_shared.hpp>
+#include <chrono>
+
+#include "hydra_ros/utils/latency_tracer.h"
+#include "hydra_ros/utils/mesh_delta.h"
+#include "hydra_ros/utils/metrics.h"
+
 namespace hydra {
 
+namespace {
+
+inline std::pair<NodeId, NodeId> edgeKey(NodeId source, NodeId target) {
+  return source < target ? std::make_pair(source, target)
+                         : std::make_pair(target, source);
+}
+
+template <typename Edges>
+void addEdges(const Edges& edges, std::set<std::pair<NodeId, NodeId>>& keys) {
+  for (const auto& id_edge_pair : edges) {
+    const auto& edge = id_edge_pair.second;
+    keys.insert(edgeKey(edge.source, edge.target));
+  }
+}
+
+//! Budgets track the link, so they use wall time instead of graph stamps
+inline uint64_t steadyTimeNs() {
+  const auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+std::set<std::pair<NodeId, NodeId>> getEdgeKeys(const DynamicSceneGraph& graph) {
+  std::set<std::pair<NodeId, NodeId>> keys;
+  for (const auto& id_layer_pair : graph.layers()) {
+    addEdges(id_layer_pair.second->edges(), keys);
+  }
+
+  addEdges(graph.interlayer_edges(), keys);
+  addEdges(graph.dynamic_interlayer_edges(), keys);
+  return keys;
+}
+
+}  // namespace
+
 DsgSender::DsgSender(const ros::NodeHandle& nh,
                      const std::string& frame_id,
                      const std::string& timer_name,
@@ -56,27 +98,521 @@ DsgSender::DsgSender(const ros::NodeHandle& nh,
       timer_name_(timer_name),
       publish_mesh_(publish_mesh),
       min_mesh_separation_s_(min_mesh_separation_s),
-      serialize_dsg_mesh_(serialize_dsg_mesh) {
-  pub_ = nh_.advertise<hydra_msgs::DsgUpdate>("dsg", 1);
+      serialize_dsg_mesh_(serialize_dsg_mesh),
+      full_update_period_(0),
+      codec_(DsgCodec::NONE),
+      compression_level_(1),
+      profile_(DsgProfile::FULL),
+      position_resolution_(0.01),
+      compact_mesh_delta_(false),
+      mesh_position_resolution_(0.001),
+      sequence_number_(0),
+      updates_since_full_(0),
+      num_delta_nodes_(0),
+      resync_requested_(true),
+      mesh_sequence_number_(0),
+      mesh_updates_since_full_(0),
+      mesh_resync_requested_(true),
+      get_dsg_timeout_s_(0.5),
+      cache_requested_(false),
+      graph_revision_(0),
+      cache_revision_(0),
+      async_publish_(false),
+      should_shutdown_(false),
+      num_dropped_(0) {
+  nh_.getParam("dsg_full_update_period", full_update_period_);
+  nh_.getParam("get_dsg_timeout_s", get_dsg_timeout_s_);
+  nh_.getParam("async_publish", async_publish_);
+
+  std::string codec_name = codecToString(codec_);
+  nh_.getParam("dsg_codec", codec_name);
+  const auto codec = codecFromString(codec_name);
+  if (codec) {
+    codec_ = *codec;
+  } else {
+    ROS_ERROR_STREAM("Unknown dsg codec '" << codec_name << "'. Sending uncompressed");
+  }
+
+  nh_.getParam("dsg_compression_level", compression_level_);
+
+  std::string profile_name = profileToString(profile_);
+  nh_.getParam("dsg_profile", profile_name);
+  const auto profile = profileFromString(profile_name);
+  if (profile) {
+    profile_ = *profile;
+  } else {
+    ROS_ERROR_STREAM("Unknown dsg profile '" << profile_name << "'. Sending full");
+  }
+
+  nh_.getParam("dsg_position_resolution", position_resolution_);
+  nh_.getParam("compact_mesh_delta", compact_mesh_delta_);
+  nh_.getParam("mesh_position_resolution", mesh_position_resolution_);
+  if (compact_mesh_delta_ && mesh_position_resolution_ <= 0.0) {
+    ROS_ERROR_STREAM("Invalid mesh position resolution "
+                     << mesh_position_resolution_ << ". Sending raw mesh deltas");
+    compact_mesh_delta_ = false;
+  }
+
+  if (nh_.hasParam("stream_scheduler")) {
+    const ros::NodeHandle scheduler_nh(nh_, "stream_scheduler");
+    if (full_update_period_ > 0) {
+      scheduler_.reset(
+          new StreamScheduler(config::fromRos<StreamScheduler::Config>(scheduler_nh)));
+    } else {
+      ROS_WARN_STREAM("[" << timer_name_ << "] stream_scheduler requires delta "
+                          << "updates (dsg_full_update_period > 0). Ignoring");
+    }
+  }
+
+  if (publish_mesh_ && nh_.hasParam("mesh_stream_scheduler")) {
+    const ros::NodeHandle scheduler_nh(nh_, "mesh_stream_scheduler");
+    mesh_scheduler_.reset(
+        new StreamScheduler(config::fromRos<StreamScheduler::Config>(scheduler_nh)));
+  }
+
+  // deltas only apply in order, so queue enough of them to ride out short stalls
+  int queue_size = 10;
+  nh_.getParam("dsg_queue_size", queue_size);
+  pub_ = nh_.advertise<hydra_msgs::DsgUpdate>("dsg", queue_size);
+  if (full_update_period_ > 0) {
+    resync_sub_ =
+        nh_.subscribe(pub_.getTopic() + "_resync", 1, &DsgSender::handleResync, this);
+  }
+
   if (publish_mesh_) {
     mesh_pub_ = nh_.advertise<kimera_pgmo_msgs::KimeraPgmoMesh>("dsg_mesh", 1, false);
+    mesh_delta_pub_ =
+        nh_.advertise<hydra_msgs::MeshDelta>("dsg_mesh_delta", queue_size, false);
+    mesh_resync_sub_ = nh_.subscribe(mesh_delta_pub_.getTopic() + "_resync",
+                                     1,
+                                     &DsgSender::handleMeshResync,
+                                     this);
+  }
+
+  service_nh_ = nh_;
+  service_threads_.reset(new CallbackThreads(service_nh_, 1));
+  get_dsg_service_ =
+      service_nh_.advertiseService("get_dsg", &DsgSender::handleGetDsg, this);
+
+  std::string shm_name;
+  nh_.getParam("shm_name", shm_name);
+  if (!shm_name.empty()) {
+    int shm_capacity_mb = 256;
+    nh_.getParam("shm_capacity_mb", shm_capacity_mb);
+    int shm_permissions = 0600;
+    nh_.getParam("shm_permissions", shm_permissions);
+    shm_writer_.reset(new SharedDsgWriter(
+        shm_name, shm_capacity_mb * 1024 * 1024, shm_permissions));
+    if (!shm_writer_->valid()) {
+      shm_writer_.reset();
+    }
+  }
+
+  if (async_publish_) {
+    publish_thread_.reset(new std::thread(&DsgSender::publishLoop, this));
+  }
+}
+
+DsgSender::~DsgSender() {
+  service_threads_->stop();
+  get_dsg_service_.shutdown();
+  if (!publish_thread_) {
+    return;
+  }
+
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    should_shutdown_ = true;
+  }  // end critical section
+
+  pending_cv_.notify_all();
+  publish_thread_->join();
+  publish_thread_.reset();
+
+  if (num_dropped_) {
+    VLOG(1) << "[" << timer_name_ << "] dropped " << num_dropped_
+            << " graphs while publishing";
+  }
+}
+
+void DsgSender::handleResync(const std_msgs::Empty::ConstPtr&) {
+  VLOG(2) << "[" << timer_name_ << "] resync requested for " << pub_.getTopic();
+  resync_requested_ = true;
+}
+
+void DsgSender::handleMeshResync(const std_msgs::Empty::ConstPtr&) {
+  VLOG(2) << "[" << timer_name_ << "] resync requested for "
+          << mesh_delta_pub_.getTopic();
+  mesh_resync_requested_ = true;
+}
+
+bool DsgSender::shouldSendFullUpdate() const {
+  if (full_update_period_ <= 0) {
+    return true;
+  }
+
+  return resync_requested_.exchange(false) ||
+         updates_since_full_ >= full_update_period_;
+}
+
+void DsgSender::fillFullUpdate(const DynamicSceneGraph& graph,
+                               hydra_msgs::DsgUpdate& msg,
+                               std::vector<uint8_t>& serialized) const {
+  msg.full_update = true;
+  if (profile_ != DsgProfile::FULL) {
+    // reduction only ever touches a copy so the delta state keeps full precision
+    writeContents(*graph.clone(), msg);
+    return;
+  }
+
+  // reuses the encoding written for shared memory (if any) without copying it
+  if (serialized.empty()) {
+    spark_dsg::io::binary::writeGraph(graph, serialized, serialize_dsg_mesh_);
+  }
+
+  msg.layer_contents.swap(serialized);
+  msg.profile = static_cast<uint8_t>(DsgProfile::FULL);
+}
+
+void DsgSender::writeContents(DynamicSceneGraph& graph,
+                              hydra_msgs::DsgUpdate& msg) const {
+  msg.profile = static_cast<uint8_t>(profile_);
+  if (profile_ == DsgProfile::REDUCED) {
+    reduceGraph(graph, position_resolution_);
+    msg.position_resolution = position_resolution_;
+  }
+
+  spark_dsg::io::binary::writeGraph(graph, msg.layer_contents, serialize_dsg_mesh_);
+}
+
+void DsgSender::compressUpdate(hydra_msgs::DsgUpdate& msg) const {
+  msg.uncompressed_size = msg.layer_contents.size();
+  msg.codec = static_cast<uint8_t>(DsgCodec::NONE);
+  if (codec_ == DsgCodec::NONE || msg.layer_contents.empty()) {
+    return;
+  }
+
+  std::vector<uint8_t> compressed;
+  {  // start timing scope
+    LatencyTimer timer(timer_name_ + "_compress", msg.header.stamp.toNSec());
+    try {
+      compressPayload(codec_, compression_level_, msg.layer_contents, compressed);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "[" << timer_name_ << "] " << e.what() << ". Sending uncompressed";
+      return;
+    }
+  }  // end timing scope
+
+  const double ratio = static_cast<double>(msg.uncompressed_size) / compressed.size();
+  VLOG(5) << "[" << timer_name_ << "] compressed dsg with " << codecToString(codec_)
+          << ": " << msg.uncompressed_size << " -> " << compressed.size()
+          << " bytes (ratio: " << ratio << ")";
+  // the compression time is reported by the timer above
+  auto& metrics = MetricsRegistry::instance();
+  metrics.addCount(timer_name_ + "/uncompressed_bytes", msg.uncompressed_size);
+  metrics.addCount(timer_name_ + "/compressed_bytes", compressed.size());
+  metrics.setGauge(timer_name_ + "/compression_ratio", ratio);
+  msg.layer_contents.swap(compressed);
+  msg.codec = static_cast<uint8_t>(codec_);
+}
+
+void DsgSender::resetDeltaState(const DynamicSceneGraph& graph) const {
+  updates_since_full_ = 0;
+  if (full_update_period_ <= 0) {
+    return;
+  }
+
+  sent_nodes_.clear();
+  for (const auto& id_layer_pair : graph.layers()) {
+    for (const auto& id_node_pair : id_layer_pair.second->nodes()) {
+      sent_nodes_[id_node_pair.first] = id_node_pair.second->attributes().clone();
+    }
+  }
+
+  sent_edges_ = getEdgeKeys(graph);
+}
+
+void DsgSender::fillDeltaUpdate(const DynamicSceneGraph& graph,
+                                hydra_msgs::DsgUpdate& msg) const {
+  auto curr_edges = getEdgeKeys(graph);
+
+  std::set<NodeId> to_send;
+  for (const auto& id_layer_pair : graph.layers()) {
+    for (const auto& [node_id, node] : id_layer_pair.second->nodes()) {
+      auto iter = sent_nodes_.find(node_id);
+      if (iter == sent_nodes_.end() || !(*iter->second == node->attributes())) {
+        to_send.insert(node_id);
+      }
+    }
+  }
+
+  // new edges only survive in the delta if both endpoints are present
+  for (const auto& key : curr_edges) {
+    if (!sent_edges_.count(key)) {
+      to_send.insert(key.first);
+      to_send.insert(key.second);
+    }
+  }
+
+  if (scheduler_) {
+    scheduleDelta(graph, to_send, curr_edges);
+  }
+
+  for (auto iter = sent_nodes_.begin(); iter != sent_nodes_.end();) {
+    if (graph.hasNode(iter->first)) {
+      ++iter;
+      continue;
+    }
+
+    msg.deleted_nodes.push_back(iter->first);
+    iter = sent_nodes_.erase(iter);
+  }
+
+  for (const auto& key : sent_edges_) {
+    if (curr_edges.count(key) || !graph.hasNode(key.first) ||
+        !graph.hasNode(key.second)) {
+      continue;
+    }
+
+    msg.deleted_edges.push_back(key.first);
+    msg.deleted_edges.push_back(key.second);
   }
+
+  // dynamic layers are always sent in full to preserve their node indices
+  auto delta = graph.clone();
+  for (const auto& id_layer_pair : graph.layers()) {
+    for (const auto& id_node_pair : id_layer_pair.second->nodes()) {
+      const auto node_id = id_node_pair.first;
+      if (to_send.count(node_id)) {
+        sent_nodes_[node_id] = id_node_pair.second->attributes().clone();
+      } else {
+        delta->removeNode(node_id);
+      }
+    }
+  }
+
+  sent_edges_ = std::move(curr_edges);
+  writeContents(*delta, msg);
+  msg.full_update = false;
+  ++updates_since_full_;
+  num_delta_nodes_ = to_send.size();
+}
+
+void DsgSender::scheduleDelta(const DynamicSceneGraph& graph,
+                              std::set<NodeId>& to_send,
+                              EdgeSet& curr_edges) const {
+  std::map<LayerId, std::vector<NodeId>> pending;
+  for (const auto& [layer_id, layer] : graph.layers()) {
+    for (const auto& id_node_pair : layer->nodes()) {
+      if (to_send.count(id_node_pair.first)) {
+        pending[layer_id].push_back(id_node_pair.first);
+      }
+    }
+  }
+
+  std::map<LayerId, size_t> num_pending;
+  for (const auto& [layer_id, nodes] : pending) {
+    num_pending[layer_id] = nodes.size();
+  }
+
+  const auto scheduled = scheduler_->schedule(steadyTimeNs(), num_pending);
+  auto& metrics = MetricsRegistry::instance();
+  std::set<NodeId> deferred;
+  for (const auto& [layer_id, nodes] : pending) {
+    if (scheduled.count(layer_id)) {
+      continue;
+    }
+
+    const auto layer_name = DsgLayers::LayerIdToString(layer_id);
+    metrics.addCount(timer_name_ + "/deferred_nodes", nodes.size());
+    metrics.addCount(timer_name_ + "/deferred/" + layer_name, nodes.size());
+    VLOG(5) << "[" << timer_name_ << "] deferring " << nodes.size()
+            << " nodes of layer " << layer_name;
+    deferred.insert(nodes.begin(), nodes.end());
+  }
+
+  if (deferred.empty()) {
+    return;
+  }
+
+  // deferred nodes stay out of sent_nodes_ and are picked up again next update
+  for (const auto node_id : deferred) {
+    to_send.erase(node_id);
+  }
+
+  // new edges to deferred nodes are not in the delta and have to be detected again
+  for (auto iter = curr_edges.begin(); iter != curr_edges.end();) {
+    const bool is_new = !sent_edges_.count(*iter);
+    if (is_new && (deferred.count(iter->first) || deferred.count(iter->second))) {
+      iter = curr_edges.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void DsgSender::cacheFullUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg) const {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    cached_update_ = msg;
+    cache_revision_ = graph_revision_;
+  }  // end critical section
+  cache_cv_.notify_all();
+}
+
+bool DsgSender::handleGetDsg(hydra_msgs::GetDsg::Request&,
+                             hydra_msgs::GetDsg::Response& res) {
+  std::unique_lock<std::mutex> lock(cache_mutex_);
+  if (!cached_update_ || cache_revision_ != graph_revision_) {
+    // the next call to sendGraph serializes the graph once for all waiting callers
+    cache_requested_ = true;
+    const std::chrono::duration<double> timeout(get_dsg_timeout_s_);
+    cache_cv_.wait_for(lock, timeout, [this]() {
+      return cached_update_ && cache_revision_ == graph_revision_;
+    });
+  }
+
+  if (!cached_update_) {
+    ROS_WARN_STREAM("[" << timer_name_ << "] no scene graph available for get_dsg");
+    return false;
+  }
+
+  res.graph = *cached_update_;
+  return true;
 }
 
 void DsgSender::sendGraph(const DynamicSceneGraph& graph,
                           const ros::Time& stamp) const {
+  if (!publish_thread_) {
+    publishGraph(graph, stamp);
+    return;
+  }
+
+  const bool graph_needed =
+      shm_writer_ || cache_requested_ || pub_.getNumSubscribers() > 0;
+  const bool mesh_needed = publish_mesh_ && (mesh_pub_.getNumSubscribers() > 0 ||
+                                             mesh_delta_pub_.getNumSubscribers() > 0);
+  if (!graph_needed && !mesh_needed) {
+    // nothing would read the copy, but get_dsg has to know the cache is stale
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    ++graph_revision_;
+    return;
+  }
+
+  LatencyTimer timer(timer_name_ + "_snapshot", stamp.toNSec());
+  auto snapshot = graph.clone();
+  // make sure the publisher thread never reads a mesh the caller is modifying
+  const auto mesh = graph.mesh();
+  if (mesh && (mesh_needed || (graph_needed && serialize_dsg_mesh_))) {
+    snapshot->setMesh(std::make_shared<Mesh>(*mesh));
+  } else {
+    snapshot->setMesh(nullptr);
+  }
+
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    if (pending_graph_) {
+      ++num_dropped_;
+      MetricsRegistry::instance().addCount(timer_name_ + "/dropped_graphs");
+    }
+
+    pending_graph_ = snapshot;
+    pending_stamp_ = stamp;
+  }  // end critical section
+
+  pending_cv_.notify_one();
+}
+
+void DsgSender::publishLoop() const {
+  while (true) {
+    DynamicSceneGraph::Ptr graph;
+    ros::Time stamp;
+    {  // start critical section
+      std::unique_lock<std::mutex> lock(pending_mutex_);
+      pending_cv_.wait(lock, [this]() { return should_shutdown_ || pending_graph_; });
+      if (!pending_graph_) {
+        return;  // only reachable on shutdown
+      }
+
+      graph = std::move(pending_graph_);
+      stamp = pending_stamp_;
+    }  // end critical section
+
+    publishGraph(*graph, stamp);
+  }
+}
+
+void DsgSender::publishGraph(const DynamicSceneGraph& graph,
+                             const ros::Time& stamp) const {
   const uint64_t timestamp_ns = stamp.toNSec();
-  timing::ScopedTimer timer(timer_name_, timestamp_ns);
+  LatencyTimer timer(timer_name_, timestamp_ns);
+  auto& metrics = MetricsRegistry::instance();
+
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    ++graph_revision_;
+  }  // end critical section
+
+  // the graph is encoded at most once per publish and shared by every output
+  std::vector<uint8_t> serialized;
+  if (shm_writer_) {
+    LatencyTimer shm_timer(timer_name_ + "_shm", timestamp_ns);
+    spark_dsg::io::binary::writeGraph(graph, serialized, serialize_dsg_mesh_);
+    shm_writer_->write(serialized.data(), serialized.size(), timestamp_ns);
+  }
+
+  const bool cache_requested = cache_requested_.exchange(false);
+  const bool publish = pub_.getNumSubscribers() > 0;
+  const bool send_full = publish && shouldSendFullUpdate();
+  if (send_full || cache_requested) {
+    auto msg = boost::make_shared<hydra_msgs::DsgUpdate>();
+    msg->header.stamp = stamp;
+    fillFullUpdate(graph, *msg, serialized);
+    compressUpdate(*msg);
+    if (send_full) {
+      resetDeltaState(graph);
+      msg->sequence_number = sequence_number_++;
+      pub_.publish(msg);
+      metrics.addCount(timer_name_ + "/messages");
+      metrics.addCount(timer_name_ + "/bytes", msg->layer_contents.size());
+      if (scheduler_) {
+        // full updates are never deferred, but later deltas wait for the budget
+        scheduler_->consume(steadyTimeNs(), msg->layer_contents.size());
+      }
+    } else if (sequence_number_ > 0) {
+      // matches the last published message so deltas can be applied on top
+      msg->sequence_number = sequence_number_ - 1;
+    } else {
+      // nothing was published yet, so the next (full) update reuses this number
+      msg->sequence_number = 0;
+    }
 
-  if (pub_.getNumSubscribers()) {
+    cacheFullUpdate(msg);
+  }
+
+  if (publish && !send_full) {
     hydra_msgs::DsgUpdate msg;
     msg.header.stamp = stamp;
-    spark_dsg::io::binary::writeGraph(graph, msg.layer_contents, serialize_dsg_mesh_);
-    msg.full_update = true;
+    fillDeltaUpdate(graph, msg);
+    compressUpdate(msg);
+    msg.sequence_number = sequence_number_++;
     pub_.publish(msg);
+    metrics.addCount(timer_name_ + "/messages");
+    metrics.addCount(timer_name_ + "/bytes", msg.layer_contents.size());
+    if (scheduler_) {
+      scheduler_->consume(
+          steadyTimeNs(), msg.layer_contents.size(), num_delta_nodes_);
+    }
   }
 
-  if (!publish_mesh_ || !mesh_pub_.getNumSubscribers()) {
+  LatencyTracer::instance().mark(timestamp_ns, timer_name_ + "_publish");
+  if (!publish_mesh_) {
+    return;
+  }
+
+  const bool publish_full_mesh = mesh_pub_.getNumSubscribers() > 0;
+  const bool publish_mesh_delta = mesh_delta_pub_.getNumSubscribers() > 0;
+  if (!publish_full_mesh && !publish_mesh_delta) {
     return;
   }
 
@@ -93,19 +629,101 @@ void DsgSender::sendGraph(const DynamicSceneGraph& graph,
     }
   }
 
+  if (mesh_scheduler_) {
+    // the mesh is one stream, so its estimate is the size of the last message
+    const auto scheduled = mesh_scheduler_->schedule(steadyTimeNs(), {{0, 1}});
+    if (scheduled.empty()) {
+      metrics.addCount(timer_name_ + "/deferred_meshes");
+      return;
+    }
+  }
+
   last_mesh_time_ns_ = timestamp_ns;
+  if (publish_mesh_delta) {
+    publishMeshDelta(*mesh, timestamp_ns);
+  }
+
+  if (!publish_full_mesh) {
+    return;
+  }
 
   kimera_pgmo_msgs::KimeraPgmoMesh msg = kimera_pgmo::conversions::toMsg(*mesh);
   msg.header.stamp.fromNSec(timestamp_ns);
   msg.header.frame_id = frame_id_;
   mesh_pub_.publish(msg);
+  if (mesh_scheduler_) {
+    mesh_scheduler_->consume(
+        steadyTimeNs(), ros::serialization::serializationLength(msg), 1);
+  }
+}
+
+void DsgSender::publishMeshDelta(const Mesh& mesh, uint64_t timestamp_ns) const {
+  LatencyTimer timer(timer_name_ + "_mesh_delta", timestamp_ns);
+  const bool send_full = mesh_resync_requested_.exchange(false) || !sent_mesh_ ||
+                         (full_update_period_ > 0 &&
+                          mesh_updates_since_full_ >= full_update_period_);
+
+  hydra_msgs::MeshDelta msg;
+  msg.header.stamp.fromNSec(timestamp_ns);
+  msg.header.frame_id = frame_id_;
+  fillMeshDelta(send_full ? nullptr : sent_mesh_.get(), mesh, msg);
+  msg.sequence_number = mesh_sequence_number_++;
+  mesh_updates_since_full_ = msg.full_update ? 0 : mesh_updates_since_full_ + 1;
+  VLOG(5) << "[" << timer_name_ << "] sending " << msg.vertex_indices.size() << " / "
+          << msg.num_vertices << " vertices and " << msg.face_indices.size() << " / "
+          << msg.num_faces << " faces";
+  if (compact_mesh_delta_) {
+    try {
+      encodeMeshDelta(msg, mesh_position_resolution_, codec_, compression_level_);
+      VLOG(5) << "[" << timer_name_ << "] packed mesh delta into "
+              << msg.compact_data.size() << " bytes";
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Failed to pack mesh delta, sending raw delta: " << e.what();
+    }
+  }
+
+  mesh_delta_pub_.publish(msg);
+  if (mesh_scheduler_) {
+    mesh_scheduler_->consume(
+        steadyTimeNs(), ros::serialization::serializationLength(msg), 1);
+  }
+
+  sent_mesh_ = std::make_shared<Mesh>(mesh);
 }
 
 DsgReceiver::DsgReceiver(const ros::NodeHandle& nh, bool subscribe_to_mesh)
-    : nh_(nh), has_update_(false), graph_(nullptr) {
-  sub_ = nh_.subscribe("dsg", 1, &DsgReceiver::handleUpdate, this);
+    : nh_(nh),
+      has_update_(false),
+      profile_(DsgProfile::FULL),
+      sequence_(nh.param("dsg_resync_retry", 10)),
+      mesh_sequence_(nh.param("dsg_resync_retry", 10)),
+      graph_(nullptr),
+      snapshot_dirty_(false),
+      mesh_dirty_(false) {
+  int queue_size = 10;
+  nh_.getParam("dsg_queue_size", queue_size);
+
+  std::string shm_name;
+  nh_.getParam("shm_name", shm_name);
+  if (shm_name.empty()) {
+    sub_ = nh_.subscribe("dsg", queue_size, &DsgReceiver::handleUpdate, this);
+    resync_pub_ = nh_.advertise<std_msgs::Empty>(sub_.getTopic() + "_resync", 1);
+  } else {
+    // the sender is on the same machine, so skip the topic and read the graph in place
+    double shm_poll_period_s = 0.01;
+    nh_.getParam("shm_poll_period_s", shm_poll_period_s);
+    shm_reader_.reset(new SharedDsgReader(shm_name));
+    shm_timer_ = nh_.createWallTimer(ros::WallDuration(shm_poll_period_s),
+                                     &DsgReceiver::pollSharedMemory,
+                                     this);
+  }
+
   if (subscribe_to_mesh) {
     mesh_sub_ = nh_.subscribe("dsg_mesh_updates", 1, &DsgReceiver::handleMesh, this);
+    mesh_delta_sub_ = nh_.subscribe(
+        "dsg_mesh_delta", queue_size, &DsgReceiver::handleMeshDelta, this);
+    mesh_resync_pub_ =
+        nh_.advertise<std_msgs::Empty>(mesh_delta_sub_.getTopic() + "_resync", 1);
   }
 }
 
@@ -115,24 +733,61 @@ DsgReceiver::DsgReceiver(const ros::NodeHandle& nh, const LogCallback& log_cb)
 }
 
 void DsgReceiver::handleUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg) {
-  timing::ScopedTimer timer("receive_dsg", msg->header.stamp.toNSec());
-  if (!msg->full_update) {
-    throw std::runtime_error("not implemented");
-  }
-
+  LatencyTimer timer("receive_dsg", msg->header.stamp.toNSec());
+  auto& metrics = MetricsRegistry::instance();
+  metrics.addCount("receive_dsg/messages");
+  metrics.addCount("receive_dsg/bytes", msg->layer_contents.size());
   if (log_callback_) {
     (*log_callback_)(msg->header.stamp, msg->layer_contents.size());
   }
 
   const auto size_bytes = getHumanReadableMemoryString(msg->layer_contents.size());
   VLOG(5) << "Received dsg update message of " << size_bytes;
+
+  const auto profile = static_cast<DsgProfile>(msg->profile);
+  if (profile != DsgProfile::FULL && profile != DsgProfile::REDUCED) {
+    LOG(ERROR) << "Dropping dsg update with unknown profile "
+               << static_cast<int>(msg->profile);
+    MetricsRegistry::instance().addCount("receive_dsg/dropped_updates");
+    return;
+  }
+
+  // reduced updates use the regular encoding with rounded positions and fewer
+  // attributes, so they only need to be tracked for consumers of the graph
+  profile_ = profile;
+  VLOG_IF(5, profile == DsgProfile::REDUCED)
+      << "Received reduced dsg update (positions rounded to "
+      << msg->position_resolution << " m)";
+
+  const auto codec = static_cast<DsgCodec>(msg->codec);
+  std::vector<uint8_t> decompressed;
+  if (codec != DsgCodec::NONE) {
+    LatencyTimer timer("receive_dsg_decompress", msg->header.stamp.toNSec());
+    try {
+      decompressPayload(
+          codec, msg->uncompressed_size, msg->layer_contents, decompressed);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Failed to decompress dsg update: " << e.what();
+      requestResync();
+      return;
+    }
+  }
+
+  const auto& contents = codec == DsgCodec::NONE ? msg->layer_contents : decompressed;
+  if (!msg->full_update) {
+    applyDelta(*msg, contents);
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(graph_mutex_);
   try {
     if (!graph_) {
-      graph_ = spark_dsg::io::binary::readGraph(msg->layer_contents);
+      graph_ = spark_dsg::io::binary::readGraph(contents);
     } else {
-      spark_dsg::io::binary::updateGraph(*graph_, msg->layer_contents);
+      spark_dsg::io::binary::updateGraph(*graph_, contents);
     }
     has_update_ = true;
+    sequence_.applied(msg->sequence_number);
   } catch (const std::exception& e) {
     ROS_FATAL_STREAM("Received invalid message: " << e.what());
     ros::shutdown();
@@ -142,13 +797,145 @@ void DsgReceiver::handleUpdate(const hydra_msgs::DsgUpdate::ConstPtr& msg) {
   if (mesh_) {
     graph_->setMesh(mesh_);
   }
+
+  notifyUpdate();
+}
+
+void DsgReceiver::applyDelta(const hydra_msgs::DsgUpdate& msg,
+                             const std::vector<uint8_t>& contents) {
+  if (!graph_ || !sequence_.canApply(msg.sequence_number, false)) {
+    const auto last = sequence_.last();
+    VLOG(2) << "Dropping delta update " << msg.sequence_number
+            << " (last: " << (last ? std::to_string(*last) : "n/a") << ")";
+    MetricsRegistry::instance().addCount("receive_dsg/dropped_updates");
+    requestResync();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(graph_mutex_);
+  try {
+    spark_dsg::io::binary::updateGraph(*graph_, contents, false);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Received invalid delta update: " << e.what();
+    requestResync();
+    return;
+  }
+
+  for (const auto node_id : msg.deleted_nodes) {
+    graph_->removeNode(node_id);
+  }
+
+  for (size_t i = 0; i + 1 < msg.deleted_edges.size(); i += 2) {
+    graph_->removeEdge(msg.deleted_edges[i], msg.deleted_edges[i + 1]);
+  }
+
+  sequence_.applied(msg.sequence_number);
+  has_update_ = true;
+  if (mesh_) {
+    graph_->setMesh(mesh_);
+  }
+
+  notifyUpdate();
+}
+
+void DsgReceiver::pollSharedMemory(const ros::WallTimerEvent&) {
+  shm_reader_->readLatest([this](const uint8_t* data, size_t size, uint64_t stamp_ns) {
+    handleSharedGraph(data, size, stamp_ns);
+  });
+}
+
+void DsgReceiver::handleSharedGraph(const uint8_t* data,
+                                    size_t size,
+                                    uint64_t timestamp_ns) {
+  LatencyTimer timer("receive_dsg", timestamp_ns);
+  auto& metrics = MetricsRegistry::instance();
+  metrics.addCount("receive_dsg/messages");
+  metrics.addCount("receive_dsg/bytes", size);
+  if (log_callback_) {
+    ros::Time stamp;
+    stamp.fromNSec(timestamp_ns);
+    (*log_callback_)(stamp, size);
+  }
+
+  std::lock_guard<std::mutex> lock(graph_mutex_);
+  try {
+    if (!graph_) {
+      graph_ = spark_dsg::io::binary::readGraph(data, size);
+    } else {
+      spark_dsg::io::binary::updateGraph(*graph_, data, size);
+    }
+    has_update_ = true;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to parse shared memory graph: " << e.what();
+    return;
+  }
+
+  if (mesh_) {
+    graph_->setMesh(mesh_);
+  }
+
+  notifyUpdate();
+}
+
+void DsgReceiver::setUpdateCallback(const UpdateCallback& callback) {
+  update_callback_.reset(new UpdateCallback(callback));
+}
+
+void DsgReceiver::notifyUpdate(bool mesh_changed) {
+  // called with the graph lock held
+  mesh_dirty_ |= mesh_changed;
+  if (snapshot_dirty_.exchange(true)) {
+    MetricsRegistry::instance().addCount("receive_dsg/coalesced_updates");
+  }
+
+  if (update_callback_ && graph_) {
+    (*update_callback_)(*graph_);
+  }
+}
+
+DynamicSceneGraph::Ptr DsgReceiver::takeSnapshot() {
+  if (!snapshot_dirty_.exchange(false)) {
+    return nullptr;
+  }
+
+  ScopedLatency latency("receive_dsg/snapshot");
+  std::lock_guard<std::mutex> lock(graph_mutex_);
+  if (!graph_) {
+    return nullptr;
+  }
+
+  if (mesh_dirty_) {
+    // the previous copy may still be drawn, so it is replaced instead of updated
+    snapshot_mesh_ = mesh_ ? std::make_shared<Mesh>(*mesh_) : nullptr;
+    mesh_dirty_ = false;
+  }
+
+  // detach the mesh while cloning so unchanged meshes are not copied again
+  graph_->setMesh(nullptr);
+  auto snapshot = graph_->clone();
+  graph_->setMesh(mesh_);
+  snapshot->setMesh(snapshot_mesh_);
+  return snapshot;
+}
+
+void DsgReceiver::requestResync() {
+  if (sequence_.rejected()) {
+    resync_pub_.publish(std_msgs::Empty());
+  }
+}
+
+void DsgReceiver::requestMeshResync() {
+  if (mesh_sequence_.rejected()) {
+    mesh_resync_pub_.publish(std_msgs::Empty());
+  }
 }
 
 void DsgReceiver::handleMesh(const kimera_pgmo_msgs::KimeraPgmoMesh::ConstPtr& msg) {
   if (!msg) {
     return;
   }
-  timing::ScopedTimer timer("receive_mesh", msg->header.stamp.toNSec());
+  LatencyTimer timer("receive_mesh", msg->header.stamp.toNSec());
+  std::lock_guard<std::mutex> lock(graph_mutex_);
   if (!mesh_) {
     mesh_ = std::make_shared<Mesh>();
   }
@@ -160,6 +947,52 @@ void DsgReceiver::handleMesh(const kimera_pgmo_msgs::KimeraPgmoMesh::ConstPtr& m
   }
 
   has_update_ = true;
+  notifyUpdate(true);
+}
+
+void DsgReceiver::handleMeshDelta(const hydra_msgs::MeshDelta::ConstPtr& msg) {
+  if (!msg) {
+    return;
+  }
+
+  LatencyTimer timer("receive_mesh_delta", msg->header.stamp.toNSec());
+  if (!mesh_sequence_.canApply(msg->sequence_number, msg->full_update) ||
+      (!msg->full_update && !mesh_)) {
+    VLOG(2) << "Dropping mesh delta " << msg->sequence_number;
+    MetricsRegistry::instance().addCount("receive_mesh_delta/dropped");
+    requestMeshResync();
+    return;
+  }
+
+  // decode before locking so snapshots only wait on patching the mesh
+  std::optional<hydra_msgs::MeshDelta> decoded;
+  try {
+    if (msg->encoding != hydra_msgs::MeshDelta::ENCODING_RAW) {
+      decoded = *msg;
+      decodeMeshDelta(*decoded);
+    }
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Received invalid mesh delta: " << e.what();
+    requestMeshResync();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(graph_mutex_);
+  try {
+    applyMeshDelta(decoded ? *decoded : *msg, mesh_);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Received invalid mesh delta: " << e.what();
+    requestMeshResync();
+    return;
+  }
+
+  mesh_sequence_.applied(msg->sequence_number);
+  if (graph_) {
+    graph_->setMesh(mesh_);
+  }
+
+  has_update_ = true;
+  notifyUpdate(true);
 }
 
 }  // namespace hydra
@@ -38,6 +38,10 @@
 #include <glog/logging.h>
 
 #include <numeric>
+#include <optional>
+#include <set>
+
+#include "hydra_ros/utils/parallel_for.h"
 
 namespace hydra {
 
@@ -370,4 +374,221 @@ std::vector<std::array<size_t, 3>> Polygon::triangulate(bool use_first_ear) {
   return faces;
 }
 
+namespace {
+
+class EarClipper {
+ public:
+  using Face = std::array<size_t, 3>;
+
+  EarClipper(const std::vector<Vertex>& vertices, bool is_ccw, bool use_first_ear)
+      : vertices_(vertices),
+        is_ccw_(is_ccw),
+        use_first_ear_(use_first_ear),
+        num_active_(vertices.size()),
+        prev_(vertices.size()),
+        next_(vertices.size()),
+        active_(vertices.size(), true),
+        convex_(vertices.size(), false),
+        is_ear_(vertices.size(), false),
+        cosines_(vertices.size(), 0.0),
+        ear_cosines_(vertices.size(), 0.0),
+        in_reflex_(vertices.size(), false) {
+    const size_t n = vertices_.size();
+    for (size_t i = 0; i < n; ++i) {
+      prev_[i] = i == 0 ? n - 1 : i - 1;
+      next_[i] = i + 1 == n ? 0 : i + 1;
+    }
+
+    filter();
+  }
+
+  std::vector<Face> run() {
+    if (num_active_ == 0) {
+      return {};
+    }
+
+    for (size_t i = 0; i < vertices_.size(); ++i) {
+      if (active_[i]) {
+        updateConvexity(i);
+      }
+    }
+
+    for (size_t i = 0; i < vertices_.size(); ++i) {
+      if (active_[i]) {
+        setEar(i, isEar(i));
+      }
+    }
+
+    std::vector<Face> faces;
+    faces.reserve(num_active_);
+    while (num_active_ >= 3) {
+      const auto ear = nextEar();
+      if (!ear) {
+        return faces;
+      }
+
+      faces.push_back(face(*ear));
+      setEar(*ear, false);
+      const size_t prev = prev_[*ear];
+      const size_t next = next_[*ear];
+      remove(*ear);
+      if (num_active_ == 3) {
+        faces.push_back(face(first(next)));
+        break;
+      }
+
+      // clipping only changes the triangles at the two neighbors
+      updateConvexity(prev);
+      updateConvexity(next);
+      setEar(prev, isEar(prev));
+      setEar(next, isEar(next));
+    }
+
+    return faces;
+  }
+
+ private:
+  // same as Polygon::filter: drop vertices that coincide with their successor
+  void filter() {
+    for (size_t i = 0; i < vertices_.size() && num_active_ > 0; ++i) {
+      const auto norm = (vertices_[i].pos - vertices_[next_[i]].pos).norm();
+      if (norm < 1.0e-6) {
+        remove(i);
+      }
+    }
+  }
+
+  void remove(size_t i) {
+    next_[prev_[i]] = next_[i];
+    prev_[next_[i]] = prev_[i];
+    active_[i] = false;
+    --num_active_;
+  }
+
+  // active vertices are visited in index order, so the first is the smallest index
+  size_t first(size_t start) const {
+    size_t result = start;
+    for (size_t i = next_[start]; i != start; i = next_[i]) {
+      result = std::min(result, i);
+    }
+    return result;
+  }
+
+  inline TriangleView view(size_t i) const {
+    return {&vertices_[prev_[i]], &vertices_[i], &vertices_[next_[i]]};
+  }
+
+  inline Face face(size_t i) const {
+    return {vertices_[prev_[i]].id, vertices_[i].id, vertices_[next_[i]].id};
+  }
+
+  void updateConvexity(size_t i) {
+    const auto triangle = view(i);
+    cosines_[i] = triangle.interiorAngle(is_ccw_);
+    convex_[i] = triangle.isConvex(is_ccw_);
+    if (!convex_[i] && !in_reflex_[i]) {
+      reflex_.push_back(i);
+      in_reflex_[i] = true;
+    }
+  }
+
+  // only reflex vertices can lie inside a convex ear
+  bool isEar(size_t i) const {
+    if (!convex_[i]) {
+      return false;
+    }
+
+    const auto triangle = view(i);
+    for (const auto other : reflex_) {
+      if (!active_[other] || convex_[other]) {
+        continue;
+      }
+
+      if (other == prev_[i] || other == i || other == next_[i]) {
+        continue;
+      }
+
+      if (triangle.isInside(vertices_[other].pos)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  void setEar(size_t i, bool is_ear) {
+    if (is_ear_[i]) {
+      ears_.erase({use_first_ear_ ? 0.0 : -ear_cosines_[i], i});
+    }
+
+    is_ear_[i] = is_ear;
+    if (is_ear) {
+      ear_cosines_[i] = cosines_[i];
+      ears_.insert({use_first_ear_ ? 0.0 : -cosines_[i], i});
+    }
+  }
+
+  // ears are ordered by decreasing cosine (or just index), and then by index
+  std::optional<size_t> nextEar() const {
+    if (ears_.empty()) {
+      return std::nullopt;
+    }
+
+    const auto& best = *ears_.begin();
+    if (!use_first_ear_ && !(-best.first > 0.0)) {
+      return std::nullopt;
+    }
+
+    return best.second;
+  }
+
+  const std::vector<Vertex>& vertices_;
+  const bool is_ccw_;
+  const bool use_first_ear_;
+  size_t num_active_;
+  std::vector<size_t> prev_;
+  std::vector<size_t> next_;
+  std::vector<bool> active_;
+  std::vector<bool> convex_;
+  std::vector<bool> is_ear_;
+  std::vector<double> cosines_;
+  std::vector<double> ear_cosines_;
+  std::vector<bool> in_reflex_;
+  std::vector<size_t> reflex_;
+  std::set<std::pair<double, size_t>> ears_;
+};
+
+}  // namespace
+
+std::vector<std::array<size_t, 3>> triangulatePolygon(
+    const std::vector<Vertex>& vertices, bool is_ccw, bool use_first_ear) {
+  if (vertices.size() <= 2) {
+    return {};
+  }
+
+  if (vertices.size() == 3) {
+    return {{0, 1, 2}};
+  }
+
+  return EarClipper(vertices, is_ccw, use_first_ear).run();
+}
+
+std::vector<std::array<size_t, 3>> triangulatePoints(const Eigen::MatrixXd& points) {
+  std::vector<Vertex> vertices(points.cols());
+  for (int i = 0; i < points.cols(); ++i) {
+    vertices[i] = {points.col(i).head<2>(), static_cast<size_t>(i)};
+  }
+
+  return triangulatePolygon(vertices);
+}
+
+std::vector<std::vector<std::array<size_t, 3>>> triangulatePolygons(
+    const std::vector<const Eigen::MatrixXd*>& polygons, size_t num_threads) {
+  std::vector<std::vector<std::array<size_t, 3>>> faces(polygons.size());
+  parallelFor(polygons.size(), num_threads, [&](size_t i) {
+    faces[i] = triangulatePoints(*polygons[i]);
+  });
+  return faces;
+}
+
 }  // namespace hydra
@@ -0,0 +1,182 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/freespace_index.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace hydra {
+
+FreespaceIndex::FreespaceIndex(double resolution) : resolution_(resolution) {
+  CHECK_GT(resolution_, 0.0) << "invalid freespace index resolution";
+}
+
+void FreespaceIndex::clear() {
+  spheres_.clear();
+  cells_.clear();
+}
+
+void FreespaceIndex::updateSphere(NodeId node,
+                                  const Eigen::Vector3d& center,
+                                  double radius) {
+  auto iter = spheres_.find(node);
+  if (iter != spheres_.end()) {
+    if (iter->second.center == center && iter->second.radius == radius) {
+      return;
+    }
+
+    eraseCells(node, iter->second);
+    spheres_.erase(iter);
+  }
+
+  if (radius <= 0.0) {
+    return;
+  }
+
+  const auto new_iter = spheres_.emplace(node, Sphere{center, radius}).first;
+  insertCells(node, new_iter->second);
+}
+
+void FreespaceIndex::removeSphere(NodeId node) {
+  auto iter = spheres_.find(node);
+  if (iter == spheres_.end()) {
+    return;
+  }
+
+  eraseCells(node, iter->second);
+  spheres_.erase(iter);
+}
+
+void FreespaceIndex::update(const SceneGraphLayer& places) {
+  std::unordered_set<NodeId> seen;
+  for (const auto& id_node_pair : places.nodes()) {
+    const auto& attrs = id_node_pair.second->attributes();
+    const auto frontier = dynamic_cast<const FrontierNodeAttributes*>(&attrs);
+    if (frontier && !frontier->real_place) {
+      continue;
+    }
+
+    const auto place = dynamic_cast<const PlaceNodeAttributes*>(&attrs);
+    if (!place) {
+      continue;
+    }
+
+    seen.insert(id_node_pair.first);
+    updateSphere(id_node_pair.first, place->position, place->distance);
+  }
+
+  std::vector<NodeId> to_remove;
+  for (const auto& id_sphere_pair : spheres_) {
+    if (!seen.count(id_sphere_pair.first)) {
+      to_remove.push_back(id_sphere_pair.first);
+    }
+  }
+
+  for (const auto node : to_remove) {
+    removeSphere(node);
+  }
+}
+
+bool FreespaceIndex::inFreespace(const Eigen::Vector3d& point, double clearance) const {
+  const auto iter = cells_.find(toKey(toIndex(point)));
+  if (iter == cells_.end()) {
+    return false;
+  }
+
+  for (const auto node : iter->second) {
+    const auto& sphere = spheres_.at(node);
+    const double max_dist = sphere.radius - clearance;
+    if (max_dist < 0.0) {
+      continue;
+    }
+
+    if ((point - sphere.center).squaredNorm() <= max_dist * max_dist) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+FreespaceIndex::CellKey FreespaceIndex::toKey(const Eigen::Vector3i& index) const {
+  // 21 bits per axis is enough for +/- 1e6 cells
+  constexpr uint64_t mask = (uint64_t{1} << 21) - 1;
+  return (static_cast<uint64_t>(index.x()) & mask) |
+         ((static_cast<uint64_t>(index.y()) & mask) << 21) |
+         ((static_cast<uint64_t>(index.z()) & mask) << 42);
+}
+
+Eigen::Vector3i FreespaceIndex::toIndex(const Eigen::Vector3d& point) const {
+  return (point / resolution_).array().floor().cast<int>();
+}
+
+void FreespaceIndex::insertCells(NodeId node, const Sphere& sphere) {
+  const Eigen::Vector3d offset = Eigen::Vector3d::Constant(sphere.radius);
+  const auto min_index = toIndex(sphere.center - offset);
+  const auto max_index = toIndex(sphere.center + offset);
+  for (int x = min_index.x(); x <= max_index.x(); ++x) {
+    for (int y = min_index.y(); y <= max_index.y(); ++y) {
+      for (int z = min_index.z(); z <= max_index.z(); ++z) {
+        cells_[toKey(Eigen::Vector3i(x, y, z))].push_back(node);
+      }
+    }
+  }
+}
+
+void FreespaceIndex::eraseCells(NodeId node, const Sphere& sphere) {
+  const Eigen::Vector3d offset = Eigen::Vector3d::Constant(sphere.radius);
+  const auto min_index = toIndex(sphere.center - offset);
+  const auto max_index = toIndex(sphere.center + offset);
+  for (int x = min_index.x(); x <= max_index.x(); ++x) {
+    for (int y = min_index.y(); y <= max_index.y(); ++y) {
+      for (int z = min_index.z(); z <= max_index.z(); ++z) {
+        auto iter = cells_.find(toKey(Eigen::Vector3i(x, y, z)));
+        if (iter == cells_.end()) {
+          continue;
+        }
+
+        auto& nodes = iter->second;
+        nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+        if (nodes.empty()) {
+          cells_.erase(iter);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace hydra
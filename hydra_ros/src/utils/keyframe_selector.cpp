@@ -0,0 +1,100 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/keyframe_selector.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+#include <cmath>
+
+namespace hydra {
+
+void declare_config(KeyframeSelector::Config& config) {
+  using namespace config;
+  name("KeyframeSelector::Config");
+  field(config.enable, "enable");
+  field(config.min_translation, "min_translation", "m");
+  field(config.min_rotation, "min_rotation", "rad");
+  field(config.min_separation_s, "min_separation_s", "s");
+  check(config.min_translation, GE, 0.0, "min_translation");
+  check(config.min_rotation, GE, 0.0, "min_rotation");
+  check(config.min_separation_s, GE, 0.0, "min_separation_s");
+}
+
+KeyframeSelector::KeyframeSelector(const Config& config)
+    : config(config::checkValid(config)),
+      last_world_T_sensor_(Eigen::Isometry3d::Identity()) {}
+
+bool KeyframeSelector::accept(uint64_t timestamp_ns,
+                              const Eigen::Isometry3d& world_T_sensor) {
+  if (!config.enable || !last_timestamp_ns_) {
+    last_timestamp_ns_ = timestamp_ns;
+    last_world_T_sensor_ = world_T_sensor;
+    ++num_accepted_;
+    return true;
+  }
+
+  // out of order frames never count as having waited long enough
+  const auto elapsed_ns =
+      timestamp_ns > *last_timestamp_ns_ ? timestamp_ns - *last_timestamp_ns_ : 0;
+  const auto min_separation_ns = static_cast<uint64_t>(config.min_separation_s * 1e9);
+  bool is_keyframe = elapsed_ns >= min_separation_ns;
+  if (is_keyframe) {
+    const Eigen::Isometry3d last_T_sensor =
+        last_world_T_sensor_.inverse() * world_T_sensor;
+    const Eigen::AngleAxisd rotation(last_T_sensor.rotation());
+    is_keyframe = last_T_sensor.translation().norm() >= config.min_translation ||
+                  std::abs(rotation.angle()) >= config.min_rotation;
+  }
+
+  if (!is_keyframe) {
+    ++num_rejected_;
+    return false;
+  }
+
+  last_timestamp_ns_ = timestamp_ns;
+  last_world_T_sensor_ = world_T_sensor;
+  ++num_accepted_;
+  return true;
+}
+
+void KeyframeSelector::reset() {
+  last_timestamp_ns_.reset();
+  last_world_T_sensor_ = Eigen::Isometry3d::Identity();
+  num_accepted_ = 0;
+  num_rejected_ = 0;
+}
+
+}  // namespace hydra
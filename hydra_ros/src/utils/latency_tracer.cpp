@@ -0,0 +1,181 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/latency_tracer.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "hydra_ros/utils/metrics.h"
+
+namespace hydra {
+
+namespace {
+
+inline void writeEvent(std::ostream& out,
+                       bool& first,
+                       const std::string& name,
+                       char phase,
+                       uint64_t timestamp_ns,
+                       uint64_t wall_ns) {
+  // timestamps are in microseconds, but doubles cannot represent epoch nanoseconds
+  out << (first ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\"frame\""
+      << ",\"ph\":\"" << phase << "\",\"id\":\"" << timestamp_ns << "\""
+      << ",\"pid\":1,\"tid\":1,\"ts\":" << wall_ns / 1000 << "." << std::setfill('0')
+      << std::setw(3) << wall_ns % 1000 << ",\"args\":{\"stamp_ns\":" << timestamp_ns
+      << "}}";
+  first = false;
+}
+
+}  // namespace
+
+void declare_config(LatencyTracer::Config& config) {
+  using namespace config;
+  name("LatencyTracer::Config");
+  field(config.enable, "enable");
+  field(config.output_path, "output_path");
+  field(config.max_frames, "max_frames");
+  check(config.max_frames, GT, 0, "max_frames");
+}
+
+LatencyTracer& LatencyTracer::instance() {
+  static LatencyTracer tracer;
+  return tracer;
+}
+
+void LatencyTracer::start(const Config& config) {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+  }  // end critical section
+
+  enabled_ = config.enable;
+}
+
+void LatencyTracer::stop() {
+  if (!enabled_.exchange(false)) {
+    return;
+  }
+
+  std::string output_path;
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    output_path = config_.output_path;
+  }  // end critical section
+
+  if (output_path.empty()) {
+    return;
+  }
+
+  std::ofstream out(output_path);
+  if (!out) {
+    LOG(ERROR) << "Unable to write latency trace to '" << output_path << "'";
+    return;
+  }
+
+  out << toChromeTrace();
+  LOG(INFO) << "Wrote latency trace to '" << output_path << "'";
+}
+
+void LatencyTracer::mark(uint64_t timestamp_ns, const std::string& stage) {
+  if (!enabled_) {
+    return;
+  }
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  mark(timestamp_ns,
+       stage,
+       std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+void LatencyTracer::mark(uint64_t timestamp_ns,
+                         const std::string& stage,
+                         uint64_t wall_ns) {
+  if (!enabled_) {
+    return;
+  }
+
+  if (wall_ns >= timestamp_ns) {
+    MetricsRegistry::instance().recordLatency("trace/" + stage,
+                                              (wall_ns - timestamp_ns) * 1.0e-9);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  frames_[timestamp_ns].push_back({stage, wall_ns});
+  while (frames_.size() > config_.max_frames) {
+    frames_.erase(frames_.begin());
+  }
+}
+
+std::map<uint64_t, std::vector<LatencyTracer::Mark>> LatencyTracer::frames() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return frames_;
+}
+
+std::string LatencyTracer::toChromeTrace() const {
+  const auto traces = frames();
+
+  std::stringstream ss;
+  ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& [timestamp_ns, marks] : traces) {
+    // each span ends at a stage and starts at the previous one (or the sensor stamp)
+    uint64_t prev_ns = timestamp_ns;
+    for (const auto& mark : marks) {
+      if (mark.wall_ns < prev_ns) {
+        prev_ns = mark.wall_ns;
+      }
+
+      writeEvent(ss, first, mark.stage, 'b', timestamp_ns, prev_ns);
+      writeEvent(ss, first, mark.stage, 'e', timestamp_ns, mark.wall_ns);
+      prev_ns = mark.wall_ns;
+    }
+  }
+
+  ss << "\n]}\n";
+  return ss.str();
+}
+
+void LatencyTracer::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  frames_.clear();
+}
+
+}  // namespace hydra
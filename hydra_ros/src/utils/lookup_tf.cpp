@@ -39,8 +39,77 @@
 #include <tf2_eigen/tf2_eigen.h>
 #include <tf2_ros/transform_listener.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+
 namespace hydra {
 
+namespace {
+
+inline std::string getStampSuffix(const ros::Time& stamp) {
+  std::stringstream ss;
+  ss << " @ " << stamp.toNSec() << " [ns]";
+  return ss.str();
+}
+
+PoseStatus getPoseFromBuffer(const tf2_ros::Buffer& buffer,
+                             const ros::Time& lookup_time,
+                             const std::string& target,
+                             const std::string& source,
+                             const std::string& stamp_suffix) {
+  geometry_msgs::TransformStamped transform;
+  try {
+    transform = buffer.lookupTransform(target, source, lookup_time);
+  } catch (const tf2::TransformException& ex) {
+    LOG(ERROR) << "Failed to look up: " << target << "_T_" << source << stamp_suffix;
+    return {false, {}, {}};
+  }
+
+  geometry_msgs::Pose curr_pose;
+  curr_pose.position.x = transform.transform.translation.x;
+  curr_pose.position.y = transform.transform.translation.y;
+  curr_pose.position.z = transform.transform.translation.z;
+  curr_pose.orientation = transform.transform.rotation;
+
+  PoseStatus to_return;
+  to_return.is_valid = true;
+  tf2::convert(curr_pose.position, to_return.target_p_source);
+  tf2::convert(curr_pose.orientation, to_return.target_R_source);
+  to_return.target_R_source.normalize();
+  return to_return;
+}
+
+// tf2 returns the largest request handle when the stamp predates the buffer cache
+inline bool isRequestTooOld(tf2::TransformableRequestHandle request) {
+  return request == std::numeric_limits<tf2::TransformableRequestHandle>::max();
+}
+
+std::optional<double> getStampAge(const tf2_ros::Buffer& buffer,
+                                  const ros::Time& stamp,
+                                  const std::string& target,
+                                  const std::string& source) {
+  try {
+    const auto latest = buffer.lookupTransform(target, source, ros::Time(0));
+    return (latest.header.stamp - stamp).toSec();
+  } catch (const tf2::TransformException&) {
+    // nothing to compare against until the frames are connected
+    return std::nullopt;
+  }
+}
+
+struct TransformWaitState {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  bool failed = false;
+};
+
+}  // namespace
+
 PoseStatus lookupTransform(const std::string& target,
                            const std::string& source,
                            double wait_duration_s,
@@ -59,12 +128,7 @@ PoseStatus lookupTransform(const tf2_ros::Buffer& buffer,
                            double wait_duration_s,
                            int verbosity) {
   ros::WallRate tf_wait_rate(1.0 / wait_duration_s);
-  std::string stamp_suffix;
-  if (stamp) {
-    std::stringstream ss;
-    ss << " @ " << stamp.value().toNSec() << " [ns]";
-    stamp_suffix = ss.str();
-  }
+  const std::string stamp_suffix = stamp ? getStampSuffix(*stamp) : "";
 
   bool have_transform = false;
   std::string err_str;
@@ -97,26 +161,94 @@ PoseStatus lookupTransform(const tf2_ros::Buffer& buffer,
     return {false, {}, {}};
   }
 
-  geometry_msgs::TransformStamped transform;
-  try {
-    transform = buffer.lookupTransform(target, source, lookup_time);
-  } catch (const tf2::TransformException& ex) {
-    LOG(ERROR) << "Failed to look up: " << target << "_T_" << source << stamp_suffix;
-    return {false, {}, {}};
+  return getPoseFromBuffer(buffer, lookup_time, target, source, stamp_suffix);
+}
+
+PoseStatus waitForTransform(tf2_ros::Buffer& buffer,
+                            const ros::Time& stamp,
+                            const std::string& target,
+                            const std::string& source,
+                            std::optional<double> timeout_s,
+                            int verbosity,
+                            std::optional<double> max_age_s) {
+  const auto stamp_suffix = getStampSuffix(stamp);
+  VLOG(verbosity) << "Waiting for transform " << target << "_T_" << source
+                  << stamp_suffix;
+
+  if (max_age_s && !stamp.isZero()) {
+    const auto age_s = getStampAge(buffer, stamp, target, source);
+    if (age_s && *age_s > *max_age_s) {
+      LOG(ERROR) << "Failed to find: " << target << "_T_" << source << stamp_suffix
+                 << ": stamp is " << *age_s << " [s] older than latest transform";
+      return {false, {}, {}};
+    }
   }
 
-  geometry_msgs::Pose curr_pose;
-  curr_pose.position.x = transform.transform.translation.x;
-  curr_pose.position.y = transform.transform.translation.y;
-  curr_pose.position.z = transform.transform.translation.z;
-  curr_pose.orientation = transform.transform.rotation;
+  // state is shared with the callback in case tf2 fires it while we unregister
+  auto state = std::make_shared<TransformWaitState>();
+  const auto cb_handle = buffer.addTransformableCallback(
+      [state](tf2::TransformableRequestHandle,
+              const std::string&,
+              const std::string&,
+              ros::Time,
+              tf2::TransformableResult result) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->done = true;
+        state->failed = result == tf2::TransformFailed;
+        state->cv.notify_all();
+      });
 
-  PoseStatus to_return;
-  to_return.is_valid = true;
-  tf2::convert(curr_pose.position, to_return.target_p_source);
-  tf2::convert(curr_pose.orientation, to_return.target_R_source);
-  to_return.target_R_source.normalize();
-  return to_return;
+  const auto request = buffer.addTransformableRequest(cb_handle, target, source, stamp);
+  if (request == 0) {
+    // transform was already available
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->done = true;
+  } else if (isRequestTooOld(request)) {
+    // stamp is older than anything in the buffer
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->done = true;
+    state->failed = true;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(timeout_s.value_or(0.0)));
+  bool have_transform = false;
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->done && ros::ok()) {
+      // wake up periodically to check for shutdown
+      const auto now = std::chrono::steady_clock::now();
+      auto wake_time = now + std::chrono::milliseconds(100);
+      if (timeout_s) {
+        wake_time = std::min(wake_time, start + timeout);
+      }
+
+      state->cv.wait_until(lock, wake_time, [&] { return state->done; });
+      if (timeout_s && std::chrono::steady_clock::now() >= start + timeout) {
+        break;
+      }
+    }
+
+    have_transform = state->done && !state->failed;
+  }  // end critical section
+
+  if (request != 0 && !isRequestTooOld(request)) {
+    buffer.cancelTransformableRequest(request);
+  }
+  buffer.removeTransformableCallback(cb_handle);
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  VLOG(verbosity) << "Waited " << elapsed.count() << " [s] for " << target << "_T_"
+                  << source << stamp_suffix;
+  if (!have_transform) {
+    LOG(ERROR) << "Failed to find: " << target << "_T_" << source << stamp_suffix
+               << " after " << elapsed.count() << " [s]";
+    return {false, {}, {}};
+  }
+
+  return getPoseFromBuffer(buffer, stamp, target, source, stamp_suffix);
 }
 
 }  // namespace hydra
@@ -0,0 +1,226 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/mat_pool.h"
+
+#include <mutex>
+#include <vector>
+
+namespace hydra {
+
+namespace {
+
+#if CV_VERSION_MAJOR >= 4
+using AccessFlag = cv::AccessFlag;
+#else
+using AccessFlag = int;
+#endif
+
+// every buffer starts with a header holding its capacity; 64 bytes keeps the matrix
+// data as aligned as fastMalloc would
+constexpr size_t kHeaderSize = 64;
+
+inline size_t& bufferCapacity(uchar* buffer) {
+  return *reinterpret_cast<size_t*>(buffer - kHeaderSize);
+}
+
+}  // namespace
+
+class MatPool::Allocator : public cv::MatAllocator {
+ public:
+  explicit Allocator(size_t max_idle_buffers) : max_idle_(max_idle_buffers) {
+    idle_.reserve(max_idle_);
+  }
+
+  //! Hand the allocator over to the matrices that are still using it
+  void release() {
+    bool unused = false;
+    {  // start critical section
+      std::lock_guard<std::mutex> lock(mutex_);
+      released_ = true;
+      unused = num_outstanding_ == 0;
+    }  // end critical section
+
+    if (unused) {
+      delete this;
+    }
+  }
+
+  ~Allocator() {
+    for (auto buffer : idle_) {
+      cv::fastFree(buffer - kHeaderSize);
+    }
+  }
+
+  cv::UMatData* allocate(int dims,
+                         const int* sizes,
+                         int type,
+                         void* data,
+                         size_t* step,
+                         AccessFlag flags,
+                         cv::UMatUsageFlags usage) const override {
+    if (data) {
+      // wrapping user data doesn't need any storage from us
+      return cv::Mat::getStdAllocator()->allocate(
+          dims, sizes, type, data, step, flags, usage);
+    }
+
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; --i) {
+      if (step) {
+        step[i] = total;
+      }
+
+      total *= sizes[i];
+    }
+
+    auto u = new cv::UMatData(this);
+    u->data = u->origdata = getBuffer(total);
+    u->size = total;
+    return u;
+  }
+
+  bool allocate(cv::UMatData* data, AccessFlag, cv::UMatUsageFlags) const override {
+    return data != nullptr;
+  }
+
+  void deallocate(cv::UMatData* data) const override {
+    if (!data) {
+      return;
+    }
+
+    CV_Assert(data->urefcount == 0 && data->refcount == 0);
+    const bool last = returnBuffer(data->origdata);
+    delete data;
+    if (last) {
+      delete const_cast<Allocator*>(this);
+    }
+  }
+
+  size_t numAllocated() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_allocated_;
+  }
+
+  size_t numReused() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_reused_;
+  }
+
+  size_t numIdle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+  }
+
+ private:
+  uchar* getBuffer(size_t size) const {
+    {  // start critical section
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto best = idle_.end();
+      for (auto iter = idle_.begin(); iter != idle_.end(); ++iter) {
+        const auto capacity = bufferCapacity(*iter);
+        if (capacity < size || capacity > 2 * size) {
+          continue;
+        }
+
+        if (best == idle_.end() || capacity < bufferCapacity(*best)) {
+          best = iter;
+        }
+      }
+
+      if (best != idle_.end()) {
+        auto buffer = *best;
+        *best = idle_.back();
+        idle_.pop_back();
+        ++num_outstanding_;
+        ++num_reused_;
+        return buffer;
+      }
+
+      ++num_outstanding_;
+      ++num_allocated_;
+    }  // end critical section
+
+    // leave some headroom so that inputs that vary in size can share buffers
+    const size_t capacity = size + size / 4;
+    auto buffer = static_cast<uchar*>(cv::fastMalloc(capacity + kHeaderSize));
+    buffer += kHeaderSize;
+    bufferCapacity(buffer) = capacity;
+    return buffer;
+  }
+
+  //! Returns true if this was the last buffer of a released allocator
+  bool returnBuffer(uchar* buffer) const {
+    bool last = false;
+    {  // start critical section
+      std::lock_guard<std::mutex> lock(mutex_);
+      --num_outstanding_;
+      last = released_ && num_outstanding_ == 0;
+      if (!released_ && idle_.size() < max_idle_) {
+        idle_.push_back(buffer);
+        return false;
+      }
+    }  // end critical section
+
+    cv::fastFree(buffer - kHeaderSize);
+    return last;
+  }
+
+  const size_t max_idle_;
+  mutable std::mutex mutex_;
+  mutable std::vector<uchar*> idle_;
+  mutable size_t num_allocated_ = 0;
+  mutable size_t num_reused_ = 0;
+  mutable size_t num_outstanding_ = 0;
+  bool released_ = false;
+};
+
+MatPool::Ptr MatPool::create(size_t max_idle_buffers) {
+  return Ptr(new MatPool(max_idle_buffers));
+}
+
+MatPool::MatPool(size_t max_idle_buffers)
+    : allocator_(new Allocator(max_idle_buffers)) {}
+
+MatPool::~MatPool() { allocator_->release(); }
+
+void MatPool::attach(cv::Mat& mat) const { mat.allocator = allocator_; }
+
+size_t MatPool::numAllocated() const { return allocator_->numAllocated(); }
+
+size_t MatPool::numReused() const { return allocator_->numReused(); }
+
+size_t MatPool::numIdle() const { return allocator_->numIdle(); }
+
+}  // namespace hydra
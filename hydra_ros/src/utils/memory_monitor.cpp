@@ -0,0 +1,230 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/memory_monitor.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+#include <unistd.h>
+
+#include <fstream>
+
+namespace hydra {
+
+namespace {
+
+// rough cost of an entry in the node-based containers used for ids and edges
+inline constexpr size_t kContainerEntryBytes = 48;
+
+size_t attributeBytes(const NodeAttributes& attrs) {
+  if (dynamic_cast<const ObjectNodeAttributes*>(&attrs)) {
+    return sizeof(ObjectNodeAttributes);
+  }
+
+  if (dynamic_cast<const RoomNodeAttributes*>(&attrs)) {
+    return sizeof(RoomNodeAttributes);
+  }
+
+  if (dynamic_cast<const Place2dNodeAttributes*>(&attrs)) {
+    return sizeof(Place2dNodeAttributes);
+  }
+
+  if (dynamic_cast<const PlaceNodeAttributes*>(&attrs)) {
+    return sizeof(PlaceNodeAttributes);
+  }
+
+  if (dynamic_cast<const SemanticNodeAttributes*>(&attrs)) {
+    return sizeof(SemanticNodeAttributes);
+  }
+
+  return sizeof(NodeAttributes);
+}
+
+inline void setUsage(const std::string& name, const MemoryUsage& usage) {
+  auto& metrics = MetricsRegistry::instance();
+  metrics.setGauge(name + "/count", usage.count);
+  metrics.setGauge(name + "/bytes", usage.bytes);
+}
+
+}  // namespace
+
+void declare_config(MemoryMonitor::Config& config) {
+  using namespace config;
+  name("MemoryMonitor::Config");
+  field(config.period_s, "period_s", "s");
+}
+
+void declare_config(TsdfMemorySink::Config& config) {
+  using namespace config;
+  name("TsdfMemorySink::Config");
+  field(config.period_s, "period_s", "s");
+}
+
+void declare_config(GvdMemorySink::Config& config) {
+  using namespace config;
+  name("GvdMemorySink::Config");
+  field(config.period_s, "period_s", "s");
+}
+
+MemoryUsage estimateLayerMemory(const SceneGraphLayer& layer) {
+  MemoryUsage usage;
+  usage.count = layer.numNodes();
+  // layers only hold one kind of attributes, so the first node is representative
+  const auto first = layer.nodes().begin();
+  const size_t attr_bytes =
+      first == layer.nodes().end() ? 0 : attributeBytes(first->second->attributes());
+  const size_t node_bytes = sizeof(SceneGraphNode) + attr_bytes + kContainerEntryBytes;
+  // edges are stored once in the layer and referenced by both nodes
+  const size_t edge_bytes =
+      sizeof(SceneGraphEdge) + sizeof(EdgeAttributes) + 3 * kContainerEntryBytes;
+  usage.bytes = layer.numNodes() * node_bytes + layer.numEdges() * edge_bytes;
+  return usage;
+}
+
+MemoryUsage estimateMeshMemory(const Mesh& mesh) {
+  size_t vertex_bytes = sizeof(Mesh::Pos);
+  vertex_bytes += mesh.has_colors ? sizeof(Color) : 0;
+  vertex_bytes += mesh.has_timestamps ? sizeof(uint64_t) : 0;
+  vertex_bytes += mesh.has_first_seen_stamps ? sizeof(uint64_t) : 0;
+  vertex_bytes += mesh.has_labels ? sizeof(uint32_t) : 0;
+
+  MemoryUsage usage;
+  usage.count = mesh.numVertices();
+  usage.bytes = mesh.numVertices() * vertex_bytes;
+  usage.bytes += mesh.numFaces() * sizeof(Mesh::Face);
+  return usage;
+}
+
+size_t readResidentBytes() {
+  // second field is the number of resident pages
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (!(statm >> total_pages >> resident_pages)) {
+    return 0;
+  }
+
+  return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+MemoryMonitor::MemoryMonitor(const Config& config, const ros::NodeHandle& nh)
+    : config(config::checkValid(config)), nh_(nh) {
+  if (config.period_s <= 0.0) {
+    return;
+  }
+
+  timer_ = nh_.createWallTimer(ros::WallDuration(config.period_s),
+                               [this](const ros::WallTimerEvent&) { update(); });
+}
+
+MemoryMonitor::~MemoryMonitor() { timer_.stop(); }
+
+void MemoryMonitor::addGraph(const std::string& name, const SharedDsgInfo::Ptr& dsg) {
+  if (dsg) {
+    graphs_[name] = dsg;
+  }
+}
+
+void MemoryMonitor::update() {
+  ScopedLatency latency("memory_monitor");
+  for (const auto& [name, dsg] : graphs_) {
+    updateGraph(name, *dsg);
+  }
+
+  MetricsRegistry::instance().setGauge("memory/rss_bytes", readResidentBytes());
+}
+
+void MemoryMonitor::updateGraph(const std::string& name, SharedDsgInfo& dsg) const {
+  std::map<LayerId, MemoryUsage> layers;
+  MemoryUsage mesh;
+  size_t num_edges = 0;
+  size_t num_faces = 0;
+  {  // start critical section
+    std::unique_lock<std::mutex> lock(dsg.mutex);
+    const auto& graph = *dsg.graph;
+    for (const auto& [layer_id, layer] : graph.layers()) {
+      layers[layer_id] = estimateLayerMemory(*layer);
+    }
+
+    num_edges = graph.numEdges();
+    const auto graph_mesh = graph.mesh();
+    if (graph_mesh) {
+      mesh = estimateMeshMemory(*graph_mesh);
+      num_faces = graph_mesh->numFaces();
+    }
+  }  // end critical section
+
+  auto& metrics = MetricsRegistry::instance();
+  const auto prefix = "memory/" + name;
+  for (const auto& [layer_id, usage] : layers) {
+    setUsage(prefix + "/layer_" + std::to_string(layer_id), usage);
+  }
+
+  metrics.setGauge(prefix + "/edges", num_edges);
+  setUsage(prefix + "/mesh", mesh);
+  metrics.setGauge(prefix + "/mesh/faces", num_faces);
+}
+
+TsdfMemorySink::TsdfMemorySink(const Config& config)
+    : config(config::checkValid(config)) {}
+
+void TsdfMemorySink::call(uint64_t timestamp_ns,
+                          const Eigen::Isometry3d&,
+                          const TsdfLayer& tsdf,
+                          const ReconstructionOutput&) const {
+  if (last_ns_ && timestamp_ns < last_ns_ + config.period_s * 1.0e9) {
+    return;
+  }
+
+  last_ns_ = timestamp_ns;
+  setUsage("memory/tsdf_blocks", estimateVoxelLayerMemory(tsdf));
+}
+
+GvdMemorySink::GvdMemorySink(const Config& config)
+    : config(config::checkValid(config)) {}
+
+void GvdMemorySink::call(uint64_t timestamp_ns,
+                         const Eigen::Isometry3f&,
+                         const places::GvdLayer& gvd,
+                         const places::GraphExtractorInterface*) const {
+  if (last_ns_ && timestamp_ns < last_ns_ + config.period_s * 1.0e9) {
+    return;
+  }
+
+  last_ns_ = timestamp_ns;
+  setUsage("memory/gvd_blocks", estimateVoxelLayerMemory(gvd));
+}
+
+}  // namespace hydra
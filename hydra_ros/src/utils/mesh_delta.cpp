@@ -0,0 +1,490 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/mesh_delta.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+
+namespace hydra {
+
+namespace {
+
+inline bool sameAttributes(const Mesh& lhs, const Mesh& rhs) {
+  return lhs.has_colors == rhs.has_colors && lhs.has_timestamps == rhs.has_timestamps &&
+         lhs.has_first_seen_stamps == rhs.has_first_seen_stamps &&
+         lhs.has_labels == rhs.has_labels;
+}
+
+inline bool sameColor(const Color& lhs, const Color& rhs) {
+  return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+}
+
+bool vertexChanged(const Mesh& prev, const Mesh& curr, size_t i) {
+  if (i >= prev.numVertices()) {
+    return true;
+  }
+
+  if (prev.points[i] != curr.points[i]) {
+    return true;
+  }
+
+  if (curr.has_colors && !sameColor(prev.colors[i], curr.colors[i])) {
+    return true;
+  }
+
+  if (curr.has_timestamps && prev.stamps[i] != curr.stamps[i]) {
+    return true;
+  }
+
+  if (curr.has_first_seen_stamps &&
+      prev.first_seen_stamps[i] != curr.first_seen_stamps[i]) {
+    return true;
+  }
+
+  return curr.has_labels && prev.labels[i] != curr.labels[i];
+}
+
+void addVertex(const Mesh& mesh, size_t i, hydra_msgs::MeshDelta& msg) {
+  msg.vertex_indices.push_back(i);
+  const auto& pos = mesh.points[i];
+  msg.positions.insert(msg.positions.end(), {pos.x(), pos.y(), pos.z()});
+  if (mesh.has_colors) {
+    const auto& c = mesh.colors[i];
+    msg.colors.insert(msg.colors.end(), {c.r, c.g, c.b, c.a});
+  }
+
+  if (mesh.has_timestamps) {
+    msg.stamps.push_back(mesh.stamps[i]);
+  }
+
+  if (mesh.has_first_seen_stamps) {
+    msg.first_seen_stamps.push_back(mesh.first_seen_stamps[i]);
+  }
+
+  if (mesh.has_labels) {
+    msg.labels.push_back(mesh.labels[i]);
+  }
+}
+
+void checkSize(size_t actual, size_t expected, const std::string& name) {
+  if (actual != expected) {
+    throw std::runtime_error("invalid mesh delta: expected " +
+                             std::to_string(expected) + " " + name + ", got " +
+                             std::to_string(actual));
+  }
+}
+
+// colors are sent as palette indices if every index fits in one byte
+constexpr size_t kMaxPaletteSize = 256;
+
+struct ByteWriter {
+  std::vector<uint8_t>& bytes;
+
+  void write(uint64_t value) {
+    while (value >= 0x80) {
+      bytes.push_back(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+
+    bytes.push_back(static_cast<uint8_t>(value));
+  }
+
+  void writeSigned(int64_t value) {
+    // zigzag coding keeps small negative values small
+    write((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+
+  //! Write each value as the difference to the previous one
+  template <typename T>
+  void writeDeltas(const std::vector<T>& values) {
+    int64_t prev = 0;
+    for (const auto value : values) {
+      writeSigned(static_cast<int64_t>(value) - prev);
+      prev = static_cast<int64_t>(value);
+    }
+  }
+};
+
+struct ByteReader {
+  const std::vector<uint8_t>& bytes;
+  size_t pos = 0;
+
+  uint8_t readByte() {
+    if (pos >= bytes.size()) {
+      throw std::runtime_error("invalid mesh delta: compact data is truncated");
+    }
+
+    return bytes[pos++];
+  }
+
+  uint64_t read() {
+    uint64_t value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+      const auto byte = readByte();
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+
+    throw std::runtime_error("invalid mesh delta: malformed varint");
+  }
+
+  int64_t readSigned() {
+    const auto value = read();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  template <typename T>
+  void readDeltas(size_t num_values, std::vector<T>& values) {
+    values.resize(num_values);
+    int64_t prev = 0;
+    for (auto& value : values) {
+      prev += readSigned();
+      value = static_cast<T>(prev);
+    }
+  }
+};
+
+void encodePositions(const std::vector<float>& positions,
+                     double resolution,
+                     ByteWriter& writer) {
+  int64_t prev[3] = {0, 0, 0};
+  for (size_t i = 0; i < positions.size(); ++i) {
+    const auto quantized = std::llround(positions[i] / resolution);
+    writer.writeSigned(quantized - prev[i % 3]);
+    prev[i % 3] = quantized;
+  }
+}
+
+void decodePositions(size_t num_values,
+                     double resolution,
+                     ByteReader& reader,
+                     std::vector<float>& positions) {
+  positions.resize(num_values);
+  int64_t prev[3] = {0, 0, 0};
+  for (size_t i = 0; i < num_values; ++i) {
+    prev[i % 3] += reader.readSigned();
+    positions[i] = static_cast<float>(prev[i % 3] * resolution);
+  }
+}
+
+void encodeColors(const std::vector<uint8_t>& colors, ByteWriter& writer) {
+  std::map<uint32_t, uint8_t> palette;
+  std::vector<uint8_t> indices;
+  indices.reserve(colors.size() / 4);
+  for (size_t i = 0; i + 3 < colors.size(); i += 4) {
+    const uint32_t rgba = colors[i] | (colors[i + 1] << 8) | (colors[i + 2] << 16) |
+                          (static_cast<uint32_t>(colors[i + 3]) << 24);
+    auto iter = palette.find(rgba);
+    if (iter == palette.end()) {
+      if (palette.size() == kMaxPaletteSize) {
+        break;
+      }
+
+      iter = palette.emplace(rgba, palette.size()).first;
+    }
+
+    indices.push_back(iter->second);
+  }
+
+  if (indices.size() != colors.size() / 4) {
+    // too many distinct colors for a palette
+    writer.write(0);
+    writer.bytes.insert(writer.bytes.end(), colors.begin(), colors.end());
+    return;
+  }
+
+  std::vector<uint32_t> entries(palette.size());
+  for (const auto& [rgba, index] : palette) {
+    entries[index] = rgba;
+  }
+
+  writer.write(entries.size());
+  for (const auto rgba : entries) {
+    for (size_t c = 0; c < 4; ++c) {
+      writer.bytes.push_back(static_cast<uint8_t>(rgba >> (8 * c)));
+    }
+  }
+
+  writer.bytes.insert(writer.bytes.end(), indices.begin(), indices.end());
+}
+
+void decodeColors(size_t num_vertices,
+                  ByteReader& reader,
+                  std::vector<uint8_t>& colors) {
+  colors.resize(4 * num_vertices);
+  const auto palette_size = reader.read();
+  if (palette_size == 0) {
+    for (auto& value : colors) {
+      value = reader.readByte();
+    }
+
+    return;
+  }
+
+  if (palette_size > kMaxPaletteSize) {
+    throw std::runtime_error("invalid mesh delta: color palette is too large");
+  }
+
+  std::vector<uint8_t> palette(4 * palette_size);
+  for (auto& value : palette) {
+    value = reader.readByte();
+  }
+
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const size_t index = reader.readByte();
+    if (index >= palette_size) {
+      throw std::runtime_error("invalid mesh delta: color index out of range");
+    }
+
+    std::copy_n(palette.begin() + 4 * index, 4, colors.begin() + 4 * i);
+  }
+}
+
+}  // namespace
+
+void fillMeshDelta(const Mesh* prev, const Mesh& curr, hydra_msgs::MeshDelta& msg) {
+  msg.full_update = !prev || !sameAttributes(*prev, curr);
+  msg.has_colors = curr.has_colors;
+  msg.has_timestamps = curr.has_timestamps;
+  msg.has_first_seen_stamps = curr.has_first_seen_stamps;
+  msg.has_labels = curr.has_labels;
+  msg.num_vertices = curr.numVertices();
+  msg.num_faces = curr.numFaces();
+
+  for (size_t i = 0; i < curr.numVertices(); ++i) {
+    if (msg.full_update || vertexChanged(*prev, curr, i)) {
+      addVertex(curr, i, msg);
+    }
+  }
+
+  for (size_t i = 0; i < curr.numFaces(); ++i) {
+    const auto& face = curr.faces[i];
+    if (!msg.full_update && i < prev->numFaces() && prev->faces[i] == face) {
+      continue;
+    }
+
+    msg.face_indices.push_back(i);
+    msg.faces.insert(msg.faces.end(), face.begin(), face.end());
+  }
+}
+
+void applyMeshDelta(const hydra_msgs::MeshDelta& msg, Mesh::Ptr& mesh) {
+  const size_t num_updated = msg.vertex_indices.size();
+  checkSize(msg.positions.size(), 3 * num_updated, "positions");
+  checkSize(msg.colors.size(), msg.has_colors ? 4 * num_updated : 0, "colors");
+  checkSize(msg.stamps.size(), msg.has_timestamps ? num_updated : 0, "stamps");
+  checkSize(msg.first_seen_stamps.size(),
+            msg.has_first_seen_stamps ? num_updated : 0,
+            "first seen stamps");
+  checkSize(msg.labels.size(), msg.has_labels ? num_updated : 0, "labels");
+  checkSize(msg.faces.size(), 3 * msg.face_indices.size(), "face indices");
+
+  if (msg.full_update) {
+    mesh = std::make_shared<Mesh>(
+        msg.has_colors, msg.has_timestamps, msg.has_labels, msg.has_first_seen_stamps);
+  } else if (!mesh) {
+    throw std::runtime_error("invalid mesh delta: no mesh to apply delta to");
+  } else if (mesh->has_colors != msg.has_colors ||
+             mesh->has_timestamps != msg.has_timestamps ||
+             mesh->has_first_seen_stamps != msg.has_first_seen_stamps ||
+             mesh->has_labels != msg.has_labels) {
+    throw std::runtime_error("invalid mesh delta: mesh attributes do not match");
+  }
+
+  mesh->resizeVertices(msg.num_vertices);
+  mesh->resizeFaces(msg.num_faces);
+
+  for (size_t i = 0; i < num_updated; ++i) {
+    const auto idx = msg.vertex_indices[i];
+    if (idx >= msg.num_vertices) {
+      throw std::runtime_error("invalid mesh delta: vertex index out of range");
+    }
+
+    mesh->points[idx] << msg.positions[3 * i], msg.positions[3 * i + 1],
+        msg.positions[3 * i + 2];
+    if (msg.has_colors) {
+      mesh->colors[idx] = Color(msg.colors[4 * i],
+                                msg.colors[4 * i + 1],
+                                msg.colors[4 * i + 2],
+                                msg.colors[4 * i + 3]);
+    }
+
+    if (msg.has_timestamps) {
+      mesh->stamps[idx] = msg.stamps[i];
+    }
+
+    if (msg.has_first_seen_stamps) {
+      mesh->first_seen_stamps[idx] = msg.first_seen_stamps[i];
+    }
+
+    if (msg.has_labels) {
+      mesh->labels[idx] = msg.labels[i];
+    }
+  }
+
+  for (size_t i = 0; i < msg.face_indices.size(); ++i) {
+    const auto idx = msg.face_indices[i];
+    if (idx >= msg.num_faces) {
+      throw std::runtime_error("invalid mesh delta: face index out of range");
+    }
+
+    auto& face = mesh->faces[idx];
+    for (size_t j = 0; j < 3; ++j) {
+      face[j] = msg.faces[3 * i + j];
+    }
+  }
+}
+
+void encodeMeshDelta(hydra_msgs::MeshDelta& msg,
+                     double position_resolution,
+                     DsgCodec codec,
+                     int compression_level) {
+  if (msg.encoding == hydra_msgs::MeshDelta::ENCODING_COMPACT) {
+    return;
+  }
+
+  if (position_resolution <= 0.0) {
+    throw std::runtime_error("invalid position resolution for compact mesh delta");
+  }
+
+  // quantize with the resolution the receiver sees
+  msg.position_resolution = position_resolution;
+  std::vector<uint8_t> data;
+  ByteWriter writer{data};
+  writer.write(msg.vertex_indices.size());
+  writer.writeDeltas(msg.vertex_indices);
+  encodePositions(msg.positions, msg.position_resolution, writer);
+  if (msg.has_colors) {
+    encodeColors(msg.colors, writer);
+  }
+
+  if (msg.has_timestamps) {
+    writer.writeDeltas(msg.stamps);
+  }
+
+  if (msg.has_first_seen_stamps) {
+    writer.writeDeltas(msg.first_seen_stamps);
+  }
+
+  if (msg.has_labels) {
+    writer.writeDeltas(msg.labels);
+  }
+
+  // neighboring faces share vertices, so face corners are coded as index differences
+  writer.write(msg.face_indices.size());
+  writer.writeDeltas(msg.face_indices);
+  writer.writeDeltas(msg.faces);
+
+  // the raw fields stay valid until compression succeeded
+  msg.uncompressed_size = data.size();
+  if (codec == DsgCodec::NONE) {
+    msg.compact_data = std::move(data);
+  } else {
+    compressPayload(codec, compression_level, data, msg.compact_data);
+  }
+
+  msg.encoding = hydra_msgs::MeshDelta::ENCODING_COMPACT;
+  msg.codec = static_cast<uint8_t>(codec);
+
+  msg.vertex_indices.clear();
+  msg.positions.clear();
+  msg.colors.clear();
+  msg.stamps.clear();
+  msg.first_seen_stamps.clear();
+  msg.labels.clear();
+  msg.face_indices.clear();
+  msg.faces.clear();
+}
+
+void decodeMeshDelta(hydra_msgs::MeshDelta& msg) {
+  if (msg.encoding == hydra_msgs::MeshDelta::ENCODING_RAW) {
+    return;
+  }
+
+  if (msg.encoding != hydra_msgs::MeshDelta::ENCODING_COMPACT) {
+    throw std::runtime_error("invalid mesh delta: unknown encoding " +
+                             std::to_string(msg.encoding));
+  }
+
+  std::vector<uint8_t> data;
+  const auto codec = static_cast<DsgCodec>(msg.codec);
+  if (codec == DsgCodec::NONE) {
+    data = std::move(msg.compact_data);
+  } else {
+    decompressPayload(codec, msg.uncompressed_size, msg.compact_data, data);
+  }
+
+  ByteReader reader{data};
+  const auto num_vertices = reader.read();
+  // every vertex takes at least one byte, which bounds allocations for bad input
+  if (num_vertices > data.size()) {
+    throw std::runtime_error("invalid mesh delta: compact data is truncated");
+  }
+
+  reader.readDeltas(num_vertices, msg.vertex_indices);
+  decodePositions(3 * num_vertices, msg.position_resolution, reader, msg.positions);
+  if (msg.has_colors) {
+    decodeColors(num_vertices, reader, msg.colors);
+  }
+
+  if (msg.has_timestamps) {
+    reader.readDeltas(num_vertices, msg.stamps);
+  }
+
+  if (msg.has_first_seen_stamps) {
+    reader.readDeltas(num_vertices, msg.first_seen_stamps);
+  }
+
+  if (msg.has_labels) {
+    reader.readDeltas(num_vertices, msg.labels);
+  }
+
+  const auto num_faces = reader.read();
+  if (num_faces > data.size()) {
+    throw std::runtime_error("invalid mesh delta: compact data is truncated");
+  }
+
+  reader.readDeltas(num_faces, msg.face_indices);
+  reader.readDeltas(3 * num_faces, msg.faces);
+
+  msg.encoding = hydra_msgs::MeshDelta::ENCODING_RAW;
+  msg.compact_data.clear();
+}
+
+}  // namespace hydra
@@ -0,0 +1,210 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/mesh_stitching.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "hydra_ros/utils/parallel_for.h"
+
+namespace hydra {
+
+namespace {
+
+inline uint64_t quantize(const Mesh::Pos& pos, double scale) {
+  // 21 bits per axis, which covers +/- 100 m at the default tolerance
+  uint64_t key = 0;
+  for (int i = 0; i < 3; ++i) {
+    const auto index = static_cast<int64_t>(std::floor(pos[i] * scale + 0.5));
+    key |= (static_cast<uint64_t>(index) & 0x1FFFFF) << (21 * i);
+  }
+
+  return key;
+}
+
+inline size_t shardFor(uint64_t key, size_t num_shards) {
+  // mix the bits so that neighboring cells spread across shards
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return key % num_shards;
+}
+
+void copyVertex(const Mesh& from, size_t i, Mesh& to, size_t j) {
+  to.points[j] = from.points[i];
+  if (to.has_colors && from.has_colors) {
+    to.colors[j] = from.colors[i];
+  }
+
+  if (to.has_timestamps && from.has_timestamps) {
+    to.stamps[j] = from.stamps[i];
+  }
+
+  if (to.has_first_seen_stamps && from.has_first_seen_stamps) {
+    to.first_seen_stamps[j] = from.first_seen_stamps[i];
+  }
+
+  if (to.has_labels && from.has_labels) {
+    to.labels[j] = from.labels[i];
+  }
+}
+
+}  // namespace
+
+Mesh::Ptr connectMeshes(const std::vector<const Mesh*>& meshes,
+                        double tolerance,
+                        size_t num_threads) {
+  CHECK_GT(tolerance, 0.0);
+  const Mesh* first = nullptr;
+  std::vector<size_t> vertex_offsets(meshes.size() + 1, 0);
+  for (size_t m = 0; m < meshes.size(); ++m) {
+    const size_t num_vertices = meshes[m] ? meshes[m]->numVertices() : 0;
+    vertex_offsets[m + 1] = vertex_offsets[m] + num_vertices;
+    if (!first && meshes[m]) {
+      first = meshes[m];
+    }
+  }
+
+  auto result = first ? std::make_shared<Mesh>(first->has_colors,
+                                               first->has_timestamps,
+                                               first->has_labels,
+                                               first->has_first_seen_stamps)
+                      : std::make_shared<Mesh>();
+  const size_t total_vertices = vertex_offsets.back();
+  if (!total_vertices) {
+    return result;
+  }
+
+  // quantized keys of every input vertex
+  const double scale = 1.0 / tolerance;
+  std::vector<uint64_t> keys(total_vertices);
+  parallelFor(meshes.size(), num_threads, [&](size_t m) {
+    if (!meshes[m]) {
+      return;
+    }
+
+    const auto& points = meshes[m]->points;
+    for (size_t i = 0; i < points.size(); ++i) {
+      keys[vertex_offsets[m] + i] = quantize(points[i], scale);
+    }
+  });
+
+  // each shard assigns local indices in input order to the keys it owns
+  const size_t num_shards = std::max<size_t>(num_threads, 1);
+  std::vector<uint32_t> local_index(total_vertices);
+  std::vector<uint32_t> shard_of(total_vertices);
+  std::vector<std::vector<size_t>> shard_vertices(num_shards);
+  parallelFor(num_shards, num_threads, [&](size_t shard) {
+    std::unordered_map<uint64_t, uint32_t> lookup;
+    auto& unique = shard_vertices[shard];
+    for (size_t v = 0; v < total_vertices; ++v) {
+      if (shardFor(keys[v], num_shards) != shard) {
+        continue;
+      }
+
+      auto [iter, inserted] = lookup.emplace(keys[v], unique.size());
+      if (inserted) {
+        unique.push_back(v);
+      }
+
+      local_index[v] = iter->second;
+      shard_of[v] = shard;
+    }
+  });
+
+  std::vector<size_t> shard_offsets(num_shards + 1, 0);
+  for (size_t s = 0; s < num_shards; ++s) {
+    shard_offsets[s + 1] = shard_offsets[s] + shard_vertices[s].size();
+  }
+
+  result->resizeVertices(shard_offsets.back());
+  const auto mesh_for = [&](size_t v) {
+    const auto iter = std::upper_bound(vertex_offsets.begin(), vertex_offsets.end(), v);
+    return static_cast<size_t>(iter - vertex_offsets.begin() - 1);
+  };
+
+  parallelFor(num_shards, num_threads, [&](size_t shard) {
+    const auto& unique = shard_vertices[shard];
+    for (size_t i = 0; i < unique.size(); ++i) {
+      const size_t m = mesh_for(unique[i]);
+      copyVertex(*meshes[m],
+                 unique[i] - vertex_offsets[m],
+                 *result,
+                 shard_offsets[shard] + i);
+    }
+  });
+
+  // remap faces, dropping any that collapse once vertices are merged
+  std::vector<std::vector<Mesh::Face>> faces(meshes.size());
+  parallelFor(meshes.size(), num_threads, [&](size_t m) {
+    if (!meshes[m]) {
+      return;
+    }
+
+    auto& mesh_faces = faces[m];
+    mesh_faces.reserve(meshes[m]->faces.size());
+    for (const auto& face : meshes[m]->faces) {
+      Mesh::Face new_face;
+      for (size_t i = 0; i < 3; ++i) {
+        const size_t v = vertex_offsets[m] + face[i];
+        new_face[i] = shard_offsets[shard_of[v]] + local_index[v];
+      }
+
+      if (new_face[0] != new_face[1] && new_face[1] != new_face[2] &&
+          new_face[0] != new_face[2]) {
+        mesh_faces.push_back(new_face);
+      }
+    }
+  });
+
+  size_t num_faces = 0;
+  for (const auto& mesh_faces : faces) {
+    num_faces += mesh_faces.size();
+  }
+
+  result->faces.reserve(num_faces);
+  for (const auto& mesh_faces : faces) {
+    result->faces.insert(result->faces.end(), mesh_faces.begin(), mesh_faces.end());
+  }
+
+  VLOG(1) << "Connected " << meshes.size() << " meshes: " << total_vertices << " -> "
+          << result->numVertices() << " vertices, " << num_faces << " faces";
+  return result;
+}
+
+}  // namespace hydra
@@ -0,0 +1,254 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace hydra {
+
+namespace {
+
+inline constexpr double kMinLatencyS = 1.0e-6;
+inline constexpr double kBucketsPerDoubling = 4.0;
+
+inline size_t getBucket(double seconds) {
+  if (seconds <= kMinLatencyS) {
+    return 0;
+  }
+
+  const auto doublings = std::log2(seconds / kMinLatencyS);
+  const auto bucket = std::ceil(kBucketsPerDoubling * doublings);
+  return std::min(static_cast<size_t>(bucket), LatencyHistogram::kNumBuckets - 1);
+}
+
+inline std::string escapeLabel(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const auto c : value) {
+    switch (c) {
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
+}  // namespace
+
+double LatencyHistogram::bucketUpperBound(size_t bucket) {
+  return kMinLatencyS * std::exp2(bucket / kBucketsPerDoubling);
+}
+
+void LatencyHistogram::record(double seconds) {
+  ++buckets_[getBucket(seconds)];
+  ++count_;
+  total_s_ += seconds;
+  max_s_ = std::max(max_s_, seconds);
+}
+
+double LatencyHistogram::quantile(double q) const {
+  if (!count_) {
+    return 0.0;
+  }
+
+  // rank of the sample at the quantile (1-indexed)
+  const auto rank = std::max<uint64_t>(1, std::ceil(q * count_));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // the last bucket is unbounded, so fall back to the true max
+      return std::min(bucketUpperBound(i), max_s_);
+    }
+  }
+
+  return max_s_;
+}
+
+void LatencyHistogram::clear() {
+  buckets_.fill(0);
+  count_ = 0;
+  total_s_ = 0.0;
+  max_s_ = 0.0;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+  static MetricsRegistry registry;
+  return registry;
+}
+
+void MetricsRegistry::recordLatency(const std::string& name, double seconds) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  latencies_[name].record(seconds);
+}
+
+void MetricsRegistry::addCount(const std::string& name, uint64_t count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  counters_[name] += count;
+}
+
+void MetricsRegistry::setGauge(const std::string& name, double value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  gauges_[name] = value;
+}
+
+void MetricsRegistry::registerGauge(const std::string& name,
+                                    const GaugeCallback& callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  gauge_callbacks_[name] = callback;
+}
+
+void MetricsRegistry::removeGauge(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  gauge_callbacks_.erase(name);
+  gauges_.erase(name);
+}
+
+using LatencySummaries = std::map<std::string, MetricsRegistry::LatencySummary>;
+
+LatencySummaries MetricsRegistry::takeLatencies() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  LatencySummaries summaries;
+  for (auto& [name, histogram] : latencies_) {
+    if (!histogram.count()) {
+      continue;  // nothing recorded during this window
+    }
+
+    auto& summary = summaries[name];
+    summary.count = histogram.count();
+    summary.mean_s = histogram.mean();
+    summary.p50_s = histogram.quantile(0.5);
+    summary.p95_s = histogram.quantile(0.95);
+    summary.p99_s = histogram.quantile(0.99);
+    summary.max_s = histogram.max();
+    histogram.clear();
+  }
+
+  return summaries;
+}
+
+std::map<std::string, uint64_t> MetricsRegistry::counters() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return counters_;
+}
+
+std::map<std::string, double> MetricsRegistry::gauges() const {
+  std::map<std::string, GaugeCallback> callbacks;
+  std::map<std::string, double> values;
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks = gauge_callbacks_;
+    values = gauges_;
+  }  // end critical section
+
+  // callbacks may take other locks (e.g., queue mutexes), so call them unlocked
+  for (const auto& [name, callback] : callbacks) {
+    values[name] = callback();
+  }
+
+  return values;
+}
+
+void MetricsRegistry::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  latencies_.clear();
+  counters_.clear();
+  gauges_.clear();
+  gauge_callbacks_.clear();
+}
+
+std::string formatPrometheus(const std::string& node_name,
+                             const LatencySummaries& latencies,
+                             const std::map<std::string, uint64_t>& counters,
+                             const std::map<std::string, double>& gauges) {
+  const std::string node_label = "node=\"" + escapeLabel(node_name) + "\"";
+  std::stringstream ss;
+  ss << "# HELP hydra_latency_seconds Latency quantiles over the last window\n";
+  ss << "# TYPE hydra_latency_seconds gauge\n";
+  for (const auto& [name, summary] : latencies) {
+    const auto prefix = "hydra_latency_seconds{" + node_label + ",timer=\"" +
+                        escapeLabel(name) + "\",quantile=";
+    ss << prefix << "\"0.5\"} " << summary.p50_s << "\n";
+    ss << prefix << "\"0.95\"} " << summary.p95_s << "\n";
+    ss << prefix << "\"0.99\"} " << summary.p99_s << "\n";
+    ss << prefix << "\"1\"} " << summary.max_s << "\n";
+  }
+
+  ss << "# HELP hydra_latency_samples Number of latency samples in the last window\n";
+  ss << "# TYPE hydra_latency_samples gauge\n";
+  for (const auto& [name, summary] : latencies) {
+    ss << "hydra_latency_samples{" << node_label << ",timer=\"" << escapeLabel(name)
+       << "\"} " << summary.count << "\n";
+  }
+
+  ss << "# HELP hydra_events_total Monotonic event and byte counters\n";
+  ss << "# TYPE hydra_events_total counter\n";
+  for (const auto& [name, value] : counters) {
+    ss << "hydra_events_total{" << node_label << ",name=\"" << escapeLabel(name)
+       << "\"} " << value << "\n";
+  }
+
+  ss << "# HELP hydra_gauge Sampled values (e.g., queue depths)\n";
+  ss << "# TYPE hydra_gauge gauge\n";
+  for (const auto& [name, value] : gauges) {
+    ss << "hydra_gauge{" << node_label << ",name=\"" << escapeLabel(name) << "\"} "
+       << value << "\n";
+  }
+
+  return ss.str();
+}
+
+ScopedLatency::ScopedLatency(const std::string& name)
+    : name_(name), start_(std::chrono::steady_clock::now()) {}
+
+ScopedLatency::~ScopedLatency() {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_;
+  MetricsRegistry::instance().recordLatency(name_, elapsed.count());
+}
+
+}  // namespace hydra
@@ -0,0 +1,172 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/metrics_publisher.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <glog/logging.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace hydra {
+
+using diagnostic_msgs::DiagnosticArray;
+using diagnostic_msgs::DiagnosticStatus;
+using diagnostic_msgs::KeyValue;
+
+void declare_config(MetricsPublisher::Config& config) {
+  using namespace config;
+  name("MetricsPublisher::Config");
+  field(config.enable, "enable");
+  field(config.period_s, "period_s", "s");
+  field(config.warn_p99_s, "warn_p99_s", "s");
+  field(config.prometheus_path, "prometheus_path");
+
+  check(config.period_s, GT, 0.0, "period_s");
+}
+
+namespace {
+
+template <typename T>
+inline void addValue(DiagnosticStatus& status, const std::string& key, T value) {
+  auto& kv = status.values.emplace_back();
+  kv.key = key;
+  kv.value = std::to_string(value);
+}
+
+inline DiagnosticStatus makeStatus(const std::string& node_name,
+                                   const std::string& name) {
+  DiagnosticStatus status;
+  status.level = DiagnosticStatus::OK;
+  status.name = node_name + ": " + name;
+  status.hardware_id = node_name;
+  return status;
+}
+
+}  // namespace
+
+MetricsPublisher::MetricsPublisher(const Config& config,
+                                   const ros::NodeHandle& nh,
+                                   const std::string& node_name)
+    : config(config::checkValid(config)), nh_(nh), node_name_(node_name) {
+  if (!config.enable) {
+    return;
+  }
+
+  pub_ = nh_.advertise<DiagnosticArray>("/diagnostics", 10);
+  last_time_ = ros::WallTime::now();
+  timer_ = nh_.createWallTimer(ros::WallDuration(config.period_s),
+                               &MetricsPublisher::publish,
+                               this);
+}
+
+MetricsPublisher::~MetricsPublisher() { timer_.stop(); }
+
+void MetricsPublisher::publish(const ros::WallTimerEvent&) {
+  auto& registry = MetricsRegistry::instance();
+  const auto latencies = registry.takeLatencies();
+  const auto counters = registry.counters();
+  const auto gauges = registry.gauges();
+
+  const auto now = ros::WallTime::now();
+  const double elapsed_s = (now - last_time_).toSec();
+  last_time_ = now;
+
+  DiagnosticArray msg;
+  msg.header.stamp = ros::Time::now();
+
+  auto& latency_status = msg.status.emplace_back(makeStatus(node_name_, "latency"));
+  for (const auto& [name, summary] : latencies) {
+    addValue(latency_status, name + "/count", summary.count);
+    addValue(latency_status, name + "/mean_ms", 1.0e3 * summary.mean_s);
+    addValue(latency_status, name + "/p50_ms", 1.0e3 * summary.p50_s);
+    addValue(latency_status, name + "/p95_ms", 1.0e3 * summary.p95_s);
+    addValue(latency_status, name + "/p99_ms", 1.0e3 * summary.p99_s);
+    addValue(latency_status, name + "/max_ms", 1.0e3 * summary.max_s);
+    if (config.warn_p99_s > 0.0 && summary.p99_s > config.warn_p99_s) {
+      latency_status.level = DiagnosticStatus::WARN;
+      latency_status.message += (latency_status.message.empty() ? "" : ", ") + name;
+    }
+  }
+
+  if (latency_status.level == DiagnosticStatus::WARN) {
+    latency_status.message = "p99 above threshold: " + latency_status.message;
+  }
+
+  auto& counter_status = msg.status.emplace_back(makeStatus(node_name_, "counters"));
+  for (const auto& [name, total] : counters) {
+    auto iter = last_counters_.find(name);
+    const auto previous = iter == last_counters_.end() ? 0 : iter->second;
+    addValue(counter_status, name, total);
+    if (elapsed_s > 0.0) {
+      addValue(counter_status, name + "/rate", (total - previous) / elapsed_s);
+    }
+  }
+  last_counters_ = counters;
+
+  auto& gauge_status = msg.status.emplace_back(makeStatus(node_name_, "gauges"));
+  for (const auto& [name, value] : gauges) {
+    addValue(gauge_status, name, value);
+  }
+
+  pub_.publish(msg);
+
+  if (!config.prometheus_path.empty()) {
+    writePrometheus(formatPrometheus(node_name_, latencies, counters, gauges));
+  }
+}
+
+void MetricsPublisher::writePrometheus(const std::string& contents) const {
+  // write to a temporary file first so that scrapers never see partial output
+  const std::filesystem::path path(config.prometheus_path);
+  const auto tmp_path = path.string() + ".tmp";
+  {
+    std::ofstream out(tmp_path);
+    if (!out) {
+      LOG_FIRST_N(ERROR, 1) << "Unable to write metrics to " << tmp_path;
+      return;
+    }
+
+    out << contents;
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  LOG_IF(ERROR, ec) << "Unable to move metrics to " << path << ": " << ec.message();
+}
+
+}  // namespace hydra
@@ -0,0 +1,298 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/multi_dsg_receiver.h"
+
+#include <glog/logging.h>
+
+#include "hydra_ros/utils/metrics.h"
+
+namespace hydra {
+
+namespace {
+
+using Changes = MultiDsgReceiver::Changes;
+using EdgeKey = MultiDsgReceiver::EdgeKey;
+using GraphState = MultiDsgReceiver::GraphState;
+
+inline EdgeKey edgeKey(NodeId source, NodeId target) {
+  return source < target ? std::make_pair(source, target)
+                         : std::make_pair(target, source);
+}
+
+template <typename K>
+inline const SceneGraphNode* getNode(
+    const std::pair<const K, SceneGraphNode::Ptr>& id_node_pair) {
+  return id_node_pair.second.get();
+}
+
+inline const SceneGraphNode* getNode(const SceneGraphNode::Ptr& node) {
+  return node.get();
+}
+
+template <typename Nodes>
+void diffNodes(const Nodes& nodes,
+               GraphState& state,
+               std::set<NodeId>& seen,
+               Changes& changes) {
+  for (const auto& entry : nodes) {
+    const auto node = getNode(entry);
+    if (!node) {
+      continue;
+    }
+
+    seen.insert(node->id);
+    auto iter = state.nodes.find(node->id);
+    if (iter != state.nodes.end() && *iter->second == node->attributes()) {
+      continue;
+    }
+
+    state.nodes[node->id] = node->attributes().clone();
+    changes.nodes[node->id] = {
+        node->layer, node->timestamp, node->attributes().clone()};
+  }
+}
+
+template <typename Edges>
+void diffEdges(const Edges& edges,
+               const GraphState& state,
+               std::set<EdgeKey>& seen,
+               Changes& changes) {
+  for (const auto& id_edge_pair : edges) {
+    const auto& edge = id_edge_pair.second;
+    const auto key = edgeKey(edge.source, edge.target);
+    seen.insert(key);
+    if (!state.edges.count(key)) {
+      changes.edges[key] = edge.info ? edge.info->clone() : nullptr;
+    }
+  }
+}
+
+}  // namespace
+
+bool MultiDsgReceiver::Changes::empty() const {
+  return nodes.empty() && removed_nodes.empty() && edges.empty() &&
+         removed_edges.empty();
+}
+
+void MultiDsgReceiver::Changes::update(Changes&& other) {
+  for (auto& [node_id, node] : other.nodes) {
+    removed_nodes.erase(node_id);
+    nodes[node_id] = std::move(node);
+  }
+
+  for (const auto node_id : other.removed_nodes) {
+    nodes.erase(node_id);
+    removed_nodes.insert(node_id);
+  }
+
+  for (auto& [key, attrs] : other.edges) {
+    removed_edges.erase(key);
+    edges[key] = std::move(attrs);
+  }
+
+  for (const auto& key : other.removed_edges) {
+    edges.erase(key);
+    removed_edges.insert(key);
+  }
+}
+
+MultiDsgReceiver::MultiDsgReceiver(const ros::NodeHandle& nh,
+                                   const std::vector<std::string>& robot_namespaces) {
+  for (const auto& ns : robot_namespaces) {
+    auto robot = std::make_unique<Robot>();
+    robot->index = robots_.size();
+    robot->ns = ns;
+    robot->nh = ros::NodeHandle(nh, ns);
+    // the queue has to be set before the receiver subscribes
+    robot->threads.reset(new CallbackThreads(robot->nh, 1));
+    robot->receiver.reset(new DsgReceiver(robot->nh));
+
+    auto& robot_ref = *robot;
+    robot->receiver->setUpdateCallback(
+        [this, &robot_ref](const DynamicSceneGraph& graph) {
+          handleUpdate(robot_ref, graph);
+        });
+
+    LOG(INFO) << "Receiving scene graph for robot '" << ns << "'";
+    robots_.push_back(std::move(robot));
+  }
+}
+
+MultiDsgReceiver::~MultiDsgReceiver() {
+  for (auto& robot : robots_) {
+    robot->threads->stop();
+  }
+
+  robots_.clear();
+}
+
+MultiDsgReceiver::Changes MultiDsgReceiver::diffGraph(const DynamicSceneGraph& graph,
+                                                      GraphState& state) {
+  Changes changes;
+  std::set<NodeId> nodes;
+  for (const auto& id_layer_pair : graph.layers()) {
+    diffNodes(id_layer_pair.second->nodes(), state, nodes, changes);
+  }
+
+  for (const auto& id_sublayers_pair : graph.dynamicLayers()) {
+    for (const auto& prefix_layer_pair : id_sublayers_pair.second) {
+      diffNodes(prefix_layer_pair.second->nodes(), state, nodes, changes);
+    }
+  }
+
+  for (auto iter = state.nodes.begin(); iter != state.nodes.end();) {
+    if (nodes.count(iter->first)) {
+      ++iter;
+      continue;
+    }
+
+    changes.removed_nodes.insert(iter->first);
+    iter = state.nodes.erase(iter);
+  }
+
+  std::set<EdgeKey> edges;
+  for (const auto& id_layer_pair : graph.layers()) {
+    diffEdges(id_layer_pair.second->edges(), state, edges, changes);
+  }
+
+  for (const auto& id_sublayers_pair : graph.dynamicLayers()) {
+    for (const auto& prefix_layer_pair : id_sublayers_pair.second) {
+      diffEdges(prefix_layer_pair.second->edges(), state, edges, changes);
+    }
+  }
+
+  diffEdges(graph.interlayer_edges(), state, edges, changes);
+  diffEdges(graph.dynamic_interlayer_edges(), state, edges, changes);
+
+  // edges of removed nodes are dropped with the nodes
+  for (const auto& key : state.edges) {
+    if (!edges.count(key) && nodes.count(key.first) && nodes.count(key.second)) {
+      changes.removed_edges.insert(key);
+    }
+  }
+
+  state.edges = std::move(edges);
+  return changes;
+}
+
+void MultiDsgReceiver::handleUpdate(Robot& robot, const DynamicSceneGraph& graph) {
+  // called from the robot's receiving thread, so only the robot's changes are locked
+  ScopedLatency latency("multi_dsg_receiver/diff");
+  auto changes = diffGraph(graph, robot.state);
+  if (changes.empty()) {
+    return;
+  }
+
+  MetricsRegistry::instance().addCount("multi_dsg_receiver/updates");
+  std::lock_guard<std::mutex> lock(robot.mutex);
+  robot.pending.update(std::move(changes));
+}
+
+DynamicSceneGraph::Ptr MultiDsgReceiver::getUpdatedGraph() {
+  bool updated = false;
+  for (auto& robot : robots_) {
+    Changes changes;
+    {  // start critical section
+      std::lock_guard<std::mutex> lock(robot->mutex);
+      std::swap(changes, robot->pending);
+    }  // end critical section
+
+    if (changes.empty()) {
+      continue;
+    }
+
+    if (!merged_) {
+      merged_ = std::make_shared<DynamicSceneGraph>();
+    }
+
+    applyChanges(*robot, changes);
+    updated = true;
+  }
+
+  return updated ? merged_ : nullptr;
+}
+
+void MultiDsgReceiver::applyChanges(const Robot& robot, Changes& changes) {
+  ScopedLatency latency("multi_dsg_receiver/merge");
+  auto& metrics = MetricsRegistry::instance();
+  metrics.addCount("multi_dsg_receiver/merges");
+  metrics.addCount("multi_dsg_receiver/merged_nodes", changes.nodes.size());
+
+  for (const auto& key : changes.removed_edges) {
+    merged_->removeEdge(key.first, key.second);
+  }
+
+  for (const auto node_id : changes.removed_nodes) {
+    auto iter = owners_.find(node_id);
+    if (iter == owners_.end() || iter->second != robot.index) {
+      continue;
+    }
+
+    merged_->removeNode(node_id);
+    owners_.erase(iter);
+  }
+
+  for (auto& [node_id, node] : changes.nodes) {
+    auto iter = owners_.emplace(node_id, robot.index).first;
+    if (iter->second != robot.index) {
+      metrics.addCount("multi_dsg_receiver/id_conflicts");
+      LOG_FIRST_N(WARNING, 5) << "Robot '" << robot.ns << "' overwrote node "
+                              << NodeSymbol(node_id).getLabel() << " from robot '"
+                              << robots_.at(iter->second)->ns << "'";
+      iter->second = robot.index;
+    }
+
+    if (!node.timestamp) {
+      merged_->addOrUpdateNode(node.layer, node_id, std::move(node.attributes));
+      continue;
+    }
+
+    // dynamic nodes are appended in order, so they keep their original ids
+    if (!merged_->hasNode(node_id)) {
+      const NodeSymbol symbol(node_id);
+      merged_->emplaceNode(node.layer,
+                           symbol.category(),
+                           *node.timestamp,
+                           std::move(node.attributes),
+                           false);
+    }
+  }
+
+  for (auto& [key, attrs] : changes.edges) {
+    merged_->insertEdge(key.first, key.second, std::move(attrs));
+  }
+}
+
+}  // namespace hydra
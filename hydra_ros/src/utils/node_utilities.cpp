@@ -103,6 +103,21 @@ void spinUntilExitRequested() {
   ROS_WARN("Exiting!");
 }
 
+CallbackThreads::CallbackThreads(ros::NodeHandle& nh, size_t num_threads)
+    : queue(new ros::CallbackQueue()) {
+  nh.setCallbackQueue(queue.get());
+  spinner.reset(new ros::AsyncSpinner(num_threads, queue.get()));
+  spinner->start();
+}
+
+CallbackThreads::~CallbackThreads() { stop(); }
+
+void CallbackThreads::stop() {
+  if (spinner) {
+    spinner->stop();
+  }
+}
+
 void spinAndWait(const ros::NodeHandle& nh) {
   bool exit_after_clock = false;
   nh.getParam("exit_after_clock", exit_after_clock);
@@ -113,4 +128,13 @@ void spinAndWait(const ros::NodeHandle& nh) {
   }
 }
 
+std::string getParamSignature(const ros::NodeHandle& nh) {
+  XmlRpc::XmlRpcValue params;
+  if (!nh.getParam(nh.getNamespace(), params)) {
+    return "";
+  }
+
+  return params.toXml();
+}
+
 }  // namespace hydra
@@ -40,10 +40,37 @@
 #include <config_utilities/types/eigen_matrix.h>
 #include <config_utilities/validation.h>
 #include <hydra/common/global_info.h>
+#include <map_msgs/OccupancyGridUpdate.h>
 #include <nav_msgs/OccupancyGrid.h>
 
+#include "hydra_ros/utils/parallel_for.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <set>
+
 namespace hydra {
 
+using Column = std::pair<int, int>;
+
+struct IncrementalGrid {
+  //! whether the grid has been filled at least once for the current slices
+  bool valid = false;
+  //! block and voxel z-index of every slice the grid was filled from
+  std::vector<std::pair<int, int>> slices;
+  //! global voxel index of cell (0, 0)
+  Eigen::Vector2i origin = Eigen::Vector2i::Zero();
+  //! block columns covered by the robot footprint during the last update
+  std::set<Column> footprint_columns;
+  //! changed cells since the last publish (inclusive)
+  Eigen::Vector2i changed_min;
+  Eigen::Vector2i changed_max;
+  bool resized = false;
+  uint64_t last_full_ns = 0;
+  nav_msgs::OccupancyGrid msg;
+};
+
 template <typename T>
 float getDistance(const T& /*voxel*/) {
   return 0.0f;
@@ -96,6 +123,30 @@ Bounds getLayerBounds(const spatial_hash::VoxelLayer<BlockT>& layer) {
   return bounds;
 }
 
+template <typename BlockT>
+Bounds getLocalBounds(const spatial_hash::VoxelLayer<BlockT>& layer,
+                      const Eigen::Isometry3d& world_T_sensor,
+                      double window_size) {
+  // window is rounded out to block boundaries so that only whole blocks are filled
+  const float block_size = layer.voxel_size * layer.voxels_per_side;
+  const Eigen::Vector2f center = world_T_sensor.translation().head<2>().cast<float>();
+  const Eigen::Vector2f half_size = Eigen::Vector2f::Constant(window_size / 2.0);
+
+  Bounds bounds;
+  bounds.x_min = ((center - half_size) / block_size).array().floor() * block_size;
+  bounds.x_max = ((center + half_size) / block_size).array().ceil() * block_size;
+  bounds.dims = (bounds.x_max - bounds.x_min) / layer.voxel_size;
+  return bounds;
+}
+
+template <typename BlockT>
+bool inBounds(const BlockT& block, const Bounds& bounds) {
+  const Eigen::Vector2f half_size = Eigen::Vector2f::Constant(block.block_size / 2);
+  const Eigen::Vector2f center = block.origin().template head<2>() + half_size;
+  return (center.array() >= bounds.x_min.array()).all() &&
+         (center.array() <= bounds.x_max.array()).all();
+}
+
 template <typename BlockT>
 void initGrid(const spatial_hash::VoxelLayer<BlockT>& layer,
               const Bounds& bounds,
@@ -111,6 +162,77 @@ void initGrid(const spatial_hash::VoxelLayer<BlockT>& layer,
   msg.data.resize(msg.info.width * msg.info.height, -1);
 }
 
+int8_t getInflatedCost(const OccupancyPublisher::Config& config, float distance) {
+  if (distance < config.min_distance) {
+    return 100;
+  }
+
+  if (!config.costmap || distance >= config.inflation_radius) {
+    return 0;
+  }
+
+  if (distance < config.inscribed_radius) {
+    return 99;
+  }
+
+  // matches the costmap_2d decay between the inscribed and inflation radius
+  const auto factor = std::exp(-config.cost_scaling_factor *
+                               (distance - config.inscribed_radius));
+  return static_cast<int8_t>(std::clamp<long>(std::lround(98.0 * factor), 1, 98));
+}
+
+template <typename VoxelT>
+void updateCell(const OccupancyPublisher::Config& config,
+                const VoxelT& voxel,
+                bool in_footprint,
+                int8_t& cell) {
+  if (in_footprint) {
+    cell = 0;
+    return;
+  }
+
+  if (!isObserved(voxel, config.min_observation_weight)) {
+    cell = -2;
+    return;
+  }
+
+  // costs only ever go up across slices in the same way occupancy does
+  const auto cost = getInflatedCost(config, getDistance(voxel));
+  if (cost > 0) {
+    cell = std::max(cell, cost);
+    return;
+  }
+
+  if (cell == -1) {
+    // we only can mark cells as free if they haven't been touched
+    cell = 0;
+  }
+}
+
+// cells points to the grid cell of voxel (0, 0, voxel_z) of the block
+template <typename BlockT>
+void fillBlockSlice(const OccupancyPublisher::Config& config,
+                    const BlockT& block,
+                    int voxel_z,
+                    const BoundingBox& bbox,
+                    const Eigen::Isometry3f& sensor_T_world,
+                    size_t row_stride,
+                    int8_t* cells) {
+  const int vps = block.voxels_per_side;
+  // step the footprint-frame position along each row instead of transforming per voxel
+  const Eigen::Vector3f x_step = sensor_T_world.linear().col(0) * block.voxel_size;
+  for (int y = 0; y < vps; ++y) {
+    int8_t* row = cells + y * row_stride;
+    const Eigen::Vector3f row_pos = block.getVoxelPosition(VoxelIndex(0, y, voxel_z));
+    Eigen::Vector3f sensor_pos = sensor_T_world * row_pos;
+    for (int x = 0; x < vps; ++x, sensor_pos += x_step) {
+      const auto& voxel = block.getVoxel(VoxelIndex(x, y, voxel_z));
+      const bool in_footprint = config.add_robot_footprint && bbox.contains(sensor_pos);
+      updateCell(config, voxel, in_footprint, row[x]);
+    }
+  }
+}
+
 template <typename BlockT>
 void fillOccupancySlice(const OccupancyPublisher::Config& config,
                         const spatial_hash::VoxelLayer<BlockT>& layer,
@@ -125,53 +247,32 @@ void fillOccupancySlice(const OccupancyPublisher::Config& config,
                   : BoundingBox();
   const Eigen::Isometry3f sensor_T_world = world_T_sensor.inverse().cast<float>();
 
-  for (const auto block_ptr :
-       layer.blocksWithCondition([&slice_key](const BlockT& block) {
-         return block.index.z() == slice_key.first.z();
-       })) {
-    for (size_t x = 0; x < block_ptr->voxels_per_side; ++x) {
-      for (size_t y = 0; y < block_ptr->voxels_per_side; ++y) {
-        const VoxelIndex voxel_index(x, y, slice_key.second.z());
-        const auto& voxel = block_ptr->getVoxel(voxel_index);
-        const Eigen::Vector3f pos = block_ptr->getVoxelPosition(voxel_index);
-        const auto rel_pos = pos.head<2>() - bounds.x_min;
-        // pos is center point, so we want floor
-        const auto r = std::floor(rel_pos.y() / layer.voxel_size);
-        const auto c = std::floor(rel_pos.x() / layer.voxel_size);
-        const size_t index = r * msg.info.width + c;
-
-        if (config.add_robot_footprint &&
-            bbox.contains((sensor_T_world * pos).eval())) {
-          msg.data[index] = 0;
-          continue;
-        }
-
-        if (!isObserved(voxel, config.min_observation_weight)) {
-          msg.data[index] = -2;
-          continue;
-        }
-
-        const auto occupied = getDistance(voxel) < config.min_distance;
-        if (occupied) {
-          msg.data[index] = 100;
-          continue;
-        }
-
-        if (msg.data[index] == -1) {
-          // we only can mark cells as free if they haven't been touched
-          msg.data[index] = 0;
-        }
-      }
-    }
-  }
+  const auto blocks = layer.blocksWithCondition([&](const BlockT& block) {
+    return block.index.z() == slice_key.first.z() && inBounds(block, bounds);
+  });
+
+  // blocks in a slice cover disjoint cells, so they can be filled concurrently
+  const size_t width = msg.info.width;
+  const int voxel_z = slice_key.second.z();
+  parallelFor(blocks.size(), config.num_threads, [&](size_t i) {
+    const auto& block = *blocks[i];
+    const Eigen::Vector3f pos = block.getVoxelPosition(VoxelIndex(0, 0, voxel_z));
+    const auto rel_pos = pos.head<2>() - bounds.x_min;
+    // pos is center point, so we want floor
+    const size_t r = std::floor(rel_pos.y() / layer.voxel_size);
+    const size_t c = std::floor(rel_pos.x() / layer.voxel_size);
+    int8_t* cells = msg.data.data() + r * width + c;
+    fillBlockSlice(config, block, voxel_z, bbox, sensor_T_world, width, cells);
+  });
 }
 
 template <typename BlockT>
 void fillOccupancy(const OccupancyPublisher::Config& config,
                    const spatial_hash::VoxelLayer<BlockT>& layer,
                    const Eigen::Isometry3d& world_T_sensor,
-                   nav_msgs::OccupancyGrid& msg) {
-  const auto bounds = getLayerBounds(layer);
+                   nav_msgs::OccupancyGrid& msg,
+                   const std::optional<Bounds>& window = std::nullopt) {
+  const auto bounds = window ? *window : getLayerBounds(layer);
   auto height = config.slice_height;
   if (config.use_relative_height) {
     height += world_T_sensor.translation().z();
@@ -191,32 +292,320 @@ void fillOccupancy(const OccupancyPublisher::Config& config,
   }
 }
 
+inline int floorDiv(int value, int divisor) {
+  return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+template <typename BlockT>
+std::vector<std::pair<int, int>> getSliceKeys(
+    const OccupancyPublisher::Config& config,
+    const spatial_hash::VoxelLayer<BlockT>& layer,
+    const Eigen::Isometry3d& world_T_sensor) {
+  auto height = config.slice_height;
+  if (config.use_relative_height) {
+    height += world_T_sensor.translation().z();
+  }
+
+  std::vector<std::pair<int, int>> slices;
+  for (size_t i = 0; i < config.num_slices; ++i) {
+    const Point slice_pos(0, 0, height + i * layer.voxel_size);
+    const auto key = layer.getVoxelKey(slice_pos);
+    slices.emplace_back(key.first.z(), key.second.z());
+  }
+
+  return slices;
+}
+
+std::set<Column> getFootprintColumns(const OccupancyPublisher::Config& config,
+                                     const Eigen::Isometry3d& world_T_sensor,
+                                     float block_size) {
+  if (!config.add_robot_footprint) {
+    return {};
+  }
+
+  const Eigen::Isometry3f world_T_sensor_f = world_T_sensor.cast<float>();
+  Eigen::Vector2f lower = Eigen::Vector2f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector2f upper =
+      Eigen::Vector2f::Constant(std::numeric_limits<float>::lowest());
+  for (int i = 0; i < 8; ++i) {
+    const Eigen::Vector3f corner(
+        (i & 1) ? config.footprint_max.x() : config.footprint_min.x(),
+        (i & 2) ? config.footprint_max.y() : config.footprint_min.y(),
+        (i & 4) ? config.footprint_max.z() : config.footprint_min.z());
+    const Eigen::Vector2f world_corner = (world_T_sensor_f * corner).head<2>();
+    lower = lower.cwiseMin(world_corner);
+    upper = upper.cwiseMax(world_corner);
+  }
+
+  std::set<Column> columns;
+  const int x_min = std::floor(lower.x() / block_size);
+  const int x_max = std::floor(upper.x() / block_size);
+  const int y_min = std::floor(lower.y() / block_size);
+  const int y_max = std::floor(upper.y() / block_size);
+  for (int x = x_min; x <= x_max; ++x) {
+    for (int y = y_min; y <= y_max; ++y) {
+      columns.emplace(x, y);
+    }
+  }
+
+  return columns;
+}
+
+void growGrid(IncrementalGrid& grid,
+              const Eigen::Vector2i& lower,
+              const Eigen::Vector2i& upper,
+              int chunk_voxels) {
+  auto& info = grid.msg.info;
+  const Eigen::Vector2i curr_upper =
+      grid.origin + Eigen::Vector2i(info.width, info.height);
+  const bool empty = info.width == 0 || info.height == 0;
+  if (!empty && (lower.array() >= grid.origin.array()).all() &&
+      (upper.array() <= curr_upper.array()).all()) {
+    return;
+  }
+
+  Eigen::Vector2i new_lower = empty ? lower : lower.cwiseMin(grid.origin);
+  Eigen::Vector2i new_upper = empty ? upper : upper.cwiseMax(curr_upper);
+  for (int i = 0; i < 2; ++i) {
+    new_lower(i) = floorDiv(new_lower(i), chunk_voxels) * chunk_voxels;
+    new_upper(i) = -floorDiv(-new_upper(i), chunk_voxels) * chunk_voxels;
+  }
+
+  const Eigen::Vector2i dims = new_upper - new_lower;
+  std::vector<int8_t> data(dims.x() * dims.y(), -1);
+  if (!empty) {
+    const Eigen::Vector2i offset = grid.origin - new_lower;
+    for (size_t r = 0; r < info.height; ++r) {
+      const auto row_start = grid.msg.data.begin() + r * info.width;
+      std::copy(row_start,
+                row_start + info.width,
+                data.begin() + (r + offset.y()) * dims.x() + offset.x());
+    }
+  }
+
+  grid.origin = new_lower;
+  grid.msg.data = std::move(data);
+  info.width = dims.x();
+  info.height = dims.y();
+  info.origin.position.x = new_lower.x() * info.resolution;
+  info.origin.position.y = new_lower.y() * info.resolution;
+  grid.resized = true;
+}
+
+// cells points to the grid cell of voxel (0, 0) of the column
+template <typename BlockT>
+void fillColumn(const OccupancyPublisher::Config& config,
+                const spatial_hash::VoxelLayer<BlockT>& layer,
+                const std::vector<std::pair<int, int>>& slices,
+                const Eigen::Isometry3f& sensor_T_world,
+                const BoundingBox& bbox,
+                const Column& column,
+                size_t row_stride,
+                int8_t* cells) {
+  const int vps = layer.voxels_per_side;
+  for (int y = 0; y < vps; ++y) {
+    std::fill_n(cells + y * row_stride, vps, -1);
+  }
+
+  for (const auto& [block_z, voxel_z] : slices) {
+    const auto block =
+        layer.getBlockPtr(BlockIndex(column.first, column.second, block_z));
+    if (block) {
+      fillBlockSlice(config, *block, voxel_z, bbox, sensor_T_world, row_stride, cells);
+    }
+  }
+
+  for (int y = 0; y < vps; ++y) {
+    int8_t* row = cells + y * row_stride;
+    std::replace(row, row + vps, int8_t(-2), int8_t(-1));
+  }
+}
+
+template <typename BlockT>
+void updateColumn(const OccupancyPublisher::Config& config,
+                  const spatial_hash::VoxelLayer<BlockT>& layer,
+                  const Eigen::Isometry3f& sensor_T_world,
+                  const BoundingBox& bbox,
+                  const Column& column,
+                  IncrementalGrid& grid) {
+  const int vps = layer.voxels_per_side;
+  const Eigen::Vector2i offset =
+      Eigen::Vector2i(column.first, column.second) * vps - grid.origin;
+  const size_t width = grid.msg.info.width;
+  int8_t* cells = grid.msg.data.data() + offset.y() * width + offset.x();
+  fillColumn(config, layer, grid.slices, sensor_T_world, bbox, column, width, cells);
+}
+
+void resetChanges(IncrementalGrid& grid) {
+  grid.changed_min = Eigen::Vector2i::Constant(std::numeric_limits<int>::max());
+  grid.changed_max = Eigen::Vector2i::Constant(std::numeric_limits<int>::lowest());
+}
+
+template <typename BlockT>
+void updateIncrementalGrid(const OccupancyPublisher::Config& config,
+                           const spatial_hash::VoxelLayer<BlockT>& layer,
+                           const Eigen::Isometry3d& world_T_sensor,
+                           IncrementalGrid& grid) {
+  const auto slices = getSliceKeys(config, layer, world_T_sensor);
+  const bool rebuild = !grid.valid || slices != grid.slices;
+  if (rebuild) {
+    // cells from other slice heights are meaningless, so start from scratch
+    grid.msg.info.resolution = layer.voxel_size;
+    grid.msg.info.width = 0;
+    grid.msg.info.height = 0;
+    grid.msg.data.clear();
+    grid.slices = slices;
+    grid.valid = true;
+  }
+
+  std::set<int> slice_blocks;
+  for (const auto& slice : slices) {
+    slice_blocks.insert(slice.first);
+  }
+
+  std::set<Column> columns;
+  for (const auto& block : layer) {
+    if ((rebuild || block.updated) && slice_blocks.count(block.index.z())) {
+      columns.emplace(block.index.x(), block.index.y());
+    }
+  }
+
+  // cells under the previous and current footprint both need to be recomputed
+  const float block_size = layer.voxel_size * layer.voxels_per_side;
+  auto footprint_columns = getFootprintColumns(config, world_T_sensor, block_size);
+  columns.insert(grid.footprint_columns.begin(), grid.footprint_columns.end());
+  columns.insert(footprint_columns.begin(), footprint_columns.end());
+  grid.footprint_columns = std::move(footprint_columns);
+  if (columns.empty()) {
+    return;
+  }
+
+  const int vps = layer.voxels_per_side;
+  Eigen::Vector2i lower = Eigen::Vector2i::Constant(std::numeric_limits<int>::max());
+  Eigen::Vector2i upper = Eigen::Vector2i::Constant(std::numeric_limits<int>::lowest());
+  for (const auto& column : columns) {
+    const Eigen::Vector2i start = Eigen::Vector2i(column.first, column.second) * vps;
+    lower = lower.cwiseMin(start);
+    upper = upper.cwiseMax(start + Eigen::Vector2i::Constant(vps));
+  }
+
+  const int chunk_voxels = std::max<int>(config.grid_chunk_blocks, 1) * vps;
+  growGrid(grid, lower, upper, chunk_voxels);
+
+  const auto bbox = config.add_robot_footprint
+                        ? BoundingBox(config.footprint_min, config.footprint_max)
+                        : BoundingBox();
+  const Eigen::Isometry3f sensor_T_world = world_T_sensor.inverse().cast<float>();
+  const std::vector<Column> to_update(columns.begin(), columns.end());
+  parallelFor(to_update.size(), config.num_threads, [&](size_t i) {
+    updateColumn(config, layer, sensor_T_world, bbox, to_update[i], grid);
+  });
+
+  grid.changed_min = lower - grid.origin;
+  grid.changed_max = upper - grid.origin - Eigen::Vector2i::Ones();
+}
+
+template <typename BlockT>
+void fillCoarseOccupancy(const OccupancyPublisher::Config& config,
+                         const spatial_hash::VoxelLayer<BlockT>& layer,
+                         const Eigen::Isometry3d& world_T_sensor,
+                         nav_msgs::OccupancyGrid& msg) {
+  const auto bounds = getLayerBounds(layer);
+  const auto slices = getSliceKeys(config, layer, world_T_sensor);
+  auto height = config.slice_height;
+  if (config.use_relative_height) {
+    height += world_T_sensor.translation().z();
+  }
+
+  const double resolution = config.coarse_resolution;
+  msg.info.resolution = resolution;
+  msg.info.width = std::ceil((bounds.x_max.x() - bounds.x_min.x()) / resolution);
+  msg.info.height = std::ceil((bounds.x_max.y() - bounds.x_min.y()) / resolution);
+  msg.info.origin.position.x = bounds.x_min.x();
+  msg.info.origin.position.y = bounds.x_min.y();
+  msg.info.origin.position.z = height;
+  msg.info.origin.orientation.w = 1.0;
+  msg.data.resize(msg.info.width * msg.info.height, -1);
+
+  std::set<int> slice_blocks;
+  for (const auto& slice : slices) {
+    slice_blocks.insert(slice.first);
+  }
+
+  std::set<Column> columns;
+  for (const auto& block : layer) {
+    if (slice_blocks.count(block.index.z())) {
+      columns.emplace(block.index.x(), block.index.y());
+    }
+  }
+
+  const auto bbox = config.add_robot_footprint
+                        ? BoundingBox(config.footprint_min, config.footprint_max)
+                        : BoundingBox();
+  const Eigen::Isometry3f sensor_T_world = world_T_sensor.inverse().cast<float>();
+  const int vps = layer.voxels_per_side;
+  std::vector<int8_t> cells(vps * vps);
+  for (const auto& column : columns) {
+    // only a single column is ever held at full resolution
+    fillColumn(config, layer, slices, sensor_T_world, bbox, column, vps, cells.data());
+    const Eigen::Vector2i start = Eigen::Vector2i(column.first, column.second) * vps;
+    for (int y = 0; y < vps; ++y) {
+      const float pos_y = (start.y() + y + 0.5f) * layer.voxel_size;
+      const size_t r = std::floor((pos_y - bounds.x_min.y()) / resolution);
+      for (int x = 0; x < vps; ++x) {
+        const float pos_x = (start.x() + x + 0.5f) * layer.voxel_size;
+        const size_t c = std::floor((pos_x - bounds.x_min.x()) / resolution);
+        // unknown < free < occupied, so max-pooling keeps the most conservative value
+        auto& cell = msg.data[r * msg.info.width + c];
+        cell = std::max(cell, cells[y * vps + x]);
+      }
+    }
+  }
+}
+
 template <typename BlockT>
 void collate(const spatial_hash::VoxelLayer<BlockT>& layer_in,
              spatial_hash::VoxelLayer<BlockT>& layer_out,
-             double min_observation_weight) {
+             double min_observation_weight,
+             size_t num_threads) {
+  std::vector<const BlockT*> blocks;
   for (const auto& block : layer_in) {
-    bool unobserved = true;
+    blocks.push_back(&block);
+  }
+
+  std::vector<uint8_t> observed(blocks.size(), false);
+  parallelFor(blocks.size(), num_threads, [&](size_t b) {
+    const auto& block = *blocks[b];
     for (size_t i = 0; i < block.numVoxels(); ++i) {
       if (isObserved(block.getVoxel(i), min_observation_weight)) {
-        unobserved = false;
+        observed[b] = true;
         break;
       }
     }
+  });
+
+  // allocation modifies the layer and has to happen serially
+  std::vector<BlockT*> new_blocks(blocks.size(), nullptr);
+  for (size_t b = 0; b < blocks.size(); ++b) {
+    if (observed[b]) {
+      new_blocks[b] = layer_out.allocateBlockPtr(blocks[b]->index).get();
+      new_blocks[b]->updated = blocks[b]->updated;
+    }
+  }
 
-    if (unobserved) {
-      continue;
+  parallelFor(blocks.size(), num_threads, [&](size_t b) {
+    if (!new_blocks[b]) {
+      return;
     }
 
-    auto new_block = layer_out.allocateBlockPtr(block.index);
-    new_block->updated = block.updated;
+    const auto& block = *blocks[b];
     for (size_t i = 0; i < block.numVoxels(); ++i) {
       const auto& voxel = block.getVoxel(i);
       if (isObserved(voxel, min_observation_weight)) {
-        new_block->getVoxel(i) = voxel;
+        new_blocks[b]->getVoxel(i) = voxel;
       }
     }
-  }
+  });
 }
 
 void declare_config(OccupancyPublisher::Config& config) {
@@ -230,55 +619,203 @@ void declare_config(OccupancyPublisher::Config& config) {
   field(config.add_robot_footprint, "add_robot_footprint");
   field(config.footprint_min, "footprint_min");
   field(config.footprint_max, "footprint_max");
+  field(config.incremental, "incremental");
+  field(config.grid_chunk_blocks, "grid_chunk_blocks");
+  field(config.full_update_period_s, "full_update_period_s", "s");
+  field(config.num_threads, "num_threads");
+  field(config.local_window_size, "local_window_size", "m");
+  field(config.coarse_resolution, "coarse_resolution", "m");
+  field(config.coarse_period_s, "coarse_period_s", "s");
+  field(config.costmap, "costmap");
+  field(config.inscribed_radius, "inscribed_radius", "m");
+  field(config.inflation_radius, "inflation_radius", "m");
+  field(config.cost_scaling_factor, "cost_scaling_factor");
+  check(config.grid_chunk_blocks, GT, 0u, "grid_chunk_blocks");
+  if (config.costmap) {
+    check(config.inflation_radius, GE, config.inscribed_radius, "inflation_radius");
+    check(config.cost_scaling_factor, GE, 0.0, "cost_scaling_factor");
+  }
+}
+
+void fillOccupancyGrid(const OccupancyPublisher::Config& config,
+                       const TsdfLayer& tsdf,
+                       const Eigen::Isometry3d& world_T_sensor,
+                       nav_msgs::OccupancyGrid& msg) {
+  fillOccupancy(config, tsdf, world_T_sensor, msg);
+}
+
+void fillOccupancyGrid(const OccupancyPublisher::Config& config,
+                       const places::GvdLayer& gvd,
+                       const Eigen::Isometry3d& world_T_sensor,
+                       nav_msgs::OccupancyGrid& msg) {
+  fillOccupancy(config, gvd, world_T_sensor, msg);
+}
+
+namespace {
+
+template <typename Msg, typename Callback>
+ros::Publisher advertiseLatched(ros::NodeHandle& nh,
+                                const std::string& topic,
+                                const Callback& connect_cb) {
+  return nh.advertise<Msg>(topic,
+                           1,
+                           connect_cb,
+                           ros::SubscriberStatusCallback(),
+                           ros::VoidConstPtr(),
+                           true);
 }
 
+}  // namespace
+
 OccupancyPublisher::OccupancyPublisher(const Config& config, const ros::NodeHandle& nh)
     : config(config::checkValid(config)),
       nh_(nh),
-      pub_(nh_.advertise<nav_msgs::OccupancyGrid>("occupancy", 1, true)) {}
+      need_full_grid_(false),
+      need_coarse_grid_(false) {
+  const ros::SubscriberStatusCallback connect_cb =
+      boost::bind(&OccupancyPublisher::onSubscriberConnect, this, _1);
+  pub_ = advertiseLatched<nav_msgs::OccupancyGrid>(nh_, "occupancy", connect_cb);
+  if (config.incremental) {
+    update_pub_ =
+        nh_.advertise<map_msgs::OccupancyGridUpdate>("occupancy_updates", 10, false);
+    grid_ = std::make_unique<IncrementalGrid>();
+  }
+
+  if (config.local_window_size > 0.0) {
+    local_pub_ = nh_.advertise<nav_msgs::OccupancyGrid>("occupancy_local", 1, true);
+  }
+
+  if (config.coarse_resolution > 0.0) {
+    coarse_pub_ =
+        advertiseLatched<nav_msgs::OccupancyGrid>(nh_, "occupancy_coarse", connect_cb);
+  }
+}
 
 OccupancyPublisher::~OccupancyPublisher() {}
 
-void OccupancyPublisher::publishTsdf(uint64_t timestamp_ns,
-                                     const Eigen::Isometry3d& world_T_sensor,
-                                     const TsdfLayer& tsdf) const {
-  if (pub_.getNumSubscribers() == 0) {
-    return;
+void OccupancyPublisher::onSubscriberConnect(
+    const ros::SingleSubscriberPublisher& pub) {
+  // the latched message may be arbitrarily old, so the next update sends the grid
+  if (pub.getTopic() == pub_.getTopic()) {
+    need_full_grid_ = true;
+  } else {
+    need_coarse_grid_ = true;
   }
+}
 
-  nav_msgs::OccupancyGrid msg;
-  msg.header.frame_id = GlobalInfo::instance().getFrames().map;
-  msg.header.stamp.fromNSec(timestamp_ns);
+template <typename BlockT>
+void OccupancyPublisher::publishLayer(
+    uint64_t timestamp_ns,
+    const Eigen::Isometry3d& world_T_sensor,
+    const spatial_hash::VoxelLayer<BlockT>& layer) const {
+  if (grid_) {
+    // the grid has to track every update, even without subscribers
+    resetChanges(*grid_);
+    updateIncrementalGrid(config, layer, world_T_sensor, *grid_);
+    publishIncremental(timestamp_ns);
+  } else if (pub_.getNumSubscribers() > 0) {
+    nav_msgs::OccupancyGrid msg;
+    msg.header.frame_id = GlobalInfo::instance().getFrames().map;
+    msg.header.stamp.fromNSec(timestamp_ns);
+
+    msg.info.map_load_time = msg.header.stamp;
+
+    fillOccupancy(config, layer, world_T_sensor, msg);
+    pub_.publish(msg);
+  }
 
-  msg.info.map_load_time = msg.header.stamp;
+  if (config.local_window_size > 0.0 && local_pub_.getNumSubscribers() > 0) {
+    nav_msgs::OccupancyGrid msg;
+    msg.header.frame_id = GlobalInfo::instance().getFrames().map;
+    msg.header.stamp.fromNSec(timestamp_ns);
+    msg.info.map_load_time = msg.header.stamp;
 
-  fillOccupancy(config, tsdf, world_T_sensor, msg);
-  pub_.publish(msg);
+    const auto window = getLocalBounds(layer, world_T_sensor, config.local_window_size);
+    fillOccupancy(config, layer, world_T_sensor, msg, window);
+    local_pub_.publish(msg);
+  }
+
+  const auto coarse_elapsed_ns =
+      timestamp_ns > last_coarse_ns_ ? timestamp_ns - last_coarse_ns_ : 0;
+  const bool coarse_ready = !last_coarse_ns_ || need_coarse_grid_ ||
+                            coarse_elapsed_ns * 1.0e-9 >= config.coarse_period_s;
+  if (config.coarse_resolution > 0.0 && coarse_ready &&
+      coarse_pub_.getNumSubscribers() > 0) {
+    need_coarse_grid_ = false;
+    nav_msgs::OccupancyGrid msg;
+    msg.header.frame_id = GlobalInfo::instance().getFrames().map;
+    msg.header.stamp.fromNSec(timestamp_ns);
+    msg.info.map_load_time = msg.header.stamp;
+
+    fillCoarseOccupancy(config, layer, world_T_sensor, msg);
+    coarse_pub_.publish(msg);
+    last_coarse_ns_ = timestamp_ns;
+  }
+}
+
+void OccupancyPublisher::publishTsdf(uint64_t timestamp_ns,
+                                     const Eigen::Isometry3d& world_T_sensor,
+                                     const TsdfLayer& tsdf) const {
+  publishLayer(timestamp_ns, world_T_sensor, tsdf);
 }
 
 void OccupancyPublisher::publishGvd(uint64_t timestamp_ns,
                                     const Eigen::Isometry3d& world_T_sensor,
                                     const places::GvdLayer& gvd) const {
-  if (pub_.getNumSubscribers() == 0) {
+  publishLayer(timestamp_ns, world_T_sensor, gvd);
+}
+
+void OccupancyPublisher::publishIncremental(uint64_t timestamp_ns) const {
+  auto& grid = *grid_;
+  if (grid.msg.data.empty()) {
     return;
   }
 
-  nav_msgs::OccupancyGrid msg;
-  msg.header.frame_id = GlobalInfo::instance().getFrames().map;
-  msg.header.stamp.fromNSec(timestamp_ns);
+  grid.msg.header.frame_id = GlobalInfo::instance().getFrames().map;
+  grid.msg.header.stamp.fromNSec(timestamp_ns);
+
+  const auto elapsed_ns =
+      timestamp_ns > grid.last_full_ns ? timestamp_ns - grid.last_full_ns : 0;
+  const bool refresh = config.full_update_period_s > 0.0 &&
+                       elapsed_ns * 1.0e-9 >= config.full_update_period_s;
+  if (grid.resized || refresh || !grid.last_full_ns || need_full_grid_) {
+    // patches are useless to consumers without the full grid, so hold off on them
+    if (pub_.getNumSubscribers() > 0) {
+      need_full_grid_ = false;
+      grid.msg.info.map_load_time = grid.msg.header.stamp;
+      pub_.publish(grid.msg);
+      grid.last_full_ns = timestamp_ns;
+      grid.resized = false;
+    }
 
-  msg.info.map_load_time = msg.header.stamp;
+    return;
+  }
 
-  fillOccupancy(config, gvd, world_T_sensor, msg);
-  pub_.publish(msg);
+  if ((grid.changed_min.array() > grid.changed_max.array()).any() ||
+      update_pub_.getNumSubscribers() == 0) {
+    return;
+  }
+
+  map_msgs::OccupancyGridUpdate msg;
+  msg.header = grid.msg.header;
+  msg.x = grid.changed_min.x();
+  msg.y = grid.changed_min.y();
+  msg.width = grid.changed_max.x() - grid.changed_min.x() + 1;
+  msg.height = grid.changed_max.y() - grid.changed_min.y() + 1;
+  msg.data.reserve(msg.width * msg.height);
+  for (size_t r = msg.y; r < msg.y + msg.height; ++r) {
+    const auto row_start = grid.msg.data.begin() + r * grid.msg.info.width + msg.x;
+    msg.data.insert(msg.data.end(), row_start, row_start + msg.width);
+  }
+
+  update_pub_.publish(msg);
 }
 
 TsdfOccupancyPublisher::TsdfOccupancyPublisher(const Config& config)
-    : config(config),
-      pub_(OccupancyPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
+    : config(config), pub_(config.extraction, ros::NodeHandle(config.ns)) {}
 
 GvdOccupancyPublisher::GvdOccupancyPublisher(const Config& config)
-    : pub_(OccupancyPublisher(config.extraction, ros::NodeHandle(config.ns))) {}
+    : config(config), pub_(config.extraction, ros::NodeHandle(config.ns)) {}
 
 void TsdfOccupancyPublisher::call(uint64_t timestamp_ns,
                                   const Eigen::Isometry3d& world_T_sensor,
@@ -293,7 +830,10 @@ void TsdfOccupancyPublisher::call(uint64_t timestamp_ns,
     tsdf_.reset(new TsdfLayer(tsdf.voxel_size, tsdf.voxels_per_side));
   }
 
-  collate(tsdf, *tsdf_, config.extraction.min_observation_weight);
+  collate(tsdf,
+          *tsdf_,
+          config.extraction.min_observation_weight,
+          config.extraction.num_threads);
   pub_.publishTsdf(timestamp_ns, world_T_sensor, *tsdf_);
 }
 
@@ -310,7 +850,10 @@ void GvdOccupancyPublisher::call(uint64_t timestamp_ns,
     gvd_.reset(new places::GvdLayer(gvd.voxel_size, gvd.voxels_per_side));
   }
 
-  collate(gvd, *gvd_, config.extraction.min_observation_weight);
+  collate(gvd,
+          *gvd_,
+          config.extraction.min_observation_weight,
+          config.extraction.num_threads);
   pub_.publishGvd(timestamp_ns, world_T_body.cast<double>(), *gvd_);
 }
 
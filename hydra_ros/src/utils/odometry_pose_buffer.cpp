@@ -0,0 +1,134 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/odometry_pose_buffer.h"
+
+#include <glog/logging.h>
+
+#include <chrono>
+
+namespace hydra {
+
+OdometryPoseBuffer::OdometryPoseBuffer(size_t capacity)
+    : poses_(capacity), start_(0), size_(0) {
+  CHECK_GT(capacity, 0u) << "odometry buffer requires non-zero capacity";
+}
+
+bool OdometryPoseBuffer::add(uint64_t stamp_ns,
+                             const Eigen::Vector3d& position,
+                             const Eigen::Quaterniond& rotation) {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size_ && at(size_ - 1).stamp_ns >= stamp_ns) {
+      return false;
+    }
+
+    if (size_ < poses_.size()) {
+      poses_[(start_ + size_) % poses_.size()] = {stamp_ns, position, rotation};
+      ++size_;
+    } else {
+      // overwrite the oldest sample
+      poses_[start_] = {stamp_ns, position, rotation};
+      start_ = (start_ + 1) % poses_.size();
+    }
+  }  // end critical section
+
+  cv_.notify_all();
+  return true;
+}
+
+std::optional<OdometryPoseBuffer::Pose> OdometryPoseBuffer::getPose(
+    uint64_t stamp_ns) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return interpolate(stamp_ns);
+}
+
+std::optional<OdometryPoseBuffer::Pose> OdometryPoseBuffer::waitForPose(
+    uint64_t stamp_ns, double timeout_s) const {
+  const auto timeout = std::chrono::duration<double>(timeout_s);
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait_for(
+      lock, timeout, [&] { return size_ && at(size_ - 1).stamp_ns >= stamp_ns; });
+  return interpolate(stamp_ns);
+}
+
+bool OdometryPoseBuffer::isTooOld(uint64_t stamp_ns) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_ && stamp_ns < at(0).stamp_ns;
+}
+
+size_t OdometryPoseBuffer::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+const OdometryPoseBuffer::Pose& OdometryPoseBuffer::at(size_t index) const {
+  return poses_[(start_ + index) % poses_.size()];
+}
+
+std::optional<OdometryPoseBuffer::Pose> OdometryPoseBuffer::interpolate(
+    uint64_t stamp_ns) const {
+  if (!size_ || stamp_ns < at(0).stamp_ns || stamp_ns > at(size_ - 1).stamp_ns) {
+    return std::nullopt;
+  }
+
+  // find the first sample that is at or after the stamp
+  size_t low = 0;
+  size_t high = size_ - 1;
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    if (at(mid).stamp_ns < stamp_ns) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  const auto& after = at(low);
+  if (after.stamp_ns == stamp_ns || low == 0) {
+    return after;
+  }
+
+  const auto& before = at(low - 1);
+  const double ratio = static_cast<double>(stamp_ns - before.stamp_ns) /
+                       static_cast<double>(after.stamp_ns - before.stamp_ns);
+
+  Pose pose;
+  pose.stamp_ns = stamp_ns;
+  pose.position = (1.0 - ratio) * before.position + ratio * after.position;
+  pose.rotation = before.rotation.slerp(ratio, after.rotation).normalized();
+  return pose;
+}
+
+}  // namespace hydra
@@ -0,0 +1,271 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/utils/pipeline_benchmark.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+#include <hydra/utils/timing_utilities.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace hydra {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+inline constexpr const char* kCsvHeader =
+    "stage,count,mean_s,min_s,max_s,total_s,throughput_hz";
+
+std::optional<std::string> readFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    return std::nullopt;
+  }
+
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+void addRegression(std::vector<PipelineBenchmark::Regression>& regressions,
+                   const std::string& stage,
+                   const std::string& metric,
+                   double baseline,
+                   double current) {
+  regressions.push_back({stage, metric, baseline, current});
+}
+
+}  // namespace
+
+void declare_config(PipelineBenchmark::Config& config) {
+  using namespace config;
+  name("PipelineBenchmark::Config");
+  field(config.output_path, "output_path");
+  field(config.baseline_path, "baseline_path");
+  field(config.stages, "stages");
+  field(config.tolerance, "tolerance");
+  field(config.min_delta_s, "min_delta_s", "s");
+  check(config.tolerance, GE, 0.0, "tolerance");
+  check(config.min_delta_s, GE, 0.0, "min_delta_s");
+}
+
+PipelineBenchmark::PipelineBenchmark(const Config& config)
+    : config(config::checkValid(config)), start_(std::chrono::steady_clock::now()) {}
+
+bool PipelineBenchmark::enabled() const {
+  return !config.output_path.empty() || !config.baseline_path.empty();
+}
+
+void PipelineBenchmark::start() { start_ = std::chrono::steady_clock::now(); }
+
+std::vector<PipelineBenchmark::Regression> PipelineBenchmark::finish() const {
+  if (!enabled()) {
+    return {};
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_;
+  const auto report = collect(config.stages, elapsed.count());
+  if (!config.output_path.empty()) {
+    const fs::path output_path(config.output_path);
+    fs::create_directories(output_path);
+    std::ofstream(output_path / "benchmark.csv") << toCsv(report);
+    std::ofstream(output_path / "benchmark.json") << toJson(report, elapsed.count());
+    LOG(INFO) << "Wrote benchmark results for " << elapsed.count() << " [s] run to "
+              << output_path;
+  }
+
+  if (config.baseline_path.empty()) {
+    return {};
+  }
+
+  const auto contents = readFile(config.baseline_path);
+  const auto baseline = contents ? fromCsv(*contents) : std::nullopt;
+  if (!baseline) {
+    // a run that can't be checked should not pass as one without regressions
+    LOG(ERROR) << "Unable to read benchmark baseline from " << config.baseline_path;
+    return {{"", "baseline", 0.0, 0.0}};
+  }
+
+  const auto regressions =
+      compare(*baseline, report, config.tolerance, config.min_delta_s);
+  for (const auto& regression : regressions) {
+    LOG(WARNING) << "Regression in '" << regression.stage << "' " << regression.metric
+                 << ": " << regression.baseline << " -> " << regression.current;
+  }
+
+  return regressions;
+}
+
+PipelineBenchmark::Report PipelineBenchmark::collect(
+    const std::vector<std::string>& stages, double duration_s) {
+  const auto& recorder = timing::ElapsedTimeRecorder::instance();
+  Report report;
+  for (const auto& name : stages) {
+    auto& stage = report.emplace_back();
+    stage.name = name;
+    const auto stats = recorder.getStats(name);
+    stage.count = stats.num_measurements;
+    if (!stage.count) {
+      LOG(WARNING) << "No measurements for benchmark stage '" << name << "'";
+      continue;
+    }
+
+    stage.mean_s = stats.mean_s;
+    stage.min_s = stats.min_s;
+    stage.max_s = stats.max_s;
+    stage.total_s = stats.mean_s * stage.count;
+    stage.throughput_hz = duration_s > 0.0 ? stage.count / duration_s : 0.0;
+  }
+
+  return report;
+}
+
+std::string PipelineBenchmark::toCsv(const Report& report) {
+  std::stringstream ss;
+  ss << std::setprecision(9) << kCsvHeader << "\n";
+  for (const auto& stage : report) {
+    ss << stage.name << "," << stage.count << "," << stage.mean_s << ","
+       << stage.min_s << "," << stage.max_s << "," << stage.total_s << ","
+       << stage.throughput_hz << "\n";
+  }
+
+  return ss.str();
+}
+
+std::string PipelineBenchmark::toJson(const Report& report, double duration_s) {
+  std::stringstream ss;
+  ss << std::setprecision(9) << "{\n  \"duration_s\": " << duration_s
+     << ",\n  \"stages\": [";
+  for (size_t i = 0; i < report.size(); ++i) {
+    const auto& stage = report[i];
+    ss << (i ? ",\n" : "\n") << "    {\"name\": \"" << stage.name
+       << "\", \"count\": " << stage.count << ", \"mean_s\": " << stage.mean_s
+       << ", \"min_s\": " << stage.min_s << ", \"max_s\": " << stage.max_s
+       << ", \"total_s\": " << stage.total_s
+       << ", \"throughput_hz\": " << stage.throughput_hz << "}";
+  }
+
+  ss << (report.empty() ? "]\n}\n" : "\n  ]\n}\n");
+  return ss.str();
+}
+
+std::optional<PipelineBenchmark::Report> PipelineBenchmark::fromCsv(
+    const std::string& contents) {
+  std::stringstream ss(contents);
+  std::string line;
+  if (!std::getline(ss, line) || line != kCsvHeader) {
+    return std::nullopt;
+  }
+
+  Report report;
+  while (std::getline(ss, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    std::stringstream line_ss(line);
+    auto& stage = report.emplace_back();
+    std::string count, mean_s, min_s, max_s, total_s, throughput_hz;
+    if (!std::getline(line_ss, stage.name, ',') || !std::getline(line_ss, count, ',') ||
+        !std::getline(line_ss, mean_s, ',') || !std::getline(line_ss, min_s, ',') ||
+        !std::getline(line_ss, max_s, ',') || !std::getline(line_ss, total_s, ',') ||
+        !std::getline(line_ss, throughput_hz)) {
+      return std::nullopt;
+    }
+
+    try {
+      stage.count = std::stoul(count);
+      stage.mean_s = std::stod(mean_s);
+      stage.min_s = std::stod(min_s);
+      stage.max_s = std::stod(max_s);
+      stage.total_s = std::stod(total_s);
+      stage.throughput_hz = std::stod(throughput_hz);
+    } catch (const std::exception&) {
+      return std::nullopt;
+    }
+  }
+
+  return report;
+}
+
+std::vector<PipelineBenchmark::Regression> PipelineBenchmark::compare(
+    const Report& baseline,
+    const Report& current,
+    double tolerance,
+    double min_delta_s) {
+  std::map<std::string, const Stage*> current_stages;
+  for (const auto& stage : current) {
+    current_stages[stage.name] = &stage;
+  }
+
+  std::vector<Regression> regressions;
+  for (const auto& prev : baseline) {
+    if (!prev.count) {
+      continue;  // stages that never ran in the baseline can't regress
+    }
+
+    const auto iter = current_stages.find(prev.name);
+    if (iter == current_stages.end() || !iter->second->count) {
+      addRegression(regressions, prev.name, "count", prev.count, 0.0);
+      continue;
+    }
+
+    const auto& curr = *iter->second;
+    if (curr.mean_s > prev.mean_s * (1.0 + tolerance) &&
+        curr.mean_s - prev.mean_s > min_delta_s) {
+      addRegression(regressions, prev.name, "mean_s", prev.mean_s, curr.mean_s);
+    }
+
+    if (curr.throughput_hz < prev.throughput_hz * (1.0 - tolerance)) {
+      addRegression(regressions,
+                    prev.name,
+                    "throughput_hz",
+                    prev.throughput_hz,
+                    curr.throughput_hz);
+    }
+  }
+
+  return regressions;
+}
+
+}  // namespace hydra
@@ -0,0 +1,370 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/pipeline_checkpointer.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+#include <glog/logging.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+
+#include "hydra_ros/utils/metrics.h"
+
+namespace hydra {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+inline const std::string kCheckpointPrefix = "checkpoint_";
+inline const std::string kTempPrefix = "tmp_";
+
+std::optional<uint64_t> parseCheckpointStamp(const fs::path& path) {
+  const auto name = path.filename().string();
+  if (name.rfind(kCheckpointPrefix, 0) != 0) {
+    return std::nullopt;
+  }
+
+  const auto suffix = name.substr(kCheckpointPrefix.size());
+  if (suffix.empty() || suffix.size() > 19) {
+    return std::nullopt;
+  }
+
+  for (const auto c : suffix) {
+    if (!std::isdigit(static_cast<unsigned char>(c))) {
+      return std::nullopt;
+    }
+  }
+
+  return std::stoull(suffix);
+}
+
+// complete checkpoints sorted from oldest to newest
+std::vector<std::pair<uint64_t, fs::path>> listCheckpoints(const fs::path& directory) {
+  std::vector<std::pair<uint64_t, fs::path>> checkpoints;
+  std::error_code ec;
+  if (!fs::is_directory(directory, ec)) {
+    return checkpoints;
+  }
+
+  for (const auto& entry : fs::directory_iterator(directory, ec)) {
+    if (!entry.is_directory(ec)) {
+      continue;
+    }
+
+    const auto stamp = parseCheckpointStamp(entry.path());
+    if (stamp) {
+      checkpoints.emplace_back(*stamp, entry.path());
+    }
+  }
+
+  std::sort(checkpoints.begin(), checkpoints.end());
+  return checkpoints;
+}
+
+// the staging directory may be on a different filesystem than the checkpoint
+void moveFile(const fs::path& source, const fs::path& target, std::error_code& ec) {
+  fs::rename(source, target, ec);
+  if (!ec) {
+    return;
+  }
+
+  ec.clear();
+  fs::copy_file(source, target, fs::copy_options::overwrite_existing, ec);
+  std::error_code remove_ec;
+  fs::remove(source, remove_ec);
+}
+
+class CheckpointFrontendSink : public FrontendModule::Sink {
+ public:
+  explicit CheckpointFrontendSink(const PipelineCheckpointer::Ptr& checkpointer)
+      : checkpointer_(checkpointer) {}
+
+  void call(uint64_t timestamp_ns,
+            const DynamicSceneGraph& graph,
+            const BackendInput&) const override {
+    checkpointer_->saveFrontend(timestamp_ns, graph);
+  }
+
+ private:
+  PipelineCheckpointer::Ptr checkpointer_;
+};
+
+class CheckpointBackendSink : public BackendModule::Sink {
+ public:
+  explicit CheckpointBackendSink(const PipelineCheckpointer::Ptr& checkpointer)
+      : checkpointer_(checkpointer) {}
+
+  void call(uint64_t timestamp_ns,
+            const DynamicSceneGraph& graph,
+            const kimera_pgmo::DeformationGraph& dgraph) const override {
+    checkpointer_->saveBackend(timestamp_ns, graph, dgraph);
+  }
+
+ private:
+  PipelineCheckpointer::Ptr checkpointer_;
+};
+
+}  // namespace
+
+void declare_config(PipelineCheckpointer::Config& config) {
+  using namespace config;
+  name("PipelineCheckpointer::Config");
+  field(config.directory, "directory");
+  field(config.period_s, "period_s", "s");
+  field(config.num_checkpoints, "num_checkpoints");
+  field(config.resume, "resume");
+  field(config.staging_directory, "staging_directory");
+  check(config.period_s, GE, 0.0, "period_s");
+  check(config.num_checkpoints, GT, 0, "num_checkpoints");
+}
+
+std::optional<fs::path> findLatestCheckpoint(const fs::path& directory) {
+  const auto checkpoints = listCheckpoints(directory);
+  for (auto iter = checkpoints.rbegin(); iter != checkpoints.rend(); ++iter) {
+    // backend graph is optional, but warm starting needs the other two
+    const auto& path = iter->second;
+    if (fs::exists(path / CheckpointFiles::frontend_dsg) &&
+        fs::exists(path / CheckpointFiles::deformation_graph)) {
+      return path;
+    }
+  }
+
+  return std::nullopt;
+}
+
+PipelineCheckpointer::PipelineCheckpointer(const Config& config)
+    : config(config::checkValid(config)), should_shutdown_(false) {
+  std::error_code ec;
+  fs::create_directories(config.directory, ec);
+  if (ec) {
+    LOG(ERROR) << "Failed to create checkpoint directory '" << config.directory
+               << "': " << ec.message();
+  }
+
+  // anything left over from a checkpoint that was interrupted is incomplete
+  for (const auto& entry : fs::directory_iterator(config.directory, ec)) {
+    if (entry.path().filename().string().rfind(kTempPrefix, 0) == 0) {
+      fs::remove_all(entry.path(), ec);
+    }
+  }
+
+  staging_directory_ = config.directory;
+  if (!config.staging_directory.empty() && fs::is_directory(config.staging_directory)) {
+    staging_directory_ = config.staging_directory;
+  }
+
+  thread_.reset(new std::thread(&PipelineCheckpointer::writeLoop, this));
+}
+
+PipelineCheckpointer::~PipelineCheckpointer() {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    should_shutdown_ = true;
+  }  // end critical section
+
+  cv_.notify_all();
+  thread_->join();
+  thread_.reset();
+}
+
+PipelineCheckpointer::Snapshot PipelineCheckpointer::makeSnapshot(
+    uint64_t timestamp_ns, const DynamicSceneGraph& graph) {
+  // one contiguous buffer is much cheaper to produce than a clone of every node
+  auto serialized = std::make_shared<std::vector<uint8_t>>();
+  spark_dsg::io::binary::writeGraph(graph, *serialized, true);
+  return {timestamp_ns, serialized};
+}
+
+FrontendModule::Sink::Ptr PipelineCheckpointer::frontendSink() {
+  return std::make_shared<CheckpointFrontendSink>(shared_from_this());
+}
+
+BackendModule::Sink::Ptr PipelineCheckpointer::backendSink() {
+  return std::make_shared<CheckpointBackendSink>(shared_from_this());
+}
+
+bool PipelineCheckpointer::due(uint64_t timestamp_ns,
+                               std::optional<uint64_t>& last_ns) const {
+  const auto period_ns = static_cast<uint64_t>(config.period_s * 1.0e9);
+  if (last_ns && timestamp_ns < *last_ns + period_ns) {
+    return false;
+  }
+
+  last_ns = timestamp_ns;
+  return true;
+}
+
+void PipelineCheckpointer::saveFrontend(uint64_t timestamp_ns,
+                                        const DynamicSceneGraph& graph) {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!due(timestamp_ns, last_frontend_ns_)) {
+      return;
+    }
+  }  // end critical section
+
+  ScopedLatency latency("checkpointer/frontend_copy");
+  auto snapshot = makeSnapshot(timestamp_ns, graph);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  frontend_ = std::move(snapshot);
+}
+
+void PipelineCheckpointer::saveBackend(uint64_t timestamp_ns,
+                                       const DynamicSceneGraph& graph,
+                                       const kimera_pgmo::DeformationGraph& dgraph) {
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!due(timestamp_ns, last_backend_ns_)) {
+      return;
+    }
+  }  // end critical section
+
+  ScopedLatency latency("checkpointer/backend_copy");
+  auto snapshot = makeSnapshot(timestamp_ns, graph);
+  // the deformation graph has no copy, so it is staged for the writer thread
+  const auto dgrf_name = kTempPrefix + std::to_string(getpid()) + "_" +
+                         std::to_string(timestamp_ns) + ".dgrf";
+  const auto dgrf_path = staging_directory_ / dgrf_name;
+  dgraph.save(dgrf_path.string());
+
+  fs::path stale_dgrf;
+  {  // start critical section
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!pending_dgrf_.empty()) {
+      stale_dgrf = pending_dgrf_;
+      MetricsRegistry::instance().addCount("checkpointer/dropped");
+    }
+
+    backend_ = std::move(snapshot);
+    pending_dgrf_ = dgrf_path;
+  }  // end critical section
+
+  cv_.notify_one();
+  if (!stale_dgrf.empty()) {
+    std::error_code ec;
+    fs::remove(stale_dgrf, ec);
+  }
+}
+
+void PipelineCheckpointer::writeLoop() {
+  while (true) {
+    Snapshot frontend;
+    Snapshot backend;
+    fs::path dgrf_path;
+    {  // start critical section
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return should_shutdown_ || !pending_dgrf_.empty(); });
+      if (pending_dgrf_.empty()) {
+        return;  // only reachable on shutdown
+      }
+
+      // the frontend snapshot is kept so every checkpoint has one
+      frontend = frontend_;
+      backend = std::move(backend_);
+      dgrf_path = pending_dgrf_;
+      pending_dgrf_.clear();
+    }  // end critical section
+
+    writeCheckpoint(frontend, backend, dgrf_path);
+    pruneCheckpoints();
+  }
+}
+
+void PipelineCheckpointer::writeCheckpoint(const Snapshot& frontend,
+                                           const Snapshot& backend,
+                                           const fs::path& dgrf_path) const {
+  ScopedLatency latency("checkpointer/write");
+  const auto name = std::to_string(backend.timestamp_ns);
+  const auto tmp_path = fs::path(config.directory) / (kTempPrefix + name);
+  const auto final_path = fs::path(config.directory) / (kCheckpointPrefix + name);
+
+  std::error_code ec;
+  fs::create_directories(tmp_path, ec);
+  if (ec) {
+    LOG(ERROR) << "Failed to create '" << tmp_path << "': " << ec.message();
+    fs::remove(dgrf_path, ec);
+    return;
+  }
+
+  try {
+    if (frontend.serialized) {
+      const auto graph = spark_dsg::io::binary::readGraph(*frontend.serialized);
+      graph->save((tmp_path / CheckpointFiles::frontend_dsg).string());
+    }
+
+    const auto graph = spark_dsg::io::binary::readGraph(*backend.serialized);
+    graph->save((tmp_path / CheckpointFiles::backend_dsg).string());
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to write checkpoint graphs: " << e.what();
+    fs::remove(dgrf_path, ec);
+    fs::remove_all(tmp_path, ec);
+    return;
+  }
+
+  moveFile(dgrf_path, tmp_path / CheckpointFiles::deformation_graph, ec);
+  if (!ec) {
+    // renaming is atomic, so the checkpoint either appears complete or not at all
+    fs::rename(tmp_path, final_path, ec);
+  }
+
+  if (ec) {
+    LOG(ERROR) << "Failed to write checkpoint '" << final_path << "': " << ec.message();
+    fs::remove_all(tmp_path, ec);
+    return;
+  }
+
+  MetricsRegistry::instance().addCount("checkpointer/checkpoints");
+  VLOG(1) << "Wrote checkpoint to '" << final_path.string() << "'";
+}
+
+void PipelineCheckpointer::pruneCheckpoints() const {
+  const auto checkpoints = listCheckpoints(config.directory);
+  if (checkpoints.size() <= config.num_checkpoints) {
+    return;
+  }
+
+  std::error_code ec;
+  const auto num_to_remove = checkpoints.size() - config.num_checkpoints;
+  for (size_t i = 0; i < num_to_remove; ++i) {
+    fs::remove_all(checkpoints[i].second, ec);
+  }
+}
+
+}  // namespace hydra
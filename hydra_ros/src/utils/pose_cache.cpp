@@ -40,58 +40,98 @@
 #include <geometry_msgs/Pose.h>
 #include <glog/logging.h>
 #include <rosbag/bag.h>
-#include <rosbag/view.h>
 #include <tf2/exceptions.h>
 #include <tf2_eigen/tf2_eigen.h>
-#include <tf2_msgs/TFMessage.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "hydra_ros/utils/bag_metadata.h"
 
 namespace hydra {
 
-void fillBuffer(const rosbag::Bag& bag,
+void fillBuffer(const BagMetadata& metadata,
                 bool static_only,
-                std::shared_ptr<tf2::BufferCore>& buffer) {
-  std::vector<std::string> topics{"/tf_static"};
-  if (!static_only) {
-    topics.push_back("/tf");
-  }
-
-  rosbag::View view(bag, rosbag::TopicQuery(topics));
-  const auto bag_duration = view.getEndTime() - view.getBeginTime();
+                std::shared_ptr<tf2::BufferCore>& buffer,
+                std::vector<uint64_t>& stamps) {
+  const auto bag_duration = metadata.tf_end - metadata.tf_begin;
   buffer = std::make_shared<tf2::BufferCore>(bag_duration + ros::Duration(10.0));
+  for (const auto& tf : metadata.static_transforms) {
+    buffer->setTransform(tf, "rosbag", true);
+  }
 
-  for (const auto& m : view) {
-    const auto msg = m.instantiate<tf2_msgs::TFMessage>();
-    if (!msg) {
-      LOG(ERROR) << "Found invalid message on '" << m.getTopic() << "'";
-      continue;
-    }
+  if (static_only) {
+    return;
+  }
 
-    const bool is_static = m.getTopic() == "/tf_static";
-    for (const auto& tf : msg->transforms) {
-      buffer->setTransform(tf, "rosbag", is_static);
-    }
+  stamps.reserve(metadata.transforms.size());
+  for (const auto& tf : metadata.transforms) {
+    buffer->setTransform(tf, "rosbag", false);
+    stamps.push_back(tf.header.stamp.toNSec());
   }
+
+  std::sort(stamps.begin(), stamps.end());
+  stamps.erase(std::unique(stamps.begin(), stamps.end()), stamps.end());
 }
 
+PoseCache::PoseCache() = default;
+
 PoseCache::PoseCache(const PoseCache::Config& config) {
   config::checkValid(config);
   LOG(INFO) << "Loading poses from " << config.bag_path;
-
-
-  rosbag::Bag bag;
-  bag.open(config.bag_path, rosbag::bagmode::Read);
-  fillBuffer(bag, config.static_only, buffer_);
-  bag.close();
+  const auto metadata = BagMetadata::get(config.bag_path, config.metadata_cache_dir);
+  fillBuffer(*metadata, config.static_only, buffer_, tf_stamps_);
 }
 
-PoseCache::PoseCache(const rosbag::Bag& bag, bool static_only) {
-  fillBuffer(bag, static_only, buffer_);
+PoseCache::PoseCache(const rosbag::Bag& bag, bool static_only)
+    : PoseCache(BagMetadata(bag), static_only) {}
+
+PoseCache::PoseCache(const BagMetadata& metadata, bool static_only) {
+  fillBuffer(metadata, static_only, buffer_, tf_stamps_);
 }
 
 PoseCache::PoseResult PoseCache::lookupPose(uint64_t timestamp_ns,
                                             const std::string& to_frame,
                                             const std::string& from_frame) const {
   PoseResult result;
+  const auto iter = trajectories_.find({to_frame, from_frame});
+  if (iter != trajectories_.end()) {
+    const auto& trajectory = iter->second;
+    auto upper = std::lower_bound(trajectory.begin(),
+                                  trajectory.end(),
+                                  timestamp_ns,
+                                  [](const PoseSample& sample, uint64_t stamp) {
+                                    return sample.timestamp_ns < stamp;
+                                  });
+    if (upper == trajectory.end() ||
+        (upper == trajectory.begin() && upper->timestamp_ns != timestamp_ns)) {
+      LOG(ERROR) << "Pose @ " << timestamp_ns << " [ns] between '" << from_frame
+                 << "' and '" << to_frame << "' is outside of indexed trajectory";
+      return result;
+    }
+
+    result.valid = true;
+    if (upper->timestamp_ns == timestamp_ns) {
+      result.to_p_from = upper->to_p_from;
+      result.to_R_from = upper->to_R_from;
+      return result;
+    }
+
+    const auto lower = std::prev(upper);
+    const double ratio =
+        static_cast<double>(timestamp_ns - lower->timestamp_ns) /
+        static_cast<double>(upper->timestamp_ns - lower->timestamp_ns);
+    result.to_p_from = (1.0 - ratio) * lower->to_p_from + ratio * upper->to_p_from;
+    result.to_R_from = lower->to_R_from.slerp(ratio, upper->to_R_from).normalized();
+    return result;
+  }
+
+  if (!buffer_) {
+    LOG(ERROR) << "No poses available between '" << from_frame << "' and '"
+               << to_frame << "'";
+    return result;
+  }
+
   try {
     ros::Time stamp;
     stamp.fromNSec(timestamp_ns);
@@ -115,11 +155,173 @@ PoseCache::PoseResult PoseCache::lookupPose(uint64_t timestamp_ns,
   return result;
 }
 
+bool PoseCache::indexTrajectory(const std::string& to_frame,
+                                const std::string& from_frame) {
+  if (!buffer_) {
+    LOG(ERROR) << "Cannot index trajectory without tf data";
+    return false;
+  }
+
+  Trajectory trajectory;
+  trajectory.reserve(tf_stamps_.size());
+  for (const auto stamp_ns : tf_stamps_) {
+    ros::Time stamp;
+    stamp.fromNSec(stamp_ns);
+    if (!buffer_->canTransform(to_frame, from_frame, stamp)) {
+      continue;
+    }
+
+    const auto msg = buffer_->lookupTransform(to_frame, from_frame, stamp);
+    auto& sample = trajectory.emplace_back();
+    sample.timestamp_ns = stamp_ns;
+    const auto& pos = msg.transform.translation;
+    const auto& rot = msg.transform.rotation;
+    sample.to_p_from = Eigen::Vector3d(pos.x, pos.y, pos.z);
+    sample.to_R_from = Eigen::Quaterniond(rot.w, rot.x, rot.y, rot.z).normalized();
+  }
+
+  if (trajectory.empty()) {
+    LOG(ERROR) << "Unable to find any poses between '" << from_frame << "' and '"
+               << to_frame << "'";
+    return false;
+  }
+
+  VLOG(1) << "Indexed " << trajectory.size() << " poses between '" << from_frame
+          << "' and '" << to_frame << "'";
+  trajectories_[{to_frame, from_frame}] = std::move(trajectory);
+  return true;
+}
+
+namespace {
+
+inline constexpr uint32_t kTrajectoryVersion = 1;
+
+void writeString(std::ofstream& out, const std::string& value) {
+  const uint64_t size = value.size();
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out.write(value.data(), size);
+}
+
+std::string readString(std::ifstream& in) {
+  uint64_t size = 0;
+  in.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if (!in || size > 4096) {
+    return "";
+  }
+
+  std::string value(size, '\0');
+  in.read(value.data(), size);
+  return value;
+}
+
+}  // namespace
+
+bool PoseCache::saveTrajectory(const std::filesystem::path& filepath,
+                               const std::string& to_frame,
+                               const std::string& from_frame) const {
+  const auto iter = trajectories_.find({to_frame, from_frame});
+  if (iter == trajectories_.end()) {
+    LOG(ERROR) << "No trajectory indexed between '" << from_frame << "' and '"
+               << to_frame << "'";
+    return false;
+  }
+
+  // write to a temporary file so readers never see a partial trajectory
+  auto tmp_path = filepath;
+  tmp_path += ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    if (!out) {
+      LOG(ERROR) << "Unable to open " << tmp_path << " for writing";
+      return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&kTrajectoryVersion),
+              sizeof(kTrajectoryVersion));
+    writeString(out, to_frame);
+    writeString(out, from_frame);
+    const uint64_t num_samples = iter->second.size();
+    out.write(reinterpret_cast<const char*>(&num_samples), sizeof(num_samples));
+    for (const auto& sample : iter->second) {
+      const double values[7] = {sample.to_p_from.x(),
+                                sample.to_p_from.y(),
+                                sample.to_p_from.z(),
+                                sample.to_R_from.w(),
+                                sample.to_R_from.x(),
+                                sample.to_R_from.y(),
+                                sample.to_R_from.z()};
+      out.write(reinterpret_cast<const char*>(&sample.timestamp_ns),
+                sizeof(sample.timestamp_ns));
+      out.write(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+
+    if (!out) {
+      LOG(ERROR) << "Unable to write trajectory to " << tmp_path;
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, filepath, ec);
+  if (ec) {
+    LOG(ERROR) << "Unable to move " << tmp_path << " to " << filepath << ": "
+               << ec.message();
+    return false;
+  }
+
+  return true;
+}
+
+bool PoseCache::loadTrajectory(const std::filesystem::path& filepath,
+                               const std::string& to_frame,
+                               const std::string& from_frame) {
+  std::ifstream in(filepath, std::ios::binary);
+  if (!in) {
+    return false;
+  }
+
+  uint32_t version = 0;
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  if (!in || version != kTrajectoryVersion) {
+    LOG(WARNING) << "Ignoring trajectory " << filepath << " with unknown version";
+    return false;
+  }
+
+  if (readString(in) != to_frame || readString(in) != from_frame) {
+    LOG(WARNING) << "Ignoring trajectory " << filepath << " for different frames";
+    return false;
+  }
+
+  uint64_t num_samples = 0;
+  in.read(reinterpret_cast<char*>(&num_samples), sizeof(num_samples));
+  Trajectory trajectory;
+  for (uint64_t i = 0; in && i < num_samples; ++i) {
+    PoseSample sample;
+    double values[7];
+    in.read(reinterpret_cast<char*>(&sample.timestamp_ns),
+            sizeof(sample.timestamp_ns));
+    in.read(reinterpret_cast<char*>(values), sizeof(values));
+    sample.to_p_from = Eigen::Vector3d(values[0], values[1], values[2]);
+    sample.to_R_from = Eigen::Quaterniond(values[3], values[4], values[5], values[6]);
+    trajectory.push_back(sample);
+  }
+
+  if (!in || trajectory.empty()) {
+    LOG(WARNING) << "Ignoring truncated trajectory " << filepath;
+    return false;
+  }
+
+  VLOG(1) << "Loaded " << trajectory.size() << " poses from " << filepath;
+  trajectories_[{to_frame, from_frame}] = std::move(trajectory);
+  return true;
+}
+
 void declare_config(PoseCache::Config& config) {
   using namespace config;
   name("RosCameraIntrinsics::Config");
   field<Path>(config.bag_path, "bag_path");
   field(config.static_only, "static_only");
+  field<Path>(config.metadata_cache_dir, "metadata_cache_dir");
   check<Path::Exists>(config.bag_path, "bag_path");
 }
 
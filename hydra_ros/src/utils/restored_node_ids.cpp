@@ -0,0 +1,134 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/utils/restored_node_ids.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace hydra {
+
+namespace {
+
+struct SavedEdge {
+  NodeId source;
+  NodeId target;
+  EdgeAttributes::Ptr info;
+};
+
+template <typename Edges>
+void saveEdges(const Edges& edges,
+               const std::map<NodeId, NodeId>& shifted,
+               std::vector<SavedEdge>& saved) {
+  for (const auto& id_edge_pair : edges) {
+    const auto& edge = id_edge_pair.second;
+    const auto source = shifted.find(edge.source);
+    const auto target = shifted.find(edge.target);
+    if (source == shifted.end() && target == shifted.end()) {
+      continue;
+    }
+
+    saved.push_back({source == shifted.end() ? edge.source : source->second,
+                     target == shifted.end() ? edge.target : target->second,
+                     edge.info ? edge.info->clone() : nullptr});
+  }
+}
+
+}  // namespace
+
+size_t RestoredNodeIds::findFreeBlock(const DynamicSceneGraph& graph) {
+  size_t block = 1;
+  for (const auto& id_layer_pair : graph.layers()) {
+    for (const auto& id_node_pair : id_layer_pair.second->nodes()) {
+      const auto index = NodeSymbol(id_node_pair.first).categoryId();
+      block = std::max(block, index / kBlockSize + 1);
+    }
+  }
+
+  return block;
+}
+
+NodeId RestoredNodeIds::shift(NodeId node_id, size_t block) {
+  const NodeSymbol symbol(node_id);
+  if (symbol.categoryId() >= kBlockSize) {
+    return node_id;
+  }
+
+  return NodeSymbol(symbol.category(), block * kBlockSize + symbol.categoryId());
+}
+
+DynamicSceneGraph::Ptr RestoredNodeIds::shiftGraph(const DynamicSceneGraph& graph,
+                                                   size_t block) {
+  CHECK_GT(block, 0u) << "block 0 belongs to the frontend";
+  auto result = graph.clone();
+
+  std::map<NodeId, NodeId> shifted;
+  for (const auto& id_layer_pair : graph.layers()) {
+    for (const auto& id_node_pair : id_layer_pair.second->nodes()) {
+      const auto node_id = id_node_pair.first;
+      const auto new_id = shift(node_id, block);
+      if (new_id != node_id) {
+        shifted.emplace(node_id, new_id);
+      }
+    }
+  }
+
+  // removing a node drops its edges, so every edge that touches one is saved first
+  std::vector<SavedEdge> edges;
+  for (const auto& id_layer_pair : graph.layers()) {
+    saveEdges(id_layer_pair.second->edges(), shifted, edges);
+  }
+
+  saveEdges(graph.interlayer_edges(), shifted, edges);
+  saveEdges(graph.dynamic_interlayer_edges(), shifted, edges);
+
+  for (const auto& [node_id, new_id] : shifted) {
+    const auto& node = graph.getNode(node_id);
+    result->removeNode(node_id);
+    result->emplaceNode(node.layer, new_id, node.attributes().clone());
+  }
+
+  for (auto& edge : edges) {
+    result->insertEdge(edge.source, edge.target, std::move(edge.info));
+  }
+
+  VLOG(1) << "Moved " << shifted.size() << " restored nodes into block " << block;
+  return result;
+}
+
+}  // namespace hydra
@@ -0,0 +1,313 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/utils/shared_memory_dsg.h"
+
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include "hydra_ros/utils/metrics.h"
+
+namespace hydra {
+
+namespace {
+
+constexpr uint64_t kMagic = 0x6864736773686d31;  // "hdsgshm1"
+constexpr size_t kAlignment = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory transport requires address-free atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "shared-memory transport requires address-free atomics");
+
+inline size_t alignUp(size_t value) {
+  return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+}  // namespace
+
+struct SharedDsgSlot {
+  //! odd while the writer owns the slot
+  std::atomic<uint64_t> version;
+  //! number of readers currently parsing the slot
+  std::atomic<uint32_t> readers;
+  uint64_t size;
+  uint64_t stamp_ns;
+  uint64_t sequence;
+};
+
+struct SharedDsgLayout {
+  std::atomic<uint64_t> magic;
+  uint64_t capacity;
+  //! sequence number of the most recent complete write
+  std::atomic<uint64_t> sequence;
+  //! slot holding the most recent complete write
+  std::atomic<uint32_t> latest;
+  SharedDsgSlot slots[2];
+};
+
+SharedDsgWriter::SharedDsgWriter(const std::string& name,
+                                 size_t capacity_bytes,
+                                 int permissions)
+    : name_(name),
+      capacity_(alignUp(capacity_bytes)),
+      mapped_size_(alignUp(sizeof(SharedDsgLayout)) + 2 * capacity_),
+      layout_(nullptr),
+      buffers_(nullptr),
+      sequence_(0),
+      num_dropped_(0) {
+  // remove any segment left behind by a previous writer that did not shut down cleanly
+  shm_unlink(name_.c_str());
+  const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR, permissions);
+  if (fd < 0) {
+    LOG(ERROR) << "Failed to create shared memory '" << name_
+               << "': " << std::strerror(errno);
+    return;
+  }
+
+  // shm_open applies the umask, so set the requested permissions explicitly
+  if (fchmod(fd, permissions) != 0) {
+    LOG(WARNING) << "Failed to set permissions of shared memory '" << name_
+                 << "': " << std::strerror(errno);
+  }
+
+  if (ftruncate(fd, mapped_size_) != 0) {
+    LOG(ERROR) << "Failed to size shared memory '" << name_
+               << "': " << std::strerror(errno);
+    close(fd);
+    shm_unlink(name_.c_str());
+    return;
+  }
+
+  void* ptr = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    LOG(ERROR) << "Failed to map shared memory '" << name_
+               << "': " << std::strerror(errno);
+    shm_unlink(name_.c_str());
+    return;
+  }
+
+  layout_ = new (ptr) SharedDsgLayout();
+  layout_->capacity = capacity_;
+  layout_->sequence.store(0);
+  layout_->latest.store(0);
+  for (auto& slot : layout_->slots) {
+    slot.version.store(0);
+    slot.readers.store(0);
+    slot.size = 0;
+    slot.stamp_ns = 0;
+    slot.sequence = 0;
+  }
+
+  buffers_ = static_cast<uint8_t*>(ptr) + alignUp(sizeof(SharedDsgLayout));
+  // readers only trust the layout once the magic number is visible
+  layout_->magic.store(kMagic, std::memory_order_release);
+}
+
+SharedDsgWriter::~SharedDsgWriter() {
+  if (!layout_) {
+    return;
+  }
+
+  // tells connected readers to drop their mapping
+  layout_->magic.store(0, std::memory_order_release);
+  munmap(layout_, mapped_size_);
+  shm_unlink(name_.c_str());
+}
+
+bool SharedDsgWriter::write(const uint8_t* data, size_t size, uint64_t stamp_ns) {
+  if (!layout_) {
+    return false;
+  }
+
+  if (size > capacity_) {
+    LOG(ERROR) << "Serialized graph (" << size << " bytes) exceeds shared memory slot ("
+               << capacity_ << " bytes)";
+    ++num_dropped_;
+    MetricsRegistry::instance().addCount("shm_dsg/dropped_graphs");
+    return false;
+  }
+
+  // prefer the slot readers are not looking at, otherwise overwrite the latest one
+  const uint32_t latest = layout_->latest.load();
+  if (tryWrite(1 - latest, data, size, stamp_ns) ||
+      tryWrite(latest, data, size, stamp_ns)) {
+    return true;
+  }
+
+  ++num_dropped_;
+  MetricsRegistry::instance().addCount("shm_dsg/dropped_graphs");
+  return false;
+}
+
+bool SharedDsgWriter::tryWrite(uint32_t index,
+                               const uint8_t* data,
+                               size_t size,
+                               uint64_t stamp_ns) {
+  auto& slot = layout_->slots[index];
+  // claim the slot before checking for readers (readers do the opposite)
+  slot.version.fetch_add(1);
+  if (slot.readers.load() > 0) {
+    slot.version.fetch_add(1);
+    return false;
+  }
+
+  std::memcpy(buffers_ + index * capacity_, data, size);
+  slot.size = size;
+  slot.stamp_ns = stamp_ns;
+  slot.sequence = ++sequence_;
+  slot.version.fetch_add(1, std::memory_order_release);
+
+  layout_->latest.store(index);
+  layout_->sequence.store(sequence_, std::memory_order_release);
+  return true;
+}
+
+SharedDsgReader::SharedDsgReader(const std::string& name)
+    : name_(name),
+      device_(0),
+      inode_(0),
+      mapped_size_(0),
+      layout_(nullptr),
+      buffers_(nullptr),
+      last_sequence_(0) {}
+
+SharedDsgReader::~SharedDsgReader() { disconnect(); }
+
+bool SharedDsgReader::connect() {
+  const int fd = shm_open(name_.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < alignUp(sizeof(SharedDsgLayout))) {
+    close(fd);
+    return false;
+  }
+
+  void* ptr = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    return false;
+  }
+
+  auto layout = static_cast<SharedDsgLayout*>(ptr);
+  const size_t expected_size =
+      alignUp(sizeof(SharedDsgLayout)) + 2 * layout->capacity;
+  if (layout->magic.load(std::memory_order_acquire) != kMagic ||
+      expected_size > static_cast<size_t>(info.st_size)) {
+    munmap(ptr, info.st_size);
+    return false;
+  }
+
+  device_ = info.st_dev;
+  inode_ = info.st_ino;
+  mapped_size_ = info.st_size;
+  layout_ = layout;
+  buffers_ = static_cast<const uint8_t*>(ptr) + alignUp(sizeof(SharedDsgLayout));
+  last_sequence_ = 0;
+  VLOG(1) << "Connected to shared memory scene graph '" << name_ << "'";
+  return true;
+}
+
+void SharedDsgReader::disconnect() {
+  if (!layout_) {
+    return;
+  }
+
+  munmap(layout_, mapped_size_);
+  layout_ = nullptr;
+  buffers_ = nullptr;
+  mapped_size_ = 0;
+}
+
+bool SharedDsgReader::segmentReplaced() const {
+  const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return true;
+  }
+
+  struct stat info;
+  const bool valid = fstat(fd, &info) == 0;
+  close(fd);
+  return !valid || info.st_dev != device_ || info.st_ino != inode_;
+}
+
+bool SharedDsgReader::readLatest(const Callback& func) {
+  if (!layout_ && !connect()) {
+    return false;
+  }
+
+  if (layout_->magic.load(std::memory_order_acquire) != kMagic) {
+    // writer shut down; the next call picks up a new writer if there is one
+    disconnect();
+    return false;
+  }
+
+  if (layout_->sequence.load(std::memory_order_acquire) == last_sequence_) {
+    // a writer that died without cleaning up leaves a valid-looking segment behind
+    if (segmentReplaced()) {
+      disconnect();
+    }
+
+    return false;
+  }
+
+  const uint32_t index = layout_->latest.load();
+  auto& slot = layout_->slots[index];
+  slot.readers.fetch_add(1);
+  const uint64_t version = slot.version.load();
+  if (version % 2 != 0 || slot.sequence == last_sequence_) {
+    slot.readers.fetch_sub(1);
+    return false;
+  }
+
+  func(buffers_ + index * layout_->capacity, slot.size, slot.stamp_ns);
+  last_sequence_ = slot.sequence;
+  slot.readers.fetch_sub(1);
+  return true;
+}
+
+}  // namespace hydra
@@ -0,0 +1,166 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/utils/stream_scheduler.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace hydra {
+
+void declare_config(StreamScheduler::LayerConfig& config) {
+  using namespace config;
+  name("StreamScheduler::LayerConfig");
+  field(config.priority, "priority");
+  field(config.min_period_s, "min_period_s", "s");
+  check(config.min_period_s, GE, 0.0, "min_period_s");
+}
+
+void declare_config(StreamScheduler::Config& config) {
+  using namespace config;
+  name("StreamScheduler::Config");
+  field(config.bytes_per_second, "bytes_per_second", "B/s");
+  field(config.burst_s, "burst_s", "s");
+  field(config.initial_bytes_per_node, "initial_bytes_per_node", "B");
+  field(config.default_layer, "default_layer");
+  field(config.layers, "layers");
+  check(config.bytes_per_second, GE, 0.0, "bytes_per_second");
+  check(config.burst_s, GT, 0.0, "burst_s");
+  check(config.initial_bytes_per_node, GT, 0.0, "initial_bytes_per_node");
+}
+
+StreamScheduler::StreamScheduler(const Config& config)
+    : config(config::checkValid(config)),
+      tokens_(0.0),
+      bytes_per_node_(config.initial_bytes_per_node) {
+  for (const auto& [name, layer_config] : config.layers) {
+    layer_configs_[spark_dsg::DsgLayers::StringToLayerId(name)] = layer_config;
+  }
+}
+
+const StreamScheduler::LayerConfig& StreamScheduler::layerConfig(LayerId layer) const {
+  const auto iter = layer_configs_.find(layer);
+  return iter == layer_configs_.end() ? config.default_layer : iter->second;
+}
+
+double StreamScheduler::capacity() const {
+  return config.bytes_per_second * config.burst_s;
+}
+
+void StreamScheduler::refill(uint64_t timestamp_ns) {
+  if (!last_refill_ns_) {
+    last_refill_ns_ = timestamp_ns;
+    tokens_ = capacity();
+    return;
+  }
+
+  if (timestamp_ns <= *last_refill_ns_) {
+    return;
+  }
+
+  const double elapsed_s = (timestamp_ns - *last_refill_ns_) * 1.0e-9;
+  tokens_ = std::min(capacity(), tokens_ + elapsed_s * config.bytes_per_second);
+  last_refill_ns_ = timestamp_ns;
+}
+
+double StreamScheduler::available(uint64_t timestamp_ns) {
+  if (config.bytes_per_second <= 0.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  refill(timestamp_ns);
+  return tokens_;
+}
+
+std::set<StreamScheduler::LayerId> StreamScheduler::schedule(
+    uint64_t timestamp_ns, const std::map<LayerId, size_t>& pending_nodes) {
+  std::vector<std::pair<LayerId, size_t>> candidates;
+  for (const auto& [layer, num_nodes] : pending_nodes) {
+    if (num_nodes > 0) {
+      candidates.emplace_back(layer, num_nodes);
+    }
+  }
+
+  // ties go to the higher layer, which is usually the smaller one
+  std::sort(candidates.begin(), candidates.end(), [this](const auto& a, const auto& b) {
+    const auto a_priority = layerConfig(a.first).priority;
+    const auto b_priority = layerConfig(b.first).priority;
+    return a_priority == b_priority ? a.first > b.first : a_priority > b_priority;
+  });
+
+  double remaining = available(timestamp_ns);
+  std::set<LayerId> scheduled;
+  for (const auto& [layer, num_nodes] : candidates) {
+    const auto last = last_sent_ns_.find(layer);
+    const auto min_period_ns =
+        static_cast<uint64_t>(layerConfig(layer).min_period_s * 1.0e9);
+    if (last != last_sent_ns_.end() && timestamp_ns >= last->second &&
+        timestamp_ns - last->second < min_period_ns) {
+      continue;
+    }
+
+    const double estimate = num_nodes * bytes_per_node_;
+    if (estimate > remaining && remaining < capacity()) {
+      continue;
+    }
+
+    remaining -= estimate;
+    last_sent_ns_[layer] = timestamp_ns;
+    scheduled.insert(layer);
+  }
+
+  return scheduled;
+}
+
+void StreamScheduler::consume(uint64_t timestamp_ns, size_t bytes, size_t num_nodes) {
+  if (num_nodes > 0) {
+    // smoothed so that one unusually large message does not stall every layer
+    const double sample = static_cast<double>(bytes) / num_nodes;
+    bytes_per_node_ = 0.75 * bytes_per_node_ + 0.25 * sample;
+  }
+
+  if (config.bytes_per_second <= 0.0) {
+    return;
+  }
+
+  refill(timestamp_ns);
+  tokens_ -= bytes;
+}
+
+}  // namespace hydra
@@ -68,55 +68,65 @@ void declare_config(BasisPointPlugin::Config& config) {
   field(config.label_colormap, "label_colormap");
 }
 
-struct BasisPoint {
-  double x;
-  double y;
-  double z;
-  double r = 0.0;
-  double g = 0.0;
-  double b = 0.0;
-};
-
-std::vector<BasisPoint> getBasisPoints(const PlaceNodeAttributes& attrs,
-                                       bool use_voxblox,
-                                       const spark_dsg::Mesh* vertices,
-                                       const SemanticColorMap* colormap) {
-  std::vector<BasisPoint> to_return;
+namespace {
+
+inline constexpr const char* kEdgeNs = "places_parent_edges";
+inline constexpr const char* kBasisPointNs = "places_parents";
+
+template <typename Entry>
+void addBasisPoint(
+    Entry& entry, const Eigen::Vector3d& pos, double r, double g, double b) {
+  auto& point = entry.points.emplace_back();
+  point.x = pos.x();
+  point.y = pos.y();
+  point.z = pos.z();
+  auto& color = entry.colors.emplace_back();
+  color.r = r;
+  color.g = g;
+  color.b = b;
+}
+
+template <typename Entry>
+void fillBasisPoints(const PlaceNodeAttributes& attrs,
+                     bool use_voxblox,
+                     const spark_dsg::Mesh* vertices,
+                     const SemanticColorMap* colormap,
+                     double alpha,
+                     Entry& entry) {
+  entry.points.clear();
+  entry.colors.clear();
   if (!use_voxblox && !vertices) {
-    return to_return;
+    return;
   }
 
   if (use_voxblox) {
     for (const auto& info : attrs.voxblox_mesh_connections) {
-      auto& basis_point = to_return.emplace_back();
-      Eigen::Vector3d pos = Eigen::Map<const Eigen::Vector3d>(info.voxel_pos);
-      basis_point.x = pos.x();
-      basis_point.y = pos.y();
-      basis_point.z = pos.z();
+      const Eigen::Vector3d pos = Eigen::Map<const Eigen::Vector3d>(info.voxel_pos);
       if (info.label && colormap && colormap->isValid()) {
         const auto label_color = colormap->getColorFromLabel(*info.label);
-        basis_point.r = label_color.r;
-        basis_point.g = label_color.g;
-        basis_point.b = label_color.b;
+        addBasisPoint(entry, pos, label_color.r, label_color.g, label_color.b);
+      } else {
+        addBasisPoint(entry, pos, 0.0, 0.0, 0.0);
       }
     }
   } else {
     for (const auto idx : attrs.pcl_mesh_connections) {
-      const auto pos = vertices->pos(idx);
       const auto color = vertices->colors.at(idx);
-      auto& basis_point = to_return.emplace_back();
-      basis_point.x = pos.x();
-      basis_point.y = pos.y();
-      basis_point.z = pos.z();
-      basis_point.r = color.r / 255.0;
-      basis_point.g = color.g / 255.0;
-      basis_point.b = color.b / 255.0;
+      addBasisPoint(entry,
+                    vertices->pos(idx).cast<double>(),
+                    color.r / 255.0,
+                    color.g / 255.0,
+                    color.b / 255.0);
     }
   }
 
-  return to_return;
+  for (auto& color : entry.colors) {
+    color.a = alpha;
+  }
 }
 
+}  // namespace
+
 BasisPointPlugin::BasisPointPlugin(const Config& config,
                                    const ros::NodeHandle& nh,
                                    const std::string& name)
@@ -147,6 +157,8 @@ void BasisPointPlugin::draw(const ConfigManager&,
     return;
   }
 
+  updateCache(graph);
+
   MarkerArray msg;
   drawNodes(header, graph, msg);
   drawEdges(header, graph, msg);
@@ -154,6 +166,58 @@ void BasisPointPlugin::draw(const ConfigManager&,
     drawBasisPoints(header, graph, msg);
   }
   pub_.publish(msg);
+
+  // hand the point buffers back so the next draw reuses their capacity
+  for (auto& marker : msg.markers) {
+    if (marker.ns == kEdgeNs) {
+      edge_marker_ = std::move(marker);
+    } else if (marker.ns == kBasisPointNs) {
+      basis_marker_ = std::move(marker);
+    }
+  }
+}
+
+void BasisPointPlugin::updateCache(const DynamicSceneGraph& graph) {
+  const auto mesh = graph.mesh();
+  const bool use_voxblox = config.show_voxblox_connections;
+  // mesh basis points read positions and colors from the mesh, so entries are only
+  // valid for the mesh they were computed from
+  const size_t mesh_size = mesh ? mesh->numVertices() : 0;
+  if (!use_voxblox && (mesh.get() != cached_mesh_ || mesh_size != cached_mesh_size_)) {
+    cache_.clear();
+  }
+
+  cached_mesh_ = mesh.get();
+  cached_mesh_size_ = mesh_size;
+
+  ++generation_;
+  size_t num_updated = 0;
+  const auto& layer = graph.getLayer(DsgLayers::PLACES);
+  for (const auto& [node_id, node] : layer.nodes()) {
+    const auto& attrs = node->attributes<PlaceNodeAttributes>();
+    auto& entry = cache_[node_id];
+    entry.generation = generation_;
+    if (entry.attrs && *entry.attrs == attrs) {
+      continue;
+    }
+
+    entry.attrs = attrs.clone();
+    fillBasisPoints(attrs,
+                    use_voxblox,
+                    mesh.get(),
+                    colormap_.get(),
+                    config.basis_point_alpha,
+                    entry);
+    ++num_updated;
+  }
+
+  for (auto iter = cache_.begin(); iter != cache_.end();) {
+    iter = iter->second.generation == generation_ ? std::next(iter)
+                                                  : cache_.erase(iter);
+  }
+
+  VLOG(10) << "[BasisPointPlugin] updated " << num_updated << " / " << cache_.size()
+           << " places";
 }
 
 void BasisPointPlugin::reset(const std_msgs::Header& header, const DynamicSceneGraph&) {
@@ -204,32 +268,26 @@ void BasisPointPlugin::drawNodes(const std_msgs::Header& header,
 
 void BasisPointPlugin::drawEdges(const std_msgs::Header& header,
                                  const DynamicSceneGraph& graph,
-                                 MarkerArray& msg) const {
-  auto& marker = msg.markers.emplace_back();
+                                 MarkerArray& msg) {
+  auto& marker = msg.markers.emplace_back(std::move(edge_marker_));
+  marker.points.clear();
   marker.header = header;
   marker.type = Marker::LINE_LIST;
   marker.action = Marker::ADD;
   marker.id = 0;
-  marker.ns = "places_parent_edges";
+  marker.ns = kEdgeNs;
   marker.pose.orientation.w = 1.0;
   marker.scale.x = config.places_edge_scale;
   marker.color.a = config.places_edge_alpha;
 
   const auto& layer = graph.getLayer(DsgLayers::PLACES);
   for (const auto& id_node_pair : layer.nodes()) {
-    auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
-
+    const auto& entry = cache_.at(id_node_pair.first);
     geometry_msgs::Point start;
-    tf2::convert(attrs.position, start);
-
-    const auto basis_points = getBasisPoints(
-        attrs, config.show_voxblox_connections, graph.mesh().get(), colormap_.get());
-    for (const auto& basis_point : basis_points) {
+    tf2::convert(entry.attrs->position, start);
+    for (const auto& point : entry.points) {
       marker.points.push_back(start);
-      auto& point = marker.points.emplace_back();
-      point.x = basis_point.x;
-      point.y = basis_point.y;
-      point.z = basis_point.z;
+      marker.points.push_back(point);
     }
   }
 
@@ -238,18 +296,19 @@ void BasisPointPlugin::drawEdges(const std_msgs::Header& header,
 
 void BasisPointPlugin::drawBasisPoints(const std_msgs::Header& header,
                                        const DynamicSceneGraph& graph,
-                                       MarkerArray& msg) const {
-  const auto mesh = graph.mesh();
-  if (!config.show_voxblox_connections && !mesh) {
+                                       MarkerArray& msg) {
+  if (!config.show_voxblox_connections && !graph.mesh()) {
     return;
   }
 
-  auto& marker = msg.markers.emplace_back();
+  auto& marker = msg.markers.emplace_back(std::move(basis_marker_));
+  marker.points.clear();
+  marker.colors.clear();
   marker.header = header;
   marker.type = Marker::CUBE_LIST;
   marker.action = Marker::ADD;
   marker.id = 0;
-  marker.ns = "places_parents";
+  marker.ns = kBasisPointNs;
   marker.pose.orientation.w = 1.0;
   marker.scale.x = config.basis_point_scale;
   marker.scale.y = config.basis_point_scale;
@@ -257,20 +316,9 @@ void BasisPointPlugin::drawBasisPoints(const std_msgs::Header& header,
 
   const auto& layer = graph.getLayer(DsgLayers::PLACES);
   for (const auto& id_node_pair : layer.nodes()) {
-    auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
-    const auto basis_points = getBasisPoints(
-        attrs, config.show_voxblox_connections, mesh.get(), colormap_.get());
-    for (const auto& basis_point : basis_points) {
-      auto& point = marker.points.emplace_back();
-      point.x = basis_point.x;
-      point.y = basis_point.y;
-      point.z = basis_point.z;
-      auto& color = marker.colors.emplace_back();
-      color.r = basis_point.r;
-      color.g = basis_point.g;
-      color.b = basis_point.b;
-      color.a = config.basis_point_alpha;
-    }
+    const auto& entry = cache_.at(id_node_pair.first);
+    marker.points.insert(marker.points.end(), entry.points.begin(), entry.points.end());
+    marker.colors.insert(marker.colors.end(), entry.colors.begin(), entry.colors.end());
   }
 
   published_.insert(marker.ns);
@@ -0,0 +1,104 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/visualizer/chunked_marker_cache.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+namespace hydra {
+
+using spatial_hash::BlockIndex;
+
+void declare_config(ChunkedMarkerCache::Config& config) {
+  using namespace config;
+  name("ChunkedMarkerCache::Config");
+  field(config.enable, "enable");
+  field(config.blocks_per_chunk, "blocks_per_chunk");
+  field(config.crop_radius, "crop_radius", "m");
+
+  check(config.blocks_per_chunk, GT, 0, "blocks_per_chunk");
+}
+
+ChunkedMarkerCache::ChunkedMarkerCache(const Config& config)
+    : config(config::checkValid(config)) {}
+
+size_t ChunkedMarkerCache::IndexHash::operator()(const BlockIndex& index) const {
+  return hashIndex(index);
+}
+
+uint64_t ChunkedMarkerCache::hashIndex(const BlockIndex& index) {
+  // same primes as the spatial hash used by the block layers
+  return static_cast<uint64_t>(index.x()) * 73856093 ^
+         static_cast<uint64_t>(index.y()) * 19349663 ^
+         static_cast<uint64_t>(index.z()) * 83492791;
+}
+
+BlockIndex ChunkedMarkerCache::getChunkIndex(const BlockIndex& index) const {
+  const auto size = config.blocks_per_chunk;
+  BlockIndex chunk;
+  for (int i = 0; i < 3; ++i) {
+    // floor division so that negative indices map to the correct chunk
+    chunk(i) = index(i) >= 0 ? index(i) / size : (index(i) - size + 1) / size;
+  }
+
+  return chunk;
+}
+
+int ChunkedMarkerCache::getChunkId(const BlockIndex& chunk) {
+  auto iter = chunk_ids_.find(chunk);
+  if (iter == chunk_ids_.end()) {
+    iter = chunk_ids_.emplace(chunk, next_id_++).first;
+  }
+
+  return iter->second;
+}
+
+void ChunkedMarkerCache::setNumSubscribers(size_t num_subscribers) {
+  // new subscribers only receive the latched message and need every chunk, and
+  // updates are skipped while nobody is subscribed
+  if (num_subscribers > num_subscribers_) {
+    refresh_ = true;
+  }
+
+  num_subscribers_ = num_subscribers;
+}
+
+void ChunkedMarkerCache::clear() {
+  published_.clear();
+  num_updated_ = 0;
+  refresh_ = false;
+}
+
+}  // namespace hydra
@@ -35,6 +35,8 @@
 #include "hydra_ros/visualizer/colormap_utilities.h"
 
 #include <algorithm>
+#include <cmath>
+#include <list>
 #include <opencv2/imgproc.hpp>
 
 namespace hydra::dsg_utils {
@@ -52,7 +54,14 @@ std_msgs::ColorRGBA makeColorMsg(const Color& color, double alpha) {
   return msg;
 }
 
-Color interpolateColorMap(const ColormapConfig& config, double ratio) {
+ColormapLut::ColormapLut(const ColormapConfig& config) : config_(config) {
+  colors_.reserve(kNumEntries);
+  for (size_t i = 0; i < kNumEntries; ++i) {
+    colors_.push_back(compute(config, static_cast<double>(i) / (kNumEntries - 1)));
+  }
+}
+
+Color ColormapLut::compute(const ColormapConfig& config, double ratio) {
   ratio = std::clamp(ratio, 0.0, 1.0);
   const float hue = lerp(config.min_hue, config.max_hue, ratio);
   const float luminance = lerp(config.min_luminance, config.max_luminance, ratio);
@@ -60,4 +69,43 @@ Color interpolateColorMap(const ColormapConfig& config, double ratio) {
   return Color::fromHLS(hue, luminance, saturation);
 }
 
+bool ColormapLut::matches(const ColormapConfig& config) const {
+  return config_.min_hue == config.min_hue && config_.max_hue == config.max_hue &&
+         config_.min_saturation == config.min_saturation &&
+         config_.max_saturation == config.max_saturation &&
+         config_.min_luminance == config.min_luminance &&
+         config_.max_luminance == config.max_luminance;
+}
+
+const Color& ColormapLut::lookup(double ratio) const {
+  // clamping passes NaN through, which maps to the first entry
+  const double scaled = std::clamp(ratio, 0.0, 1.0) * (kNumEntries - 1);
+  const size_t index = std::isnan(scaled) ? 0 : static_cast<size_t>(scaled + 0.5);
+  return colors_[index];
+}
+
+const ColormapLut& getColormapLut(const ColormapConfig& config) {
+  // a handful of colormaps are in use at any time; each thread keeps its own tables
+  // so lookups never lock and the most recently used table is checked first
+  constexpr size_t max_tables = 8;
+  thread_local std::list<ColormapLut> tables;
+  for (auto iter = tables.begin(); iter != tables.end(); ++iter) {
+    if (iter->matches(config)) {
+      tables.splice(tables.begin(), tables, iter);
+      return tables.front();
+    }
+  }
+
+  tables.emplace_front(config);
+  if (tables.size() > max_tables) {
+    tables.pop_back();
+  }
+
+  return tables.front();
+}
+
+Color interpolateColorMap(const ColormapConfig& config, double ratio) {
+  return getColormapLut(config).lookup(ratio);
+}
+
 }  // namespace hydra::dsg_utils
@@ -89,6 +89,25 @@ bool ConfigManager::hasChange() const {
   return has_changed;
 }
 
+bool ConfigManager::visualizerConfigChanged() const {
+  return visualizer_config_ && visualizer_config_->hasChange();
+}
+
+bool ConfigManager::layerConfigChanged(LayerId layer) const {
+  auto iter = layer_configs_.find(layer);
+  return iter != layer_configs_.end() && iter->second->hasChange();
+}
+
+bool ConfigManager::dynamicLayerConfigChanged(LayerId layer) const {
+  auto iter = dynamic_layer_configs_.find(layer);
+  return iter != dynamic_layer_configs_.end() && iter->second->hasChange();
+}
+
+bool ConfigManager::colormapChanged(const std::string& name) const {
+  auto iter = colormaps_.find(name);
+  return iter != colormaps_.end() && iter->second->hasChange();
+}
+
 void ConfigManager::clearChangeFlags() {
   visualizer_config_->clearChangeFlag();
   for (auto& id_config_pair : layer_configs_) {
@@ -105,6 +124,7 @@ void ConfigManager::clearChangeFlags() {
 }
 
 const VisualizerConfig& ConfigManager::getVisualizerConfig() const {
+  std::lock_guard<std::mutex> lock(mutex_);
   if (!visualizer_config_) {
     visualizer_config_ =
         std::make_shared<ConfigWrapper<VisualizerConfig>>(nh_, "config");
@@ -114,6 +134,7 @@ const VisualizerConfig& ConfigManager::getVisualizerConfig() const {
 }
 
 const LayerConfig* ConfigManager::getLayerConfig(LayerId layer) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto iter = layer_configs_.find(layer);
   if (iter == layer_configs_.end()) {
     const auto ns = "config/layer" + std::to_string(layer);
@@ -126,6 +147,7 @@ const LayerConfig* ConfigManager::getLayerConfig(LayerId layer) const {
 }
 
 const DynamicLayerConfig& ConfigManager::getDynamicLayerConfig(LayerId layer) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto iter = dynamic_layer_configs_.find(layer);
   if (iter == dynamic_layer_configs_.end()) {
     const std::string ns = "config/dynamic_layer/" + std::to_string(layer);
@@ -139,6 +161,7 @@ const DynamicLayerConfig& ConfigManager::getDynamicLayerConfig(LayerId layer) co
 }
 
 const ColormapConfig& ConfigManager::getColormapConfig(const std::string& name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto iter = colormaps_.find(name);
   if (iter == colormaps_.end()) {
     const std::string ns = "config/" + name;
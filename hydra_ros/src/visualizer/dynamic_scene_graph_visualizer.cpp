@@ -34,10 +34,14 @@
  * -------------------------------------------------------------------------- */
 #include "hydra_ros/visualizer/dynamic_scene_graph_visualizer.h"
 
+#include <config_utilities/parsing/ros.h>
 #include <glog/logging.h>
 #include <spark_dsg/node_attributes.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <algorithm>
+
+#include "hydra_ros/utils/parallel_for.h"
 #include "hydra_ros/visualizer/colormap_utilities.h"
 #include "hydra_ros/visualizer/visualizer_utilities.h"
 
@@ -74,16 +78,128 @@ void clearPrevMarkers(const std_msgs::Header& header,
   prev_nodes = curr_nodes;
 }
 
+//! Text of the full (non-collapsed) label for a node
+std::string getLabelText(const Node& node) {
+  std::string name;
+  try {
+    name = node.attributes<SemanticNodeAttributes>().name;
+  } catch (const std::exception&) {
+  }
+
+  return name.empty() ? NodeSymbol(node.id).getLabel() : name;
+}
+
+template <typename K>
+inline const Node* getSnapshotNode(const std::pair<const K, Node::Ptr>& id_node_pair) {
+  return id_node_pair.second.get();
+}
+
+inline const Node* getSnapshotNode(const Node::Ptr& node) { return node.get(); }
+
+//! Check for added or removed nodes and nodes marked as changed since the snapshot
+template <typename Nodes>
+bool updateNodeSnapshot(const Nodes& nodes,
+                        const std::unordered_map<NodeId, uint64_t>& node_revisions,
+                        LayerSnapshot& snapshot) {
+  bool changed = false;
+  std::set<NodeId> curr;
+  for (const auto& entry : nodes) {
+    const Node* node = getSnapshotNode(entry);
+    if (!node) {
+      continue;
+    }
+
+    curr.insert(node->id);
+    if (!changed) {
+      const auto iter = node_revisions.find(node->id);
+      changed = iter != node_revisions.end() && iter->second > snapshot.revision;
+    }
+  }
+
+  changed |= curr != snapshot.nodes;
+  snapshot.nodes = std::move(curr);
+  return changed;
+}
+
+template <typename Edges>
+bool updateEdgeSnapshot(const Edges& edges,
+                        std::map<std::pair<NodeId, NodeId>, double>& snapshot) {
+  std::map<std::pair<NodeId, NodeId>, double> curr;
+  for (const auto& id_edge_pair : edges) {
+    const auto& edge = id_edge_pair.second;
+    curr.emplace(std::make_pair(edge.source, edge.target), edge.attributes().weight);
+  }
+
+  if (curr == snapshot) {
+    return false;
+  }
+
+  snapshot = std::move(curr);
+  return true;
+}
+
 DynamicSceneGraphVisualizer::DynamicSceneGraphVisualizer(const ros::NodeHandle& nh)
-    : nh_(nh), need_redraw_(false), periodic_redraw_(false), visualizer_frame_("map") {
+    : nh_(nh),
+      need_redraw_(false),
+      need_full_redraw_(true),
+      full_redraw_(false),
+      graph_updated_(false),
+      graph_revision_(0),
+      unknown_change_revision_(0),
+      periodic_redraw_(false),
+      incremental_redraw_(true),
+      num_redraw_threads_(1),
+      per_layer_topics_(false),
+      visualizer_frame_("map"),
+      viewer_moved_(false),
+      frustum_moved_(false) {
   nh_.param("visualizer_frame", visualizer_frame_, visualizer_frame_);
+  nh_.param("incremental_redraw", incremental_redraw_, incremental_redraw_);
+  nh_.param("per_layer_topics", per_layer_topics_, per_layer_topics_);
+  int num_edge_threads = 2;
+  nh_.param("num_edge_threads", num_edge_threads, num_edge_threads);
+  edge_builder_.reset(new EdgeMarkerBuilder(std::max(num_edge_threads, 1)));
+  int num_redraw_threads = 1;
+  nh_.param("num_redraw_threads", num_redraw_threads, num_redraw_threads);
+  num_redraw_threads_ = std::max(num_redraw_threads, 1);
+
+  const ros::NodeHandle lod_nh(nh_, "label_lod");
+  label_lod_.reset(new LabelLod(config::fromRos<LabelLod::Config>(lod_nh)));
+  const ros::NodeHandle frustum_nh(nh_, "view_frustum");
+  frustum_.reset(new ViewFrustum(config::fromRos<ViewFrustum::Config>(frustum_nh)));
+  const bool use_lod_frame =
+      label_lod_->config.enable && !label_lod_->config.view_frame.empty();
+  const bool use_frustum_frame =
+      frustum_->config.enable && !frustum_->config.view_frame.empty();
+  if (use_lod_frame || use_frustum_frame) {
+    tf_buffer_.reset(new tf2_ros::Buffer());
+    tf_listener_.reset(new tf2_ros::TransformListener(*tf_buffer_));
+  }
 
   std::string config_ns = "~";
   nh_.param("config_ns", config_ns, config_ns);
   config_manager_ = std::make_shared<ConfigManager>(ros::NodeHandle(config_ns));
 
-  dsg_pub_ = nh_.advertise<MarkerArray>("dsg_markers", 1, true);
-  dynamic_layers_viz_pub_ = nh_.advertise<MarkerArray>("dynamic_layers_viz", 1, true);
+  // unchanged layers are not republished, so late subscribers need a full redraw
+  const auto connect_cb =
+      boost::bind(&DynamicSceneGraphVisualizer::onSubscriberConnect, this, _1);
+  dsg_pub_ = nh_.advertise<MarkerArray>("dsg_markers",
+                                        1,
+                                        connect_cb,
+                                        ros::SubscriberStatusCallback(),
+                                        ros::VoidConstPtr(),
+                                        true);
+  dynamic_layers_viz_pub_ = nh_.advertise<MarkerArray>("dynamic_layers_viz",
+                                                       1,
+                                                       connect_cb,
+                                                       ros::SubscriberStatusCallback(),
+                                                       ros::VoidConstPtr(),
+                                                       true);
+}
+
+void DynamicSceneGraphVisualizer::onSubscriberConnect(
+    const ros::SingleSubscriberPublisher&) {
+  setNeedFullRedraw();
 }
 
 void DynamicSceneGraphVisualizer::start(bool periodic_redraw) {
@@ -104,12 +220,10 @@ void DynamicSceneGraphVisualizer::reset() {
 
     MarkerArray msg;
     resetImpl(header, msg);
-
-    if (!msg.markers.empty()) {
-      dsg_pub_.publish(msg);
-    }
+    publishMarkers(msg);
   }
 
+  mesh_edge_cache_.clear();
   scene_graph_.reset();
 }
 
@@ -118,27 +232,44 @@ bool DynamicSceneGraphVisualizer::redraw() {
     return false;
   }
 
-  need_redraw_ |= config_manager_->hasChange();
+  // requests can arrive from the connect callbacks while redrawing, so they are
+  // taken up front instead of being cleared once the redraw is done
+  bool need_redraw = need_redraw_.exchange(false);
+  // only layers with a changed config are redrawn unless every layer is affected
+  full_redraw_ = need_full_redraw_.exchange(false);
+  full_redraw_ |= config_manager_->visualizerConfigChanged();
+  need_redraw |= config_manager_->hasChange();
+  need_redraw |= full_redraw_;
+  if (label_lod_->config.enable) {
+    viewer_position_ = getViewerPosition();
+    viewer_moved_ = label_lod_->viewerMoved(viewer_position_);
+    need_redraw |= viewer_moved_;
+  }
+
+  frustum_moved_ = false;
+  if (frustum_->config.enable) {
+    const auto view_pose = lookupViewPose(frustum_->config.view_frame);
+    frustum_moved_ = view_pose && frustum_->setViewPose(*view_pose);
+    need_redraw |= frustum_moved_;
+  }
+
   for (const auto& plugin : plugins_) {
-    need_redraw_ |= plugin->hasChange();
+    need_redraw |= plugin->hasChange();
   }
 
-  if (!need_redraw_) {
+  if (!need_redraw) {
     return false;
   }
 
-  need_redraw_ = false;
-
   std_msgs::Header header;
   header.stamp = ros::Time::now();
   header.frame_id = visualizer_frame_;
 
   MarkerArray msg;
   redrawImpl(header, msg);
-
-  if (!msg.markers.empty()) {
-    dsg_pub_.publish(msg);
-  }
+  full_redraw_ = false;
+  graph_updated_ = false;
+  publishMarkers(msg);
 
   config_manager_->clearChangeFlags();
   for (auto& plugin : plugins_) {
@@ -148,6 +279,81 @@ bool DynamicSceneGraphVisualizer::redraw() {
   return true;
 }
 
+void DynamicSceneGraphVisualizer::publishMarkers(const MarkerArray& msg) {
+  if (!per_layer_topics_) {
+    if (!msg.markers.empty()) {
+      dsg_pub_.publish(msg);
+    }
+    return;
+  }
+
+  std::map<std::string, MarkerArray> topic_msgs;
+  for (const auto& marker : msg.markers) {
+    topic_msgs[getMarkerTopic(marker.ns)].markers.push_back(marker);
+  }
+
+  for (const auto& [topic, topic_msg] : topic_msgs) {
+    if (topic.empty()) {
+      dsg_pub_.publish(topic_msg);
+    } else {
+      getTopicPublisher(topic).publish(topic_msg);
+    }
+  }
+}
+
+std::string DynamicSceneGraphVisualizer::getMarkerTopic(const std::string& ns) const {
+  const auto has_prefix = [&ns](const std::string& prefix) {
+    return ns.compare(0, prefix.size(), prefix) == 0;
+  };
+
+  if (has_prefix(interlayer_edge_ns_prefix_) ||
+      has_prefix(dynamic_interlayer_edge_ns_prefix_)) {
+    return "interlayer_edges";
+  }
+
+  if (ns == mesh_edge_ns_) {
+    return "mesh_edges";
+  }
+
+  // every per-layer namespace ends with the layer id
+  for (const auto& prefix : {node_ns_prefix_,
+                             edge_ns_prefix_,
+                             label_ns_prefix_,
+                             bbox_ns_prefix_,
+                             boundary_ns_prefix_,
+                             boundary_ellipse_ns_prefix_,
+                             frontier_ns_prefix_}) {
+    if (has_prefix(prefix)) {
+      return ns.substr(ns.find_last_of('_') + 1);
+    }
+  }
+
+  return "";
+}
+
+const ros::Publisher& DynamicSceneGraphVisualizer::getTopicPublisher(
+    const std::string& topic) {
+  auto iter = topic_pubs_.find(topic);
+  if (iter != topic_pubs_.end()) {
+    return iter->second;
+  }
+
+  const auto connect_cb =
+      boost::bind(&DynamicSceneGraphVisualizer::onSubscriberConnect, this, _1);
+  auto pub = nh_.advertise<MarkerArray>("dsg_markers/" + topic,
+                                        1,
+                                        connect_cb,
+                                        ros::SubscriberStatusCallback(),
+                                        ros::VoidConstPtr(),
+                                        true);
+  return topic_pubs_.emplace(topic, pub).first->second;
+}
+
+bool DynamicSceneGraphVisualizer::hasSubscribers(const std::string& topic) {
+  // topics are advertised on first use, so new subscribers trigger a full redraw
+  return !per_layer_topics_ || getTopicPublisher(topic).getNumSubscribers() > 0;
+}
+
 void DynamicSceneGraphVisualizer::setGraph(const DynamicSceneGraph::Ptr& scene_graph,
                                            bool need_reset) {
   if (scene_graph == nullptr) {
@@ -170,11 +376,67 @@ void DynamicSceneGraphVisualizer::setGraph(const DynamicSceneGraph::Ptr& scene_g
 
   scene_graph_ = scene_graph;
   need_redraw_ = true;
+  graph_updated_ = true;
+  unknown_change_revision_ = ++graph_revision_;
+}
+
+void DynamicSceneGraphVisualizer::setNodesUpdated(const std::vector<NodeId>& nodes) {
+  need_redraw_ = true;
+  graph_updated_ = true;
+  ++graph_revision_;
+  for (const auto node_id : nodes) {
+    node_revisions_[node_id] = graph_revision_;
+  }
 }
 
 void DynamicSceneGraphVisualizer::setLayerColorFunction(LayerId layer,
                                                         const ColorFunction& func) {
   layer_colors_[layer] = func;
+  setNeedFullRedraw();
+}
+
+bool DynamicSceneGraphVisualizer::layerChanged(const SceneGraphLayer& layer) {
+  auto& snapshot = layer_snapshots_[layer.id];
+  return snapshotChanged(layer.nodes(), layer.edges(), snapshot) ||
+         !incremental_redraw_;
+}
+
+template <typename Nodes, typename Edges>
+bool DynamicSceneGraphVisualizer::snapshotChanged(const Nodes& nodes,
+                                                  const Edges& edges,
+                                                  LayerSnapshot& snapshot) const {
+  // nothing in the graph changed since the layer was last checked
+  if (snapshot.revision == graph_revision_) {
+    return false;
+  }
+
+  // attributes are never compared: nodes only count as changed when marked, and
+  // updates that do not say which nodes changed affect every node
+  bool changed = unknown_change_revision_ > snapshot.revision;
+  changed |= updateNodeSnapshot(nodes, node_revisions_, snapshot);
+  changed |= updateEdgeSnapshot(edges, snapshot.edges);
+  snapshot.revision = graph_revision_;
+  return changed;
+}
+
+bool DynamicSceneGraphVisualizer::layerConfigChanged(LayerId layer_id,
+                                                     const LayerConfig& config) const {
+  if (config_manager_->layerConfigChanged(layer_id)) {
+    return true;
+  }
+
+  // colormaps are shared between layers, so only redraw the layers that use them
+  const bool uses_colormap =
+      config.color_edges_by_weight ||
+      static_cast<NodeColorMode>(config.marker_color_mode) == NodeColorMode::DISTANCE;
+  return uses_colormap && config_manager_->colormapChanged("places_colormap");
+}
+
+bool DynamicSceneGraphVisualizer::dynamicLayerChanged(
+    LayerId layer_id, const DynamicSceneGraphLayer& layer) {
+  auto& snapshot = dynamic_snapshots_[{layer_id, layer.prefix}];
+  return snapshotChanged(layer.nodes(), layer.edges(), snapshot) ||
+         !incremental_redraw_;
 }
 
 inline double getDynamicHue(const DynamicLayerConfig& config, char prefix) {
@@ -267,10 +529,14 @@ void DynamicSceneGraphVisualizer::drawDynamicLayers(const std_msgs::Header& head
     for (auto&& [prefix, layer] : sublayers) {
       if (!config.visualize) {
         deleteDynamicLayer(header, prefix, msg);
+        dynamic_snapshots_.erase({layer_id, prefix});
         continue;
       }
 
-      drawDynamicLayer(header, *layer, config, viz_config, viz_layer_idx, msg);
+      if (dynamicLayerChanged(layer_id, *layer) || full_redraw_ ||
+          config_manager_->dynamicLayerConfigChanged(layer_id)) {
+        drawDynamicLayer(header, *layer, config, viz_config, viz_layer_idx, msg);
+      }
       viz_layer_idx++;
     }
   }
@@ -295,6 +561,7 @@ void DynamicSceneGraphVisualizer::resetImpl(const std_msgs::Header& header,
   for (auto& label_set : curr_labels_) {
     label_set.second.clear();
   }
+  label_lod_->reset();
 
   // vanilla scene graph also makes delete markers for dynamic layers, so we duplicate
   // them here (rviz checks for topic / namespace coherence)
@@ -311,6 +578,15 @@ void DynamicSceneGraphVisualizer::resetImpl(const std_msgs::Header& header,
 
   published_dynamic_labels_.clear();
 
+  layer_snapshots_.clear();
+  dynamic_snapshots_.clear();
+  node_revisions_.clear();
+  interlayer_snapshot_.clear();
+  dynamic_interlayer_snapshot_.clear();
+  frustum_->clear();
+  visible_nodes_.clear();
+  need_full_redraw_ = true;
+
   for (const auto& plugin : plugins_) {
     plugin->reset(header, *scene_graph_);
   }
@@ -324,6 +600,10 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
   }
 
   const auto& visualizer_config = config_manager_->getVisualizerConfig();
+
+  // layers that pull colors from other layers have to be redrawn with any change
+  std::set<LayerId> changed_layers;
+  std::set<LayerId> dependent_layers;
   for (auto&& [layer_id, layer] : scene_graph_->layers()) {
     const auto layer_config = config_manager_->getLayerConfig(layer_id);
     if (!layer_config) {
@@ -332,13 +612,61 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
 
     if (!layer_config->visualize) {
       deleteLayer(header, *layer, msg);
-    } else {
-      drawLayer(header, *layer, *layer_config, msg);
+      layer_snapshots_.erase(layer_id);
+      visible_nodes_.erase(layer_id);
+      continue;
+    }
+
+    // a different view volume changes what is drawn for every layer
+    if (layerChanged(*layer) || full_redraw_ || frustum_moved_ ||
+        layerConfigChanged(layer_id, *layer_config)) {
+      changed_layers.insert(layer_id);
+    } else if (layer_colors_.count(layer_id) ||
+               static_cast<NodeColorMode>(layer_config->marker_color_mode) ==
+                   NodeColorMode::PARENT) {
+      dependent_layers.insert(layer_id);
+    }
+  }
+
+  if (!changed_layers.empty()) {
+    changed_layers.insert(dependent_layers.begin(), dependent_layers.end());
+  }
+
+  if (full_redraw_) {
+    label_lod_->reset();
+  }
+
+  std::vector<LayerId> layers_to_draw;
+  for (const auto layer_id : changed_layers) {
+    if (hasSubscribers(std::to_string(layer_id))) {
+      layers_to_draw.push_back(layer_id);
     }
   }
 
-  if (visualizer_config.draw_mesh_edges) {
-    drawLayerMeshEdges(header, mesh_edge_source_layer_, mesh_edge_ns_, msg);
+  const bool draw_mesh_edges =
+      visualizer_config.draw_mesh_edges && hasSubscribers("mesh_edges");
+  if (num_redraw_threads_ > 1) {
+    drawLayersParallel(header, layers_to_draw, draw_mesh_edges, msg);
+  } else {
+    for (const auto layer_id : layers_to_draw) {
+      const auto& layer = scene_graph_->getLayer(layer_id);
+      drawLayer(header, layer, *config_manager_->getLayerConfig(layer_id), msg);
+    }
+
+    if (draw_mesh_edges) {
+      drawLayerMeshEdges(header, mesh_edge_source_layer_, mesh_edge_ns_, msg);
+    }
+  }
+
+  if (viewer_moved_) {
+    // labels of layers that did not change still depend on the viewer position
+    for (auto&& [layer_id, layer] : scene_graph_->layers()) {
+      const auto layer_config = config_manager_->getLayerConfig(layer_id);
+      if (!changed_layers.count(layer_id) && layer_config && layer_config->visualize &&
+          hasSubscribers(std::to_string(layer_id))) {
+        drawLayerLabels(header, *layer, *layer_config, visualizer_config, msg);
+      }
+    }
   }
 
   std::map<LayerId, LayerConfig> all_configs;
@@ -346,12 +674,102 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
     all_configs[layer_id] = *CHECK_NOTNULL(config_manager_->getLayerConfig(layer_id));
   }
 
-  MarkerArray interlayer_edge_markers =
-      makeGraphEdgeMarkers(header,
-                           *scene_graph_,
-                           all_configs,
-                           visualizer_config,
-                           interlayer_edge_ns_prefix_);
+  const bool interlayer_changed =
+      updateEdgeSnapshot(scene_graph_->interlayer_edges(), interlayer_snapshot_);
+  const bool draw_interlayer = hasSubscribers("interlayer_edges");
+  if (draw_interlayer && (interlayer_changed || !changed_layers.empty() ||
+                          full_redraw_ || !incremental_redraw_)) {
+    drawInterlayerEdges(header, all_configs, msg);
+  }
+
+  MarkerArray dynamic_markers;
+  drawDynamicLayers(header, dynamic_markers);
+  const bool dynamic_changed = !dynamic_markers.markers.empty();
+
+  const bool dynamic_interlayer_changed = updateEdgeSnapshot(
+      scene_graph_->dynamic_interlayer_edges(), dynamic_interlayer_snapshot_);
+  if (draw_interlayer &&
+      (dynamic_interlayer_changed || dynamic_changed || !changed_layers.empty() ||
+       full_redraw_ || !incremental_redraw_)) {
+    drawDynamicInterlayerEdges(header, all_configs, msg);
+  }
+
+  if (!dynamic_markers.markers.empty()) {
+    dynamic_layers_viz_pub_.publish(dynamic_markers);
+  }
+
+  // plugins that only depend on the graph skip redraws caused by config changes
+  // (plugins are drawn serially, as their draw calls are not required to be
+  // thread-safe with respect to each other)
+  const bool config_changed = config_manager_->hasChange();
+  for (const auto& plugin : plugins_) {
+    if (graph_updated_ || full_redraw_ || plugin->hasChange() ||
+        (config_changed && plugin->usesConfigs())) {
+      plugin->setGraphRevision(graph_revision_);
+      plugin->draw(*config_manager_, header, *scene_graph_);
+    }
+  }
+}
+
+void DynamicSceneGraphVisualizer::drawLayersParallel(
+    const std_msgs::Header& header,
+    const std::vector<LayerId>& layer_ids,
+    bool draw_mesh_edges,
+    MarkerArray& msg) {
+  const auto& viz_config = config_manager_->getVisualizerConfig();
+
+  // culling updates per-layer state shared by every layer, so it runs up front
+  std::vector<const LayerConfig*> configs;
+  std::vector<FilterFunction> filters;
+  for (const auto layer_id : layer_ids) {
+    const auto& layer = scene_graph_->getLayer(layer_id);
+    configs.push_back(config_manager_->getLayerConfig(layer_id));
+    filters.push_back(getFrustumFilter(layer, *configs.back(), viz_config));
+  }
+
+  // every task gets its own message so the merged order does not depend on timing
+  const size_t num_tasks = layer_ids.size() + (draw_mesh_edges ? 1 : 0);
+  std::vector<MarkerArray> results(num_tasks);
+  parallelFor(num_tasks, num_redraw_threads_, [&](size_t i) {
+    if (i == layer_ids.size()) {
+      drawLayerMeshEdges(header, mesh_edge_source_layer_, mesh_edge_ns_, results[i]);
+      return;
+    }
+
+    const auto& layer = scene_graph_->getLayer(layer_ids[i]);
+    drawLayerMarkers(header, layer, *configs[i], filters[i], results[i]);
+  });
+
+  for (size_t i = 0; i < num_tasks; ++i) {
+    auto& markers = results[i].markers;
+    msg.markers.insert(msg.markers.end(),
+                       std::make_move_iterator(markers.begin()),
+                       std::make_move_iterator(markers.end()));
+    if (i < layer_ids.size()) {
+      // label LOD keeps per-layer state, so labels are drawn after merging
+      const auto& layer = scene_graph_->getLayer(layer_ids[i]);
+      drawLayerLabels(header, layer, *configs[i], viz_config, msg);
+    }
+  }
+}
+
+void DynamicSceneGraphVisualizer::drawInterlayerEdges(
+    const std_msgs::Header& header,
+    const std::map<LayerId, LayerConfig>& all_configs,
+    MarkerArray& msg) {
+  const auto& visualizer_config = config_manager_->getVisualizerConfig();
+  FilterFunction filter;
+  if (frustum_->config.enable) {
+    filter = [this](const SceneGraphNode& node) { return isVisible(node); };
+  }
+
+  const auto interlayer_edge_markers =
+      edge_builder_->makeGraphEdgeMarkers(header,
+                                          *scene_graph_,
+                                          all_configs,
+                                          visualizer_config,
+                                          interlayer_edge_ns_prefix_,
+                                          filter);
 
   std::set<std::string> seen_edge_labels;
   for (const auto& marker : interlayer_edge_markers.markers) {
@@ -375,24 +793,27 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
       deleteMultiMarker(header, curr_ns, msg);
     }
   }
+}
 
-  MarkerArray dynamic_markers;
-  drawDynamicLayers(header, dynamic_markers);
-
+void DynamicSceneGraphVisualizer::drawDynamicInterlayerEdges(
+    const std_msgs::Header& header,
+    const std::map<LayerId, LayerConfig>& all_configs,
+    MarkerArray& msg) {
+  const auto& visualizer_config = config_manager_->getVisualizerConfig();
   std::map<LayerId, DynamicLayerConfig> all_dynamic_configs;
   for (const auto& id_layer_pair : scene_graph_->dynamicLayers()) {
     const auto layer_id = id_layer_pair.first;
     all_dynamic_configs[layer_id] = config_manager_->getDynamicLayerConfig(layer_id);
   }
 
-  const std::string dynamic_interlayer_edge_prefix = "dynamic_interlayer_edges_";
-  MarkerArray dynamic_interlayer_edge_markers =
-      makeDynamicGraphEdgeMarkers(header,
-                                  *scene_graph_,
-                                  all_configs,
-                                  all_dynamic_configs,
-                                  visualizer_config,
-                                  dynamic_interlayer_edge_prefix);
+  const auto& dynamic_interlayer_edge_prefix = dynamic_interlayer_edge_ns_prefix_;
+  const auto dynamic_interlayer_edge_markers =
+      edge_builder_->makeDynamicGraphEdgeMarkers(header,
+                                                 *scene_graph_,
+                                                 all_configs,
+                                                 all_dynamic_configs,
+                                                 visualizer_config,
+                                                 dynamic_interlayer_edge_prefix);
 
   std::set<std::string> seen_dyn_edge_labels;
   for (const auto& marker : dynamic_interlayer_edge_markers.markers) {
@@ -417,33 +838,26 @@ void DynamicSceneGraphVisualizer::redrawImpl(const std_msgs::Header& header,
       }
     }
   }
-
-  if (!dynamic_markers.markers.empty()) {
-    dynamic_layers_viz_pub_.publish(dynamic_markers);
-  }
-
-  for (const auto& plugin : plugins_) {
-    plugin->draw(*config_manager_, header, *scene_graph_);
-  }
 }
 
 void DynamicSceneGraphVisualizer::deleteMultiMarker(const std_msgs::Header& header,
                                                     const std::string& ns,
                                                     MarkerArray& msg) {
-  if (!published_multimarkers_.count(ns)) {
-    return;
+  {  // layers may be drawn in parallel
+    std::lock_guard<std::mutex> lock(multimarker_mutex_);
+    if (!published_multimarkers_.erase(ns)) {
+      return;
+    }
   }
 
-  Marker delete_marker = makeDeleteMarker(header, 0, ns);
-  msg.markers.push_back(delete_marker);
-
-  published_multimarkers_.erase(ns);
+  msg.markers.push_back(makeDeleteMarker(header, 0, ns));
 }
 
 void DynamicSceneGraphVisualizer::addMultiMarkerIfValid(const Marker& marker,
                                                         MarkerArray& msg) {
   if (!marker.points.empty()) {
     msg.markers.push_back(marker);
+    std::lock_guard<std::mutex> lock(multimarker_mutex_);
     published_multimarkers_.insert(marker.ns);
     return;
   }
@@ -453,7 +867,7 @@ void DynamicSceneGraphVisualizer::addMultiMarkerIfValid(const Marker& marker,
 
 void DynamicSceneGraphVisualizer::displayLoop(const ros::WallTimerEvent&) {
   if (periodic_redraw_) {
-    need_redraw_ = true;
+    setNeedRedraw();
   }
   redraw();
 }
@@ -467,6 +881,7 @@ void DynamicSceneGraphVisualizer::deleteLayer(const std_msgs::Header& header,
   deleteMultiMarker(header, getLayerBboxEdgeNamespace(layer.id), msg);
   deleteMultiMarker(header, getLayerBoundaryNamespace(layer.id), msg);
   deleteMultiMarker(header, getLayerBoundaryEdgeNamespace(layer.id), msg);
+  deleteMultiMarker(header, getLayerFrontierNamespace(layer.id), msg);
 
   const std::string label_ns = getLayerLabelNamespace(layer.id);
   for (const auto& node : prev_labels_.at(layer.id)) {
@@ -523,6 +938,17 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
                                             const LayerConfig& config,
                                             MarkerArray& msg) {
   const auto& viz_config = config_manager_->getVisualizerConfig();
+  const auto filter = getFrustumFilter(layer, config, viz_config);
+  drawLayerMarkers(header, layer, config, filter, msg);
+  drawLayerLabels(header, layer, config, viz_config, msg);
+}
+
+void DynamicSceneGraphVisualizer::drawLayerMarkers(const std_msgs::Header& header,
+                                                   const SceneGraphLayer& layer,
+                                                   const LayerConfig& config,
+                                                   const FilterFunction& filter,
+                                                   MarkerArray& msg) {
+  const auto& viz_config = config_manager_->getVisualizerConfig();
   const std::string node_ns = getLayerNodeNamespace(layer.id);
 
   ColorFunction layer_color_func;
@@ -572,19 +998,30 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
     }
   }
 
+  const std::string frontier_ns = getLayerFrontierNamespace(layer.id);
+  if (!config.draw_frontier_ellipse || !config.batch_frontier_ellipse) {
+    deleteMultiMarker(header, frontier_ns, msg);
+  }
+
   if (config.draw_frontier_ellipse) {
-    std::vector<Marker> ellipsoids = makeEllipsoidMarkers(
-        header, config, layer, viz_config, "frontier_ns", layer_color_func);
-    for (auto e : ellipsoids) {
-      msg.markers.push_back(e);
+    if (config.batch_frontier_ellipse) {
+      auto ellipsoids = makeEllipsoidListMarker(
+          header, config, layer, viz_config, frontier_ns, layer_color_func, filter);
+      addMultiMarkerIfValid(ellipsoids, msg);
+    } else {
+      std::vector<Marker> ellipsoids = makeEllipsoidMarkers(
+          header, config, layer, viz_config, "frontier_ns", layer_color_func, filter);
+      for (auto e : ellipsoids) {
+        msg.markers.push_back(e);
+      }
     }
 
     auto nodes = makePlaceCentroidMarkers(
-        header, config, layer, viz_config, node_ns, layer_color_func);
+        header, config, layer, viz_config, node_ns, layer_color_func, filter);
     addMultiMarkerIfValid(nodes, msg);
   } else {
     auto nodes = makeCentroidMarkers(
-        header, config, layer, viz_config, node_ns, layer_color_func);
+        header, config, layer, viz_config, node_ns, layer_color_func, filter);
     addMultiMarkerIfValid(nodes, msg);
   }
 
@@ -596,47 +1033,30 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
                                  layer,
                                  viz_config,
                                  config_manager_->getColormapConfig("places_colormap"),
-                                 edge_ns);
+                                 edge_ns,
+                                 filter);
   } else {
     edges = makeLayerEdgeMarkers(
-        header, config, layer, viz_config, Color(), edge_ns);
+        header, config, layer, viz_config, Color(), edge_ns, filter);
   }
   addMultiMarkerIfValid(edges, msg);
 
-  const std::string label_ns = getLayerLabelNamespace(layer.id);
-
-  curr_labels_.at(layer.id).clear();
-  for (const auto& id_node_pair : layer.nodes()) {
-    const Node& node = *id_node_pair.second;
-
-    if (config.use_label) {
-      Marker label = makeTextMarker(header, config, node, viz_config, label_ns);
-      msg.markers.push_back(label);
-      curr_labels_.at(layer.id).insert(node.id);
-    }
-  }
-
-  if (config.use_collapsed_label) {
-    for (const auto& id_node_pair : layer.nodes()) {
-      const Node& node = *id_node_pair.second;
-
-      Marker label = makeTextMarkerNoHeight(header, config, node, viz_config, label_ns);
-      msg.markers.push_back(label);
-      curr_labels_.at(layer.id).insert(node.id);
-    }
-  }
-
   const std::string bbox_ns = getLayerBboxNamespace(layer.id);
   const std::string bbox_edge_ns = getLayerBboxEdgeNamespace(layer.id);
   if (config.use_bounding_box) {
     try {
       Marker bbox = makeLayerWireframeBoundingBoxes(
-          header, config, layer, viz_config, bbox_ns, layer_color_func);
+          header, config, layer, viz_config, bbox_ns, layer_color_func, filter);
       addMultiMarkerIfValid(bbox, msg);
 
       if (config.collapse_bounding_box) {
-        Marker bbox_edges = makeEdgesToBoundingBoxes(
-            header, config, layer, viz_config, bbox_edge_ns, layer_color_func);
+        Marker bbox_edges = makeEdgesToBoundingBoxes(header,
+                                                     config,
+                                                     layer,
+                                                     viz_config,
+                                                     bbox_edge_ns,
+                                                     layer_color_func,
+                                                     filter);
         addMultiMarkerIfValid(bbox_edges, msg);
       } else {
         deleteMultiMarker(header, bbox_edge_ns, msg);
@@ -684,9 +1104,115 @@ void DynamicSceneGraphVisualizer::drawLayer(const std_msgs::Header& header,
   } else {
     deleteMultiMarker(header, boundary_ellipse_ns, msg);
   }
+}
+
+void DynamicSceneGraphVisualizer::drawLayerLabels(const std_msgs::Header& header,
+                                                  const SceneGraphLayer& layer,
+                                                  const LayerConfig& config,
+                                                  const VisualizerConfig& viz_config,
+                                                  MarkerArray& msg) {
+  const std::string label_ns = getLayerLabelNamespace(layer.id);
+  auto& curr_labels = curr_labels_.at(layer.id);
+  curr_labels.clear();
+
+  const bool use_labels = config.use_label || config.use_collapsed_label;
+  if (use_labels && !label_lod_->config.enable) {
+    for (const auto& id_node_pair : layer.nodes()) {
+      const Node& node = *id_node_pair.second;
+      if (!isVisible(node)) {
+        continue;
+      }
+
+      if (config.use_label) {
+        Marker label = makeTextMarker(header, config, node, viz_config, label_ns);
+        msg.markers.push_back(label);
+        curr_labels.insert(node.id);
+      }
+    }
+
+    if (config.use_collapsed_label) {
+      for (const auto& id_node_pair : layer.nodes()) {
+        const Node& node = *id_node_pair.second;
+        if (!isVisible(node)) {
+          continue;
+        }
+
+        Marker label =
+            makeTextMarkerNoHeight(header, config, node, viz_config, label_ns);
+        msg.markers.push_back(label);
+        curr_labels.insert(node.id);
+      }
+    }
+  } else if (use_labels) {
+    std::vector<const Node*> nodes;
+    std::vector<LabelLod::Label> labels;
+    for (const auto& id_node_pair : layer.nodes()) {
+      const Node& node = *id_node_pair.second;
+      if (!isVisible(node)) {
+        continue;
+      }
+
+      nodes.push_back(&node);
+      labels.push_back({node.id, getLabelText(node), node.attributes().position});
+    }
+
+    const auto result = label_lod_->update(layer.id, labels, viewer_position_);
+    for (const auto idx : result.to_publish) {
+      // the collapsed label replaces the regular label when both are enabled
+      const Node& node = *nodes[idx];
+      msg.markers.push_back(
+          config.use_collapsed_label
+              ? makeTextMarkerNoHeight(header, config, node, viz_config, label_ns)
+              : makeTextMarker(header, config, node, viz_config, label_ns));
+    }
+
+    curr_labels = result.visible;
+  }
+
+  clearPrevMarkers(header, curr_labels, label_ns, prev_labels_.at(layer.id), msg);
+}
+
+std::optional<Eigen::Vector3d> DynamicSceneGraphVisualizer::getViewerPosition() const {
+  const auto view_pose = lookupViewPose(label_lod_->config.view_frame);
+  if (!view_pose) {
+    return std::nullopt;
+  }
 
-  clearPrevMarkers(
-      header, curr_labels_.at(layer.id), label_ns, prev_labels_.at(layer.id), msg);
+  return view_pose->translation();
+}
+
+std::optional<Eigen::Isometry3d> DynamicSceneGraphVisualizer::lookupViewPose(
+    const std::string& frame) const {
+  if (!tf_buffer_ || frame.empty()) {
+    return std::nullopt;
+  }
+
+  if (!tf_buffer_->canTransform(visualizer_frame_, frame, ros::Time(0))) {
+    return std::nullopt;
+  }
+
+  const auto msg = tf_buffer_->lookupTransform(visualizer_frame_, frame, ros::Time(0));
+  return tf2::transformToEigen(msg);
+}
+
+FilterFunction DynamicSceneGraphVisualizer::getFrustumFilter(
+    const SceneGraphLayer& layer,
+    const LayerConfig& config,
+    const VisualizerConfig& viz_config) {
+  if (!frustum_->config.enable) {
+    return {};
+  }
+
+  // markers are drawn with the layer offset, so the index uses the drawn positions
+  frustum_->update(layer.id, layer, getZOffset(config, viz_config));
+  visible_nodes_[layer.id] = frustum_->getVisible(layer.id);
+  return [this](const SceneGraphNode& node) { return isVisible(node); };
+}
+
+bool DynamicSceneGraphVisualizer::isVisible(const SceneGraphNode& node) const {
+  // layers that were not culled are always visible
+  auto iter = visible_nodes_.find(node.layer);
+  return iter == visible_nodes_.end() || iter->second.count(node.id);
 }
 
 void DynamicSceneGraphVisualizer::drawLayerMeshEdges(const std_msgs::Header& header,
@@ -707,12 +1233,15 @@ void DynamicSceneGraphVisualizer::drawLayerMeshEdges(const std_msgs::Header& hea
     return;
   }
 
-  Marker mesh_edges = makeMeshEdgesMarker(header,
-                                          *layer_config,
-                                          config_manager_->getVisualizerConfig(),
-                                          *scene_graph_,
-                                          scene_graph_->getLayer(layer_id),
-                                          ns);
+  Marker mesh_edges = mesh_edge_cache_.draw(header,
+                                            *layer_config,
+                                            config_manager_->getVisualizerConfig(),
+                                            *scene_graph_,
+                                            scene_graph_->getLayer(layer_id),
+                                            ns);
+  VLOG(10) << "[DSG Visualizer] rebuilt mesh edges for "
+           << mesh_edge_cache_.numRebuilt() << " / " << mesh_edge_cache_.size()
+           << " nodes";
   addMultiMarkerIfValid(mesh_edges, msg);
 }
 
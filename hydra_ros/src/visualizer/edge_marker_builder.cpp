@@ -0,0 +1,259 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/visualizer/edge_marker_builder.h"
+
+#include <spark_dsg/node_attributes.h>
+
+#include <algorithm>
+
+#include "hydra_ros/utils/parallel_for.h"
+#include "hydra_ros/visualizer/colormap_utilities.h"
+
+namespace hydra {
+
+using dsg_utils::makeColorMsg;
+using visualization_msgs::Marker;
+using visualization_msgs::MarkerArray;
+
+namespace {
+
+inline geometry_msgs::Point makePoint(const SceneGraphNode& node, double z_offset) {
+  const auto& position = node.attributes().position;
+  geometry_msgs::Point point;
+  point.x = position.x();
+  point.y = position.y();
+  point.z = position.z() + z_offset;
+  return point;
+}
+
+bool shouldVisualize(const DynamicSceneGraph& graph,
+                     const SceneGraphNode& node,
+                     const std::map<LayerId, LayerConfig>& configs,
+                     const std::map<LayerId, DynamicLayerConfig>& dynamic_configs) {
+  if (graph.isDynamic(node.id)) {
+    return dynamic_configs.count(node.layer) &&
+           dynamic_configs.at(node.layer).visualize &&
+           dynamic_configs.at(node.layer).visualize_interlayer_edges;
+  }
+
+  return configs.count(node.layer) && configs.at(node.layer).visualize;
+}
+
+LayerId getConfigLayer(const DynamicSceneGraph& graph,
+                       const SceneGraphNode& source,
+                       const SceneGraphNode& target) {
+  if (graph.isDynamic(source.id)) {
+    return source.layer;
+  } else {
+    return target.layer;
+  }
+}
+
+}  // namespace
+
+EdgeMarkerBuilder::EdgeMarkerBuilder(size_t num_threads) : num_threads_(num_threads) {}
+
+EdgeMarkerBuilder::Bucket& EdgeMarkerBuilder::getBucket(LayerId source,
+                                                        LayerId target,
+                                                        size_t skip) {
+  // there are only ever a handful of layers, so a linear search is fastest
+  for (size_t i = 0; i < num_buckets_; ++i) {
+    auto& bucket = buckets_[i];
+    if (bucket.source == source) {
+      return bucket;
+    }
+  }
+
+  if (num_buckets_ == buckets_.size()) {
+    buckets_.emplace_back();
+  }
+
+  auto& bucket = buckets_[num_buckets_++];
+  bucket.source = source;
+  bucket.target = target;
+  // make sure we always draw at least one edge
+  bucket.num_since_last_insertion = skip;
+  bucket.edges.clear();
+  return bucket;
+}
+
+void EdgeMarkerBuilder::addEdge(const SceneGraphNode& source,
+                                const SceneGraphNode& target,
+                                size_t skip) {
+  auto& bucket = getBucket(source.layer, target.layer, skip);
+  // the skip comes from the edge (as dynamic edges in a bucket may use different
+  // configs), while the count is shared by every edge from the source layer
+  if (bucket.num_since_last_insertion < skip) {
+    ++bucket.num_since_last_insertion;
+    return;
+  }
+
+  bucket.num_since_last_insertion = 0;
+  bucket.edges.emplace_back(&source, &target);
+}
+
+MarkerArray EdgeMarkerBuilder::makeMarkers(
+    const std_msgs::Header& header,
+    const std::map<LayerId, LayerConfig>& configs,
+    const std::string& ns_prefix) {
+  // markers are ordered by source layer (swapping buckets keeps their allocations)
+  std::sort(buckets_.begin(),
+            buckets_.begin() + num_buckets_,
+            [](const auto& lhs, const auto& rhs) { return lhs.source < rhs.source; });
+
+  MarkerArray markers;
+  markers.markers.resize(num_buckets_);
+  for (size_t i = 0; i < num_buckets_; ++i) {
+    const auto& bucket = buckets_[i];
+    auto& marker = markers.markers[i];
+    marker.header = header;
+    marker.type = Marker::LINE_LIST;
+    marker.action = Marker::ADD;
+    marker.id = 0;
+    marker.ns = ns_prefix + std::to_string(bucket.source) + "_" +
+                std::to_string(bucket.target);
+    marker.scale.x = configs.at(bucket.source).interlayer_edge_scale;
+    marker.pose = geometry_msgs::Pose();
+    marker.pose.orientation.w = 1.0;
+    marker.points.resize(2 * bucket.edges.size());
+  }
+
+  return markers;
+}
+
+MarkerArray EdgeMarkerBuilder::makeGraphEdgeMarkers(
+    const std_msgs::Header& header,
+    const DynamicSceneGraph& graph,
+    const std::map<LayerId, LayerConfig>& configs,
+    const VisualizerConfig& visualizer_config,
+    const std::string& ns_prefix,
+    const FilterFunction& filter) {
+  num_buckets_ = 0;
+  for (const auto& edge : graph.interlayer_edges()) {
+    const auto& source = graph.getNode(edge.second.source);
+    const auto& target = graph.getNode(edge.second.target);
+    if (filter && (!filter(source) || !filter(target))) {
+      continue;
+    }
+
+    const auto source_config = configs.find(source.layer);
+    const auto target_config = configs.find(target.layer);
+    if (source_config == configs.end() || target_config == configs.end()) {
+      continue;
+    }
+
+    if (!source_config->second.visualize || !target_config->second.visualize) {
+      continue;
+    }
+
+    // parent is always source
+    addEdge(source, target, source_config->second.interlayer_edge_insertion_skip);
+  }
+
+  auto markers = makeMarkers(header, configs, ns_prefix);
+  parallelFor(num_buckets_, num_threads_, [&](size_t i) {
+    const auto& bucket = buckets_[i];
+    const auto& config = configs.at(bucket.source);
+    const auto source_offset = getZOffset(config, visualizer_config);
+
+    auto& marker = markers.markers[i];
+    marker.colors.resize(marker.points.size());
+    for (size_t e = 0; e < bucket.edges.size(); ++e) {
+      const auto& [source, target] = bucket.edges[e];
+      const auto& target_config = configs.at(target->layer);
+      marker.points[2 * e] = makePoint(*source, source_offset);
+      marker.points[2 * e + 1] =
+          makePoint(*target, getZOffset(target_config, visualizer_config));
+
+      Color edge_color;
+      if (config.interlayer_edge_use_color) {
+        // TODO(nathan) this might not be a safe cast in general
+        const auto& node = config.use_edge_source ? *source : *target;
+        edge_color = node.attributes<SemanticNodeAttributes>().color;
+      }
+
+      const auto color = makeColorMsg(edge_color, config.intralayer_edge_alpha);
+      marker.colors[2 * e] = color;
+      marker.colors[2 * e + 1] = color;
+    }
+  });
+
+  return markers;
+}
+
+MarkerArray EdgeMarkerBuilder::makeDynamicGraphEdgeMarkers(
+    const std_msgs::Header& header,
+    const DynamicSceneGraph& graph,
+    const std::map<LayerId, LayerConfig>& configs,
+    const std::map<LayerId, DynamicLayerConfig>& dynamic_configs,
+    const VisualizerConfig& visualizer_config,
+    const std::string& ns_prefix) {
+  num_buckets_ = 0;
+  for (const auto& edge : graph.dynamic_interlayer_edges()) {
+    const auto& source = graph.getNode(edge.second.source);
+    const auto& target = graph.getNode(edge.second.target);
+    if (!shouldVisualize(graph, source, configs, dynamic_configs) ||
+        !shouldVisualize(graph, target, configs, dynamic_configs)) {
+      continue;
+    }
+
+    const auto& config = dynamic_configs.at(getConfigLayer(graph, source, target));
+    addEdge(source, target, config.interlayer_edge_insertion_skip);
+  }
+
+  auto markers = makeMarkers(header, configs, ns_prefix);
+  parallelFor(num_buckets_, num_threads_, [&](size_t i) {
+    const auto& bucket = buckets_[i];
+    // the marker color comes from the first edge in the bucket
+    const auto& first = bucket.edges.front();
+    const auto& config =
+        dynamic_configs.at(getConfigLayer(graph, *first.first, *first.second));
+    const auto source_offset = getZOffset(configs.at(bucket.source), visualizer_config);
+
+    auto& marker = markers.markers[i];
+    marker.color = makeColorMsg(Color(), config.edge_alpha);
+    for (size_t e = 0; e < bucket.edges.size(); ++e) {
+      const auto& [source, target] = bucket.edges[e];
+      const auto& target_config = configs.at(target->layer);
+      marker.points[2 * e] = makePoint(*source, source_offset);
+      marker.points[2 * e + 1] =
+          makePoint(*target, getZOffset(target_config, visualizer_config));
+    }
+  });
+
+  return markers;
+}
+
+}  // namespace hydra
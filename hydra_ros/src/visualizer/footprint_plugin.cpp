@@ -129,23 +129,51 @@ void FootprintPlugin::draw(const ConfigManager&,
   }
 
   const auto& layer = graph.getLayer(config.layer_id);
-  for (auto&& [id, node] : layer.nodes()) {
-    const auto mean_z = getMeanNeighborHeight(layer, *node);
-    const auto& attrs = node->attributes<SemanticNodeAttributes>();
+  const auto layer_signature = hashLayerGeometry(layer);
+  if (layer_signature != layer_signature_ || mean_heights_.empty()) {
+    mean_heights_.clear();
+    for (auto&& [id, node] : layer.nodes()) {
+      mean_heights_[id] = getMeanNeighborHeight(layer, *node);
+    }
 
-    auto color = dsg_utils::makeColorMsg(attrs.color);
-    color.a = config.line_alpha;
+    layer_signature_ = layer_signature;
+  }
 
+  PolygonCache::Signatures signatures;
+  for (auto&& [id, node] : layer.nodes()) {
     double radius = config.footprint_radius;
     if (config.use_place_radius) {
       radius = node->attributes<PlaceNodeAttributes>().distance;
     }
 
-    const auto footprint = getCirclePolygon(*node, radius, config.num_samples);
+    const auto& pos = node->attributes().position;
+    auto signature = hashCombine(0, pos.data(), 3 * sizeof(double));
+    signatures.emplace_back(id, hashCombine(signature, &radius, sizeof(double)));
+  }
+
+  polygon_cache_.update(signatures, [&](NodeId id, PolygonGeometry& geometry) {
+    const auto& node = layer.getNode(id);
+    double radius = config.footprint_radius;
+    if (config.use_place_radius) {
+      radius = node.attributes<PlaceNodeAttributes>().distance;
+    }
+
+    geometry.points = getCirclePolygon(node, radius, config.num_samples);
+  });
+
+  for (auto&& [id, node] : layer.nodes()) {
+    const auto mean_z = mean_heights_.at(id);
+    const auto& attrs = node->attributes<SemanticNodeAttributes>();
+
+    auto color = dsg_utils::makeColorMsg(attrs.color);
+    color.a = config.line_alpha;
+
+    const auto& geometry = polygon_cache_.at(id);
+    const auto& footprint = geometry.points;
 
     auto mesh_color = color;
     mesh_color.a = config.mesh_alpha;
-    makeFilledPolygon(footprint, mesh_color, msg.markers[0], mean_z);
+    makeFilledPolygon(footprint, geometry.faces, mesh_color, msg.markers[0], mean_z);
     if (config.draw_boundaries) {
       makePolygonBoundary(footprint,
                           color,
@@ -168,6 +196,8 @@ void FootprintPlugin::reset(const std_msgs::Header& header, const DynamicSceneGr
     msg.markers.push_back(makeDeleteMarker(header, 0, ns));
   }
   namespaces_.clear();
+  polygon_cache_.clear();
+  mean_heights_.clear();
 
   pub_.publish(msg);
 }
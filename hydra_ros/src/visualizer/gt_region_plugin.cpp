@@ -46,6 +46,7 @@
 
 #include <filesystem>
 
+#include "hydra_ros/utils/ear_clipping.h"
 #include "hydra_ros/visualizer/colormap_utilities.h"
 #include "hydra_ros/visualizer/polygon_utilities.h"
 #include "hydra_ros/visualizer/visualizer_utilities.h"
@@ -68,6 +69,9 @@ void declare_config(GtRegionPlugin::Config& config) {
   field(config.label_offset, "label_offset");
   field(config.z_offset, "z_offset");
   field(config.use_boundary_color, "use_boundary_color");
+  field(config.num_triangulation_threads, "num_triangulation_threads");
+
+  check(config.num_triangulation_threads, GT, 0, "num_triangulation_threads");
 }
 
 GtRegionPlugin::GtRegionPlugin(const Config& config,
@@ -125,6 +129,16 @@ GtRegionPlugin::GtRegionPlugin(const Config& config,
     new_region.color.g = color.at(1) / 255.0;
     new_region.color.b = color.at(2) / 255.0;
   }
+
+  std::vector<const Eigen::MatrixXd*> boundaries;
+  for (const auto& region : regions_) {
+    boundaries.push_back(&region.points);
+  }
+
+  auto faces = triangulatePolygons(boundaries, config.num_triangulation_threads);
+  for (size_t i = 0; i < regions_.size(); ++i) {
+    regions_[i].faces = std::move(faces[i]);
+  }
 }
 
 GtRegionPlugin::~GtRegionPlugin() {}
@@ -242,7 +256,7 @@ void GtRegionPlugin::draw(const ConfigManager&,
     if (f_index) {
       auto color = region.color;
       color.a = config.mesh_alpha;
-      makeFilledPolygon(region.points, color, msg.markers.at(*f_index));
+      makeFilledPolygon(region.points, region.faces, color, msg.markers.at(*f_index));
     }
 
     auto b_index = getBoundaryMarker(header, msg);
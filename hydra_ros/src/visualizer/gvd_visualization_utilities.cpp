@@ -36,6 +36,8 @@
 
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <algorithm>
+#include <cstring>
 #include <random>
 
 #include "hydra_ros/visualizer/colormap_utilities.h"
@@ -62,21 +64,47 @@ void MarkerGroupPub::publish(const std::string& name,
 }
 
 void MarkerGroupPub::publish(const std::string& name, const ArrayCallback& func) const {
-  auto iter = pubs_.find(name);
-  if (iter == pubs_.end()) {
-    iter = pubs_.emplace(name, nh_.advertise<MarkerArray>(name, 1, true)).first;
+  const auto& pub = getPublisher(name);
+  if (!pub.getNumSubscribers()) {
+    return;  // avoid doing computation if we don't need to publish
+  }
+
+  MarkerArray msg;
+  if (func(msg)) {
+    pub.publish(msg);
+  }
+}
+
+void MarkerGroupPub::publish(const std::string& name, const CloudCallback& func) const {
+  auto iter = cloud_pubs_.find(name);
+  if (iter == cloud_pubs_.end()) {
+    const auto pub = nh_.advertise<sensor_msgs::PointCloud2>(name, 1, true);
+    iter = cloud_pubs_.emplace(name, pub).first;
   }
 
   if (!iter->second.getNumSubscribers()) {
-    return;  // avoid doing computation if we don't need to publish
+    return;
   }
 
-  MarkerArray msg;
+  sensor_msgs::PointCloud2 msg;
   if (func(msg)) {
     iter->second.publish(msg);
   }
 }
 
+size_t MarkerGroupPub::numSubscribers(const std::string& name) const {
+  return getPublisher(name).getNumSubscribers();
+}
+
+const ros::Publisher& MarkerGroupPub::getPublisher(const std::string& name) const {
+  auto iter = pubs_.find(name);
+  if (iter == pubs_.end()) {
+    iter = pubs_.emplace(name, nh_.advertise<MarkerArray>(name, 1, true)).first;
+  }
+
+  return iter->second;
+}
+
 double getRatioFromDistance(const GvdVisualizerConfig& config, const GvdVoxel& voxel) {
   return computeRatio(config.gvd_min_distance, config.gvd_max_distance, voxel.distance);
 }
@@ -100,41 +128,52 @@ double getRatio(const GvdVisualizerConfig& config, const GvdVoxel& voxel) {
   return 0.0;
 }
 
-Marker makeGvdMarker(const GvdVisualizerConfig& config,
-                     const ColormapConfig& colors,
-                     const GvdLayer& layer) {
+Marker makeVoxelMarker(double voxel_size, const std::string& ns) {
   Marker marker;
   marker.type = Marker::CUBE_LIST;
   marker.action = Marker::ADD;
   marker.id = 0;
-  marker.ns = "gvd_markers";
+  marker.ns = ns;
 
   Eigen::Vector3d identity_pos = Eigen::Vector3d::Zero();
   tf2::convert(identity_pos, marker.pose.position);
   tf2::convert(Eigen::Quaterniond::Identity(), marker.pose.orientation);
 
-  marker.scale.x = layer.voxel_size;
-  marker.scale.y = layer.voxel_size;
-  marker.scale.z = layer.voxel_size;
+  marker.scale.x = voxel_size;
+  marker.scale.y = voxel_size;
+  marker.scale.z = voxel_size;
+  return marker;
+}
 
-  for (const auto& block : layer) {
-    for (size_t i = 0; i < block.numVoxels(); ++i) {
-      const auto& voxel = block.getVoxel(i);
-      if (!voxel.observed || voxel.num_extra_basis < config.basis_threshold) {
-        continue;
-      }
+void addGvdVoxels(const GvdVisualizerConfig& config,
+                  const ColormapConfig& colors,
+                  const places::GvdBlock& block,
+                  Marker& marker) {
+  for (size_t i = 0; i < block.numVoxels(); ++i) {
+    const auto& voxel = block.getVoxel(i);
+    if (!voxel.observed || voxel.num_extra_basis < config.basis_threshold) {
+      continue;
+    }
 
-      const Eigen::Vector3d voxel_pos = block.getVoxelPosition(i).cast<double>();
-      geometry_msgs::Point marker_pos;
-      tf2::convert(voxel_pos, marker_pos);
-      marker.points.push_back(marker_pos);
+    const Eigen::Vector3d voxel_pos = block.getVoxelPosition(i).cast<double>();
+    geometry_msgs::Point marker_pos;
+    tf2::convert(voxel_pos, marker_pos);
+    marker.points.push_back(marker_pos);
 
-      double ratio = getRatio(config, voxel);
-      Color color = dsg_utils::interpolateColorMap(colors, ratio);
+    double ratio = getRatio(config, voxel);
+    Color color = dsg_utils::interpolateColorMap(colors, ratio);
 
-      std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.gvd_alpha);
-      marker.colors.push_back(color_msg);
-    }
+    std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.gvd_alpha);
+    marker.colors.push_back(color_msg);
+  }
+}
+
+Marker makeGvdMarker(const GvdVisualizerConfig& config,
+                     const ColormapConfig& colors,
+                     const GvdLayer& layer) {
+  auto marker = makeVoxelMarker(layer.voxel_size, "gvd_markers");
+  for (const auto& block : layer) {
+    addGvdVoxels(config, colors, block, marker);
   }
 
   return marker;
@@ -191,93 +230,87 @@ Marker makeErrorMarker(const GvdVisualizerConfig& config,
   return marker;
 }
 
-Marker makeSurfaceVoxelMarker(const GvdVisualizerConfig& config,
-                              const ColormapConfig& colors,
-                              const GvdLayer& layer) {
-  Marker marker;
-  marker.type = Marker::CUBE_LIST;
-  marker.action = Marker::ADD;
-  marker.id = 0;
-  marker.ns = "surface_markers";
-
-  Eigen::Vector3d identity_pos = Eigen::Vector3d::Zero();
-  tf2::convert(identity_pos, marker.pose.position);
-  tf2::convert(Eigen::Quaterniond::Identity(), marker.pose.orientation);
-
-  marker.scale.x = layer.voxel_size;
-  marker.scale.y = layer.voxel_size;
-  marker.scale.z = layer.voxel_size;
+void addSurfaceVoxels(const GvdVisualizerConfig& config,
+                      const ColormapConfig& colors,
+                      const places::GvdBlock& block,
+                      Marker& marker) {
+  for (size_t i = 0; i < block.numVoxels(); ++i) {
+    const auto& voxel = block.getVoxel(i);
+    if (!voxel.on_surface) {
+      continue;
+    }
 
-  for (const auto& block : layer) {
-    for (size_t i = 0; i < block.numVoxels(); ++i) {
-      const auto& voxel = block.getVoxel(i);
-      if (!voxel.on_surface) {
-        continue;
-      }
+    Eigen::Vector3d voxel_pos = block.getVoxelPosition(i).cast<double>();
+    geometry_msgs::Point marker_pos;
+    tf2::convert(voxel_pos, marker_pos);
+    marker.points.push_back(marker_pos);
 
-      Eigen::Vector3d voxel_pos = block.getVoxelPosition(i).cast<double>();
-      geometry_msgs::Point marker_pos;
-      tf2::convert(voxel_pos, marker_pos);
-      marker.points.push_back(marker_pos);
+    double ratio = computeRatio(-0.4, 0.4, voxel.distance);
+    Color color = dsg_utils::interpolateColorMap(colors, ratio);
 
-      double ratio = computeRatio(-0.4, 0.4, voxel.distance);
-      Color color = dsg_utils::interpolateColorMap(colors, ratio);
+    std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.gvd_alpha);
+    marker.colors.push_back(color_msg);
+  }
+}
 
-      std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.gvd_alpha);
-      marker.colors.push_back(color_msg);
-    }
+Marker makeSurfaceVoxelMarker(const GvdVisualizerConfig& config,
+                              const ColormapConfig& colors,
+                              const GvdLayer& layer) {
+  auto marker = makeVoxelMarker(layer.voxel_size, "surface_markers");
+  for (const auto& block : layer) {
+    addSurfaceVoxels(config, colors, block, marker);
   }
 
   return marker;
 }
 
-Marker makeEsdfMarker(const GvdVisualizerConfig& config,
-                      const ColormapConfig& colors,
-                      const GvdLayer& layer) {
-  Marker marker;
-  marker.type = Marker::CUBE_LIST;
-  marker.action = Marker::ADD;
-  marker.id = 0;
-  marker.ns = "esdf_slice_markers";
-
-  Eigen::Vector3d identity_pos = Eigen::Vector3d::Zero();
-  tf2::convert(identity_pos, marker.pose.position);
-  tf2::convert(Eigen::Quaterniond::Identity(), marker.pose.orientation);
-
-  marker.scale.x = layer.voxel_size;
-  marker.scale.y = layer.voxel_size;
-  marker.scale.z = layer.voxel_size;
-
-  const float voxel_size = layer.voxel_size;
+void addEsdfVoxels(const GvdVisualizerConfig& config,
+                   const ColormapConfig& colors,
+                   const places::GvdBlock& block,
+                   Marker& marker) {
+  const float voxel_size = block.voxel_size;
   const float half_voxel_size = voxel_size / 2.0;
   // rounds down and points the slice at the middle of the nearest voxel boundary
   const float slice_height =
       std::floor(config.slice_height / voxel_size) * voxel_size + half_voxel_size;
 
-  for (const auto& block : layer) {
-    for (size_t i = 0; i < block.numVoxels(); ++i) {
-      const auto& voxel = block.getVoxel(i);
-      if (!voxel.observed) {
-        continue;
-      }
+  const float block_min_z = block.origin().z();
+  if (slice_height + half_voxel_size < block_min_z ||
+      slice_height - half_voxel_size > block_min_z + block.block_size) {
+    return;
+  }
 
-      Eigen::Vector3d voxel_pos = block.getVoxelPosition(i).cast<double>();
-      if (voxel_pos(2) < slice_height - half_voxel_size ||
-          voxel_pos(2) > slice_height + half_voxel_size) {
-        continue;
-      }
+  for (size_t i = 0; i < block.numVoxels(); ++i) {
+    const auto& voxel = block.getVoxel(i);
+    if (!voxel.observed) {
+      continue;
+    }
 
-      geometry_msgs::Point marker_pos;
-      tf2::convert(voxel_pos, marker_pos);
-      marker.points.push_back(marker_pos);
+    Eigen::Vector3d voxel_pos = block.getVoxelPosition(i).cast<double>();
+    if (voxel_pos(2) < slice_height - half_voxel_size ||
+        voxel_pos(2) > slice_height + half_voxel_size) {
+      continue;
+    }
 
-      double ratio = computeRatio(
-          config.esdf_min_distance, config.esdf_max_distance, voxel.distance);
-      Color color = dsg_utils::interpolateColorMap(colors, ratio);
+    geometry_msgs::Point marker_pos;
+    tf2::convert(voxel_pos, marker_pos);
+    marker.points.push_back(marker_pos);
 
-      std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.esdf_alpha);
-      marker.colors.push_back(color_msg);
-    }
+    double ratio = computeRatio(
+        config.esdf_min_distance, config.esdf_max_distance, voxel.distance);
+    Color color = dsg_utils::interpolateColorMap(colors, ratio);
+
+    std_msgs::ColorRGBA color_msg = dsg_utils::makeColorMsg(color, config.esdf_alpha);
+    marker.colors.push_back(color_msg);
+  }
+}
+
+Marker makeEsdfMarker(const GvdVisualizerConfig& config,
+                      const ColormapConfig& colors,
+                      const GvdLayer& layer) {
+  auto marker = makeVoxelMarker(layer.voxel_size, "esdf_slice_markers");
+  for (const auto& block : layer) {
+    addEsdfVoxels(config, colors, block, marker);
   }
 
   return marker;
@@ -428,26 +461,22 @@ std_msgs::ColorRGBA makeGvdColor(const GvdVisualizerConfig& config,
   return dsg_utils::makeColorMsg(color, alpha);
 }
 
-using EdgeMap = std::unordered_map<uint64_t, std::unordered_set<uint64_t>>;
+namespace {
 
-std::unordered_set<uint64_t>& getNodeSet(EdgeMap& edge_map, uint64_t node) {
-  auto iter = edge_map.find(node);
-  if (iter == edge_map.end()) {
-    iter = edge_map.emplace(node, std::unordered_set<uint64_t>()).first;
-  }
-  return iter->second;
+inline void hashCombine(uint64_t& seed, uint64_t value) {
+  seed ^= std::hash<uint64_t>()(value) + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2);
 }
 
-MarkerArray makeGvdGraphMarkers(const GvdGraph& graph,
-                                const GvdVisualizerConfig& config,
-                                const ColormapConfig& colors,
-                                const std::string& ns,
-                                size_t marker_id) {
-  MarkerArray marker;
-  if (graph.empty()) {
-    return marker;
-  }
+inline uint64_t hashDouble(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
 
+MarkerArray makeGvdGraphMarkerArray(const GvdVisualizerConfig& config,
+                                    const std::string& ns,
+                                    size_t marker_id) {
+  MarkerArray marker;
   const Eigen::Vector3d p_identity = Eigen::Vector3d::Zero();
   const Eigen::Quaterniond q_identity = Eigen::Quaterniond::Identity();
   {  // scope to make handling stuff a little easier
@@ -476,79 +505,158 @@ MarkerArray makeGvdGraphMarkers(const GvdGraph& graph,
     marker.markers.push_back(edges);
   }
 
-  auto& nodes = marker.markers[0];
-  auto& edges = marker.markers[1];
+  return marker;
+}
 
-  EdgeMap seen_edges;
-  for (const auto& id_node_pair : graph.nodes()) {
-    geometry_msgs::Point node_centroid;
-    tf2::convert(id_node_pair.second.position, node_centroid);
-    nodes.points.push_back(node_centroid);
-    nodes.colors.push_back(makeGvdColor(config,
-                                        colors,
-                                        id_node_pair.second.distance,
-                                        id_node_pair.second.num_basis_points));
+/**
+ * Fills node and edge markers for a GVD graph. Every node is colored once and edges
+ * are collected as a flat list of sorted index pairs, which replaces tracking the
+ * visited siblings of each node in a hash set.
+ */
+template <typename ColorFunc>
+void fillGvdGraphMarkers(const GvdGraph& graph,
+                         const ColorFunc& get_color,
+                         Marker& nodes,
+                         Marker& edges) {
+  const auto& graph_nodes = graph.nodes();
+  std::unordered_map<uint64_t, uint32_t> indices;
+  indices.reserve(graph_nodes.size());
+  nodes.points.reserve(graph_nodes.size());
+  nodes.colors.reserve(graph_nodes.size());
+  for (const auto& [node_id, node] : graph_nodes) {
+    indices.emplace(node_id, nodes.points.size());
+    tf2::convert(node.position, nodes.points.emplace_back());
+    nodes.colors.push_back(get_color(node_id, node));
+  }
 
-    auto& curr_seen = getNodeSet(seen_edges, id_node_pair.first);
+  std::vector<std::pair<uint32_t, uint32_t>> edge_list;
+  uint32_t source = 0;
+  for (const auto& id_node_pair : graph_nodes) {
     for (const auto sibling : id_node_pair.second.siblings) {
-      if (curr_seen.count(sibling)) {
+      const auto iter = indices.find(sibling);
+      if (iter == indices.end()) {
         continue;
       }
 
-      curr_seen.insert(sibling);
-      getNodeSet(seen_edges, sibling).insert(id_node_pair.first);
+      edge_list.emplace_back(std::min(source, iter->second),
+                             std::max(source, iter->second));
+    }
 
-      edges.points.push_back(nodes.points.back());
-      edges.colors.push_back(nodes.colors.back());
+    ++source;
+  }
+
+  // siblings are usually listed by both nodes
+  std::sort(edge_list.begin(), edge_list.end());
+  edge_list.erase(std::unique(edge_list.begin(), edge_list.end()), edge_list.end());
+
+  edges.points.reserve(2 * edge_list.size());
+  edges.colors.reserve(2 * edge_list.size());
+  for (const auto& [lhs, rhs] : edge_list) {
+    edges.points.push_back(nodes.points[lhs]);
+    edges.colors.push_back(nodes.colors[lhs]);
+    edges.points.push_back(nodes.points[rhs]);
+    edges.colors.push_back(nodes.colors[rhs]);
+  }
+}
+
+}  // namespace
+
+uint64_t computeGvdGraphSignature(const GvdGraph& graph) {
+  // order-independent so that the signature only depends on the graph contents
+  uint64_t signature = graph.nodes().size();
+  for (const auto& [node_id, node] : graph.nodes()) {
+    uint64_t node_hash = node_id;
+    hashCombine(node_hash, hashDouble(node.position.x()));
+    hashCombine(node_hash, hashDouble(node.position.y()));
+    hashCombine(node_hash, hashDouble(node.position.z()));
+    hashCombine(node_hash, hashDouble(node.distance));
+    hashCombine(node_hash, node.num_basis_points);
+    for (const auto sibling : node.siblings) {
+      hashCombine(node_hash, sibling);
+    }
+
+    signature += node_hash;
+  }
+
+  return signature;
+}
 
-      const auto& other = *graph.getNode(sibling);
-      geometry_msgs::Point neighbor_centroid;
-      tf2::convert(other.position, neighbor_centroid);
-      edges.points.push_back(neighbor_centroid);
-      edges.colors.push_back(
-          makeGvdColor(config, colors, other.distance, other.num_basis_points));
+uint64_t computeGvdClusterSignature(
+    const CompressedNodeMap& clusters,
+    const std::unordered_map<uint64_t, uint64_t>& remapping) {
+  uint64_t signature = clusters.size();
+  for (const auto& [cluster_id, cluster] : clusters) {
+    uint64_t cluster_hash = cluster_id;
+    for (const auto sibling : cluster.siblings) {
+      hashCombine(cluster_hash, sibling);
     }
+
+    signature += cluster_hash;
+  }
+
+  for (const auto& [node_id, cluster_id] : remapping) {
+    uint64_t remap_hash = node_id;
+    hashCombine(remap_hash, cluster_id);
+    signature += remap_hash;
   }
 
+  return signature;
+}
+
+MarkerArray makeGvdGraphMarkers(const GvdGraph& graph,
+                                const GvdVisualizerConfig& config,
+                                const ColormapConfig& colors,
+                                const std::string& ns,
+                                size_t marker_id) {
+  MarkerArray marker;
+  if (graph.empty()) {
+    return marker;
+  }
+
+  marker = makeGvdGraphMarkerArray(config, ns, marker_id);
+  fillGvdGraphMarkers(
+      graph,
+      [&](uint64_t, const auto& node) {
+        return makeGvdColor(config, colors, node.distance, node.num_basis_points);
+      },
+      marker.markers[0],
+      marker.markers[1]);
   return marker;
 }
 
 size_t fillColors(const CompressedNodeMap& clusters,
-                  std::map<uint64_t, size_t>& colors) {
+                  std::unordered_map<uint64_t, size_t>& colors) {
+  colors.reserve(clusters.size());
+  std::vector<bool> seen_colors;
   for (const auto& id_node_pair : clusters) {
     size_t max_color = 0;
-    std::set<size_t> seen_colors;
+    bool has_neighbor = false;
+    seen_colors.clear();
     for (const auto sibling : id_node_pair.second.siblings) {
       const auto iter = colors.find(sibling);
       if (iter == colors.end()) {
         continue;
       }
 
-      seen_colors.insert(iter->second);
-      if (iter->second > max_color) {
-        max_color = iter->second;
+      if (iter->second >= seen_colors.size()) {
+        seen_colors.resize(iter->second + 1, false);
       }
-    }
 
-    if (seen_colors.empty()) {
-      colors[id_node_pair.first] = 0;
-      continue;
+      has_neighbor = true;
+      seen_colors[iter->second] = true;
+      max_color = std::max(max_color, iter->second);
     }
 
-    bool found_color = false;
-    for (size_t i = 0; i < max_color; ++i) {
-      if (!seen_colors.count(i)) {
-        colors[id_node_pair.first] = i;
-        found_color = true;
-        break;
-      }
-    }
-
-    if (found_color) {
+    if (!has_neighbor) {
+      colors[id_node_pair.first] = 0;
       continue;
     }
 
-    colors[id_node_pair.first] = max_color + 1;
+    // lowest color not used by a neighbor
+    const auto first_free = std::find(seen_colors.begin(), seen_colors.end(), false);
+    const size_t free_color = first_free - seen_colors.begin();
+    colors[id_node_pair.first] =
+        first_free == seen_colors.end() ? max_color + 1 : free_color;
   }
 
   size_t num_colors = 0;
@@ -573,38 +681,7 @@ MarkerArray showGvdClusters(const GvdGraph& graph,
     return marker;
   }
 
-  const Eigen::Vector3d p_identity = Eigen::Vector3d::Zero();
-  const Eigen::Quaterniond q_identity = Eigen::Quaterniond::Identity();
-  {  // scope to make handling stuff a little easier
-    Marker nodes;
-    nodes.type = Marker::SPHERE_LIST;
-    nodes.id = marker_id;
-    nodes.ns = ns + "_nodes";
-    nodes.action = Marker::ADD;
-    nodes.scale.x = config.gvd_graph_scale;
-    nodes.scale.y = config.gvd_graph_scale;
-    nodes.scale.z = config.gvd_graph_scale;
-    tf2::convert(p_identity, nodes.pose.position);
-    tf2::convert(q_identity, nodes.pose.orientation);
-    marker.markers.push_back(nodes);
-  }
-
-  {  // scope to make handling stuff a little easier
-    Marker edges;
-    edges.type = Marker::LINE_LIST;
-    edges.id = marker_id;
-    edges.ns = ns + "_edges";
-    edges.action = Marker::ADD;
-    edges.scale.x = config.gvd_graph_scale;
-    tf2::convert(p_identity, edges.pose.position);
-    tf2::convert(q_identity, edges.pose.orientation);
-    marker.markers.push_back(edges);
-  }
-
-  auto& nodes = marker.markers[0];
-  auto& edges = marker.markers[1];
-
-  std::map<uint64_t, size_t> color_mapping;
+  std::unordered_map<uint64_t, size_t> color_mapping;
   const size_t num_colors = fillColors(clusters, color_mapping);
   std::vector<std_msgs::ColorRGBA> colors;
   for (size_t i = 0; i < num_colors; ++i) {
@@ -613,47 +690,17 @@ MarkerArray showGvdClusters(const GvdGraph& graph,
     colors.push_back(dsg_utils::makeColorMsg(color, config.gvd_alpha));
   }
 
-  EdgeMap seen_edges;
-  for (const auto& id_node_pair : graph.nodes()) {
-    geometry_msgs::Point node_centroid;
-    tf2::convert(id_node_pair.second.position, node_centroid);
-    nodes.points.push_back(node_centroid);
-    if (remapping.count(id_node_pair.first)) {
-      const auto cluster_id = remapping.at(id_node_pair.first);
-      const auto& cluster_color = colors.at(color_mapping.at(cluster_id));
-      nodes.colors.push_back(cluster_color);
-    } else {
-      nodes.colors.push_back(dsg_utils::makeColorMsg(Color(0, 0, 0), config.gvd_alpha));
-    }
-
-    auto& curr_seen = getNodeSet(seen_edges, id_node_pair.first);
-    for (const auto sibling : id_node_pair.second.siblings) {
-      if (curr_seen.count(sibling)) {
-        continue;
-      }
-
-      curr_seen.insert(sibling);
-      getNodeSet(seen_edges, sibling).insert(id_node_pair.first);
-
-      edges.points.push_back(nodes.points.back());
-      edges.colors.push_back(nodes.colors.back());
-
-      const auto& other = *graph.getNode(sibling);
-      geometry_msgs::Point neighbor_centroid;
-      tf2::convert(other.position, neighbor_centroid);
-      edges.points.push_back(neighbor_centroid);
-
-      if (remapping.count(sibling)) {
-        const auto& neighbor_cluster = remapping.at(sibling);
-        const auto& neighbor_color = colors.at(color_mapping.at(neighbor_cluster));
-        edges.colors.push_back(neighbor_color);
-      } else {
-        edges.colors.push_back(
-            dsg_utils::makeColorMsg(Color(0, 0, 0), config.gvd_alpha));
-      }
-    }
-  }
-
+  const auto unassigned = dsg_utils::makeColorMsg(Color(0, 0, 0), config.gvd_alpha);
+  marker = makeGvdGraphMarkerArray(config, ns, marker_id);
+  fillGvdGraphMarkers(
+      graph,
+      [&](uint64_t node_id, const auto&) {
+        const auto iter = remapping.find(node_id);
+        return iter == remapping.end() ? unassigned
+                                       : colors.at(color_mapping.at(iter->second));
+      },
+      marker.markers[0],
+      marker.markers[1]);
   return marker;
 }
 
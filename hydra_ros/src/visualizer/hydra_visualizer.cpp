@@ -42,19 +42,57 @@
 #include <glog/logging.h>
 #include <hydra/utils/timing_utilities.h>
 
+#include <filesystem>
+#include <limits>
+
+#include "hydra_ros/utils/detached_task.h"
+#include "hydra_ros/utils/dsg_log.h"
+#include "hydra_ros/utils/metrics.h"
+#include "hydra_ros/utils/node_utilities.h"
+
 namespace hydra {
 
+namespace {
+
+DynamicSceneGraph::Ptr loadGraphFile(const std::string& filepath) {
+  if (std::filesystem::path(filepath).extension() != ".log") {
+    return DynamicSceneGraph::load(filepath);
+  }
+
+  // logs are memory-mapped, so only the last keyframe and the deltas after it are read
+  DsgLogReader reader(filepath);
+  if (!reader.valid() || reader.records().empty()) {
+    return nullptr;
+  }
+
+  return reader.seek(std::numeric_limits<uint64_t>::max()).graph;
+}
+
+}  // namespace
+
 void declare_config(HydraVisualizerConfig& config) {
   using namespace config;
   name("HydraVisualizerConfig");
   field(config.load_graph, "load_graph");
   field(config.use_zmq, "use_zmq");
   field(config.scene_graph_filepath, "scene_graph_filepath");
+  field(config.mesh_filepath, "mesh_filepath");
   field(config.visualizer_ns, "visualizer_ns");
   field(config.output_path, "output_path");
   field(config.zmq_url, "zmq_url");
   field(config.zmq_num_threads, "zmq_num_threads");
+  field(config.pipelined, "pipelined");
+  field(config.render_rate_hz, "render_rate_hz", "Hz");
+  field(config.robot_namespaces, "robot_namespaces");
+  field(config.freespace_index_resolution, "freespace_index_resolution");
+  field(config.query_index_resolution, "query_index_resolution", "m");
+  field(config.metrics, "metrics");
   field(config.plugins, "plugins");
+
+  checkCondition(config.freespace_index_resolution > 0.0,
+                 "freespace_index_resolution must be positive");
+  check(config.query_index_resolution, GT, 0.0, "query_index_resolution");
+  check(config.render_rate_hz, GT, 0.0, "render_rate_hz");
 }
 
 HydraVisualizer::HydraVisualizer(const ros::NodeHandle& nh) : nh_(nh) {
@@ -63,6 +101,10 @@ HydraVisualizer::HydraVisualizer(const ros::NodeHandle& nh) : nh_(nh) {
 
   config_ = config::fromRos<HydraVisualizerConfig>(nh);
   ROS_INFO_STREAM("Config: " << std::endl << config_);
+  freespace_index_ = FreespaceIndex(config_.freespace_index_resolution);
+  query_index_ = DsgQueryIndex(config_.query_index_resolution);
+  const ros::NodeHandle metrics_nh(nh_, "metrics");
+  metrics_.reset(new MetricsPublisher(config_.metrics, metrics_nh, "visualizer"));
 
   visualizer_.reset(new DsgVisualizer(nh_));
   for (auto&& [name, config] : config_.plugins) {
@@ -89,12 +131,80 @@ HydraVisualizer::~HydraVisualizer() {
 }
 
 void HydraVisualizer::loadGraph() {
-  ROS_INFO_STREAM("Loading dsg from: " << config_.scene_graph_filepath);
-  auto dsg = hydra::DynamicSceneGraph::load(config_.scene_graph_filepath);
+  // loads that are still running from a previous reload are abandoned instead of
+  // waited on and their results are dropped with their futures
+  const auto graph_filepath = config_.scene_graph_filepath;
+  pending_graph_ = launchDetached([graph_filepath]() {
+    ROS_INFO_STREAM("Loading dsg from: " << graph_filepath);
+    return loadGraphFile(graph_filepath);
+  });
+
+  pending_mesh_ = {};
+  if (!config_.mesh_filepath.empty()) {
+    // draw the layers first and attach the mesh once it is loaded
+    const auto mesh_filepath = config_.mesh_filepath;
+    pending_mesh_ = launchDetached([mesh_filepath]() {
+      ROS_INFO_STREAM("Loading mesh from: " << mesh_filepath);
+      return Mesh::load(mesh_filepath);
+    });
+  }
+}
+
+bool HydraVisualizer::checkPendingGraph() {
+  if (!isReady(pending_graph_)) {
+    return false;
+  }
+
+  DynamicSceneGraph::Ptr dsg;
+  std::string error;
+  try {
+    dsg = pending_graph_.get();
+  } catch (const std::exception& e) {
+    error = std::string(": ") + e.what();
+  }
+
+  if (!dsg) {
+    LOG(ERROR) << "Failed to load dsg from " << config_.scene_graph_filepath << error;
+    // the mesh would otherwise be attached to the previous graph
+    pending_mesh_ = {};
+    return false;
+  }
+
   ROS_INFO_STREAM("Loaded dsg: " << dsg->numNodes() << " nodes, " << dsg->numEdges()
                                  << " edges, has mesh? "
                                  << (dsg->hasMesh() ? "yes" : "no"));
+  freespace_index_.clear();
+  updateFreespaceIndex(*dsg);
+  query_index_.clear();
+  updateQueryIndex(*dsg);
   visualizer_->setGraph(dsg);
+  file_graph_ = dsg;
+  return true;
+}
+
+bool HydraVisualizer::checkPendingMesh() {
+  // the mesh belongs to the graph that is still loading
+  if (pending_graph_.valid() || !isReady(pending_mesh_)) {
+    return false;
+  }
+
+  Mesh::Ptr mesh;
+  try {
+    mesh = pending_mesh_.get();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Failed to load mesh from " << config_.mesh_filepath << ": "
+               << e.what();
+    return false;
+  }
+
+  if (!mesh || !file_graph_) {
+    return false;
+  }
+
+  ROS_INFO_STREAM("Loaded mesh: " << mesh->numVertices() << " vertices, "
+                                  << mesh->numFaces() << " faces");
+  file_graph_->setMesh(mesh);
+  return true;
 }
 
 bool HydraVisualizer::handleReload(std_srvs::Empty::Request&,
@@ -111,6 +221,102 @@ bool HydraVisualizer::handleRedraw(std_srvs::Empty::Request&,
   return true;
 }
 
+bool HydraVisualizer::handleFreespaceQuery(hydra_msgs::QueryFreespace::Request& req,
+                                           hydra_msgs::QueryFreespace::Response& res) {
+  if (req.x.size() != req.y.size() || req.x.size() != req.z.size()) {
+    ROS_ERROR_STREAM("Invalid freespace query: x, y and z sizes differ ("
+                     << req.x.size() << ", " << req.y.size() << ", " << req.z.size()
+                     << ")");
+    return false;
+  }
+
+  timing::ScopedTimer timer("visualizer/freespace_query", ros::Time::now().toNSec());
+  res.in_freespace.resize(req.x.size());
+  for (size_t i = 0; i < req.x.size(); ++i) {
+    const Eigen::Vector3d point(req.x[i], req.y[i], req.z[i]);
+    res.in_freespace[i] = freespace_index_.inFreespace(point, req.freespace_distance_m);
+  }
+
+  return true;
+}
+
+bool HydraVisualizer::handleDsgQuery(hydra_msgs::QueryDsg::Request& req,
+                                     hydra_msgs::QueryDsg::Response& res) {
+  using Request = hydra_msgs::QueryDsg::Request;
+  const auto num_queries = req.type.size();
+  // every array a query type uses has to have one entry per query
+  auto has = [num_queries](const auto& values) { return values.size() == num_queries; };
+  const bool has_point = has(req.layer) && has(req.x) && has(req.y) && has(req.z);
+
+  timing::ScopedTimer timer("visualizer/dsg_query", ros::Time::now().toNSec());
+  res.offsets.reserve(num_queries + 1);
+  res.offsets.push_back(0);
+  for (size_t i = 0; i < num_queries; ++i) {
+    switch (req.type[i]) {
+      case Request::NEAREST_WITH_LABEL: {
+        if (!has_point || !has(req.label)) {
+          ROS_ERROR_STREAM("Invalid dsg query " << i
+                                                << ": missing layer, point or label");
+          return false;
+        }
+
+        const Eigen::Vector3d point(req.x[i], req.y[i], req.z[i]);
+        const auto node =
+            query_index_.nearestWithLabel(req.layer[i], req.label[i], point);
+        if (node) {
+          res.nodes.push_back(*node);
+        }
+        break;
+      }
+      case Request::WITHIN_RADIUS: {
+        if (!has_point || !has(req.radius)) {
+          ROS_ERROR_STREAM("Invalid dsg query " << i
+                                                << ": missing layer, point or radius");
+          return false;
+        }
+
+        const Eigen::Vector3d point(req.x[i], req.y[i], req.z[i]);
+        const auto nodes =
+            query_index_.withinRadius(req.layer[i], point, req.radius[i]);
+        res.nodes.insert(res.nodes.end(), nodes.begin(), nodes.end());
+        break;
+      }
+      case Request::CHILDREN: {
+        if (!has(req.node)) {
+          ROS_ERROR_STREAM("Invalid dsg query " << i << ": missing node");
+          return false;
+        }
+
+        const auto nodes = query_index_.children(req.node[i]);
+        res.nodes.insert(res.nodes.end(), nodes.begin(), nodes.end());
+        break;
+      }
+      default:
+        ROS_ERROR_STREAM("Invalid dsg query " << i << ": unknown type "
+                                              << static_cast<int>(req.type[i]));
+        return false;
+    }
+
+    res.offsets.push_back(res.nodes.size());
+  }
+
+  return true;
+}
+
+void HydraVisualizer::updateFreespaceIndex(const DynamicSceneGraph& graph) {
+  if (!graph.hasLayer(DsgLayers::PLACES)) {
+    return;
+  }
+
+  timing::ScopedTimer timer("visualizer/freespace_update", ros::Time::now().toNSec());
+  freespace_index_.update(graph.getLayer(DsgLayers::PLACES));
+}
+
+void HydraVisualizer::updateQueryIndex(const DynamicSceneGraph& graph) {
+  timing::ScopedTimer timer("visualizer/query_update", ros::Time::now().toNSec());
+  query_index_.update(graph);
+}
+
 void HydraVisualizer::spinRos() {
   receiver_.reset(new DsgReceiver(nh_, [&](const ros::Time& stamp, size_t bytes) {
     if (size_log_file_) {
@@ -129,6 +335,8 @@ void HydraVisualizer::spinRos() {
         r.sleep();
         continue;
       }
+      updateFreespaceIndex(*receiver_->graph());
+      updateQueryIndex(*receiver_->graph());
       if (!graph_set) {
         visualizer_->setGraph(receiver_->graph());
         graph_set = true;
@@ -136,7 +344,10 @@ void HydraVisualizer::spinRos() {
         visualizer_->setGraphUpdated();
       }
 
-      visualizer_->redraw();
+      {
+        ScopedLatency latency("visualizer/redraw");
+        visualizer_->redraw();
+      }
       receiver_->clearUpdated();
     }
 
@@ -144,6 +355,66 @@ void HydraVisualizer::spinRos() {
   }
 }
 
+void HydraVisualizer::spinRosPipelined() {
+  // the receiver gets its own queue and thread so deserializing never waits on redraws
+  ros::NodeHandle receive_nh(nh_);
+  CallbackThreads receive_threads(receive_nh, 1);
+
+  auto size_callback = [&](const ros::Time& stamp, size_t bytes) {
+    if (size_log_file_) {
+      *size_log_file_ << stamp.toNSec() << "," << bytes << std::endl;
+    }
+  };
+  receiver_.reset(new DsgReceiver(receive_nh, size_callback));
+
+  bool graph_set = false;
+  ros::WallRate r(config_.render_rate_hz);
+  while (ros::ok()) {
+    ros::spinOnce();
+
+    // updates between redraws only mark the graph dirty, so it is copied at most
+    // once per redraw and the receiver never modifies what we draw
+    auto graph = receiver_->takeSnapshot();
+    if (graph) {
+      updateFreespaceIndex(*graph);
+      updateQueryIndex(*graph);
+      visualizer_->setGraph(graph, !graph_set);
+      graph_set = true;
+
+      ScopedLatency latency("visualizer/redraw");
+      visualizer_->redraw();
+    }
+
+    r.sleep();
+  }
+
+  receive_threads.stop();
+  receiver_.reset();
+}
+
+void HydraVisualizer::spinRosMultiRobot() {
+  MultiDsgReceiver receiver(nh_, config_.robot_namespaces);
+
+  bool graph_set = false;
+  ros::WallRate r(config_.render_rate_hz);
+  while (ros::ok()) {
+    ros::spinOnce();
+
+    auto graph = receiver.getUpdatedGraph();
+    if (graph) {
+      updateFreespaceIndex(*graph);
+      updateQueryIndex(*graph);
+      visualizer_->setGraph(graph, !graph_set);
+      graph_set = true;
+
+      ScopedLatency latency("visualizer/redraw");
+      visualizer_->redraw();
+    }
+
+    r.sleep();
+  }
+}
+
 void HydraVisualizer::spinFile() {
   if (config_.scene_graph_filepath.empty()) {
     LOG(ERROR) << "Scene graph filepath invalid!";
@@ -156,11 +427,16 @@ void HydraVisualizer::spinFile() {
       nh_.advertiseService("reload", &HydraVisualizer::handleReload, this);
   visualizer_->start();
 
-  // Still publish updates if they need to be e.g. redrawn.
+  // the graph only changes when a (re)load or its mesh finishes loading, so
+  // everything else only redraws for config, plugin or view changes
   ros::WallRate r(5);
   while (ros::ok()) {
     ros::spinOnce();
-    visualizer_->setGraphUpdated();
+    checkPendingGraph();
+    if (checkPendingMesh()) {
+      visualizer_->setGraphUpdated();
+    }
+
     visualizer_->redraw();
     r.sleep();
   }
@@ -184,6 +460,8 @@ void HydraVisualizer::spinZmq() {
       continue;
     }
 
+    updateFreespaceIndex(*graph);
+    updateQueryIndex(*graph);
     if (!graph_set) {
       visualizer_->setGraph(graph);
       graph_set = true;
@@ -199,6 +477,10 @@ void HydraVisualizer::spin() {
   ROS_DEBUG("Visualizer running");
   redraw_service_ =
       nh_.advertiseService("redraw", &HydraVisualizer::handleRedraw, this);
+  freespace_service_ = nh_.advertiseService(
+      "query_freespace", &HydraVisualizer::handleFreespaceQuery, this);
+  query_service_ =
+      nh_.advertiseService("query_dsg", &HydraVisualizer::handleDsgQuery, this);
 
   if (config_.load_graph) {
     spinFile();
@@ -207,6 +489,10 @@ void HydraVisualizer::spin() {
 
   if (config_.use_zmq) {
     spinZmq();
+  } else if (!config_.robot_namespaces.empty()) {
+    spinRosMultiRobot();
+  } else if (config_.pipelined) {
+    spinRosPipelined();
   } else {
     spinRos();
   }
@@ -0,0 +1,145 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/visualizer/label_lod.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+namespace hydra {
+
+namespace {
+
+inline constexpr double kPositionTolerance = 1.0e-3;
+
+struct CellHash {
+  size_t operator()(const Eigen::Vector3i& index) const {
+    return static_cast<size_t>(index.x()) * 73856093 ^
+           static_cast<size_t>(index.y()) * 19349663 ^
+           static_cast<size_t>(index.z()) * 83492791;
+  }
+};
+
+}  // namespace
+
+void declare_config(LabelLod::Config& config) {
+  using namespace config;
+  name("LabelLod::Config");
+  field(config.enable, "enable");
+  field(config.view_frame, "view_frame");
+  field(config.view_radius, "view_radius", "m");
+  field(config.min_spacing, "min_spacing", "m");
+  field(config.only_changed, "only_changed");
+  field(config.view_update_distance, "view_update_distance", "m");
+  check(config.view_update_distance, GE, 0.0, "view_update_distance");
+}
+
+LabelLod::LabelLod(const Config& config) : config(config::checkValid(config)) {}
+
+LabelLod::Result LabelLod::update(int64_t layer,
+                                  const std::vector<Label>& labels,
+                                  const std::optional<Eigen::Vector3d>& viewer) {
+  const Eigen::Vector3d center = viewer.value_or(Eigen::Vector3d::Zero());
+  const double radius_sq = config.view_radius * config.view_radius;
+  auto& prev = published_[layer];
+
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < labels.size(); ++i) {
+    if (config.view_radius > 0.0 &&
+        (labels[i].position - center).squaredNorm() > radius_sq) {
+      continue;
+    }
+
+    candidates.push_back(i);
+  }
+
+  if (config.min_spacing > 0.0) {
+    // previously drawn labels claim their cells first to avoid flickering
+    std::stable_partition(candidates.begin(), candidates.end(), [&](size_t i) {
+      return prev.count(labels[i].id) > 0;
+    });
+
+    std::unordered_set<Eigen::Vector3i, CellHash> occupied;
+    std::vector<size_t> thinned;
+    for (const auto i : candidates) {
+      const Eigen::Vector3i cell =
+          (labels[i].position / config.min_spacing).array().floor().cast<int>();
+      if (occupied.insert(cell).second) {
+        thinned.push_back(i);
+      }
+    }
+
+    candidates = std::move(thinned);
+  }
+
+  Result result;
+  std::map<uint64_t, Label> curr;
+  for (const auto i : candidates) {
+    const auto& label = labels[i];
+    result.visible.insert(label.id);
+    curr.emplace(label.id, label);
+
+    const auto iter = prev.find(label.id);
+    const bool changed =
+        iter == prev.end() || iter->second.text != label.text ||
+        (iter->second.position - label.position).norm() > kPositionTolerance;
+    if (changed || !config.only_changed) {
+      result.to_publish.push_back(i);
+    }
+  }
+
+  prev = std::move(curr);
+  return result;
+}
+
+bool LabelLod::viewerMoved(const std::optional<Eigen::Vector3d>& viewer) {
+  if (!viewer || config.view_radius <= 0.0) {
+    return false;
+  }
+
+  if (last_viewer_ && (*viewer - *last_viewer_).norm() < config.view_update_distance) {
+    return false;
+  }
+
+  last_viewer_ = viewer;
+  return true;
+}
+
+void LabelLod::reset() { published_.clear(); }
+
+}  // namespace hydra
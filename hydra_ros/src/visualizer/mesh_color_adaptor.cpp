@@ -3,6 +3,10 @@
 #include <hydra/common/semantic_color_map.h>
 #include <hydra/utils/pgmo_mesh_traits.h>
 
+#include <atomic>
+
+#include "hydra_ros/utils/parallel_for.h"
+
 namespace hydra {
 
 using spark_dsg::Color;
@@ -28,6 +32,11 @@ Color FirstSeenMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const {
   return colorFromTime(mesh.first_seen_stamps[i], min_, max_);
 }
 
+std::optional<uint64_t> FirstSeenMeshColoring::getVertexKey(const Mesh& mesh,
+                                                             size_t i) const {
+  return mesh.first_seen_stamps[i];
+}
+
 LastSeenMeshColoring::LastSeenMeshColoring(Mesh::Timestamp min, Mesh::Timestamp max)
     : min_(min), max_(max) {}
 
@@ -48,6 +57,11 @@ Color LastSeenMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const {
   return colorFromTime(mesh.stamps[i], min_, max_);
 }
 
+std::optional<uint64_t> LastSeenMeshColoring::getVertexKey(const Mesh& mesh,
+                                                            size_t i) const {
+  return mesh.stamps[i];
+}
+
 SeenDurationMeshColoring::SeenDurationMeshColoring(Mesh::Timestamp max) : max_(max) {}
 
 SeenDurationMeshColoring::SeenDurationMeshColoring(const Mesh& mesh) {
@@ -64,6 +78,11 @@ Color SeenDurationMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const
   return colorFromTime(mesh.stamps[i] - mesh.first_seen_stamps[i], 0, max_);
 }
 
+std::optional<uint64_t> SeenDurationMeshColoring::getVertexKey(const Mesh& mesh,
+                                                                size_t i) const {
+  return mesh.stamps[i] - mesh.first_seen_stamps[i];
+}
+
 SemanticMeshColoring::SemanticMeshColoring(const SemanticColorMap& colormap)
     : colormap_(colormap) {}
 
@@ -79,6 +98,47 @@ Color SemanticMeshColoring::getVertexColor(const Mesh& mesh, size_t i) const {
   return colormap_.getColorFromLabel(label);
 }
 
+std::optional<uint64_t> SemanticMeshColoring::getVertexKey(const Mesh& mesh,
+                                                            size_t i) const {
+  return mesh.has_labels ? mesh.label(i) : 0;
+}
+
+MeshColorCache::MeshColorCache(size_t num_threads)
+    : num_threads_(num_threads), num_updated_(0) {}
+
+const std::vector<Color>& MeshColorCache::update(
+    const Mesh& mesh, const MeshColoring::ConstPtr& coloring) {
+  if (coloring != coloring_) {
+    clear();
+    coloring_ = coloring;
+  }
+
+  const size_t num_cached = colors_.size();
+  colors_.resize(mesh.numVertices());
+  keys_.resize(mesh.numVertices());
+  std::atomic<size_t> num_updated(0);
+  parallelFor(colors_.size(), num_threads_, [&](size_t i) {
+    const auto key = coloring_->getVertexKey(mesh, i);
+    if (key && i < num_cached && keys_[i] == *key) {
+      return;
+    }
+
+    colors_[i] = coloring_->getVertexColor(mesh, i);
+    keys_[i] = key.value_or(0);
+    num_updated.fetch_add(1, std::memory_order_relaxed);
+  });
+
+  num_updated_ = num_updated;
+  return colors_;
+}
+
+void MeshColorCache::clear() {
+  coloring_.reset();
+  colors_.clear();
+  keys_.clear();
+  num_updated_ = 0;
+}
+
 MeshColorAdaptor::MeshColorAdaptor(const Mesh& mesh, MeshColoring::ConstPtr coloring)
     : mesh(mesh), coloring_(std::move(coloring)) {
   if (coloring_) {
@@ -90,6 +150,11 @@ MeshColorAdaptor::MeshColorAdaptor(const Mesh& mesh, MeshColoring::ConstPtr colo
   }
 }
 
+MeshColorAdaptor::MeshColorAdaptor(const Mesh& mesh, const std::vector<Color>& colors)
+    : mesh(mesh) {
+  getVertexColor = [&colors](size_t i) { return colors[i]; };
+}
+
 Eigen::Vector3f pgmoGetVertex(const MeshColorAdaptor& mesh_adaptor,
                               size_t i,
                               kimera_pgmo::traits::VertexTraits* traits) {
@@ -0,0 +1,175 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include "hydra_ros/visualizer/mesh_edge_cache.h"
+
+#include <spark_dsg/node_attributes.h>
+
+#include <algorithm>
+
+#include "hydra_ros/visualizer/polygon_cache.h"
+#include "hydra_ros/visualizer/visualizer_utilities.h"
+
+namespace hydra {
+
+using visualization_msgs::Marker;
+
+namespace {
+
+inline constexpr uint64_t kHashSeed = 0xcbf29ce484222325;
+
+template <typename T>
+inline uint64_t hashValue(uint64_t hash, const T& value) {
+  return hashCombine(hash, &value, sizeof(T));
+}
+
+uint64_t hashSettings(const LayerConfig& config,
+                      const VisualizerConfig& visualizer_config) {
+  auto hash = hashValue(kHashSeed, getZOffset(config, visualizer_config));
+  hash = hashValue(hash, visualizer_config.mesh_edge_break_ratio);
+  hash = hashValue(hash, visualizer_config.mesh_layer_offset);
+  hash = hashValue(hash, visualizer_config.collapse_layers);
+  hash = hashValue(hash, config.interlayer_edge_insertion_skip);
+  hash = hashValue(hash, config.interlayer_edge_use_color);
+  return hashValue(hash, config.interlayer_edge_alpha);
+}
+
+uint64_t hashNode(const Place2dNodeAttributes& attrs) {
+  auto hash = hashCombine(kHashSeed, attrs.position.data(), 3 * sizeof(double));
+  hash = hashValue(hash, attrs.color);
+  const auto& connections = attrs.pcl_mesh_connections;
+  return hashCombine(
+      hash, connections.data(), connections.size() * sizeof(connections[0]));
+}
+
+}  // namespace
+
+uint64_t hashMeshRevision(const spark_dsg::Mesh* mesh, size_t num_samples) {
+  auto hash = hashValue(kHashSeed, mesh);
+  if (!mesh) {
+    return hash;
+  }
+
+  const size_t num_vertices = mesh->numVertices();
+  hash = hashValue(hash, num_vertices);
+  if (!num_vertices || !num_samples) {
+    return hash;
+  }
+
+  const size_t stride = std::max<size_t>(1, num_vertices / num_samples);
+  for (size_t i = 0; i < num_vertices; i += stride) {
+    const Eigen::Vector3f pos = mesh->pos(i);
+    hash = hashCombine(hash, pos.data(), 3 * sizeof(float));
+  }
+
+  // always include the newest vertex
+  const Eigen::Vector3f last = mesh->pos(num_vertices - 1);
+  return hashCombine(hash, last.data(), 3 * sizeof(float));
+}
+
+Marker MeshEdgeCache::draw(const std_msgs::Header& header,
+                           const LayerConfig& config,
+                           const VisualizerConfig& visualizer_config,
+                           const DynamicSceneGraph& graph,
+                           const SceneGraphLayer& layer,
+                           const std::string& ns) {
+  Marker marker;
+  marker.header = header;
+  marker.type = Marker::LINE_LIST;
+  marker.action = Marker::ADD;
+  marker.id = 0;
+  marker.ns = ns;
+  marker.scale.x = config.interlayer_edge_scale;
+  marker.pose.orientation.w = 1.0;
+
+  num_rebuilt_ = 0;
+  const auto mesh = graph.mesh();
+  if (!mesh) {
+    clear();
+    return marker;
+  }
+
+  const auto mesh_revision = hashMeshRevision(mesh.get());
+  const auto settings = hashSettings(config, visualizer_config);
+  if (mesh_revision != mesh_revision_ || settings != settings_) {
+    cache_.clear();
+    mesh_revision_ = mesh_revision;
+    settings_ = settings;
+  }
+
+  ++generation_;
+  size_t num_points = 0;
+  for (const auto& [node_id, node] : layer.nodes()) {
+    const auto& attrs = node->attributes<Place2dNodeAttributes>();
+    const auto signature = hashNode(attrs);
+    auto& segments = cache_[node_id];
+    segments.generation = generation_;
+    if (segments.signature != signature || !segments.built) {
+      segments.signature = signature;
+      segments.built = true;
+      segments.points.clear();
+      segments.colors.clear();
+      appendMeshEdges(
+          attrs, *mesh, config, visualizer_config, segments.points, segments.colors);
+      ++num_rebuilt_;
+    }
+
+    num_points += segments.points.size();
+  }
+
+  for (auto iter = cache_.begin(); iter != cache_.end();) {
+    iter = iter->second.generation == generation_ ? std::next(iter)
+                                                  : cache_.erase(iter);
+  }
+
+  marker.points.reserve(num_points);
+  marker.colors.reserve(num_points);
+  for (const auto& [node_id, segments] : cache_) {
+    marker.points.insert(
+        marker.points.end(), segments.points.begin(), segments.points.end());
+    marker.colors.insert(
+        marker.colors.end(), segments.colors.begin(), segments.colors.end());
+  }
+
+  return marker;
+}
+
+void MeshEdgeCache::clear() {
+  cache_.clear();
+  mesh_revision_.reset();
+  settings_.reset();
+}
+
+}  // namespace hydra
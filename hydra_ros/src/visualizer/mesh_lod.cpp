@@ -0,0 +1,263 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/visualizer/mesh_lod.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hydra {
+
+using spark_dsg::Mesh;
+
+namespace {
+
+inline uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+  // FNV-1a
+  const auto bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+uint64_t getSignature(const Mesh& mesh, const std::vector<size_t>& faces) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (const auto face_idx : faces) {
+    const auto& face = mesh.face(face_idx);
+    hash = hashBytes(hash, face.data(), sizeof(size_t) * face.size());
+    for (const auto vertex : face) {
+      hash = hashBytes(hash, mesh.pos(vertex).data(), 3 * sizeof(float));
+    }
+  }
+  return hash;
+}
+
+inline Mesh::Face sortedFace(const Mesh::Face& face) {
+  auto sorted = face;
+  std::sort(sorted.begin(), sorted.end());
+  return sorted;
+}
+
+}  // namespace
+
+void declare_config(MeshLod::Config& config) {
+  using namespace config;
+  name("MeshLod::Config");
+  field(config.chunk_size, "chunk_size", "m");
+  field(config.voxel_size, "voxel_size", "m");
+  field(config.level_distances, "level_distances", "m");
+
+  check(config.chunk_size, GT, 0.0, "chunk_size");
+  check(config.voxel_size, GT, 0.0, "voxel_size");
+  checkCondition(
+      std::is_sorted(config.level_distances.begin(), config.level_distances.end()),
+      "level_distances must be increasing");
+}
+
+size_t MeshLod::ChunkIndexHash::operator()(const Eigen::Vector3i& index) const {
+  return static_cast<size_t>(index.x()) * 73856093 ^
+         static_cast<size_t>(index.y()) * 19349663 ^
+         static_cast<size_t>(index.z()) * 83492791;
+}
+
+MeshLod::MeshLod(const Config& config)
+    : config(config::checkValid(config)), num_changed_(0) {}
+
+Eigen::Vector3i MeshLod::getChunkIndex(const Mesh::Pos& pos) const {
+  return (pos / config.chunk_size).array().floor().cast<int>();
+}
+
+size_t MeshLod::getLevel(double distance) const {
+  const auto& distances = config.level_distances;
+  return std::upper_bound(distances.begin(), distances.end(), distance) -
+         distances.begin();
+}
+
+void MeshLod::update(const Mesh& mesh) {
+  std::unordered_map<Eigen::Vector3i, std::vector<size_t>, ChunkIndexHash> assignments;
+  for (size_t i = 0; i < mesh.numFaces(); ++i) {
+    assignments[getChunkIndex(mesh.pos(mesh.face(i)[0]))].push_back(i);
+  }
+
+  num_changed_ = 0;
+  for (auto iter = chunks_.begin(); iter != chunks_.end();) {
+    if (!assignments.count(iter->first)) {
+      iter = chunks_.erase(iter);
+      ++num_changed_;
+    } else {
+      ++iter;
+    }
+  }
+
+  for (auto&& [index, faces] : assignments) {
+    const auto signature = getSignature(mesh, faces);
+    auto& chunk = chunks_[index];
+    if (!chunk.levels.empty() && chunk.signature == signature) {
+      continue;
+    }
+
+    chunk.faces = std::move(faces);
+    chunk.signature = signature;
+    chunk.levels.clear();
+    chunk.levels.resize(config.level_distances.size() + 1);
+    ++num_changed_;
+  }
+}
+
+void MeshLod::buildLevel(const Mesh& mesh, Chunk& chunk, size_t level) const {
+  auto& result = chunk.levels.at(level);
+  result = Level();
+  result.valid = true;
+
+  // every vertex is its own cluster at full resolution
+  const bool full_resolution = level == 0;
+  const double cell_size = config.voxel_size * std::pow(2.0, level - 1.0);
+  std::unordered_map<size_t, size_t> vertex_to_cluster;
+  std::unordered_map<Eigen::Vector3i, size_t, ChunkIndexHash> cell_to_cluster;
+  std::vector<size_t> cluster_sizes;
+
+  const auto getCluster = [&](size_t vertex) -> size_t {
+    auto iter = vertex_to_cluster.find(vertex);
+    if (iter != vertex_to_cluster.end()) {
+      return iter->second;
+    }
+
+    const auto& pos = mesh.pos(vertex);
+    size_t cluster = result.points.size();
+    if (!full_resolution) {
+      const Eigen::Vector3i cell = (pos / cell_size).array().floor().cast<int>();
+      const auto cell_iter = cell_to_cluster.emplace(cell, cluster).first;
+      cluster = cell_iter->second;
+    }
+
+    if (cluster == result.points.size()) {
+      result.sources.push_back(vertex);
+      result.points.push_back(pos);
+      cluster_sizes.push_back(1);
+    } else {
+      // running mean of the cluster members
+      const auto n = ++cluster_sizes[cluster];
+      result.points[cluster] += (pos - result.points[cluster]) / n;
+    }
+
+    vertex_to_cluster.emplace(vertex, cluster);
+    return cluster;
+  };
+
+  std::vector<std::pair<Mesh::Face, Mesh::Face>> faces;
+  faces.reserve(chunk.faces.size());
+  for (const auto face_idx : chunk.faces) {
+    const auto& face = mesh.face(face_idx);
+    const Mesh::Face mapped{
+        getCluster(face[0]), getCluster(face[1]), getCluster(face[2])};
+    if (mapped[0] == mapped[1] || mapped[1] == mapped[2] || mapped[0] == mapped[2]) {
+      continue;  // collapsed
+    }
+
+    faces.emplace_back(sortedFace(mapped), mapped);
+  }
+
+  // clustering produces many copies of the same triangle at coarse levels
+  std::stable_sort(faces.begin(), faces.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (i > 0 && faces[i].first == faces[i - 1].first) {
+      continue;
+    }
+
+    result.faces.push_back(faces[i].second);
+  }
+}
+
+Mesh::Ptr MeshLod::extract(const Mesh& mesh,
+                           const Eigen::Vector3f& focus,
+                           const std::vector<spark_dsg::Color>* colors,
+                           const ChunkFilter& filter) {
+  std::vector<std::pair<Chunk*, size_t>> selected;
+  selected.reserve(chunks_.size());
+  size_t num_points = 0;
+  size_t num_faces = 0;
+  for (auto&& [index, chunk] : chunks_) {
+    // distance from the focus point to the closest point of the chunk
+    const Eigen::Vector3f lower = index.cast<float>() * config.chunk_size;
+    const Eigen::Vector3f upper = lower.array() + config.chunk_size;
+    if (filter && !filter(lower, upper)) {
+      continue;
+    }
+
+    const Eigen::Vector3f closest = focus.cwiseMax(lower).cwiseMin(upper);
+    const auto level = getLevel((closest - focus).norm());
+    if (!chunk.levels.at(level).valid) {
+      buildLevel(mesh, chunk, level);
+    }
+
+    const auto& result = chunk.levels[level];
+    num_points += result.points.size();
+    num_faces += result.faces.size();
+    selected.emplace_back(&chunk, level);
+  }
+
+  auto output = std::make_shared<Mesh>(true, false, false, false);
+  output->points.reserve(num_points);
+  output->colors.reserve(num_points);
+  output->faces.reserve(num_faces);
+  for (const auto& [chunk, level] : selected) {
+    const auto& result = chunk->levels[level];
+    const size_t offset = output->points.size();
+    for (size_t i = 0; i < result.points.size(); ++i) {
+      const auto source = result.sources[i];
+      output->points.push_back(result.points[i]);
+      if (colors) {
+        output->colors.push_back(colors->at(source));
+      } else {
+        output->colors.push_back(mesh.has_colors ? mesh.color(source)
+                                                 : spark_dsg::Color());
+      }
+    }
+
+    for (const auto& face : result.faces) {
+      output->faces.push_back({face[0] + offset, face[1] + offset, face[2] + offset});
+    }
+  }
+
+  return output;
+}
+
+}  // namespace hydra
@@ -41,6 +41,7 @@
 #include <hydra/utils/pgmo_mesh_traits.h>
 #include <kimera_pgmo_msgs/KimeraPgmoMesh.h>
 #include <kimera_pgmo_ros/conversion/ros_conversion.h>
+#include <tf2_eigen/tf2_eigen.h>
 
 #include "hydra_ros/visualizer/mesh_color_adaptor.h"
 
@@ -51,6 +52,15 @@ void declare_config(MeshPlugin::Config& config) {
   name("MeshPlugin::Config");
   field(config.label_colormap, "label_colormap");
   field(config.color_by_label, "color_by_label");
+  field(config.use_lod, "use_lod");
+  field(config.lod_focus_frame, "lod_focus_frame");
+  field(config.lod_focus_point, "lod_focus_point");
+  field(config.lod, "lod");
+  field(config.view_frustum, "view_frustum");
+  field(config.num_coloring_threads, "num_coloring_threads");
+
+  checkCondition(config.lod_focus_point.size() == 3,
+                 "lod_focus_point must have three elements");
 }
 
 MeshPlugin::MeshPlugin(const Config& config,
@@ -69,6 +79,19 @@ MeshPlugin::MeshPlugin(const Config& config,
     }
   }
 
+  color_cache_.reset(new MeshColorCache(config.num_coloring_threads));
+  if (config.use_lod) {
+    lod_.reset(new MeshLod(config.lod));
+    if (config.view_frustum.enable) {
+      frustum_.reset(new ViewFrustum(config.view_frustum));
+    }
+
+    if (!config.lod_focus_frame.empty() || frustum_) {
+      tf_buffer_.reset(new tf2_ros::Buffer());
+      tf_listener_.reset(new tf2_ros::TransformListener(*tf_buffer_));
+    }
+  }
+
   // namespacing gives us a reasonable topic
   mesh_pub_ = nh_.advertise<kimera_pgmo_msgs::KimeraPgmoMesh>("", 1, true);
 }
@@ -83,14 +106,59 @@ void MeshPlugin::draw(const ConfigManager&,
     return;
   }
 
+  // the mesh topic is latched, so an unchanged mesh never needs to be republished
+  // (view volumes depend on more than the graph, so they always redraw)
+  const bool mesh_changed = !drawn_revision_ || *drawn_revision_ != graph_revision_ ||
+                            drawn_mesh_ != mesh.get();
+  if (!mesh_changed && !need_redraw_ && !frustum_) {
+    VLOG(5) << "Skipping unchanged mesh";
+    return;
+  }
+
+  drawn_revision_ = graph_revision_;
+  drawn_mesh_ = mesh.get();
+
   const auto invalid_colormap = !colormap_ || !colormap_->isValid();
   if (color_by_label_ && invalid_colormap) {
     ROS_WARN_STREAM("Invalid colormap; defaulting to original vertex color");
   }
 
   kimera_pgmo_msgs::KimeraPgmoMesh msg;
-  if (color_by_label_ && !invalid_colormap) {
-    const MeshColorAdaptor adaptor(*mesh, mesh_coloring_);
+  const auto coloring = color_by_label_ && !invalid_colormap ? mesh_coloring_ : nullptr;
+  const std::vector<spark_dsg::Color>* colors = nullptr;
+  if (coloring) {
+    colors = &color_cache_->update(*mesh, coloring);
+    VLOG(5) << "Recolored " << color_cache_->numUpdated() << " / "
+            << mesh->numVertices() << " vertices";
+  }
+
+  if (lod_) {
+    MeshLod::ChunkFilter filter;
+    if (frustum_) {
+      frame_id_ = header.frame_id;
+      const auto view_pose = getViewPose(frame_id_);
+      if (view_pose) {
+        frustum_->setViewPose(*view_pose);
+      }
+
+      filter = [this](const Eigen::Vector3f& lower, const Eigen::Vector3f& upper) {
+        const Eigen::Vector3d center = ((lower + upper) / 2.0f).cast<double>();
+        return frustum_->contains(center, (upper - lower).norm() / 2.0);
+      };
+    }
+
+    // chunks only change with the mesh; view and color changes reuse the cached levels
+    if (mesh_changed) {
+      lod_->update(*mesh);
+    }
+
+    const auto lod_mesh = lod_->extract(*mesh, getFocusPoint(header), colors, filter);
+    VLOG(5) << "LOD mesh: " << lod_mesh->numFaces() << " / " << mesh->numFaces()
+            << " faces (" << lod_->numChanged() << " of " << lod_->numChunks()
+            << " chunks changed)";
+    msg = kimera_pgmo::conversions::toMsg(*lod_mesh);
+  } else if (colors) {
+    const MeshColorAdaptor adaptor(*mesh, *colors);
     msg = kimera_pgmo::conversions::toMsg(adaptor);
   } else {
     msg = kimera_pgmo::conversions::toMsg(*mesh);
@@ -101,18 +169,67 @@ void MeshPlugin::draw(const ConfigManager&,
 }
 
 void MeshPlugin::reset(const std_msgs::Header& header, const DynamicSceneGraph&) {
+  drawn_revision_.reset();
+  drawn_mesh_ = nullptr;
   kimera_pgmo_msgs::KimeraPgmoMesh msg;
   msg.header = header;
   msg.ns = getMsgNamespace();
   mesh_pub_.publish(msg);
 }
 
+Eigen::Vector3f MeshPlugin::getFocusPoint(const std_msgs::Header& header) const {
+  const auto& point = config.lod_focus_point;
+  const Eigen::Vector3f default_focus(point[0], point[1], point[2]);
+  if (!tf_buffer_) {
+    return default_focus;
+  }
+
+  // don't wait or spin for the transform; draw is called from the ROS callback loop
+  geometry_msgs::TransformStamped transform;
+  try {
+    const auto& focus_frame = config.lod_focus_frame;
+    transform = tf_buffer_->lookupTransform(header.frame_id, focus_frame, ros::Time());
+  } catch (const tf2::TransformException& e) {
+    VLOG(2) << "Failed to look up LOD focus frame: " << e.what();
+    return default_focus;
+  }
+
+  const auto& t = transform.transform.translation;
+  return Eigen::Vector3f(t.x, t.y, t.z);
+}
+
+std::optional<Eigen::Isometry3d> MeshPlugin::getViewPose(
+    const std::string& frame_id) const {
+  if (!tf_buffer_ || frame_id.empty()) {
+    return std::nullopt;
+  }
+
+  geometry_msgs::TransformStamped transform;
+  try {
+    const auto& view_frame = config.view_frustum.view_frame;
+    transform = tf_buffer_->lookupTransform(frame_id, view_frame, ros::Time());
+  } catch (const tf2::TransformException& e) {
+    VLOG(2) << "Failed to look up view frame: " << e.what();
+    return std::nullopt;
+  }
+
+  return tf2::transformToEigen(transform);
+}
+
 std::string MeshPlugin::getMsgNamespace() const {
   // TODO(lschmid): Hardcoded for now. Eventually read from scene graph or so.
   return "robot0/dsg_mesh";
 }
 
-bool MeshPlugin::hasChange() const { return need_redraw_; }
+bool MeshPlugin::hasChange() const {
+  if (need_redraw_) {
+    return true;
+  }
+
+  // chunks entering or leaving the view volume require republishing the mesh
+  const auto view_pose = frustum_ ? getViewPose(frame_id_) : std::nullopt;
+  return view_pose && frustum_->moved(*view_pose);
+}
 
 void MeshPlugin::clearChangeFlag() { need_redraw_ = false; }
 
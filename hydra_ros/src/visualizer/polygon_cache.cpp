@@ -0,0 +1,125 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/visualizer/polygon_cache.h"
+
+#include <glog/logging.h>
+
+#include "hydra_ros/utils/ear_clipping.h"
+
+namespace hydra {
+
+namespace {
+
+inline constexpr uint64_t kHashSeed = 0xcbf29ce484222325;
+
+inline uint64_t hashPosition(uint64_t hash, const Eigen::Vector3d& pos) {
+  return hashCombine(hash, pos.data(), 3 * sizeof(double));
+}
+
+}  // namespace
+
+uint64_t hashCombine(uint64_t hash, const void* data, size_t size) {
+  const auto bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3;
+  }
+
+  return hash;
+}
+
+uint64_t hashChildGeometry(const DynamicSceneGraph& graph,
+                           const SceneGraphNode& parent) {
+  uint64_t hash = hashPosition(kHashSeed, parent.attributes().position);
+  for (const auto child : parent.children()) {
+    hash = hashCombine(hash, &child, sizeof(NodeId));
+    hash = hashPosition(hash, graph.getPosition(child));
+  }
+
+  return hash;
+}
+
+uint64_t hashLayerGeometry(const SceneGraphLayer& layer) {
+  uint64_t hash = kHashSeed;
+  for (const auto& [id, node] : layer.nodes()) {
+    hash = hashCombine(hash, &id, sizeof(NodeId));
+    hash = hashPosition(hash, node->attributes().position);
+    for (const auto sibling : node->siblings()) {
+      hash = hashCombine(hash, &sibling, sizeof(NodeId));
+    }
+  }
+
+  return hash;
+}
+
+PolygonCache::PolygonCache(size_t num_threads) : num_threads_(num_threads) {}
+
+void PolygonCache::update(const Signatures& signatures, const BuildFunc& build) {
+  std::map<NodeId, PolygonGeometry> cache;
+  std::vector<PolygonGeometry*> changed;
+  std::vector<const Eigen::MatrixXd*> polygons;
+  for (const auto& [node, signature] : signatures) {
+    auto& entry = cache[node];
+    auto iter = cache_.find(node);
+    if (iter != cache_.end() && iter->second.signature == signature) {
+      entry = std::move(iter->second);
+      continue;
+    }
+
+    entry.signature = signature;
+    build(node, entry);
+    changed.push_back(&entry);
+    polygons.push_back(&entry.points);
+  }
+
+  auto faces = triangulatePolygons(polygons, num_threads_);
+  for (size_t i = 0; i < faces.size(); ++i) {
+    changed[i]->faces = std::move(faces[i]);
+  }
+
+  num_rebuilt_ = changed.size();
+  VLOG(2) << "[PolygonCache] Rebuilt " << num_rebuilt_ << " of " << cache.size()
+          << " polygons";
+  cache_ = std::move(cache);
+}
+
+const PolygonGeometry& PolygonCache::at(NodeId node) const { return cache_.at(node); }
+
+void PolygonCache::clear() {
+  cache_.clear();
+  num_rebuilt_ = 0;
+}
+
+}  // namespace hydra
@@ -152,9 +152,22 @@ void makeFilledPolygon(const Eigen::MatrixXd& points,
     return;
   }
 
-  auto polygon = Polygon::fromPoints(points);
-  const auto faces = polygon.triangulate();
+  makeFilledPolygon(points, triangulatePoints(points), color, marker, height);
+}
+
+void makeFilledPolygon(const Eigen::MatrixXd& points,
+                       const std::vector<std::array<size_t, 3>>& faces,
+                       const std_msgs::ColorRGBA& color,
+                       visualization_msgs::Marker& marker,
+                       std::optional<double> height) {
+  if (points.cols() <= 1 || points.rows() != 3) {
+    LOG(ERROR) << "Invalid point dimensions: [" << points.rows() << ", "
+               << points.cols() << "]";
+    return;
+  }
 
+  marker.points.reserve(marker.points.size() + 3 * faces.size());
+  marker.colors.reserve(marker.colors.size() + 3 * faces.size());
   for (const auto& face : faces) {
     for (const auto idx : face) {
       auto& point = marker.points.emplace_back();
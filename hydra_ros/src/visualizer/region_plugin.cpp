@@ -56,15 +56,19 @@ void declare_config(RegionPlugin::Config& config) {
   field(config.line_width, "line_width");
   field(config.line_alpha, "line_alpha");
   field(config.region_colormap, "region_colormap");
+  field(config.num_triangulation_threads, "num_triangulation_threads");
 
   check(config.line_width, GT, 0.0, "line_width");
   check(config.line_alpha, GT, 0.0, "line_alpha");
+  check(config.num_triangulation_threads, GT, 0, "num_triangulation_threads");
 }
 
 RegionPlugin::RegionPlugin(const Config& config,
                            const ros::NodeHandle& nh,
                            const std::string& name)
-    : DsgVisualizerPlugin(nh, name), config(config::checkValid(config)) {
+    : DsgVisualizerPlugin(nh, name),
+      config(config::checkValid(config)),
+      polygon_cache_(config.num_triangulation_threads) {
   // namespacing gives us a reasonable topic
   pub_ = nh_.advertise<visualization_msgs::MarkerArray>("", 1, true);
 }
@@ -109,16 +113,31 @@ void RegionPlugin::draw(const ConfigManager&,
   msg.markers[2].scale.z = config.line_width;
 
   const auto& regions = graph.getLayer(DsgLayers::ROOMS);
+  PolygonCache::Signatures signatures;
   for (auto&& [id, node] : regions.nodes()) {
     const auto& attrs = node->attributes<SemanticNodeAttributes>();
     if (config.skip_unknown && attrs.name == "unknown") {
       continue;
     }
+
+    signatures.emplace_back(id, hashChildGeometry(graph, *node));
+  }
+
+  polygon_cache_.update(signatures, [&](NodeId id, PolygonGeometry& geometry) {
+    const auto& node = regions.getNode(id);
+    geometry.points = getChildrenConvexHull(graph, node);
+    geometry.height = getMeanChildHeight(graph, node);
+  });
+
+  for (const auto& [id, signature] : signatures) {
+    const auto& node = regions.getNode(id);
+    const auto& attrs = node.attributes<SemanticNodeAttributes>();
     auto color = dsg_utils::makeColorMsg(attrs.color);
     color.a = config.line_alpha;
 
-    const double mean_z = getMeanChildHeight(graph, *node);
-    auto hull_points = getChildrenConvexHull(graph, *node);
+    const auto& geometry = polygon_cache_.at(id);
+    const double mean_z = geometry.height;
+    const auto& hull_points = geometry.points;
 
     if (config.draw_labels) {
       const auto& pos = attrs.position;
@@ -140,7 +159,8 @@ void RegionPlugin::draw(const ConfigManager&,
 
     auto mesh_color = color;
     mesh_color.a = config.mesh_alpha;
-    makeFilledPolygon(hull_points, mesh_color, msg.markers[0], mean_z);
+    makeFilledPolygon(
+        hull_points, geometry.faces, mesh_color, msg.markers[0], mean_z);
     makePolygonBoundary(hull_points, color, msg.markers[1], mean_z, &msg.markers[2]);
   }
 
@@ -157,6 +177,7 @@ void RegionPlugin::reset(const std_msgs::Header& header, const DynamicSceneGraph
     msg.markers.push_back(makeDeleteMarker(header, id, "region_plugin_labels"));
   }
   published_labels_.clear();
+  polygon_cache_.clear();
   pub_.publish(msg);
 }
 
@@ -0,0 +1,252 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/visualizer/view_frustum.h"
+
+#include <config_utilities/config.h>
+#include <config_utilities/validation.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace hydra {
+
+void declare_config(ViewFrustum::Config& config) {
+  using namespace config;
+  name("ViewFrustum::Config");
+  field(config.enable, "enable");
+  field(config.view_frame, "view_frame");
+  field(config.optical_frame, "optical_frame");
+  field(config.horizontal_fov, "horizontal_fov", "deg");
+  field(config.vertical_fov, "vertical_fov", "deg");
+  field(config.min_range, "min_range", "m");
+  field(config.max_range, "max_range", "m");
+  field(config.margin, "margin", "m");
+  field(config.index_resolution, "index_resolution", "m");
+  field(config.update_distance, "update_distance", "m");
+  field(config.update_angle, "update_angle", "deg");
+  check(config.horizontal_fov, GT, 0.0, "horizontal_fov");
+  check(config.horizontal_fov, LT, 180.0, "horizontal_fov");
+  check(config.vertical_fov, GT, 0.0, "vertical_fov");
+  check(config.vertical_fov, LT, 180.0, "vertical_fov");
+  check(config.min_range, GE, 0.0, "min_range");
+  checkCondition(config.max_range > config.min_range,
+                 "max_range must be larger than min_range");
+  check(config.margin, GE, 0.0, "margin");
+  check(config.index_resolution, GT, 0.0, "index_resolution");
+  check(config.update_distance, GE, 0.0, "update_distance");
+  check(config.update_angle, GE, 0.0, "update_angle");
+}
+
+size_t ViewFrustum::CellHash::operator()(const Eigen::Vector3i& index) const {
+  return static_cast<size_t>(index.x()) * 73856093 ^
+         static_cast<size_t>(index.y()) * 19349663 ^
+         static_cast<size_t>(index.z()) * 83492791;
+}
+
+ViewFrustum::ViewFrustum(const Config& config)
+    : config(config::checkValid(config)),
+      has_pose_(false),
+      world_T_view_(Eigen::Isometry3d::Identity()),
+      view_T_world_(Eigen::Isometry3d::Identity()) {
+  const double half_h = config.horizontal_fov * M_PI / 360.0;
+  const double half_v = config.vertical_fov * M_PI / 360.0;
+  cos_half_h_ = std::cos(half_h);
+  sin_half_h_ = std::sin(half_h);
+  cos_half_v_ = std::cos(half_v);
+  sin_half_v_ = std::sin(half_v);
+}
+
+bool ViewFrustum::setViewPose(const Eigen::Isometry3d& world_T_view) {
+  if (!moved(world_T_view)) {
+    return false;
+  }
+
+  has_pose_ = true;
+  world_T_view_ = world_T_view;
+  view_T_world_ = world_T_view.inverse();
+  return true;
+}
+
+bool ViewFrustum::moved(const Eigen::Isometry3d& world_T_view) const {
+  if (!has_pose_) {
+    return true;
+  }
+
+  const double dist = (world_T_view.translation() - world_T_view_.translation()).norm();
+  const Eigen::AngleAxisd rotation(world_T_view_.linear().transpose() *
+                                   world_T_view.linear());
+  const double angle = rotation.angle() * 180.0 / M_PI;
+  return dist > config.update_distance || angle > config.update_angle;
+}
+
+bool ViewFrustum::contains(const Eigen::Vector3d& point, double radius) const {
+  if (!has_pose_) {
+    return true;
+  }
+
+  const Eigen::Vector3d p = view_T_world_ * point;
+  const double forward = config.optical_frame ? p.z() : p.x();
+  const double lateral = std::abs(config.optical_frame ? p.x() : p.y());
+  const double vertical = std::abs(config.optical_frame ? p.y() : p.z());
+  const double pad = config.margin + radius;
+  if (forward < config.min_range - pad || forward > config.max_range + pad) {
+    return false;
+  }
+
+  // signed distance to the side planes of the pyramid
+  if (lateral * cos_half_h_ - forward * sin_half_h_ > pad) {
+    return false;
+  }
+
+  return vertical * cos_half_v_ - forward * sin_half_v_ <= pad;
+}
+
+void ViewFrustum::update(LayerId layer_id,
+                         const SceneGraphLayer& layer,
+                         double z_offset) {
+  std::unordered_set<NodeId> seen;
+  for (const auto& id_node_pair : layer.nodes()) {
+    Eigen::Vector3d position = id_node_pair.second->attributes().position;
+    position.z() += z_offset;
+    updateNode(layer_id, id_node_pair.first, position);
+    seen.insert(id_node_pair.first);
+  }
+
+  auto& index = layers_[layer_id];
+  if (seen.size() == index.positions.size()) {
+    return;
+  }
+
+  std::vector<NodeId> to_remove;
+  for (const auto& id_pos_pair : index.positions) {
+    if (!seen.count(id_pos_pair.first)) {
+      to_remove.push_back(id_pos_pair.first);
+    }
+  }
+
+  for (const auto node : to_remove) {
+    removeNode(layer_id, node);
+  }
+}
+
+void ViewFrustum::updateNode(LayerId layer_id,
+                             NodeId node,
+                             const Eigen::Vector3d& position) {
+  auto& index = layers_[layer_id];
+  auto iter = index.positions.find(node);
+  if (iter != index.positions.end()) {
+    if (toIndex(iter->second) == toIndex(position)) {
+      iter->second = position;
+      return;
+    }
+
+    eraseFromCell(index, node, iter->second);
+    iter->second = position;
+  } else {
+    index.positions.emplace(node, position);
+  }
+
+  index.cells[toIndex(position)].push_back(node);
+}
+
+void ViewFrustum::removeNode(LayerId layer_id, NodeId node) {
+  auto layer = layers_.find(layer_id);
+  if (layer == layers_.end()) {
+    return;
+  }
+
+  auto& index = layer->second;
+  auto iter = index.positions.find(node);
+  if (iter == index.positions.end()) {
+    return;
+  }
+
+  eraseFromCell(index, node, iter->second);
+  index.positions.erase(iter);
+}
+
+std::unordered_set<NodeId> ViewFrustum::getVisible(LayerId layer_id) const {
+  std::unordered_set<NodeId> visible;
+  auto layer = layers_.find(layer_id);
+  if (layer == layers_.end()) {
+    return visible;
+  }
+
+  const auto& index = layer->second;
+  const double cell_radius = std::sqrt(3.0) * config.index_resolution / 2.0;
+  for (const auto& [cell, nodes] : index.cells) {
+    const Eigen::Vector3d center =
+        (cell.cast<double>().array() + 0.5) * config.index_resolution;
+    if (!contains(center, cell_radius)) {
+      continue;
+    }
+
+    for (const auto node : nodes) {
+      if (contains(index.positions.at(node))) {
+        visible.insert(node);
+      }
+    }
+  }
+
+  return visible;
+}
+
+void ViewFrustum::clear() { layers_.clear(); }
+
+Eigen::Vector3i ViewFrustum::toIndex(const Eigen::Vector3d& position) const {
+  return (position / config.index_resolution).array().floor().cast<int>();
+}
+
+void ViewFrustum::eraseFromCell(LayerIndex& index,
+                                NodeId node,
+                                const Eigen::Vector3d& position) {
+  auto cell = index.cells.find(toIndex(position));
+  if (cell == index.cells.end()) {
+    return;
+  }
+
+  auto& nodes = cell->second;
+  auto iter = std::find(nodes.begin(), nodes.end(), node);
+  if (iter != nodes.end()) {
+    *iter = nodes.back();
+    nodes.pop_back();
+  }
+
+  if (nodes.empty()) {
+    index.cells.erase(cell);
+  }
+}
+
+}  // namespace hydra
@@ -37,9 +37,11 @@
 #include <spark_dsg/node_attributes.h>
 #include <tf2_eigen/tf2_eigen.h>
 
+#include <optional>
 #include <random>
 
 #include "hydra_ros/visualizer/colormap_utilities.h"
+#include "hydra_ros/visualizer/edge_marker_builder.h"
 
 namespace hydra {
 
@@ -63,6 +65,42 @@ inline void fillPoseWithIdentity(geometry_msgs::Pose& pose) {
   tf2::convert(Eigen::Quaterniond::Identity(), pose.orientation);
 }
 
+// triangles of a unit sphere (three vertices per triangle) used to draw ellipsoids
+const std::vector<Eigen::Vector3d>& getUnitSphereTriangles() {
+  static const auto triangles = []() {
+    constexpr size_t num_rings = 6;
+    constexpr size_t num_segments = 10;
+    const auto vertex = [&](size_t ring, size_t segment) -> Eigen::Vector3d {
+      const double theta = M_PI * ring / num_rings;
+      const double phi = 2.0 * M_PI * segment / num_segments;
+      return {std::sin(theta) * std::cos(phi),
+              std::sin(theta) * std::sin(phi),
+              std::cos(theta)};
+    };
+
+    std::vector<Eigen::Vector3d> vertices;
+    for (size_t r = 0; r < num_rings; ++r) {
+      for (size_t s = 0; s < num_segments; ++s) {
+        const auto top_left = vertex(r, s);
+        const auto top_right = vertex(r, s + 1);
+        const auto bottom_left = vertex(r + 1, s);
+        const auto bottom_right = vertex(r + 1, s + 1);
+        if (r > 0) {
+          vertices.insert(vertices.end(), {top_left, bottom_left, top_right});
+        }
+
+        if (r + 1 < num_rings) {
+          vertices.insert(vertices.end(), {top_right, bottom_left, bottom_right});
+        }
+      }
+    }
+
+    return vertices;
+  }();
+
+  return triangles;
+}
+
 }  // namespace
 
 Color getDistanceColor(const VisualizerConfig& config,
@@ -476,7 +514,8 @@ std::vector<Marker> makeEllipsoidMarkers(const std_msgs::Header& header,
                                          const SceneGraphLayer& layer,
                                          const VisualizerConfig& visualizer_config,
                                          const std::string& ns,
-                                         const ColorFunction& color_func) {
+                                         const ColorFunction& color_func,
+                                         const FilterFunction& filter) {
   size_t id = 0;
   std::vector<Marker> markers;
   for (const auto& id_node_pair : layer.nodes()) {
@@ -484,6 +523,13 @@ std::vector<Marker> makeEllipsoidMarkers(const std_msgs::Header& header,
     if (attrs.real_place) {
       continue;
     }
+
+    // ids follow the frontier order, so filtered frontiers have to be removed
+    if (filter && !filter(*id_node_pair.second)) {
+      markers.push_back(makeDeleteMarker(header, id++, ns));
+      continue;
+    }
+
     Marker marker;
     marker.header = header;
     marker.type = Marker::SPHERE;
@@ -500,14 +546,97 @@ std::vector<Marker> makeEllipsoidMarkers(const std_msgs::Header& header,
 
     marker.pose.position.z += getZOffset(config, visualizer_config);
     marker.color = makeColorMsg(color_func(*id_node_pair.second), config.marker_alpha);
-
-    Color desired_color = color_func(*id_node_pair.second);
-    marker.colors.push_back(makeColorMsg(desired_color, config.marker_alpha));
+    marker.colors.push_back(marker.color);
     markers.push_back(marker);
   }
   return markers;
 }
 
+Marker makeEllipsoidListMarker(const std_msgs::Header& header,
+                               const LayerConfig& config,
+                               const SceneGraphLayer& layer,
+                               const VisualizerConfig& visualizer_config,
+                               const std::string& ns,
+                               const ColorFunction& color_func,
+                               const FilterFunction& filter) {
+  Marker marker;
+  marker.header = header;
+  marker.action = visualization_msgs::Marker::ADD;
+  marker.id = 0;
+  marker.ns = ns;
+  fillPoseWithIdentity(marker.pose);
+  marker.pose.position.z += getZOffset(config, visualizer_config);
+
+  std::vector<const SceneGraphNode*> frontiers;
+  frontiers.reserve(layer.numNodes());
+  bool same_spheres = true;
+  std::optional<Eigen::Vector3d> first_scale;
+  for (const auto& id_node_pair : layer.nodes()) {
+    const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
+    if (attrs.real_place || (filter && !filter(*id_node_pair.second))) {
+      continue;
+    }
+
+    frontiers.push_back(id_node_pair.second.get());
+    const Eigen::Vector3d scale = attrs.frontier_scale.cast<double>();
+    if (!first_scale) {
+      first_scale = scale;
+    }
+
+    // a sphere list only has a single scale for every point
+    same_spheres &= scale.isApprox(*first_scale) &&
+                    std::abs(scale.x() - scale.y()) <= 1.0e-6 * scale.norm() &&
+                    std::abs(scale.x() - scale.z()) <= 1.0e-6 * scale.norm();
+  }
+
+  if (frontiers.empty()) {
+    marker.type = Marker::SPHERE_LIST;
+    return marker;
+  }
+
+  if (same_spheres) {
+    marker.type = Marker::SPHERE_LIST;
+    marker.scale.x = first_scale->x();
+    marker.scale.y = first_scale->x();
+    marker.scale.z = first_scale->x();
+    marker.points.resize(frontiers.size());
+    marker.colors.resize(frontiers.size());
+    for (size_t i = 0; i < frontiers.size(); ++i) {
+      const auto& attrs = frontiers[i]->attributes<PlaceNodeAttributes>();
+      tf2::convert(attrs.position, marker.points[i]);
+      marker.colors[i] = makeColorMsg(color_func(*frontiers[i]), config.marker_alpha);
+    }
+
+    return marker;
+  }
+
+  marker.type = Marker::TRIANGLE_LIST;
+  marker.scale.x = 1.0;
+  marker.scale.y = 1.0;
+  marker.scale.z = 1.0;
+
+  const auto& sphere = getUnitSphereTriangles();
+  marker.points.resize(frontiers.size() * sphere.size());
+  marker.colors.resize(frontiers.size() * sphere.size());
+  size_t index = 0;
+  for (const auto node : frontiers) {
+    const auto& attrs = node->attributes<PlaceNodeAttributes>();
+    // marker scales are diameters, so the semi-axes are half the frontier scale
+    const Eigen::Matrix3d transform =
+        attrs.orientation.cast<double>().toRotationMatrix() *
+        (0.5 * attrs.frontier_scale.cast<double>()).asDiagonal();
+    const auto color = makeColorMsg(color_func(*node), config.marker_alpha);
+    for (const auto& vertex : sphere) {
+      const Eigen::Vector3d point = transform * vertex + attrs.position;
+      tf2::convert(point, marker.points[index]);
+      marker.colors[index] = color;
+      ++index;
+    }
+  }
+
+  return marker;
+}
+
 Marker makeCentroidMarkers(const std_msgs::Header& header,
                            const LayerConfig& config,
                            const SceneGraphLayer& layer,
@@ -552,7 +681,8 @@ Marker makePlaceCentroidMarkers(const std_msgs::Header& header,
                                 const SceneGraphLayer& layer,
                                 const VisualizerConfig& visualizer_config,
                                 const std::string& ns,
-                                const ColorFunction& color_func) {
+                                const ColorFunction& color_func,
+                                const FilterFunction& filter) {
   Marker marker;
   marker.header = header;
   marker.type = config.use_sphere_marker ? Marker::SPHERE_LIST : Marker::CUBE_LIST;
@@ -570,9 +700,10 @@ Marker makePlaceCentroidMarkers(const std_msgs::Header& header,
   marker.colors.reserve(layer.numNodes());
   for (const auto& id_node_pair : layer.nodes()) {
     const auto& attrs = id_node_pair.second->attributes<PlaceNodeAttributes>();
-    if (!attrs.real_place) {
+    if (!attrs.real_place || (filter && !filter(*id_node_pair.second))) {
       continue;
     }
+
     geometry_msgs::Point node_centroid;
     tf2::convert(attrs.position, node_centroid);
     node_centroid.z += getZOffset(config, visualizer_config);
@@ -585,49 +716,6 @@ Marker makePlaceCentroidMarkers(const std_msgs::Header& header,
   return marker;
 }
 
-namespace {
-
-inline Marker makeNewEdgeList(const std_msgs::Header& header,
-                              const LayerConfig& config,
-                              const std::string& ns_prefix,
-                              LayerId source,
-                              LayerId target) {
-  Marker marker;
-  marker.header = header;
-  marker.type = Marker::LINE_LIST;
-  marker.action = Marker::ADD;
-  marker.id = 0;
-  marker.ns = ns_prefix + std::to_string(source) + "_" + std::to_string(target);
-  marker.scale.x = config.interlayer_edge_scale;
-  fillPoseWithIdentity(marker.pose);
-  return marker;
-}
-
-}  // namespace
-
-bool shouldVisualize(const DynamicSceneGraph& graph,
-                     const SceneGraphNode& node,
-                     const std::map<LayerId, LayerConfig>& configs,
-                     const std::map<LayerId, DynamicLayerConfig>& dynamic_configs) {
-  if (graph.isDynamic(node.id)) {
-    return dynamic_configs.count(node.layer) &&
-           dynamic_configs.at(node.layer).visualize &&
-           dynamic_configs.at(node.layer).visualize_interlayer_edges;
-  }
-
-  return configs.count(node.layer) && configs.at(node.layer).visualize;
-}
-
-LayerId getConfigLayer(const DynamicSceneGraph& graph,
-                       const SceneGraphNode& source,
-                       const SceneGraphNode& target) {
-  if (graph.isDynamic(source.id)) {
-    return source.layer;
-  } else {
-    return target.layer;
-  }
-}
-
 MarkerArray makeDynamicGraphEdgeMarkers(
     const std_msgs::Header& header,
     const DynamicSceneGraph& graph,
@@ -635,149 +723,75 @@ MarkerArray makeDynamicGraphEdgeMarkers(
     const std::map<LayerId, DynamicLayerConfig>& dynamic_configs,
     const VisualizerConfig& visualizer_config,
     const std::string& ns_prefix) {
-  MarkerArray layer_edges;
-  std::map<LayerId, Marker> layer_markers;
-  std::map<LayerId, size_t> num_since_last_insertion;
-
-  for (const auto& edge : graph.dynamic_interlayer_edges()) {
-    const auto& source = graph.getNode(edge.second.source);
-    const auto& target = graph.getNode(edge.second.target);
-
-    if (!shouldVisualize(graph, source, configs, dynamic_configs)) {
-      continue;
-    }
-
-    if (!shouldVisualize(graph, target, configs, dynamic_configs)) {
-      continue;
-    }
-
-    DynamicLayerConfig config =
-        dynamic_configs.at(getConfigLayer(graph, source, target));
-
-    size_t num_between_insertions = config.interlayer_edge_insertion_skip;
-
-    if (layer_markers.count(source.layer) == 0) {
-      layer_markers[source.layer] = makeNewEdgeList(
-          header, configs.at(source.layer), ns_prefix, source.layer, target.layer);
-      layer_markers[source.layer].color =
-          makeColorMsg(Color(), config.edge_alpha);
-      // make sure we always draw at least one edge
-      num_since_last_insertion[source.layer] = num_between_insertions;
-    }
-
-    if (num_since_last_insertion[source.layer] >= num_between_insertions) {
-      num_since_last_insertion[source.layer] = 0;
-    } else {
-      num_since_last_insertion[source.layer]++;
-      continue;
-    }
-
-    Marker& marker = layer_markers.at(source.layer);
-    geometry_msgs::Point source_point;
-    tf2::convert(source.attributes().position, source_point);
-    source_point.z += getZOffset(configs.at(source.layer), visualizer_config);
-    marker.points.push_back(source_point);
-
-    geometry_msgs::Point target_point;
-    tf2::convert(target.attributes().position, target_point);
-    target_point.z += getZOffset(configs.at(target.layer), visualizer_config);
-    marker.points.push_back(target_point);
-  }
-
-  for (const auto& id_marker_pair : layer_markers) {
-    layer_edges.markers.push_back(id_marker_pair.second);
-  }
-  return layer_edges;
+  EdgeMarkerBuilder builder;
+  return builder.makeDynamicGraphEdgeMarkers(
+      header, graph, configs, dynamic_configs, visualizer_config, ns_prefix);
 }
 
-// TODO(nathan) consider making this shorter
 MarkerArray makeGraphEdgeMarkers(const std_msgs::Header& header,
                                  const DynamicSceneGraph& graph,
                                  const std::map<LayerId, LayerConfig>& configs,
                                  const VisualizerConfig& visualizer_config,
                                  const std::string& ns_prefix,
                                  const FilterFunction& filter) {
-  MarkerArray layer_edges;
-  std::map<LayerId, Marker> layer_markers;
-  std::map<LayerId, size_t> num_since_last_insertion;
-
-  for (const auto& edge : graph.interlayer_edges()) {
-    const auto& source = graph.getNode(edge.second.source);
-    const auto& target = graph.getNode(edge.second.target);
-
-    if (filter && !filter(source)) {
-      continue;
-    }
-
-    if (filter && !filter(target)) {
-      continue;
-    }
-
-    if (!configs.count(source.layer) || !configs.count(target.layer)) {
-      continue;
-    }
+  EdgeMarkerBuilder builder;
+  return builder.makeGraphEdgeMarkers(
+      header, graph, configs, visualizer_config, ns_prefix, filter);
+}
 
-    if (!configs.at(source.layer).visualize) {
-      continue;
-    }
+void appendMeshEdges(const Place2dNodeAttributes& attrs,
+                     const spark_dsg::Mesh& mesh,
+                     const LayerConfig& config,
+                     const VisualizerConfig& visualizer_config,
+                     std::vector<geometry_msgs::Point>& points,
+                     std::vector<std_msgs::ColorRGBA>& colors) {
+  const auto& mesh_edge_indices = attrs.pcl_mesh_connections;
+  if (mesh_edge_indices.empty()) {
+    return;
+  }
 
-    if (!configs.at(target.layer).visualize) {
+  geometry_msgs::Point center_point;
+  tf2::convert(attrs.position, center_point);
+  center_point.z +=
+      visualizer_config.mesh_edge_break_ratio * getZOffset(config, visualizer_config);
+
+  geometry_msgs::Point centroid_location;
+  tf2::convert(attrs.position, centroid_location);
+  centroid_location.z += getZOffset(config, visualizer_config);
+
+  const auto color =
+      makeColorMsg(config.interlayer_edge_use_color ? attrs.color : Color(),
+                   config.interlayer_edge_alpha);
+
+  // make first edge
+  points.push_back(centroid_location);
+  points.push_back(center_point);
+  colors.push_back(color);
+  colors.push_back(color);
+
+  size_t i = 0;
+  for (const auto midx : mesh_edge_indices) {
+    ++i;
+    if ((i - 1) % (config.interlayer_edge_insertion_skip + 1) != 0) {
       continue;
     }
 
-    size_t num_between_insertions =
-        configs.at(source.layer).interlayer_edge_insertion_skip;
-
-    // parent is always source
-    // TODO(nathan) make the above statement an invariant
-    if (layer_markers.count(source.layer) == 0) {
-      layer_markers[source.layer] = makeNewEdgeList(
-          header, configs.at(source.layer), ns_prefix, source.layer, target.layer);
-      // make sure we always draw at least one edge
-      num_since_last_insertion[source.layer] = num_between_insertions;
-    }
-
-    if (num_since_last_insertion[source.layer] >= num_between_insertions) {
-      num_since_last_insertion[source.layer] = 0;
-    } else {
-      num_since_last_insertion[source.layer]++;
+    if (midx >= mesh.numVertices()) {
       continue;
     }
 
-    Marker& marker = layer_markers.at(source.layer);
-    geometry_msgs::Point source_point;
-    tf2::convert(source.attributes().position, source_point);
-    source_point.z += getZOffset(configs.at(source.layer), visualizer_config);
-    marker.points.push_back(source_point);
-
-    geometry_msgs::Point target_point;
-    tf2::convert(target.attributes().position, target_point);
-    target_point.z += getZOffset(configs.at(target.layer), visualizer_config);
-    marker.points.push_back(target_point);
-
-    Color edge_color;
-    if (configs.at(source.layer).interlayer_edge_use_color) {
-      if (configs.at(source.layer).use_edge_source) {
-        // TODO(nathan) this might not be a safe cast in general
-        edge_color = source.attributes<SemanticNodeAttributes>().color;
-      } else {
-        // TODO(nathan) this might not be a safe cast in general
-        edge_color = target.attributes<SemanticNodeAttributes>().color;
-      }
-    } else {
-      edge_color = Color();
+    Eigen::Vector3d vertex_pos = mesh.pos(midx).cast<double>();
+    geometry_msgs::Point vertex;
+    tf2::convert(vertex_pos, vertex);
+    if (!visualizer_config.collapse_layers) {
+      vertex.z += visualizer_config.mesh_layer_offset;
     }
 
-    marker.colors.push_back(
-        makeColorMsg(edge_color, configs.at(source.layer).intralayer_edge_alpha));
-    marker.colors.push_back(
-        makeColorMsg(edge_color, configs.at(source.layer).intralayer_edge_alpha));
+    points.push_back(center_point);
+    points.push_back(vertex);
+    colors.push_back(color);
+    colors.push_back(color);
   }
-
-  for (const auto& id_marker_pair : layer_markers) {
-    layer_edges.markers.push_back(id_marker_pair.second);
-  }
-  return layer_edges;
 }
 
 Marker makeMeshEdgesMarker(const std_msgs::Header& header,
@@ -802,68 +816,9 @@ Marker makeMeshEdgesMarker(const std_msgs::Header& header,
   }
 
   for (const auto& id_node_pair : layer.nodes()) {
-    const auto& node = *id_node_pair.second;
-    const auto& attrs = node.attributes<Place2dNodeAttributes>();
-    const auto& mesh_edge_indices = attrs.pcl_mesh_connections;
-    if (mesh_edge_indices.empty()) {
-      continue;
-    }
-
-    geometry_msgs::Point center_point;
-    tf2::convert(attrs.position, center_point);
-    center_point.z +=
-        visualizer_config.mesh_edge_break_ratio * getZOffset(config, visualizer_config);
-
-    geometry_msgs::Point centroid_location;
-    tf2::convert(attrs.position, centroid_location);
-    centroid_location.z += getZOffset(config, visualizer_config);
-
-    // make first edge
-    marker.points.push_back(centroid_location);
-    marker.points.push_back(center_point);
-    if (config.interlayer_edge_use_color) {
-      marker.colors.push_back(makeColorMsg(attrs.color, config.interlayer_edge_alpha));
-      marker.colors.push_back(makeColorMsg(attrs.color, config.interlayer_edge_alpha));
-    } else {
-      marker.colors.push_back(
-          makeColorMsg(Color(), config.interlayer_edge_alpha));
-      marker.colors.push_back(
-          makeColorMsg(Color(), config.interlayer_edge_alpha));
-    }
-
-    size_t i = 0;
-    for (const auto midx : mesh_edge_indices) {
-      ++i;
-      if ((i - 1) % (config.interlayer_edge_insertion_skip + 1) != 0) {
-        continue;
-      }
-
-      if (midx >= mesh->numVertices()) {
-        continue;
-      }
-
-      Eigen::Vector3d vertex_pos = mesh->pos(midx).cast<double>();
-      geometry_msgs::Point vertex;
-      tf2::convert(vertex_pos, vertex);
-      if (!visualizer_config.collapse_layers) {
-        vertex.z += visualizer_config.mesh_layer_offset;
-      }
-
-      marker.points.push_back(center_point);
-      marker.points.push_back(vertex);
-
-      if (config.interlayer_edge_use_color) {
-        marker.colors.push_back(
-            makeColorMsg(attrs.color, config.interlayer_edge_alpha));
-        marker.colors.push_back(
-            makeColorMsg(attrs.color, config.interlayer_edge_alpha));
-      } else {
-        marker.colors.push_back(
-            makeColorMsg(Color(), config.interlayer_edge_alpha));
-        marker.colors.push_back(
-            makeColorMsg(Color(), config.interlayer_edge_alpha));
-      }
-    }
+    const auto& attrs = id_node_pair.second->attributes<Place2dNodeAttributes>();
+    appendMeshEdges(
+        attrs, *mesh, config, visualizer_config, marker.points, marker.colors);
   }
 
   return marker;
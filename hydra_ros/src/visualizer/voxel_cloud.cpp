@@ -0,0 +1,113 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include "hydra_ros/visualizer/voxel_cloud.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace hydra {
+
+namespace {
+
+inline sensor_msgs::PointField makeField(const std::string& name, uint32_t offset) {
+  sensor_msgs::PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = sensor_msgs::PointField::FLOAT32;
+  field.count = 1;
+  return field;
+}
+
+inline uint8_t toByte(float value) {
+  return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+}  // namespace
+
+void initColoredCloud(size_t num_points, sensor_msgs::PointCloud2& cloud) {
+  constexpr uint32_t point_step = 4 * sizeof(float);
+
+  cloud.height = 1;
+  cloud.width = num_points;
+  cloud.fields = {makeField("x", 0),
+                  makeField("y", sizeof(float)),
+                  makeField("z", 2 * sizeof(float)),
+                  makeField("rgb", 3 * sizeof(float))};
+  cloud.is_bigendian = false;
+  cloud.point_step = point_step;
+  cloud.row_step = point_step * cloud.width;
+  cloud.is_dense = true;
+  cloud.data.resize(cloud.row_step);
+}
+
+void setColoredPoint(sensor_msgs::PointCloud2& cloud,
+                     size_t index,
+                     float x,
+                     float y,
+                     float z,
+                     uint8_t r,
+                     uint8_t g,
+                     uint8_t b) {
+  uint8_t* data = cloud.data.data() + index * cloud.point_step;
+  const float xyz[3] = {x, y, z};
+  std::memcpy(data, xyz, sizeof(xyz));
+  const uint32_t rgb = (static_cast<uint32_t>(r) << 16) |
+                       (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b);
+  std::memcpy(data + sizeof(xyz), &rgb, sizeof(rgb));
+}
+
+sensor_msgs::PointCloud2 makeVoxelCloud(const visualization_msgs::Marker& marker) {
+  sensor_msgs::PointCloud2 cloud;
+  cloud.header = marker.header;
+  initColoredCloud(marker.points.size(), cloud);
+
+  const bool has_colors = marker.colors.size() == marker.points.size();
+  for (size_t i = 0; i < marker.points.size(); ++i) {
+    const auto& point = marker.points[i];
+    uint8_t r = 255, g = 255, b = 255;
+    if (has_colors) {
+      const auto& color = marker.colors[i];
+      r = toByte(color.r);
+      g = toByte(color.g);
+      b = toByte(color.b);
+    }
+
+    setColoredPoint(cloud, i, point.x, point.y, point.z, r, g, b);
+  }
+
+  return cloud;
+}
+
+}  // namespace hydra
@@ -0,0 +1,104 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/backpressure.h>
+
+#include <atomic>
+#include <thread>
+
+namespace hydra {
+
+namespace {
+
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+}  // namespace
+
+TEST(Backpressure, NoWaitWithRoom) {
+  size_t size = 1;
+  Backpressure backpressure([&]() { return size; }, 2, std::chrono::seconds(30));
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(backpressure.wait());
+  EXPECT_LT(secondsSince(start), 1.0);
+}
+
+TEST(Backpressure, NotifyWakesProducer) {
+  std::atomic<size_t> size(2);
+  // the recheck period is long enough that only the notification can release it
+  Backpressure backpressure([&]() { return size.load(); }, 2, std::chrono::seconds(30));
+
+  const auto start = std::chrono::steady_clock::now();
+  std::atomic<bool> released(false);
+  std::thread producer([&]() {
+    EXPECT_TRUE(backpressure.wait());
+    released = true;
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(released);
+  size = 1;
+  backpressure.notify();
+  producer.join();
+  EXPECT_TRUE(released);
+  EXPECT_LT(secondsSince(start), 5.0);
+}
+
+TEST(Backpressure, RecheckWithoutNotify) {
+  std::atomic<size_t> size(2);
+  Backpressure backpressure(
+      [&]() { return size.load(); }, 2, std::chrono::milliseconds(1));
+  std::thread producer([&]() { EXPECT_TRUE(backpressure.wait()); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  size = 0;
+  producer.join();
+}
+
+TEST(Backpressure, StopReleasesProducer) {
+  Backpressure backpressure([]() { return 5; }, 2, std::chrono::seconds(30));
+  bool result = true;
+  std::thread producer([&]() { result = backpressure.wait(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  backpressure.stop();
+  producer.join();
+  EXPECT_FALSE(result);
+  EXPECT_FALSE(backpressure.wait());
+}
+
+}  // namespace hydra
@@ -0,0 +1,195 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/bag_metadata.h>
+#include <rosbag/bag.h>
+#include <tf2_msgs/TFMessage.h>
+
+#include <thread>
+
+namespace hydra {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+geometry_msgs::TransformStamped makeTransform(double stamp,
+                                              const std::string& child,
+                                              double x) {
+  geometry_msgs::TransformStamped tf;
+  tf.header.stamp.fromSec(stamp);
+  tf.header.frame_id = "world";
+  tf.child_frame_id = child;
+  tf.transform.translation.x = x;
+  tf.transform.rotation.w = 1.0;
+  return tf;
+}
+
+fs::path writeBag(const fs::path& dir) {
+  fs::create_directories(dir);
+  const auto bag_path = dir / "test.bag";
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Write);
+
+  tf2_msgs::TFMessage static_msg;
+  static_msg.transforms.push_back(makeTransform(1.0, "base", 0.5));
+  bag.write("/tf_static", ros::Time(1.0), static_msg);
+
+  for (int i = 0; i < 3; ++i) {
+    tf2_msgs::TFMessage msg;
+    msg.transforms.push_back(makeTransform(1.0 + i, "body", i));
+    bag.write("/tf", ros::Time(1.0 + i), msg);
+  }
+
+  sensor_msgs::CameraInfo info;
+  info.width = 640;
+  info.height = 480;
+  bag.write("/camera/info", ros::Time(1.5), info);
+  info.width = 320;
+  bag.write("/camera/info", ros::Time(2.5), info);
+  bag.close();
+  return bag_path;
+}
+
+void expectEqual(const BagMetadata& lhs, const BagMetadata& rhs) {
+  EXPECT_EQ(lhs.tf_begin, rhs.tf_begin);
+  EXPECT_EQ(lhs.tf_end, rhs.tf_end);
+  EXPECT_EQ(lhs.transforms, rhs.transforms);
+  EXPECT_EQ(lhs.static_transforms, rhs.static_transforms);
+  EXPECT_EQ(lhs.camera_infos, rhs.camera_infos);
+}
+
+}  // namespace
+
+TEST(BagMetadata, ExtractsMetadata) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_bag_metadata";
+  const auto bag_path = writeBag(dir);
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+  const BagMetadata metadata(bag);
+
+  EXPECT_EQ(metadata.transforms.size(), 3u);
+  EXPECT_EQ(metadata.static_transforms.size(), 1u);
+  EXPECT_EQ(metadata.tf_begin, ros::Time(1.0));
+  EXPECT_EQ(metadata.tf_end, ros::Time(3.0));
+  ASSERT_TRUE(metadata.cameraInfo("/camera/info"));
+  EXPECT_EQ(metadata.cameraInfo("/camera/info")->width, 640u);
+  EXPECT_FALSE(metadata.cameraInfo("/other/info"));
+  fs::remove_all(dir);
+}
+
+TEST(BagMetadata, SaveLoadRoundTrip) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_bag_metadata_io";
+  const auto bag_path = writeBag(dir);
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+  const BagMetadata metadata(bag);
+
+  const auto cache_path = dir / "test.metadata";
+  ASSERT_TRUE(metadata.save(cache_path));
+  const auto loaded = BagMetadata::load(cache_path);
+  ASSERT_TRUE(loaded);
+  expectEqual(*loaded, metadata);
+
+  // truncated files are rejected instead of partially loaded
+  fs::resize_file(cache_path, fs::file_size(cache_path) - 4);
+  EXPECT_FALSE(BagMetadata::load(cache_path));
+  EXPECT_FALSE(BagMetadata::load(dir / "missing.metadata"));
+  fs::remove_all(dir);
+}
+
+TEST(BagMetadata, CachesInDirectory) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_bag_metadata_cache";
+  const auto cache_dir = dir / "cache";
+  const auto bag_path = writeBag(dir);
+  BagMetadata::clearLoaded();
+
+  // nothing is written without a cache directory
+  auto metadata = BagMetadata::get(bag_path);
+  ASSERT_TRUE(metadata);
+  EXPECT_FALSE(fs::exists(cache_dir));
+  EXPECT_EQ(std::distance(fs::directory_iterator(dir), fs::directory_iterator()), 1);
+
+  // metadata outlives its consumers
+  const auto* previous = metadata.get();
+  metadata.reset();
+  metadata = BagMetadata::get(bag_path);
+  EXPECT_EQ(metadata.get(), previous);
+
+  BagMetadata::clearLoaded();
+  metadata = BagMetadata::get(bag_path, cache_dir);
+  const auto cache_path = BagMetadata::cachePath(bag_path, cache_dir);
+  EXPECT_EQ(cache_path.parent_path(), cache_dir);
+  ASSERT_TRUE(fs::exists(cache_path));
+
+  BagMetadata::clearLoaded();
+  const auto cached = BagMetadata::get(bag_path, cache_dir);
+  ASSERT_TRUE(cached);
+  EXPECT_NE(cached, metadata);
+  expectEqual(*cached, *metadata);
+
+  BagMetadata::clearLoaded();
+  fs::remove_all(dir);
+}
+
+TEST(BagMetadata, ConcurrentGetScansOnce) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_bag_metadata_threads";
+  const auto bag_path = writeBag(dir);
+  BagMetadata::clearLoaded();
+
+  std::vector<BagMetadata::Ptr> results(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&, i]() { results[i] = BagMetadata::get(bag_path); });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // every caller shares the metadata from the first scan
+  ASSERT_TRUE(results.front());
+  for (const auto& result : results) {
+    EXPECT_EQ(result, results.front());
+  }
+
+  BagMetadata::clearLoaded();
+  EXPECT_THROW(BagMetadata::get(dir / "missing.bag"), rosbag::BagException);
+  EXPECT_THROW(BagMetadata::get(dir / "missing.bag"), rosbag::BagException);
+  fs::remove_all(dir);
+}
+
+}  // namespace hydra
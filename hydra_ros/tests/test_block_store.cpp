@@ -0,0 +1,81 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/block_store.h>
+
+namespace hydra {
+
+TEST(ChunkedBlockStore, ReadWrite) {
+  const auto directory = std::filesystem::temp_directory_path() / "test_block_store";
+  std::vector<uint8_t> result;
+  {
+    ChunkedBlockStore store(directory, 2);
+    EXPECT_FALSE(store.read({0, 0, 0}, result));
+
+    // blocks 0 and 1 share a chunk, -1 does not
+    EXPECT_TRUE(store.write({0, 0, 0}, {1, 2, 3}));
+    EXPECT_TRUE(store.write({1, 0, 0}, {4, 5}));
+    EXPECT_TRUE(store.write({-1, 0, 0}, {6}));
+    EXPECT_EQ(store.size(), 3u);
+    EXPECT_EQ(store.bytesWritten(), 6u);
+
+    ASSERT_TRUE(store.read({1, 0, 0}, result));
+    EXPECT_EQ(result, std::vector<uint8_t>({4, 5}));
+    ASSERT_TRUE(store.read({0, 0, 0}, result));
+    EXPECT_EQ(result, std::vector<uint8_t>({1, 2, 3}));
+
+    // rewriting a block returns the latest version
+    EXPECT_TRUE(store.write({0, 0, 0}, {7, 8, 9, 10}));
+    ASSERT_TRUE(store.read({0, 0, 0}, result));
+    EXPECT_EQ(result, std::vector<uint8_t>({7, 8, 9, 10}));
+    ASSERT_TRUE(store.read({-1, 0, 0}, result));
+    EXPECT_EQ(result, std::vector<uint8_t>({6}));
+
+    store.erase({1, 0, 0});
+    EXPECT_FALSE(store.contains({1, 0, 0}));
+    EXPECT_EQ(store.blocks().size(), 2u);
+  }
+
+  // chunk files are cleaned up with the store
+  size_t num_files = 0;
+  for ([[maybe_unused]] const auto& entry :
+       std::filesystem::directory_iterator(directory)) {
+    ++num_files;
+  }
+  EXPECT_EQ(num_files, 0u);
+  std::filesystem::remove_all(directory);
+}
+
+}  // namespace hydra
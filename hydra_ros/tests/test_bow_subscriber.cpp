@@ -0,0 +1,81 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/bow_subscriber.h>
+
+#include <chrono>
+#include <thread>
+
+namespace hydra {
+
+TEST(BowSubscriber, ForwardsBatches) {
+  auto state = std::make_shared<SharedModuleState>();
+  state->bow_queue.reset(new InputQueue<pose_graph_tools::BowQuery::ConstPtr>());
+
+  ros::NodeHandle nh("~bow_subscriber");
+  BowSubscriber subscriber(nh, state);
+  auto pub = nh.advertise<pose_graph_tools_msgs::BowQueries>("bow_vectors", 10);
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto timeout = std::chrono::seconds(5);
+  while (pub.getNumSubscribers() == 0) {
+    ASSERT_LT(std::chrono::steady_clock::now() - start, timeout);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  pose_graph_tools_msgs::BowQueries msg;
+  for (size_t i = 0; i < 3; ++i) {
+    auto& query = msg.queries.emplace_back();
+    query.robot_id = 1;
+    query.pose_id = i;
+  }
+
+  pub.publish(msg);
+  while (state->bow_queue->size() < 3) {
+    ASSERT_LT(std::chrono::steady_clock::now() - start, timeout);
+    ros::spinOnce();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    const auto query = state->bow_queue->pop();
+    ASSERT_TRUE(query);
+    EXPECT_EQ(query->robot_id, 1);
+    EXPECT_EQ(query->pose_id, static_cast<int>(i));
+  }
+}
+
+}  // namespace hydra
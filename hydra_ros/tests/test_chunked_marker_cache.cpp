@@ -0,0 +1,163 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/chunked_marker_cache.h>
+
+namespace hydra {
+
+using spatial_hash::Block;
+using spatial_hash::BlockIndex;
+using visualization_msgs::Marker;
+
+namespace {
+
+// one point per block
+void fillBlock(const Block& block, Marker& marker) {
+  auto& point = marker.points.emplace_back();
+  point.x = block.origin().x();
+  point.y = block.origin().y();
+  point.z = block.origin().z();
+}
+
+void clearUpdated(spatial_hash::BlockLayer<Block>& layer) {
+  for (auto& block : layer) {
+    block.updated = false;
+  }
+}
+
+}  // namespace
+
+TEST(ChunkedMarkerCache, OnlyUpdatesChangedChunks) {
+  ChunkedMarkerCache::Config config;
+  config.blocks_per_chunk = 2;
+  ChunkedMarkerCache cache(config);
+
+  spatial_hash::BlockLayer<Block> layer(1.0);
+  layer.allocateBlock(BlockIndex(0, 0, 0));
+  layer.allocateBlock(BlockIndex(1, 1, 0));
+  layer.allocateBlock(BlockIndex(2, 0, 0));
+  layer.allocateBlock(BlockIndex(-1, 0, 0));
+
+  const Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  Marker prototype;
+  prototype.ns = "test";
+  std_msgs::Header header;
+  auto msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  ASSERT_EQ(msg.markers.size(), 3u);
+  EXPECT_EQ(cache.numChunks(), 3u);
+  EXPECT_EQ(cache.numUpdated(), 3u);
+  size_t num_points = 0;
+  for (const auto& marker : msg.markers) {
+    EXPECT_EQ(marker.ns, "test");
+    EXPECT_EQ(marker.action, Marker::ADD);
+    num_points += marker.points.size();
+  }
+  EXPECT_EQ(num_points, 4u);
+
+  // nothing changed
+  clearUpdated(layer);
+  msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  EXPECT_TRUE(msg.markers.empty());
+  EXPECT_EQ(cache.numUpdated(), 0u);
+
+  // updating a block only redraws its chunk
+  layer.allocateBlock(BlockIndex(1, 1, 0)).updated = true;
+  msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  ASSERT_EQ(msg.markers.size(), 1u);
+  EXPECT_EQ(msg.markers[0].points.size(), 2u);
+
+  // removing the only block in a chunk deletes the chunk
+  clearUpdated(layer);
+  layer.removeBlock(BlockIndex(2, 0, 0));
+  msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  ASSERT_EQ(msg.markers.size(), 1u);
+  EXPECT_EQ(msg.markers[0].action, Marker::DELETE);
+  EXPECT_EQ(cache.numChunks(), 2u);
+
+  // forcing redraws everything
+  msg = cache.update<Block>(header, layer, origin, prototype, fillBlock, true);
+  EXPECT_EQ(msg.markers.size(), 2u);
+}
+
+TEST(ChunkedMarkerCache, CropRadius) {
+  ChunkedMarkerCache::Config config;
+  config.blocks_per_chunk = 1;
+  config.crop_radius = 2.0;
+  ChunkedMarkerCache cache(config);
+
+  spatial_hash::BlockLayer<Block> layer(1.0);
+  layer.allocateBlock(BlockIndex(0, 0, 0));
+  layer.allocateBlock(BlockIndex(5, 0, 0));
+
+  const Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  Marker prototype;
+  std_msgs::Header header;
+  auto msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  ASSERT_EQ(msg.markers.size(), 1u);
+  EXPECT_EQ(cache.numChunks(), 1u);
+
+  // moving the sensor swaps which block is drawn
+  clearUpdated(layer);
+  msg = cache.update<Block>(
+      header, layer, Eigen::Vector3d(5.0, 0.0, 0.0), prototype, fillBlock);
+  ASSERT_EQ(msg.markers.size(), 2u);
+  EXPECT_EQ(msg.markers[0].action, Marker::DELETE);
+  EXPECT_EQ(msg.markers[1].action, Marker::ADD);
+  EXPECT_EQ(cache.numChunks(), 1u);
+}
+
+TEST(ChunkedMarkerCache, RefreshOnNewSubscriber) {
+  ChunkedMarkerCache cache(ChunkedMarkerCache::Config{});
+  spatial_hash::BlockLayer<Block> layer(1.0);
+  layer.allocateBlock(BlockIndex(0, 0, 0));
+
+  const Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  Marker prototype;
+  std_msgs::Header header;
+  cache.setNumSubscribers(1);
+  auto msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  EXPECT_EQ(msg.markers.size(), 1u);
+
+  clearUpdated(layer);
+  cache.setNumSubscribers(1);
+  msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  EXPECT_TRUE(msg.markers.empty());
+
+  cache.setNumSubscribers(2);
+  msg = cache.update<Block>(header, layer, origin, prototype, fillBlock);
+  EXPECT_EQ(msg.markers.size(), 1u);
+}
+
+}  // namespace hydra
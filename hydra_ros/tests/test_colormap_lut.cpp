@@ -0,0 +1,66 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/colormap_utilities.h>
+
+namespace hydra::dsg_utils {
+
+TEST(ColormapLut, MatchesExactColors) {
+  const auto config = ColormapConfig::__getDefault__();
+  const ColormapLut lut(config);
+  EXPECT_EQ(lut.lookup(0.0), ColormapLut::compute(config, 0.0));
+  EXPECT_EQ(lut.lookup(1.0), ColormapLut::compute(config, 1.0));
+  // out of range ratios are clamped
+  EXPECT_EQ(lut.lookup(-1.0), ColormapLut::compute(config, 0.0));
+  EXPECT_EQ(lut.lookup(2.0), ColormapLut::compute(config, 1.0));
+
+  const double ratio = 100.0 / (ColormapLut::kNumEntries - 1);
+  EXPECT_EQ(lut.lookup(ratio), ColormapLut::compute(config, ratio));
+}
+
+TEST(ColormapLut, RebuiltOnConfigChange) {
+  auto config = ColormapConfig::__getDefault__();
+  const auto& original = getColormapLut(config);
+  EXPECT_TRUE(original.matches(config));
+  EXPECT_EQ(&original, &getColormapLut(config));
+
+  config.max_hue = 0.1;
+  const auto& updated = getColormapLut(config);
+  EXPECT_TRUE(updated.matches(config));
+  EXPECT_EQ(interpolateColorMap(config, 1.0), ColormapLut::compute(config, 1.0));
+}
+
+}  // namespace hydra::dsg_utils
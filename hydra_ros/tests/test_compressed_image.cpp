@@ -0,0 +1,161 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/compressed_image.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include <cstring>
+#include <opencv2/imgcodecs.hpp>
+
+namespace hydra {
+
+namespace {
+
+namespace enc = sensor_msgs::image_encodings;
+
+cv::Mat makePattern(int type) {
+  cv::Mat image(3, 5, type);
+  cv::randu(image, 0, 200);
+  return image;
+}
+
+sensor_msgs::CompressedImage encode(const cv::Mat& image,
+                                    const std::string& ext,
+                                    const std::string& format) {
+  std::vector<uint8_t> buffer;
+  EXPECT_TRUE(cv::imencode(ext, image, buffer));
+  sensor_msgs::CompressedImage msg;
+  msg.format = format;
+  msg.data = buffer;
+  return msg;
+}
+
+cv::Mat wrap(const sensor_msgs::Image& image, int type) {
+  return cv::Mat(image.height,
+                 image.width,
+                 type,
+                 const_cast<uint8_t*>(image.data.data()),
+                 image.step);
+}
+
+bool equal(const cv::Mat& lhs, const cv::Mat& rhs) {
+  return lhs.size() == rhs.size() && lhs.type() == rhs.type() &&
+         cv::norm(lhs, rhs, cv::NORM_INF) == 0.0;
+}
+
+}  // namespace
+
+TEST(CompressedImage, PngRoundTrip) {
+  const std::vector<std::pair<int, std::string>> cases{{CV_8UC1, enc::MONO8},
+                                                       {CV_8UC3, enc::BGR8},
+                                                       {CV_8UC4, enc::BGRA8},
+                                                       {CV_16UC1, enc::MONO16},
+                                                       {CV_16UC3, enc::BGR16},
+                                                       {CV_16UC4, enc::BGRA16}};
+  for (const auto& [type, encoding] : cases) {
+    const auto expected = makePattern(type);
+    const auto msg = encode(expected, ".png", "png");
+    const auto result = decodeCompressedImage(msg);
+    ASSERT_TRUE(result) << encoding;
+    EXPECT_EQ(result->encoding, encoding);
+    EXPECT_TRUE(equal(wrap(*result, type), expected)) << encoding;
+  }
+}
+
+TEST(CompressedImage, FloatRoundTrip) {
+  if (!cv::haveImageWriter(".tiff")) {
+    GTEST_SKIP() << "OpenCV built without tiff support";
+  }
+
+  const auto expected = makePattern(CV_32FC1);
+  const auto msg = encode(expected, ".tiff", "tiff");
+  const auto result = decodeCompressedImage(msg);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->encoding, enc::TYPE_32FC1);
+  EXPECT_TRUE(equal(wrap(*result, CV_32FC1), expected));
+}
+
+TEST(CompressedImage, HintedDecodeMatches) {
+  DecodeShapeHint hint;
+  const auto first = makePattern(CV_8UC3);
+  auto result = decodeCompressedImage(encode(first, ".png", "png"), &hint);
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(equal(wrap(*result, CV_8UC3), first));
+
+  int rows, cols, type;
+  ASSERT_TRUE(hint.get(rows, cols, type));
+  EXPECT_EQ(rows, 3);
+  EXPECT_EQ(cols, 5);
+  EXPECT_EQ(type, CV_8UC3);
+
+  // decoding into the hinted shape and recovering from a stale hint are both exact
+  const auto second = makePattern(CV_8UC3);
+  result = decodeCompressedImage(encode(second, ".png", "png"), &hint);
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(equal(wrap(*result, CV_8UC3), second));
+
+  const auto third = makePattern(CV_16UC1);
+  result = decodeCompressedImage(encode(third, ".png", "png"), &hint);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->encoding, enc::MONO16);
+  EXPECT_TRUE(equal(wrap(*result, CV_16UC1), third));
+}
+
+TEST(CompressedImage, CompressedDepthRoundTrip) {
+  const auto expected = makePattern(CV_16UC1);
+  const auto png = encode(expected, ".png", "");
+
+  sensor_msgs::CompressedImage msg;
+  msg.format = "16UC1; compressedDepth png";
+  const int32_t header[3] = {0, 0, 0};
+  msg.data.resize(sizeof(header) + png.data.size());
+  std::memcpy(msg.data.data(), header, sizeof(header));
+  std::memcpy(msg.data.data() + sizeof(header), png.data.data(), png.data.size());
+
+  const auto result = decodeCompressedImage(msg);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->encoding, enc::TYPE_16UC1);
+  EXPECT_TRUE(equal(wrap(*result, CV_16UC1), expected));
+}
+
+TEST(CompressedImage, InvalidData) {
+  sensor_msgs::CompressedImage msg;
+  msg.format = "png";
+  msg.data = {1, 2, 3};
+  EXPECT_FALSE(decodeCompressedImage(msg));
+}
+
+}  // namespace hydra
@@ -0,0 +1,82 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/detached_task.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+namespace hydra {
+
+TEST(DetachedTask, ReturnsResult) {
+  auto future = launchDetached([]() { return 42; });
+  EXPECT_EQ(future.get(), 42);
+
+  std::atomic<bool> ran(false);
+  auto done = launchDetached([&ran]() { ran = true; });
+  done.get();
+  EXPECT_TRUE(ran);
+}
+
+TEST(DetachedTask, ForwardsExceptions) {
+  auto future = launchDetached([]() -> int { throw std::runtime_error("failed"); });
+  EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(DetachedTask, ReplacingFutureDoesNotBlock) {
+  // the task only finishes once released, long after the future is replaced
+  auto release = std::make_shared<std::atomic<bool>>(false);
+  auto future = launchDetached([release]() {
+    while (!*release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 1;
+  });
+  EXPECT_FALSE(isReady(future));
+
+  const auto start = std::chrono::steady_clock::now();
+  future = launchDetached([]() { return 2; });
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_LT(elapsed.count(), 1.0);
+  EXPECT_EQ(future.get(), 2);
+  EXPECT_FALSE(isReady(future));
+  *release = true;
+}
+
+}  // namespace hydra
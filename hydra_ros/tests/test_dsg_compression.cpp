@@ -0,0 +1,122 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/dsg_compression.h>
+
+namespace hydra {
+
+std::vector<uint8_t> makePayload() {
+  std::vector<uint8_t> payload;
+  for (size_t i = 0; i < 10000; ++i) {
+    payload.push_back(static_cast<uint8_t>((i / 7) % 13));
+  }
+  return payload;
+}
+
+TEST(DsgCompression, CodecNames) {
+  for (const auto codec : {DsgCodec::NONE, DsgCodec::ZSTD, DsgCodec::LZ4}) {
+    EXPECT_EQ(codecFromString(codecToString(codec)), codec);
+  }
+
+  EXPECT_FALSE(codecFromString("gzip"));
+}
+
+TEST(DsgCompression, RoundTrip) {
+  const auto payload = makePayload();
+  for (const auto codec : {DsgCodec::NONE, DsgCodec::ZSTD, DsgCodec::LZ4}) {
+    SCOPED_TRACE(codecToString(codec));
+    std::vector<uint8_t> compressed;
+    compressPayload(codec, 1, payload, compressed);
+    if (codec != DsgCodec::NONE) {
+      EXPECT_LT(compressed.size(), payload.size());
+    }
+
+    std::vector<uint8_t> result;
+    decompressPayload(codec, payload.size(), compressed, result);
+    EXPECT_EQ(result, payload);
+
+    // raw buffers decode the same as vectors, including from unaligned offsets
+    std::vector<uint8_t> shifted(compressed.size() + 1);
+    std::copy(compressed.begin(), compressed.end(), shifted.begin() + 1);
+    result.clear();
+    decompressPayload(
+        codec, payload.size(), shifted.data() + 1, compressed.size(), result);
+    EXPECT_EQ(result, payload);
+  }
+}
+
+TEST(DsgCompression, InvalidPayload) {
+  const auto payload = makePayload();
+  for (const auto codec : {DsgCodec::ZSTD, DsgCodec::LZ4}) {
+    SCOPED_TRACE(codecToString(codec));
+    std::vector<uint8_t> compressed;
+    compressPayload(codec, 1, payload, compressed);
+
+    std::vector<uint8_t> result;
+    EXPECT_THROW(decompressPayload(codec, payload.size() + 1, compressed, result),
+                 std::runtime_error);
+
+    compressed.resize(compressed.size() / 2);
+    EXPECT_THROW(decompressPayload(codec, payload.size(), compressed, result),
+                 std::runtime_error);
+  }
+}
+
+TEST(DsgCompression, ProfileNames) {
+  for (const auto profile : {DsgProfile::FULL, DsgProfile::REDUCED}) {
+    EXPECT_EQ(profileFromString(profileToString(profile)), profile);
+  }
+
+  EXPECT_FALSE(profileFromString("float16"));
+}
+
+TEST(DsgCompression, ReduceGraph) {
+  DynamicSceneGraph graph;
+  auto attrs = std::make_unique<PlaceNodeAttributes>();
+  attrs->position << 1.234, -0.006, 2.0;
+  attrs->pcl_mesh_connections = {1, 2, 3};
+  attrs->mesh_vertex_labels = {4, 5, 6};
+  graph.emplaceNode(DsgLayers::PLACES, 0, std::move(attrs));
+
+  reduceGraph(graph, 0.01);
+  const auto& reduced = graph.getNode(0).attributes<PlaceNodeAttributes>();
+  EXPECT_NEAR(reduced.position.x(), 1.23, 1.0e-9);
+  EXPECT_NEAR(reduced.position.y(), -0.01, 1.0e-9);
+  EXPECT_NEAR(reduced.position.z(), 2.0, 1.0e-9);
+  EXPECT_TRUE(reduced.pcl_mesh_connections.empty());
+  EXPECT_TRUE(reduced.mesh_vertex_labels.empty());
+}
+
+}  // namespace hydra
@@ -0,0 +1,203 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/dsg_log.h>
+#include <spark_dsg/node_attributes.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <vector>
+
+namespace hydra {
+
+namespace {
+
+std::string getLogPath(const std::string& test) {
+  return "/tmp/hydra_ros_test_" + test + "_" + std::to_string(getpid()) + ".log";
+}
+
+DsgLogRecord makeRecord(DsgLogRecord::Type type, uint64_t stamp, int64_t sequence) {
+  DsgLogRecord record;
+  record.type = type;
+  record.timestamp_ns = stamp;
+  record.sequence_number = sequence;
+  return record;
+}
+
+std::vector<uint8_t> makePayload(size_t size, uint8_t value) {
+  return std::vector<uint8_t>(size, value);
+}
+
+}  // namespace
+
+TEST(DsgLog, IndexRoundTrip) {
+  const auto path = getLogPath("index_round_trip");
+  {
+    DsgLogWriter writer(path);
+    ASSERT_TRUE(writer.valid());
+    EXPECT_TRUE(writer.append(makeRecord(DsgLogRecord::Type::FULL_UPDATE, 10, 0),
+                              makePayload(20, 1)));
+    EXPECT_TRUE(writer.append(makeRecord(DsgLogRecord::Type::DELTA_UPDATE, 20, 1),
+                              makePayload(5, 2)));
+    EXPECT_TRUE(writer.append(makeRecord(DsgLogRecord::Type::SNAPSHOT, 20, 1),
+                              makePayload(30, 3)));
+    EXPECT_EQ(writer.records().size(), 3u);
+  }
+
+  DsgLogReader reader(path);
+  ASSERT_TRUE(reader.valid());
+  const auto& records = reader.records();
+  ASSERT_EQ(records.size(), 3u);
+  EXPECT_EQ(records[0].type, DsgLogRecord::Type::FULL_UPDATE);
+  EXPECT_EQ(records[1].type, DsgLogRecord::Type::DELTA_UPDATE);
+  EXPECT_EQ(records[2].type, DsgLogRecord::Type::SNAPSHOT);
+  EXPECT_EQ(records[1].timestamp_ns, 20u);
+  EXPECT_EQ(records[1].sequence_number, 1);
+
+  const std::vector<size_t> sizes{20, 5, 30};
+  for (size_t i = 0; i < records.size(); ++i) {
+    ASSERT_EQ(records[i].size, sizes[i]);
+    const std::vector<uint8_t> payload(reader.payload(i),
+                                       reader.payload(i) + records[i].size);
+    EXPECT_EQ(payload, makePayload(sizes[i], i + 1));
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST(DsgLog, RecoverWithoutIndex) {
+  const auto path = getLogPath("recover_without_index");
+  std::vector<DsgLogRecord> written;
+  {
+    DsgLogWriter writer(path);
+    ASSERT_TRUE(writer.valid());
+    writer.append(makeRecord(DsgLogRecord::Type::FULL_UPDATE, 10, 0),
+                  makePayload(20, 1));
+    writer.append(makeRecord(DsgLogRecord::Type::DELTA_UPDATE, 20, 1),
+                  makePayload(40, 2));
+
+    // records are flushed as they are written
+    DsgLogReader reader(path);
+    ASSERT_TRUE(reader.valid());
+    EXPECT_EQ(reader.records().size(), 2u);
+    written = writer.records();
+  }
+
+  // drop the index and half of the last record
+  const auto& last = written.back();
+  ASSERT_EQ(truncate(path.c_str(), last.offset + last.size / 2), 0);
+
+  DsgLogReader reader(path);
+  ASSERT_TRUE(reader.valid());
+  ASSERT_EQ(reader.records().size(), 1u);
+  EXPECT_EQ(reader.records()[0].offset, written[0].offset);
+  EXPECT_EQ(reader.records()[0].size, 20u);
+
+  std::remove(path.c_str());
+}
+
+TEST(DsgLog, FindKeyframe) {
+  const auto path = getLogPath("find_keyframe");
+  {
+    DsgLogWriter writer(path);
+    ASSERT_TRUE(writer.valid());
+    const auto payload = makePayload(10, 0);
+    writer.append(makeRecord(DsgLogRecord::Type::DELTA_UPDATE, 5, 3), payload);
+    writer.append(makeRecord(DsgLogRecord::Type::FULL_UPDATE, 10, 4), payload);
+    writer.append(makeRecord(DsgLogRecord::Type::DELTA_UPDATE, 20, 5), payload);
+    writer.append(makeRecord(DsgLogRecord::Type::DELTA_UPDATE, 30, 6), payload);
+    writer.append(makeRecord(DsgLogRecord::Type::SNAPSHOT, 30, 6), payload);
+    writer.append(makeRecord(DsgLogRecord::Type::DELTA_UPDATE, 40, 7), payload);
+  }
+
+  DsgLogReader reader(path);
+  ASSERT_TRUE(reader.valid());
+  EXPECT_EQ(reader.findKeyframe(0), std::optional<size_t>(1));
+  EXPECT_EQ(reader.findKeyframe(10), std::optional<size_t>(1));
+  EXPECT_EQ(reader.findKeyframe(25), std::optional<size_t>(1));
+  EXPECT_EQ(reader.findKeyframe(30), std::optional<size_t>(4));
+  EXPECT_EQ(reader.findKeyframe(100), std::optional<size_t>(4));
+
+  std::remove(path.c_str());
+}
+
+TEST(DsgLog, CompressedSnapshots) {
+  const auto path = getLogPath("compressed_snapshots");
+  DynamicSceneGraph graph;
+  auto attrs = std::make_unique<PlaceNodeAttributes>();
+  attrs->position << 1.0, 2.0, 3.0;
+  graph.emplaceNode(DsgLayers::PLACES, 0, std::move(attrs));
+  {
+    DsgLogWriter writer(path, DsgCodec::ZSTD, 1);
+    ASSERT_TRUE(writer.valid());
+    EXPECT_TRUE(writer.writeSnapshot(graph, 10, 0));
+    graph.getNode(0).attributes().position.x() = 4.0;
+    EXPECT_TRUE(writer.writeSnapshot(graph, 20, 1));
+  }
+
+  // payloads are decompressed directly from the mapped file
+  DsgLogReader reader(path);
+  ASSERT_TRUE(reader.valid());
+  ASSERT_EQ(reader.records().size(), 2u);
+  EXPECT_EQ(reader.records()[0].codec, DsgCodec::ZSTD);
+
+  auto state = reader.seek(15);
+  ASSERT_TRUE(state.graph);
+  ASSERT_TRUE(state.graph->hasNode(0));
+  EXPECT_DOUBLE_EQ(state.graph->getNode(0).attributes().position.x(), 1.0);
+
+  ASSERT_TRUE(reader.apply(1, state));
+  EXPECT_DOUBLE_EQ(state.graph->getNode(0).attributes().position.x(), 4.0);
+  EXPECT_EQ(state.sequence_number, std::optional<int64_t>(1));
+  std::remove(path.c_str());
+}
+
+TEST(DsgLog, InvalidFile) {
+  const auto path = getLogPath("invalid_file");
+  DsgLogReader missing(path);
+  EXPECT_FALSE(missing.valid());
+
+  auto file = std::fopen(path.c_str(), "wb");
+  ASSERT_TRUE(file != nullptr);
+  const auto garbage = makePayload(64, 7);
+  std::fwrite(garbage.data(), 1, garbage.size(), file);
+  std::fclose(file);
+
+  DsgLogReader reader(path);
+  EXPECT_FALSE(reader.valid());
+  std::remove(path.c_str());
+}
+
+}  // namespace hydra
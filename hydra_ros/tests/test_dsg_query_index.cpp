@@ -0,0 +1,121 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/dsg_query_index.h>
+
+#include <algorithm>
+
+namespace hydra {
+
+namespace {
+
+DsgQueryIndex::Entry makeEntry(LayerId layer,
+                               const Eigen::Vector3d& position,
+                               std::optional<uint32_t> label = std::nullopt,
+                               std::optional<NodeId> parent = std::nullopt) {
+  return {layer, position, label, parent};
+}
+
+std::vector<NodeId> sorted(std::vector<NodeId> nodes) {
+  std::sort(nodes.begin(), nodes.end());
+  return nodes;
+}
+
+}  // namespace
+
+TEST(DsgQueryIndex, NearestWithLabel) {
+  DsgQueryIndex index(1.0);
+  index.updateNode(0, makeEntry(2, Eigen::Vector3d(0.0, 0.0, 0.0), 5));
+  index.updateNode(1, makeEntry(2, Eigen::Vector3d(4.0, 0.0, 0.0), 5));
+  index.updateNode(2, makeEntry(2, Eigen::Vector3d(3.0, 0.0, 0.0), 7));
+  index.updateNode(3, makeEntry(3, Eigen::Vector3d(3.0, 0.0, 0.0), 5));
+  EXPECT_EQ(index.numNodes(), 4u);
+
+  EXPECT_EQ(index.nearestWithLabel(2, 5, Eigen::Vector3d(3.0, 0.0, 0.0)), 1u);
+  EXPECT_EQ(index.nearestWithLabel(2, 5, Eigen::Vector3d(1.0, 0.0, 0.0)), 0u);
+  EXPECT_EQ(index.nearestWithLabel(3, 5, Eigen::Vector3d(0.0, 0.0, 0.0)), 3u);
+  EXPECT_FALSE(index.nearestWithLabel(2, 9, Eigen::Vector3d::Zero()));
+  EXPECT_FALSE(index.nearestWithLabel(4, 5, Eigen::Vector3d::Zero()));
+
+  // relabeling a node moves it between label buckets
+  index.updateNode(1, makeEntry(2, Eigen::Vector3d(4.0, 0.0, 0.0), 7));
+  EXPECT_EQ(index.nearestWithLabel(2, 5, Eigen::Vector3d(3.0, 0.0, 0.0)), 0u);
+  EXPECT_EQ(index.nearestWithLabel(2, 7, Eigen::Vector3d(5.0, 0.0, 0.0)), 1u);
+}
+
+TEST(DsgQueryIndex, WithinRadius) {
+  DsgQueryIndex index(0.5);
+  index.updateNode(0, makeEntry(3, Eigen::Vector3d(0.0, 0.0, 0.0)));
+  index.updateNode(1, makeEntry(3, Eigen::Vector3d(0.9, 0.0, 0.0)));
+  index.updateNode(2, makeEntry(3, Eigen::Vector3d(0.8, 0.8, 0.0)));
+  index.updateNode(3, makeEntry(2, Eigen::Vector3d(0.1, 0.0, 0.0)));
+
+  const Eigen::Vector3d origin = Eigen::Vector3d::Zero();
+  EXPECT_EQ(sorted(index.withinRadius(3, origin, 1.0)), std::vector<NodeId>({0, 1}));
+  EXPECT_EQ(sorted(index.withinRadius(3, origin, 2.0)),
+            std::vector<NodeId>({0, 1, 2}));
+  // large radii walk the occupied cells instead of the bounding box
+  EXPECT_EQ(sorted(index.withinRadius(3, origin, 1.0e4)),
+            std::vector<NodeId>({0, 1, 2}));
+  EXPECT_TRUE(index.withinRadius(4, origin, 1.0).empty());
+
+  // moving and removing nodes clears the cells they used to be in
+  index.updateNode(1, makeEntry(3, Eigen::Vector3d(10.0, 0.0, 0.0)));
+  index.removeNode(0);
+  EXPECT_TRUE(index.withinRadius(3, origin, 1.0).empty());
+  EXPECT_EQ(index.withinRadius(3, Eigen::Vector3d(10.0, 0.0, 0.0), 0.1),
+            std::vector<NodeId>({1}));
+}
+
+TEST(DsgQueryIndex, Children) {
+  DsgQueryIndex index;
+  index.updateNode(10, makeEntry(4, Eigen::Vector3d::Zero()));
+  index.updateNode(0, makeEntry(3, Eigen::Vector3d::Zero(), std::nullopt, 10));
+  index.updateNode(1, makeEntry(3, Eigen::Vector3d::Zero(), std::nullopt, 10));
+  index.updateNode(2, makeEntry(3, Eigen::Vector3d::Zero(), std::nullopt, 11));
+  EXPECT_EQ(sorted(index.children(10)), std::vector<NodeId>({0, 1}));
+  EXPECT_TRUE(index.children(0).empty());
+
+  index.updateNode(1, makeEntry(3, Eigen::Vector3d::Zero(), std::nullopt, 11));
+  EXPECT_EQ(index.children(10), std::vector<NodeId>({0}));
+  EXPECT_EQ(sorted(index.children(11)), std::vector<NodeId>({1, 2}));
+
+  index.clear();
+  EXPECT_EQ(index.numNodes(), 0u);
+  EXPECT_TRUE(index.children(11).empty());
+}
+
+}  // namespace hydra
@@ -0,0 +1,177 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/dsg_streaming_interface.h>
+#include <hydra_ros/utils/mesh_delta.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace hydra {
+
+namespace {
+
+template <typename Pred>
+bool spinUntil(const Pred& pred, double timeout_s = 5.0) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto timeout = std::chrono::duration<double>(timeout_s);
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() - start > timeout) {
+      return false;
+    }
+
+    ros::spinOnce();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return true;
+}
+
+hydra_msgs::DsgUpdate makeUpdate(const DynamicSceneGraph& graph) {
+  hydra_msgs::DsgUpdate msg;
+  msg.header.stamp = ros::Time::now();
+  msg.full_update = true;
+  spark_dsg::io::binary::writeGraph(graph, msg.layer_contents, false);
+  msg.uncompressed_size = msg.layer_contents.size();
+  return msg;
+}
+
+hydra_msgs::MeshDelta makeMeshDelta(size_t num_vertices, int64_t sequence_number) {
+  Mesh mesh;
+  mesh.resizeVertices(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    mesh.points[i] << i, 0.0, 0.0;
+  }
+
+  hydra_msgs::MeshDelta msg;
+  fillMeshDelta(nullptr, mesh, msg);
+  msg.header.stamp = ros::Time::now();
+  msg.sequence_number = sequence_number;
+  return msg;
+}
+
+}  // namespace
+
+TEST(DsgReceiver, SnapshotsAreCopiedLazily) {
+  ros::NodeHandle nh("~receiver_snapshot");
+  DsgReceiver receiver(nh, true);
+  EXPECT_FALSE(receiver.takeSnapshot());
+
+  auto graph_pub = nh.advertise<hydra_msgs::DsgUpdate>("dsg", 10);
+  auto mesh_pub = nh.advertise<hydra_msgs::MeshDelta>("dsg_mesh_delta", 10);
+  ASSERT_TRUE(spinUntil([&]() {
+    return graph_pub.getNumSubscribers() > 0 && mesh_pub.getNumSubscribers() > 0;
+  }));
+
+  DynamicSceneGraph graph;
+  auto attrs = std::make_unique<PlaceNodeAttributes>();
+  graph.emplaceNode(DsgLayers::PLACES, 0, std::move(attrs));
+  graph_pub.publish(makeUpdate(graph));
+  mesh_pub.publish(makeMeshDelta(3, 0));
+  ASSERT_TRUE(
+      spinUntil([&]() { return receiver.graph() && receiver.graph()->mesh(); }));
+
+  // several updates result in a single snapshot
+  const auto first = receiver.takeSnapshot();
+  ASSERT_TRUE(first);
+  EXPECT_TRUE(first->hasNode(0));
+  ASSERT_TRUE(first->mesh());
+  EXPECT_EQ(first->mesh()->numVertices(), 3u);
+  EXPECT_FALSE(receiver.takeSnapshot());
+
+  // graph updates share the unchanged mesh copy
+  graph.emplaceNode(DsgLayers::PLACES, 1, std::make_unique<PlaceNodeAttributes>());
+  graph_pub.publish(makeUpdate(graph));
+  ASSERT_TRUE(spinUntil([&]() { return receiver.graph()->hasNode(1); }));
+  const auto second = receiver.takeSnapshot();
+  ASSERT_TRUE(second);
+  EXPECT_TRUE(second->hasNode(1));
+  EXPECT_FALSE(first->hasNode(1));
+  EXPECT_EQ(second->mesh(), first->mesh());
+  EXPECT_NE(second->mesh(), receiver.graph()->mesh());
+
+  // mesh updates never modify a mesh that was handed out
+  mesh_pub.publish(makeMeshDelta(5, 1));
+  ASSERT_TRUE(
+      spinUntil([&]() { return receiver.graph()->mesh()->numVertices() == 5; }));
+  EXPECT_EQ(first->mesh()->numVertices(), 3u);
+  const auto third = receiver.takeSnapshot();
+  ASSERT_TRUE(third);
+  ASSERT_TRUE(third->mesh());
+  EXPECT_EQ(third->mesh()->numVertices(), 5u);
+  EXPECT_NE(third->mesh(), first->mesh());
+}
+
+TEST(DsgReceiver, SnapshotsFromAnotherThread) {
+  ros::NodeHandle nh("~receiver_threaded");
+  DsgReceiver receiver(nh);
+  auto graph_pub = nh.advertise<hydra_msgs::DsgUpdate>("dsg", 100);
+  ASSERT_TRUE(spinUntil([&]() { return graph_pub.getNumSubscribers() > 0; }));
+
+  std::atomic<bool> done(false);
+  size_t num_snapshots = 0;
+  std::thread reader([&]() {
+    while (!done) {
+      const auto snapshot = receiver.takeSnapshot();
+      if (snapshot) {
+        EXPECT_LE(snapshot->numNodes(), 20u);
+        ++num_snapshots;
+      }
+    }
+  });
+
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 20; ++i) {
+    auto attrs = std::make_unique<PlaceNodeAttributes>();
+    graph.emplaceNode(DsgLayers::PLACES, i, std::move(attrs));
+    graph_pub.publish(makeUpdate(graph));
+  }
+
+  EXPECT_TRUE(spinUntil([&]() {
+    return receiver.graph() && receiver.graph()->numNodes() == 20;
+  }));
+  done = true;
+  reader.join();
+  if (receiver.takeSnapshot()) {
+    ++num_snapshots;
+  }
+
+  EXPECT_GT(num_snapshots, 0u);
+}
+
+}  // namespace hydra
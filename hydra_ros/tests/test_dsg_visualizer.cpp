@@ -0,0 +1,263 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/dynamic_scene_graph_visualizer.h>
+#include <spark_dsg/node_attributes.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace hydra {
+
+namespace {
+
+struct TestVisualizer : public DynamicSceneGraphVisualizer {
+  explicit TestVisualizer(const ros::NodeHandle& nh)
+      : DynamicSceneGraphVisualizer(nh) {}
+
+  using DynamicSceneGraphVisualizer::layerChanged;
+
+  MarkerArray draw() {
+    std_msgs::Header header;
+    header.frame_id = "map";
+    MarkerArray msg;
+    full_redraw_ = need_full_redraw_.exchange(false);
+    redrawImpl(header, msg);
+    full_redraw_ = false;
+    return msg;
+  }
+};
+
+struct CallbackPlugin : public DsgVisualizerPlugin {
+  CallbackPlugin(const ros::NodeHandle& nh, const std::function<void()>& on_draw)
+      : DsgVisualizerPlugin(nh, "callback"), on_draw(on_draw) {}
+
+  void draw(const ConfigManager&,
+            const std_msgs::Header&,
+            const DynamicSceneGraph&) override {
+    ++num_draws;
+    if (on_draw) {
+      on_draw();
+    }
+  }
+
+  void reset(const std_msgs::Header&, const DynamicSceneGraph&) override {}
+
+  std::function<void()> on_draw;
+  size_t num_draws = 0;
+};
+
+struct ConcurrencyPlugin : public DsgVisualizerPlugin {
+  ConcurrencyPlugin(const ros::NodeHandle& nh,
+                    std::atomic<int>& active,
+                    std::atomic<int>& max_active,
+                    size_t& num_draws)
+      : DsgVisualizerPlugin(nh, "concurrency"),
+        active(active),
+        max_active(max_active),
+        num_draws(num_draws) {}
+
+  void draw(const ConfigManager&,
+            const std_msgs::Header&,
+            const DynamicSceneGraph&) override {
+    const int curr = ++active;
+    int prev = max_active;
+    while (prev < curr && !max_active.compare_exchange_weak(prev, curr)) {
+    }
+
+    // give other draws a chance to overlap
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ++num_draws;
+    --active;
+  }
+
+  void reset(const std_msgs::Header&, const DynamicSceneGraph&) override {}
+
+  std::atomic<int>& active;
+  std::atomic<int>& max_active;
+  size_t& num_draws;
+};
+
+DynamicSceneGraph::Ptr makeGraph() {
+  auto graph = std::make_shared<DynamicSceneGraph>();
+  for (size_t i = 0; i < 10; ++i) {
+    auto attrs = std::make_unique<PlaceNodeAttributes>();
+    attrs->position = Eigen::Vector3d(i, 0.0, 0.0);
+    graph->emplaceNode(DsgLayers::PLACES, NodeSymbol('p', i), std::move(attrs));
+
+    auto obj_attrs = std::make_unique<ObjectNodeAttributes>();
+    obj_attrs->position = Eigen::Vector3d(i, 1.0, 0.0);
+    graph->emplaceNode(DsgLayers::OBJECTS, NodeSymbol('O', i), std::move(obj_attrs));
+    if (i > 0) {
+      graph->insertEdge(NodeSymbol('p', i - 1), NodeSymbol('p', i));
+    }
+  }
+
+  return graph;
+}
+
+std::unique_ptr<TestVisualizer> makeVisualizer(const std::string& ns,
+                                               int num_threads) {
+  ros::NodeHandle nh("~" + ns);
+  nh.setParam("num_redraw_threads", num_threads);
+  nh.setParam("config_ns", "~" + ns + "/config");
+  return std::make_unique<TestVisualizer>(nh);
+}
+
+}  // namespace
+
+TEST(DynamicSceneGraphVisualizer, ParallelRedrawMatchesSerial) {
+  auto serial = makeVisualizer("serial_viz", 1);
+  auto parallel = makeVisualizer("parallel_viz", 4);
+  serial->setGraph(makeGraph());
+  parallel->setGraph(makeGraph());
+
+  // layers are merged in order, so the output does not depend on scheduling
+  const auto expected = serial->draw();
+  const auto result = parallel->draw();
+  ASSERT_EQ(result.markers.size(), expected.markers.size());
+  for (size_t i = 0; i < expected.markers.size(); ++i) {
+    EXPECT_EQ(result.markers[i].ns, expected.markers[i].ns);
+    EXPECT_EQ(result.markers[i].id, expected.markers[i].id);
+    EXPECT_EQ(result.markers[i].points.size(), expected.markers[i].points.size());
+  }
+}
+
+TEST(DynamicSceneGraphVisualizer, PluginsDrawSerially) {
+  auto visualizer = makeVisualizer("plugin_viz", 4);
+  std::atomic<int> active(0);
+  std::atomic<int> max_active(0);
+  size_t num_draws = 0;
+  ros::NodeHandle nh("~plugin_viz");
+  for (size_t i = 0; i < 4; ++i) {
+    visualizer->addPlugin(
+        std::make_shared<ConcurrencyPlugin>(nh, active, max_active, num_draws));
+  }
+
+  visualizer->setGraph(makeGraph());
+  visualizer->draw();
+  EXPECT_EQ(num_draws, 4u);
+  EXPECT_EQ(max_active, 1);
+}
+
+TEST(DynamicSceneGraphVisualizer, FullRedrawRequestedWhileDrawingIsKept) {
+  auto visualizer = makeVisualizer("request_viz", 1);
+  bool requested = false;
+  ros::NodeHandle nh("~request_viz");
+  // a subscriber connecting in the middle of a redraw
+  auto plugin = std::make_shared<CallbackPlugin>(nh, [&]() {
+    if (!requested) {
+      requested = true;
+      visualizer->setNeedFullRedraw();
+    }
+  });
+  visualizer->addPlugin(plugin);
+
+  visualizer->setGraph(makeGraph());
+  EXPECT_TRUE(visualizer->redraw());
+  EXPECT_EQ(plugin->num_draws, 1u);
+
+  // plugins only redraw an unchanged graph for full redraws
+  EXPECT_TRUE(visualizer->redraw());
+  EXPECT_EQ(plugin->num_draws, 2u);
+  EXPECT_FALSE(visualizer->redraw());
+  EXPECT_EQ(plugin->num_draws, 2u);
+}
+
+TEST(DynamicSceneGraphVisualizer, ConcurrentRedrawRequests) {
+  auto visualizer = makeVisualizer("concurrent_request_viz", 1);
+  ros::NodeHandle nh("~concurrent_request_viz");
+  auto plugin = std::make_shared<CallbackPlugin>(nh, nullptr);
+  visualizer->addPlugin(plugin);
+  visualizer->setGraph(makeGraph());
+  visualizer->redraw();
+
+  std::atomic<bool> should_stop(false);
+  std::thread requester([&]() {
+    while (!should_stop) {
+      visualizer->setNeedFullRedraw();
+      std::this_thread::yield();
+    }
+  });
+
+  for (size_t i = 0; i < 50; ++i) {
+    visualizer->redraw();
+  }
+
+  should_stop = true;
+  requester.join();
+
+  // the last request always leads to one more full redraw
+  visualizer->setNeedFullRedraw();
+  const auto num_draws = plugin->num_draws;
+  EXPECT_TRUE(visualizer->redraw());
+  EXPECT_EQ(plugin->num_draws, num_draws + 1);
+  EXPECT_FALSE(visualizer->redraw());
+}
+
+TEST(DynamicSceneGraphVisualizer, OnlyMarkedNodesChangeLayers) {
+  auto visualizer = makeVisualizer("dirty_viz", 1);
+  auto graph = makeGraph();
+  visualizer->setGraph(graph);
+  const auto& places = graph->getLayer(DsgLayers::PLACES);
+  const auto& objects = graph->getLayer(DsgLayers::OBJECTS);
+  EXPECT_TRUE(visualizer->layerChanged(places));
+  EXPECT_TRUE(visualizer->layerChanged(objects));
+  EXPECT_FALSE(visualizer->layerChanged(places));
+  EXPECT_FALSE(visualizer->layerChanged(objects));
+
+  // nodes edited in place only change their own layer
+  graph->getNode(NodeSymbol('p', 0)).attributes().position.x() = 5.0;
+  visualizer->setNodesUpdated({NodeSymbol('p', 0)});
+  EXPECT_TRUE(visualizer->layerChanged(places));
+  EXPECT_FALSE(visualizer->layerChanged(objects));
+
+  // new nodes are found without being marked
+  auto attrs = std::make_unique<ObjectNodeAttributes>();
+  graph->emplaceNode(DsgLayers::OBJECTS, NodeSymbol('O', 20), std::move(attrs));
+  visualizer->setNodesUpdated({});
+  EXPECT_FALSE(visualizer->layerChanged(places));
+  EXPECT_TRUE(visualizer->layerChanged(objects));
+
+  // updates without node ids change every layer
+  visualizer->setGraphUpdated();
+  EXPECT_TRUE(visualizer->layerChanged(places));
+  EXPECT_TRUE(visualizer->layerChanged(objects));
+}
+
+}  // namespace hydra
@@ -37,6 +37,8 @@
 #include <gtest/gtest.h>
 #include <hydra_ros/utils/ear_clipping.h>
 
+#include <random>
+
 namespace hydra {
 
 TEST(EarClipping, TriangleIter) {
@@ -235,4 +237,82 @@ TEST(EarClipping, TriangulateMissingFaces) {
   EXPECT_EQ(faces, expected);
 }
 
+TEST(EarClipping, TriangulatePolygonMatchesPolygon) {
+  std::vector<Vertex> hexagon{{Eigen::Vector2d(0.0, 0.0), 0u},
+                              {Eigen::Vector2d(1.0, 1.0), 1u},
+                              {Eigen::Vector2d(1.0, 2.0), 2u},
+                              {Eigen::Vector2d(0.0, 3.0), 3u},
+                              {Eigen::Vector2d(-1.0, 2.0), 4u},
+                              {Eigen::Vector2d(-1.0, 1.0), 5u}};
+  std::vector<std::array<size_t, 3>> expected{
+      {5, 0, 1}, {5, 1, 2}, {2, 3, 4}, {5, 2, 4}};
+  EXPECT_EQ(triangulatePolygon(hexagon), expected);
+
+  std::vector<Vertex> duplicates{{Eigen::Vector2d(-18.15, 26.85), 0u},
+                                 {Eigen::Vector2d(-18.95, 25.95), 1u},
+                                 {Eigen::Vector2d(-19.05, 24.15), 2u},
+                                 {Eigen::Vector2d(-18.65, 23.25), 3u},
+                                 {Eigen::Vector2d(-17.45, 22.45), 4u},
+                                 {Eigen::Vector2d(-16.75, 21.95), 5u},
+                                 {Eigen::Vector2d(-15.45, 22.05), 6u},
+                                 {Eigen::Vector2d(-15.45, 22.05), 7u},
+                                 {Eigen::Vector2d(-15.35, 23.25), 8u},
+                                 {Eigen::Vector2d(-14.95, 24.45), 9u},
+                                 {Eigen::Vector2d(-15.45, 26.65), 10u},
+                                 {Eigen::Vector2d(-16.05, 27.25), 11u},
+                                 {Eigen::Vector2d(-16.05, 27.25), 12u},
+                                 {Eigen::Vector2d(-17.15, 27.55), 13u},
+                                 {Eigen::Vector2d(-17.65, 26.75), 14u}};
+  for (const bool use_first_ear : {true, false}) {
+    for (const bool is_ccw : {true, false}) {
+      Polygon polygon(duplicates, is_ccw);
+      EXPECT_EQ(triangulatePolygon(duplicates, is_ccw, use_first_ear),
+                polygon.triangulate(use_first_ear));
+    }
+  }
+}
+
+TEST(EarClipping, TriangulatePolygonRandomStars) {
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> radius(0.2, 2.0);
+  for (size_t trial = 0; trial < 20; ++trial) {
+    const size_t num_vertices = 4 + trial;
+    std::vector<Vertex> vertices;
+    for (size_t i = 0; i < num_vertices; ++i) {
+      const double theta = 2.0 * M_PI * i / num_vertices;
+      const double r = radius(gen);
+      const Eigen::Vector2d pos(r * std::cos(theta), r * std::sin(theta));
+      vertices.push_back({pos, i});
+    }
+
+    SCOPED_TRACE("trial: " + std::to_string(trial));
+    for (const bool use_first_ear : {true, false}) {
+      Polygon polygon(vertices);
+      const auto faces = triangulatePolygon(vertices, true, use_first_ear);
+      EXPECT_EQ(faces, polygon.triangulate(use_first_ear));
+    }
+  }
+}
+
+TEST(EarClipping, TriangulatePolygonsBatch) {
+  std::vector<Eigen::MatrixXd> points;
+  for (size_t i = 0; i < 8; ++i) {
+    Eigen::MatrixXd square(3, 4);
+    square << 0.0, 1.0, 1.0, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0;
+    points.push_back(square * (i + 1.0));
+  }
+
+  std::vector<const Eigen::MatrixXd*> polygons;
+  for (const auto& polygon : points) {
+    polygons.push_back(&polygon);
+  }
+
+  const auto faces = triangulatePolygons(polygons, 4);
+  ASSERT_EQ(faces.size(), points.size());
+  std::vector<std::array<size_t, 3>> expected{{3, 0, 1}, {3, 1, 2}};
+  for (const auto& polygon_faces : faces) {
+    EXPECT_EQ(polygon_faces, expected);
+  }
+}
+
 }  // namespace hydra
@@ -0,0 +1,160 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/edge_marker_builder.h>
+#include <spark_dsg/node_attributes.h>
+
+namespace hydra {
+
+namespace {
+
+template <typename Attrs>
+void addNode(DynamicSceneGraph& graph, LayerId layer, NodeId node, double z) {
+  auto attrs = std::make_unique<Attrs>();
+  attrs->position = Eigen::Vector3d(0.0, 0.0, z);
+  graph.emplaceNode(layer, node, std::move(attrs));
+}
+
+std::map<LayerId, LayerConfig> makeConfigs() {
+  std::map<LayerId, LayerConfig> configs;
+  for (const auto layer : {DsgLayers::OBJECTS, DsgLayers::PLACES, DsgLayers::ROOMS}) {
+    auto& config = configs[layer];
+    config = LayerConfig::__getDefault__();
+    config.visualize = true;
+    config.interlayer_edge_insertion_skip = 0;
+    config.interlayer_edge_use_color = false;
+  }
+
+  return configs;
+}
+
+// room with one place and one object as children and a place with an object
+DynamicSceneGraph makeGraph() {
+  DynamicSceneGraph graph;
+  addNode<RoomNodeAttributes>(graph, DsgLayers::ROOMS, NodeSymbol('R', 0), 3.0);
+  addNode<PlaceNodeAttributes>(graph, DsgLayers::PLACES, NodeSymbol('p', 0), 2.0);
+  addNode<PlaceNodeAttributes>(graph, DsgLayers::PLACES, NodeSymbol('p', 1), 2.0);
+  addNode<ObjectNodeAttributes>(graph, DsgLayers::OBJECTS, NodeSymbol('O', 0), 1.0);
+  addNode<ObjectNodeAttributes>(graph, DsgLayers::OBJECTS, NodeSymbol('O', 1), 1.0);
+  graph.insertEdge(NodeSymbol('R', 0), NodeSymbol('p', 0));
+  graph.insertEdge(NodeSymbol('R', 0), NodeSymbol('O', 0));
+  graph.insertEdge(NodeSymbol('p', 1), NodeSymbol('O', 1));
+  return graph;
+}
+
+}  // namespace
+
+TEST(EdgeMarkerBuilder, OneMarkerPerSourceLayer) {
+  const auto graph = makeGraph();
+  const auto configs = makeConfigs();
+  auto viz_config = VisualizerConfig::__getDefault__();
+  viz_config.collapse_layers = true;
+
+  EdgeMarkerBuilder builder;
+  const auto result = builder.makeGraphEdgeMarkers(
+      std_msgs::Header(), graph, configs, viz_config, "edges_");
+
+  // markers are ordered by source layer and rooms draw edges to places and objects
+  ASSERT_EQ(result.markers.size(), 2u);
+  const auto& places = result.markers[0];
+  EXPECT_EQ(places.ns, "edges_3_2");
+  EXPECT_EQ(places.points.size(), 2u);
+  EXPECT_EQ(places.colors.size(), 2u);
+
+  const auto& rooms = result.markers[1];
+  EXPECT_EQ(rooms.ns.rfind("edges_4_", 0), 0u);
+  ASSERT_EQ(rooms.points.size(), 4u);
+  EXPECT_EQ(rooms.colors.size(), 4u);
+  for (size_t i = 0; i < rooms.points.size(); i += 2) {
+    EXPECT_DOUBLE_EQ(rooms.points[i].z, 3.0);
+  }
+}
+
+TEST(EdgeMarkerBuilder, InsertionSkipIsPerSourceLayer) {
+  const auto graph = makeGraph();
+  auto configs = makeConfigs();
+  configs[DsgLayers::ROOMS].interlayer_edge_insertion_skip = 1;
+  auto viz_config = VisualizerConfig::__getDefault__();
+  viz_config.collapse_layers = true;
+
+  // the room draws its first edge and skips the next one, whatever the target layer
+  EdgeMarkerBuilder builder;
+  const auto result = builder.makeGraphEdgeMarkers(
+      std_msgs::Header(), graph, configs, viz_config, "edges_");
+  ASSERT_EQ(result.markers.size(), 2u);
+  EXPECT_EQ(result.markers[0].points.size(), 2u);
+  EXPECT_EQ(result.markers[1].points.size(), 2u);
+}
+
+TEST(EdgeMarkerBuilder, ResultsAreIndependent) {
+  const auto graph = makeGraph();
+  const auto configs = makeConfigs();
+  auto viz_config = VisualizerConfig::__getDefault__();
+  viz_config.collapse_layers = true;
+
+  EdgeMarkerBuilder builder;
+  const auto first = builder.makeGraphEdgeMarkers(
+      std_msgs::Header(), graph, configs, viz_config, "edges_");
+
+  // redrawing with a filter reuses the builder without touching earlier results
+  const auto filter = [](const SceneGraphNode& node) {
+    return node.layer != DsgLayers::ROOMS;
+  };
+  const auto second = builder.makeGraphEdgeMarkers(
+      std_msgs::Header(), graph, configs, viz_config, "edges_", filter);
+  ASSERT_EQ(second.markers.size(), 1u);
+  EXPECT_EQ(second.markers[0].ns, "edges_3_2");
+
+  ASSERT_EQ(first.markers.size(), 2u);
+  EXPECT_EQ(first.markers[1].points.size(), 4u);
+}
+
+TEST(EdgeMarkerBuilder, SkipsHiddenLayers) {
+  const auto graph = makeGraph();
+  auto configs = makeConfigs();
+  configs[DsgLayers::OBJECTS].visualize = false;
+  auto viz_config = VisualizerConfig::__getDefault__();
+  viz_config.collapse_layers = true;
+
+  EdgeMarkerBuilder builder;
+  const auto result = builder.makeGraphEdgeMarkers(
+      std_msgs::Header(), graph, configs, viz_config, "edges_");
+  ASSERT_EQ(result.markers.size(), 1u);
+  EXPECT_EQ(result.markers[0].ns, "edges_4_3");
+  EXPECT_EQ(result.markers[0].points.size(), 2u);
+}
+
+}  // namespace hydra
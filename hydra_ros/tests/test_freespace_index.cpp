@@ -0,0 +1,79 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/freespace_index.h>
+
+namespace hydra {
+
+TEST(FreespaceIndex, QueryInsideSpheres) {
+  FreespaceIndex index(0.5);
+  index.updateSphere(0, Eigen::Vector3d::Zero(), 1.0);
+  index.updateSphere(1, Eigen::Vector3d(3.0, 0.0, 0.0), 0.5);
+  EXPECT_EQ(index.numSpheres(), 2u);
+
+  EXPECT_TRUE(index.inFreespace(Eigen::Vector3d(0.9, 0.0, 0.0)));
+  EXPECT_TRUE(index.inFreespace(Eigen::Vector3d(0.0, -0.9, 0.0)));
+  EXPECT_FALSE(index.inFreespace(Eigen::Vector3d(0.8, 0.8, 0.0)));
+  EXPECT_TRUE(index.inFreespace(Eigen::Vector3d(3.2, 0.0, 0.0)));
+  EXPECT_FALSE(index.inFreespace(Eigen::Vector3d(2.0, 0.0, 0.0)));
+  EXPECT_FALSE(index.inFreespace(Eigen::Vector3d(-10.0, 5.0, 2.0)));
+
+  // clearance shrinks the free-space spheres
+  EXPECT_TRUE(index.inFreespace(Eigen::Vector3d(0.4, 0.0, 0.0), 0.5));
+  EXPECT_FALSE(index.inFreespace(Eigen::Vector3d(0.6, 0.0, 0.0), 0.5));
+  EXPECT_FALSE(index.inFreespace(Eigen::Vector3d(3.0, 0.0, 0.0), 0.6));
+}
+
+TEST(FreespaceIndex, UpdateAndRemove) {
+  FreespaceIndex index(0.5);
+  index.updateSphere(0, Eigen::Vector3d::Zero(), 1.0);
+  EXPECT_TRUE(index.inFreespace(Eigen::Vector3d(-0.5, 0.0, 0.0)));
+
+  // moving a sphere clears the cells it used to cover
+  index.updateSphere(0, Eigen::Vector3d(5.0, 0.0, 0.0), 1.0);
+  EXPECT_EQ(index.numSpheres(), 1u);
+  EXPECT_FALSE(index.inFreespace(Eigen::Vector3d(-0.5, 0.0, 0.0)));
+  EXPECT_TRUE(index.inFreespace(Eigen::Vector3d(5.5, 0.0, 0.0)));
+
+  index.removeSphere(0);
+  EXPECT_EQ(index.numSpheres(), 0u);
+  EXPECT_FALSE(index.inFreespace(Eigen::Vector3d(5.5, 0.0, 0.0)));
+
+  // spheres with no free space are not tracked
+  index.updateSphere(1, Eigen::Vector3d::Zero(), 0.0);
+  EXPECT_EQ(index.numSpheres(), 0u);
+}
+
+}  // namespace hydra
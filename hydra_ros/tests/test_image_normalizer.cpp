@@ -0,0 +1,103 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/image_normalizer.h>
+
+#include <limits>
+
+namespace hydra {
+
+TEST(ImageNormalizer, NormalizesDepth) {
+  ImageNormalizer::Config config;
+  config.normalize_depth = true;
+  config.min_depth_m = 0.5f;
+  config.max_depth_m = 4.0f;
+  ImageNormalizer normalizer(config);
+
+  cv::Mat raw_mm(1, 4, CV_16UC1);
+  raw_mm.at<uint16_t>(0, 0) = 100;
+  raw_mm.at<uint16_t>(0, 1) = 1500;
+  raw_mm.at<uint16_t>(0, 2) = 4000;
+  raw_mm.at<uint16_t>(0, 3) = 5000;
+
+  cv::Mat depth;
+  ASSERT_TRUE(normalizer.normalizeDepth(raw_mm, depth));
+  ASSERT_EQ(depth.type(), CV_32FC1);
+  EXPECT_EQ(depth.at<float>(0, 0), 0.0f);
+  EXPECT_NEAR(depth.at<float>(0, 1), 1.5f, 1.0e-6f);
+  EXPECT_NEAR(depth.at<float>(0, 2), 4.0f, 1.0e-6f);
+  EXPECT_EQ(depth.at<float>(0, 3), 0.0f);
+
+  cv::Mat raw_m(1, 3, CV_32FC1);
+  raw_m.at<float>(0, 0) = std::numeric_limits<float>::quiet_NaN();
+  raw_m.at<float>(0, 1) = 2.0f;
+  raw_m.at<float>(0, 2) = 0.2f;
+  ASSERT_TRUE(normalizer.normalizeDepth(raw_m, depth));
+  EXPECT_EQ(depth.at<float>(0, 0), 0.0f);
+  EXPECT_EQ(depth.at<float>(0, 1), 2.0f);
+  EXPECT_EQ(depth.at<float>(0, 2), 0.0f);
+
+  cv::Mat unsupported(1, 1, CV_32SC1);
+  EXPECT_FALSE(normalizer.normalizeDepth(unsupported, depth));
+}
+
+TEST(ImageNormalizer, RemapsLabels) {
+  ImageNormalizer::Config config;
+  config.label_remapping = {{1, 10}, {3, 7}};
+  ImageNormalizer normalizer(config);
+  EXPECT_TRUE(normalizer.remapsLabels());
+
+  cv::Mat raw(1, 5, CV_8UC1);
+  for (int i = 0; i < 5; ++i) {
+    raw.at<uint8_t>(0, i) = i;
+  }
+
+  cv::Mat labels;
+  ASSERT_TRUE(normalizer.remapLabels(raw, labels));
+  ASSERT_EQ(labels.type(), CV_32SC1);
+  const std::vector<int32_t> expected{0, 10, 2, 7, 4};
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(labels.at<int32_t>(0, i), expected[i]) << "index: " << i;
+  }
+
+  cv::Mat raw_int(1, 2, CV_32SC1);
+  raw_int.at<int32_t>(0, 0) = -1;
+  raw_int.at<int32_t>(0, 1) = 3;
+  ASSERT_TRUE(normalizer.remapLabels(raw_int, labels));
+  EXPECT_EQ(labels.at<int32_t>(0, 0), -1);
+  EXPECT_EQ(labels.at<int32_t>(0, 1), 7);
+}
+
+}  // namespace hydra
@@ -0,0 +1,131 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/backend/incremental_pose_graph.h>
+#include <spark_dsg/node_attributes.h>
+
+namespace hydra {
+
+using pose_graph_tools_msgs::PoseGraph;
+using pose_graph_tools_msgs::PoseGraphEdge;
+using Update = IncrementalPoseGraph::Update;
+
+namespace {
+
+inline constexpr char kPrefix = 'a';
+
+void addPose(DynamicSceneGraph& graph, size_t index) {
+  const Eigen::Vector3d pos(index, 0.0, 0.0);
+  auto attrs = std::make_unique<AgentNodeAttributes>(
+      Eigen::Quaterniond::Identity(), pos, NodeSymbol('x', index));
+  graph.emplaceNode(DsgLayers::AGENTS,
+                    kPrefix,
+                    std::chrono::nanoseconds(10 * (index + 1)),
+                    std::move(attrs));
+}
+
+}  // namespace
+
+TEST(IncrementalPoseGraph, SendsOnlyNewPoses) {
+  DynamicSceneGraph graph;
+  addPose(graph, 0);
+  addPose(graph, 1);
+  const auto& agents = graph.getLayer(DsgLayers::AGENTS, kPrefix);
+
+  IncrementalPoseGraph tracker(0.0);
+  PoseGraph msg;
+  EXPECT_EQ(tracker.update(100, agents, 3, msg), Update::FULL);
+  EXPECT_EQ(tracker.update(200, agents, 3, msg), Update::NONE);
+
+  addPose(graph, 2);
+  addPose(graph, 3);
+  ASSERT_EQ(tracker.update(300, agents, 3, msg), Update::DELTA);
+  ASSERT_EQ(msg.nodes.size(), 2u);
+  EXPECT_EQ(msg.nodes[0].key, 2u);
+  EXPECT_EQ(msg.nodes[0].robot_id, 3);
+  EXPECT_DOUBLE_EQ(msg.nodes[1].pose.position.x, 3.0);
+
+  // the first edge links to the last pose of the previous message
+  ASSERT_EQ(msg.edges.size(), 2u);
+  EXPECT_EQ(msg.edges[0].key_from, 1u);
+  EXPECT_EQ(msg.edges[0].key_to, 2u);
+  EXPECT_EQ(msg.edges[0].type, PoseGraphEdge::ODOM);
+  EXPECT_DOUBLE_EQ(msg.edges[0].pose.position.x, 1.0);
+  EXPECT_EQ(msg.edges[1].key_from, 2u);
+  EXPECT_EQ(msg.edges[1].key_to, 3u);
+
+  EXPECT_EQ(tracker.update(400, agents, 3, msg), Update::NONE);
+}
+
+TEST(IncrementalPoseGraph, MovedPosesRequireFullGraph) {
+  DynamicSceneGraph graph;
+  addPose(graph, 0);
+  addPose(graph, 1);
+  const auto& agents = graph.getLayer(DsgLayers::AGENTS, kPrefix);
+
+  IncrementalPoseGraph tracker(0.0);
+  PoseGraph msg;
+  EXPECT_EQ(tracker.update(100, agents, 0, msg), Update::FULL);
+
+  // an optimization moves a pose that was already sent
+  graph.getNode(NodeSymbol(kPrefix, 0)).attributes().position.x() = 0.5;
+  addPose(graph, 2);
+  EXPECT_EQ(tracker.update(200, agents, 0, msg), Update::FULL);
+
+  addPose(graph, 3);
+  ASSERT_EQ(tracker.update(300, agents, 0, msg), Update::DELTA);
+  EXPECT_EQ(msg.nodes.size(), 1u);
+}
+
+TEST(IncrementalPoseGraph, RefreshesOnRequestAndPeriod) {
+  DynamicSceneGraph graph;
+  addPose(graph, 0);
+  const auto& agents = graph.getLayer(DsgLayers::AGENTS, kPrefix);
+
+  IncrementalPoseGraph tracker(1.0);
+  PoseGraph msg;
+  EXPECT_EQ(tracker.update(0, agents, 0, msg), Update::FULL);
+
+  // e.g., a new subscriber connected
+  tracker.requestRefresh();
+  EXPECT_EQ(tracker.update(100, agents, 0, msg), Update::FULL);
+
+  addPose(graph, 1);
+  EXPECT_EQ(tracker.update(500'000'000, agents, 0, msg), Update::DELTA);
+  EXPECT_EQ(tracker.update(1'000'000'100, agents, 0, msg), Update::FULL);
+}
+
+}  // namespace hydra
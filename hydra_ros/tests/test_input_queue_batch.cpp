@@ -0,0 +1,91 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/input_queue_batch.h>
+
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+TEST(InputQueueBatch, PushesInOrder) {
+  InputQueue<int> queue;
+  const std::vector<int> values{1, 2, 3, 4};
+  EXPECT_EQ(pushBatch(queue, values.begin(), values.end()), 4u);
+  ASSERT_EQ(queue.size(), 4u);
+  for (const auto value : values) {
+    EXPECT_EQ(queue.pop(), value);
+  }
+
+  EXPECT_EQ(pushBatch(queue, values.end(), values.end()), 0u);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(InputQueueBatch, RespectsMaxSize) {
+  InputQueue<int> queue(3);
+  queue.push(0);
+  const std::vector<int> values{1, 2, 3, 4};
+  EXPECT_EQ(pushBatch(queue, values.begin(), values.end()), 2u);
+  ASSERT_EQ(queue.size(), 3u);
+  EXPECT_EQ(queue.pop(), 0);
+  EXPECT_EQ(queue.pop(), 1);
+  EXPECT_EQ(queue.pop(), 2);
+}
+
+TEST(InputQueueBatch, ConsumerSeesWholeBatch) {
+  InputQueue<int> queue;
+  std::vector<int> values(100);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = i;
+  }
+
+  size_t size_on_wakeup = 0;
+  std::thread consumer([&]() {
+    // size() takes the queue lock, so it never sees part of a batch
+    while (queue.empty()) {
+      std::this_thread::yield();
+    }
+
+    size_on_wakeup = queue.size();
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  pushBatch(queue, values.begin(), values.end());
+  consumer.join();
+  EXPECT_EQ(size_on_wakeup, values.size());
+}
+
+}  // namespace hydra
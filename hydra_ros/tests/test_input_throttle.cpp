@@ -0,0 +1,85 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/input_throttle.h>
+
+namespace hydra {
+
+using Decision = InputThrottle::Decision;
+
+TEST(InputThrottle, SkipsLowMotionFramesUnderLoad) {
+  InputThrottle::Config config;
+  config.enable = true;
+  config.target_latency_s = 0.5;
+  config.max_queue_size = 3;
+  config.min_translation_m = 0.1;
+  config.max_consecutive_skips = 2;
+  InputThrottle throttle(config);
+
+  const Eigen::Quaterniond q = Eigen::Quaterniond::Identity();
+  EXPECT_EQ(throttle.update(0.1, 0, Eigen::Vector3d::Zero(), q), Decision::KEEP);
+
+  // not overloaded: frames are kept even without motion
+  EXPECT_EQ(throttle.update(0.1, 0, Eigen::Vector3d::Zero(), q), Decision::KEEP);
+
+  // overloaded without motion
+  EXPECT_EQ(throttle.update(0.8, 0, Eigen::Vector3d::Zero(), q),
+            Decision::SKIP_LATENCY);
+  EXPECT_EQ(throttle.update(0.1, 5, Eigen::Vector3d::Zero(), q), Decision::SKIP_QUEUE);
+
+  // too many consecutive skips
+  EXPECT_EQ(throttle.update(0.8, 5, Eigen::Vector3d::Zero(), q), Decision::KEEP);
+
+  // overloaded, but the frame adds enough motion
+  EXPECT_EQ(throttle.update(0.8, 5, Eigen::Vector3d(0.5, 0.0, 0.0), q), Decision::KEEP);
+
+  // far behind: motion no longer saves the frame
+  EXPECT_EQ(throttle.update(1.5, 0, Eigen::Vector3d(1.0, 0.0, 0.0), q),
+            Decision::SKIP_LATENCY);
+
+  EXPECT_EQ(throttle.numKept(), 4u);
+  EXPECT_EQ(throttle.numSkippedLatency(), 2u);
+  EXPECT_EQ(throttle.numSkippedQueue(), 1u);
+}
+
+TEST(InputThrottle, DisabledKeepsEverything) {
+  InputThrottle throttle(InputThrottle::Config{});
+  const Eigen::Quaterniond q = Eigen::Quaterniond::Identity();
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(throttle.update(10.0, 100, Eigen::Vector3d::Zero(), q), Decision::KEEP);
+  }
+}
+
+}  // namespace hydra
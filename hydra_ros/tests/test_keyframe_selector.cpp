@@ -0,0 +1,92 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/keyframe_selector.h>
+
+namespace hydra {
+
+namespace {
+
+Eigen::Isometry3d makePose(double x, double yaw = 0.0) {
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation() << x, 0.0, 0.0;
+  pose.linear() = Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+  return pose;
+}
+
+}  // namespace
+
+TEST(KeyframeSelector, AcceptsEverythingWhenDisabled) {
+  KeyframeSelector selector({});
+  EXPECT_TRUE(selector.accept(0, makePose(0.0)));
+  EXPECT_TRUE(selector.accept(1, makePose(0.0)));
+  EXPECT_EQ(selector.numAccepted(), 2u);
+  EXPECT_EQ(selector.numRejected(), 0u);
+}
+
+TEST(KeyframeSelector, RejectsStationaryFrames) {
+  KeyframeSelector::Config config;
+  config.enable = true;
+  config.min_translation = 0.1;
+  config.min_rotation = 0.2;
+  KeyframeSelector selector(config);
+
+  EXPECT_TRUE(selector.accept(0, makePose(0.0)));
+  EXPECT_FALSE(selector.accept(10, makePose(0.05)));
+  // motion is measured against the last keyframe, not the last frame
+  EXPECT_TRUE(selector.accept(20, makePose(0.1)));
+  EXPECT_FALSE(selector.accept(30, makePose(0.1, 0.1)));
+  EXPECT_TRUE(selector.accept(40, makePose(0.1, 0.25)));
+  EXPECT_EQ(selector.numAccepted(), 3u);
+  EXPECT_EQ(selector.numRejected(), 2u);
+
+  selector.reset();
+  EXPECT_TRUE(selector.accept(50, makePose(0.1, 0.25)));
+}
+
+TEST(KeyframeSelector, EnforcesMinimumSeparation) {
+  KeyframeSelector::Config config;
+  config.enable = true;
+  config.min_translation = 0.1;
+  config.min_separation_s = 1.0;
+  KeyframeSelector selector(config);
+
+  EXPECT_TRUE(selector.accept(0, makePose(0.0)));
+  EXPECT_FALSE(selector.accept(500000000, makePose(1.0)));
+  EXPECT_TRUE(selector.accept(1000000000, makePose(1.0)));
+  EXPECT_FALSE(selector.accept(500000000, makePose(2.0)));
+}
+
+}  // namespace hydra
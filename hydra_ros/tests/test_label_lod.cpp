@@ -0,0 +1,113 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/label_lod.h>
+
+namespace hydra {
+
+namespace {
+
+std::vector<LabelLod::Label> makeLabels(size_t num_labels, double spacing) {
+  std::vector<LabelLod::Label> labels;
+  for (size_t i = 0; i < num_labels; ++i) {
+    labels.push_back({i, "label_" + std::to_string(i), {i * spacing, 0.0, 0.0}});
+  }
+  return labels;
+}
+
+}  // namespace
+
+TEST(LabelLod, CullsByViewRadius) {
+  LabelLod::Config config;
+  config.enable = true;
+  config.view_radius = 2.5;
+  LabelLod lod(config);
+
+  const auto labels = makeLabels(10, 1.0);
+  auto result = lod.update(0, labels, Eigen::Vector3d(5.0, 0.0, 0.0));
+  EXPECT_EQ(result.visible, std::set<uint64_t>({3, 4, 5, 6, 7}));
+  EXPECT_EQ(result.to_publish.size(), 5u);
+
+  // moving the viewer only publishes the labels that became visible
+  result = lod.update(0, labels, Eigen::Vector3d(6.0, 0.0, 0.0));
+  EXPECT_EQ(result.visible, std::set<uint64_t>({4, 5, 6, 7, 8}));
+  EXPECT_EQ(result.to_publish, std::vector<size_t>({8}));
+}
+
+TEST(LabelLod, ThinsDenseLabels) {
+  LabelLod::Config config;
+  config.enable = true;
+  config.min_spacing = 1.0;
+  LabelLod lod(config);
+
+  const auto labels = makeLabels(10, 0.25);
+  const auto result = lod.update(0, labels, std::nullopt);
+  EXPECT_EQ(result.visible, std::set<uint64_t>({0, 4, 8}));
+}
+
+TEST(LabelLod, RepublishesChangedLabels) {
+  LabelLod::Config config;
+  config.enable = true;
+  LabelLod lod(config);
+
+  auto labels = makeLabels(3, 1.0);
+  EXPECT_EQ(lod.update(0, labels, std::nullopt).to_publish.size(), 3u);
+  EXPECT_TRUE(lod.update(0, labels, std::nullopt).to_publish.empty());
+
+  labels[1].text = "renamed";
+  labels[2].position.z() = 1.0;
+  EXPECT_EQ(lod.update(0, labels, std::nullopt).to_publish,
+            std::vector<size_t>({1, 2}));
+
+  // layers are tracked independently and reset forgets everything
+  EXPECT_EQ(lod.update(1, labels, std::nullopt).to_publish.size(), 3u);
+  lod.reset();
+  EXPECT_EQ(lod.update(0, labels, std::nullopt).to_publish.size(), 3u);
+}
+
+TEST(LabelLod, DetectsViewerMotion) {
+  LabelLod::Config config;
+  config.enable = true;
+  config.view_radius = 10.0;
+  config.view_update_distance = 1.0;
+  LabelLod lod(config);
+
+  EXPECT_FALSE(lod.viewerMoved(std::nullopt));
+  EXPECT_TRUE(lod.viewerMoved(Eigen::Vector3d::Zero()));
+  EXPECT_FALSE(lod.viewerMoved(Eigen::Vector3d(0.5, 0.0, 0.0)));
+  EXPECT_TRUE(lod.viewerMoved(Eigen::Vector3d(1.5, 0.0, 0.0)));
+}
+
+}  // namespace hydra
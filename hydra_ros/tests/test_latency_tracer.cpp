@@ -0,0 +1,101 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/latency_tracer.h>
+#include <hydra_ros/utils/metrics.h>
+
+namespace hydra {
+
+TEST(LatencyTracer, IgnoresMarksWhenDisabled) {
+  auto& tracer = LatencyTracer::instance();
+  tracer.clear();
+  tracer.mark(10, "receive", 20);
+  EXPECT_TRUE(tracer.frames().empty());
+}
+
+TEST(LatencyTracer, RecordsStagesPerFrame) {
+  auto& tracer = LatencyTracer::instance();
+  tracer.clear();
+  MetricsRegistry::instance().clear();
+
+  LatencyTracer::Config config;
+  config.enable = true;
+  config.max_frames = 2;
+  tracer.start(config);
+  tracer.mark(1000, "receive", 2000);
+  tracer.mark(1000, "frontend", 5000);
+  tracer.mark(3000, "receive", 4000);
+  tracer.mark(4000, "receive", 4500);
+  tracer.stop();
+
+  // oldest frame is dropped and marks after stopping are ignored
+  tracer.mark(5000, "receive", 6000);
+  const auto frames = tracer.frames();
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames.count(1000), 0u);
+  ASSERT_EQ(frames.at(3000).size(), 1u);
+  EXPECT_EQ(frames.at(3000)[0].stage, "receive");
+
+  const auto latencies = MetricsRegistry::instance().takeLatencies();
+  ASSERT_EQ(latencies.count("trace/receive"), 1u);
+  EXPECT_EQ(latencies.at("trace/receive").count, 3u);
+  EXPECT_EQ(latencies.at("trace/frontend").count, 1u);
+}
+
+TEST(LatencyTracer, ExportsChromeTrace) {
+  auto& tracer = LatencyTracer::instance();
+  tracer.clear();
+
+  LatencyTracer::Config config;
+  config.enable = true;
+  tracer.start(config);
+  tracer.mark(1000, "receive", 2500);
+  tracer.mark(1000, "frontend", 1002000);
+  tracer.stop();
+
+  const auto trace = tracer.toChromeTrace();
+  EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  // spans start at the sensor stamp and then at the previous stage
+  const std::string receive_begin =
+      "\"name\":\"receive\",\"cat\":\"frame\",\"ph\":\"b\",\"id\":\"1000\""
+      ",\"pid\":1,\"tid\":1,\"ts\":1.000";
+  const std::string frontend_end =
+      "\"name\":\"frontend\",\"cat\":\"frame\",\"ph\":\"e\",\"id\":\"1000\""
+      ",\"pid\":1,\"tid\":1,\"ts\":1002.000";
+  EXPECT_NE(trace.find(receive_begin), std::string::npos);
+  EXPECT_NE(trace.find(frontend_end), std::string::npos);
+}
+
+}  // namespace hydra
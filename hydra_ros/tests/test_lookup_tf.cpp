@@ -0,0 +1,111 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/lookup_tf.h>
+
+#include <chrono>
+#include <tuple>
+
+namespace hydra {
+
+namespace {
+
+// buffer with transforms from 100 to 105 seconds, keeping 10 seconds of history
+struct TestBuffer {
+  TestBuffer() : buffer(ros::Duration(10.0)) {
+    for (int i = 0; i <= 5; ++i) {
+      geometry_msgs::TransformStamped msg;
+      msg.header.frame_id = "odom";
+      msg.header.stamp = ros::Time(100.0 + i);
+      msg.child_frame_id = "robot";
+      msg.transform.translation.x = i;
+      msg.transform.rotation.w = 1.0;
+      buffer.setTransform(msg, "test");
+    }
+  }
+
+  // returns the result and how long the lookup took in seconds
+  std::pair<PoseStatus, double> wait(double stamp_s,
+                                     std::optional<double> max_age_s = std::nullopt) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = waitForTransform(
+        buffer, ros::Time(stamp_s), "odom", "robot", 2.0, 10, max_age_s);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return {result, elapsed.count()};
+  }
+
+  tf2_ros::Buffer buffer;
+};
+
+}  // namespace
+
+TEST(LookupTf, WaitForAvailableTransform) {
+  TestBuffer buffer;
+  const auto [result, elapsed_s] = buffer.wait(103.5);
+  ASSERT_TRUE(result.is_valid);
+  EXPECT_NEAR(result.target_p_source.x(), 3.5, 1.0e-6);
+  EXPECT_LT(elapsed_s, 1.0);
+}
+
+TEST(LookupTf, StampOlderThanBufferFailsEarly) {
+  TestBuffer buffer;
+  const auto [result, elapsed_s] = buffer.wait(50.0);
+  EXPECT_FALSE(result.is_valid);
+  EXPECT_LT(elapsed_s, 1.0);
+}
+
+TEST(LookupTf, StampOlderThanMaxAgeFailsEarly) {
+  TestBuffer buffer;
+  // 2 seconds older than the latest transform, but still in the buffer
+  auto [result, elapsed_s] = buffer.wait(103.0, 1.5);
+  EXPECT_FALSE(result.is_valid);
+  EXPECT_LT(elapsed_s, 1.0);
+
+  std::tie(result, elapsed_s) = buffer.wait(103.0, 2.5);
+  ASSERT_TRUE(result.is_valid);
+  EXPECT_NEAR(result.target_p_source.x(), 3.0, 1.0e-6);
+}
+
+TEST(LookupTf, NewerStampsIgnoreMaxAge) {
+  TestBuffer buffer;
+  // stamps past the latest transform wait until the timeout
+  const auto [result, elapsed_s] = buffer.wait(106.0, 0.5);
+  EXPECT_FALSE(result.is_valid);
+  EXPECT_GE(elapsed_s, 1.5);
+}
+
+}  // namespace hydra
@@ -0,0 +1,93 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/mat_pool.h>
+
+namespace hydra {
+
+TEST(MatPool, ReusesReleasedBuffers) {
+  auto pool = MatPool::create(2);
+  const uchar* first_data = nullptr;
+  {
+    cv::Mat mat;
+    pool->attach(mat);
+    mat.create(480, 640, CV_32FC3);
+    mat.setTo(cv::Scalar::all(1.0));
+    first_data = mat.data;
+    EXPECT_EQ(pool->numIdle(), 0u);
+  }
+
+  EXPECT_EQ(pool->numIdle(), 1u);
+
+  cv::Mat mat;
+  pool->attach(mat);
+  mat.create(480, 640, CV_32FC3);
+  EXPECT_EQ(mat.data, first_data);
+  EXPECT_EQ(pool->numAllocated(), 1u);
+  EXPECT_EQ(pool->numReused(), 1u);
+
+  // buffers that are much too large are not handed out for small matrices
+  mat.release();
+  cv::Mat small;
+  pool->attach(small);
+  small.create(10, 10, CV_8UC1);
+  EXPECT_NE(small.data, first_data);
+  EXPECT_EQ(pool->numAllocated(), 2u);
+}
+
+TEST(MatPool, MatricesOutliveThePool) {
+  cv::Mat mat;
+  {
+    auto pool = MatPool::create(1);
+    pool->attach(mat);
+    mat.create(4, 4, CV_32SC1);
+  }
+
+  mat.setTo(cv::Scalar::all(3));
+  EXPECT_EQ(mat.at<int32_t>(3, 3), 3);
+  mat.release();
+}
+
+TEST(MatPool, CopiesUseThePool) {
+  auto pool = MatPool::create(1);
+  cv::Mat source(8, 8, CV_8UC3, cv::Scalar::all(7));
+  cv::Mat copy;
+  pool->attach(copy);
+  source.copyTo(copy);
+  EXPECT_EQ(pool->numAllocated(), 1u);
+  EXPECT_EQ(copy.at<cv::Vec3b>(7, 7), cv::Vec3b(7, 7, 7));
+}
+
+}  // namespace hydra
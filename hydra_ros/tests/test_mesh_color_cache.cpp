@@ -0,0 +1,128 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/mesh_color_adaptor.h>
+
+#include <atomic>
+
+namespace hydra {
+
+namespace {
+
+// colors vertices by label and counts how often it is asked for a color
+struct CountingColoring : public MeshColoring {
+  spark_dsg::Color getVertexColor(const spark_dsg::Mesh& mesh,
+                                  size_t i) const override {
+    ++num_calls;
+    return spark_dsg::Color(mesh.label(i), 0, 0);
+  }
+
+  std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh& mesh,
+                                       size_t i) const override {
+    return mesh.label(i);
+  }
+
+  mutable std::atomic<size_t> num_calls{0};
+};
+
+// same as above, but without a key so every vertex is always recomputed
+struct UnkeyedColoring : public CountingColoring {
+  std::optional<uint64_t> getVertexKey(const spark_dsg::Mesh&,
+                                       size_t) const override {
+    return std::nullopt;
+  }
+};
+
+spark_dsg::Mesh makeMesh(size_t num_vertices) {
+  spark_dsg::Mesh mesh(true, false, true, false);
+  mesh.resizeVertices(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    mesh.labels[i] = i % 5;
+  }
+  return mesh;
+}
+
+}  // namespace
+
+TEST(MeshColorCache, OnlyChangedVertices) {
+  auto mesh = makeMesh(100);
+  const auto coloring = std::make_shared<CountingColoring>();
+  MeshColorCache cache(4);
+
+  const auto& colors = cache.update(mesh, coloring);
+  ASSERT_EQ(colors.size(), 100u);
+  EXPECT_EQ(cache.numUpdated(), 100u);
+  EXPECT_EQ(colors[7].r, 2);
+
+  cache.update(mesh, coloring);
+  EXPECT_EQ(cache.numUpdated(), 0u);
+  EXPECT_EQ(coloring->num_calls, 100u);
+
+  mesh.labels[7] = 4;
+  const auto& updated = cache.update(mesh, coloring);
+  EXPECT_EQ(cache.numUpdated(), 1u);
+  EXPECT_EQ(updated[7].r, 4);
+
+  // new vertices are always colored
+  mesh.resizeVertices(120);
+  cache.update(mesh, coloring);
+  EXPECT_EQ(cache.numUpdated(), 20u);
+}
+
+TEST(MeshColorCache, ColoringChanges) {
+  const auto mesh = makeMesh(50);
+  MeshColorCache cache;
+  cache.update(mesh, std::make_shared<CountingColoring>());
+  EXPECT_EQ(cache.numUpdated(), 50u);
+
+  const auto unkeyed = std::make_shared<UnkeyedColoring>();
+  cache.update(mesh, unkeyed);
+  EXPECT_EQ(cache.numUpdated(), 50u);
+  cache.update(mesh, unkeyed);
+  EXPECT_EQ(cache.numUpdated(), 50u);
+  EXPECT_EQ(unkeyed->num_calls, 100u);
+}
+
+TEST(MeshColorCache, AdaptorUsesCachedColors) {
+  const auto mesh = makeMesh(10);
+  MeshColorCache cache;
+  const auto& colors = cache.update(mesh, std::make_shared<CountingColoring>());
+  const MeshColorAdaptor adaptor(mesh, colors);
+  for (size_t i = 0; i < mesh.numVertices(); ++i) {
+    EXPECT_EQ(adaptor.getVertexColor(i).r, i % 5);
+  }
+}
+
+}  // namespace hydra
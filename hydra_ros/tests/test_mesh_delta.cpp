@@ -0,0 +1,192 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/mesh_delta.h>
+
+namespace hydra {
+
+Mesh::Ptr makeMesh(size_t num_vertices, size_t num_faces) {
+  auto mesh = std::make_shared<Mesh>(true, true, true, false);
+  mesh->resizeVertices(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    mesh->points[i] << i, 2.0 * i, 3.0 * i;
+    mesh->colors[i] = Color(i, 0, 0);
+    mesh->stamps[i] = 10 * i;
+    mesh->labels[i] = i % 3;
+  }
+
+  mesh->resizeFaces(num_faces);
+  for (size_t i = 0; i < num_faces; ++i) {
+    mesh->faces[i] = {i, i + 1, i + 2};
+  }
+
+  return mesh;
+}
+
+void expectMeshesEqual(const Mesh& lhs, const Mesh& rhs) {
+  ASSERT_EQ(lhs.numVertices(), rhs.numVertices());
+  ASSERT_EQ(lhs.numFaces(), rhs.numFaces());
+  for (size_t i = 0; i < lhs.numVertices(); ++i) {
+    EXPECT_EQ(lhs.points[i], rhs.points[i]) << "vertex " << i;
+    EXPECT_EQ(lhs.colors[i].r, rhs.colors[i].r) << "vertex " << i;
+    EXPECT_EQ(lhs.stamps[i], rhs.stamps[i]) << "vertex " << i;
+    EXPECT_EQ(lhs.labels[i], rhs.labels[i]) << "vertex " << i;
+  }
+
+  for (size_t i = 0; i < lhs.numFaces(); ++i) {
+    EXPECT_EQ(lhs.faces[i], rhs.faces[i]) << "face " << i;
+  }
+}
+
+TEST(MeshDelta, FullUpdate) {
+  const auto mesh = makeMesh(5, 3);
+  hydra_msgs::MeshDelta msg;
+  fillMeshDelta(nullptr, *mesh, msg);
+  EXPECT_TRUE(msg.full_update);
+  EXPECT_EQ(msg.vertex_indices.size(), 5u);
+  EXPECT_EQ(msg.face_indices.size(), 3u);
+
+  Mesh::Ptr result;
+  applyMeshDelta(msg, result);
+  ASSERT_TRUE(result);
+  EXPECT_FALSE(result->has_first_seen_stamps);
+  expectMeshesEqual(*mesh, *result);
+}
+
+TEST(MeshDelta, PartialUpdate) {
+  const auto prev = makeMesh(5, 3);
+  auto curr = makeMesh(7, 4);
+  curr->points[1] << -1.0, -1.0, -1.0;
+  curr->labels[2] = 10;
+
+  hydra_msgs::MeshDelta msg;
+  fillMeshDelta(prev.get(), *curr, msg);
+  EXPECT_FALSE(msg.full_update);
+  const std::vector<uint64_t> expected_vertices{1, 2, 5, 6};
+  EXPECT_EQ(msg.vertex_indices, expected_vertices);
+  const std::vector<uint64_t> expected_faces{3};
+  EXPECT_EQ(msg.face_indices, expected_faces);
+
+  auto result = std::make_shared<Mesh>(*prev);
+  applyMeshDelta(msg, result);
+  expectMeshesEqual(*curr, *result);
+
+  // shrinking the mesh only sends the new sizes and the reverted vertex
+  const auto smaller = makeMesh(2, 1);
+  hydra_msgs::MeshDelta shrink_msg;
+  fillMeshDelta(curr.get(), *smaller, shrink_msg);
+  EXPECT_EQ(shrink_msg.vertex_indices, std::vector<uint64_t>{1});
+  EXPECT_TRUE(shrink_msg.face_indices.empty());
+  applyMeshDelta(shrink_msg, result);
+  expectMeshesEqual(*smaller, *result);
+}
+
+TEST(MeshDelta, InvalidDelta) {
+  const auto prev = makeMesh(5, 3);
+  const auto curr = makeMesh(6, 3);
+  hydra_msgs::MeshDelta msg;
+  fillMeshDelta(prev.get(), *curr, msg);
+
+  Mesh::Ptr empty;
+  EXPECT_THROW(applyMeshDelta(msg, empty), std::runtime_error);
+
+  auto result = std::make_shared<Mesh>(*prev);
+  msg.positions.pop_back();
+  EXPECT_THROW(applyMeshDelta(msg, result), std::runtime_error);
+}
+
+TEST(MeshDelta, CompactEncoding) {
+  const auto prev = makeMesh(5, 3);
+  auto curr = makeMesh(7, 4);
+  curr->points[1] << -1.0, -1.0, -1.0;
+  curr->labels[2] = 10;
+
+  hydra_msgs::MeshDelta msg;
+  fillMeshDelta(prev.get(), *curr, msg);
+  const auto raw = msg;
+  // positions are multiples of the resolution, so the round trip is exact
+  encodeMeshDelta(msg, 0.25);
+  EXPECT_EQ(msg.encoding, hydra_msgs::MeshDelta::ENCODING_COMPACT);
+  EXPECT_TRUE(msg.vertex_indices.empty());
+  EXPECT_TRUE(msg.faces.empty());
+  EXPECT_FALSE(msg.compact_data.empty());
+
+  decodeMeshDelta(msg);
+  EXPECT_EQ(msg.encoding, hydra_msgs::MeshDelta::ENCODING_RAW);
+  EXPECT_EQ(msg.vertex_indices, raw.vertex_indices);
+  EXPECT_EQ(msg.positions, raw.positions);
+  EXPECT_EQ(msg.colors, raw.colors);
+  EXPECT_EQ(msg.stamps, raw.stamps);
+  EXPECT_EQ(msg.labels, raw.labels);
+  EXPECT_EQ(msg.face_indices, raw.face_indices);
+  EXPECT_EQ(msg.faces, raw.faces);
+
+  auto result = std::make_shared<Mesh>(*prev);
+  applyMeshDelta(msg, result);
+  expectMeshesEqual(*curr, *result);
+
+  // truncated data is rejected instead of producing a partial delta
+  auto truncated = raw;
+  encodeMeshDelta(truncated, 0.25);
+  truncated.compact_data.resize(truncated.compact_data.size() / 2);
+  EXPECT_THROW(decodeMeshDelta(truncated), std::runtime_error);
+}
+
+TEST(MeshDelta, CompactEncodingQuantizesAndFallsBackToRawColors) {
+  // more distinct colors than fit in a palette
+  auto mesh = std::make_shared<Mesh>(true, false, false, false);
+  mesh->resizeVertices(300);
+  for (size_t i = 0; i < mesh->numVertices(); ++i) {
+    mesh->points[i] << 0.1234 * i, -0.5678 * i, 10.0;
+    mesh->colors[i] = Color(i % 256, i / 256, 0);
+  }
+
+  hydra_msgs::MeshDelta msg;
+  fillMeshDelta(nullptr, *mesh, msg);
+  encodeMeshDelta(msg, 0.001);
+  decodeMeshDelta(msg);
+
+  Mesh::Ptr result;
+  applyMeshDelta(msg, result);
+  ASSERT_TRUE(result);
+  ASSERT_EQ(result->numVertices(), mesh->numVertices());
+  for (size_t i = 0; i < mesh->numVertices(); ++i) {
+    EXPECT_NEAR((result->points[i] - mesh->points[i]).norm(), 0.0, 1.0e-3);
+    EXPECT_EQ(result->colors[i].r, mesh->colors[i].r);
+    EXPECT_EQ(result->colors[i].g, mesh->colors[i].g);
+  }
+}
+
+}  // namespace hydra
@@ -0,0 +1,131 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/mesh_edge_cache.h>
+#include <hydra_ros/visualizer/visualizer_utilities.h>
+#include <spark_dsg/node_attributes.h>
+
+namespace hydra {
+
+namespace {
+
+void addNode(DynamicSceneGraph& graph,
+             NodeId node_id,
+             const Eigen::Vector3d& pos,
+             const std::vector<size_t>& connections) {
+  auto attrs = std::make_unique<Place2dNodeAttributes>();
+  attrs->position = pos;
+  attrs->pcl_mesh_connections = connections;
+  graph.emplaceNode(DsgLayers::PLACES, node_id, std::move(attrs));
+}
+
+std::shared_ptr<spark_dsg::Mesh> makeMesh(size_t num_vertices) {
+  auto mesh = std::make_shared<spark_dsg::Mesh>();
+  mesh->resizeVertices(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    mesh->points[i] = Eigen::Vector3f(i, 0.0, 0.0);
+  }
+  return mesh;
+}
+
+}  // namespace
+
+TEST(MeshEdgeCache, OnlyRebuildsChangedNodes) {
+  DynamicSceneGraph graph;
+  graph.setMesh(makeMesh(10));
+  addNode(graph, 0, Eigen::Vector3d::Zero(), {1, 2});
+  addNode(graph, 1, Eigen::Vector3d::UnitY(), {3});
+  addNode(graph, 2, Eigen::Vector3d::UnitZ(), {});
+
+  auto config = LayerConfig::__getDefault__();
+  const auto viz_config = VisualizerConfig::__getDefault__();
+  std_msgs::Header header;
+  const auto& layer = graph.getLayer(DsgLayers::PLACES);
+
+  MeshEdgeCache cache;
+  const auto first = cache.draw(header, config, viz_config, graph, layer, "edges");
+  EXPECT_EQ(cache.numRebuilt(), 3u);
+  EXPECT_EQ(cache.size(), 3u);
+
+  // same output as drawing without a cache
+  const auto expected =
+      makeMeshEdgesMarker(header, config, viz_config, graph, layer, "edges");
+  EXPECT_EQ(first.points, expected.points);
+  EXPECT_EQ(first.colors, expected.colors);
+
+  // nothing changed
+  auto result = cache.draw(header, config, viz_config, graph, layer, "edges");
+  EXPECT_EQ(cache.numRebuilt(), 0u);
+  EXPECT_EQ(result.points, expected.points);
+
+  // one changed node and one removed node
+  graph.getNode(1).attributes<Place2dNodeAttributes>().pcl_mesh_connections = {3, 4};
+  graph.removeNode(2);
+  result = cache.draw(header, config, viz_config, graph, layer, "edges");
+  EXPECT_EQ(cache.numRebuilt(), 1u);
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_EQ(result.points.size(), first.points.size() + 2);
+
+  // changing the settings rebuilds everything
+  config.interlayer_edge_alpha = 0.5 * config.interlayer_edge_alpha + 0.1;
+  cache.draw(header, config, viz_config, graph, layer, "edges");
+  EXPECT_EQ(cache.numRebuilt(), 2u);
+}
+
+TEST(MeshEdgeCache, MeshChangesInvalidate) {
+  DynamicSceneGraph graph;
+  auto mesh = makeMesh(10);
+  graph.setMesh(mesh);
+  addNode(graph, 0, Eigen::Vector3d::Zero(), {1, 2});
+
+  auto config = LayerConfig::__getDefault__();
+  const auto viz_config = VisualizerConfig::__getDefault__();
+  std_msgs::Header header;
+  const auto& layer = graph.getLayer(DsgLayers::PLACES);
+
+  MeshEdgeCache cache;
+  cache.draw(header, config, viz_config, graph, layer, "edges");
+  EXPECT_EQ(cache.numRebuilt(), 1u);
+
+  // moving a vertex the node connects to changes the mesh revision
+  mesh->points[1] = Eigen::Vector3f(1.0, 2.0, 0.0);
+  const auto result = cache.draw(header, config, viz_config, graph, layer, "edges");
+  EXPECT_EQ(cache.numRebuilt(), 1u);
+  ASSERT_EQ(result.points.size(), 6u);
+  EXPECT_DOUBLE_EQ(result.points[3].y, 2.0);
+}
+
+}  // namespace hydra
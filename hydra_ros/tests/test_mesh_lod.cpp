@@ -0,0 +1,163 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/mesh_lod.h>
+
+namespace hydra {
+
+namespace {
+
+// square grid in the xy-plane with two triangles per cell
+spark_dsg::Mesh::Ptr makeGridMesh(size_t num_cells, double spacing) {
+  auto mesh = std::make_shared<spark_dsg::Mesh>(true, false, false, false);
+  const size_t width = num_cells + 1;
+  mesh->resizeVertices(width * width);
+  for (size_t r = 0; r < width; ++r) {
+    for (size_t c = 0; c < width; ++c) {
+      const size_t i = r * width + c;
+      mesh->points[i] << c * spacing, r * spacing, 0.0;
+      mesh->colors[i] = spark_dsg::Color(r % 256, c % 256, 0);
+    }
+  }
+
+  for (size_t r = 0; r < num_cells; ++r) {
+    for (size_t c = 0; c < num_cells; ++c) {
+      const size_t i = r * width + c;
+      mesh->faces.push_back({i, i + 1, i + width});
+      mesh->faces.push_back({i + 1, i + width + 1, i + width});
+    }
+  }
+
+  return mesh;
+}
+
+MeshLod::Config makeConfig(std::vector<double> level_distances) {
+  MeshLod::Config config;
+  config.chunk_size = 1.0;
+  config.voxel_size = 0.2;
+  config.level_distances = level_distances;
+  return config;
+}
+
+}  // namespace
+
+TEST(MeshLod, GetLevel) {
+  MeshLod lod(makeConfig({1.0, 5.0}));
+  EXPECT_EQ(lod.getLevel(0.0), 0u);
+  EXPECT_EQ(lod.getLevel(0.99), 0u);
+  EXPECT_EQ(lod.getLevel(1.0), 1u);
+  EXPECT_EQ(lod.getLevel(4.0), 1u);
+  EXPECT_EQ(lod.getLevel(10.0), 2u);
+}
+
+TEST(MeshLod, FullResolutionMatchesInput) {
+  const auto mesh = makeGridMesh(40, 0.049);
+  MeshLod lod(makeConfig({1000.0}));
+  lod.update(*mesh);
+  EXPECT_EQ(lod.numChunks(), 4u);
+
+  const auto result = lod.extract(*mesh, Eigen::Vector3f::Zero());
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->numFaces(), mesh->numFaces());
+  // vertices on chunk borders are duplicated between chunks
+  EXPECT_GE(result->numVertices(), mesh->numVertices());
+  EXPECT_EQ(result->colors.size(), result->numVertices());
+}
+
+TEST(MeshLod, CoarseLevelsAwayFromFocus) {
+  const auto mesh = makeGridMesh(40, 0.049);
+  MeshLod lod(makeConfig({0.5}));
+  lod.update(*mesh);
+
+  const auto far = lod.extract(*mesh, Eigen::Vector3f(100.0, 100.0, 0.0));
+  // 0.2 m clusters leave roughly 11 x 11 vertices of the 41 x 41 grid
+  EXPECT_LT(far->numFaces(), mesh->numFaces() / 10);
+  EXPECT_GT(far->numFaces(), 0u);
+
+  // only the chunk containing the focus point is at full resolution
+  const auto near = lod.extract(*mesh, Eigen::Vector3f(0.5, 0.5, 0.0));
+  EXPECT_GT(near->numFaces(), mesh->numFaces() / 4);
+  EXPECT_LT(near->numFaces(), mesh->numFaces() / 2);
+
+  for (const auto& face : near->faces) {
+    for (const auto vertex : face) {
+      ASSERT_LT(vertex, near->numVertices());
+    }
+  }
+}
+
+TEST(MeshLod, FilteredChunksAreSkipped) {
+  const auto mesh = makeGridMesh(40, 0.049);
+  MeshLod lod(makeConfig({1000.0}));
+  lod.update(*mesh);
+
+  // only keep the chunks with x < 1
+  const auto result = lod.extract(
+      *mesh,
+      Eigen::Vector3f::Zero(),
+      nullptr,
+      [](const Eigen::Vector3f& lower, const Eigen::Vector3f&) {
+        return lower.x() < 1.0f;
+      });
+  EXPECT_GT(result->numFaces(), 0u);
+  EXPECT_LT(result->numFaces(), mesh->numFaces());
+  // faces are assigned by their first vertex, so they can reach one cell further
+  for (const auto& point : result->points) {
+    EXPECT_LT(point.x(), 1.1f);
+  }
+}
+
+TEST(MeshLod, IncrementalUpdate) {
+  auto mesh = makeGridMesh(40, 0.049);
+  MeshLod lod(makeConfig({0.5}));
+  lod.update(*mesh);
+  EXPECT_EQ(lod.numChanged(), 4u);
+
+  lod.update(*mesh);
+  EXPECT_EQ(lod.numChanged(), 0u);
+
+  // vertex in the middle of the first chunk
+  mesh->points[10 * 41 + 10].z() = 0.1;
+  lod.update(*mesh);
+  EXPECT_EQ(lod.numChanged(), 1u);
+  EXPECT_EQ(lod.numChunks(), 4u);
+
+  // faces in the last chunk are removed
+  const auto small = makeGridMesh(10, 0.049);
+  lod.update(*small);
+  EXPECT_EQ(lod.numChunks(), 1u);
+}
+
+}  // namespace hydra
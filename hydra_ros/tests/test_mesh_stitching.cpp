@@ -0,0 +1,102 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/mesh_stitching.h>
+
+namespace hydra {
+
+namespace {
+
+// two triangles forming the unit square offset along x
+Mesh makeSquare(float x_offset, uint32_t label) {
+  Mesh mesh(true, false, true, false);
+  mesh.resizeVertices(4);
+  mesh.points[0] = Mesh::Pos(x_offset, 0.0f, 0.0f);
+  mesh.points[1] = Mesh::Pos(x_offset + 1.0f, 0.0f, 0.0f);
+  mesh.points[2] = Mesh::Pos(x_offset + 1.0f, 1.0f, 0.0f);
+  mesh.points[3] = Mesh::Pos(x_offset, 1.0f, 0.0f);
+  for (auto& l : mesh.labels) {
+    l = label;
+  }
+
+  mesh.faces = {{0, 1, 2}, {0, 2, 3}};
+  return mesh;
+}
+
+}  // namespace
+
+TEST(MeshStitching, MergesSharedVertices) {
+  const auto left = makeSquare(0.0f, 1);
+  const auto right = makeSquare(1.0f, 2);
+  for (const size_t num_threads : {1u, 3u}) {
+    SCOPED_TRACE("threads: " + std::to_string(num_threads));
+    const auto result = connectMeshes({&left, &right}, 1.0e-4, num_threads);
+    ASSERT_TRUE(result);
+    EXPECT_TRUE(result->has_labels);
+    EXPECT_FALSE(result->has_timestamps);
+    ASSERT_EQ(result->numVertices(), 6u);
+    ASSERT_EQ(result->numFaces(), 4u);
+
+    // shared vertices keep the attributes of their first copy (from the left mesh)
+    for (size_t i = 0; i < result->numVertices(); ++i) {
+      const auto& pos = result->points[i];
+      EXPECT_EQ(result->labels[i], pos.x() < 1.5f ? 1u : 2u);
+    }
+
+    // both squares reference the same boundary vertices
+    const auto& left_face = result->faces[0];
+    const auto& right_face = result->faces[3];
+    EXPECT_EQ(result->points[left_face[1]], Mesh::Pos(1.0f, 0.0f, 0.0f));
+    EXPECT_EQ(result->faces[2][0], left_face[1]);
+    EXPECT_EQ(result->points[right_face[2]], Mesh::Pos(1.0f, 1.0f, 0.0f));
+  }
+}
+
+TEST(MeshStitching, DropsCollapsedFaces) {
+  Mesh mesh(false, false, false, false);
+  mesh.resizeVertices(3);
+  mesh.points[0] = Mesh::Pos(0.0f, 0.0f, 0.0f);
+  mesh.points[1] = Mesh::Pos(1.0e-5f, 0.0f, 0.0f);
+  mesh.points[2] = Mesh::Pos(0.0f, 1.0f, 0.0f);
+  mesh.faces = {{0, 1, 2}};
+
+  const auto result = connectMeshes({&mesh, nullptr}, 1.0e-3);
+  EXPECT_EQ(result->numVertices(), 2u);
+  EXPECT_EQ(result->numFaces(), 0u);
+
+  EXPECT_EQ(connectMeshes({})->numVertices(), 0u);
+}
+
+}  // namespace hydra
@@ -0,0 +1,130 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/metrics.h>
+
+#include <cmath>
+
+namespace hydra {
+
+TEST(Metrics, HistogramQuantiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.quantile(0.5), 0.0);
+
+  for (size_t i = 1; i <= 100; ++i) {
+    histogram.record(1.0e-3 * i);
+  }
+
+  EXPECT_EQ(histogram.count(), 100u);
+  EXPECT_NEAR(histogram.mean(), 0.0505, 1.0e-9);
+  EXPECT_DOUBLE_EQ(histogram.max(), 0.1);
+
+  // quantiles are bucket upper bounds, so they over-estimate by at most one bucket
+  const double factor = std::pow(2.0, 0.25);
+  EXPECT_GE(histogram.quantile(0.5), 0.050);
+  EXPECT_LE(histogram.quantile(0.5), 0.050 * factor);
+  EXPECT_GE(histogram.quantile(0.99), 0.099);
+  EXPECT_LE(histogram.quantile(0.99), 0.099 * factor);
+  EXPECT_LE(histogram.quantile(1.0), 0.1 * factor);
+
+  histogram.clear();
+  EXPECT_EQ(histogram.count(), 0u);
+  EXPECT_EQ(histogram.quantile(0.5), 0.0);
+}
+
+TEST(Metrics, RegistryWindows) {
+  auto& registry = MetricsRegistry::instance();
+  registry.clear();
+
+  registry.recordLatency("test", 0.01);
+  registry.recordLatency("test", 0.02);
+  registry.addCount("events");
+  registry.addCount("events", 4);
+  registry.setGauge("fixed", 2.0);
+  size_t queue_size = 3;
+  registry.registerGauge("queue", [&]() { return queue_size; });
+
+  auto latencies = registry.takeLatencies();
+  ASSERT_EQ(latencies.count("test"), 1u);
+  EXPECT_EQ(latencies.at("test").count, 2u);
+  EXPECT_NEAR(latencies.at("test").mean_s, 0.015, 1.0e-9);
+  EXPECT_DOUBLE_EQ(latencies.at("test").max_s, 0.02);
+
+  // latencies only cover the last window while counters accumulate
+  latencies = registry.takeLatencies();
+  EXPECT_TRUE(latencies.empty());
+  registry.addCount("events");
+  EXPECT_EQ(registry.counters().at("events"), 6u);
+
+  queue_size = 5;
+  const auto gauges = registry.gauges();
+  EXPECT_DOUBLE_EQ(gauges.at("fixed"), 2.0);
+  EXPECT_DOUBLE_EQ(gauges.at("queue"), 5.0);
+
+  registry.removeGauge("queue");
+  EXPECT_EQ(registry.gauges().count("queue"), 0u);
+  registry.clear();
+}
+
+TEST(Metrics, LatencyTimerRecordsLatency) {
+  auto& registry = MetricsRegistry::instance();
+  registry.clear();
+  {
+    LatencyTimer timer("test_latency_timer", 0);
+  }
+
+  const auto latencies = registry.takeLatencies();
+  ASSERT_EQ(latencies.count("test_latency_timer"), 1u);
+  EXPECT_EQ(latencies.at("test_latency_timer").count, 1u);
+  registry.clear();
+}
+
+TEST(Metrics, PrometheusFormat) {
+  MetricsRegistry::LatencySummary summary;
+  summary.count = 10;
+  summary.p99_s = 0.5;
+
+  const auto result = formatPrometheus(
+      "/hydra", {{"frontend", summary}}, {{"bytes", 12}}, {{"queue", 3.0}});
+  EXPECT_NE(result.find("hydra_latency_seconds{node=\"/hydra\",timer=\"frontend\","
+                        "quantile=\"0.99\"} 0.5"),
+            std::string::npos);
+  EXPECT_NE(result.find("hydra_events_total{node=\"/hydra\",name=\"bytes\"} 12"),
+            std::string::npos);
+  EXPECT_NE(result.find("hydra_gauge{node=\"/hydra\",name=\"queue\"} 3"),
+            std::string::npos);
+}
+
+}  // namespace hydra
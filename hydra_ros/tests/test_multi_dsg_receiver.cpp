@@ -0,0 +1,195 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/multi_dsg_receiver.h>
+#include <spark_dsg/serialization/graph_binary_serialization.h>
+
+#include <chrono>
+#include <thread>
+
+namespace hydra {
+
+namespace {
+
+void addPlace(DynamicSceneGraph& graph, NodeId node_id, double x = 0.0) {
+  auto attrs = std::make_unique<PlaceNodeAttributes>();
+  attrs->position << x, 0.0, 0.0;
+  graph.emplaceNode(DsgLayers::PLACES, node_id, std::move(attrs));
+}
+
+hydra_msgs::DsgUpdate makeUpdate(const DynamicSceneGraph& graph) {
+  hydra_msgs::DsgUpdate msg;
+  msg.header.stamp = ros::Time::now();
+  msg.full_update = true;
+  spark_dsg::io::binary::writeGraph(graph, msg.layer_contents, false);
+  msg.uncompressed_size = msg.layer_contents.size();
+  return msg;
+}
+
+template <typename Pred>
+DynamicSceneGraph::Ptr waitForGraph(MultiDsgReceiver& receiver, const Pred& pred) {
+  const auto start = std::chrono::steady_clock::now();
+  DynamicSceneGraph::Ptr graph;
+  while (std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    auto updated = receiver.getUpdatedGraph();
+    graph = updated ? updated : graph;
+    if (graph && pred(*graph)) {
+      return graph;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return nullptr;
+}
+
+}  // namespace
+
+TEST(MultiDsgReceiver, DiffGraph) {
+  const NodeId p0 = NodeSymbol('p', 0);
+  const NodeId p1 = NodeSymbol('p', 1);
+  DynamicSceneGraph graph;
+  addPlace(graph, p0);
+  addPlace(graph, p1);
+  graph.insertEdge(p0, p1);
+
+  MultiDsgReceiver::GraphState state;
+  auto changes = MultiDsgReceiver::diffGraph(graph, state);
+  EXPECT_EQ(changes.nodes.size(), 2u);
+  EXPECT_EQ(changes.edges.size(), 1u);
+  EXPECT_TRUE(changes.removed_nodes.empty());
+  EXPECT_TRUE(MultiDsgReceiver::diffGraph(graph, state).empty());
+
+  // removed edges between remaining nodes are tracked
+  graph.removeEdge(p0, p1);
+  changes = MultiDsgReceiver::diffGraph(graph, state);
+  EXPECT_TRUE(changes.nodes.empty());
+  EXPECT_EQ(changes.removed_edges, std::set<MultiDsgReceiver::EdgeKey>({{p0, p1}}));
+
+  // only nodes with different attributes are sent again
+  graph.insertEdge(p0, p1);
+  MultiDsgReceiver::diffGraph(graph, state);
+  graph.removeNode(p1);
+  addPlace(graph, p1, 2.0);
+  changes = MultiDsgReceiver::diffGraph(graph, state);
+  ASSERT_EQ(changes.nodes.size(), 1u);
+  EXPECT_EQ(changes.nodes.begin()->first, p1);
+  EXPECT_EQ(changes.removed_edges.size(), 1u);
+
+  // edges of removed nodes go with the nodes
+  graph.insertEdge(p0, p1);
+  MultiDsgReceiver::diffGraph(graph, state);
+  graph.removeNode(p0);
+  changes = MultiDsgReceiver::diffGraph(graph, state);
+  EXPECT_EQ(changes.removed_nodes, std::set<NodeId>({p0}));
+  EXPECT_TRUE(changes.removed_edges.empty());
+}
+
+TEST(MultiDsgReceiver, ChangesUpdate) {
+  MultiDsgReceiver::Changes changes;
+  changes.nodes[0] = {DsgLayers::PLACES, std::nullopt, nullptr};
+  changes.edges[{0, 1}] = nullptr;
+
+  MultiDsgReceiver::Changes removals;
+  removals.removed_nodes.insert(0);
+  removals.removed_edges.insert({0, 1});
+  changes.update(std::move(removals));
+  EXPECT_TRUE(changes.nodes.empty());
+  EXPECT_TRUE(changes.edges.empty());
+  EXPECT_EQ(changes.removed_nodes.size(), 1u);
+
+  MultiDsgReceiver::Changes additions;
+  additions.nodes[0] = {DsgLayers::PLACES, std::nullopt, nullptr};
+  changes.update(std::move(additions));
+  EXPECT_EQ(changes.nodes.size(), 1u);
+  EXPECT_TRUE(changes.removed_nodes.empty());
+  EXPECT_EQ(changes.removed_edges.size(), 1u);
+}
+
+TEST(MultiDsgReceiver, MergesRobots) {
+  ros::NodeHandle nh("~multi_receiver");
+  MultiDsgReceiver receiver(nh, {"robot_a", "robot_b"});
+  EXPECT_FALSE(receiver.getUpdatedGraph());
+
+  auto pub_a = nh.advertise<hydra_msgs::DsgUpdate>("robot_a/dsg", 10);
+  auto pub_b = nh.advertise<hydra_msgs::DsgUpdate>("robot_b/dsg", 10);
+  const auto start = std::chrono::steady_clock::now();
+  while (pub_a.getNumSubscribers() == 0 || pub_b.getNumSubscribers() == 0) {
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  const NodeId a0 = NodeSymbol('a', 0);
+  const NodeId a1 = NodeSymbol('a', 1);
+  const NodeId a2 = NodeSymbol('a', 2);
+  const NodeId b0 = NodeSymbol('b', 0);
+  DynamicSceneGraph graph_a;
+  addPlace(graph_a, a0);
+  addPlace(graph_a, a1);
+  graph_a.insertEdge(a0, a1);
+  DynamicSceneGraph graph_b;
+  addPlace(graph_b, b0);
+  pub_a.publish(makeUpdate(graph_a));
+  pub_b.publish(makeUpdate(graph_b));
+
+  auto merged = waitForGraph(receiver, [&](const DynamicSceneGraph& graph) {
+    return graph.numNodes() == 3 && graph.hasEdge(a0, a1);
+  });
+  ASSERT_TRUE(merged);
+
+  // removed edges and nodes of one robot are pruned without touching the other
+  graph_a.removeEdge(a0, a1);
+  addPlace(graph_a, a2);
+  pub_a.publish(makeUpdate(graph_a));
+  merged = waitForGraph(receiver, [&](const DynamicSceneGraph& graph) {
+    return graph.hasNode(a2);
+  });
+  ASSERT_TRUE(merged);
+  EXPECT_FALSE(merged->hasEdge(a0, a1));
+  EXPECT_TRUE(merged->hasNode(b0));
+
+  graph_a.removeNode(a1);
+  pub_a.publish(makeUpdate(graph_a));
+  merged = waitForGraph(receiver, [&](const DynamicSceneGraph& graph) {
+    return !graph.hasNode(a1);
+  });
+  ASSERT_TRUE(merged);
+  EXPECT_EQ(merged->numNodes(), 3u);
+  EXPECT_TRUE(merged->hasNode(b0));
+  EXPECT_FALSE(receiver.getUpdatedGraph());
+}
+
+}  // namespace hydra
@@ -0,0 +1,69 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/occupancy_publisher.h>
+
+namespace hydra {
+
+TEST(OccupancyCosts, OccupancyModeIsBinary) {
+  OccupancyPublisher::Config config;
+  config.min_distance = 0.2;
+  EXPECT_EQ(getInflatedCost(config, 0.1f), 100);
+  EXPECT_EQ(getInflatedCost(config, 0.25f), 0);
+  EXPECT_EQ(getInflatedCost(config, 5.0f), 0);
+}
+
+TEST(OccupancyCosts, CostsDecayWithDistance) {
+  OccupancyPublisher::Config config;
+  config.costmap = true;
+  config.min_distance = 0.2;
+  config.inscribed_radius = 0.3;
+  config.inflation_radius = 1.0;
+  config.cost_scaling_factor = 5.0;
+  EXPECT_EQ(getInflatedCost(config, 0.1f), 100);
+  EXPECT_EQ(getInflatedCost(config, 0.25f), 99);
+  EXPECT_EQ(getInflatedCost(config, 0.3f), 98);
+  EXPECT_EQ(getInflatedCost(config, 1.0f), 0);
+
+  int8_t prev_cost = 99;
+  for (float distance = 0.3f; distance < 1.0f; distance += 0.05f) {
+    const auto cost = getInflatedCost(config, distance);
+    EXPECT_LE(cost, prev_cost) << "distance: " << distance;
+    EXPECT_GE(cost, 1) << "distance: " << distance;
+    prev_cost = cost;
+  }
+}
+
+}  // namespace hydra
@@ -0,0 +1,165 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/occupancy_publisher.h>
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace hydra {
+
+namespace {
+
+template <typename Pred>
+bool spinUntil(const Pred& pred, double timeout_s = 5.0) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto timeout = std::chrono::duration<double>(timeout_s);
+  while (!pred()) {
+    if (std::chrono::steady_clock::now() - start > timeout) {
+      return false;
+    }
+
+    ros::spinOnce();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  return true;
+}
+
+// single block of free space at the slice height
+void fillLayer(TsdfLayer& layer) {
+  auto& block = layer.allocateBlock(BlockIndex(0, 0, 0));
+  for (size_t i = 0; i < block.numVoxels(); ++i) {
+    auto& voxel = block.getVoxel(i);
+    voxel.distance = 1.0;
+    voxel.weight = 1.0;
+  }
+
+  block.updated = true;
+}
+
+OccupancyPublisher::Config makeConfig(double full_update_period_s) {
+  OccupancyPublisher::Config config;
+  config.use_relative_height = false;
+  config.slice_height = 0.05;
+  config.incremental = true;
+  config.full_update_period_s = full_update_period_s;
+  return config;
+}
+
+struct GridListener {
+  GridListener(ros::NodeHandle& nh, const std::string& topic)
+      : sub(nh.subscribe(topic, 10, &GridListener::callback, this)) {}
+
+  void callback(const nav_msgs::OccupancyGrid::ConstPtr& msg) { grids.push_back(msg); }
+
+  ros::Subscriber sub;
+  std::vector<nav_msgs::OccupancyGrid::ConstPtr> grids;
+};
+
+int8_t getCell(const nav_msgs::OccupancyGrid& msg, double x, double y) {
+  const auto& info = msg.info;
+  const int col = std::floor((x - info.origin.position.x) / info.resolution);
+  const int row = std::floor((y - info.origin.position.y) / info.resolution);
+  return msg.data.at(row * info.width + col);
+}
+
+}  // namespace
+
+TEST(OccupancyPublisher, NewSubscribersGetCurrentGrid) {
+  ros::NodeHandle nh("~occupancy_relatch");
+  // never refreshed periodically, so only new subscribers trigger full grids
+  OccupancyPublisher publisher(makeConfig(0.0), nh);
+  TsdfLayer layer(0.1, 8);
+  fillLayer(layer);
+
+  GridListener first(nh, "occupancy");
+  ASSERT_TRUE(spinUntil([&]() { return first.sub.getNumPublishers() > 0; }));
+  publisher.publishTsdf(1000, Eigen::Isometry3d::Identity(), layer);
+  ASSERT_TRUE(spinUntil([&]() { return !first.grids.empty(); }));
+  EXPECT_EQ(getCell(*first.grids.back(), 0.25, 0.35), 0);
+
+  // the change only reaches the first subscriber as a patch
+  auto& block = *layer.getBlockPtr(BlockIndex(0, 0, 0));
+  block.getVoxel(VoxelIndex(2, 3, 0)).distance = 0.0;
+  block.updated = true;
+  publisher.publishTsdf(2000, Eigen::Isometry3d::Identity(), layer);
+  block.updated = false;
+
+  // the latched grid is stale until the publisher sees the new subscriber
+  GridListener second(nh, "occupancy");
+  ASSERT_TRUE(spinUntil([&]() { return !second.grids.empty(); }));
+  EXPECT_EQ(getCell(*second.grids.front(), 0.25, 0.35), 0);
+
+  // later updates send the current grid even though no blocks changed
+  uint64_t stamp_ns = 3000;
+  ASSERT_TRUE(spinUntil([&]() {
+    publisher.publishTsdf(stamp_ns++, Eigen::Isometry3d::Identity(), layer);
+    return second.grids.size() > 1;
+  }));
+  EXPECT_EQ(getCell(*second.grids.back(), 0.25, 0.35), 100);
+}
+
+TEST(OccupancyPublisher, CoarseGridIgnoresPeriodForNewSubscribers) {
+  ros::NodeHandle nh("~occupancy_coarse_relatch");
+  auto config = makeConfig(10.0);
+  config.incremental = false;
+  config.coarse_resolution = 0.4;
+  config.coarse_period_s = 100.0;
+  OccupancyPublisher publisher(config, nh);
+  TsdfLayer layer(0.1, 8);
+  fillLayer(layer);
+
+  GridListener first(nh, "occupancy_coarse");
+  ASSERT_TRUE(spinUntil([&]() { return first.sub.getNumPublishers() > 0; }));
+  publisher.publishTsdf(1000, Eigen::Isometry3d::Identity(), layer);
+  ASSERT_TRUE(spinUntil([&]() { return !first.grids.empty(); }));
+
+  // within the period, updates only go out once a new subscriber connects
+  publisher.publishTsdf(2000, Eigen::Isometry3d::Identity(), layer);
+  GridListener second(nh, "occupancy_coarse");
+  ASSERT_TRUE(spinUntil([&]() { return !second.grids.empty(); }));
+
+  uint64_t stamp_ns = 3000;
+  ASSERT_TRUE(spinUntil([&]() {
+    publisher.publishTsdf(stamp_ns++, Eigen::Isometry3d::Identity(), layer);
+    return second.grids.size() > 1;
+  }));
+  EXPECT_GE(second.grids.back()->header.stamp.toNSec(), 3000u);
+}
+
+}  // namespace hydra
@@ -0,0 +1,103 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/odometry_pose_buffer.h>
+
+#include <thread>
+
+namespace hydra {
+
+TEST(OdometryPoseBuffer, InterpolatesBetweenSamples) {
+  OdometryPoseBuffer buffer(4);
+  EXPECT_FALSE(buffer.getPose(10));
+
+  const Eigen::Quaterniond q_start = Eigen::Quaterniond::Identity();
+  const Eigen::Quaterniond q_end(
+      Eigen::AngleAxisd(M_PI / 2.0, Eigen::Vector3d::UnitZ()));
+  EXPECT_TRUE(buffer.add(10, Eigen::Vector3d::Zero(), q_start));
+  EXPECT_TRUE(buffer.add(20, Eigen::Vector3d(2.0, 0.0, 0.0), q_end));
+
+  const auto exact = buffer.getPose(20);
+  ASSERT_TRUE(exact);
+  EXPECT_NEAR((exact->position - Eigen::Vector3d(2.0, 0.0, 0.0)).norm(), 0.0, 1.0e-9);
+
+  const auto middle = buffer.getPose(15);
+  ASSERT_TRUE(middle);
+  EXPECT_EQ(middle->stamp_ns, 15u);
+  EXPECT_NEAR((middle->position - Eigen::Vector3d(1.0, 0.0, 0.0)).norm(), 0.0, 1.0e-9);
+  const Eigen::Quaterniond q_expected(
+      Eigen::AngleAxisd(M_PI / 4.0, Eigen::Vector3d::UnitZ()));
+  EXPECT_NEAR(middle->rotation.angularDistance(q_expected), 0.0, 1.0e-9);
+
+  EXPECT_FALSE(buffer.getPose(5));
+  EXPECT_FALSE(buffer.getPose(25));
+}
+
+TEST(OdometryPoseBuffer, DropsOldestWhenFull) {
+  OdometryPoseBuffer buffer(3);
+  for (uint64_t i = 1; i <= 5; ++i) {
+    EXPECT_TRUE(buffer.add(10 * i, Eigen::Vector3d::Constant(i), {1, 0, 0, 0}));
+  }
+
+  // out-of-order samples are rejected
+  EXPECT_FALSE(buffer.add(45, Eigen::Vector3d::Zero(), {1, 0, 0, 0}));
+
+  EXPECT_EQ(buffer.size(), 3u);
+  EXPECT_TRUE(buffer.isTooOld(20));
+  EXPECT_FALSE(buffer.isTooOld(30));
+  EXPECT_FALSE(buffer.getPose(20));
+
+  const auto pose = buffer.getPose(35);
+  ASSERT_TRUE(pose);
+  EXPECT_NEAR(pose->position.x(), 3.5, 1.0e-9);
+}
+
+TEST(OdometryPoseBuffer, WaitWakesOnNewSample) {
+  OdometryPoseBuffer buffer(10);
+  buffer.add(10, Eigen::Vector3d::Zero(), {1, 0, 0, 0});
+  EXPECT_FALSE(buffer.waitForPose(20, 0.01));
+
+  std::thread producer([&buffer]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    buffer.add(30, Eigen::Vector3d(2.0, 0.0, 0.0), {1, 0, 0, 0});
+  });
+
+  const auto pose = buffer.waitForPose(20, 5.0);
+  producer.join();
+  ASSERT_TRUE(pose);
+  EXPECT_NEAR(pose->position.x(), 1.0, 1.0e-9);
+}
+
+}  // namespace hydra
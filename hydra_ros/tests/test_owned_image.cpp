@@ -0,0 +1,99 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/owned_image.h>
+#include <sensor_msgs/image_encodings.h>
+
+namespace hydra {
+
+namespace {
+
+sensor_msgs::Image::ConstPtr makeImage(const std::string& encoding) {
+  auto msg = boost::make_shared<sensor_msgs::Image>();
+  msg->encoding = encoding;
+  msg->width = 4;
+  msg->height = 2;
+  msg->step = 3 * msg->width;
+  msg->data.resize(msg->step * msg->height);
+  for (size_t i = 0; i < msg->data.size(); ++i) {
+    msg->data[i] = i;
+  }
+
+  return msg;
+}
+
+}  // namespace
+
+TEST(OwnedImage, CopiesMessagePixels) {
+  const auto msg = makeImage(sensor_msgs::image_encodings::RGB8);
+  auto image = toOwnedImage(cv_bridge::toCvShare(msg));
+  ASSERT_EQ(image.rows, 2);
+  ASSERT_EQ(image.cols, 4);
+  EXPECT_NE(image.data, msg->data.data());
+  EXPECT_EQ(image.at<cv::Vec3b>(1, 2), cv::Vec3b(18, 19, 20));
+
+  // writing to the image leaves the message untouched
+  image.setTo(cv::Scalar(0, 0, 0));
+  EXPECT_EQ(msg->data[18], 18u);
+}
+
+TEST(OwnedImage, ConvertedPixelsAreNotCopied) {
+  const auto msg = makeImage(sensor_msgs::image_encodings::BGR8);
+  const auto converted = cv_bridge::toCvShare(msg, sensor_msgs::image_encodings::RGB8);
+  const auto image = toOwnedImage(converted);
+  EXPECT_EQ(image.data, converted->image.data);
+  EXPECT_EQ(image.at<cv::Vec3b>(1, 2), cv::Vec3b(20, 19, 18));
+}
+
+TEST(OwnedImage, CopiesIntoPool) {
+  const auto pool = MatPool::create(2);
+  const auto msg = makeImage(sensor_msgs::image_encodings::RGB8);
+  {
+    const auto image = toOwnedImage(cv_bridge::toCvShare(msg), pool);
+    EXPECT_NE(image.data, msg->data.data());
+    EXPECT_EQ(pool->numAllocated(), 1u);
+  }
+
+  const auto image = toOwnedImage(cv_bridge::toCvShare(msg), pool);
+  EXPECT_EQ(pool->numReused(), 1u);
+  EXPECT_EQ(image.at<cv::Vec3b>(0, 0), cv::Vec3b(0, 1, 2));
+}
+
+TEST(OwnedImage, EmptyImages) {
+  EXPECT_TRUE(toOwnedImage(nullptr).empty());
+}
+
+}  // namespace hydra
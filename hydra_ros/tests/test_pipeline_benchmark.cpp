@@ -0,0 +1,111 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/pipeline_benchmark.h>
+
+namespace hydra {
+
+namespace {
+
+PipelineBenchmark::Stage makeStage(const std::string& name,
+                                   size_t count,
+                                   double mean_s,
+                                   double throughput_hz) {
+  PipelineBenchmark::Stage stage;
+  stage.name = name;
+  stage.count = count;
+  stage.mean_s = mean_s;
+  stage.min_s = mean_s / 2.0;
+  stage.max_s = mean_s * 2.0;
+  stage.total_s = mean_s * count;
+  stage.throughput_hz = throughput_hz;
+  return stage;
+}
+
+}  // namespace
+
+TEST(PipelineBenchmark, CsvRoundTrip) {
+  const PipelineBenchmark::Report report{makeStage("frontend/spin", 10, 0.25, 5.0),
+                                         makeStage("backend/spin", 0, 0.0, 0.0)};
+  const auto parsed = PipelineBenchmark::fromCsv(PipelineBenchmark::toCsv(report));
+  ASSERT_TRUE(parsed);
+  ASSERT_EQ(parsed->size(), 2u);
+  EXPECT_EQ(parsed->at(0).name, "frontend/spin");
+  EXPECT_EQ(parsed->at(0).count, 10u);
+  EXPECT_DOUBLE_EQ(parsed->at(0).mean_s, 0.25);
+  EXPECT_DOUBLE_EQ(parsed->at(0).max_s, 0.5);
+  EXPECT_DOUBLE_EQ(parsed->at(0).throughput_hz, 5.0);
+  EXPECT_EQ(parsed->at(1).count, 0u);
+
+  EXPECT_FALSE(PipelineBenchmark::fromCsv("name,count\nfrontend,1\n"));
+  const std::string header = "stage,count,mean_s,min_s,max_s,total_s,throughput_hz\n";
+  EXPECT_FALSE(PipelineBenchmark::fromCsv(header + "frontend,1,0.1\n"));
+  EXPECT_FALSE(PipelineBenchmark::fromCsv(header + "frontend,a,0,0,0,0,0\n"));
+}
+
+TEST(PipelineBenchmark, JsonContainsStages) {
+  const PipelineBenchmark::Report report{makeStage("frontend/spin", 10, 0.25, 5.0)};
+  const auto json = PipelineBenchmark::toJson(report, 2.0);
+  EXPECT_NE(json.find("\"duration_s\": 2"), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"frontend/spin\""), std::string::npos);
+  EXPECT_NE(json.find("\"count\": 10"), std::string::npos);
+}
+
+TEST(PipelineBenchmark, CompareFlagsRegressions) {
+  const PipelineBenchmark::Report baseline{makeStage("frontend/spin", 10, 0.1, 5.0),
+                                           makeStage("backend/spin", 10, 0.1, 5.0),
+                                           makeStage("lcd/spin", 10, 0.0001, 5.0),
+                                           makeStage("publish", 10, 0.1, 5.0),
+                                           makeStage("unused", 0, 0.0, 0.0)};
+  const PipelineBenchmark::Report current{makeStage("frontend/spin", 10, 0.105, 5.0),
+                                          makeStage("backend/spin", 10, 0.2, 4.0),
+                                          makeStage("lcd/spin", 10, 0.0005, 5.0)};
+
+  const auto regressions = PipelineBenchmark::compare(baseline, current, 0.1, 1.0e-3);
+  ASSERT_EQ(regressions.size(), 3u);
+  EXPECT_EQ(regressions[0].stage, "backend/spin");
+  EXPECT_EQ(regressions[0].metric, "mean_s");
+  EXPECT_DOUBLE_EQ(regressions[0].current, 0.2);
+  EXPECT_EQ(regressions[1].stage, "backend/spin");
+  EXPECT_EQ(regressions[1].metric, "throughput_hz");
+  // stages that stopped reporting count as regressions
+  EXPECT_EQ(regressions[2].stage, "publish");
+  EXPECT_EQ(regressions[2].metric, "count");
+
+  EXPECT_TRUE(PipelineBenchmark::compare(baseline, baseline, 0.1, 1.0e-3).empty());
+}
+
+}  // namespace hydra
@@ -0,0 +1,111 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/pipeline_checkpointer.h>
+#include <spark_dsg/node_attributes.h>
+
+#include <fstream>
+
+namespace hydra {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void makeCheckpoint(const fs::path& path, bool complete) {
+  fs::create_directories(path);
+  std::ofstream(path / CheckpointFiles::frontend_dsg) << "dsg";
+  if (complete) {
+    std::ofstream(path / CheckpointFiles::deformation_graph) << "dgrf";
+  }
+}
+
+}  // namespace
+
+TEST(PipelineCheckpointer, FindLatestCheckpoint) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_checkpoints";
+  fs::remove_all(dir);
+  EXPECT_FALSE(findLatestCheckpoint(dir));
+
+  makeCheckpoint(dir / "checkpoint_5", true);
+  makeCheckpoint(dir / "checkpoint_40", true);
+  // numeric ordering, not lexical ordering
+  makeCheckpoint(dir / "checkpoint_100", true);
+  // incomplete or unrelated directories are never picked
+  makeCheckpoint(dir / "checkpoint_200", false);
+  makeCheckpoint(dir / "tmp_300", true);
+  makeCheckpoint(dir / "checkpoint_abc", true);
+
+  const auto latest = findLatestCheckpoint(dir);
+  ASSERT_TRUE(latest);
+  EXPECT_EQ(latest->filename(), "checkpoint_100");
+  fs::remove_all(dir);
+}
+
+TEST(PipelineCheckpointer, WritesCheckpointFromSnapshots) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_checkpoint_write";
+  fs::remove_all(dir);
+
+  DynamicSceneGraph graph;
+  graph.emplaceNode(DsgLayers::PLACES,
+                    NodeSymbol('p', 0),
+                    std::make_unique<PlaceNodeAttributes>());
+  graph.emplaceNode(DsgLayers::PLACES,
+                    NodeSymbol('p', 1),
+                    std::make_unique<PlaceNodeAttributes>());
+  kimera_pgmo::DeformationGraph dgraph;
+
+  PipelineCheckpointer::Config config;
+  config.directory = dir.string();
+  config.period_s = 0.0;
+  {
+    auto checkpointer = std::make_shared<PipelineCheckpointer>(config);
+    checkpointer->saveFrontend(10, graph);
+    checkpointer->saveBackend(10, graph, dgraph);
+    // later changes never leak into the pending checkpoint
+    graph.removeNode(NodeSymbol('p', 1));
+  }  // pending checkpoints are written on shutdown
+
+  const auto latest = findLatestCheckpoint(dir);
+  ASSERT_TRUE(latest);
+  EXPECT_EQ(latest->filename(), "checkpoint_10");
+  const auto backend_path = *latest / CheckpointFiles::backend_dsg;
+  const auto loaded = DynamicSceneGraph::load(backend_path.string());
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->numNodes(), 2u);
+  fs::remove_all(dir);
+}
+
+}  // namespace hydra
@@ -0,0 +1,279 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/input/pointcloud_adaptor.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace hydra {
+
+namespace {
+
+sensor_msgs::PointField makeField(const std::string& name,
+                                  uint32_t offset,
+                                  uint8_t datatype) {
+  sensor_msgs::PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = 1;
+  return field;
+}
+
+template <typename T>
+void writeField(sensor_msgs::PointCloud2& cloud,
+                size_t index,
+                uint32_t offset,
+                T value) {
+  std::memcpy(cloud.data.data() + index * cloud.point_step + offset, &value, sizeof(T));
+}
+
+sensor_msgs::PointCloud2 makeCloud(bool packed) {
+  using sensor_msgs::PointField;
+  sensor_msgs::PointCloud2 cloud;
+  cloud.height = 2;
+  cloud.width = 3;
+  cloud.point_step = 24;
+  cloud.row_step = cloud.width * cloud.point_step;
+  const uint32_t y_offset = packed ? 4 : 12;
+  const uint32_t z_offset = packed ? 8 : 16;
+  cloud.fields.push_back(makeField("x", 0, PointField::FLOAT32));
+  cloud.fields.push_back(makeField("y", y_offset, PointField::FLOAT32));
+  cloud.fields.push_back(makeField("z", z_offset, PointField::FLOAT32));
+  cloud.fields.push_back(makeField("rgb", packed ? 12 : 4, PointField::UINT32));
+  cloud.fields.push_back(makeField("ring", packed ? 16 : 8, PointField::UINT16));
+  cloud.data.resize(cloud.row_step * cloud.height);
+  for (size_t i = 0; i < cloud.width * cloud.height; ++i) {
+    writeField<float>(cloud, i, 0, 1.0f * i);
+    writeField<float>(cloud, i, y_offset, 2.0f * i);
+    writeField<float>(cloud, i, z_offset, 3.0f * i);
+    const uint8_t bgra[4] = {static_cast<uint8_t>(i), 10, 20, 255};
+    std::memcpy(cloud.data.data() + i * cloud.point_step + (packed ? 12 : 4), bgra, 4);
+    writeField<uint16_t>(cloud, i, packed ? 16 : 8, 100 + i);
+  }
+
+  return cloud;
+}
+
+}  // namespace
+
+TEST(PointcloudAdaptor, DetectLayout) {
+  const auto packed = PointcloudLayout::fromCloud(makeCloud(true));
+  EXPECT_TRUE(packed.packed_xyz);
+  EXPECT_EQ(packed.xyz_offset, 0u);
+  EXPECT_TRUE(packed.color_offset);
+  EXPECT_TRUE(packed.label_offset);
+
+  const auto unpacked = PointcloudLayout::fromCloud(makeCloud(false));
+  EXPECT_FALSE(unpacked.packed_xyz);
+}
+
+TEST(PointcloudAdaptor, CachedLayoutFollowsFields) {
+  const auto packed_cloud = makeCloud(true);
+  const auto packed = PointcloudLayout::cached(packed_cloud);
+  EXPECT_TRUE(packed.packed_xyz);
+  EXPECT_EQ(PointcloudLayout::cached(packed_cloud).label_offset, packed.label_offset);
+
+  // any change to the fields invalidates the cached layout
+  EXPECT_FALSE(PointcloudLayout::cached(makeCloud(false)).packed_xyz);
+  auto cloud = makeCloud(true);
+  cloud.fields.pop_back();
+  EXPECT_FALSE(PointcloudLayout::cached(cloud).label_offset);
+  cloud.fields[1].offset = 12;
+  EXPECT_FALSE(PointcloudLayout::cached(cloud).packed_xyz);
+  cloud.fields[1].offset = 4;
+  EXPECT_TRUE(PointcloudLayout::cached(cloud).packed_xyz);
+  cloud.is_bigendian = true;
+  EXPECT_FALSE(PointcloudLayout::cached(cloud).packed_xyz);
+  EXPECT_TRUE(PointcloudLayout::cached(packed_cloud).label_offset);
+}
+
+TEST(PointcloudAdaptor, FastPathMatchesGeneric) {
+  for (const bool packed : {true, false}) {
+    SCOPED_TRACE(packed ? "packed" : "unpacked");
+    const auto cloud = makeCloud(packed);
+    CloudInputPacket packet(0, 0);
+    ASSERT_TRUE(fillPointcloudPacket(cloud, packet, true));
+
+    PointcloudAdaptor adaptor(cloud);
+    ASSERT_TRUE(adaptor.valid());
+    for (uint32_t r = 0; r < cloud.height; ++r) {
+      for (uint32_t c = 0; c < cloud.width; ++c) {
+        const auto ptr = &cloud.data[r * cloud.row_step + c * cloud.point_step];
+        const auto pos = adaptor.position(ptr);
+        const auto color = adaptor.color(ptr);
+        const auto& result_pos = packet.points.at<cv::Vec3f>(r, c);
+        const auto& result_color = packet.colors.at<cv::Vec3b>(r, c);
+        for (int i = 0; i < 3; ++i) {
+          EXPECT_EQ(result_pos[i], pos[i]);
+          EXPECT_EQ(result_color[i], color[i]);
+        }
+        EXPECT_EQ(packet.labels.at<int32_t>(r, c),
+                  static_cast<int32_t>(adaptor.label(ptr)));
+      }
+    }
+  }
+}
+
+TEST(PointcloudAdaptor, MissingLabels) {
+  auto cloud = makeCloud(true);
+  cloud.fields.pop_back();
+  CloudInputPacket packet(0, 0);
+  EXPECT_FALSE(fillPointcloudPacket(cloud, packet, true));
+  EXPECT_TRUE(fillPointcloudPacket(cloud, packet, false));
+  EXPECT_TRUE(packet.labels.empty());
+}
+
+TEST(PointcloudAdaptor, FilteredPacket) {
+  for (const bool packed : {true, false}) {
+    SCOPED_TRACE(packed ? "packed" : "unpacked");
+    // points are at i * (1, 2, 3) for i in [0, 6)
+    auto cloud = makeCloud(packed);
+    const uint32_t y_offset = packed ? 4 : 12;
+    writeField<float>(cloud, 4, y_offset, std::numeric_limits<float>::quiet_NaN());
+
+    PointcloudFilter filter;
+    filter.min_range = 1.0;
+    filter.max_range = 15.0;
+    CloudInputPacket packet(0, 0);
+    ASSERT_TRUE(fillFilteredPointcloudPacket(cloud, packet, filter, true));
+    // drops the origin (too close), index 4 (NaN) and index 5 (too far)
+    ASSERT_EQ(packet.points.rows, 1);
+    ASSERT_EQ(packet.points.cols, 3);
+    for (int i = 0; i < 3; ++i) {
+      const auto& pos = packet.points.at<cv::Vec3f>(0, i);
+      EXPECT_EQ(pos[0], i + 1.0f);
+      EXPECT_EQ(pos[2], 3.0f * (i + 1));
+      EXPECT_EQ(packet.colors.at<cv::Vec3b>(0, i)[2], i + 1);
+      EXPECT_EQ(packet.labels.at<int32_t>(0, i), 101 + i);
+    }
+
+    // one voxel holds everything but the last point
+    filter = PointcloudFilter();
+    filter.voxel_size = 14.0;
+    ASSERT_TRUE(fillFilteredPointcloudPacket(cloud, packet, filter, true));
+    ASSERT_EQ(packet.points.cols, 2);
+    EXPECT_EQ(packet.points.at<cv::Vec3f>(0, 0)[0], 0.0f);
+    EXPECT_EQ(packet.points.at<cv::Vec3f>(0, 1)[0], 5.0f);
+  }
+}
+
+TEST(PointcloudAdaptor, TransformWhileParsing) {
+  Eigen::Isometry3f target_T_cloud = Eigen::Isometry3f::Identity();
+  target_T_cloud.linear() =
+      Eigen::AngleAxisf(M_PI / 2, Eigen::Vector3f::UnitZ()).toRotationMatrix();
+  target_T_cloud.translation() << 1.0f, 2.0f, 3.0f;
+
+  for (const bool packed : {true, false}) {
+    SCOPED_TRACE(packed ? "packed" : "unpacked");
+    const auto cloud = makeCloud(packed);
+    CloudInputPacket expected(0, 0);
+    CloudInputPacket packet(0, 0);
+    ASSERT_TRUE(fillPointcloudPacket(cloud, expected, true));
+    ASSERT_TRUE(fillPointcloudPacket(cloud, packet, true, &target_T_cloud));
+    for (uint32_t r = 0; r < cloud.height; ++r) {
+      for (uint32_t c = 0; c < cloud.width; ++c) {
+        const auto& p = expected.points.at<cv::Vec3f>(r, c);
+        const Eigen::Vector3f expected_pos(p[0], p[1], p[2]);
+        const Eigen::Vector3f result = target_T_cloud * expected_pos;
+        const auto& pos = packet.points.at<cv::Vec3f>(r, c);
+        for (int i = 0; i < 3; ++i) {
+          EXPECT_NEAR(pos[i], result(i), 1.0e-5);
+        }
+      }
+    }
+  }
+
+  // wide enough to use full batches as well as the remainder
+  using sensor_msgs::PointField;
+  sensor_msgs::PointCloud2 cloud;
+  cloud.height = 1;
+  cloud.width = 150;
+  cloud.point_step = 12;
+  cloud.row_step = cloud.width * cloud.point_step;
+  cloud.fields.push_back(makeField("x", 0, PointField::FLOAT32));
+  cloud.fields.push_back(makeField("y", 4, PointField::FLOAT32));
+  cloud.fields.push_back(makeField("z", 8, PointField::FLOAT32));
+  cloud.data.resize(cloud.row_step);
+  for (size_t i = 0; i < cloud.width; ++i) {
+    writeField<float>(cloud, i, 0, 1.0f * i);
+  }
+
+  CloudInputPacket packet(0, 0);
+  ASSERT_TRUE(fillPointcloudPacket(cloud, packet, false, &target_T_cloud));
+  for (uint32_t c = 0; c < cloud.width; ++c) {
+    const auto& pos = packet.points.at<cv::Vec3f>(0, c);
+    EXPECT_NEAR(pos[0], 1.0f, 1.0e-4);
+    EXPECT_NEAR(pos[1], 2.0f + c, 1.0e-4);
+    EXPECT_NEAR(pos[2], 3.0f, 1.0e-4);
+  }
+
+  // filtering uses the original coordinates
+  PointcloudFilter filter;
+  filter.max_range = 9.5;
+  ASSERT_TRUE(
+      fillFilteredPointcloudPacket(cloud, packet, filter, false, &target_T_cloud));
+  ASSERT_EQ(packet.points.cols, 10);
+  EXPECT_NEAR(packet.points.at<cv::Vec3f>(0, 9)[1], 11.0f, 1.0e-4);
+}
+
+TEST(PointcloudAdaptor, CompactPacket) {
+  for (const bool packed : {true, false}) {
+    SCOPED_TRACE(packed ? "packed" : "unpacked");
+    // points are at i * (1, 2, 3) for i in [0, 6), so the first one is at the origin
+    auto cloud = makeCloud(packed);
+    writeField<float>(cloud, 3, 0, std::numeric_limits<float>::infinity());
+
+    PointcloudFilter filter;
+    filter.compact = true;
+    EXPECT_TRUE(filter.enabled());
+
+    CloudInputPacket packet(0, 0);
+    std::vector<uint32_t> indices;
+    ASSERT_TRUE(
+        fillFilteredPointcloudPacket(cloud, packet, filter, true, nullptr, &indices));
+    const std::vector<uint32_t> expected{1, 2, 4, 5};
+    EXPECT_EQ(indices, expected);
+    ASSERT_EQ(packet.points.cols, 4);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(packet.points.at<cv::Vec3f>(0, i)[1], 2.0f * expected[i]);
+      EXPECT_EQ(packet.labels.at<int32_t>(0, i), 100 + expected[i]);
+    }
+  }
+}
+
+}  // namespace hydra
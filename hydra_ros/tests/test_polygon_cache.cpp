@@ -0,0 +1,87 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/polygon_cache.h>
+
+namespace hydra {
+
+namespace {
+
+Eigen::MatrixXd makeSquare(double scale) {
+  Eigen::MatrixXd points(3, 4);
+  points << 0.0, 1.0, 1.0, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0, 0.0;
+  return scale * points;
+}
+
+}  // namespace
+
+TEST(PolygonCache, OnlyRebuildsChanged) {
+  PolygonCache cache(2);
+  size_t num_built = 0;
+  const auto build = [&](NodeId node, PolygonGeometry& geometry) {
+    ++num_built;
+    geometry.points = makeSquare(node + 1.0);
+    geometry.height = node;
+  };
+
+  cache.update({{0, 10}, {1, 11}, {2, 12}}, build);
+  EXPECT_EQ(num_built, 3u);
+  EXPECT_EQ(cache.numRebuilt(), 3u);
+  ASSERT_EQ(cache.size(), 3u);
+  std::vector<std::array<size_t, 3>> expected{{3, 0, 1}, {3, 1, 2}};
+  EXPECT_EQ(cache.at(1).faces, expected);
+  EXPECT_DOUBLE_EQ(cache.at(2).height, 2.0);
+
+  // same signatures: nothing gets rebuilt
+  num_built = 0;
+  cache.update({{0, 10}, {1, 11}, {2, 12}}, build);
+  EXPECT_EQ(num_built, 0u);
+  EXPECT_EQ(cache.numRebuilt(), 0u);
+  EXPECT_EQ(cache.at(1).faces, expected);
+
+  // one changed signature and one removed node
+  cache.update({{0, 10}, {1, 21}}, build);
+  EXPECT_EQ(num_built, 1u);
+  EXPECT_EQ(cache.numRebuilt(), 1u);
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_EQ(cache.at(1).signature, 21u);
+  EXPECT_EQ(cache.at(0).faces, expected);
+  EXPECT_THROW(cache.at(2), std::out_of_range);
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+}  // namespace hydra
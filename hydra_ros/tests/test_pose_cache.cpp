@@ -0,0 +1,165 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/pose_cache.h>
+#include <rosbag/bag.h>
+#include <tf2_msgs/TFMessage.h>
+
+namespace hydra {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+inline constexpr uint64_t kSecToNs = 1000000000;
+
+geometry_msgs::TransformStamped makeTransform(double stamp, double x, double yaw) {
+  const Eigen::Quaterniond rot(Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()));
+  geometry_msgs::TransformStamped tf;
+  tf.header.stamp.fromSec(stamp);
+  tf.header.frame_id = "world";
+  tf.child_frame_id = "body";
+  tf.transform.translation.x = x;
+  tf.transform.rotation.w = rot.w();
+  tf.transform.rotation.x = rot.x();
+  tf.transform.rotation.y = rot.y();
+  tf.transform.rotation.z = rot.z();
+  return tf;
+}
+
+// body moves 1 m and turns 0.2 rad per second from 1 to 4 seconds
+fs::path writeBag(const fs::path& dir) {
+  fs::create_directories(dir);
+  const auto bag_path = dir / "test.bag";
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Write);
+
+  tf2_msgs::TFMessage static_msg;
+  auto& sensor_tf = static_msg.transforms.emplace_back();
+  sensor_tf.header.stamp.fromSec(1.0);
+  sensor_tf.header.frame_id = "body";
+  sensor_tf.child_frame_id = "sensor";
+  sensor_tf.transform.translation.z = 0.5;
+  sensor_tf.transform.rotation.w = 1.0;
+  bag.write("/tf_static", ros::Time(1.0), static_msg);
+
+  for (int i = 0; i < 4; ++i) {
+    tf2_msgs::TFMessage msg;
+    msg.transforms.push_back(makeTransform(1.0 + i, i, 0.2 * i));
+    bag.write("/tf", ros::Time(1.0 + i), msg);
+  }
+
+  bag.close();
+  return bag_path;
+}
+
+void expectNear(const PoseCache::PoseResult& lhs, const PoseCache::PoseResult& rhs) {
+  ASSERT_TRUE(lhs);
+  ASSERT_TRUE(rhs);
+  EXPECT_NEAR((lhs.to_p_from - rhs.to_p_from).norm(), 0.0, 1.0e-9);
+  EXPECT_NEAR(lhs.to_R_from.angularDistance(rhs.to_R_from), 0.0, 1.0e-9);
+}
+
+}  // namespace
+
+TEST(PoseCache, IndexedLookupsMatchTf) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_pose_cache";
+  const auto bag_path = writeBag(dir);
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+  const PoseCache tf_cache(bag);
+  PoseCache indexed(bag);
+  ASSERT_TRUE(indexed.indexTrajectory("world", "sensor"));
+
+  // samples and points between samples agree with tf interpolation
+  for (const double stamp_s : {1.0, 1.25, 2.0, 2.5, 3.9, 4.0}) {
+    const uint64_t stamp_ns = stamp_s * kSecToNs;
+    SCOPED_TRACE("stamp: " + std::to_string(stamp_s));
+    expectNear(indexed.lookupPose(stamp_ns, "world", "sensor"),
+               tf_cache.lookupPose(stamp_ns, "world", "sensor"));
+  }
+
+  const auto mid = indexed.lookupPose(2.5 * kSecToNs, "world", "sensor");
+  ASSERT_TRUE(mid);
+  EXPECT_NEAR(mid.to_p_from.x(), 1.5, 1.0e-9);
+  EXPECT_NEAR(mid.to_p_from.z(), 0.5, 1.0e-9);
+  const auto identity = Eigen::Quaterniond::Identity();
+  EXPECT_NEAR(mid.to_R_from.angularDistance(identity), 0.3, 1.0e-9);
+
+  // stamps outside of the trajectory are not extrapolated
+  EXPECT_FALSE(indexed.lookupPose(0.5 * kSecToNs, "world", "sensor"));
+  EXPECT_FALSE(indexed.lookupPose(4.5 * kSecToNs, "world", "sensor"));
+
+  // other frame pairs still go through tf
+  expectNear(indexed.lookupPose(2 * kSecToNs, "body", "sensor"),
+             tf_cache.lookupPose(2 * kSecToNs, "body", "sensor"));
+  EXPECT_FALSE(indexed.indexTrajectory("world", "missing"));
+  fs::remove_all(dir);
+}
+
+TEST(PoseCache, TrajectoryRoundTrip) {
+  const auto dir = fs::temp_directory_path() / "hydra_ros_test_pose_cache_io";
+  const auto bag_path = writeBag(dir);
+  rosbag::Bag bag;
+  bag.open(bag_path, rosbag::bagmode::Read);
+  PoseCache indexed(bag);
+  const auto trajectory_path = dir / "test.poses";
+  EXPECT_FALSE(indexed.saveTrajectory(trajectory_path, "world", "sensor"));
+  ASSERT_TRUE(indexed.indexTrajectory("world", "sensor"));
+  ASSERT_TRUE(indexed.saveTrajectory(trajectory_path, "world", "sensor"));
+  EXPECT_FALSE(fs::exists(dir / "test.poses.tmp"));
+
+  // loaded trajectories answer lookups without any tf data
+  PoseCache loaded;
+  EXPECT_FALSE(loaded.lookupPose(2 * kSecToNs, "world", "sensor"));
+  EXPECT_FALSE(loaded.loadTrajectory(trajectory_path, "world", "body"));
+  ASSERT_TRUE(loaded.loadTrajectory(trajectory_path, "world", "sensor"));
+  for (const double stamp_s : {1.0, 1.7, 3.0, 4.0}) {
+    const uint64_t stamp_ns = stamp_s * kSecToNs;
+    SCOPED_TRACE("stamp: " + std::to_string(stamp_s));
+    expectNear(loaded.lookupPose(stamp_ns, "world", "sensor"),
+               indexed.lookupPose(stamp_ns, "world", "sensor"));
+  }
+
+  // truncated and missing files are rejected instead of partially loaded
+  fs::resize_file(trajectory_path, fs::file_size(trajectory_path) - 8);
+  PoseCache truncated;
+  EXPECT_FALSE(truncated.loadTrajectory(trajectory_path, "world", "sensor"));
+  EXPECT_FALSE(truncated.loadTrajectory(dir / "missing.poses", "world", "sensor"));
+  fs::remove_all(dir);
+}
+
+}  // namespace hydra
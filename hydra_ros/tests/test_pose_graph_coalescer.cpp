@@ -0,0 +1,132 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/backend/pose_graph_coalescer.h>
+
+namespace hydra {
+
+using pose_graph_tools_msgs::PoseGraph;
+
+namespace {
+
+PoseGraph makeGraph(int robot_id, size_t first_key, size_t num_nodes, double stamp) {
+  PoseGraph msg;
+  msg.header.stamp.fromSec(stamp);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    auto& node = msg.nodes.emplace_back();
+    node.robot_id = robot_id;
+    node.key = first_key + i;
+    node.pose.position.x = first_key + i;
+    node.pose.orientation.w = 1.0;
+    if (i == 0) {
+      continue;
+    }
+
+    auto& edge = msg.edges.emplace_back();
+    edge.robot_from = robot_id;
+    edge.robot_to = robot_id;
+    edge.key_from = first_key + i - 1;
+    edge.key_to = first_key + i;
+    edge.pose.orientation.w = 1.0;
+  }
+
+  return msg;
+}
+
+}  // namespace
+
+TEST(PoseGraphCoalescer, MergesGraphsPerRobot) {
+  PoseGraphCoalescer coalescer;
+  coalescer.add(makeGraph(1, 0, 3, 2.0));
+  coalescer.add(makeGraph(0, 10, 2, 1.0));
+  coalescer.add(makeGraph(1, 3, 2, 1.5));
+  coalescer.add(PoseGraph());
+  EXPECT_EQ(coalescer.numPending(), 2u);
+
+  std::vector<pose_graph_tools::PoseGraph::ConstPtr> graphs;
+  coalescer.flush(graphs);
+  EXPECT_EQ(coalescer.numPending(), 0u);
+  ASSERT_EQ(graphs.size(), 2u);
+
+  // graphs are ordered by robot id and keep the arrival order of their nodes
+  ASSERT_TRUE(graphs[0]);
+  EXPECT_EQ(graphs[0]->nodes.size(), 2u);
+  EXPECT_EQ(graphs[0]->edges.size(), 1u);
+  EXPECT_EQ(graphs[0]->stamp_ns, 1000000000u);
+
+  const auto& merged = *graphs[1];
+  ASSERT_EQ(merged.nodes.size(), 5u);
+  EXPECT_EQ(merged.edges.size(), 3u);
+  for (size_t i = 0; i < merged.nodes.size(); ++i) {
+    EXPECT_EQ(merged.nodes[i].key, i);
+  }
+  EXPECT_EQ(merged.stamp_ns, 2000000000u);
+
+  // nothing is left for the next input
+  graphs.clear();
+  coalescer.flush(graphs);
+  EXPECT_TRUE(graphs.empty());
+}
+
+TEST(PoseGraphCoalescer, EdgeOnlyGraphsUseSourceRobot) {
+  PoseGraphCoalescer coalescer;
+  auto msg = makeGraph(2, 0, 2, 1.0);
+  msg.nodes.clear();
+  coalescer.add(msg);
+
+  std::vector<pose_graph_tools::PoseGraph::ConstPtr> graphs;
+  coalescer.flush(graphs);
+  ASSERT_EQ(graphs.size(), 1u);
+  EXPECT_TRUE(graphs[0]->nodes.empty());
+  ASSERT_EQ(graphs[0]->edges.size(), 1u);
+  EXPECT_EQ(graphs[0]->edges[0].key_to, 1u);
+}
+
+TEST(PoseGraphCoalescer, ReservesPreviousSize) {
+  PoseGraphCoalescer coalescer;
+  coalescer.add(makeGraph(0, 0, 20, 1.0));
+  std::vector<pose_graph_tools::PoseGraph::ConstPtr> graphs;
+  coalescer.flush(graphs);
+
+  coalescer.add(makeGraph(0, 20, 1, 2.0));
+  coalescer.flush(graphs);
+  ASSERT_EQ(graphs.size(), 2u);
+  EXPECT_EQ(graphs[1]->nodes.size(), 1u);
+  EXPECT_GE(graphs[1]->nodes.capacity(), 20u);
+  EXPECT_GE(graphs[1]->edges.capacity(), 19u);
+}
+
+}  // namespace hydra
@@ -0,0 +1,88 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/loop_closure/registration_cache.h>
+
+namespace hydra::lcd {
+
+TEST(RegistrationCache, EvictsLeastRecentlyUsed) {
+  RegistrationCache::Config config;
+  config.max_size = 2;
+  RegistrationCache cache(config);
+
+  RegistrationCache::Entry success;
+  success.valid = true;
+  success.match_t_query = Eigen::Vector3d(1.0, 2.0, 3.0);
+  cache.put({0, 1, 1, 5}, success, 0.0);
+  cache.put({0, 2, 1, 6}, RegistrationCache::Entry(), 0.0);
+  EXPECT_EQ(cache.size(), 2u);
+
+  // touching the first pair makes the second the eviction candidate
+  auto result = cache.get({0, 1, 1, 5}, 1.0);
+  ASSERT_TRUE(result);
+  EXPECT_TRUE(result->valid);
+  EXPECT_EQ(result->match_t_query, Eigen::Vector3d(1.0, 2.0, 3.0));
+
+  cache.put({0, 3, 1, 7}, success, 1.0);
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_TRUE(cache.get({0, 1, 1, 5}, 1.0));
+  EXPECT_FALSE(cache.get({0, 2, 1, 6}, 1.0));
+  EXPECT_TRUE(cache.get({0, 3, 1, 7}, 1.0));
+
+  // robots are part of the key
+  EXPECT_FALSE(cache.get({1, 1, 1, 5}, 1.0));
+}
+
+TEST(RegistrationCache, FailuresExpire) {
+  RegistrationCache::Config config;
+  config.success_ttl_s = -1.0;
+  config.failure_ttl_s = 10.0;
+  RegistrationCache cache(config);
+
+  RegistrationCache::Entry success;
+  success.valid = true;
+  cache.put({0, 1, 0, 2}, success, 0.0);
+  cache.put({0, 3, 0, 4}, RegistrationCache::Entry(), 0.0);
+
+  auto failure = cache.get({0, 3, 0, 4}, 5.0);
+  ASSERT_TRUE(failure);
+  EXPECT_FALSE(failure->valid);
+
+  EXPECT_FALSE(cache.get({0, 3, 0, 4}, 11.0));
+  EXPECT_EQ(cache.size(), 1u);
+  EXPECT_TRUE(cache.get({0, 1, 0, 2}, 1000.0));
+}
+
+}  // namespace hydra::lcd
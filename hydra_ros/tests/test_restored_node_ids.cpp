@@ -0,0 +1,117 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/restored_node_ids.h>
+#include <spark_dsg/node_attributes.h>
+
+namespace hydra {
+
+namespace {
+
+void addPlace(DynamicSceneGraph& graph, NodeId node_id, double x) {
+  auto attrs = std::make_unique<PlaceNodeAttributes>();
+  attrs->position = Eigen::Vector3d(x, 0.0, 0.0);
+  graph.emplaceNode(DsgLayers::PLACES, node_id, std::move(attrs));
+}
+
+void addObject(DynamicSceneGraph& graph, NodeId node_id) {
+  graph.emplaceNode(
+      DsgLayers::OBJECTS, node_id, std::make_unique<ObjectNodeAttributes>());
+}
+
+}  // namespace
+
+TEST(RestoredNodeIds, ShiftOnlyMovesFrontendIds) {
+  constexpr auto kBlockSize = RestoredNodeIds::kBlockSize;
+  EXPECT_EQ(RestoredNodeIds::shift(NodeSymbol('p', 5), 1),
+            NodeSymbol('p', kBlockSize + 5));
+  EXPECT_EQ(RestoredNodeIds::shift(NodeSymbol('O', 0), 2),
+            NodeSymbol('O', 2 * kBlockSize));
+
+  // nodes restored by an earlier run keep their ids
+  const NodeId restored = NodeSymbol('p', kBlockSize + 3);
+  EXPECT_EQ(RestoredNodeIds::shift(restored, 2), restored);
+}
+
+TEST(RestoredNodeIds, ShiftGraphKeepsStructure) {
+  DynamicSceneGraph graph;
+  addPlace(graph, NodeSymbol('p', 0), 1.0);
+  addPlace(graph, NodeSymbol('p', 1), 2.0);
+  addObject(graph, NodeSymbol('O', 0));
+  graph.insertEdge(NodeSymbol('p', 0), NodeSymbol('p', 1));
+  graph.insertEdge(NodeSymbol('p', 1), NodeSymbol('O', 0));
+
+  const auto block = RestoredNodeIds::findFreeBlock(graph);
+  EXPECT_EQ(block, 1u);
+  const auto result = RestoredNodeIds::shiftGraph(graph, block);
+  const auto p0 = RestoredNodeIds::shift(NodeSymbol('p', 0), block);
+  const auto p1 = RestoredNodeIds::shift(NodeSymbol('p', 1), block);
+  const auto o0 = RestoredNodeIds::shift(NodeSymbol('O', 0), block);
+
+  EXPECT_EQ(result->numNodes(), graph.numNodes());
+  EXPECT_FALSE(result->hasNode(NodeSymbol('p', 0)));
+  ASSERT_TRUE(result->hasNode(p0));
+  ASSERT_TRUE(result->hasNode(o0));
+  EXPECT_DOUBLE_EQ(result->getNode(p1).attributes().position.x(), 2.0);
+  EXPECT_TRUE(result->hasEdge(p0, p1));
+  EXPECT_TRUE(result->hasEdge(p1, o0));
+  EXPECT_EQ(result->numEdges(), graph.numEdges());
+
+  // the input is left untouched
+  EXPECT_TRUE(graph.hasNode(NodeSymbol('p', 0)));
+}
+
+TEST(RestoredNodeIds, NewNodesNeverCollide) {
+  DynamicSceneGraph graph;
+  addPlace(graph, NodeSymbol('p', 0), 1.0);
+  const auto first_block = RestoredNodeIds::findFreeBlock(graph);
+  auto first = RestoredNodeIds::shiftGraph(graph, first_block);
+
+  // the frontend of the resumed run allocates from zero again
+  addPlace(*first, NodeSymbol('p', 0), 3.0);
+  EXPECT_EQ(first->numNodes(), 2u);
+
+  // a second restart moves the new nodes into the next block
+  const auto block = RestoredNodeIds::findFreeBlock(*first);
+  EXPECT_EQ(block, 2u);
+  const auto second = RestoredNodeIds::shiftGraph(*first, block);
+  EXPECT_EQ(second->numNodes(), 2u);
+  EXPECT_TRUE(second->hasNode(NodeSymbol('p', RestoredNodeIds::kBlockSize)));
+  EXPECT_TRUE(second->hasNode(NodeSymbol('p', 2 * RestoredNodeIds::kBlockSize)));
+  EXPECT_FALSE(second->hasNode(NodeSymbol('p', 0)));
+}
+
+}  // namespace hydra
@@ -0,0 +1,126 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/backend/ros_backend_publisher.h>
+
+namespace hydra {
+
+namespace {
+
+visualization_msgs::Marker makeMarker(size_t num_points, double offset = 0.0) {
+  visualization_msgs::Marker marker;
+  marker.type = visualization_msgs::Marker::LINE_LIST;
+  marker.ns = "edges";
+  for (size_t i = 0; i < num_points; ++i) {
+    auto& point = marker.points.emplace_back();
+    point.x = i + offset;
+    marker.colors.emplace_back().a = 1.0;
+  }
+
+  return marker;
+}
+
+}  // namespace
+
+TEST(RosBackendPublisher, IncrementalMarkerAppends) {
+  RosBackendPublisher::IncrementalMarker state;
+  auto marker = makeMarker(4);
+  auto result = RosBackendPublisher::updateIncrementalMarker(state, marker);
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].id, 0);
+  EXPECT_EQ(result[0].points.size(), 4u);
+
+  // nothing new
+  marker = makeMarker(4);
+  result = RosBackendPublisher::updateIncrementalMarker(state, marker);
+  EXPECT_TRUE(result.empty());
+
+  // only the appended points are sent with a new id
+  marker = makeMarker(6);
+  result = RosBackendPublisher::updateIncrementalMarker(state, marker);
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].id, 1);
+  ASSERT_EQ(result[0].points.size(), 2u);
+  EXPECT_DOUBLE_EQ(result[0].points[0].x, 4.0);
+  EXPECT_EQ(result[0].colors.size(), 2u);
+
+  marker = makeMarker(8);
+  result = RosBackendPublisher::updateIncrementalMarker(state, marker);
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].id, 2);
+}
+
+TEST(RosBackendPublisher, IncrementalMarkerReplacesMovedPoints) {
+  RosBackendPublisher::IncrementalMarker state;
+  auto marker = makeMarker(4);
+  RosBackendPublisher::updateIncrementalMarker(state, marker);
+  marker = makeMarker(6);
+  RosBackendPublisher::updateIncrementalMarker(state, marker);
+
+  // shifted points invalidate everything that was sent
+  marker = makeMarker(6, 0.5);
+  const auto result = RosBackendPublisher::updateIncrementalMarker(state, marker);
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(result[0].action, visualization_msgs::Marker::DELETEALL);
+  EXPECT_EQ(result[1].id, 0);
+  EXPECT_EQ(result[1].points.size(), 6u);
+}
+
+TEST(RosBackendPublisher, IncrementalMarkerInvalidateClearsSentIds) {
+  RosBackendPublisher::IncrementalMarker state;
+  auto marker = makeMarker(4);
+  RosBackendPublisher::updateIncrementalMarker(state, marker);
+  marker = makeMarker(6);
+  RosBackendPublisher::updateIncrementalMarker(state, marker);
+
+  // a new subscriber gets the full marker and the appended markers are cleared
+  state.invalidate();
+  marker = makeMarker(6);
+  auto result = RosBackendPublisher::updateIncrementalMarker(state, marker);
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(result[0].action, visualization_msgs::Marker::DELETEALL);
+  EXPECT_EQ(result[1].id, 0);
+  EXPECT_EQ(result[1].points.size(), 6u);
+
+  // appending continues after the full marker
+  marker = makeMarker(7);
+  result = RosBackendPublisher::updateIncrementalMarker(state, marker);
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0].id, 1);
+  EXPECT_EQ(result[0].points.size(), 1u);
+}
+
+}  // namespace hydra
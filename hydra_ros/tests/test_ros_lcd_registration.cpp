@@ -0,0 +1,172 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/loop_closure/ros_lcd_registration.h>
+#include <hydra_ros/utils/node_utilities.h>
+#include <spark_dsg/node_attributes.h>
+
+namespace hydra::lcd {
+
+using pose_graph_tools_msgs::LcdFrameRegistration;
+
+namespace {
+
+inline constexpr char kPrefix = 'a';
+
+void addPose(DynamicSceneGraph& graph, size_t index) {
+  auto attrs = std::make_unique<AgentNodeAttributes>(Eigen::Quaterniond::Identity(),
+                                                     Eigen::Vector3d::Zero(),
+                                                     NodeSymbol(kPrefix, index));
+  graph.emplaceNode(DsgLayers::AGENTS,
+                    kPrefix,
+                    std::chrono::nanoseconds(10 * (index + 1)),
+                    std::move(attrs));
+}
+
+DsgRegistrationInput makeInput(size_t query, size_t match) {
+  DsgRegistrationInput input;
+  input.query_nodes = {NodeSymbol(kPrefix, query)};
+  input.match_nodes = {NodeSymbol(kPrefix, match)};
+  return input;
+}
+
+bool registerFrames(LcdFrameRegistration::Request& req,
+                    LcdFrameRegistration::Response& res) {
+  // later queries take longer so that earlier candidates finish first
+  std::this_thread::sleep_for(std::chrono::milliseconds(20 * req.query));
+  res.valid = true;
+  res.match_T_query.orientation.w = 1.0;
+  return true;
+}
+
+}  // namespace
+
+TEST(ServiceBackoff, DelayDoublesUpToMax) {
+  ServiceBackoff backoff(1.0, 3.0);
+  EXPECT_TRUE(backoff.shouldCheck(0.0));
+
+  backoff.failed(0.0);
+  EXPECT_FALSE(backoff.shouldCheck(0.5));
+  EXPECT_TRUE(backoff.shouldCheck(1.0));
+
+  backoff.failed(1.0);
+  EXPECT_FALSE(backoff.shouldCheck(2.5));
+  EXPECT_TRUE(backoff.shouldCheck(3.0));
+
+  // capped at the maximum delay
+  backoff.failed(3.0);
+  EXPECT_FALSE(backoff.shouldCheck(5.5));
+  EXPECT_TRUE(backoff.shouldCheck(6.0));
+
+  backoff.succeeded();
+  EXPECT_TRUE(backoff.shouldCheck(0.0));
+}
+
+TEST(DsgAgentSolver, MissingServiceDoesNotBlock) {
+  DynamicSceneGraph graph;
+  addPose(graph, 0);
+  addPose(graph, 1);
+
+  DsgAgentSolver::Config config;
+  config.service_name = "missing_frame_registration";
+  DsgAgentSolver solver(config);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_FALSE(solver.solve(graph, makeInput(1, 0), NodeSymbol(kPrefix, 1)).valid);
+  }
+
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_LT(elapsed.count(), 1.0);
+}
+
+TEST(DsgAgentSolver, AsyncSolveWaitsForOwnCandidate) {
+  ros::NodeHandle nh;
+  CallbackThreads threads(nh, 1);
+  auto server = nh.advertiseService("test_frame_registration", &registerFrames);
+
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 4; ++i) {
+    addPose(graph, i);
+  }
+
+  DsgAgentSolver::Config config;
+  config.service_name = "test_frame_registration";
+  config.async = true;
+  DsgAgentSolver solver(config);
+
+  // the other candidate finishes first but is never handed back for this one
+  auto other = solver.solveAsync(graph, makeInput(1, 0));
+  const auto solution = solver.solve(graph, makeInput(3, 0), NodeSymbol(kPrefix, 3));
+  ASSERT_TRUE(solution.valid);
+  EXPECT_EQ(solution.from_node, NodeSymbol(kPrefix, 3));
+  EXPECT_EQ(solution.to_node, NodeSymbol(kPrefix, 0));
+
+  ASSERT_TRUE(other.valid());
+  const auto other_solution = other.get();
+  EXPECT_TRUE(other_solution.valid);
+  EXPECT_EQ(other_solution.from_node, NodeSymbol(kPrefix, 1));
+
+  threads.stop();
+}
+
+TEST(DsgAgentSolver, AsyncSolveKeepsLateResult) {
+  ros::NodeHandle nh;
+  CallbackThreads threads(nh, 1);
+  auto server = nh.advertiseService("test_frame_registration", &registerFrames);
+
+  DynamicSceneGraph graph;
+  for (size_t i = 0; i < 4; ++i) {
+    addPose(graph, i);
+  }
+
+  DsgAgentSolver::Config config;
+  config.service_name = "test_frame_registration";
+  config.async = true;
+  config.async_timeout_s = 0.0;
+  DsgAgentSolver solver(config);
+
+  // the request outlives the timeout but is still handed back when asked again
+  EXPECT_FALSE(solver.solve(graph, makeInput(3, 0), NodeSymbol(kPrefix, 3)).valid);
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  const auto solution = solver.solve(graph, makeInput(3, 0), NodeSymbol(kPrefix, 3));
+  EXPECT_TRUE(solution.valid);
+
+  threads.stop();
+}
+
+}  // namespace hydra::lcd
@@ -0,0 +1,124 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/input/sensor_prefetcher.h>
+
+namespace hydra {
+
+namespace {
+
+XmlRpc::XmlRpcValue makeReceivers(const std::string& topic, const std::string& frame) {
+  XmlRpc::XmlRpcValue extrinsics;
+  extrinsics["type"] = "ros";
+  extrinsics["sensor_frame"] = frame;
+
+  XmlRpc::XmlRpcValue sensor;
+  sensor["type"] = "camera_info";
+  sensor["camera_info_topic"] = topic;
+  sensor["extrinsics"] = extrinsics;
+
+  XmlRpc::XmlRpcValue receivers;
+  receivers[0]["sensor"] = sensor;
+  return receivers;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start) {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+}  // namespace
+
+TEST(SensorPrefetcher, TimeoutFallsBack) {
+  ros::NodeHandle nh("~prefetch_timeout");
+  nh.setParam("receivers", makeReceivers("prefetch_missing_info", "missing_frame"));
+
+  SensorPrefetcher::Config config;
+  config.timeout_s = 0.2;
+  const auto start = std::chrono::steady_clock::now();
+  auto& prefetcher = SensorPrefetcher::instance();
+  prefetcher.start(config, nh);
+
+  // sensors resolve missing information themselves instead of using empty results
+  const auto topic = ros::NodeHandle("~").resolveName("prefetch_missing_info");
+  EXPECT_FALSE(prefetcher.getCameraInfo(topic));
+  EXPECT_FALSE(prefetcher.getExtrinsics("missing_frame"));
+  EXPECT_LT(secondsSince(start), 5.0);
+  prefetcher.stop();
+}
+
+TEST(SensorPrefetcher, ReceivesCameraInfo) {
+  ros::NodeHandle nh("~prefetch_info");
+  nh.setParam("receivers", makeReceivers("prefetch_info_topic", "missing_frame"));
+
+  const auto topic = ros::NodeHandle("~").resolveName("prefetch_info_topic");
+  ros::NodeHandle pub_nh;
+  auto pub = pub_nh.advertise<sensor_msgs::CameraInfo>(topic, 1, true);
+  sensor_msgs::CameraInfo msg;
+  msg.width = 640;
+  pub.publish(msg);
+
+  SensorPrefetcher::Config config;
+  config.timeout_s = 5.0;
+  auto& prefetcher = SensorPrefetcher::instance();
+  prefetcher.start(config, nh);
+  const auto result = prefetcher.getCameraInfo(topic);
+  ASSERT_TRUE(result);
+  ASSERT_TRUE(*result);
+  EXPECT_EQ((*result)->width, 640u);
+  prefetcher.stop();
+}
+
+TEST(SensorPrefetcher, OnlyReceiverSensorsArePrefetched) {
+  ros::NodeHandle nh("~prefetch_receivers");
+  nh.setParam("other/sensor/type", "camera_info");
+  nh.setParam("other/sensor/camera_info_topic", "prefetch_other_info");
+
+  SensorPrefetcher::Config config;
+  config.timeout_s = 30.0;
+  const auto start = std::chrono::steady_clock::now();
+  auto& prefetcher = SensorPrefetcher::instance();
+  prefetcher.start(config, nh);
+
+  // not waited on, so the lookup returns immediately
+  const auto topic = ros::NodeHandle("~").resolveName("prefetch_other_info");
+  EXPECT_FALSE(prefetcher.getCameraInfo(topic));
+  EXPECT_LT(secondsSince(start), 5.0);
+  prefetcher.stop();
+}
+
+}  // namespace hydra
@@ -0,0 +1,205 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <hydra_ros/utils/shared_memory_dsg.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+namespace hydra {
+
+namespace {
+
+std::string getSegmentName(const std::string& test) {
+  return "/hydra_ros_test_" + test + "_" + std::to_string(getpid());
+}
+
+std::vector<uint8_t> makePayload(size_t size, uint8_t value) {
+  return std::vector<uint8_t>(size, value);
+}
+
+}  // namespace
+
+TEST(SharedMemoryDsg, WriteAndRead) {
+  const auto name = getSegmentName("write_and_read");
+  SharedDsgReader reader(name);
+  EXPECT_FALSE(reader.readLatest([](const uint8_t*, size_t, uint64_t) {}));
+
+  SharedDsgWriter writer(name, 1024);
+  ASSERT_TRUE(writer.valid());
+  EXPECT_FALSE(reader.readLatest([](const uint8_t*, size_t, uint64_t) {}));
+  EXPECT_TRUE(reader.connected());
+
+  const auto payload = makePayload(100, 3);
+  EXPECT_TRUE(writer.write(payload.data(), payload.size(), 5));
+
+  std::vector<uint8_t> result;
+  uint64_t stamp = 0;
+  const auto read_func = [&](const uint8_t* data, size_t size, uint64_t stamp_ns) {
+    result.assign(data, data + size);
+    stamp = stamp_ns;
+  };
+  EXPECT_TRUE(reader.readLatest(read_func));
+  EXPECT_EQ(result, payload);
+  EXPECT_EQ(stamp, 5u);
+
+  // nothing new to read
+  EXPECT_FALSE(reader.readLatest(read_func));
+
+  // only the latest write is visible
+  writer.write(makePayload(10, 1).data(), 10, 6);
+  writer.write(makePayload(20, 2).data(), 20, 7);
+  EXPECT_TRUE(reader.readLatest(read_func));
+  EXPECT_EQ(result, makePayload(20, 2));
+  EXPECT_EQ(stamp, 7u);
+
+  // payloads larger than a slot are dropped
+  const auto too_big = makePayload(2048, 1);
+  EXPECT_FALSE(writer.write(too_big.data(), too_big.size(), 8));
+  EXPECT_EQ(writer.numDropped(), 1u);
+}
+
+TEST(SharedMemoryDsg, WriterAvoidsBusySlot) {
+  const auto name = getSegmentName("busy_slot");
+  SharedDsgWriter writer(name, 1024);
+  SharedDsgReader reader(name);
+  writer.write(makePayload(10, 1).data(), 10, 1);
+
+  std::vector<uint8_t> result;
+  EXPECT_TRUE(reader.readLatest([&](const uint8_t* data, size_t size, uint64_t) {
+    // the slot being read stays intact while the writer uses the other one
+    EXPECT_TRUE(writer.write(makePayload(10, 2).data(), 10, 2));
+    EXPECT_TRUE(writer.write(makePayload(10, 3).data(), 10, 3));
+    result.assign(data, data + size);
+  }));
+  EXPECT_EQ(result, makePayload(10, 1));
+
+  EXPECT_TRUE(reader.readLatest([&](const uint8_t* data, size_t size, uint64_t) {
+    result.assign(data, data + size);
+  }));
+  EXPECT_EQ(result, makePayload(10, 3));
+}
+
+TEST(SharedMemoryDsg, ReconnectAfterWriterRestart) {
+  const auto name = getSegmentName("restart");
+  SharedDsgReader reader(name);
+  std::vector<uint8_t> result;
+  const auto read_func = [&](const uint8_t* data, size_t size, uint64_t) {
+    result.assign(data, data + size);
+  };
+
+  {
+    SharedDsgWriter writer(name, 1024);
+    writer.write(makePayload(10, 1).data(), 10, 1);
+    EXPECT_TRUE(reader.readLatest(read_func));
+  }
+
+  EXPECT_FALSE(reader.readLatest(read_func));
+  EXPECT_FALSE(reader.connected());
+
+  SharedDsgWriter writer(name, 512);
+  writer.write(makePayload(10, 4).data(), 10, 1);
+  EXPECT_TRUE(reader.readLatest(read_func));
+  EXPECT_EQ(result, makePayload(10, 4));
+}
+
+TEST(SharedMemoryDsg, RemapAfterWriterCrash) {
+  const auto name = getSegmentName("crash");
+  SharedDsgReader reader(name);
+  std::vector<uint8_t> result;
+  const auto read_func = [&](const uint8_t* data, size_t size, uint64_t) {
+    result.assign(data, data + size);
+  };
+
+  // leaking the writer leaves its segment mapped and marked valid, like a crash
+  auto crashed = new SharedDsgWriter(name, 1024);
+  crashed->write(makePayload(10, 1).data(), 10, 1);
+  EXPECT_TRUE(reader.readLatest(read_func));
+
+  SharedDsgWriter writer(name, 1024);
+  writer.write(makePayload(10, 5).data(), 10, 2);
+  // the first read notices the replaced segment, the second reads from it
+  EXPECT_FALSE(reader.readLatest(read_func));
+  EXPECT_TRUE(reader.readLatest(read_func));
+  EXPECT_EQ(result, makePayload(10, 5));
+}
+
+TEST(SharedMemoryDsg, Permissions) {
+  const auto name = getSegmentName("permissions");
+  SharedDsgWriter writer(name, 1024);
+  ASSERT_TRUE(writer.valid());
+
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  ASSERT_GE(fd, 0);
+  struct stat info;
+  ASSERT_EQ(fstat(fd, &info), 0);
+  close(fd);
+  EXPECT_EQ(info.st_mode & 0777, 0600u);
+}
+
+TEST(SharedMemoryDsg, ConcurrentReadsAreConsistent) {
+  const auto name = getSegmentName("concurrent");
+  SharedDsgWriter writer(name, 1 << 16);
+  SharedDsgReader reader(name);
+
+  std::thread producer([&writer]() {
+    for (size_t i = 1; i <= 2000; ++i) {
+      const auto payload = makePayload(1000 + i % 100, i % 251);
+      writer.write(payload.data(), payload.size(), i);
+    }
+  });
+
+  size_t num_reads = 0;
+  bool consistent = true;
+  for (size_t i = 0; i < 20000; ++i) {
+    reader.readLatest([&](const uint8_t* data, size_t size, uint64_t stamp_ns) {
+      ++num_reads;
+      consistent &= size == 1000 + stamp_ns % 100;
+      for (size_t j = 0; j < size; ++j) {
+        consistent &= data[j] == stamp_ns % 251;
+      }
+    });
+  }
+
+  producer.join();
+  EXPECT_TRUE(consistent);
+  EXPECT_GT(num_reads, 0u);
+}
+
+}  // namespace hydra
@@ -0,0 +1,156 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/spsc_ring_buffer.h>
+
+#include <thread>
+
+namespace hydra {
+
+TEST(SpscRingBuffer, PushPopInOrder) {
+  SpscRingBuffer<int> buffer(3);
+  EXPECT_EQ(buffer.capacity(), 4u);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_FALSE(buffer.pop());
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(buffer.push(i));
+  }
+
+  EXPECT_EQ(buffer.size(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(buffer.pop(), i);
+  }
+
+  EXPECT_FALSE(buffer.pop());
+  EXPECT_EQ(buffer.numPushed(), 4u);
+  EXPECT_EQ(buffer.numDropped(), 0u);
+}
+
+TEST(SpscRingBuffer, DropPolicies) {
+  SpscRingBuffer<int> oldest(2, DropPolicy::DROP_OLDEST);
+  SpscRingBuffer<int> newest(2, DropPolicy::DROP_NEWEST);
+  for (int i = 0; i < 5; ++i) {
+    oldest.push(i);
+    newest.push(i);
+  }
+
+  EXPECT_EQ(oldest.numDropped(), 3u);
+  EXPECT_EQ(oldest.pop(), 3);
+  EXPECT_EQ(oldest.pop(), 4);
+  EXPECT_FALSE(oldest.pop());
+
+  EXPECT_EQ(newest.numDropped(), 3u);
+  EXPECT_EQ(newest.pop(), 0);
+  EXPECT_EQ(newest.pop(), 1);
+  EXPECT_FALSE(newest.pop());
+}
+
+TEST(SpscRingBuffer, ConcurrentHandoff) {
+  SpscRingBuffer<std::unique_ptr<int>> buffer(8, DropPolicy::DROP_OLDEST);
+  constexpr int num_items = 20000;
+  std::thread producer([&]() {
+    for (int i = 0; i < num_items; ++i) {
+      buffer.push(std::make_unique<int>(i));
+    }
+  });
+
+  int last = -1;
+  size_t num_received = 0;
+  while (true) {
+    auto value = buffer.pop();
+    if (!value) {
+      if (last == num_items - 1) {
+        break;
+      }
+
+      std::this_thread::yield();
+      continue;
+    }
+
+    // items may be dropped but never reordered
+    EXPECT_GT(**value, last);
+    last = **value;
+    ++num_received;
+  }
+
+  producer.join();
+  EXPECT_EQ(num_received + buffer.numDropped(), static_cast<size_t>(num_items));
+}
+
+TEST(SpscRingBuffer, BlockingHandoffIsLossless) {
+  SpscRingBuffer<int> buffer(8, DropPolicy::BLOCK);
+  constexpr int num_items = 20000;
+  std::thread producer([&]() {
+    for (int i = 0; i < num_items; ++i) {
+      EXPECT_TRUE(buffer.push(i));
+    }
+  });
+
+  int expected = 0;
+  while (expected < num_items) {
+    auto value = buffer.pop();
+    if (!value) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    EXPECT_EQ(*value, expected);
+    ++expected;
+  }
+
+  producer.join();
+  EXPECT_EQ(buffer.numDropped(), 0u);
+  EXPECT_EQ(buffer.numPushed(), static_cast<size_t>(num_items));
+}
+
+TEST(SpscRingBuffer, CloseReleasesBlockedProducer) {
+  SpscRingBuffer<int> buffer(2, DropPolicy::BLOCK);
+  EXPECT_TRUE(buffer.push(0));
+  EXPECT_TRUE(buffer.push(1));
+
+  bool pushed = true;
+  std::thread producer([&]() { pushed = buffer.push(2); });
+  buffer.close();
+  producer.join();
+
+  EXPECT_FALSE(pushed);
+  EXPECT_EQ(buffer.numDropped(), 1u);
+  EXPECT_EQ(buffer.pop(), 0);
+  EXPECT_EQ(buffer.pop(), 1);
+  EXPECT_FALSE(buffer.pop());
+}
+
+}  // namespace hydra
@@ -0,0 +1,107 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/stamp_synchronizer.h>
+
+namespace hydra {
+
+using Sync = StampSynchronizer<int, 3>;
+
+TEST(StampSynchronizer, ExactMatchesDoNotWait) {
+  std::vector<Sync::Items> matches;
+  Sync sync(4, 0, [&](const Sync::Items& items) { matches.push_back(items); });
+  sync.add(1, 100, 11);
+  sync.add(0, 100, 10);
+  EXPECT_TRUE(matches.empty());
+  sync.add(2, 100, 12);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matches[0], (Sync::Items{10, 11, 12}));
+
+  // a reference message stamped later than the others is matched immediately
+  sync.add(1, 200, 21);
+  sync.add(2, 200, 22);
+  sync.add(0, 200, 20);
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches[1], (Sync::Items{20, 21, 22}));
+  EXPECT_EQ(sync.numDropped(), 0u);
+}
+
+TEST(StampSynchronizer, ApproximateMatchesWaitForCloserMessages) {
+  std::vector<Sync::Items> matches;
+  Sync sync(4, 10, [&](const Sync::Items& items) { matches.push_back(items); });
+  sync.add(0, 100, 10);
+  sync.add(1, 95, 11);
+  sync.add(2, 92, 12);
+  // neither stream has reached the reference stamp, so a closer message may follow
+  EXPECT_TRUE(matches.empty());
+
+  sync.add(1, 101, 13);
+  sync.add(2, 120, 14);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matches[0], (Sync::Items{10, 13, 12}));
+}
+
+TEST(StampSynchronizer, RejectsMessagesOutsideTolerance) {
+  std::vector<Sync::Items> matches;
+  Sync sync(4, 5, [&](const Sync::Items& items) { matches.push_back(items); });
+  sync.add(0, 100, 10);
+  sync.add(0, 200, 20);
+  sync.add(1, 150, 11);
+  sync.add(2, 150, 12);
+  EXPECT_TRUE(matches.empty());
+  EXPECT_EQ(sync.numDropped(), 1u);
+
+  sync.add(1, 200, 21);
+  sync.add(2, 202, 22);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matches[0], (Sync::Items{20, 21, 22}));
+}
+
+TEST(StampSynchronizer, RingsDropOldestMessages) {
+  size_t num_matches = 0;
+  Sync sync(2, 0, [&](const Sync::Items&) { ++num_matches; });
+  for (int i = 0; i < 5; ++i) {
+    sync.add(0, i, i);
+  }
+
+  sync.add(0, 3, 3);  // out of order
+  sync.add(1, 4, 4);
+  sync.add(2, 4, 4);
+  EXPECT_EQ(num_matches, 1u);
+  // three ring overflows, one out of order message and one stale reference message
+  EXPECT_EQ(sync.numDropped(), 5u);
+}
+
+}  // namespace hydra
@@ -0,0 +1,121 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/stream_scheduler.h>
+
+#include <cmath>
+
+namespace hydra {
+
+using spark_dsg::DsgLayers;
+
+namespace {
+
+constexpr uint64_t kSecondNs = 1000000000;
+
+}  // namespace
+
+TEST(StreamScheduler, SendsEverythingWithoutBudget) {
+  StreamScheduler scheduler({});
+  const auto scheduled =
+      scheduler.schedule(0, {{DsgLayers::OBJECTS, 1000}, {DsgLayers::PLACES, 1000}});
+  EXPECT_EQ(scheduled.size(), 2u);
+  EXPECT_TRUE(std::isinf(scheduler.available(0)));
+}
+
+TEST(StreamScheduler, PrioritizesLayersWithinBudget) {
+  StreamScheduler::Config config;
+  config.bytes_per_second = 1000.0;
+  config.initial_bytes_per_node = 10.0;
+  config.layers["rooms"].priority = 2;
+  config.layers["places"].priority = 1;
+  StreamScheduler scheduler(config);
+
+  // the full bucket always lets the highest priority layer through
+  auto scheduled =
+      scheduler.schedule(0, {{DsgLayers::PLACES, 80}, {DsgLayers::ROOMS, 50}});
+  EXPECT_EQ(scheduled, std::set<spark_dsg::LayerId>({DsgLayers::ROOMS}));
+
+  scheduler.consume(0, 500, 50);
+  EXPECT_DOUBLE_EQ(scheduler.available(0), 500.0);
+
+  // half a second refills 500 bytes, which fits the places as well
+  scheduled = scheduler.schedule(kSecondNs / 2,
+                                 {{DsgLayers::PLACES, 80}, {DsgLayers::ROOMS, 5}});
+  EXPECT_EQ(scheduled.size(), 2u);
+}
+
+TEST(StreamScheduler, RespectsLayerPeriods) {
+  StreamScheduler::Config config;
+  config.layers["places"].min_period_s = 1.0;
+  StreamScheduler scheduler(config);
+
+  const std::map<spark_dsg::LayerId, size_t> pending{{DsgLayers::PLACES, 1},
+                                                     {DsgLayers::OBJECTS, 1}};
+  EXPECT_EQ(scheduler.schedule(0, pending).size(), 2u);
+  EXPECT_EQ(scheduler.schedule(kSecondNs / 2, pending),
+            std::set<spark_dsg::LayerId>({DsgLayers::OBJECTS}));
+  EXPECT_EQ(scheduler.schedule(kSecondNs, pending).size(), 2u);
+}
+
+TEST(StreamScheduler, EstimatesNodeSize) {
+  StreamScheduler::Config config;
+  config.initial_bytes_per_node = 100.0;
+  StreamScheduler scheduler(config);
+
+  scheduler.consume(0, 2000, 10);
+  EXPECT_DOUBLE_EQ(scheduler.bytesPerNode(), 125.0);
+  scheduler.consume(0, 2000);
+  EXPECT_DOUBLE_EQ(scheduler.bytesPerNode(), 125.0);
+}
+
+TEST(StreamScheduler, DefersUntilBudgetRecovers) {
+  StreamScheduler::Config config;
+  config.bytes_per_second = 100.0;
+  config.initial_bytes_per_node = 10.0;
+  StreamScheduler scheduler(config);
+
+  // a large full update overdraws the budget
+  scheduler.consume(0, 300);
+  EXPECT_DOUBLE_EQ(scheduler.available(0), -200.0);
+
+  const std::map<spark_dsg::LayerId, size_t> pending{{DsgLayers::PLACES, 5}};
+  EXPECT_TRUE(scheduler.schedule(kSecondNs, pending).empty());
+  EXPECT_TRUE(scheduler.schedule(2 * kSecondNs, pending).empty());
+  EXPECT_EQ(scheduler.schedule(3 * kSecondNs, pending).size(), 1u);
+}
+
+}  // namespace hydra
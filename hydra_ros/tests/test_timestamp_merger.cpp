@@ -0,0 +1,81 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/timestamp_merger.h>
+
+#include <thread>
+
+namespace hydra {
+
+TEST(TimestampMerger, MergesInOrder) {
+  TimestampMerger<uint64_t> merger(3, 2);
+  std::vector<std::thread> producers;
+  for (size_t source = 0; source < 3; ++source) {
+    producers.emplace_back([&merger, source]() {
+      // source i produces i, i + 3, i + 6, ...
+      for (uint64_t t = source; t < 30; t += 3) {
+        merger.push(source, t, uint64_t(t));
+      }
+      merger.finish(source);
+    });
+  }
+
+  std::vector<uint64_t> result;
+  while (auto item = merger.pop()) {
+    result.push_back(*item);
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  ASSERT_EQ(result.size(), 30u);
+  for (size_t i = 0; i < result.size(); ++i) {
+    EXPECT_EQ(result[i], i);
+  }
+}
+
+TEST(TimestampMerger, FinishedSourcesDoNotBlock) {
+  TimestampMerger<int> merger(2, 4);
+  merger.finish(0);
+  merger.push(1, 5, 1);
+  merger.push(1, 7, 2);
+  merger.finish(1);
+  EXPECT_EQ(merger.pop(), 1);
+  EXPECT_EQ(merger.pop(), 2);
+  EXPECT_FALSE(merger.pop());
+}
+
+}  // namespace hydra
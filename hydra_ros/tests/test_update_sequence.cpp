@@ -0,0 +1,93 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/utils/update_sequence.h>
+
+namespace hydra {
+
+TEST(UpdateSequence, DeltasFollowFullUpdates) {
+  UpdateSequence sequence;
+  EXPECT_FALSE(sequence.last());
+  EXPECT_FALSE(sequence.canApply(0, false));
+  EXPECT_TRUE(sequence.canApply(0, true));
+
+  sequence.applied(0);
+  EXPECT_EQ(sequence.last(), 0);
+  EXPECT_TRUE(sequence.canApply(1, false));
+  sequence.applied(1);
+  EXPECT_TRUE(sequence.canApply(2, false));
+  EXPECT_FALSE(sequence.canApply(1, false));
+}
+
+TEST(UpdateSequence, GapRequiresFullUpdate) {
+  UpdateSequence sequence;
+  sequence.applied(0);
+
+  // delta 1 was lost
+  EXPECT_FALSE(sequence.canApply(2, false));
+  EXPECT_TRUE(sequence.rejected());
+  EXPECT_FALSE(sequence.last());
+
+  // later deltas are rejected without asking again
+  EXPECT_FALSE(sequence.canApply(3, false));
+  EXPECT_FALSE(sequence.rejected());
+
+  // the resync answer restores the sequence
+  EXPECT_TRUE(sequence.canApply(4, true));
+  sequence.applied(4);
+  EXPECT_TRUE(sequence.canApply(5, false));
+}
+
+TEST(UpdateSequence, ResyncIsRetried) {
+  UpdateSequence sequence(3);
+  sequence.applied(0);
+
+  size_t num_requests = 0;
+  for (int64_t i = 2; i < 9; ++i) {
+    ASSERT_FALSE(sequence.canApply(i, false));
+    num_requests += sequence.rejected() ? 1 : 0;
+  }
+
+  // requested on the 1st, 4th and 7th rejection
+  EXPECT_EQ(num_requests, 3u);
+
+  // a new gap after resyncing is requested immediately
+  sequence.applied(10);
+  EXPECT_FALSE(sequence.canApply(12, false));
+  EXPECT_TRUE(sequence.rejected());
+}
+
+}  // namespace hydra
@@ -0,0 +1,118 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/view_frustum.h>
+
+namespace hydra {
+
+namespace {
+
+ViewFrustum::Config makeConfig() {
+  ViewFrustum::Config config;
+  config.enable = true;
+  config.horizontal_fov = 90.0;
+  config.vertical_fov = 90.0;
+  config.max_range = 10.0;
+  config.margin = 0.0;
+  config.index_resolution = 1.0;
+  return config;
+}
+
+}  // namespace
+
+TEST(ViewFrustum, ContainsEverythingWithoutPose) {
+  ViewFrustum frustum(makeConfig());
+  EXPECT_TRUE(frustum.contains(Eigen::Vector3d(-100.0, 0.0, 0.0)));
+}
+
+TEST(ViewFrustum, ContainsPointsInsideVolume) {
+  ViewFrustum frustum(makeConfig());
+  EXPECT_TRUE(frustum.setViewPose(Eigen::Isometry3d::Identity()));
+
+  EXPECT_TRUE(frustum.contains(Eigen::Vector3d(5.0, 0.0, 0.0)));
+  EXPECT_TRUE(frustum.contains(Eigen::Vector3d(5.0, 4.9, -4.9)));
+  EXPECT_FALSE(frustum.contains(Eigen::Vector3d(5.0, 5.1, 0.0)));
+  EXPECT_FALSE(frustum.contains(Eigen::Vector3d(-1.0, 0.0, 0.0)));
+  EXPECT_FALSE(frustum.contains(Eigen::Vector3d(10.5, 0.0, 0.0)));
+  // a sphere that overlaps the volume is still visible
+  EXPECT_TRUE(frustum.contains(Eigen::Vector3d(10.5, 0.0, 0.0), 1.0));
+
+  // rotating the viewer by 180 degrees flips what is visible
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.linear() = Eigen::AngleAxisd(M_PI, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+  EXPECT_TRUE(frustum.setViewPose(pose));
+  EXPECT_FALSE(frustum.contains(Eigen::Vector3d(5.0, 0.0, 0.0)));
+  EXPECT_TRUE(frustum.contains(Eigen::Vector3d(-5.0, 0.0, 0.0)));
+}
+
+TEST(ViewFrustum, IgnoresSmallMotion) {
+  auto config = makeConfig();
+  config.update_distance = 0.5;
+  config.update_angle = 5.0;
+  ViewFrustum frustum(config);
+  EXPECT_TRUE(frustum.setViewPose(Eigen::Isometry3d::Identity()));
+
+  Eigen::Isometry3d pose = Eigen::Isometry3d::Identity();
+  pose.translation() << 0.2, 0.0, 0.0;
+  EXPECT_FALSE(frustum.setViewPose(pose));
+
+  const double angle = 10.0 * M_PI / 180.0;
+  pose.linear() = Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+  EXPECT_TRUE(frustum.setViewPose(pose));
+}
+
+TEST(ViewFrustum, IndexReturnsVisibleNodes) {
+  ViewFrustum frustum(makeConfig());
+  for (size_t i = 0; i < 20; ++i) {
+    frustum.updateNode(0, i, Eigen::Vector3d(i - 10.0, 0.0, 0.0));
+  }
+
+  // everything is visible until the viewer is known
+  EXPECT_EQ(frustum.getVisible(0).size(), 20u);
+
+  frustum.setViewPose(Eigen::Isometry3d::Identity());
+  std::unordered_set<NodeId> expected{10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+  EXPECT_EQ(frustum.getVisible(0), expected);
+
+  // moved and removed nodes are reflected in the index
+  frustum.updateNode(0, 0, Eigen::Vector3d(3.0, 0.0, 0.0));
+  frustum.removeNode(0, 19);
+  expected.insert(0);
+  expected.erase(19);
+  EXPECT_EQ(frustum.getVisible(0), expected);
+  EXPECT_TRUE(frustum.getVisible(1).empty());
+}
+
+}  // namespace hydra
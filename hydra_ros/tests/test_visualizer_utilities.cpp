@@ -0,0 +1,151 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/visualizer_utilities.h>
+#include <spark_dsg/node_attributes.h>
+
+namespace hydra {
+
+namespace {
+
+void addPlace(DynamicSceneGraph& graph,
+              NodeId node_id,
+              const Eigen::Vector3d& pos,
+              const Eigen::Vector3d& scale,
+              bool real_place = false) {
+  auto attrs = std::make_unique<PlaceNodeAttributes>();
+  attrs->position = pos;
+  attrs->frontier_scale = scale;
+  attrs->orientation = Eigen::Quaterniond::Identity();
+  attrs->real_place = real_place;
+  graph.emplaceNode(DsgLayers::PLACES, node_id, std::move(attrs));
+}
+
+}  // namespace
+
+TEST(VisualizerUtilities, EllipsoidListIsotropic) {
+  DynamicSceneGraph graph;
+  addPlace(graph, 0, Eigen::Vector3d::Zero(), Eigen::Vector3d::Constant(0.5));
+  addPlace(graph, 1, Eigen::Vector3d::UnitX(), Eigen::Vector3d::Constant(0.5));
+  addPlace(graph, 2, Eigen::Vector3d::UnitY(), Eigen::Vector3d::Constant(2.0), true);
+
+  const auto config = LayerConfig::__getDefault__();
+  const auto viz_config = VisualizerConfig::__getDefault__();
+  size_t num_colored = 0;
+  const auto color_func = [&](const SceneGraphNode&) {
+    ++num_colored;
+    return Color(255, 0, 0);
+  };
+
+  const auto marker = makeEllipsoidListMarker(std_msgs::Header(),
+                                              config,
+                                              graph.getLayer(DsgLayers::PLACES),
+                                              viz_config,
+                                              "frontiers",
+                                              color_func);
+  EXPECT_EQ(marker.type, visualization_msgs::Marker::SPHERE_LIST);
+  EXPECT_DOUBLE_EQ(marker.scale.x, 0.5);
+  EXPECT_EQ(marker.points.size(), 2u);
+  EXPECT_EQ(marker.colors.size(), 2u);
+  EXPECT_EQ(num_colored, 2u);
+}
+
+TEST(VisualizerUtilities, EllipsoidListAnisotropic) {
+  DynamicSceneGraph graph;
+  addPlace(graph, 0, Eigen::Vector3d::Zero(), Eigen::Vector3d(2.0, 1.0, 0.5));
+  addPlace(graph, 1, Eigen::Vector3d(5.0, 0.0, 0.0), Eigen::Vector3d::Constant(1.0));
+
+  auto viz_config = VisualizerConfig::__getDefault__();
+  viz_config.collapse_layers = true;
+  const auto marker = makeEllipsoidListMarker(
+      std_msgs::Header(),
+      LayerConfig::__getDefault__(),
+      graph.getLayer(DsgLayers::PLACES),
+      viz_config,
+      "frontiers",
+      [](const SceneGraphNode&) { return Color(); });
+  EXPECT_EQ(marker.type, visualization_msgs::Marker::TRIANGLE_LIST);
+  ASSERT_FALSE(marker.points.empty());
+  EXPECT_EQ(marker.points.size() % 6, 0u);
+  EXPECT_EQ(marker.points.size(), marker.colors.size());
+
+  // the first half of the vertices belong to the first ellipsoid
+  const size_t num_vertices = marker.points.size() / 2;
+  for (size_t i = 0; i < num_vertices; ++i) {
+    const auto& p = marker.points[i];
+    const double r = std::pow(p.x / 1.0, 2) + std::pow(p.y / 0.5, 2) +
+                     std::pow(p.z / 0.25, 2);
+    EXPECT_NEAR(r, 1.0, 1.0e-6);
+  }
+
+  for (size_t i = num_vertices; i < marker.points.size(); ++i) {
+    const auto& p = marker.points[i];
+    const double r = std::pow(p.x - 5.0, 2) + std::pow(p.y, 2) + std::pow(p.z, 2);
+    EXPECT_NEAR(r, 0.25, 1.0e-6);
+  }
+}
+
+TEST(VisualizerUtilities, FrontierMarkersApplyFilter) {
+  DynamicSceneGraph graph;
+  addPlace(graph, 0, Eigen::Vector3d::Zero(), Eigen::Vector3d::Constant(0.5));
+  addPlace(graph, 1, Eigen::Vector3d::UnitX(), Eigen::Vector3d::Constant(0.5));
+  addPlace(graph, 2, Eigen::Vector3d::UnitY(), Eigen::Vector3d::Constant(0.5), true);
+  addPlace(graph, 3, Eigen::Vector3d::UnitZ(), Eigen::Vector3d::Constant(0.5), true);
+
+  const auto config = LayerConfig::__getDefault__();
+  const auto viz_config = VisualizerConfig::__getDefault__();
+  const auto& layer = graph.getLayer(DsgLayers::PLACES);
+  const auto color_func = [](const SceneGraphNode&) { return Color(); };
+  const auto filter = [](const SceneGraphNode& node) { return node.id % 2 == 0; };
+
+  const auto list = makeEllipsoidListMarker(
+      std_msgs::Header(), config, layer, viz_config, "frontiers", color_func, filter);
+  EXPECT_EQ(list.points.size(), 1u);
+
+  // filtered frontiers are deleted instead of keeping their previous marker
+  const auto markers = makeEllipsoidMarkers(
+      std_msgs::Header(), config, layer, viz_config, "frontiers", color_func, filter);
+  ASSERT_EQ(markers.size(), 2u);
+  EXPECT_EQ(markers[0].action, visualization_msgs::Marker::ADD);
+  EXPECT_EQ(markers[1].action, visualization_msgs::Marker::DELETE);
+  EXPECT_EQ(markers[1].id, 1);
+
+  const auto centroids = makePlaceCentroidMarkers(
+      std_msgs::Header(), config, layer, viz_config, "places", color_func, filter);
+  EXPECT_EQ(centroids.points.size(), 1u);
+}
+
+}  // namespace hydra
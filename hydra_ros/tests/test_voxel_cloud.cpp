@@ -0,0 +1,91 @@
+/* -----------------------------------------------------------------------------
+ * Copyright 2022 Massachusetts Institute of Technology.
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Research was sponsored by the United States Air Force Research Laboratory and
+ * the United States Air Force Artificial Intelligence Accelerator and was
+ * accomplished under Cooperative Agreement Number FA8750-19-2-1000. The views
+ * and conclusions contained in this document are those of the authors and should
+ * not be interpreted as representing the official policies, either expressed or
+ * implied, of the United States Air Force or the U.S. Government. The U.S.
+ * Government is authorized to reproduce and distribute reprints for Government
+ * purposes notwithstanding any copyright notation herein.
+ * -------------------------------------------------------------------------- */
+#include <gtest/gtest.h>
+#include <hydra_ros/visualizer/voxel_cloud.h>
+
+#include <cstring>
+
+namespace hydra {
+
+TEST(VoxelCloud, PacksPointsAndColors) {
+  visualization_msgs::Marker marker;
+  marker.header.frame_id = "world";
+  for (size_t i = 0; i < 3; ++i) {
+    geometry_msgs::Point point;
+    point.x = 1.0 * i;
+    point.y = 2.0 * i;
+    point.z = -0.5 * i;
+    marker.points.push_back(point);
+
+    std_msgs::ColorRGBA color;
+    color.r = 1.0f;
+    color.g = 0.5f;
+    color.b = 0.0f;
+    color.a = 1.0f;
+    marker.colors.push_back(color);
+  }
+
+  const auto cloud = makeVoxelCloud(marker);
+  EXPECT_EQ(cloud.header.frame_id, "world");
+  EXPECT_EQ(cloud.width, 3u);
+  EXPECT_EQ(cloud.height, 1u);
+  ASSERT_EQ(cloud.fields.size(), 4u);
+  EXPECT_EQ(cloud.fields[3].name, "rgb");
+  ASSERT_EQ(cloud.data.size(), 3u * cloud.point_step);
+
+  for (size_t i = 0; i < 3; ++i) {
+    float xyz[3];
+    uint32_t rgb;
+    std::memcpy(xyz, cloud.data.data() + i * cloud.point_step, sizeof(xyz));
+    std::memcpy(&rgb, cloud.data.data() + i * cloud.point_step + 12, sizeof(rgb));
+    EXPECT_FLOAT_EQ(xyz[0], 1.0f * i);
+    EXPECT_FLOAT_EQ(xyz[1], 2.0f * i);
+    EXPECT_FLOAT_EQ(xyz[2], -0.5f * i);
+    EXPECT_EQ(rgb, 0x00ff8000u);
+  }
+}
+
+TEST(VoxelCloud, DefaultsToWhite) {
+  visualization_msgs::Marker marker;
+  marker.points.resize(2);
+
+  const auto cloud = makeVoxelCloud(marker);
+  ASSERT_EQ(cloud.width, 2u);
+  uint32_t rgb;
+  std::memcpy(&rgb, cloud.data.data() + cloud.point_step + 12, sizeof(rgb));
+  EXPECT_EQ(rgb, 0x00ffffffu);
+}
+
+}  // namespace hydra